@@ -0,0 +1,590 @@
+#include "AppConverter.h"
+#include <AppSprite.h>
+#include <Core/Image.h>
+#include <Utils/IO.h>
+#include <Utils/Hash.h>
+#include <Utils/Aseprite/Format.h>
+#include <Utils/UI/Draw.h>
+#include <Utils/UI/Draw_ZXColorVideo.h>
+#include <Window/Sprite/FrameCache.h>
+#include <json/json.hpp>
+#include <atomic>
+#include <chrono>
+
+#include "stb/stb_image_write.h"
+
+namespace
+{
+	static const char* ExportFilename = "Export.json";
+	static const char* ManifestFilename = "ConvertManifest.json";
+	static constexpr int32_t ManifestVersion = 2;		// 2: sprites of subdirectories are written to the output directory itself
+
+	struct FHash
+	{
+		uint64_t Value = Utils::FNV1a64Basis;
+
+		void Update(const void* Data, size_t Size)
+		{
+			Value = Utils::FNV1a64(Value, Data, Size);
+		}
+
+		template<typename T>
+		void Update(const T& Scalar)
+		{
+			Update(&Scalar, sizeof(T));
+		}
+
+		void Update(const std::string& Text)
+		{
+			Update(Text.size());
+			Update(Text.data(), Text.size());
+		}
+
+		std::string ToString() const
+		{
+			return std::format("{:016x}", Value);
+		}
+	};
+
+	struct FSourceJob
+	{
+		std::filesystem::path Path;
+		std::string Key;								// path relative to the input directory, '/' separated
+		std::vector<std::filesystem::path> Overrides;	// <name>_frame_<n>.ink/.attr/.mask next to an aseprite file
+
+		std::string InkLayer;
+		std::string AttributeLayer;
+		std::string MaskLayer;
+
+		std::string Stamp;
+		std::string Hash;
+		nlohmann::ordered_json Sprites = nlohmann::ordered_json::array();
+
+		bool bConverted = false;
+		bool bFailed = false;
+	};
+
+	std::string ToUtf8(const std::filesystem::path& Path)
+	{
+		return Utils::Utf16ToUtf8(Path.wstring());
+	}
+
+	bool IsInside(const std::filesystem::path& Path, const std::filesystem::path& Directory)
+	{
+		const auto [DirectoryEnd, PathIt] = std::mismatch(Directory.begin(), Directory.end(), Path.begin(), Path.end());
+		return DirectoryEnd == Directory.end();
+	}
+
+	// sizes and modification times, a cheap check before the contents are read
+	std::string MakeStamp(const FSourceJob& Job, const std::string& OptionsHash)
+	{
+		FHash Hash;
+		Hash.Update(OptionsHash);
+		Hash.Update(Job.InkLayer);
+		Hash.Update(Job.AttributeLayer);
+		Hash.Update(Job.MaskLayer);
+		Hash.Update(Job.Overrides.size());
+		std::error_code ec;
+		auto AddFile = [&Hash, &ec](const std::filesystem::path& Path)
+			{
+				Hash.Update(ToUtf8(Path.filename()));
+				Hash.Update(static_cast<uint64_t>(std::filesystem::file_size(Path, ec)));
+				Hash.Update(static_cast<int64_t>(std::filesystem::last_write_time(Path, ec).time_since_epoch().count()));
+			};
+
+		AddFile(Job.Path);
+		for (const std::filesystem::path& Override : Job.Overrides)
+		{
+			AddFile(Override);
+		}
+		return Hash.ToString();
+	}
+
+	std::string HashContents(const FSourceJob& Job, const std::string& OptionsHash)
+	{
+		FHash Hash;
+		Hash.Update(OptionsHash);
+		Hash.Update(Job.InkLayer);
+		Hash.Update(Job.AttributeLayer);
+		Hash.Update(Job.MaskLayer);
+
+		std::vector<uint8_t> Data;
+		auto AddFile = [&Hash, &Data](const std::filesystem::path& Path)
+			{
+				Data.clear();
+				IO::LoadBinaryData(Data, Path);
+				Hash.Update(ToUtf8(Path.filename()));
+				Hash.Update(Data.size());
+				Hash.Update(Data.data(), Data.size());
+			};
+
+		AddFile(Job.Path);
+		for (const std::filesystem::path& Override : Job.Overrides)
+		{
+			AddFile(Override);
+		}
+		return Hash.ToString();
+	}
+
+	bool OutputsExist(const nlohmann::ordered_json& Sprites, const std::filesystem::path& OutputPath, bool bPNG)
+	{
+		std::error_code ec;
+		for (const nlohmann::ordered_json& Sprite : Sprites)
+		{
+			if (bPNG && !std::filesystem::exists(OutputPath / Utils::Utf8ToUtf16(Sprite.value("SprName", std::string{}) + ".png"), ec))
+			{
+				return false;
+			}
+			for (const char* Field : { "InkData", "AttributeData", "MaskData" })
+			{
+				const std::string DataFile = Sprite.value(Field, std::string{});
+				if (!DataFile.empty() && !std::filesystem::exists(Utils::Utf8ToUtf16(DataFile), ec))
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	// encoded in memory, stb opens files by narrow names only
+	bool WriteIndexedPNG(const std::filesystem::path& FilePath, const std::vector<uint8_t>& IndexedData, int32_t Width, int32_t Height)
+	{
+		constexpr int32_t Channels = 4;
+		std::vector<uint32_t> RGBA(static_cast<size_t>(Width) * Height);
+		for (size_t Offset = 0; Offset < RGBA.size(); ++Offset)
+		{
+			RGBA[Offset] = UI::ToU32(UI::ZXSpectrumColorRGBA[IndexedData[Offset]]);
+		}
+
+		std::vector<uint8_t> PNG;
+		auto Append = [](void* Context, void* Data, int Size)
+			{
+				std::vector<uint8_t>& Output = *static_cast<std::vector<uint8_t>*>(Context);
+				Output.insert(Output.end(), static_cast<const uint8_t*>(Data), static_cast<const uint8_t*>(Data) + Size);
+			};
+		if (!stbi_write_png_to_func(Append, &PNG, Width, Height, Channels, RGBA.data(), Width * Channels))
+		{
+			return false;
+		}
+		return !IO::SaveBinaryData(PNG, FilePath, false);
+	}
+
+	bool ConvertFrame(
+		FSourceJob& Job,
+		const FFrameZXSource& Source,
+		const std::string& SpriteName,
+		int32_t AsepriteIndex,
+		const FAppConverter::FOptions& Options)
+	{
+		FFrameZXData Data;
+		if (!FFrameCache::Convert(Source, Data))
+		{
+			std::cerr << std::format("[{}] cannot convert '{}'.", Job.Key, SpriteName) << std::endl;
+			return false;
+		}
+
+		const auto MakeExportFilename = [&Options, &SpriteName](std::string_view Extension)
+			{
+				return IO::NormalizePath(std::filesystem::absolute(Options.OutputPath / Utils::Utf8ToUtf16(SpriteName + std::string(Extension))));
+			};
+
+		if (Options.bPNG && !WriteIndexedPNG(MakeExportFilename(".png"), Data.IndexedData, Source.Width, Source.Height))
+		{
+			LOG_ERROR("[ConvertFrame]\t failed to write PNG for '{}'.", SpriteName);
+			std::cerr << std::format("[{}] failed to write PNG for '{}'.", Job.Key, SpriteName) << std::endl;
+			return false;
+		}
+
+		// a disabled or empty part leaves the path empty, a failed write fails the whole source
+		auto SaveData = [&Job](bool bEnabled, const std::vector<uint8_t>& Data, const std::filesystem::path& FilePath, std::filesystem::path& OutputPath) -> bool
+			{
+				if (!bEnabled || Data.empty())
+				{
+					return true;
+				}
+
+				const std::error_code ec = IO::SaveBinaryData(Data, FilePath, false);
+				if (ec)
+				{
+					LOG_ERROR("[ConvertFrame]\t failed to write '{}': {}.", ToUtf8(FilePath), ec.message());
+					std::cerr << std::format("[{}] failed to write '{}'.", Job.Key, ToUtf8(FilePath)) << std::endl;
+					return false;
+				}
+				OutputPath = FilePath;
+				return true;
+			};
+		std::filesystem::path InkDataFilePath;
+		std::filesystem::path AttributeDataFilePath;
+		std::filesystem::path MaskDataFilePath;
+		if (!SaveData(Options.bInk, Data.InkData, MakeExportFilename(".ink"), InkDataFilePath) ||
+			!SaveData(Options.bAttribute, Data.AttributeData, MakeExportFilename(".attr"), AttributeDataFilePath) ||
+			!SaveData(Options.bMask, Data.MaskData, MakeExportFilename(".mask"), MaskDataFilePath))
+		{
+			return false;
+		}
+
+		// the same schema as SSpriteList::ExportSprites
+		nlohmann::ordered_json SpriteJson =
+			{
+				{"SprName", SpriteName},
+				{"SprWidth", Source.Width},
+				{"SprHeight", Source.Height},
+				{"PoxImgX", 0},
+				{"PoxImgY", 0},
+				{"FileImg", ToUtf8(IO::NormalizePath(std::filesystem::absolute(Job.Path)))},
+
+				{"InkData", ToUtf8(InkDataFilePath)},
+				{"AttributeData", ToUtf8(AttributeDataFilePath)},
+				{"MaskData", ToUtf8(MaskDataFilePath)},
+			};
+		if (AsepriteIndex != INDEX_NONE)
+		{
+			SpriteJson.emplace("AsepriteIndex", AsepriteIndex);
+			SpriteJson.emplace("InkLayer", Job.InkLayer);
+			SpriteJson.emplace("AttributeLayer", Job.AttributeLayer);
+			SpriteJson.emplace("MaskLayer", Job.MaskLayer);
+		}
+		Job.Sprites.push_back(std::move(SpriteJson));
+		return true;
+	}
+
+	bool ConvertSource(FSourceJob& Job, const FAppConverter::FOptions& Options)
+	{
+		FFrameZXSource Source;
+		Source.TransparentColor = UI::ToU32(COLOR(0, 0, 0, 0));
+		Source.Settings =
+		{
+			.InkAlways = UI::EZXSpectrumColor::Black_,
+			.TransparentIndex = UI::EZXSpectrumColor::Transparent,
+			.ReplaceTransparent = UI::EZXSpectrumColor::Black,
+			.bMinimizeError = Options.bMinimizeError,
+		};
+
+		// the sprite name is a file name in the output directory, sources of subdirectories don't get their own
+		std::string BaseName = Job.Key.substr(0, Job.Key.rfind('.'));
+		std::replace_if(BaseName.begin(), BaseName.end(), [](char Char) { return Char == '/' || Char == '\\'; }, '_');
+		Job.Sprites = nlohmann::ordered_json::array();
+
+		const EImageFormat Format = FAppSprite::SupportImageFormat(Job.Path);
+		if (Format == EImageFormat::PNG)
+		{
+			uint8_t* ImageData = FImageBase::LoadToMemory(Job.Path, Source.Width, Source.Height);
+			ON_SCOPE_EXIT
+			{
+				FImageBase::ReleaseLoadedIntoMemory(ImageData);
+			};
+			if (ImageData == nullptr || Source.Width % 8 != 0 || Source.Height % 8 != 0 || Source.Width <= 0 || Source.Height <= 0)
+			{
+				std::cerr << std::format("[{}] the image must be loadable and a multiple of 8 pixels in size.", Job.Key) << std::endl;
+				return false;
+			}
+
+			Source.RGBA.assign(ImageData, ImageData + static_cast<size_t>(Source.Width) * Source.Height * 4);
+			return ConvertFrame(Job, Source, BaseName, INDEX_NONE, Options);
+		}
+
+		AsepriteFormat::FSprite Sprite;
+		if (!AsepriteFormat::Load(Job.Path, Sprite) || !Sprite.IsValid() || Sprite.Width % 8 != 0 || Sprite.Height % 8 != 0)
+		{
+			std::cerr << std::format("[{}] the sprite must be loadable and a multiple of 8 pixels in size.", Job.Key) << std::endl;
+			return false;
+		}
+
+		Source.Width = Sprite.Width;
+		Source.Height = Sprite.Height;
+		for (int32_t Frame = 0; Frame < Sprite.FrameCount; ++Frame)
+		{
+			Source.Frame = Frame;
+			Source.RGBA = *AsepriteFormat::GetFrameRGBA(Sprite, Frame);
+
+			// the same override files the canvas picks up
+			auto OverridePath = [&Job, Frame](const wchar_t* Extension)
+				{
+					const std::filesystem::path Path = Job.Path.parent_path() / std::format(L"{}_frame_{}{}", Job.Path.stem().wstring(), Frame, Extension);
+					return std::find(Job.Overrides.begin(), Job.Overrides.end(), Path) != Job.Overrides.end() ? Path : std::filesystem::path();
+				};
+			Source.OverridePath[EFrameZXPart::Ink] = OverridePath(L".ink");
+			Source.OverridePath[EFrameZXPart::Attribute] = OverridePath(L".attr");
+			Source.OverridePath[EFrameZXPart::Mask] = OverridePath(L".mask");
+			Source.bLayer[EFrameZXPart::Ink] = AsepriteFormat::GetLayerFrameRGBA(Sprite, Frame, Job.InkLayer, Source.LayerRGBA[EFrameZXPart::Ink]);
+			Source.bLayer[EFrameZXPart::Attribute] = AsepriteFormat::GetLayerFrameRGBA(Sprite, Frame, Job.AttributeLayer, Source.LayerRGBA[EFrameZXPart::Attribute]);
+			Source.bLayer[EFrameZXPart::Mask] = AsepriteFormat::GetLayerFrameRGBA(Sprite, Frame, Job.MaskLayer, Source.LayerRGBA[EFrameZXPart::Mask]);
+
+			if (!ConvertFrame(Job, Source, std::format("{}_{}", BaseName, Frame), Frame, Options))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	nlohmann::ordered_json LoadJson(const std::filesystem::path& FilePath, nlohmann::ordered_json Default)
+	{
+		std::ifstream In(FilePath, std::ios::binary);
+		if (!In.is_open())
+		{
+			return Default;
+		}
+
+		try
+		{
+			nlohmann::ordered_json Json;
+			In >> Json;
+			return Json.type() == Default.type() ? Json : Default;
+		}
+		catch (...)
+		{
+			return Default;
+		}
+	}
+
+	bool SaveJson(const std::filesystem::path& FilePath, const nlohmann::ordered_json& Json)
+	{
+		std::ofstream File(FilePath, std::ios::binary);
+		if (!File.is_open())
+		{
+			return false;
+		}
+		File << Json.dump(4);
+		return static_cast<bool>(File);
+	}
+}
+
+bool FAppConverter::IsRequested(const std::map<std::string, std::string>& Args)
+{
+	return Args.contains("convert");
+}
+
+bool FAppConverter::ParseArgs(const std::map<std::string, std::string>& Args, FOptions& Output)
+{
+	auto It = Args.find("convert");
+	if (It == Args.end() || It->second.empty())
+	{
+		std::cerr << "usage: -convert <input dir> [-output <dir>] [-jobs <n>] [-force] [-noPNG] [-noInk] [-noAttribute] [-noMask] [-minimizeError]" << std::endl;
+		return false;
+	}
+
+	Output.InputPath = IO::NormalizePath(std::filesystem::absolute(Utils::Utf8ToUtf16(It->second)));
+	It = Args.find("output");
+	Output.OutputPath = It != Args.end() && !It->second.empty()
+		? IO::NormalizePath(std::filesystem::absolute(Utils::Utf8ToUtf16(It->second)))
+		: Output.InputPath / "ZX";
+
+	It = Args.find("jobs");
+	if (It != Args.end() && !It->second.empty())
+	{
+		Output.Jobs = (std::max)(std::atoi(It->second.c_str()), 0);
+	}
+	Output.bForce = Args.contains("force");
+	Output.bPNG = !Args.contains("noPNG");
+	Output.bInk = !Args.contains("noInk");
+	Output.bAttribute = !Args.contains("noAttribute");
+	Output.bMask = !Args.contains("noMask");
+	Output.bMinimizeError = Args.contains("minimizeError");
+	return true;
+}
+
+int32_t FAppConverter::Run(const FOptions& Options)
+{
+	const auto StartTime = std::chrono::steady_clock::now();
+
+	std::error_code ec;
+	if (!std::filesystem::is_directory(Options.InputPath, ec))
+	{
+		std::cerr << std::format("'{}' is not a directory.", ToUtf8(Options.InputPath)) << std::endl;
+		return 1;
+	}
+
+	// every output goes right into this directory, the workers never create one themselves
+	std::filesystem::create_directories(Options.OutputPath, ec);
+	if (!std::filesystem::is_directory(Options.OutputPath, ec))
+	{
+		LOG_ERROR("[{}]\t cannot create '{}'.", (__FUNCTION__), ToUtf8(Options.OutputPath));
+		std::cerr << std::format("Cannot create '{}'.", ToUtf8(Options.OutputPath)) << std::endl;
+		return 1;
+	}
+
+	// sources and the per-frame override files next to them, the output directory is never a source
+	std::vector<FSourceJob> Jobs;
+	std::unordered_map<std::wstring, std::vector<std::filesystem::path>> Overrides;
+	for (auto It = std::filesystem::recursive_directory_iterator(Options.InputPath, std::filesystem::directory_options::skip_permission_denied, ec);
+		It != std::filesystem::recursive_directory_iterator(); It.increment(ec))
+	{
+		const std::filesystem::path& Path = It->path();
+		if (IsInside(Path, Options.OutputPath))
+		{
+			if (It->is_directory(ec))
+			{
+				It.disable_recursion_pending();
+			}
+			continue;
+		}
+		if (!It->is_regular_file(ec))
+		{
+			continue;
+		}
+
+		if (FAppSprite::SupportImageFormat(Path) != EImageFormat::None)
+		{
+			FSourceJob Job;
+			Job.Path = Path;
+			Job.Key = ToUtf8(std::filesystem::relative(Path, Options.InputPath, ec).generic_wstring());
+			Jobs.push_back(std::move(Job));
+		}
+		else if (Path.extension() == L".ink" || Path.extension() == L".attr" || Path.extension() == L".mask")
+		{
+			const std::wstring Stem = Path.stem().wstring();
+			const size_t FramePos = Stem.rfind(L"_frame_");
+			if (FramePos != std::wstring::npos)
+			{
+				Overrides[(Path.parent_path() / Stem.substr(0, FramePos)).wstring()].push_back(Path);
+			}
+		}
+	}
+	std::sort(Jobs.begin(), Jobs.end(), [](const FSourceJob& A, const FSourceJob& B) { return A.Key < B.Key; });
+
+	const std::filesystem::path ExportPath = Options.OutputPath / ExportFilename;
+	const std::filesystem::path ManifestPath = Options.OutputPath / ManifestFilename;
+	const nlohmann::ordered_json PreviousExport = LoadJson(ExportPath, nlohmann::ordered_json::array());
+	nlohmann::ordered_json Manifest = LoadJson(ManifestPath, nlohmann::ordered_json::object());
+	if (Manifest.value("Version", 0) != ManifestVersion || !Manifest.contains("Sources") || !Manifest["Sources"].is_object())
+	{
+		Manifest = { {"Version", ManifestVersion}, {"Sources", nlohmann::ordered_json::object()} };
+	}
+	const nlohmann::ordered_json& PreviousSources = Manifest["Sources"];
+
+	FHash OptionsHash;
+	OptionsHash.Update(ManifestVersion);
+	OptionsHash.Update(Options.bPNG);
+	OptionsHash.Update(Options.bInk);
+	OptionsHash.Update(Options.bAttribute);
+	OptionsHash.Update(Options.bMask);
+	OptionsHash.Update(Options.bMinimizeError);
+	OptionsHash.Update(ToUtf8(Options.OutputPath));
+	const std::string OptionsHashString = OptionsHash.ToString();
+
+	// layer assignments made in the editor are kept in Export.json
+	std::unordered_map<std::string, const nlohmann::ordered_json*> PreviousLayers;
+	for (const nlohmann::ordered_json& SpriteJson : PreviousExport)
+	{
+		if (SpriteJson.is_object() && SpriteJson.contains("InkLayer"))
+		{
+			PreviousLayers.emplace(SpriteJson.value("FileImg", std::string{}), &SpriteJson);
+		}
+	}
+
+	std::vector<FSourceJob*> DirtyJobs;
+	for (FSourceJob& Job : Jobs)
+	{
+		if (FAppSprite::SupportImageFormat(Job.Path) == EImageFormat::Aseprite)
+		{
+			auto OverrideIt = Overrides.find((Job.Path.parent_path() / Job.Path.stem()).wstring());
+			if (OverrideIt != Overrides.end())
+			{
+				Job.Overrides = OverrideIt->second;
+				std::sort(Job.Overrides.begin(), Job.Overrides.end());
+			}
+
+			auto LayerIt = PreviousLayers.find(ToUtf8(IO::NormalizePath(std::filesystem::absolute(Job.Path))));
+			if (LayerIt != PreviousLayers.end())
+			{
+				Job.InkLayer = LayerIt->second->value("InkLayer", std::string{});
+				Job.AttributeLayer = LayerIt->second->value("AttributeLayer", std::string{});
+				Job.MaskLayer = LayerIt->second->value("MaskLayer", std::string{});
+			}
+		}
+
+		Job.Stamp = MakeStamp(Job, OptionsHashString);
+		auto PreviousIt = PreviousSources.find(Job.Key);
+		if (!Options.bForce && PreviousIt != PreviousSources.end() &&
+			PreviousIt->value("Stamp", std::string{}) == Job.Stamp &&
+			PreviousIt->contains("Sprites") &&
+			OutputsExist((*PreviousIt)["Sprites"], Options.OutputPath, Options.bPNG))
+		{
+			Job.Hash = PreviousIt->value("Hash", std::string{});
+			Job.Sprites = (*PreviousIt)["Sprites"];
+			continue;
+		}
+		DirtyJobs.push_back(&Job);
+	}
+
+	// touched files are hashed first, only changed contents are converted
+	std::atomic<int32_t> NextJob = 0;
+	auto Worker = [&]()
+		{
+			for (int32_t Index = NextJob++; Index < static_cast<int32_t>(DirtyJobs.size()); Index = NextJob++)
+			{
+				FSourceJob& Job = *DirtyJobs[Index];
+				Job.Hash = HashContents(Job, OptionsHashString);
+
+				auto PreviousIt = PreviousSources.find(Job.Key);
+				if (!Options.bForce && PreviousIt != PreviousSources.end() &&
+					PreviousIt->value("Hash", std::string{}) == Job.Hash &&
+					PreviousIt->contains("Sprites") &&
+					OutputsExist((*PreviousIt)["Sprites"], Options.OutputPath, Options.bPNG))
+				{
+					Job.Sprites = (*PreviousIt)["Sprites"];
+					continue;
+				}
+
+				Job.bConverted = true;
+				Job.bFailed = !ConvertSource(Job, Options);
+			}
+		};
+
+	const int32_t Concurrency = Options.Jobs > 0 ? Options.Jobs : static_cast<int32_t>(std::thread::hardware_concurrency());
+	const int32_t ThreadCount = std::clamp(Concurrency, 1, (std::max)(static_cast<int32_t>(DirtyJobs.size()), 1));
+	std::vector<std::thread> Workers;
+	for (int32_t Index = 1; Index < ThreadCount; ++Index)
+	{
+		Workers.emplace_back(Worker);
+	}
+	Worker();
+	for (std::thread& Thread : Workers)
+	{
+		Thread.join();
+	}
+
+	int32_t ConvertedCount = 0;
+	int32_t FailedCount = 0;
+	nlohmann::ordered_json ExportJson = nlohmann::ordered_json::array();
+	nlohmann::ordered_json Sources = nlohmann::ordered_json::object();
+	for (const FSourceJob& Job : Jobs)
+	{
+		if (Job.bFailed)
+		{
+			++FailedCount;
+			continue;
+		}
+		ConvertedCount += Job.bConverted ? 1 : 0;
+
+		for (const nlohmann::ordered_json& SpriteJson : Job.Sprites)
+		{
+			ExportJson.push_back(SpriteJson);
+		}
+		Sources[Job.Key] =
+			{
+				{"Stamp", Job.Stamp},
+				{"Hash", Job.Hash},
+				{"Sprites", Job.Sprites},
+			};
+	}
+	Manifest["Sources"] = std::move(Sources);
+
+	if (!SaveJson(ExportPath, ExportJson) || !SaveJson(ManifestPath, Manifest))
+	{
+		std::cerr << std::format("Failed to write '{}'.", ToUtf8(Options.OutputPath)) << std::endl;
+		return 1;
+	}
+
+	const auto ElapsedTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - StartTime);
+	std::cout << std::format("{} sources: {} converted, {} up to date, {} failed ({} ms, {} threads).",
+		Jobs.size(),
+		ConvertedCount,
+		static_cast<int32_t>(Jobs.size()) - ConvertedCount - FailedCount,
+		FailedCount,
+		ElapsedTime.count(),
+		ThreadCount) << std::endl;
+	return FailedCount > 0 ? 1 : 0;
+}
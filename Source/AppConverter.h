@@ -0,0 +1,31 @@
+#pragma once
+
+#include <map>
+#include <CoreMinimal.h>
+
+// headless conversion of a directory of *.png/*.aseprite files into ZX data (-convert)
+//
+// ZX-Debugger.exe -convert <input dir> [-output <dir>] [-jobs <n>] [-force] [-noPNG] [-noInk] [-noAttribute] [-noMask] [-minimizeError]
+//
+// writes the same Export.json as the sprite list and keeps a manifest of content hashes next to it,
+// sources whose contents, overrides and options didn't change since the previous run are skipped
+class FAppConverter
+{
+public:
+	struct FOptions
+	{
+		std::filesystem::path InputPath;
+		std::filesystem::path OutputPath;
+		int32_t Jobs = 0;			// 0 - all cores
+		bool bForce = false;		// ignore the manifest
+		bool bPNG = true;
+		bool bInk = true;
+		bool bAttribute = true;
+		bool bMask = true;
+		bool bMinimizeError = false;
+	};
+
+	static bool IsRequested(const std::map<std::string, std::string>& Args);
+	static bool ParseArgs(const std::map<std::string, std::string>& Args, FOptions& Output);
+	static int32_t Run(const FOptions& Options);
+};
@@ -9,9 +9,13 @@
 #include "Devices/ControlUnit/AccessToROM.h"
 #include "Devices/Memory/EPROM.h"
 #include "Devices/Memory/DRAM.h"
+#include "Devices/IO/Tape.h"
+#include "Devices/IO/Keyboard.h"
+#include "Devices/IO/Beeper.h"
 #include "Motherboard/Motherboard.h"
 #include "Motherboard/Motherboard_Board.h"
 #include <Version.h>
+#include <Core/Audio.h>
 #include <Core/Fonts.h>
 #include <Core/Image.h>
 
@@ -38,76 +42,25 @@ void FAppDebugger::Initialize()
 	FImageBase& Images = FImageBase::Get();
 	Images.Initialize(Device, DeviceContext);
 
+	// the backend drains the ring of the beeper from its own thread
+	std::shared_ptr<FBeeper> Beeper = std::make_shared<FBeeper>(3.5_MHz);
+	if (AudioFile.empty())
+	{
+		AudioBackend = std::make_shared<FAudioBackend_WaveOut>();
+	}
+	else
+	{
+		AudioBackend = std::make_shared<FAudioBackend_WaveFile>(AudioFile);
+	}
+	Beeper->SetRateControl(AudioBackend->IsRealTime());
+	Beeper->SetLossless(!AudioBackend->IsRealTime());
+	AudioBackend->Start(Beeper->GetRing(), Beeper->GetSampleRate());
+
 	Motherboard = std::make_shared<FMotherboard>();
 	if (Motherboard)
 	{
 		Motherboard->Initialize();
-		Motherboard->AddBoard(MainBoardName, EName::MainBoard,
-		{
-			std::make_shared<FCPU_Z80>(3.5_MHz),
-			std::make_shared<FULA>(FDisplayCycles{
-				/*FlybackH*/96, /*BorderL*/32, /*DisplayH*/256, /*BorderR*/64,
-				/*FlybackV*/8, /*BorderT*/56, /*DisplayV*/192, /*BorderB*/56}, 7.0_MHz),
-			std::make_shared<FAccessToROM>(),
-			std::make_shared<FEPROM>(EEPROM_Type::EPROM_27C128, 0x0000, std::vector<uint8_t>({ 
-				0x00,
-				0x01, 0x002, 0x03,
-				0x02,
-				0x03,
-				0x04,
-				0x05,
-				0x06, 0x05,
-				0x07,
-				0x08,
-				0x09,
-				0x0a,
-				0x0b,
-				0x0c,
-				0x0d,
-				0x0e, 0xaa,
-				0x0f,
-				0x10, 0xfd,
-				0x11, 0xdd, 0xee,
-				0x12,
-				0x13,
-				0x14,
-				0x15,
-				0x16, 0x04,
-				0x17,
-				0x18, 0x00,
-				0x19,
-				0x1a,
-				0x1b,
-				0x1c,
-				0x1d,
-				0x1e, 0xfa,
-				0x1f,
-				0x20, 0x00,
-				0x21, 0x20, 0xfd,
-				0x22, 0x28, 0x00,
-				0x23,
-				0x24,
-				0x25,
-				0x26, 0x45,
-				0x27,
-				0x28, 0xFD,
-				0x29,
-				0x2a, 0x01, 0x00,
-				0x2b,
-				0x2c,
-				0x2d,
-				0x2e, 0x66,
-				0x2f,
-				0x30, 0x00,
-				0x31, 0x00, 0x00,
-				0x32, 0x00, 0x00,
-				0x33,
-				0x34,
-				0x37,
-				0x18, 0xaf
-				}), ESignalState::Low),
-			std::make_shared<FDRAM>(EDRAM_Type::DRAM_4116, 0x4000, std::vector<uint8_t>({1,2,3,4,5,6,7,8})),
-		}, 7.0_MHz);
+		CreateMainBoard(*Motherboard, Beeper);
 
 		// load ROM
 		//std::filesystem::path FIlePath = "D:\\Work\\Learning\\Emulator\\Rom\\pentagon.rom";// std::filesystem::current_path();
@@ -119,6 +72,10 @@ void FAppDebugger::Initialize()
 		Motherboard->LoadRawData(NAME_MainBoard, NAME_DRAM, FIlePath);
 
 		Motherboard->Reset();
+		if (!StartupSnapshot.empty())
+		{
+			Motherboard->LoadSnapshot(NAME_MainBoard, StartupSnapshot);
+		}
 	}
 
 	Viewer = std::make_shared<SViewer>(NAME_DOS_12, FrameworkConfig.WindowWidth, FrameworkConfig.WindowHeight);
@@ -147,12 +104,19 @@ void FAppDebugger::Shutdown()
 		Viewer.reset();
 	}
 
+	// the ring belongs to the beeper of the board, the board stops first so nothing waits for the room in the ring
 	if (Motherboard)
 	{
 		Motherboard->Shutdown();
-		Motherboard.reset();
 	}
 
+	if (AudioBackend)
+	{
+		AudioBackend->Stop();
+		AudioBackend.reset();
+	}
+	Motherboard.reset();
+
 	FFonts::Get().Reset();
 	LOG("Shutdown 'Debugger' application.");
 	FAppFramework::Shutdown();
@@ -187,6 +151,79 @@ bool FAppDebugger::IsOver()
 	return Viewer ? !Viewer->IsOpen() : true;
 }
 
+void FAppDebugger::CreateMainBoard(FMotherboard& Motherboard, std::shared_ptr<FBeeper> Beeper)
+{
+	Motherboard.AddBoard(MainBoardName, EName::MainBoard,
+	{
+		std::make_shared<FCPU_Z80>(3.5_MHz),
+		std::make_shared<FULA>(FDisplayCycles{
+			/*FlybackH*/96, /*BorderL*/32, /*DisplayH*/256, /*BorderR*/64,
+			/*FlybackV*/8, /*BorderT*/56, /*DisplayV*/192, /*BorderB*/56}, 7.0_MHz),
+		std::make_shared<FAccessToROM>(),
+		std::make_shared<FEPROM>(EEPROM_Type::EPROM_27C128, 0x0000, std::vector<uint8_t>({ 
+			0x00,
+			0x01, 0x002, 0x03,
+			0x02,
+			0x03,
+			0x04,
+			0x05,
+			0x06, 0x05,
+			0x07,
+			0x08,
+			0x09,
+			0x0a,
+			0x0b,
+			0x0c,
+			0x0d,
+			0x0e, 0xaa,
+			0x0f,
+			0x10, 0xfd,
+			0x11, 0xdd, 0xee,
+			0x12,
+			0x13,
+			0x14,
+			0x15,
+			0x16, 0x04,
+			0x17,
+			0x18, 0x00,
+			0x19,
+			0x1a,
+			0x1b,
+			0x1c,
+			0x1d,
+			0x1e, 0xfa,
+			0x1f,
+			0x20, 0x00,
+			0x21, 0x20, 0xfd,
+			0x22, 0x28, 0x00,
+			0x23,
+			0x24,
+			0x25,
+			0x26, 0x45,
+			0x27,
+			0x28, 0xFD,
+			0x29,
+			0x2a, 0x01, 0x00,
+			0x2b,
+			0x2c,
+			0x2d,
+			0x2e, 0x66,
+			0x2f,
+			0x30, 0x00,
+			0x31, 0x00, 0x00,
+			0x32, 0x00, 0x00,
+			0x33,
+			0x34,
+			0x37,
+			0x18, 0xaf
+			}), ESignalState::Low),
+		std::make_shared<FDRAM>(EDRAM_Type::DRAM_4116, 0x4000, std::vector<uint8_t>({1,2,3,4,5,6,7,8})),
+		std::make_shared<FTape>(3.5_MHz),
+		std::make_shared<FKeyboard>(3.5_MHz),
+		Beeper,
+	}, 7.0_MHz);
+}
+
 void FAppDebugger::LoadIniSettings()
 {
 	const char* DefaultIni = R"(
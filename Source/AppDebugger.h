@@ -8,7 +8,11 @@ class SCallStack;
 class SCPU_State;
 class SMemoryDump;
 class SDisassembler;
+class STraceViewer;
+class STapeRecorder;
 class FMotherboard;
+class FBeeper;
+class IAudioBackend;
 
 class FAppDebugger : public FAppFramework
 {
@@ -18,6 +22,8 @@ class FAppDebugger : public FAppFramework
 	friend SCPU_State;
 	friend SMemoryDump;
 	friend SDisassembler;
+	friend STraceViewer;
+	friend STapeRecorder;
 
 public:
 	FAppDebugger();
@@ -31,9 +37,20 @@ public:
 
 	//const FName& GetFont();
 
+	// the session starts from the snapshot instead of the ROM boot
+	void SetStartupSnapshot(const std::filesystem::path& FilePath) { StartupSnapshot = FilePath; }
+	// the sound goes to the .wav file instead of the sound card
+	void SetAudioFile(const std::filesystem::path& FilePath) { AudioFile = FilePath; }
+
+	// the devices of the main board, the headless runs build the same machine
+	static void CreateMainBoard(FMotherboard& Motherboard, std::shared_ptr<FBeeper> Beeper);
+
 private:
 	void LoadIniSettings();
 
 	std::shared_ptr<SViewer> Viewer;
 	std::shared_ptr<FMotherboard> Motherboard;
+	std::shared_ptr<IAudioBackend> AudioBackend;
+	std::filesystem::path StartupSnapshot;
+	std::filesystem::path AudioFile;
 };
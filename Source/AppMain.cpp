@@ -73,8 +73,18 @@ void FAppMain::LoadSettings()
 	if (LogOptional.has_value())
 	{
 		FrameworkConfig.bLog = LogOptional.value();
+		if (FrameworkConfig.bLog)
+		{
+			Utils::SetLogFile(FAppFramework::GetPath(EPathType::Log) / GetFilename(EFilenameType::Log));
+		}
 		LOG("[*] enable logging.");
 	}
+	auto LogVerbosityOptional = Settings.GetValue<std::string>({ ConfigTag_LogVerbosity, typeid(std::string) });
+	if (LogVerbosityOptional.has_value())
+	{
+		Utils::ParseLogVerbosity(*LogVerbosityOptional);
+		LOG("[*] set log verbosity: {}.", *LogVerbosityOptional);
+	}
 	auto ResolutionOptional = Settings.GetValue<std::string>({ ConfigTag_Resolution, typeid(std::string) });
 	if (ResolutionOptional.has_value())
 	{
@@ -126,6 +136,7 @@ std::string_view FAppMain::GetDefaultConfig()
 {
     "Resolution": "1024x768",
     "bLog": true,
+    "LogVerbosity": "Emulation=Log, Device=Log",
     "bDontAskMeNextTime_Quit": false,
     "bFullscreen": false,
     "Application": "None",
@@ -0,0 +1,109 @@
+#include "AppReplay.h"
+#include <AppDebugger.h>
+#include <Utils/IO.h>
+#include <Core/Audio.h>
+#include <chrono>
+
+#include "Devices/IO/Beeper.h"
+#include "Motherboard/Motherboard.h"
+
+namespace
+{
+	static constexpr uint32_t PollTime = 50;		// ms between the status requests
+
+	std::string ToUtf8(const std::filesystem::path& Path)
+	{
+		return Utils::Utf16ToUtf8(Path.wstring());
+	}
+}
+
+bool FAppReplay::IsRequested(const std::map<std::string, std::string>& Args)
+{
+	return Args.contains("replay");
+}
+
+bool FAppReplay::ParseArgs(const std::map<std::string, std::string>& Args, FOptions& Output)
+{
+	auto It = Args.find("replay");
+	if (It == Args.end() || It->second.empty())
+	{
+		std::cerr << "usage: -replay <recording.zxr> [-hashes <file>] [-wav <file>]" << std::endl;
+		return false;
+	}
+
+	Output.FilePath = IO::NormalizePath(std::filesystem::absolute(Utils::Utf8ToUtf16(It->second)));
+	It = Args.find("hashes");
+	if (It != Args.end() && !It->second.empty())
+	{
+		Output.HashPath = IO::NormalizePath(std::filesystem::absolute(Utils::Utf8ToUtf16(It->second)));
+	}
+	It = Args.find("wav");
+	if (It != Args.end() && !It->second.empty())
+	{
+		Output.AudioPath = IO::NormalizePath(std::filesystem::absolute(Utils::Utf8ToUtf16(It->second)));
+	}
+	return true;
+}
+
+int32_t FAppReplay::Run(const FOptions& Options)
+{
+	const auto StartTime = std::chrono::steady_clock::now();
+
+	std::error_code ec;
+	if (!std::filesystem::is_regular_file(Options.FilePath, ec))
+	{
+		std::cerr << std::format("'{}' is not a file.", ToUtf8(Options.FilePath)) << std::endl;
+		return 1;
+	}
+
+	// without the file nobody listens and the samples of the beeper are dropped,
+	// with it every frame is kept and the replay goes no faster than the file is written
+	std::shared_ptr<FBeeper> Beeper = std::make_shared<FBeeper>(3.5_MHz);
+	std::shared_ptr<IAudioBackend> AudioBackend;
+	if (!Options.AudioPath.empty())
+	{
+		AudioBackend = std::make_shared<FAudioBackend_WaveFile>(Options.AudioPath);
+		if (!AudioBackend->Start(Beeper->GetRing(), Beeper->GetSampleRate()))
+		{
+			std::cerr << std::format("'{}' can't be written.", ToUtf8(Options.AudioPath)) << std::endl;
+			return 1;
+		}
+		Beeper->SetLossless(true);
+	}
+
+	FMotherboard Motherboard;
+	Motherboard.Initialize();
+	FAppDebugger::CreateMainBoard(Motherboard, Beeper);
+	Motherboard.SetThrottle(false);
+	Motherboard.Reset();
+	Motherboard.StartInputReplay(NAME_MainBoard, Options.FilePath, Options.HashPath);
+
+	// the requests are answered in their order, the replay is on from the first answer until it reaches the end
+	FInputLogStatus Status;
+	do
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(PollTime));
+		Status = Motherboard.GetState<FInputLogStatus>(NAME_MainBoard, NAME_None);
+	} while (Status.bReplaying);
+	Motherboard.Shutdown();
+
+	// the ring belongs to the beeper, the board is stopped so the rest of it is drained
+	if (AudioBackend)
+	{
+		AudioBackend->Stop();
+	}
+
+	if (Status.FrameCount == 0)
+	{
+		std::cerr << std::format("'{}' wasn't replayed.", ToUtf8(Options.FilePath)) << std::endl;
+		return 1;
+	}
+
+	const auto ElapsedTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - StartTime);
+	std::cout << std::format("{}: {} frames, hash {:016X} ({} ms).",
+		ToUtf8(Options.FilePath),
+		Status.FrameCount,
+		Status.Hash,
+		ElapsedTime.count()) << std::endl;
+	return 0;
+}
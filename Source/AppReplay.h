@@ -0,0 +1,26 @@
+#pragma once
+
+#include <map>
+#include <CoreMinimal.h>
+
+// headless replay of a keyboard input recording (-replay)
+//
+// ZX-Debugger.exe -replay <recording.zxr> [-hashes <file>] [-wav <file>]
+//
+// the main board runs unthrottled from the state of the recording and gets the keys on their recorded clocks,
+// the display data is hashed at every frame interrupt; the hash of a run is printed, the hashes per frame go to the file,
+// the sound of every frame goes to the .wav file
+class FAppReplay
+{
+public:
+	struct FOptions
+	{
+		std::filesystem::path FilePath;
+		std::filesystem::path HashPath;
+		std::filesystem::path AudioPath;
+	};
+
+	static bool IsRequested(const std::map<std::string, std::string>& Args);
+	static bool ParseArgs(const std::map<std::string, std::string>& Args, FOptions& Output);
+	static int32_t Run(const FOptions& Options);
+};
@@ -169,13 +169,9 @@ FAppSprite::FAppSprite()
 	, bCodeGenerationApplyWindowSize(false)
 	, bCodeGenerationPreviewValid(false)
 	, bCodeGenerationCodeWindowSizeInitialized(false)
-	, bCodeGenerationGenerationInProgress(false)
 	, bCodeGenerationProgressModalOpen(false)
 	, bCodeGenerationProgressShouldClose(false)
 	, bCodeGenerationLogScrollToBottom(false)
-	, bCodeGenerationCancelRequested(false)
-	, CodeGenerationProgressCurrent(0)
-	, CodeGenerationProgressTotal(0)
 	, ExportCounter(0)
 	, CodeGenerationWindowHeight(0.0f)
 	, NewOutputFileNameBuffer{}
@@ -375,11 +371,9 @@ bool FAppSprite::Import_Image(
 
 void FAppSprite::Shutdown()
 {
-	bCodeGenerationCancelRequested.store(true, std::memory_order_relaxed);
-	if (CodeGenerationWorker.joinable())
-	{
-		CodeGenerationWorker.join();
-	}
+	CodeGenerationJob.Cancel();
+	CodeGenerationJob.Wait();
+	CodeGenerationJob.Reset();
 
 	if (Viewer)
 	{
@@ -405,8 +399,6 @@ void FAppSprite::Tick(float DeltaTime)
 	{
 		Viewer->Tick(DeltaTime);
 	}
-
-	PollCodeGenerationPreviewJob();
 }
 
 void FAppSprite::Render()
@@ -1274,6 +1266,43 @@ bool FAppSprite::Show_WindowgCodeGeneration()
 			bOptionsChanged = true;
 		}
 		DrawLastItemTooltip("Лимит проверки нелинейных паттернов за один шаг поиска.\nЭто вертикали, стековые блоки, повторы и другие варианты, которые конкурируют с линейной записью.");
+		ImGui::TextUnformatted("Planner");
+		ImGui::SameLine();
+		if (ImGui::RadioButton("Beam", CodeGenerationOptions.Planner == CodeGenerator::EPlanner::Beam))
+		{
+			CodeGenerationOptions.Planner = CodeGenerator::EPlanner::Beam;
+			bOptionsChanged = true;
+		}
+		DrawLastItemTooltip("Быстрый поиск лучом: хороший план за миллисекунды, но без гарантии минимума.");
+		ImGui::SameLine();
+		if (ImGui::RadioButton("Exact", CodeGenerationOptions.Planner == CodeGenerator::EPlanner::Exact))
+		{
+			CodeGenerationOptions.Planner = CodeGenerator::EPlanner::Exact;
+			bOptionsChanged = true;
+		}
+		DrawLastItemTooltip("Точный перебор с отсечением для небольших dirty-областей.\nСтартует с плана луча и ищет дешевле; при превышении бюджета времени остаётся лучший найденный план.");
+		if (CodeGenerationOptions.Planner != CodeGenerator::EPlanner::Exact)
+		{
+			ImGui::BeginDisabled();
+		}
+		ImGui::SetNextItemWidth(InputNumberWidth);
+		if (ImGui::InputInt("Exact max dirty bytes", &CodeGenerationOptions.ExactPlannerMaxDirtyBytes))
+		{
+			CodeGenerationOptions.ExactPlannerMaxDirtyBytes = ImClamp(CodeGenerationOptions.ExactPlannerMaxDirtyBytes, 1, CodeGenerator::ZX_SCREEN_SIZE);
+			bOptionsChanged = true;
+		}
+		DrawLastItemTooltip("Точный планировщик запускается, только если dirty-байтов не больше этого значения.\nИначе используется обычный поиск лучом.");
+		ImGui::SetNextItemWidth(InputNumberWidth);
+		if (ImGui::InputInt("Exact time budget, ms", &CodeGenerationOptions.ExactPlannerTimeBudgetMs))
+		{
+			CodeGenerationOptions.ExactPlannerTimeBudgetMs = ImClamp(CodeGenerationOptions.ExactPlannerTimeBudgetMs, 1, 60000);
+			bOptionsChanged = true;
+		}
+		DrawLastItemTooltip("Ограничение времени точного перебора.\nЕсли перебор не успел завершиться, минимальность плана не доказана.");
+		if (CodeGenerationOptions.Planner != CodeGenerator::EPlanner::Exact)
+		{
+			ImGui::EndDisabled();
+		}
 		CheckboxWithTooltip(
 			"Preserve SP",
 			&CodeGenerationOptions.PreserveSP,
@@ -1337,6 +1366,8 @@ bool FAppSprite::Show_WindowgCodeGeneration()
 		CodeGenerationOptions.MaxStackPairsToEnumerate = ImClamp(CodeGenerationOptions.MaxStackPairsToEnumerate, 2, 256);
 		CodeGenerationOptions.NonLinearBeamWidth = ImClamp(CodeGenerationOptions.NonLinearBeamWidth, 1, 32);
 		CodeGenerationOptions.MaxNonLinearCandidatesToEvaluatePerPass = ImClamp(CodeGenerationOptions.MaxNonLinearCandidatesToEvaluatePerPass, 1, 1024);
+		CodeGenerationOptions.ExactPlannerMaxDirtyBytes = ImClamp(CodeGenerationOptions.ExactPlannerMaxDirtyBytes, 1, CodeGenerator::ZX_SCREEN_SIZE);
+		CodeGenerationOptions.ExactPlannerTimeBudgetMs = ImClamp(CodeGenerationOptions.ExactPlannerTimeBudgetMs, 1, 60000);
 		CodeGenerationOptions.CycleWeight = ImMax(CodeGenerationOptions.CycleWeight, 1LL);
 		CodeGenerationOptions.ByteWeight = ImMax(CodeGenerationOptions.ByteWeight, 1LL);
 		CodeGenerationOptions.DestinationX = ImClamp(CodeGenerationOptions.DestinationX, 0, 255);
@@ -1347,7 +1378,7 @@ bool FAppSprite::Show_WindowgCodeGeneration()
 			CodeGenerationOptions.ScreenBaseAddress = CodeGenerator::ZX_SCREEN_BASE;
 		}
 		ImGui::Dummy(ImVec2(0.0f, TextHeight * 0.35f));
-		const bool bGenerationInProgress = bCodeGenerationGenerationInProgress.load(std::memory_order_relaxed);
+		const bool bGenerationInProgress = CodeGenerationJob.IsValid();
 		const bool bGenerationBusy = bGenerationInProgress || bCodeGenerationProgressModalOpen || bCodeGenerationProgressShouldClose;
 		const char* GenerateButtonLabel = bGenerationBusy ? "Generating..." : (bCodeGenerationPreviewValid ? "Refresh" : "Generate");
 		if (!bGenerationBusy && ImGui::Button(GenerateButtonLabel, ImVec2(RefreshButtonWidth, TextHeight * 1.5f)))
@@ -1487,7 +1518,7 @@ bool FAppSprite::Show_WindowgCodeGeneration()
 
 void FAppSprite::StartCodeGenerationPreview()
 {
-	if (bCodeGenerationGenerationInProgress.load(std::memory_order_relaxed))
+	if (CodeGenerationJob.IsValid())
 	{
 		return;
 	}
@@ -1505,8 +1536,6 @@ void FAppSprite::StartCodeGenerationPreview()
 	CodeGenerationJobResult = CodeGenerator::FResult();
 	bCodeGenerationPreviewValid = false;
 	bCodeGenerationProgressShouldClose = false;
-	CodeGenerationProgressCurrent.store(0, std::memory_order_relaxed);
-	CodeGenerationProgressTotal.store(100, std::memory_order_relaxed);
 
 	AppendLogLine("Generating source code...");
 
@@ -1521,29 +1550,26 @@ void FAppSprite::StartCodeGenerationPreview()
 	Utils::CopyToBuffer(NewOutputFileNameBuffer, sizeof(NewOutputFileNameBuffer), Utils::Utf16ToUtf8(MakeFrameOutputFileName(Canvas->GetWindowWName(), FrameIndex, bCodeGenerationGenerateOpcode)));
 	Utils::CopyToBuffer(CodeGenerationLabelNameBuffer, sizeof(CodeGenerationLabelNameBuffer), CodeGenerator::MakeFrameLabelName(FrameIndex));
 
-	if (CodeGenerationWorker.joinable())
-	{
-		CodeGenerationWorker.join();
-	}
-
-	bCodeGenerationCancelRequested.store(false, std::memory_order_relaxed);
-	bCodeGenerationGenerationInProgress.store(true, std::memory_order_relaxed);
 	bCodeGenerationProgressModalOpen = true;
 
 	CodeGenerator::FOptions Options = CodeGenerationOptions;
 	Options.OutputOpcodes = bCodeGenerationGenerateOpcode;
 	const std::string LabelName = CodeGenerationLabelNameBuffer;
-	CodeGenerationWorker = std::thread(
-		[this, Canvas, Options, LabelName]()
+	CodeGenerationJob = FJobSystem::Get().Submit("Code generation",
+		[this, Canvas, Options, LabelName](FJobContext& Context)
 		{
 			CodeGenerator::FProgressInfo Progress;
-			Progress.CancelRequested = &bCodeGenerationCancelRequested;
-			Progress.Current = &CodeGenerationProgressCurrent;
-			Progress.Total = &CodeGenerationProgressTotal;
+			Progress.CancelRequested = &Context.bCancelRequested;
+			Progress.Current = &Context.ProgressCurrent;
+			Progress.Total = &Context.ProgressTotal;
 
 			CodeGenerationJobResult = Canvas->BuildCodeGenerationResult(Options, LabelName, &Progress);
-			bCodeGenerationGenerationInProgress.store(false, std::memory_order_relaxed);
-		});
+		},
+		[this](const FJobHandle& Job)
+		{
+			CompleteCodeGenerationPreviewJob(Job);
+		},
+		EJobPriority::High);
 }
 
 void FAppSprite::RefreshCodeGenerationPreview()
@@ -1551,19 +1577,9 @@ void FAppSprite::RefreshCodeGenerationPreview()
 	StartCodeGenerationPreview();
 }
 
-void FAppSprite::PollCodeGenerationPreviewJob()
+void FAppSprite::CompleteCodeGenerationPreviewJob(const FJobHandle& Job)
 {
-	if (bCodeGenerationGenerationInProgress.load(std::memory_order_relaxed))
-	{
-		return;
-	}
-
-	if (!CodeGenerationWorker.joinable())
-	{
-		return;
-	}
-
-	CodeGenerationWorker.join();
+	CodeGenerationJob.Reset();
 
 	auto AppendLogLine = [this](const std::string& Line)
 	{
@@ -1577,7 +1593,7 @@ void FAppSprite::PollCodeGenerationPreviewJob()
 
 	if (!CodeGenerationJobResult.bSuccess)
 	{
-		if (bCodeGenerationCancelRequested.load(std::memory_order_relaxed))
+		if (Job.IsCancelRequested())
 		{
 			AppendLogLine("Cancelled.");
 		}
@@ -1595,6 +1611,14 @@ void FAppSprite::PollCodeGenerationPreviewJob()
 		AppendLogLine(std::format("Opcode size: {} bytes", CodeGenerationOpcodeBytes.size()));
 		AppendLogLine(std::format("Score weights: cycles={}, bytes={}", CodeGenerationOptions.CycleWeight, CodeGenerationOptions.ByteWeight));
 		AppendLogLine(std::format("Search: beam={}, probe limit={}", CodeGenerationOptions.NonLinearBeamWidth, CodeGenerationOptions.MaxNonLinearCandidatesToEvaluatePerPass));
+		if (CodeGenerationOptions.Planner == CodeGenerator::EPlanner::Exact)
+		{
+			AppendLogLine(std::format("Planner: exact ({}{}), max dirty={}, budget={} ms",
+				CodeGenerationJobResult.bPlanExact ? "optimal" : "not proven",
+				CodeGenerationJobResult.bPlanExactImproved ? ", improved beam" : "",
+				CodeGenerationOptions.ExactPlannerMaxDirtyBytes,
+				CodeGenerationOptions.ExactPlannerTimeBudgetMs));
+		}
 		AppendLogLine(std::format("Screen target: 0x{:04X}..0x{:04X}",
 			CodeGenerationOptions.ScreenBaseAddress,
 			static_cast<uint16_t>(CodeGenerationOptions.ScreenBaseAddress + CodeGenerator::ZX_SCREEN_SIZE - 1)));
@@ -1628,6 +1652,16 @@ void FAppSprite::PollCodeGenerationPreviewJob()
 			CodeGenerationOptions.EnableVerticalCandidates ? "on" : "off",
 			CodeGenerationOptions.EnableReverseDirections ? "on" : "off",
 			CodeGenerationOptions.EnableRegisterConstants ? "on" : "off"));
+		if (CodeGenerationJobResult.bAnalysisCacheHit)
+		{
+			AppendLogLine("Analysis cache: hit");
+		}
+		else
+		{
+			AppendLogLine(std::format("Analysis cache: {} regions reused, {} rebuilt",
+				CodeGenerationJobResult.AnalysisReusedRegions,
+				CodeGenerationJobResult.AnalysisRebuiltRegions));
+		}
 		AppendLogLine(std::format("Dirty bytes: {}", CodeGenerationJobResult.DirtyBytes));
 		AppendLogLine(std::format("Operations: {}", CodeGenerationJobResult.OperationCount));
 		AppendLogLine(std::format("Estimated cycles: {}", CodeGenerationJobResult.Cycles));
@@ -1645,7 +1679,7 @@ void FAppSprite::PollCodeGenerationPreviewJob()
 
 bool FAppSprite::ShowModal_CodeGenerationProgress()
 {
-	if (!bCodeGenerationProgressModalOpen && !bCodeGenerationGenerationInProgress.load(std::memory_order_relaxed) && !bCodeGenerationProgressShouldClose)
+	if (!bCodeGenerationProgressModalOpen && !CodeGenerationJob.IsValid() && !bCodeGenerationProgressShouldClose)
 	{
 		return false;
 	}
@@ -1678,15 +1712,15 @@ bool FAppSprite::ShowModal_CodeGenerationProgress()
 	const bool bVisible = ImGui::Begin(Modal_CodeGenerationProgressName, nullptr, WindowFlags);
 	if (bVisible)
 	{
-		const int32_t Current = CodeGenerationProgressCurrent.load(std::memory_order_relaxed);
-		const int32_t Total = ImMax(CodeGenerationProgressTotal.load(std::memory_order_relaxed), 1);
+		const int32_t Current = CodeGenerationJob.GetProgressCurrent();
+		const int32_t Total = ImMax(CodeGenerationJob.GetProgressTotal(), 1);
 		const float Fraction = ImClamp(static_cast<float>(Current) / static_cast<float>(Total), 0.0f, 1.0f);
 
 		ImGui::TextUnformatted("Generating code...");
 		ImGui::ProgressBar(Fraction, ImVec2(320.0f, 0.0f));
 		ImGui::Text("%d / %d", Current, Total);
 
-		if (bCodeGenerationCancelRequested.load(std::memory_order_relaxed))
+		if (CodeGenerationJob.IsCancelRequested())
 		{
 			ImGui::TextUnformatted("Cancelling...");
 		}
@@ -1695,11 +1729,11 @@ bool FAppSprite::ShowModal_CodeGenerationProgress()
 			ImGui::TextUnformatted("Press Cancel to stop the current generation.");
 		}
 
-		if (!bCodeGenerationCancelRequested.load(std::memory_order_relaxed))
+		if (!CodeGenerationJob.IsCancelRequested())
 		{
 			if (ImGui::Button("Cancel", ImVec2(120.0f, 0.0f)))
 			{
-				bCodeGenerationCancelRequested.store(true, std::memory_order_relaxed);
+				CodeGenerationJob.Cancel();
 			}
 		}
 		else
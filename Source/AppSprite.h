@@ -2,6 +2,7 @@
 
 #include <atomic>
 #include <Core/AppFramework.h>
+#include <Core/JobSystem.h>
 #include <Core/ViewerBase.h>
 #include <Utils/6912/CodeGenerator.h>
 #include <mutex>
@@ -132,7 +133,7 @@ private:
 	bool HasCanvasWithTimeline() const;
 	void RefreshCodeGenerationPreview();
 	void StartCodeGenerationPreview();
-	void PollCodeGenerationPreviewJob();
+	void CompleteCodeGenerationPreviewJob(const FJobHandle& Job);
 	bool ExportCodeGenerationPreview();
 
 	std::shared_ptr<SCanvas> GetActiveCanvas();
@@ -170,13 +171,9 @@ private:
 	bool bCodeGenerationApplyWindowSize;
 	bool bCodeGenerationPreviewValid;
 	bool bCodeGenerationCodeWindowSizeInitialized;
-	std::atomic<bool> bCodeGenerationGenerationInProgress;
 	bool bCodeGenerationProgressModalOpen;
 	bool bCodeGenerationProgressShouldClose;
 	bool bCodeGenerationLogScrollToBottom;
-	std::atomic<bool> bCodeGenerationCancelRequested;
-	std::atomic<int32_t> CodeGenerationProgressCurrent;
-	std::atomic<int32_t> CodeGenerationProgressTotal;
 	int32_t ExportCounter;
 	float CodeGenerationWindowHeight;
 	char NewOutputFileNameBuffer[BUFFER_SIZE_INPUT];
@@ -187,7 +184,7 @@ private:
 	std::string CodeGenerationPreviewText;
 	std::string CodeGenerationLogText;
 	std::vector<uint8_t> CodeGenerationOpcodeBytes;
-	std::thread CodeGenerationWorker;
+	FJobHandle CodeGenerationJob;	// valid until the completion has run
 	CodeGenerator::FResult CodeGenerationJobResult;
 
 	std::shared_ptr<SViewerBase> Viewer;
@@ -1,4 +1,5 @@
 #include "AppFramework.h"
+#include "JobSystem.h"
 
 #include <iostream>
 #include <shellapi.h>
@@ -20,10 +21,12 @@ namespace Filename
 {
 	static const char* Ini = "imgui.ini";
 	static const char* Settings = "Settings.cfg";
+	static const char* Log = "ZX-Debugger.log";
 }
 
 const char* FAppFramework::ConfigTag_Resolution = "Resolution";
 const char* FAppFramework::ConfigTag_Log = "bLog";
+const char* FAppFramework::ConfigTag_LogVerbosity = "LogVerbosity";
 const char* FAppFramework::ConfigTag_Fullscreen = "bFullscreen";
 const char* FAppFramework::ConfigTag_Application = "Application";
 const char* FAppFramework::ConfigTag_DontAskMeNextTime_Quit = "bDontAskMeNextTime_Quit";
@@ -172,6 +175,8 @@ std::string_view FAppFramework::GetFilename(EFilenameType Filename)
 		return Filename::Ini;
 	case EFilenameType::Config:
 		return Filename::Settings;
+	case EFilenameType::Log:
+		return Filename::Log;
 	}
 	return "";
 }
@@ -265,6 +270,7 @@ void FAppFramework::Initialize()
 
 void FAppFramework::Shutdown()
 {
+	FJobSystem::Get().Shutdown();
 	ShutdownGUI();
 	DestroyWindow(hwndAppFramework);
 	Release();
@@ -415,6 +421,8 @@ void FAppFramework::Idle()
 	const float DeltaTime = (float)Time.TimeBetweenTicks(OldTime, CurrentTime);
 	OldTime = CurrentTime;
 
+	// completions of the background jobs run before the application sees the frame
+	FJobSystem::Get().Tick();
 	Tick(DeltaTime);
 
 	// prepare ImGui frame
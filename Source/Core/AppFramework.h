@@ -52,6 +52,7 @@ public:
 
 	static const char* ConfigTag_Resolution;
 	static const char* ConfigTag_Log;
+	static const char* ConfigTag_LogVerbosity;
 	static const char* ConfigTag_Fullscreen;
 	static const char* ConfigTag_Application;
 	static const char* ConfigTag_DontAskMeNextTime_Quit;
@@ -0,0 +1,231 @@
+#include "Audio.h"
+
+#pragma comment(lib, "winmm.lib")
+
+namespace
+{
+	static constexpr uint32_t WaveOutBufferTime = 10;			// ms per queued buffer
+	static constexpr uint32_t WaveFileDrainTime = 10;			// ms between the writes of the file
+	static constexpr uint32_t WaveFileBusyDrainTime = 1;		// ms while the samples keep coming faster than real time
+	static constexpr uint32_t WaveHeaderSize = 44;
+
+	WAVEFORMATEX MakeFormat(uint32_t SampleRate)
+	{
+		WAVEFORMATEX Format = {};
+		Format.wFormatTag = WAVE_FORMAT_PCM;
+		Format.nChannels = 1;
+		Format.nSamplesPerSec = SampleRate;
+		Format.wBitsPerSample = 16;
+		Format.nBlockAlign = Format.nChannels * Format.wBitsPerSample / 8;
+		Format.nAvgBytesPerSec = Format.nSamplesPerSec * Format.nBlockAlign;
+		return Format;
+	}
+
+	void Put16(std::ofstream& File, uint16_t Value)
+	{
+		File.put(char(Value));
+		File.put(char(Value >> 8));
+	}
+
+	void Put32(std::ofstream& File, uint32_t Value)
+	{
+		Put16(File, uint16_t(Value));
+		Put16(File, uint16_t(Value >> 16));
+	}
+
+	void WriteWaveHeader(std::ofstream& File, const WAVEFORMATEX& Format, uint32_t DataSize)
+	{
+		File.write("RIFF", 4);
+		Put32(File, WaveHeaderSize - 8 + DataSize);
+		File.write("WAVE", 4);
+
+		File.write("fmt ", 4);
+		Put32(File, 16);
+		Put16(File, Format.wFormatTag);
+		Put16(File, Format.nChannels);
+		Put32(File, Format.nSamplesPerSec);
+		Put32(File, Format.nAvgBytesPerSec);
+		Put16(File, Format.nBlockAlign);
+		Put16(File, Format.wBitsPerSample);
+
+		File.write("data", 4);
+		Put32(File, DataSize);
+	}
+}
+
+FAudioBackend_WaveOut::FAudioBackend_WaveOut()
+	: Ring(nullptr)
+	, WaveOut(nullptr)
+	, Event(nullptr)
+	, bRunning(false)
+	, LastSample(0)
+	, Headers{}
+{}
+
+bool FAudioBackend_WaveOut::Start(FAudioRing& _Ring, uint32_t SampleRate)
+{
+	Stop();
+
+	Event = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+	const WAVEFORMATEX Format = MakeFormat(SampleRate);
+	if (Event == nullptr || waveOutOpen(&WaveOut, WAVE_MAPPER, &Format, DWORD_PTR(Event), 0, CALLBACK_EVENT) != MMSYSERR_NOERROR)
+	{
+		LOG_ERROR("[{}]\t the audio device isn't available.", (__FUNCTION__));
+		if (Event != nullptr)
+		{
+			CloseHandle(Event);
+			Event = nullptr;
+		}
+		WaveOut = nullptr;
+		return false;
+	}
+
+	Ring = &_Ring;
+	LastSample = 0;
+	const uint32_t BufferSamples = SampleRate * WaveOutBufferTime / 1000;
+	for (uint32_t Index = 0; Index < BufferCount; ++Index)
+	{
+		Buffers[Index].assign(BufferSamples, 0);
+		Headers[Index] = {};
+		Headers[Index].lpData = reinterpret_cast<char*>(Buffers[Index].data());
+		Headers[Index].dwBufferLength = DWORD(BufferSamples * sizeof(int16_t));
+		waveOutPrepareHeader(WaveOut, &Headers[Index], sizeof(WAVEHDR));
+	}
+
+	bRunning = true;
+	Thread = std::thread(&FAudioBackend_WaveOut::Thread_Execution, this);
+	LOG("Audio: waveOut, {} Hz", SampleRate);
+	return true;
+}
+
+void FAudioBackend_WaveOut::Stop()
+{
+	if (WaveOut == nullptr)
+	{
+		return;
+	}
+
+	bRunning = false;
+	SetEvent(Event);
+	if (Thread.joinable())
+	{
+		Thread.join();
+	}
+
+	waveOutReset(WaveOut);
+	for (WAVEHDR& Header : Headers)
+	{
+		waveOutUnprepareHeader(WaveOut, &Header, sizeof(WAVEHDR));
+	}
+	waveOutClose(WaveOut);
+	CloseHandle(Event);
+	WaveOut = nullptr;
+	Event = nullptr;
+	Ring = nullptr;
+}
+
+void FAudioBackend_WaveOut::Thread_Execution()
+{
+	while (bRunning)
+	{
+		// the device signals the event each time it is done with a buffer
+		for (WAVEHDR& Header : Headers)
+		{
+			if ((Header.dwFlags & WHDR_INQUEUE) == 0)
+			{
+				FillBuffer(Header);
+				waveOutWrite(WaveOut, &Header, sizeof(WAVEHDR));
+			}
+		}
+		WaitForSingleObject(Event, WaveOutBufferTime * 2);
+	}
+}
+
+void FAudioBackend_WaveOut::FillBuffer(WAVEHDR& Header)
+{
+	int16_t* Samples = reinterpret_cast<int16_t*>(Header.lpData);
+	const size_t Count = Header.dwBufferLength / sizeof(int16_t);
+	const size_t Popped = Ring->Pop(Samples, Count);
+	if (Popped != 0)
+	{
+		LastSample = Samples[Popped - 1];
+	}
+	std::fill(Samples + Popped, Samples + Count, LastSample);
+}
+
+FAudioBackend_WaveFile::FAudioBackend_WaveFile(const std::filesystem::path& _FilePath)
+	: FilePath(_FilePath)
+	, Ring(nullptr)
+	, bRunning(false)
+	, SampleRate(0)
+	, DataSize(0)
+{}
+
+bool FAudioBackend_WaveFile::Start(FAudioRing& _Ring, uint32_t _SampleRate)
+{
+	Stop();
+
+	std::error_code ec;
+	std::filesystem::create_directories(FilePath.parent_path(), ec);
+
+	File.open(FilePath, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!File.is_open())
+	{
+		LOG("Could not open the file: {}", FilePath.string().c_str());
+		return false;
+	}
+
+	// the sizes are unknown until the end
+	SampleRate = _SampleRate;
+	WriteWaveHeader(File, MakeFormat(SampleRate), 0);
+
+	Ring = &_Ring;
+	DataSize = 0;
+	Buffer.resize(_Ring.Capacity());
+	bRunning = true;
+	Thread = std::thread(&FAudioBackend_WaveFile::Thread_Execution, this);
+	LOG("Audio: recording to {}", FilePath.string().c_str());
+	return true;
+}
+
+void FAudioBackend_WaveFile::Stop()
+{
+	if (!File.is_open())
+	{
+		return;
+	}
+
+	bRunning = false;
+	if (Thread.joinable())
+	{
+		Thread.join();
+	}
+	Drain();
+
+	// the header is rewritten in place with the final sizes
+	File.seekp(0, std::ios::beg);
+	WriteWaveHeader(File, MakeFormat(SampleRate), DataSize);
+	File.close();
+	LOG("Audio: {} bytes recorded to {}", DataSize, FilePath.string().c_str());
+	Ring = nullptr;
+}
+
+void FAudioBackend_WaveFile::Thread_Execution()
+{
+	while (bRunning)
+	{
+		const size_t Count = Drain();
+		std::this_thread::sleep_for(std::chrono::milliseconds(Count != 0 ? WaveFileBusyDrainTime : WaveFileDrainTime));
+	}
+}
+
+size_t FAudioBackend_WaveFile::Drain()
+{
+	const size_t Count = Ring->Pop(Buffer.data(), Buffer.size());
+	for (size_t Index = 0; Index < Count; ++Index)
+	{
+		Put16(File, uint16_t(Buffer[Index]));
+	}
+	DataSize += uint32_t(Count * sizeof(int16_t));
+	return Count;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <CoreMinimal.h>
+#include <array>
+#include <atomic>
+#include <mmsystem.h>
+#include "Utils/RingBuffer.h"
+
+// mono 16-bit samples from the emulation thread to the audio backend
+using FAudioRing = TRingBuffer<int16_t>;
+
+namespace Audio
+{
+	static constexpr uint32_t SampleRate = 44100;
+	static constexpr size_t RingSize = 16384;		// samples, about 0.37 s
+}
+
+// the host side of the sound, the backend drains the ring from its own thread
+class IAudioBackend
+{
+public:
+	virtual ~IAudioBackend() = default;
+
+	virtual bool Start(FAudioRing& Ring, uint32_t SampleRate) = 0;
+	// has to be called while the ring is alive
+	virtual void Stop() = 0;
+	// the consumer runs at the clock of the sound card, not as fast as it can
+	virtual bool IsRealTime() const = 0;
+};
+
+// the sound card through waveOut, a few short buffers are kept queued;
+// on underrun the last sample is held so the gap doesn't click
+class FAudioBackend_WaveOut : public IAudioBackend
+{
+public:
+	FAudioBackend_WaveOut();
+	virtual ~FAudioBackend_WaveOut() { Stop(); }
+
+	virtual bool Start(FAudioRing& _Ring, uint32_t SampleRate) override;
+	virtual void Stop() override;
+	virtual bool IsRealTime() const override { return true; }
+
+private:
+	static constexpr uint32_t BufferCount = 4;
+
+	void Thread_Execution();
+	void FillBuffer(WAVEHDR& Header);
+
+	FAudioRing* Ring;
+	HWAVEOUT WaveOut;
+	HANDLE Event;
+	std::thread Thread;
+	std::atomic<bool> bRunning;
+	int16_t LastSample;
+
+	std::array<WAVEHDR, BufferCount> Headers;
+	std::array<std::vector<int16_t>, BufferCount> Buffers;
+};
+
+// headless runs, everything that comes out of the ring is appended to a .wav file,
+// the header sizes are patched when the backend stops; the beeper is lossless for it, a full ring holds up the emulation
+class FAudioBackend_WaveFile : public IAudioBackend
+{
+public:
+	FAudioBackend_WaveFile(const std::filesystem::path& _FilePath);
+	virtual ~FAudioBackend_WaveFile() { Stop(); }
+
+	virtual bool Start(FAudioRing& _Ring, uint32_t _SampleRate) override;
+	virtual void Stop() override;
+	virtual bool IsRealTime() const override { return false; }
+
+private:
+	void Thread_Execution();
+	size_t Drain();
+
+	std::filesystem::path FilePath;
+	std::ofstream File;
+	FAudioRing* Ring;
+	std::thread Thread;
+	std::atomic<bool> bRunning;
+	uint32_t SampleRate;
+	uint32_t DataSize;
+	std::vector<int16_t> Buffer;
+};
@@ -340,23 +340,62 @@ FImage& FImageBase::CreateTexture(void* ImageData, int32_t Width, int32_t Height
 }
 
 bool FImageBase::UpdateTexture(FImageHandle _Handle, void* ImageData)
+{
+	const FImage& Image = GetImage(_Handle);
+	return UpdateTextureRegion(_Handle, ImageData, 0, 0, (int32_t)Image.Width, (int32_t)Image.Height);
+}
+
+bool FImageBase::UpdateTextureRegion(FImageHandle _Handle, const void* ImageData, int32_t X, int32_t Y, int32_t Width, int32_t Height)
 {
 	FImage& Image = GetImage(_Handle);
+	if (Image.ShaderResourceView == nullptr || Width <= 0 || Height <= 0)
+	{
+		return false;
+	}
+
+	// Calculate the original pitch of the source data line (UnalignedPitch)
+	const UINT SourcePitch = UINT(Image.Width * Image.GetFormatSize());
+	const uint8_t* SourceData = static_cast<const uint8_t*>(ImageData);
 
-	ID3D11Texture2D* Texture = nullptr;
 	ID3D11Resource* TextureResource = nullptr;
+	ID3D11Texture2D* Texture = nullptr;
+	Image.ShaderResourceView->GetResource(&TextureResource);
+	if (FAILED(TextureResource->QueryInterface(__uuidof(ID3D11Texture2D), reinterpret_cast<void**>(&Texture))))
+	{
+		TextureResource->Release();
+		return false;
+	}
+
+	D3D11_TEXTURE2D_DESC Texture2D;
+	Texture->GetDesc(&Texture2D);
+	if (Texture2D.Usage == D3D11_USAGE_DEFAULT)
+	{
+		// only the rectangle goes to the GPU
+		D3D11_BOX Box;
+		Box.left = (UINT)X;
+		Box.top = (UINT)Y;
+		Box.front = 0;
+		Box.right = (UINT)(X + Width);
+		Box.bottom = (UINT)(Y + Height);
+		Box.back = 1;
+		DeviceContext->UpdateSubresource(Texture, 0, &Box, SourceData + Y * SourcePitch + X * Image.GetFormatSize(), SourcePitch, 0);
+
+		Texture->Release();
+		TextureResource->Release();
+		return true;
+	}
+	Texture->Release();
+	TextureResource->Release();
+
+	// mapping with D3D11_MAP_WRITE_DISCARD drops the previous contents, the whole image has to be written
 	D3D11_MAPPED_SUBRESOURCE MappedResource;
 	if (Lock(Image.ShaderResourceView, TextureResource, Texture, MappedResource))
 	{
-		// Calculate the original pitch of the source data line (UnalignedPitch)
-		const UINT SourcePitch = UINT(Image.Width * Image.GetFormatSize());
-
 		// Get the row pitch of the target GPU memory (MappedResource.RowPitch)
 		// This parameter is returned by Map() and is already aligned (likely 256 bytes).
 		const UINT DestinationPitch = MappedResource.RowPitch;
 
 		uint8_t* dstData = static_cast<uint8_t*>(MappedResource.pData);
-		const uint8_t* SourceData = static_cast<const uint8_t*>(ImageData);
 
 		// Copying data line by line
 		for (UINT y = 0; y < Image.Height; ++y)
@@ -94,6 +94,8 @@ public:
 	FImage& FromMemory(std::vector<uint8_t> Memory);
 	FImage& CreateTexture(void* ImageData, int32_t Width, int32_t Height, UINT CPUAccessFlags = 0, D3D11_USAGE Usage = D3D11_USAGE::D3D11_USAGE_DEFAULT);
 	bool UpdateTexture(FImageHandle _Handle, void* ImageData);
+	// ImageData is the whole image, only the rectangle is uploaded (dynamic textures are rewritten whole)
+	bool UpdateTextureRegion(FImageHandle _Handle, const void* ImageData, int32_t X, int32_t Y, int32_t Width, int32_t Height);
 	FImage& GetImage(FImageHandle _Handle);
 
 private:
@@ -0,0 +1,280 @@
+#include "JobSystem.h"
+
+float FJobHandle::GetProgress() const
+{
+	const int32_t Total = GetProgressTotal();
+	return Total > 0 ? ImClamp(float(GetProgressCurrent()) / float(Total), 0.0f, 1.0f) : 0.0f;
+}
+
+void FJobHandle::Cancel() const
+{
+	if (Context)
+	{
+		Context->bCancelRequested.store(true, std::memory_order_relaxed);
+	}
+}
+
+void FJobHandle::Wait() const
+{
+	if (Context)
+	{
+		FJobSystem::Get().WaitFor(*Context);
+	}
+}
+
+FJobSystem& FJobSystem::Get()
+{
+	static std::shared_ptr<FJobSystem> Instance(new FJobSystem);
+	return *Instance.get();
+}
+
+FJobSystem::FJobSystem()
+	: bQuit(false)
+{}
+
+FJobSystem::~FJobSystem()
+{
+	Shutdown();
+}
+
+FJobHandle FJobSystem::Submit(const std::string& DebugName, FWork&& Work, FCompletion&& Completion /*= nullptr*/, EJobPriority Priority /*= EJobPriority::Normal*/)
+{
+	FJobHandle Handle;
+	Handle.Context = std::make_shared<FJobContext>();
+	Handle.Context->DebugName = DebugName;
+
+	{
+		std::unique_lock<std::mutex> Lock(Mutex);
+		if (bQuit)
+		{
+			Handle.Context->Status.store(EJobStatus::Cancelled, std::memory_order_release);
+			return Handle;
+		}
+
+		Startup();
+		Queues[int32_t(Priority)].push_back({ Handle.Context, std::move(Work), std::move(Completion) });
+	}
+	QueueCondition.notify_one();
+	return Handle;
+}
+
+void FJobSystem::ParallelFor(int32_t Count, const std::function<void(int32_t)>& Body, int32_t MaxConcurrency /*= 0*/)
+{
+	struct FParallelFor
+	{
+		const std::function<void(int32_t)>* Body;
+		int32_t Count;
+		std::atomic<int32_t> Next = 0;
+		std::atomic<int32_t> Done = 0;
+		std::mutex Mutex;
+		std::condition_variable DoneCondition;
+
+		// a helper that starts after everything is taken doesn't touch Body anymore
+		void Run()
+		{
+			int32_t Finished = 0;
+			for (int32_t Index = Next++; Index < Count; Index = Next++)
+			{
+				(*Body)(Index);
+				++Finished;
+			}
+			if (Finished > 0 && (Done += Finished) == Count)
+			{
+				std::unique_lock<std::mutex> Lock(Mutex);
+				DoneCondition.notify_all();
+			}
+		}
+	};
+
+	if (Count <= 0)
+	{
+		return;
+	}
+
+	int32_t HelperCount = 0;
+	{
+		std::unique_lock<std::mutex> Lock(Mutex);
+		if (!bQuit)
+		{
+			Startup();
+			HelperCount = (std::min)(int32_t(Workers.size()), Count - 1);
+			if (MaxConcurrency > 0)
+			{
+				HelperCount = (std::min)(HelperCount, MaxConcurrency - 1);
+			}
+		}
+	}
+
+	std::shared_ptr<FParallelFor> State = std::make_shared<FParallelFor>();
+	State->Body = &Body;
+	State->Count = Count;
+	for (int32_t Index = 0; Index < HelperCount; ++Index)
+	{
+		Submit("ParallelFor", [State](FJobContext&) { State->Run(); }, nullptr, EJobPriority::High);
+	}
+
+	State->Run();
+
+	// only indices already taken by a running helper are left, none of them waits for a worker
+	std::unique_lock<std::mutex> Lock(State->Mutex);
+	State->DoneCondition.wait(Lock, [&State]() { return State->Done.load() == State->Count; });
+}
+
+void FJobSystem::Tick()
+{
+	std::vector<FJob> Finished;
+	{
+		std::unique_lock<std::mutex> Lock(Mutex);
+		Finished.swap(Completed);
+	}
+
+	for (FJob& Job : Finished)
+	{
+		if (Job.Completion)
+		{
+			FJobHandle Handle;
+			Handle.Context = Job.Context;
+			Job.Completion(Handle);
+		}
+	}
+}
+
+void FJobSystem::Shutdown()
+{
+	{
+		std::unique_lock<std::mutex> Lock(Mutex);
+		bQuit = true;
+		for (std::deque<FJob>& Queue : Queues)
+		{
+			for (FJob& Job : Queue)
+			{
+				Job.Context->bCancelRequested.store(true, std::memory_order_relaxed);
+			}
+		}
+		for (const std::shared_ptr<FJobContext>& Context : Running)
+		{
+			Context->bCancelRequested.store(true, std::memory_order_relaxed);
+		}
+	}
+	QueueCondition.notify_all();
+
+	for (std::thread& Worker : Workers)
+	{
+		if (Worker.joinable())
+		{
+			Worker.join();
+		}
+	}
+	Workers.clear();
+
+	// the owners are being destroyed, nobody is left to complete on the main thread
+	std::unique_lock<std::mutex> Lock(Mutex);
+	Completed.clear();
+}
+
+void FJobSystem::Startup()
+{
+	if (!Workers.empty())
+	{
+		return;
+	}
+
+	// one core is left to the main thread
+	const int32_t Concurrency = int32_t(std::thread::hardware_concurrency());
+	const int32_t WorkerCount = (std::max)(Concurrency - 1, 1);
+	Workers.reserve(WorkerCount);
+	for (int32_t Index = 0; Index < WorkerCount; ++Index)
+	{
+		Workers.emplace_back(&FJobSystem::Worker_Execution, this);
+	}
+}
+
+void FJobSystem::Worker_Execution()
+{
+	while (true)
+	{
+		FJob Job;
+		{
+			std::unique_lock<std::mutex> Lock(Mutex);
+			std::deque<FJob>* Queue = nullptr;
+			QueueCondition.wait(Lock,
+				[this, &Queue]()
+				{
+					for (std::deque<FJob>& Candidate : Queues)
+					{
+						if (!Candidate.empty())
+						{
+							Queue = &Candidate;
+							return true;
+						}
+					}
+					return bQuit;
+				});
+
+			if (Queue == nullptr)
+			{
+				return;
+			}
+
+			Job = std::move(Queue->front());
+			Queue->pop_front();
+			Running.push_back(Job.Context);
+		}
+
+		if (Job.Context->IsCancelled())
+		{
+			Finish(Job, EJobStatus::Cancelled);
+			continue;
+		}
+
+		Job.Context->Status.store(EJobStatus::Running, std::memory_order_release);
+		EJobStatus Status = EJobStatus::Completed;
+		try
+		{
+			Job.Work(*Job.Context);
+		}
+		catch (const std::exception& Exception)
+		{
+			LOG_ERROR("[{}]\t Job '{}' failed: {}", (__FUNCTION__), Job.Context->DebugName, Exception.what());
+			Status = EJobStatus::Failed;
+		}
+		catch (...)
+		{
+			LOG_ERROR("[{}]\t Job '{}' failed with an unknown exception", (__FUNCTION__), Job.Context->DebugName);
+			Status = EJobStatus::Failed;
+		}
+
+		if (Status == EJobStatus::Completed && Job.Context->IsCancelled())
+		{
+			Status = EJobStatus::Cancelled;
+		}
+		Finish(Job, Status);
+	}
+}
+
+void FJobSystem::Finish(FJob& Job, EJobStatus Status)
+{
+	// the work is released on the worker, only the completion goes to the main thread
+	Job.Work = nullptr;
+	{
+		std::unique_lock<std::mutex> Lock(Mutex);
+		Job.Context->Status.store(Status, std::memory_order_release);
+		Running.erase(std::remove(Running.begin(), Running.end(), Job.Context), Running.end());
+		if (!bQuit && Job.Completion)
+		{
+			Completed.push_back(std::move(Job));
+		}
+	}
+	FinishedCondition.notify_all();
+}
+
+void FJobSystem::WaitFor(const FJobContext& Context)
+{
+	std::unique_lock<std::mutex> Lock(Mutex);
+	FinishedCondition.wait(Lock,
+		[&Context]()
+		{
+			const EJobStatus Status = Context.Status.load(std::memory_order_acquire);
+			return Status != EJobStatus::Pending && Status != EJobStatus::Running;
+		});
+}
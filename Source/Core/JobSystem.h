@@ -0,0 +1,124 @@
+#pragma once
+
+#include <CoreMinimal.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+enum class EJobPriority : int32_t
+{
+	High,
+	Normal,
+	Low,
+
+	MAX
+};
+
+enum class EJobStatus : int32_t
+{
+	Pending,
+	Running,
+	Completed,
+	Cancelled,
+	Failed,
+};
+
+// state of a job shared by the worker running it and every handle to it,
+// the counters are plain atomics so CodeGenerator::FProgressInfo and the like can point right at them
+struct FJobContext
+{
+	std::string DebugName;
+	std::atomic<EJobStatus> Status = EJobStatus::Pending;
+	std::atomic<bool> bCancelRequested = false;
+	std::atomic<int32_t> ProgressCurrent = 0;
+	std::atomic<int32_t> ProgressTotal = 0;
+
+	bool IsCancelled() const { return bCancelRequested.load(std::memory_order_relaxed); }
+	void SetProgress(int32_t Current, int32_t Total)
+	{
+		ProgressTotal.store(Total, std::memory_order_relaxed);
+		ProgressCurrent.store(Current, std::memory_order_relaxed);
+	}
+};
+
+struct FJobHandle
+{
+	friend class FJobSystem;
+
+	FJobHandle() = default;
+
+	bool IsValid() const { return Context != nullptr; }
+	void Reset() { Context.reset(); }
+
+	EJobStatus GetStatus() const { return Context ? Context->Status.load(std::memory_order_acquire) : EJobStatus::Completed; }
+	// pending or running, the completion callback is not called yet at least
+	bool IsBusy() const { const EJobStatus Status = GetStatus(); return Status == EJobStatus::Pending || Status == EJobStatus::Running; }
+	bool IsCancelRequested() const { return Context && Context->IsCancelled(); }
+	float GetProgress() const;
+	int32_t GetProgressCurrent() const { return Context ? Context->ProgressCurrent.load(std::memory_order_relaxed) : 0; }
+	int32_t GetProgressTotal() const { return Context ? Context->ProgressTotal.load(std::memory_order_relaxed) : 0; }
+	FJobContext* GetContext() const { return Context.get(); }
+
+	// a pending job is skipped, a running one sees IsCancelled() and should return early
+	void Cancel() const;
+	// blocks until the work has finished, the completion callback still runs on the next FJobSystem::Tick
+	void Wait() const;
+
+private:
+	std::shared_ptr<FJobContext> Context;
+};
+
+// fixed pool of workers for the long editor operations
+//
+// the work runs on a worker and gets the context for cancellation and progress,
+// the completion runs on the main thread from FJobSystem::Tick (called once a frame by the framework)
+// and is called for cancelled and failed jobs too, so the owner can always release what it holds;
+// the only exception is Shutdown: jobs finishing during it and jobs submitted after it are cancelled
+// without a completion, their owners are being destroyed by then
+class FJobSystem
+{
+	friend struct FJobHandle;
+
+public:
+	using FWork = std::function<void(FJobContext&)>;
+	using FCompletion = std::function<void(const FJobHandle&)>;
+
+	static FJobSystem& Get();
+	~FJobSystem();
+
+	FJobHandle Submit(const std::string& DebugName, FWork&& Work, FCompletion&& Completion = nullptr, EJobPriority Priority = EJobPriority::Normal);
+	// calls Body for every index of [0, Count) on the workers and returns when all are done; the calling thread
+	// takes indices too and never waits for a free worker, so a job can split its own work the same way.
+	// Body must not throw
+	void ParallelFor(int32_t Count, const std::function<void(int32_t)>& Body, int32_t MaxConcurrency = 0);
+	void Tick();
+	void Shutdown();
+
+	int32_t GetWorkerCount() const { return int32_t(Workers.size()); }
+
+private:
+	FJobSystem();
+
+	struct FJob
+	{
+		std::shared_ptr<FJobContext> Context;
+		FWork Work;
+		FCompletion Completion;
+	};
+
+	void Startup();
+	void Worker_Execution();
+	void Finish(FJob& Job, EJobStatus Status);
+	void WaitFor(const FJobContext& Context);
+
+	bool bQuit;
+	std::deque<FJob> Queues[int32_t(EJobPriority::MAX)];
+	std::vector<FJob> Completed;
+	std::vector<std::shared_ptr<FJobContext>> Running;
+	std::vector<std::thread> Workers;
+
+	std::mutex Mutex;
+	std::condition_variable QueueCondition;
+	std::condition_variable FinishedCondition;
+};
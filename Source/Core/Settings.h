@@ -51,7 +51,7 @@ public:
 		}
 		catch (const std::bad_any_cast& e)
 		{
-			LOG("Error: get value - ", e.what());
+			LOG("Error: get value - {}", e.what());
 			return std::nullopt;
 		}
 	}
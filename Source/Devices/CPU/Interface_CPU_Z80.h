@@ -2,6 +2,9 @@
 
 #include "Utils/Register.h"
 
+class FMemoryTracker;
+class FTraceRecorder;
+
 struct FRegisters
 {
 	Register16 PC;		// program counter
@@ -37,6 +40,13 @@ public:
 	virtual bool Flush() = 0;
 	virtual double GetFrequency() const = 0;
 	virtual FRegisters GetRegisters() const = 0;
+	// only between instructions, the next one is fetched from the new PC
+	virtual void SetRegisters(const FRegisters& NewRegisters) = 0;
 	virtual bool IsInstrCycleDone() const = 0;
 	virtual bool IsInstrExecuteDone() const = 0;
+	virtual uint8_t GetOpcode() const = 0;
+	// the memory cycles are reported to the tracker, nullptr to stop
+	virtual void SetMemoryTracker(FMemoryTracker* Tracker) = 0;
+	// the opcode bytes and memory writes of the instructions are reported to the recorder, nullptr to stop
+	virtual void SetTraceRecorder(FTraceRecorder* Recorder) = 0;
 };
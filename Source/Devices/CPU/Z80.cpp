@@ -1,6 +1,7 @@
 #include "Z80.h"
 #include "Utils/Signal/Bus.h"
 #include "Motherboard/Motherboard_ClockGenerator.h"
+#include "Motherboard/Motherboard_SaveState.h"
 
 #define DEVICE_NAME() FName(std::format("{}", ThisDeviceName))
 #define ADD_STEP(a,b) (static_cast<DecoderStep::Type>(static_cast<int32_t>(a) + static_cast<int32_t>(b)))
@@ -12,6 +13,8 @@ namespace
 
 FCPU_Z80::FCPU_Z80(double _Frequency)
 	: FDevice(DEVICE_NAME(), EName::Z80, EDeviceType::CPU, _Frequency)
+	, MemoryTracker(nullptr)
+	, TraceRecorder(nullptr)
 {}
 
 void FCPU_Z80::Tick()
@@ -121,3 +124,62 @@ FRegisters FCPU_Z80::GetRegisters() const
 {
 	return Registers;
 }
+
+void FCPU_Z80::SetRegisters(const FRegisters& NewRegisters)
+{
+	static_cast<FRegisters&>(Registers) = NewRegisters;
+
+	// the instructions work on a copy of the flags
+	Registers.Flags = Registers.AF.L;
+}
+
+void FCPU_Z80::SaveState(FSaveStateWriter& Writer) const
+{
+	// between the instructions the pipelines are empty, the registers are the whole state
+	for (uint16_t Value : { *Registers.PC, *Registers.IR, *Registers.IX, *Registers.IY, *Registers.SP,
+							*Registers.AF, *Registers.HL, *Registers.DE, *Registers.BC,
+							*Registers.AF_, *Registers.HL_, *Registers.DE_, *Registers.BC_, *Registers.WZ })
+	{
+		Writer.Write(Value);
+	}
+	Writer.Write(Registers.bIFF1);
+	Writer.Write(Registers.bIFF2);
+	Writer.Write(Registers.IM);
+}
+
+std::function<void()> FCPU_Z80::LoadState(FSaveStateReader& Reader, uint16_t Version)
+{
+	uint16_t Values[14];
+	for (uint16_t& Value : Values)
+	{
+		Reader.Read(Value);
+	}
+
+	FRegisters NewRegisters = Registers;
+	Reader.Read(NewRegisters.bIFF1);
+	Reader.Read(NewRegisters.bIFF2);
+	Reader.Read(NewRegisters.IM);
+	if (!Reader.IsValid())
+	{
+		return nullptr;
+	}
+
+	NewRegisters.PC = Values[0];
+	NewRegisters.IR = Values[1];
+	NewRegisters.IX = Values[2];
+	NewRegisters.IY = Values[3];
+	NewRegisters.SP = Values[4];
+	NewRegisters.AF = Values[5];
+	NewRegisters.HL = Values[6];
+	NewRegisters.DE = Values[7];
+	NewRegisters.BC = Values[8];
+	NewRegisters.AF_ = Values[9];
+	NewRegisters.HL_ = Values[10];
+	NewRegisters.DE_ = Values[11];
+	NewRegisters.BC_ = Values[12];
+	return [this, NewRegisters, WZ = Values[13]]() -> void
+		{
+			SetRegisters(NewRegisters);
+			Registers.WZ = WZ;
+		};
+}
@@ -152,16 +152,25 @@ public:
 	virtual bool Flush() override;
 	virtual double GetFrequency() const override;
 	virtual FRegisters GetRegisters() const override;
+	virtual void SetRegisters(const FRegisters& NewRegisters) override;
 	virtual bool IsInstrCycleDone() const override { return Registers.bInstrCycleDone; }
 	virtual bool IsInstrExecuteDone() const override { return Registers.bInstrCompleted; }
+	virtual uint8_t GetOpcode() const override { return Registers.Opcode; }
+	virtual void SetMemoryTracker(FMemoryTracker* Tracker) override { MemoryTracker = Tracker; }
+	virtual void SetTraceRecorder(FTraceRecorder* Recorder) override { TraceRecorder = Recorder; }
 	virtual std::ostream& Serialize(std::ostream& os) const override { os << Registers; return os; }
 	virtual std::istream& Deserialize(std::istream& is) override { is >> Registers; return is; }
+	virtual uint16_t GetStateVersion() const override { return 1; }
+	virtual void SaveState(FSaveStateWriter& Writer) const override;
+	virtual std::function<void()> LoadState(FSaveStateReader& Reader, uint16_t Version) override;
 
 	void Cycle_Reset();
 	void Cycle_InitCPU();
 	void Cycle_OpcodeFetch(FCPU_Z80& CPU);
 	void Cycle_MemoryRead(uint16_t Address, Register8& Register, int32_t Delay = 0);
 	void Cycle_MemoryWrite(uint16_t Address, Register8& Register);
+	void Cycle_IORead(uint16_t Address, Register8& Register);
+	void Cycle_IOWrite(uint16_t Address, Register8& Register);
 
 	FInternalRegisters Registers;
 
@@ -169,6 +178,8 @@ private:
 	void OpcodeDecode();
 
 	static const CMD_FUNC Unprefixed[256];
+	FMemoryTracker* MemoryTracker;
+	FTraceRecorder* TraceRecorder;
 	std::function<void(FCPU_Z80& CPU)> Execute_Cycle;
 	std::function<void(FCPU_Z80& CPU)> Execute_Tick;
 };
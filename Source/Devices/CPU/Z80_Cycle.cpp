@@ -1,6 +1,8 @@
 #include "Z80.h"
 #include "Utils/Signal/Bus.h"
 #include "Motherboard/Motherboard_ClockGenerator.h"
+#include "Motherboard/Motherboard_MemoryTracker.h"
+#include "Motherboard/Motherboard_TraceRecorder.h"
 
 #define INCREMENT_CP_HALF()	{ ++(reinterpret_cast<uint32_t&>(Registers.DSCP)); }
 
@@ -112,6 +114,7 @@ void FCPU_Z80::Cycle_OpcodeFetch(FCPU_Z80& CPU)
 		{
 			SB->SetActive(BUS_MREQ);
 			SB->SetActive(BUS_RD);
+			if (MemoryTracker) MemoryTracker->Execute(*Registers.PC);
 			++Registers.PC;
 			break;
 		}
@@ -131,6 +134,7 @@ void FCPU_Z80::Cycle_OpcodeFetch(FCPU_Z80& CPU)
 		case DecoderStep::T3_H1:
 		{
 			Registers.Opcode = /*read opcode*/ SB->GetDataOnDataBus();
+			if (TraceRecorder) TraceRecorder->Fetch(Registers.Opcode);
 			break;
 		}
 		case DecoderStep::T3_H2:
@@ -209,6 +213,8 @@ void FCPU_Z80::Cycle_MemoryRead(uint16_t Address, Register8& Register, int32_t D
 		case DecoderStep::T3_H2:
 		{
 			Register = SB->GetDataOnDataBus();
+			if (MemoryTracker) MemoryTracker->Read(Address);
+			if (TraceRecorder) TraceRecorder->Read(Address, *Register);
 			ADD_EVENT_(CG, 1, FrequencyDivider, [&]() { SB->SetInactive(BUS_MREQ); }, "set inactive BUS_MREQ in next clock cycle");
 			ADD_EVENT_(CG, 1, FrequencyDivider, [&]() { SB->SetInactive(BUS_RD); }, "set inactive BUS_RD in next clock cycle");
 			break;
@@ -234,6 +240,8 @@ void FCPU_Z80::Cycle_MemoryWrite(uint16_t Address, Register8& Register)
 			SB->SetDataOnAddressBus(Address);
 			SB->SetDataOnDataBus(*Register);
 			SB->SetActive(BUS_MREQ);
+			if (MemoryTracker) MemoryTracker->Write(Address, CG->GetClockCounter());
+			if (TraceRecorder) TraceRecorder->Write(Address, *Register);
 			ADD_EVENT_(CG, 1, FrequencyDivider, [&]() { SB->SetActive(BUS_WR); }, "set active BUS_WR in next clock cycle");
 			break;
 		}
@@ -263,3 +271,115 @@ void FCPU_Z80::Cycle_MemoryWrite(uint16_t Address, Register8& Register)
 	}
 	INCREMENT_CP_HALF();
 }
+
+void FCPU_Z80::Cycle_IORead(uint16_t Address, Register8& Register)
+{
+	switch (Registers.DSCP)
+	{
+		case DecoderStep::T1_H1:
+		{
+			break;
+		}
+		case DecoderStep::T1_H2:
+		{
+			SB->SetDataOnAddressBus(Address);
+			break;
+		}
+		case DecoderStep::T2_H1:
+		{
+			SB->SetActive(BUS_IORQ);
+			SB->SetActive(BUS_RD);
+			break;
+		}
+		case DecoderStep::T2_H2:
+		{
+			break;
+		}
+		case DecoderStep::T3_H1:
+		{
+			// the automatic wait state
+			break;
+		}
+		case DecoderStep::T3_H2:
+		{
+			if (SB->IsActive(BUS_WAIT))
+			{
+				Registers.DSCP = DecoderStep::T_WAIT;
+			}
+			break;
+		}
+		case DecoderStep::T_WAIT:
+		{
+			Registers.DSCP = DecoderStep::T3_H2;
+			break;
+		}
+		case DecoderStep::T4_H1:
+		{
+			break;
+		}
+		case DecoderStep::T4_H2:
+		{
+			Register = SB->GetDataOnDataBus();
+			ADD_EVENT_(CG, 1, FrequencyDivider, [&]() { SB->SetInactive(BUS_IORQ); }, "set inactive BUS_IORQ in next clock cycle");
+			ADD_EVENT_(CG, 1, FrequencyDivider, [&]() { SB->SetInactive(BUS_RD); }, "set inactive BUS_RD in next clock cycle");
+			break;
+		}
+	}
+	INCREMENT_CP_HALF();
+}
+
+void FCPU_Z80::Cycle_IOWrite(uint16_t Address, Register8& Register)
+{
+	switch (Registers.DSCP)
+	{
+		case DecoderStep::T1_H1:
+		{
+			break;
+		}
+		case DecoderStep::T1_H2:
+		{
+			SB->SetDataOnAddressBus(Address);
+			SB->SetDataOnDataBus(*Register);
+			break;
+		}
+		case DecoderStep::T2_H1:
+		{
+			SB->SetActive(BUS_IORQ);
+			SB->SetActive(BUS_WR);
+			break;
+		}
+		case DecoderStep::T2_H2:
+		{
+			break;
+		}
+		case DecoderStep::T3_H1:
+		{
+			// the automatic wait state
+			break;
+		}
+		case DecoderStep::T3_H2:
+		{
+			if (SB->IsActive(BUS_WAIT))
+			{
+				Registers.DSCP = DecoderStep::T_WAIT;
+			}
+			break;
+		}
+		case DecoderStep::T_WAIT:
+		{
+			Registers.DSCP = DecoderStep::T3_H2;
+			break;
+		}
+		case DecoderStep::T4_H1:
+		{
+			break;
+		}
+		case DecoderStep::T4_H2:
+		{
+			ADD_EVENT_(CG, 1, FrequencyDivider, [&]() { SB->SetInactive(BUS_IORQ); }, "set inactive BUS_IORQ in next clock cycle");
+			ADD_EVENT_(CG, 1, FrequencyDivider, [&]() { SB->SetInactive(BUS_WR); }, "set inactive BUS_WR in next clock cycle");
+			break;
+		}
+	}
+	INCREMENT_CP_HALF();
+}
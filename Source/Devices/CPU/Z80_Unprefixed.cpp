@@ -331,6 +331,117 @@ static void _ld_adr_r(FCPU_Z80& CPU, Register8& Register)
 	PUT_PIPELINE(TP, [](FCPU_Z80& CPU) -> void { _ld_adr_rr_m4(CPU, true); });
 }
 
+static void _io_n_a_m2(FCPU_Z80& CPU)
+{
+	switch (CPU.Registers.DSTP)
+	{
+		case DecoderStep::T2_H1:
+		{
+			++CPU.Registers.PC;
+			break;
+		}
+		case DecoderStep::T2_H2:
+		{
+			if (CPU.GetSignalsBus().IsActive(BUS_WAIT))
+			{
+				CPU.Registers.DSTP = DecoderStep::T_WAIT;
+			}
+			break;
+		}
+		case DecoderStep::T_WAIT:
+		{
+			CPU.Registers.DSTP = DecoderStep::T2_H2;
+			break;
+		}
+		case DecoderStep::T3_H2:
+		{
+			CPU.Registers.NMC = MachineCycle::M3;
+			// transition to the overlapping stage of the pipeline tick
+			TRANSITION_TO_OVERLAP();
+		}
+
+		// clock tick overlap stage
+		case DecoderStep::OLP1_H1:
+		{
+			// the port address is n on the low half and the accumulator on the high half
+			CPU.Registers.WZ.L = CPU.Registers.LBUS;
+			CPU.Registers.WZ.H = CPU.Registers.AF.H;
+			CPU.Registers.bNextTickPipeline = true;
+			break;
+		}
+	}
+	INCREMENT_TP_HALF();
+}
+static void _out_n_a_m3(FCPU_Z80& CPU)
+{
+	switch (CPU.Registers.DSTP)
+	{
+		case DecoderStep::T3_H2:
+		{
+			if (CPU.GetSignalsBus().IsActive(BUS_WAIT))
+			{
+				CPU.Registers.DSTP = DecoderStep::T_WAIT;
+			}
+			break;
+		}
+		case DecoderStep::T_WAIT:
+		{
+			CPU.Registers.DSTP = DecoderStep::T3_H2;
+			break;
+		}
+		case DecoderStep::T4_H2:
+		{
+			++CPU.Registers.WZ.L;
+			CPU.Registers.bInstrCycleDone = true;
+			INSTRUCTION_COMPLETED();
+		}
+	}
+	INCREMENT_TP_HALF();
+}
+static void _in_a_n_m3(FCPU_Z80& CPU)
+{
+	switch (CPU.Registers.DSTP)
+	{
+		case DecoderStep::T3_H2:
+		{
+			if (CPU.GetSignalsBus().IsActive(BUS_WAIT))
+			{
+				CPU.Registers.DSTP = DecoderStep::T_WAIT;
+			}
+			break;
+		}
+		case DecoderStep::T_WAIT:
+		{
+			CPU.Registers.DSTP = DecoderStep::T3_H2;
+			break;
+		}
+		case DecoderStep::T4_H2:
+		{
+			CPU.Registers.AF.H = CPU.Registers.LBUS;
+			++CPU.Registers.WZ;
+			CPU.Registers.bInstrCycleDone = true;
+			INSTRUCTION_COMPLETED();
+		}
+	}
+	INCREMENT_TP_HALF();
+}
+static void _in_a_n(FCPU_Z80& CPU)
+{
+	PUT_PIPELINE(CP, [](FCPU_Z80& CPU) -> void { CPU.Cycle_MemoryRead(*CPU.Registers.PC, CPU.Registers.LBUS); });
+	PUT_PIPELINE(CP, [](FCPU_Z80& CPU) -> void { CPU.Cycle_IORead(*CPU.Registers.WZ, CPU.Registers.LBUS); });
+	PUT_PIPELINE(TP, [](FCPU_Z80& CPU) -> void { _ld_adr_rr_m1(CPU); });
+	PUT_PIPELINE(TP, [](FCPU_Z80& CPU) -> void { _io_n_a_m2(CPU); });
+	PUT_PIPELINE(TP, [](FCPU_Z80& CPU) -> void { _in_a_n_m3(CPU); });
+}
+static void _out_n_a(FCPU_Z80& CPU)
+{
+	PUT_PIPELINE(CP, [](FCPU_Z80& CPU) -> void { CPU.Cycle_MemoryRead(*CPU.Registers.PC, CPU.Registers.LBUS); });
+	PUT_PIPELINE(CP, [](FCPU_Z80& CPU) -> void { CPU.Cycle_IOWrite(*CPU.Registers.WZ, CPU.Registers.AF.H); });
+	PUT_PIPELINE(TP, [](FCPU_Z80& CPU) -> void { _ld_adr_rr_m1(CPU); });
+	PUT_PIPELINE(TP, [](FCPU_Z80& CPU) -> void { _io_n_a_m2(CPU); });
+	PUT_PIPELINE(TP, [](FCPU_Z80& CPU) -> void { _out_n_a_m3(CPU); });
+}
+
 static void _ld_rr_adr_m1(FCPU_Z80& CPU)
 {
 	switch (CPU.Registers.DSTP)
@@ -2538,7 +2649,9 @@ void _d2(FCPU_Z80& CPU)
 
 // out (n), a
 void _d3(FCPU_Z80& CPU)
-{}
+{
+	_out_n_a(CPU);
+}
 
 // call nc, nn
 void _d4(FCPU_Z80& CPU)
@@ -2570,7 +2683,9 @@ void _da(FCPU_Z80& CPU)
 
 // in a, (n)
 void _db(FCPU_Z80& CPU)
-{}
+{
+	_in_a_n(CPU);
+}
 
 // call c, nn
 void _dc(FCPU_Z80& CPU)
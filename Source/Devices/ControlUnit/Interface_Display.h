@@ -30,4 +30,8 @@ public:
 	virtual ~IDisplay() = default;
 	virtual void SetDisplayCycles(const FDisplayCycles& NewDisplayCycles) = 0;
 	virtual void GetSpectrumDisplay(FSpectrumDisplay& OutputDisplay) const = 0;
+	// the raster as it is being drawn, for the emulation thread only
+	virtual const std::vector<uint8_t>& GetDisplayData() const = 0;
+	virtual uint8_t GetBorderColor() const = 0;
+	virtual void SetBorderColor(uint8_t Color) = 0;
 };
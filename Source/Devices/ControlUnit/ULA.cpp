@@ -3,6 +3,7 @@
 #include "Devices/Device.h"
 #include "Utils/Signal/Bus.h"
 #include "Motherboard/Motherboard_ClockGenerator.h"
+#include "Motherboard/Motherboard_SaveState.h"
 
 #define DEVICE_NAME() FName(std::format("{}", ThisDeviceName))
 
@@ -25,6 +26,7 @@ FULA::FULA(const FDisplayCycles& _DisplayCycles, double _Frequency)
 	, X(0)
 	, Y(0)
 	, FlashCounter(32)
+	, BorderColor(15)
 	, Pixels(0)
 	, Attribute(0)
 {
@@ -50,8 +52,7 @@ void FULA::Tick()
 	if ((bIsBorder || bBorderDelay) && (!bIsVideoFetch || bBorderDelay))
 	{
 		// ToDo read port #FE
-		const uint8_t Color = 15;
-		DisplayData[Y * DisplayWidth + X] = Color;
+		DisplayData[Y * DisplayWidth + X] = BorderColor;
 	}
 	
 	if (bIsVideoFetch)
@@ -78,6 +79,35 @@ void FULA::SetDisplayCycles(const FDisplayCycles& NewDisplayCycles)
 	DisplayCycles = NewDisplayCycles;
 }
 
+void FULA::SaveState(FSaveStateWriter& Writer) const
+{
+	// the beam follows the clock counter, only the counters of its own are kept
+	Writer.Write(BorderColor);
+	Writer.Write(FlashCounter);
+	Writer.Write(bFlipFlopFlash);
+}
+
+std::function<void()> FULA::LoadState(FSaveStateReader& Reader, uint16_t Version)
+{
+	uint8_t NewBorderColor = 0;
+	uint8_t NewFlashCounter = 0;
+	bool bNewFlipFlopFlash = false;
+	Reader.Read(NewBorderColor);
+	Reader.Read(NewFlashCounter);
+	Reader.Read(bNewFlipFlopFlash);
+	if (!Reader.IsValid())
+	{
+		return nullptr;
+	}
+
+	return [=, this]() -> void
+		{
+			BorderColor = NewBorderColor;
+			FlashCounter = NewFlashCounter;
+			bFlipFlopFlash = bNewFlipFlopFlash;
+		};
+}
+
 void FULA::GetSpectrumDisplay(FSpectrumDisplay& OutputDisplay) const
 {
 	OutputDisplay.DisplayCycles = DisplayCycles;
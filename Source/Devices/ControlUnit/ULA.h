@@ -16,6 +16,12 @@ public:
 	virtual void CalculateFrequency(double MainFrequency, uint32_t Sampling) override;
 	virtual void SetDisplayCycles(const FDisplayCycles& NewDisplayCycles) override;
 	virtual void GetSpectrumDisplay(FSpectrumDisplay& OutputDisplay) const override;
+	virtual const std::vector<uint8_t>& GetDisplayData() const override { return DisplayData; }
+	virtual uint8_t GetBorderColor() const override { return BorderColor & 0x07; }
+	virtual void SetBorderColor(uint8_t Color) override { BorderColor = Color & 0x07; }
+	virtual uint16_t GetStateVersion() const override { return 1; }
+	virtual void SaveState(FSaveStateWriter& Writer) const override;
+	virtual std::function<void()> LoadState(FSaveStateReader& Reader, uint16_t Version) override;
 
 private:
 	void BusLogic(uint32_t FrameClock);
@@ -40,6 +46,7 @@ private:
 	uint32_t Y;
 	uint32_t X;
 	uint8_t FlashCounter;
+	uint8_t BorderColor;
 
 	uint16_t Pixels;
 	uint8_t PixelsShift;
@@ -42,7 +42,7 @@ void FDevice::InternalRegister(FSignalsBus& _SB, FClockGenerator& _CG)
 	bRegistered = true;
 	CG = &_CG;
 	SB = &_SB;
-	LOG(("[Device] : {} is registered."), DeviceName.ToString());
+	LOG_CATEGORY(Device, Log, "[Device] : {} is registered.", DeviceName.ToString());
 
 	Register();
 }
@@ -50,7 +50,7 @@ void FDevice::InternalRegister(FSignalsBus& _SB, FClockGenerator& _CG)
 void FDevice::InternalUnregister()
 {
 	bRegistered = false;
-	LOG(("[Device] : {} is unregistered."), DeviceName.ToString());
+	LOG_CATEGORY(Device, Log, "[Device] : {} is unregistered.", DeviceName.ToString());
 
 	Unregister();
 }
@@ -6,6 +6,8 @@ class FThread;
 class FSignalsBus;
 class FMotherboard;
 class FClockGenerator;
+class FSaveStateWriter;
+class FSaveStateReader;
 
 enum class EDeviceType
 {
@@ -40,6 +42,12 @@ public:
 	virtual std::ostream& Serialize(std::ostream& os) const { return os; }
 	virtual std::istream& Deserialize(std::istream& is) { return is; }
 
+	// save-state chunk of the device, written and read between the instructions; version 0 has nothing to save
+	// the chunk is decoded without touching the device, the returned function applies it once all the chunks are decoded, none if damaged
+	virtual uint16_t GetStateVersion() const { return 0; }
+	virtual void SaveState(FSaveStateWriter& Writer) const {}
+	virtual std::function<void()> LoadState(FSaveStateReader& Reader, uint16_t Version) { return []() -> void {}; }
+
 protected:
 	virtual void Register() {}
 	virtual void Unregister() {}
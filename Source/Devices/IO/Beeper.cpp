@@ -0,0 +1,206 @@
+#include "Beeper.h"
+
+#include <numbers>
+#include "Utils/Signal/Bus.h"
+#include "Motherboard/Motherboard_ClockGenerator.h"
+
+#define DEVICE_NAME() FName(std::format("{}", ThisDeviceName))
+
+namespace
+{
+	static const char* ThisDeviceName = "Beeper";
+
+	static constexpr uint32_t Taps = 16;					// width of the impulse, half of it is the latency
+	static constexpr uint32_t Phases = 64;					// positions of an edge between two samples
+	static constexpr uint32_t DeltaBufferSize = 4096;		// samples, flushed before an edge runs out of it
+	static constexpr float Volume = 0.4f;
+	static constexpr double Cutoff = 0.9;					// of the Nyquist frequency
+	static constexpr double HighpassFrequency = 10.0;		// Hz
+	static constexpr double TargetLatency = 0.05;			// seconds of samples kept in the ring
+	static constexpr double MaxRateAdjust = 0.005;
+	static constexpr uint32_t LosslessWaitTime = 1;			// ms between the tries to push into a full ring
+	static constexpr uint32_t LosslessTimeout = 1000;		// ms without any room, the consumer is taken as gone
+
+	using FImpulse = std::array<float, Taps>;
+	using FKernel = std::array<FImpulse, Phases>;
+
+	// windowed sinc impulses for every phase, each sums to one;
+	// integrated they give a band-limited step centred half of the taps after the edge
+	const FKernel& GetKernel()
+	{
+		static const FKernel Kernel = []() -> FKernel
+			{
+				constexpr double HalfWidth = Taps / 2;
+
+				FKernel Result;
+				for (uint32_t Phase = 0; Phase < Phases; ++Phase)
+				{
+					std::array<double, Taps> Impulse;
+					double Sum = 0.0;
+					for (uint32_t Tap = 0; Tap < Taps; ++Tap)
+					{
+						const double X = double(Tap) - HalfWidth - double(Phase) / Phases;
+						const double Sinc = X == 0.0 ? 1.0 : std::sin(std::numbers::pi * Cutoff * X) / (std::numbers::pi * Cutoff * X);
+						const double Window = std::abs(X) >= HalfWidth ? 0.0 :
+							0.42 + 0.5 * std::cos(std::numbers::pi * X / HalfWidth) + 0.08 * std::cos(2.0 * std::numbers::pi * X / HalfWidth);
+						Impulse[Tap] = Sinc * Window;
+						Sum += Impulse[Tap];
+					}
+					for (uint32_t Tap = 0; Tap < Taps; ++Tap)
+					{
+						Result[Phase][Tap] = float(Impulse[Tap] / Sum);
+					}
+				}
+				return Result;
+			}();
+		return Kernel;
+	}
+}
+
+FBeeper::FBeeper(double _Frequency, uint32_t _SampleRate /*= Audio::SampleRate*/)
+	: FDevice(DEVICE_NAME(), NAME_Beeper, EDeviceType::IO, _Frequency)
+	, Ring(Audio::RingSize)
+	, SampleRate(_SampleRate)
+	, bWriteLatch(false)
+	, bLevel(false)
+	, bRateControl(false)
+	, bLossless(false)
+	, NominalSamplesPerClock(0.0)
+	, SamplesPerClock(0.0)
+	, OriginClock(0)
+	, OriginFraction(0.0)
+	, Integrator(0.0f)
+	, Leak(float(1.0 - 2.0 * std::numbers::pi * HighpassFrequency / _SampleRate))
+	, Deltas(DeltaBufferSize + Taps, 0.0f)
+	, Samples(DeltaBufferSize, 0)
+{}
+
+void FBeeper::Tick()
+{
+	// the write is taken once, on the edge of IORQ and WR
+	const bool bWrite = SB->IsActive(BUS_IORQ) && SB->IsActive(BUS_WR);
+	if (bWrite == bWriteLatch)
+	{
+		return;
+	}
+	bWriteLatch = bWrite;
+
+	// the ULA answers the even ports
+	if (!bWrite || (SB->GetDataOnAddressBus() & 0x0001) != 0)
+	{
+		return;
+	}
+
+	const bool bNewLevel = (SB->GetDataOnDataBus() & 0x10) != 0;
+	if (bNewLevel != bLevel)
+	{
+		bLevel = bNewLevel;
+		AddEdge(CG->GetClockCounter(), bLevel ? Volume : -Volume);
+	}
+}
+
+void FBeeper::Reset()
+{
+	// the clock counter starts again, the pending edges are played from the start
+	bWriteLatch = false;
+	OriginClock = 0;
+	OriginFraction = 0.0;
+}
+
+void FBeeper::CalculateFrequency(double MainFrequency, uint32_t Sampling)
+{
+	FrequencyDivider = FMath::CeilLogTwo(FMath::RoundToInt32(MainFrequency / Frequency));
+	NominalSamplesPerClock = double(SampleRate) / (MainFrequency * Sampling);
+	SamplesPerClock = NominalSamplesPerClock;
+}
+
+void FBeeper::EndFrame(bool bRealTime)
+{
+	Flush(CG->GetClockCounter(), bRealTime || bLossless);
+
+	// the frame pacing and the sound card run on different clocks, the rate is pulled to the target latency
+	if (bRateControl)
+	{
+		const double Error = std::clamp(double(Ring.Size()) / (SampleRate * TargetLatency) - 1.0, -1.0, 1.0);
+		SamplesPerClock = NominalSamplesPerClock * (1.0 - MaxRateAdjust * Error);
+	}
+}
+
+void FBeeper::AddEdge(uint64_t Clock, float Delta)
+{
+	double Time = ToSampleTime(Clock);
+	if (Time < 0.0 || size_t(Time) + Taps > Deltas.size())
+	{
+		Flush(Clock, true);
+		Time = ToSampleTime(Clock);
+	}
+
+	const size_t Index = size_t(Time);
+	const uint32_t Phase = (std::min)(uint32_t((Time - double(Index)) * Phases), Phases - 1);
+	const FImpulse& Impulse = GetKernel()[Phase];
+	for (uint32_t Tap = 0; Tap < Taps; ++Tap)
+	{
+		Deltas[Index + Tap] += Impulse[Tap] * Delta;
+	}
+}
+
+void FBeeper::Flush(uint64_t Clock, bool bOutput)
+{
+	double Time = ToSampleTime(Clock);
+	if (Time < 0.0)
+	{
+		// the clock counter went back, the time starts over from it
+		OriginClock = Clock;
+		OriginFraction = 0.0;
+		return;
+	}
+
+	// the samples before the clock are final, no later edge reaches back to them
+	size_t Count = size_t(Time);
+	const size_t Limit = Deltas.size() - Taps;
+	if (Count > Limit)
+	{
+		// the clock jumped past the buffer, the rest of the gap is silence
+		Count = Limit;
+		Time = double(Limit);
+	}
+
+	for (size_t Index = 0; Index < Count; ++Index)
+	{
+		Integrator = Integrator * Leak + Deltas[Index];
+		Samples[Index] = int16_t(std::clamp(Integrator, -1.0f, 1.0f) * 32767.0f);
+	}
+	if (bOutput && Count != 0)
+	{
+		Output(Samples.data(), Count);
+	}
+
+	std::copy(Deltas.begin() + Count, Deltas.begin() + Count + Taps, Deltas.begin());
+	std::fill(Deltas.begin() + Taps, Deltas.begin() + Count + Taps, 0.0f);
+	OriginClock = Clock;
+	OriginFraction = Time - double(Count);
+}
+
+void FBeeper::Output(const int16_t* Data, size_t Count)
+{
+	// a full ring drops the rest, unless the consumer has to get everything
+	size_t Pushed = Ring.Push(Data, Count);
+	if (!bLossless)
+	{
+		return;
+	}
+
+	uint32_t WaitTime = 0;
+	while (Pushed < Count && WaitTime < LosslessTimeout)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(LosslessWaitTime));
+		const size_t Step = Ring.Push(Data + Pushed, Count - Pushed);
+		Pushed += Step;
+		WaitTime = Step != 0 ? 0 : WaitTime + LosslessWaitTime;
+	}
+}
+
+double FBeeper::ToSampleTime(uint64_t Clock) const
+{
+	return Clock < OriginClock ? -1.0 : double(Clock - OriginClock) * SamplesPerClock + OriginFraction;
+}
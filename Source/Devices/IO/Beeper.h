@@ -1,6 +1,55 @@
 #pragma once
 
-class FBeeper
+#include <CoreMinimal.h>
+#include "Devices/Device.h"
+#include "Core/Audio.h"
+
+// speaker on bit 4 of the even ports, every I/O write is latched with its clock-counter time
+//
+// a change of the level puts a band-limited step into the delta buffer, so the synthesis costs as much as
+// there are edges; the buffer is integrated into host-rate samples when the frame ends or before it overflows
+class FBeeper : public FDevice
 {
+	using ThisClass = FBeeper;
+public:
+	FBeeper(double _Frequency, uint32_t _SampleRate = Audio::SampleRate);
+	virtual ~FBeeper() = default;
+
+	virtual void Tick() override;
+	virtual void Reset() override;
+	virtual void CalculateFrequency(double MainFrequency, uint32_t Sampling) override;
+
+	// the thread calls it on the frame interrupt, a frame that isn't paced in real time is dropped unless lossless
+	void EndFrame(bool bRealTime);
+	// the rate follows the fill of the ring, only for a consumer at the sound card clock; set before the board runs
+	void SetRateControl(bool bEnable) { bRateControl = bEnable; }
+	// for a consumer that isn't real time: every frame is kept and the thread waits for the room in the ring
+	void SetLossless(bool bEnable) { bLossless = bEnable; }
+
+	FORCEINLINE FAudioRing& GetRing() { return Ring; }
+	FORCEINLINE uint32_t GetSampleRate() const { return SampleRate; }
+
+private:
+	void AddEdge(uint64_t Clock, float Delta);
+	void Flush(uint64_t Clock, bool bOutput);
+	void Output(const int16_t* Data, size_t Count);
+	FORCEINLINE double ToSampleTime(uint64_t Clock) const;
+
+	FAudioRing Ring;
+	uint32_t SampleRate;
+
+	bool bWriteLatch;				// IORQ and WR are active
+	bool bLevel;
+	bool bRateControl;
+	bool bLossless;
+
+	double NominalSamplesPerClock;
+	double SamplesPerClock;			// nudged to keep the ring at the target latency
+	uint64_t OriginClock;			// the clock of the first sample in the delta buffer
+	double OriginFraction;			// the part of the sample the origin is in
 
+	float Integrator;
+	float Leak;						// DC blocker of the integrator
+	std::vector<float> Deltas;
+	std::vector<int16_t> Samples;
 };
@@ -0,0 +1,203 @@
+#include "Keyboard.h"
+
+#include "Utils/Signal/Bus.h"
+#include "Motherboard/Motherboard_ClockGenerator.h"
+#include "Motherboard/Motherboard_SaveState.h"
+
+#define DEVICE_NAME() FName(std::format("{}", ThisDeviceName))
+
+namespace
+{
+	static const char* ThisDeviceName = "Keyboard";
+
+	static constexpr uint8_t KeysPerRow = 5;
+	static constexpr uint8_t UnusedBits = 0xA0;		// bits 5 and 7 are always high
+	static constexpr uint8_t EarBit = 0x40;
+}
+
+FKeyboard::FKeyboard(double _Frequency)
+	: FDevice(DEVICE_NAME(), NAME_Keyboard, EDeviceType::IO, _Frequency)
+	, Rows{}
+	, NextEvent(0)
+	, bRecording(false)
+	, bReplaying(false)
+{}
+
+void FKeyboard::Tick()
+{
+	const uint64_t Clock = CG->GetClockCounter();
+	if (NextEvent < Events.size() && Events[NextEvent].Clock <= Clock)
+	{
+		ApplyEvents(Clock);
+	}
+
+	// the ULA answers the even ports
+	if (SB->IsActive(BUS_IORQ) && SB->IsActive(BUS_RD))
+	{
+		const uint16_t Address = SB->GetDataOnAddressBus();
+		if ((Address & 0x0001) == 0)
+		{
+			SB->SetDataOnDataBus(ReadPort(uint8_t(Address >> 8)));
+		}
+	}
+}
+
+void FKeyboard::Reset()
+{
+	// the clock counter starts again, the stamped events would never come
+	if (bRecording || bReplaying)
+	{
+		LOG("Keyboard: the input log is stopped by the reset");
+	}
+	bRecording = false;
+	bReplaying = false;
+	Events.clear();
+	NextEvent = 0;
+	Rows.fill(0);
+}
+
+void FKeyboard::CalculateFrequency(double MainFrequency, uint32_t Sampling)
+{
+	FrequencyDivider = FMath::CeilLogTwo(FMath::RoundToInt32(MainFrequency / Frequency));
+}
+
+void FKeyboard::SaveState(FSaveStateWriter& Writer) const
+{
+	// the events not taken yet belong to the state, a loaded state sees them on the same clocks
+	for (uint8_t Row : Rows)
+	{
+		Writer.Write(Row);
+	}
+	Writer.Write(uint32_t(Events.size() - NextEvent));
+	for (size_t Index = NextEvent; Index < Events.size(); ++Index)
+	{
+		Writer.Write(Events[Index].Clock);
+		Writer.Write(Events[Index].Key);
+		Writer.Write(Events[Index].bPressed);
+	}
+}
+
+std::function<void()> FKeyboard::LoadState(FSaveStateReader& Reader, uint16_t Version)
+{
+	std::array<uint8_t, 8> NewRows;
+	for (uint8_t& Row : NewRows)
+	{
+		Reader.Read(Row);
+	}
+
+	uint32_t Count = 0;
+	Reader.Read(Count);
+	std::vector<FInputEvent> NewEvents;
+	for (uint32_t Index = 0; Index < Count && Reader.IsValid(); ++Index)
+	{
+		FInputEvent Event;
+		Reader.Read(Event.Clock);
+		Reader.Read(Event.Key);
+		Reader.Read(Event.bPressed);
+		if (Event.Key < EZXKey::Count)
+		{
+			NewEvents.push_back(Event);
+		}
+	}
+	if (!Reader.IsValid())
+	{
+		return nullptr;
+	}
+
+	// a replay keeps its own events
+	return [this, NewRows, NewEvents = std::move(NewEvents)]() -> void
+		{
+			Rows = NewRows;
+			if (!bReplaying)
+			{
+				Events = NewEvents;
+				NextEvent = 0;
+			}
+		};
+}
+
+void FKeyboard::Input(EZXKey::Type Key, bool bPressed)
+{
+	if (bReplaying || Key >= EZXKey::Count)
+	{
+		return;
+	}
+
+	const FInputEvent Event{ CG->GetClockCounter() + 1, Key, bPressed };
+	Events.push_back(Event);
+	if (bRecording)
+	{
+		Recorded.push_back(Event);
+	}
+}
+
+void FKeyboard::StartRecording()
+{
+	// the pending events are replayed from the log, it replaces the queue of the state
+	Recorded.clear();
+	for (size_t Index = NextEvent; Index < Events.size(); ++Index)
+	{
+		Recorded.push_back(Events[Index]);
+	}
+	bRecording = true;
+}
+
+std::vector<FInputEvent> FKeyboard::StopRecording()
+{
+	bRecording = false;
+	return std::move(Recorded);
+}
+
+void FKeyboard::StartReplay(std::vector<FInputEvent>&& _Events)
+{
+	bRecording = false;
+	bReplaying = true;
+	Events = std::move(_Events);
+	NextEvent = 0;
+}
+
+void FKeyboard::StopReplay()
+{
+	if (!bReplaying)
+	{
+		return;
+	}
+
+	bReplaying = false;
+	Events.clear();
+	NextEvent = 0;
+	Rows.fill(0);
+}
+
+void FKeyboard::ApplyEvents(uint64_t Clock)
+{
+	for (; NextEvent < Events.size() && Events[NextEvent].Clock <= Clock; ++NextEvent)
+	{
+		const FInputEvent& Event = Events[NextEvent];
+		const uint8_t Mask = uint8_t(1 << (Event.Key % KeysPerRow));
+		uint8_t& Row = Rows[Event.Key / KeysPerRow];
+		Row = Event.bPressed ? Row | Mask : Row & ~Mask;
+	}
+
+	if (NextEvent == Events.size())
+	{
+		Events.clear();
+		NextEvent = 0;
+	}
+}
+
+uint8_t FKeyboard::ReadPort(uint8_t AddressHigh) const
+{
+	// a low address line selects its half-row, the keys of all selected half-rows pull the bits low together
+	uint8_t Keys = 0;
+	for (uint8_t Row = 0; Row < Rows.size(); ++Row)
+	{
+		if ((AddressHigh & (1 << Row)) == 0)
+		{
+			Keys |= Rows[Row];
+		}
+	}
+
+	const uint8_t Ear = SB->GetSignal(BUS_EAR) == ESignalState::High ? EarBit : 0x00;
+	return UnusedBits | Ear | (~Keys & 0x1F);
+}
@@ -1,6 +1,74 @@
 #pragma once
 
-class FKeyboard
+#include <CoreMinimal.h>
+#include "Devices/Device.h"
+
+// the keys in the order of the matrix, the half-rows of five keys are selected by A8-A15 of the port read
+namespace EZXKey
+{
+	enum Type : uint8_t
+	{
+		CapsShift, Z, X, C, V,				// #FEFE
+		A, S, D, F, G,						// #FDFE
+		Q, W, E, R, T,						// #FBFE
+		_1, _2, _3, _4, _5,					// #F7FE
+		_0, _9, _8, _7, _6,					// #EFFE
+		P, O, I, U, Y,						// #DFFE
+		Enter, L, K, J, H,					// #BFFE
+		Space, SymbolShift, M, N, B,		// #7FFE
+
+		Count,
+	};
+}
+
+// a change of a key, it takes effect on the first tick of the keyboard at or after the clock
+struct FInputEvent
+{
+	uint64_t Clock;
+	EZXKey::Type Key;
+	bool bPressed;
+};
+
+// the 8x5 key matrix read on bits 0-4 of the even ports, bit 6 is the EAR signal
+//
+// every change goes through one queue stamped with the clock counter, the host keys as they come and
+// the replayed ones as they were recorded; so a replay sees the keys on the same clocks as the recording did
+class FKeyboard : public FDevice
 {
+	using ThisClass = FKeyboard;
+public:
+	FKeyboard(double _Frequency);
+	virtual ~FKeyboard() = default;
+
+	virtual void Tick() override;
+	virtual void Reset() override;
+	virtual void CalculateFrequency(double MainFrequency, uint32_t Sampling) override;
+	virtual uint16_t GetStateVersion() const override { return 1; }
+	virtual void SaveState(FSaveStateWriter& Writer) const override;
+	virtual std::function<void()> LoadState(FSaveStateReader& Reader, uint16_t Version) override;
+
+	// the key changes on the next clock, the host keys are ignored while replaying
+	void Input(EZXKey::Type Key, bool bPressed);
+
+	void StartRecording();
+	std::vector<FInputEvent> StopRecording();
+	void StartReplay(std::vector<FInputEvent>&& Events);
+	void StopReplay();
+
+	FORCEINLINE bool IsRecording() const { return bRecording; }
+	FORCEINLINE bool IsReplaying() const { return bReplaying; }
+	FORCEINLINE size_t GetPendingCount() const { return Events.size() - NextEvent; }
+	FORCEINLINE size_t GetRecordedCount() const { return Recorded.size(); }
+
+private:
+	void ApplyEvents(uint64_t Clock);
+	uint8_t ReadPort(uint8_t AddressHigh) const;
+
+	std::array<uint8_t, 8> Rows;			// a set bit is a pressed key
+	std::vector<FInputEvent> Events;		// in the order of the clock
+	size_t NextEvent;
+	std::vector<FInputEvent> Recorded;
 
+	bool bRecording;
+	bool bReplaying;
 };
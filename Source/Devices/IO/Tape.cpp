@@ -0,0 +1,238 @@
+#include "Tape.h"
+
+#include "Utils/Signal/Bus.h"
+#include "Motherboard/Motherboard_ClockGenerator.h"
+#include "Motherboard/Motherboard_SaveState.h"
+
+#define DEVICE_NAME() FName(std::format("{}", ThisDeviceName))
+
+namespace
+{
+	static const char* ThisDeviceName = "Tape";
+}
+
+FTape::FTape(double _Frequency)
+	: FDevice(DEVICE_NAME(), NAME_Tape, EDeviceType::IO, _Frequency)
+	, LoadMode(ETapeLoadMode::Normal)
+	, bPlaying(false)
+	, bLevel(false)
+	, TStateShift(0)
+	, NextPulse(0)
+	, LatestTState(0)
+{}
+
+void FTape::Tick()
+{
+	if (!bPlaying)
+	{
+		return;
+	}
+
+	const uint64_t TStates = GetTStates();
+	LatestTState = TStates;
+	while (TStates >= NextPulse)
+	{
+		FTapePulse Pulse;
+		if (!Generator.Next(Image, Pulse))
+		{
+			// the end of the tape or a stop block
+			Stop();
+			SetLevel(false);
+			return;
+		}
+
+		SetLevel(Pulse.bToggle ? !bLevel : false);
+		NextPulse += Pulse.Duration;
+	}
+}
+
+void FTape::Reset()
+{
+	// the clock counter starts again, the tape keeps going
+	NextPulse = NextPulse > LatestTState ? NextPulse - LatestTState : 0;
+	LatestTState = 0;
+}
+
+void FTape::CalculateFrequency(double MainFrequency, uint32_t Sampling)
+{
+	FrequencyDivider = FMath::CeilLogTwo(FMath::RoundToInt32(MainFrequency / Frequency));
+	TStateShift = FMath::CeilLogTwo(Sampling) + FrequencyDivider;
+}
+
+void FTape::SaveState(FSaveStateWriter& Writer) const
+{
+	// the image stays on the disk, the tape is wound to the start of the playing block
+	const std::u8string Path = FilePath.u8string();
+	Writer.WriteString(std::string_view(reinterpret_cast<const char*>(Path.data()), Path.size()));
+	Writer.Write(uint32_t(Generator.GetBlockIndex()));
+	Writer.Write(LoadMode);
+	Writer.Write(bPlaying);
+}
+
+std::function<void()> FTape::LoadState(FSaveStateReader& Reader, uint16_t Version)
+{
+	std::string Path;
+	uint32_t BlockIndex = 0;
+	ETapeLoadMode::Type NewLoadMode = ETapeLoadMode::Normal;
+	bool bNewPlaying = false;
+	Reader.ReadString(Path);
+	Reader.Read(BlockIndex);
+	Reader.Read(NewLoadMode);
+	Reader.Read(bNewPlaying);
+	if (!Reader.IsValid())
+	{
+		return nullptr;
+	}
+
+	const std::filesystem::path NewFilePath = std::u8string(Path.begin(), Path.end());
+	return [=, this]() -> void
+		{
+			if (NewFilePath.empty())
+			{
+				Control(ETapeControl::Eject);
+			}
+			else if (NewFilePath != FilePath && !Insert(NewFilePath))
+			{
+				LOG("Tape: the image of the save-state is missing: {}", Path.c_str());
+			}
+
+			Stop();
+			SetLevel(false);
+			Generator.Seek(BlockIndex);
+			LoadMode = NewLoadMode;
+			if (bNewPlaying)
+			{
+				Play();
+			}
+		};
+}
+
+bool FTape::Insert(const std::filesystem::path& _FilePath)
+{
+	Stop();
+	SetLevel(false);
+
+	if (!Image.Load(_FilePath))
+	{
+		FilePath.clear();
+		Generator.Seek(0);
+		return false;
+	}
+
+	FilePath = _FilePath;
+	Generator.Seek(0);
+	return true;
+}
+
+void FTape::Control(ETapeControl::Type Control)
+{
+	switch (Control)
+	{
+		case ETapeControl::Play:
+		{
+			Play();
+			break;
+		}
+		case ETapeControl::Stop:
+		{
+			Stop();
+			break;
+		}
+		case ETapeControl::Rewind:
+		{
+			Generator.Seek(0);
+			SetLevel(false);
+			NextPulse = GetTStates();
+			break;
+		}
+		case ETapeControl::Eject:
+		{
+			Stop();
+			SetLevel(false);
+			Image.Clear();
+			FilePath.clear();
+			Generator.Seek(0);
+			break;
+		}
+	}
+}
+
+void FTape::SetLoadMode(ETapeLoadMode::Type Mode)
+{
+	LoadMode = Mode;
+}
+
+FTapeStatus FTape::GetStatus() const
+{
+	return FTapeStatus
+	{
+		.bInserted = !Image.IsEmpty(),
+		.bPlaying = bPlaying,
+		.LoadMode = LoadMode,
+		.FilePath = FilePath,
+		.BlockIndex = Generator.GetBlockIndex(),
+		.BlockCount = Image.GetBlocks().size(),
+	};
+}
+
+const FTapeBlock* FTape::TakeDataBlock()
+{
+	const std::vector<FTapeBlock>& Blocks = Image.GetBlocks();
+
+	// the block whose data is playing is too late for the loader
+	size_t BlockIndex = Generator.GetBlockIndex();
+	if (!Generator.IsBeforeData() && !Generator.IsStopped())
+	{
+		++BlockIndex;
+	}
+
+	for (; BlockIndex < Blocks.size(); ++BlockIndex)
+	{
+		const FTapeBlock& Block = Blocks[BlockIndex];
+		if (Block.Type == ETapeBlockType::Pause || Block.Type == ETapeBlockType::Stop)
+		{
+			continue;
+		}
+		if (Block.Type != ETapeBlockType::Data || Block.PilotPulses == 0)
+		{
+			return nullptr;
+		}
+
+		Generator.Seek(BlockIndex + 1);
+		SetLevel(false);
+		NextPulse = GetTStates();
+		return &Block;
+	}
+	return nullptr;
+}
+
+uint64_t FTape::GetTStates() const
+{
+	return CG != nullptr ? CG->GetClockCounter() >> TStateShift : 0;
+}
+
+void FTape::Play()
+{
+	if (Image.IsEmpty() || bPlaying)
+	{
+		return;
+	}
+
+	bPlaying = true;
+	Generator.Resume();
+	NextPulse = GetTStates();
+}
+
+void FTape::Stop()
+{
+	bPlaying = false;
+}
+
+void FTape::SetLevel(bool bHigh)
+{
+	bLevel = bHigh;
+	if (SB != nullptr)
+	{
+		SB->SetSignal(BUS_EAR, bLevel ? ESignalState::High : ESignalState::Low);
+	}
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <CoreMinimal.h>
+#include "Devices/Device.h"
+#include "TapeImage.h"
+
+namespace ETapeLoadMode
+{
+	enum Type : uint8_t
+	{
+		Normal,			// the edges in real time
+		Accelerated,	// the edges are exact, the emulation isn't throttled while the tape is playing
+		FastLoad,		// the ROM loader is trapped and gets the blocks at once, the rest is accelerated
+	};
+}
+
+namespace ETapeControl
+{
+	enum Type : uint8_t
+	{
+		Play,
+		Stop,
+		Rewind,
+		Eject,
+	};
+}
+
+struct FTapeStatus
+{
+	bool bInserted = false;
+	bool bPlaying = false;
+	ETapeLoadMode::Type LoadMode = ETapeLoadMode::Normal;
+	std::filesystem::path FilePath;
+	size_t BlockIndex = 0;
+	size_t BlockCount = 0;
+};
+
+// cassette recorder, the blocks of the image are played as edges on the EAR signal
+// timed in T-states of the clock generator
+class FTape : public FDevice
+{
+	using ThisClass = FTape;
+public:
+	FTape(double _Frequency);
+	virtual ~FTape() = default;
+
+	virtual void Tick() override;
+	virtual void Reset() override;
+	virtual void CalculateFrequency(double MainFrequency, uint32_t Sampling) override;
+	virtual uint16_t GetStateVersion() const override { return 1; }
+	virtual void SaveState(FSaveStateWriter& Writer) const override;
+	virtual std::function<void()> LoadState(FSaveStateReader& Reader, uint16_t Version) override;
+
+	bool Insert(const std::filesystem::path& FilePath);
+	void Control(ETapeControl::Type Control);
+	void SetLoadMode(ETapeLoadMode::Type Mode);
+
+	FORCEINLINE ETapeLoadMode::Type GetLoadMode() const { return LoadMode; }
+	FORCEINLINE bool IsPlaying() const { return bPlaying; }
+	FORCEINLINE bool IsAccelerated() const { return bPlaying && LoadMode != ETapeLoadMode::Normal; }
+	FTapeStatus GetStatus() const;
+
+	// the next block the ROM is able to load, the tape is wound behind it, nullptr if a custom loader block is next
+	const FTapeBlock* TakeDataBlock();
+
+private:
+	FORCEINLINE uint64_t GetTStates() const;
+	void Play();
+	void Stop();
+	void SetLevel(bool bHigh);
+
+	FTapeImage Image;
+	FTapePulseGenerator Generator;
+	std::filesystem::path FilePath;
+	ETapeLoadMode::Type LoadMode;
+
+	bool bPlaying;
+	bool bLevel;
+	uint32_t TStateShift;			// the clock counter to T-states
+	uint64_t NextPulse;				// T-state of the next pulse
+	uint64_t LatestTState;
+};
@@ -0,0 +1,484 @@
+#include "TapeImage.h"
+
+namespace
+{
+	static const char TZX_Signature[] = "ZXTape!\x1A";
+	static constexpr size_t TZX_HeaderSize = 10;
+
+	// the loops are unrolled into copies of the blocks, a crafted image must not blow the memory up
+	static constexpr size_t TZX_MaxUnrolledBlocks = 1 << 16;
+	static constexpr size_t TZX_MaxUnrolledBytes = 64 << 20;
+
+	size_t GetBlockBytes(const FTapeBlock& Block)
+	{
+		return sizeof(FTapeBlock) + Block.Data.size() + Block.Pulses.size() * sizeof(uint16_t);
+	}
+
+	// the blocks are read from memory, every read is checked against the end of the file
+	class FReader
+	{
+	public:
+		FReader(const std::vector<uint8_t>& _File, size_t _Offset)
+			: File(_File)
+			, Offset(_Offset)
+			, bOverflow(false)
+		{}
+
+		FORCEINLINE bool IsEnd() const { return Offset >= File.size(); }
+		FORCEINLINE bool IsOverflow() const { return bOverflow; }
+		FORCEINLINE size_t GetOffset() const { return Offset; }
+
+		uint32_t Read(uint32_t Size)
+		{
+			if (Offset + Size > File.size())
+			{
+				bOverflow = true;
+				Offset = File.size();
+				return 0;
+			}
+
+			uint32_t Value = 0;
+			for (uint32_t Index = 0; Index < Size; ++Index)
+			{
+				Value |= uint32_t(File[Offset++]) << (Index * 8);
+			}
+			return Value;
+		}
+		FORCEINLINE uint8_t Read8() { return uint8_t(Read(1)); }
+		FORCEINLINE uint16_t Read16() { return uint16_t(Read(2)); }
+		FORCEINLINE uint32_t Read24() { return Read(3); }
+		FORCEINLINE uint32_t Read32() { return Read(4); }
+
+		void ReadBytes(std::vector<uint8_t>& Output, size_t Size)
+		{
+			if (Offset + Size > File.size())
+			{
+				bOverflow = true;
+				Offset = File.size();
+				return;
+			}
+			Output.assign(File.begin() + Offset, File.begin() + Offset + Size);
+			Offset += Size;
+		}
+
+		void Skip(size_t Size)
+		{
+			if (Offset + Size > File.size())
+			{
+				bOverflow = true;
+				Offset = File.size();
+				return;
+			}
+			Offset += Size;
+		}
+
+	private:
+		const std::vector<uint8_t>& File;
+		size_t Offset;
+		bool bOverflow;
+	};
+
+	// a ROM block: the header has the flag 0x00, the pilot tone of the data is shorter
+	FTapeBlock MakeStandardBlock(std::vector<uint8_t>&& Data, uint16_t PauseMs)
+	{
+		FTapeBlock Block;
+		Block.Type = ETapeBlockType::Data;
+		Block.PilotPulses = !Data.empty() && Data[0] < 0x80 ? Tape::HeaderPilotPulses : Tape::DataPilotPulses;
+		Block.PauseMs = PauseMs;
+		Block.Data = std::move(Data);
+		return Block;
+	}
+}
+
+bool FTapeImage::Load(const std::filesystem::path& FilePath)
+{
+	Clear();
+
+	std::ifstream File(FilePath, std::ios::in | std::ios::binary);
+	if (!File.is_open())
+	{
+		LOG("Could not open the file: {}", FilePath.string().c_str());
+		return false;
+	}
+
+	const std::vector<uint8_t> Content((std::istreambuf_iterator<char>(File)), std::istreambuf_iterator<char>());
+	File.close();
+
+	const bool bTZX = Content.size() >= TZX_HeaderSize && std::memcmp(Content.data(), TZX_Signature, sizeof(TZX_Signature) - 1) == 0;
+	const bool bLoaded = bTZX ? Load_TZX(Content) : Load_TAP(Content);
+	if (!bLoaded || Blocks.empty())
+	{
+		LOG("Tape: the image is empty or damaged: {}", FilePath.string().c_str());
+		Clear();
+		return false;
+	}
+
+	LOG("Tape: {} blocks in {}", Blocks.size(), FilePath.string().c_str());
+	return true;
+}
+
+void FTapeImage::Clear()
+{
+	Blocks.clear();
+}
+
+bool FTapeImage::Load_TAP(const std::vector<uint8_t>& File)
+{
+	// { u16 length, flag, bytes, checksum }...
+	FReader Reader(File, 0);
+	while (!Reader.IsEnd())
+	{
+		const uint16_t Length = Reader.Read16();
+		std::vector<uint8_t> Data;
+		Reader.ReadBytes(Data, Length);
+		if (Reader.IsOverflow())
+		{
+			// keep what was complete, the tail of a cut file is lost
+			break;
+		}
+		Blocks.push_back(MakeStandardBlock(std::move(Data), Tape::PauseMs));
+	}
+	return !Blocks.empty();
+}
+
+bool FTapeImage::Load_TZX(const std::vector<uint8_t>& File)
+{
+	FReader Reader(File, TZX_HeaderSize);
+	std::vector<std::pair<size_t, uint16_t>> Loops;			// the first block and the repetitions of the open loops
+	size_t UnrolledBytes = 0;
+
+	while (!Reader.IsEnd() && !Reader.IsOverflow())
+	{
+		const uint8_t ID = Reader.Read8();
+		switch (ID)
+		{
+			case 0x10:		// standard speed data
+			{
+				const uint16_t PauseMs = Reader.Read16();
+				std::vector<uint8_t> Data;
+				Reader.ReadBytes(Data, Reader.Read16());
+				Blocks.push_back(MakeStandardBlock(std::move(Data), PauseMs));
+				break;
+			}
+			case 0x11:		// turbo speed data
+			{
+				FTapeBlock Block;
+				Block.Type = ETapeBlockType::Data;
+				Block.PilotPulse = Reader.Read16();
+				Block.Sync1Pulse = Reader.Read16();
+				Block.Sync2Pulse = Reader.Read16();
+				Block.ZeroPulse = Reader.Read16();
+				Block.OnePulse = Reader.Read16();
+				Block.PilotPulses = Reader.Read16();
+				Block.UsedBits = Reader.Read8();
+				Block.PauseMs = Reader.Read16();
+				Reader.ReadBytes(Block.Data, Reader.Read24());
+				Blocks.push_back(std::move(Block));
+				break;
+			}
+			case 0x12:		// pure tone
+			{
+				FTapeBlock Block;
+				Block.Type = ETapeBlockType::Tone;
+				Block.Pulses = { Reader.Read16() };
+				Block.ToneCount = Reader.Read16();
+				Blocks.push_back(std::move(Block));
+				break;
+			}
+			case 0x13:		// pulse sequence
+			{
+				FTapeBlock Block;
+				Block.Type = ETapeBlockType::Pulses;
+				Block.Pulses.resize(Reader.Read8());
+				for (uint16_t& Pulse : Block.Pulses)
+				{
+					Pulse = Reader.Read16();
+				}
+				Blocks.push_back(std::move(Block));
+				break;
+			}
+			case 0x14:		// pure data
+			{
+				FTapeBlock Block;
+				Block.Type = ETapeBlockType::Data;
+				Block.ZeroPulse = Reader.Read16();
+				Block.OnePulse = Reader.Read16();
+				Block.UsedBits = Reader.Read8();
+				Block.PauseMs = Reader.Read16();
+				Reader.ReadBytes(Block.Data, Reader.Read24());
+				Blocks.push_back(std::move(Block));
+				break;
+			}
+			case 0x20:		// pause, zero stops the tape
+			{
+				FTapeBlock Block;
+				Block.PauseMs = Reader.Read16();
+				Block.Type = Block.PauseMs != 0 ? ETapeBlockType::Pause : ETapeBlockType::Stop;
+				Blocks.push_back(std::move(Block));
+				break;
+			}
+			case 0x2A:		// stop the tape in 48K mode
+			{
+				Reader.Skip(Reader.Read32());
+				FTapeBlock Block;
+				Block.Type = ETapeBlockType::Stop;
+				Blocks.push_back(std::move(Block));
+				break;
+			}
+			case 0x24:		// loop start
+			{
+				Loops.push_back({ Blocks.size(), Reader.Read16() });
+				break;
+			}
+			case 0x25:		// loop end
+			{
+				if (Loops.empty())
+				{
+					break;
+				}
+
+				const auto [First, Repetitions] = Loops.back();
+				Loops.pop_back();
+
+				const size_t Last = Blocks.size();
+				if (Repetitions <= 1 || First == Last)
+				{
+					break;
+				}
+
+				size_t LoopBytes = 0;
+				for (size_t BlockIndex = First; BlockIndex < Last; ++BlockIndex)
+				{
+					LoopBytes += GetBlockBytes(Blocks[BlockIndex]);
+				}
+
+				const size_t Copies = Repetitions - 1;
+				if (Last + (Last - First) * Copies > TZX_MaxUnrolledBlocks ||
+					UnrolledBytes + LoopBytes * Copies > TZX_MaxUnrolledBytes)
+				{
+					LOG_ERROR("[{}]\t the loop at #{:X} unrolls into too many blocks, the image is rejected", (__FUNCTION__), Reader.GetOffset());
+					Blocks.clear();
+					return false;
+				}
+				UnrolledBytes += LoopBytes * Copies;
+
+				Blocks.reserve(Last + (Last - First) * (std::max)(Repetitions, uint16_t(1)));
+				for (uint16_t Index = 1; Index < Repetitions; ++Index)
+				{
+					for (size_t BlockIndex = First; BlockIndex < Last; ++BlockIndex)
+					{
+						Blocks.push_back(Blocks[BlockIndex]);
+					}
+				}
+				break;
+			}
+			case 0x21: Reader.Skip(Reader.Read8());						break;		// group start
+			case 0x22:													break;		// group end
+			case 0x23: Reader.Skip(2);									break;		// jump to block
+			case 0x26: Reader.Skip(size_t(Reader.Read16()) * 2);		break;		// call sequence
+			case 0x27:													break;		// return from sequence
+			case 0x28: Reader.Skip(Reader.Read16());					break;		// select block
+			case 0x30: Reader.Skip(Reader.Read8());						break;		// text description
+			case 0x31: Reader.Skip(1); Reader.Skip(Reader.Read8());		break;		// message
+			case 0x32: Reader.Skip(Reader.Read16());					break;		// archive info
+			case 0x33: Reader.Skip(size_t(Reader.Read8()) * 3);			break;		// hardware type
+			case 0x35: Reader.Skip(16); Reader.Skip(Reader.Read32());	break;		// custom info
+			case 0x5A: Reader.Skip(9);									break;		// glue
+			case 0x15:		// direct recording
+			{
+				Reader.Skip(5);
+				Reader.Skip(Reader.Read24());
+				LOG("Tape: the direct recording block at #{:X} isn't supported", Reader.GetOffset());
+				break;
+			}
+			default:
+			{
+				// CSW, generalized data and the blocks of the later versions start with the length
+				LOG("Tape: the block #{:02X} isn't supported", ID);
+				Reader.Skip(Reader.Read32());
+				break;
+			}
+		}
+	}
+
+	if (Reader.IsOverflow())
+	{
+		LOG("Tape: the image is cut off at #{:X}", File.size());
+	}
+	return !Blocks.empty();
+}
+
+FTapePulseGenerator::FTapePulseGenerator()
+	: Stage(EStage::End)
+	, BlockIndex(0)
+	, Counter(0)
+	, BitCount(0)
+{}
+
+void FTapePulseGenerator::Seek(size_t _BlockIndex)
+{
+	BlockIndex = _BlockIndex;
+	Stage = EStage::Begin;
+	Counter = 0;
+	BitCount = 0;
+}
+
+void FTapePulseGenerator::Resume()
+{
+	if (Stage == EStage::Stop)
+	{
+		Stage = EStage::Begin;
+	}
+}
+
+void FTapePulseGenerator::NextBlock()
+{
+	++BlockIndex;
+	Stage = EStage::Begin;
+	Counter = 0;
+}
+
+bool FTapePulseGenerator::Next(const FTapeImage& Image, FTapePulse& OutPulse)
+{
+	const std::vector<FTapeBlock>& Blocks = Image.GetBlocks();
+	while (true)
+	{
+		if (Stage == EStage::Stop || Stage == EStage::End)
+		{
+			return false;
+		}
+
+		if (BlockIndex >= Blocks.size())
+		{
+			Stage = EStage::End;
+			return false;
+		}
+
+		const FTapeBlock& Block = Blocks[BlockIndex];
+		switch (Stage)
+		{
+			case EStage::Begin:
+			{
+				Counter = 0;
+				switch (Block.Type)
+				{
+					case ETapeBlockType::Data:
+					{
+						BitCount = Block.Data.empty() ? 0 : uint32_t(Block.Data.size() - 1) * 8 + (std::min)(Block.UsedBits, uint8_t(8));
+						Stage = Block.PilotPulses != 0 ? EStage::Pilot : EStage::Data;
+						break;
+					}
+					case ETapeBlockType::Tone:		Stage = EStage::Tone;			break;
+					case ETapeBlockType::Pulses:	Stage = EStage::Sequence;		break;
+					case ETapeBlockType::Pause:		Stage = EStage::Pause;			break;
+					case ETapeBlockType::Stop:
+					{
+						NextBlock();
+						Stage = EStage::Stop;
+						return false;
+					}
+				}
+				break;
+			}
+			case EStage::Pilot:
+			{
+				if (Counter < Block.PilotPulses)
+				{
+					++Counter;
+					OutPulse = { Block.PilotPulse, true };
+					return true;
+				}
+				Stage = EStage::Sync1;
+				break;
+			}
+			case EStage::Sync1:
+			{
+				Stage = EStage::Sync2;
+				if (Block.Sync1Pulse != 0)
+				{
+					OutPulse = { Block.Sync1Pulse, true };
+					return true;
+				}
+				break;
+			}
+			case EStage::Sync2:
+			{
+				Stage = EStage::Data;
+				Counter = 0;
+				if (Block.Sync2Pulse != 0)
+				{
+					OutPulse = { Block.Sync2Pulse, true };
+					return true;
+				}
+				break;
+			}
+			case EStage::Data:
+			{
+				// two pulses of the same length for each bit, the most significant bit first
+				if (Counter < BitCount * 2)
+				{
+					const uint32_t Bit = Counter >> 1;
+					const bool bOne = (Block.Data[Bit >> 3] >> (7 - (Bit & 7))) & 1;
+					++Counter;
+					OutPulse = { bOne ? Block.OnePulse : Block.ZeroPulse, true };
+					return true;
+				}
+				Stage = EStage::Pause;
+				Counter = 0;
+				break;
+			}
+			case EStage::Tone:
+			{
+				if (Counter < Block.ToneCount && !Block.Pulses.empty())
+				{
+					++Counter;
+					OutPulse = { Block.Pulses.front(), true };
+					return true;
+				}
+				NextBlock();
+				break;
+			}
+			case EStage::Sequence:
+			{
+				if (Counter < Block.Pulses.size())
+				{
+					OutPulse = { Block.Pulses[Counter++], true };
+					return true;
+				}
+				NextBlock();
+				break;
+			}
+			case EStage::Pause:
+			{
+				// the last pulse is ended by an edge, after a millisecond the level goes low
+				if (Block.PauseMs == 0)
+				{
+					NextBlock();
+					break;
+				}
+				if (Counter == 0 && Block.Type != ETapeBlockType::Pause)
+				{
+					Counter = 1;
+					OutPulse = { Tape::TStatesPerMs, true };
+					return true;
+				}
+				if (Counter <= 1)
+				{
+					Counter = 2;
+					const uint32_t PauseMs = Block.Type != ETapeBlockType::Pause ? Block.PauseMs - 1u : Block.PauseMs;
+					if (PauseMs != 0)
+					{
+						OutPulse = { PauseMs * Tape::TStatesPerMs, false };
+						return true;
+					}
+				}
+				NextBlock();
+				break;
+			}
+			default:
+			{
+				return false;
+			}
+		}
+	}
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <CoreMinimal.h>
+
+namespace Tape
+{
+	// 48K timings in T-states
+	static constexpr uint32_t TStatesPerMs = 3500;
+	static constexpr uint16_t PilotPulse = 2168;
+	static constexpr uint16_t HeaderPilotPulses = 8063;
+	static constexpr uint16_t DataPilotPulses = 3223;
+	static constexpr uint16_t Sync1Pulse = 667;
+	static constexpr uint16_t Sync2Pulse = 735;
+	static constexpr uint16_t ZeroPulse = 855;
+	static constexpr uint16_t OnePulse = 1710;
+	static constexpr uint16_t PauseMs = 1000;
+}
+
+namespace ETapeBlockType
+{
+	enum Type : uint8_t
+	{
+		Data,			// pilot tone, sync pulses and data, a pure data block has no pilot
+		Tone,			// the same pulse repeated
+		Pulses,			// sequence of pulses of different length
+		Pause,			// silence, the level is low
+		Stop,			// the tape stops by itself
+	};
+}
+
+struct FTapeBlock
+{
+	ETapeBlockType::Type Type = ETapeBlockType::Data;
+	uint16_t PilotPulse = Tape::PilotPulse;
+	uint16_t PilotPulses = 0;
+	uint16_t Sync1Pulse = Tape::Sync1Pulse;
+	uint16_t Sync2Pulse = Tape::Sync2Pulse;
+	uint16_t ZeroPulse = Tape::ZeroPulse;
+	uint16_t OnePulse = Tape::OnePulse;
+	uint8_t UsedBits = 8;						// in the last byte
+	uint16_t PauseMs = 0;						// after the block
+	std::vector<uint16_t> Pulses;				// Tone: one pulse, Pulses: the sequence
+	uint32_t ToneCount = 0;
+	std::vector<uint8_t> Data;					// flag, bytes, checksum of a ROM block
+};
+
+// .tap and .tzx images as a list of blocks of pulses,
+// the TZX blocks that don't produce a signal (texts, groups, archive info) are skipped, loops are unrolled
+class FTapeImage
+{
+public:
+	bool Load(const std::filesystem::path& FilePath);
+	void Clear();
+
+	FORCEINLINE bool IsEmpty() const { return Blocks.empty(); }
+	FORCEINLINE const std::vector<FTapeBlock>& GetBlocks() const { return Blocks; }
+
+private:
+	bool Load_TAP(const std::vector<uint8_t>& File);
+	bool Load_TZX(const std::vector<uint8_t>& File);
+
+	std::vector<FTapeBlock> Blocks;
+};
+
+struct FTapePulse
+{
+	uint32_t Duration;			// T-states until the next pulse
+	bool bToggle;				// the level is inverted at the start of the pulse, otherwise it goes low
+};
+
+// walks the blocks of an image pulse by pulse
+class FTapePulseGenerator
+{
+public:
+	FTapePulseGenerator();
+
+	void Seek(size_t BlockIndex);
+	bool Next(const FTapeImage& Image, FTapePulse& OutPulse);
+
+	FORCEINLINE size_t GetBlockIndex() const { return BlockIndex; }
+	FORCEINLINE bool IsStopped() const { return Stage == EStage::Stop || Stage == EStage::End; }
+	// the current block is a data block which hasn't started its data yet
+	FORCEINLINE bool IsBeforeData() const { return Stage == EStage::Begin || Stage == EStage::Pilot || Stage == EStage::Sync1 || Stage == EStage::Sync2; }
+	// the tape was stopped by a block, playing carries on with the next one
+	void Resume();
+
+private:
+	enum class EStage
+	{
+		Begin,
+		Pilot,
+		Sync1,
+		Sync2,
+		Data,
+		Tone,
+		Sequence,
+		Pause,
+		Stop,
+		End,
+	};
+
+	void NextBlock();
+
+	EStage Stage;
+	size_t BlockIndex;
+	uint32_t Counter;			// pulses of the stage
+	uint32_t BitCount;			// data bits of the block
+};
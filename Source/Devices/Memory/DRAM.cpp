@@ -1,6 +1,7 @@
 #include "DRAM.h"
 
 #include "Motherboard/Motherboard_ClockGenerator.h"
+#include "Motherboard/Motherboard_SaveState.h"
 
 #define DEVICE_NAME(Type) FName(std::format("{} {}", ThisDeviceName, ThisClass::ToString(Type)))
 
@@ -153,6 +154,52 @@ void FDRAM::Tick()
 
 void FDRAM::Snapshot(FMemorySnapshot& InOutMemorySnaphot, EMemoryOperationType Type)
 {
+	if (Type == EMemoryOperationType::Read)
+	{
+		FDataBlock DataBlock
+		{
+			.DeviceName = DeviceName,
+			.BlockName = "RAM",
+			.bReadOnlyMode = false,
+			.State = EDataBlockState::Actived,
+			.PlacementAddress = PlacementAddress,
+			.Data = RawData,
+		};
+		InOutMemorySnaphot.AddDataBlock(DataBlock);
+	}
+	else if (Type == EMemoryOperationType::Write)
+	{
+		for (FDataBlock& DataBlock : InOutMemorySnaphot.DataBlocks)
+		{
+			if (DataBlock.DeviceName != DeviceName)
+			{
+				continue;
+			}
+
+			const size_t CopySize = FMath::Min(DataBlock.Data.size(), RawData.size());
+			std::ranges::copy(DataBlock.Data.begin(), DataBlock.Data.begin() + CopySize, RawData.begin());
+		}
+	}
+}
+
+void FDRAM::SaveState(FSaveStateWriter& Writer) const
+{
+	// a failed write drops the chunk and fails the writer, the save is given up
+	Writer.WriteMemory(RawData.data(), uint32_t(RawData.size()));
+}
+
+std::function<void()> FDRAM::LoadState(FSaveStateReader& Reader, uint16_t Version)
+{
+	std::shared_ptr<std::vector<uint8_t>> NewData = std::make_shared<std::vector<uint8_t>>(RawData.size());
+	if (!Reader.ReadMemory(NewData->data(), uint32_t(NewData->size())))
+	{
+		return nullptr;
+	}
+
+	return [this, NewData]() -> void
+		{
+			RawData.swap(*NewData);
+		};
 }
 
 void FDRAM::Load(const std::filesystem::path& FilePath)
@@ -23,6 +23,9 @@ public:
 	virtual void Tick() override;
 	virtual void Snapshot(FMemorySnapshot& InOutMemorySnaphot, EMemoryOperationType Type) override;
 	virtual void Load(const std::filesystem::path& FilePath) override;
+	virtual uint16_t GetStateVersion() const override { return 1; }
+	virtual void SaveState(FSaveStateWriter& Writer) const override;
+	virtual std::function<void()> LoadState(FSaveStateReader& Reader, uint16_t Version) override;
 
 private:
 	EDRAM_Type Type;
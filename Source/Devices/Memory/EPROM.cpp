@@ -1,6 +1,7 @@
 #include "EPROM.h"
 
 #include "Motherboard/Motherboard_ClockGenerator.h"
+#include "Motherboard/Motherboard_SaveState.h"
 
 #define DEVICE_NAME(Type) FName(std::format("{} {}", ThisDeviceName, ThisClass::ToString(Type)))
 
@@ -145,6 +146,30 @@ void FEPROM::Snapshot(FMemorySnapshot& InOutMemorySnaphot, EMemoryOperationType
 	}
 }
 
+void FEPROM::SaveState(FSaveStateWriter& Writer) const
+{
+	// the firmware may have been replaced or written while it wasn't read-only,
+	// a failed write drops the chunk and fails the writer, the save is given up
+	Writer.Write(bReadOnlyMode);
+	Writer.WriteMemory(Firmware.data(), uint32_t(Firmware.size()));
+}
+
+std::function<void()> FEPROM::LoadState(FSaveStateReader& Reader, uint16_t Version)
+{
+	bool bNewReadOnlyMode = true;
+	std::shared_ptr<std::vector<uint8_t>> NewFirmware = std::make_shared<std::vector<uint8_t>>(Firmware.size());
+	if (!Reader.Read(bNewReadOnlyMode) || !Reader.ReadMemory(NewFirmware->data(), uint32_t(NewFirmware->size())))
+	{
+		return nullptr;
+	}
+
+	return [this, bNewReadOnlyMode, NewFirmware]() -> void
+		{
+			bReadOnlyMode = bNewReadOnlyMode;
+			Firmware.swap(*NewFirmware);
+		};
+}
+
 void FEPROM::Load(const std::filesystem::path& FilePath)
 {
 	std::error_code ec;
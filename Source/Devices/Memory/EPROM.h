@@ -28,6 +28,9 @@ public:
 	virtual void Snapshot(FMemorySnapshot& InOutMemorySnaphot, EMemoryOperationType Type) override;
 	virtual void Load(const std::filesystem::path& FilePath) override;
 	virtual void SetReadOnlyMode(bool bEnable = true) override;
+	virtual uint16_t GetStateVersion() const override { return 1; }
+	virtual void SaveState(FSaveStateWriter& Writer) const override;
+	virtual std::function<void()> LoadState(FSaveStateReader& Reader, uint16_t Version) override;
 
 private:
 	EEPROM_Type Type;
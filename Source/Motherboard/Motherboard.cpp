@@ -37,7 +37,7 @@ void FMotherboard::AddBoard(FName Name, EName::Type UniqueID, std::vector<std::s
 void FMotherboard::Inut_Debugger()
 {
 	bFlipFlopDebugger = !bFlipFlopDebugger;
-	LOG(bFlipFlopDebugger ? "Enter debugger" : "Escepe debugger");
+	LOG("{}", bFlipFlopDebugger ? "Enter debugger" : "Escepe debugger");
 
 	for (auto& [Name, Board] : Boards)
 	{
@@ -66,6 +66,236 @@ void FMotherboard::Input_Step(FCPU_StepType Type)
 	}
 }
 
+void FMotherboard::Input_Key(EZXKey::Type Key, bool bPressed)
+{
+	for (auto& [Name, Board] : Boards)
+	{
+		if (Board) Board->Input_Key(Key, bPressed);
+	}
+}
+
+void FMotherboard::StartInputRecording(EName::Type BoardID, std::filesystem::path FilePath)
+{
+	for (auto& [Name, Board] : Boards)
+	{
+		if (Board->UniqueBoardID != BoardID)
+		{
+			continue;
+		}
+		Board->StartInputRecording(FilePath);
+	}
+}
+
+void FMotherboard::StopInputRecording()
+{
+	for (auto& [Name, Board] : Boards)
+	{
+		if (Board) Board->StopInputRecording();
+	}
+}
+
+void FMotherboard::StartInputReplay(EName::Type BoardID, std::filesystem::path FilePath, std::filesystem::path HashPath /*= {}*/)
+{
+	std::error_code ec;
+	if (!std::filesystem::exists(FilePath, ec))
+	{
+		LOG("StartInputReplay: File does not exist: {}", FilePath.string().c_str());
+		return;
+	}
+
+	for (auto& [Name, Board] : Boards)
+	{
+		if (Board->UniqueBoardID != BoardID)
+		{
+			continue;
+		}
+		Board->StartInputReplay(FilePath, HashPath);
+	}
+}
+
+void FMotherboard::SetThrottle(bool bEnable)
+{
+	for (auto& [Name, Board] : Boards)
+	{
+		if (Board) Board->SetThrottle(bEnable);
+	}
+}
+
+void FMotherboard::SetCodeProfiler(bool bEnable)
+{
+	LOG("Code profiler {}", bEnable ? "enabled" : "disabled");
+
+	for (auto& [Name, Board] : Boards)
+	{
+		if (Board) Board->SetCodeProfiler(bEnable);
+	}
+}
+
+void FMotherboard::ResetCodeProfiler()
+{
+	for (auto& [Name, Board] : Boards)
+	{
+		if (Board) Board->ResetCodeProfiler();
+	}
+}
+
+void FMotherboard::SetMemoryTracker(bool bEnable)
+{
+	for (auto& [Name, Board] : Boards)
+	{
+		if (Board) Board->SetMemoryTracker(bEnable);
+	}
+}
+
+void FMotherboard::StartTraceRecorder(EName::Type BoardID, std::filesystem::path FilePath)
+{
+	for (auto& [Name, Board] : Boards)
+	{
+		if (Board->UniqueBoardID != BoardID)
+		{
+			continue;
+		}
+		Board->StartTraceRecorder(FilePath);
+	}
+}
+
+void FMotherboard::StopTraceRecorder()
+{
+	for (auto& [Name, Board] : Boards)
+	{
+		if (Board) Board->StopTraceRecorder();
+	}
+}
+
+void FMotherboard::InsertTape(EName::Type BoardID, std::filesystem::path FilePath)
+{
+	std::error_code ec;
+	if (!std::filesystem::exists(FilePath, ec))
+	{
+		LOG("InsertTape: File does not exist: {}", FilePath.string().c_str());
+		return;
+	}
+
+	for (auto& [Name, Board] : Boards)
+	{
+		if (Board->UniqueBoardID != BoardID)
+		{
+			continue;
+		}
+		Board->InsertTape(FilePath);
+	}
+}
+
+void FMotherboard::TapeControl(EName::Type BoardID, ETapeControl::Type Control)
+{
+	for (auto& [Name, Board] : Boards)
+	{
+		if (Board->UniqueBoardID != BoardID)
+		{
+			continue;
+		}
+		Board->TapeControl(Control);
+	}
+}
+
+void FMotherboard::SetTapeLoadMode(EName::Type BoardID, ETapeLoadMode::Type Mode)
+{
+	for (auto& [Name, Board] : Boards)
+	{
+		if (Board->UniqueBoardID != BoardID)
+		{
+			continue;
+		}
+		Board->SetTapeLoadMode(Mode);
+	}
+}
+
+void FMotherboard::LoadSnapshot(EName::Type BoardID, std::filesystem::path FilePath)
+{
+	std::error_code ec;
+	if (!std::filesystem::exists(FilePath, ec))
+	{
+		LOG("LoadSnapshot: File does not exist: {}", FilePath.string().c_str());
+		return;
+	}
+
+	for (auto& [Name, Board] : Boards)
+	{
+		if (Board->UniqueBoardID != BoardID)
+		{
+			continue;
+		}
+		Board->LoadSnapshot(FilePath);
+	}
+}
+
+void FMotherboard::SaveSnapshot(EName::Type BoardID, std::filesystem::path FilePath)
+{
+	for (auto& [Name, Board] : Boards)
+	{
+		if (Board->UniqueBoardID != BoardID)
+		{
+			continue;
+		}
+		Board->SaveSnapshot(FilePath);
+	}
+}
+
+void FMotherboard::QuickSave(EName::Type BoardID, uint32_t Slot)
+{
+	for (auto& [Name, Board] : Boards)
+	{
+		if (Board->UniqueBoardID != BoardID)
+		{
+			continue;
+		}
+		Board->QuickSave(Slot);
+	}
+}
+
+void FMotherboard::QuickLoad(EName::Type BoardID, uint32_t Slot)
+{
+	for (auto& [Name, Board] : Boards)
+	{
+		if (Board->UniqueBoardID != BoardID)
+		{
+			continue;
+		}
+		Board->QuickLoad(Slot);
+	}
+}
+
+void FMotherboard::SaveState(EName::Type BoardID, std::filesystem::path FilePath)
+{
+	for (auto& [Name, Board] : Boards)
+	{
+		if (Board->UniqueBoardID != BoardID)
+		{
+			continue;
+		}
+		Board->SaveState(FilePath);
+	}
+}
+
+void FMotherboard::LoadState(EName::Type BoardID, std::filesystem::path FilePath)
+{
+	std::error_code ec;
+	if (!std::filesystem::exists(FilePath, ec))
+	{
+		LOG("LoadState: File does not exist: {}", FilePath.string().c_str());
+		return;
+	}
+
+	for (auto& [Name, Board] : Boards)
+	{
+		if (Board->UniqueBoardID != BoardID)
+		{
+			continue;
+		}
+		Board->LoadState(FilePath);
+	}
+}
+
 void FMotherboard::LoadRawData(EName::Type BoardID, EName::Type DeviceID, std::filesystem::path FilePath)
 {
 	std::error_code ec;
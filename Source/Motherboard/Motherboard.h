@@ -21,6 +21,39 @@ public:
 	// input
 	void Inut_Debugger();
 	void Input_Step(FCPU_StepType Type);
+	void Input_Key(EZXKey::Type Key, bool bPressed);
+
+	// keyboard input recorded with the state it starts from, the replay hashes every frame into the file
+	void StartInputRecording(EName::Type BoardID, std::filesystem::path FilePath);
+	void StopInputRecording();
+	void StartInputReplay(EName::Type BoardID, std::filesystem::path FilePath, std::filesystem::path HashPath = {});
+	void SetThrottle(bool bEnable);
+
+	// code profiler
+	void SetCodeProfiler(bool bEnable);
+	void ResetCodeProfiler();
+
+	// memory access tracking
+	void SetMemoryTracker(bool bEnable);
+
+	// execution trace
+	void StartTraceRecorder(EName::Type BoardID, std::filesystem::path FilePath);
+	void StopTraceRecorder();
+
+	// tape
+	void InsertTape(EName::Type BoardID, std::filesystem::path FilePath);
+	void TapeControl(EName::Type BoardID, ETapeControl::Type Control);
+	void SetTapeLoadMode(EName::Type BoardID, ETapeLoadMode::Type Mode);
+
+	// .sna / .z80 / .szx of the 48K machine
+	void LoadSnapshot(EName::Type BoardID, std::filesystem::path FilePath);
+	void SaveSnapshot(EName::Type BoardID, std::filesystem::path FilePath);
+
+	// native save-state, the quick-save slots are kept in memory and mirrored on the disk
+	void QuickSave(EName::Type BoardID, uint32_t Slot);
+	void QuickLoad(EName::Type BoardID, uint32_t Slot);
+	void SaveState(EName::Type BoardID, std::filesystem::path FilePath);
+	void LoadState(EName::Type BoardID, std::filesystem::path FilePath);
 
 	bool GetDebuggerState() const { return bFlipFlopDebugger; }
 	void LoadRawData(EName::Type BoardID, EName::Type DeviceID, std::filesystem::path FilePath);
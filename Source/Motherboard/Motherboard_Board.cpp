@@ -33,6 +33,101 @@ void FBoard::Input_Step(FCPU_StepType Type)
 	Thread->Input_Step(Type);
 }
 
+void FBoard::Input_Key(EZXKey::Type Key, bool bPressed)
+{
+	Thread->Input_Key(Key, bPressed);
+}
+
+void FBoard::StartInputRecording(std::filesystem::path FilePath)
+{
+	Thread->StartInputRecording(FilePath);
+}
+
+void FBoard::StopInputRecording()
+{
+	Thread->StopInputRecording();
+}
+
+void FBoard::StartInputReplay(std::filesystem::path FilePath, std::filesystem::path HashPath)
+{
+	Thread->StartInputReplay(FilePath, HashPath);
+}
+
+void FBoard::SetThrottle(bool bEnable)
+{
+	Thread->SetThrottle(bEnable);
+}
+
+void FBoard::SetCodeProfiler(bool bEnable)
+{
+	Thread->SetCodeProfiler(bEnable);
+}
+
+void FBoard::ResetCodeProfiler()
+{
+	Thread->ResetCodeProfiler();
+}
+
+void FBoard::SetMemoryTracker(bool bEnable)
+{
+	Thread->SetMemoryTracker(bEnable);
+}
+
+void FBoard::StartTraceRecorder(std::filesystem::path FilePath)
+{
+	Thread->StartTraceRecorder(FilePath);
+}
+
+void FBoard::StopTraceRecorder()
+{
+	Thread->StopTraceRecorder();
+}
+
+void FBoard::InsertTape(std::filesystem::path FilePath)
+{
+	Thread->InsertTape(FilePath);
+}
+
+void FBoard::TapeControl(ETapeControl::Type Control)
+{
+	Thread->TapeControl(Control);
+}
+
+void FBoard::SetTapeLoadMode(ETapeLoadMode::Type Mode)
+{
+	Thread->SetTapeLoadMode(Mode);
+}
+
+void FBoard::LoadSnapshot(std::filesystem::path FilePath)
+{
+	Thread->LoadSnapshot(FilePath);
+}
+
+void FBoard::SaveSnapshot(std::filesystem::path FilePath)
+{
+	Thread->SaveSnapshot(FilePath);
+}
+
+void FBoard::QuickSave(uint32_t Slot)
+{
+	Thread->QuickSave(Slot);
+}
+
+void FBoard::QuickLoad(uint32_t Slot)
+{
+	Thread->QuickLoad(Slot);
+}
+
+void FBoard::SaveState(std::filesystem::path FilePath)
+{
+	Thread->SaveState(FilePath);
+}
+
+void FBoard::LoadState(std::filesystem::path FilePath)
+{
+	Thread->LoadState(FilePath);
+}
+
 void FBoard::LoadRawData(EName::Type DeviceID, std::filesystem::path FilePath)
 {
 	Thread->LoadRawData(DeviceID, FilePath);
@@ -69,7 +164,7 @@ void FBoard::SetFrequency(double _Frequency)
 	}
 
 
-	LOG("[{}] : Set frequency: {}Hz", BoardName.ToString(), FormatFrequency.c_str());
+	LOG_CATEGORY(Emulation, Log, "[{}] : Set frequency: {}Hz", BoardName.ToString(), FormatFrequency);
 }
 
 void FBoard::Inut_Debugger(bool bEnterDebugger)
@@ -33,6 +33,37 @@ private:
 
 	// input
 	void Input_Step(FCPU_StepType Type);
+	void Input_Key(EZXKey::Type Key, bool bPressed);
+
+	// input log
+	void StartInputRecording(std::filesystem::path FilePath);
+	void StopInputRecording();
+	void StartInputReplay(std::filesystem::path FilePath, std::filesystem::path HashPath);
+	void SetThrottle(bool bEnable);
+
+	// code profiler
+	void SetCodeProfiler(bool bEnable);
+	void ResetCodeProfiler();
+
+	// memory access tracking
+	void SetMemoryTracker(bool bEnable);
+
+	// execution trace
+	void StartTraceRecorder(std::filesystem::path FilePath);
+	void StopTraceRecorder();
+
+	// tape
+	void InsertTape(std::filesystem::path FilePath);
+	void TapeControl(ETapeControl::Type Control);
+	void SetTapeLoadMode(ETapeLoadMode::Type Mode);
+
+	void LoadSnapshot(std::filesystem::path FilePath);
+	void SaveSnapshot(std::filesystem::path FilePath);
+
+	void QuickSave(uint32_t Slot);
+	void QuickLoad(uint32_t Slot);
+	void SaveState(std::filesystem::path FilePath);
+	void LoadState(std::filesystem::path FilePath);
 
 	void LoadRawData(EName::Type DeviceID, std::filesystem::path FilePath);
 	template<typename T>
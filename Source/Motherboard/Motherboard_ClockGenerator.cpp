@@ -48,6 +48,15 @@ void FClockGenerator::Reset()
 	LastElementIndex = 0;
 }
 
+void FClockGenerator::SetClockCounter(uint64_t NewClockCounter)
+{
+	for (size_t i = 0; i < LastElementIndex; ++i)
+	{
+		Events[i].ExpireTime += NewClockCounter - ClockCounter;
+	}
+	ClockCounter = NewClockCounter;
+}
+
 #ifndef NDEBUG
 void FClockGenerator::AddEvent(uint64_t Rate, std::function<void()>&& EventCallback, const std::string& _DebugName /*= ""*/)
 #else
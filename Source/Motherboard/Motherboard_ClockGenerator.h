@@ -34,6 +34,8 @@ public:
 	void SetFrequency(double _Frequency) { FrequencyInv = 1.0 / (_Frequency * (double)Sampling); }
 
 	FORCEINLINE uint64_t GetClockCounter() const { return ClockCounter; }
+	// the pending events keep their distance to the counter
+	void SetClockCounter(uint64_t NewClockCounter);
 
 #ifndef NDEBUG
 	void AddEvent(uint64_t Rate, std::function<void()>&& EventCallback, const std::string& _DebugName = "");
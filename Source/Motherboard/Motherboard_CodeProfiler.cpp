@@ -0,0 +1,298 @@
+#include "Motherboard_CodeProfiler.h"
+#include "Devices/CPU/Interface_CPU_Z80.h"
+
+namespace
+{
+	static constexpr size_t AddressSpaceSize = 0x10000;
+
+	// a program that never returns (stack switching, RET used as a jump) would grow the shadow stack forever
+	static constexpr size_t MaxCallStackDepth = 1024;
+
+	// CALL nn, CALL cc,nn, RST p, RET and RET cc are the only unprefixed opcodes changing the call depth
+	FORCEINLINE bool IsCall(uint8_t Opcode)		{ return Opcode == 0xCD || (Opcode & 0xC7) == 0xC4; }
+	FORCEINLINE bool IsRestart(uint8_t Opcode)	{ return (Opcode & 0xC7) == 0xC7; }
+	FORCEINLINE bool IsReturn(uint8_t Opcode)	{ return Opcode == 0xC9 || (Opcode & 0xC7) == 0xC0; }
+
+	uint64_t ToTStates(uint64_t Clocks, uint64_t ClocksPerTState)
+	{
+		return ClocksPerTState > 0 ? Clocks / ClocksPerTState : Clocks;
+	}
+
+	double ToPercent(uint64_t Value, uint64_t Total)
+	{
+		return Total > 0 ? 100.0 * double(Value) / double(Total) : 0.0;
+	}
+}
+
+FCodeProfilerSnapshot::FCodeProfilerSnapshot()
+	: bEnabled(false)
+	, TotalInstructions(0)
+	, TotalTStates(0)
+	, MaxExecutionCount(0)
+	, MaxTStates(0)
+{}
+
+bool FCodeProfilerSnapshot::ExportReport(const std::filesystem::path& FilePath) const
+{
+	std::error_code ec;
+	std::filesystem::create_directories(FilePath.parent_path(), ec);
+
+	std::ofstream File(FilePath, std::ios::out | std::ios::trunc);
+	if (!File.is_open())
+	{
+		LOG_ERROR("[{}]\t Can't open file : {}", (__FUNCTION__), FilePath.string());
+		return false;
+	}
+
+	File << std::format("Instructions: {}\n", TotalInstructions);
+	File << std::format("T-states: {}\n\n", TotalTStates);
+
+	// functions by inclusive time
+	{
+		std::vector<FCodeProfilerFunction> SortedFunctions = Functions;
+		std::sort(SortedFunctions.begin(), SortedFunctions.end(),
+			[](const FCodeProfilerFunction& A, const FCodeProfilerFunction& B)
+			{
+				return A.InclusiveTStates > B.InclusiveTStates;
+			});
+
+		File << std::format("{:<8}{:>12}{:>16}{:>9}{:>16}{:>9}\n", "Function", "Calls", "Inclusive", "%", "Exclusive", "%");
+		for (const FCodeProfilerFunction& Function : SortedFunctions)
+		{
+			File << std::format("#{:04X}   {:>12}{:>16}{:>8.2f}%{:>16}{:>8.2f}%\n",
+				Function.Address, Function.Calls,
+				Function.InclusiveTStates, ToPercent(Function.InclusiveTStates, TotalTStates),
+				Function.ExclusiveTStates, ToPercent(Function.ExclusiveTStates, TotalTStates));
+		}
+		File << "\n";
+	}
+
+	// addresses by time
+	if (!ExecutionCount.empty() && !TStates.empty())
+	{
+		std::vector<uint16_t> Addresses;
+		for (size_t Address = 0; Address < AddressSpaceSize; ++Address)
+		{
+			if (ExecutionCount[Address] > 0)
+			{
+				Addresses.push_back(uint16_t(Address));
+			}
+		}
+		std::sort(Addresses.begin(), Addresses.end(),
+			[this](uint16_t A, uint16_t B)
+			{
+				return TStates[A] != TStates[B] ? TStates[A] > TStates[B] : A < B;
+			});
+
+		File << std::format("{:<8}{:>12}{:>16}{:>9}\n", "Address", "Count", "T-states", "%");
+		for (const uint16_t Address : Addresses)
+		{
+			File << std::format("#{:04X}   {:>12}{:>16}{:>8.2f}%\n",
+				Address, ExecutionCount[Address], TStates[Address], ToPercent(TStates[Address], TotalTStates));
+		}
+	}
+
+	return File.good();
+}
+
+FCodeProfiler::FCodeProfiler()
+	: bEnabled(false)
+	, bInstrCycleDone(false)
+	, bInstructionStarted(false)
+	, CPU(nullptr)
+	, InstructionAddress(0)
+	, InstructionStartClock(0)
+	, LatestClockCounter(0)
+	, TotalInstructions(0)
+	, TotalClocks(0)
+{}
+
+void FCodeProfiler::Enable(ICPU_Z80* _CPU)
+{
+	CPU = _CPU;
+	bEnabled = CPU != nullptr;
+	if (bEnabled && ExecutionCount.empty())
+	{
+		ExecutionCount.resize(AddressSpaceSize, 0);
+		Clocks.resize(AddressSpaceSize, 0);
+	}
+	Restart();
+}
+
+void FCodeProfiler::Disable()
+{
+	// the calls still in progress are accounted up to now
+	while (!CallStack.empty())
+	{
+		FinishFrame(LatestClockCounter);
+	}
+
+	bEnabled = false;
+	CPU = nullptr;
+	Restart();
+}
+
+void FCodeProfiler::Reset()
+{
+	std::fill(ExecutionCount.begin(), ExecutionCount.end(), 0);
+	std::fill(Clocks.begin(), Clocks.end(), 0);
+	Functions.clear();
+	CallStack.clear();
+	TotalInstructions = 0;
+	TotalClocks = 0;
+	bInstructionStarted = false;
+}
+
+void FCodeProfiler::Restart()
+{
+	CallStack.clear();
+	bInstrCycleDone = false;
+	bInstructionStarted = false;
+}
+
+void FCodeProfiler::Tick(uint64_t ClockCounter)
+{
+	// an instruction ends on the rising edge of the flag, the next one is fetched from PC
+	const bool bDone = CPU->IsInstrCycleDone();
+	if (bDone == bInstrCycleDone)
+	{
+		return;
+	}
+
+	bInstrCycleDone = bDone;
+	if (!bDone)
+	{
+		return;
+	}
+
+	const uint16_t NextAddress = *CPU->GetRegisters().PC;
+	if (bInstructionStarted)
+	{
+		Instruction(InstructionAddress, CPU->GetOpcode(), NextAddress, ClockCounter);
+	}
+
+	bInstructionStarted = true;
+	InstructionAddress = NextAddress;
+	InstructionStartClock = ClockCounter;
+	LatestClockCounter = ClockCounter;
+}
+
+void FCodeProfiler::Instruction(uint16_t Address, uint8_t Opcode, uint16_t NextAddress, uint64_t ClockCounter)
+{
+	const uint64_t InstructionClocks = ClockCounter - InstructionStartClock;
+	++ExecutionCount[Address];
+	Clocks[Address] += InstructionClocks;
+	++TotalInstructions;
+	TotalClocks += InstructionClocks;
+
+	// a conditional call or return is taken when the execution doesn't continue with the next instruction
+	if (IsCall(Opcode) || IsRestart(Opcode))
+	{
+		const bool bRestart = IsRestart(Opcode);
+		const uint16_t ReturnAddress = Address + (bRestart ? 1 : 3);
+		if (bRestart || Opcode == 0xCD || NextAddress != ReturnAddress)
+		{
+			Call(NextAddress, ReturnAddress, ClockCounter);
+		}
+	}
+	else if (IsReturn(Opcode))
+	{
+		if (Opcode == 0xC9 || NextAddress != uint16_t(Address + 1))
+		{
+			Return(NextAddress, ClockCounter);
+		}
+	}
+}
+
+void FCodeProfiler::Call(uint16_t Function, uint16_t ReturnAddress, uint64_t ClockCounter)
+{
+	if (CallStack.size() >= MaxCallStackDepth)
+	{
+		CallStack.erase(CallStack.begin());
+	}
+	CallStack.push_back({ Function, ReturnAddress, ClockCounter, 0 });
+}
+
+void FCodeProfiler::Return(uint16_t ReturnAddress, uint64_t ClockCounter)
+{
+	// the frames above the matching one were left without RET (the return address was dropped from the stack)
+	auto It = std::find_if(CallStack.rbegin(), CallStack.rend(),
+		[ReturnAddress](const FCallFrame& Frame) -> bool
+		{
+			return Frame.ReturnAddress == ReturnAddress;
+		});
+
+	if (It == CallStack.rend())
+	{
+		// RET used as an indirect jump
+		return;
+	}
+
+	const size_t Depth = std::distance(It, CallStack.rend()) - 1;
+	while (CallStack.size() > Depth)
+	{
+		FinishFrame(ClockCounter);
+	}
+}
+
+void FCodeProfiler::FinishFrame(uint64_t ClockCounter)
+{
+	const FCallFrame Frame = CallStack.back();
+	CallStack.pop_back();
+
+	const uint64_t Inclusive = ClockCounter - Frame.StartClock;
+	FFunctionCounters& Counters = Functions[Frame.Function];
+	++Counters.Calls;
+	Counters.InclusiveClocks += Inclusive;
+	Counters.ExclusiveClocks += Inclusive - (std::min)(Frame.ChildClocks, Inclusive);
+
+	if (!CallStack.empty())
+	{
+		CallStack.back().ChildClocks += Inclusive;
+	}
+}
+
+void FCodeProfiler::Snapshot(FCodeProfilerSnapshot& Output, uint64_t ClocksPerTState) const
+{
+	Output.bEnabled = bEnabled;
+	Output.TotalInstructions = TotalInstructions;
+	Output.TotalTStates = ToTStates(TotalClocks, ClocksPerTState);
+	Output.MaxExecutionCount = 0;
+	Output.MaxTStates = 0;
+
+	Output.ExecutionCount = ExecutionCount;
+	Output.TStates.resize(Clocks.size());
+	for (size_t Address = 0; Address < Clocks.size(); ++Address)
+	{
+		Output.TStates[Address] = ToTStates(Clocks[Address], ClocksPerTState);
+		Output.MaxExecutionCount = (std::max)(Output.MaxExecutionCount, ExecutionCount[Address]);
+		Output.MaxTStates = (std::max)(Output.MaxTStates, Output.TStates[Address]);
+	}
+
+	// the calls in progress are accounted as if they returned now, without touching the shadow stack
+	std::unordered_map<uint16_t, FFunctionCounters> AllFunctions = Functions;
+	uint64_t ChildClocks = 0;
+	for (auto It = CallStack.rbegin(); It != CallStack.rend(); ++It)
+	{
+		const uint64_t Inclusive = LatestClockCounter - It->StartClock;
+		const uint64_t Children = It->ChildClocks + ChildClocks;
+		FFunctionCounters& Counters = AllFunctions[It->Function];
+		++Counters.Calls;
+		Counters.InclusiveClocks += Inclusive;
+		Counters.ExclusiveClocks += Inclusive - (std::min)(Children, Inclusive);
+		ChildClocks = Inclusive;
+	}
+
+	Output.Functions.clear();
+	Output.Functions.reserve(AllFunctions.size());
+	for (const auto& [Address, Counters] : AllFunctions)
+	{
+		Output.Functions.push_back(
+			{
+				Address,
+				Counters.Calls,
+				ToTStates(Counters.InclusiveClocks, ClocksPerTState),
+				ToTStates(Counters.ExclusiveClocks, ClocksPerTState)
+			});
+	}
+}
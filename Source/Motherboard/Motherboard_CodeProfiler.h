@@ -0,0 +1,94 @@
+#pragma once
+
+#include <CoreMinimal.h>
+
+class ICPU_Z80;
+
+struct FCodeProfilerFunction
+{
+	uint16_t Address;				// entry point, the target of CALL/RST
+	uint64_t Calls;
+	uint64_t InclusiveTStates;		// including the called subroutines
+	uint64_t ExclusiveTStates;		// the function body only
+};
+
+// copy of the profiler counters for the UI, the time is already converted to T-states
+struct FCodeProfilerSnapshot
+{
+	FCodeProfilerSnapshot();
+
+	bool IsEmpty() const { return TotalInstructions == 0; }
+	bool ExportReport(const std::filesystem::path& FilePath) const;
+
+	bool bEnabled;
+	uint64_t TotalInstructions;
+	uint64_t TotalTStates;
+	uint64_t MaxExecutionCount;
+	uint64_t MaxTStates;
+
+	std::vector<uint64_t> ExecutionCount;	// per address, 64K entries or empty
+	std::vector<uint64_t> TStates;			// per address, 64K entries or empty
+	std::vector<FCodeProfilerFunction> Functions;
+};
+
+// per-address execution counts and time of the running code
+//
+// the emulation thread calls Tick after every clock generator tick while the profiler is enabled,
+// an instruction is accounted when the CPU finishes its cycle, with the time measured by the clock generator,
+// so the wait states inserted by the ULA on contended memory are included.
+// CALL/RST and RET are tracked on a shadow call stack to build the inclusive/exclusive time per function
+class FCodeProfiler
+{
+public:
+	FCodeProfiler();
+
+	FORCEINLINE bool IsEnabled() const { return bEnabled; }
+
+	void Enable(ICPU_Z80* _CPU);
+	void Disable();
+	void Reset();
+	// the CPU was reset, the call stack and the current instruction are no longer valid
+	void Restart();
+
+	void Tick(uint64_t ClockCounter);
+	void Snapshot(FCodeProfilerSnapshot& Output, uint64_t ClocksPerTState) const;
+
+private:
+	struct FCallFrame
+	{
+		uint16_t Function;
+		uint16_t ReturnAddress;
+		uint64_t StartClock;
+		uint64_t ChildClocks;
+	};
+
+	struct FFunctionCounters
+	{
+		uint64_t Calls = 0;
+		uint64_t InclusiveClocks = 0;
+		uint64_t ExclusiveClocks = 0;
+	};
+
+	void Instruction(uint16_t Address, uint8_t Opcode, uint16_t NextAddress, uint64_t ClockCounter);
+	void Call(uint16_t Function, uint16_t ReturnAddress, uint64_t ClockCounter);
+	void Return(uint16_t ReturnAddress, uint64_t ClockCounter);
+	void FinishFrame(uint64_t ClockCounter);
+
+	bool bEnabled;
+	bool bInstrCycleDone;
+	bool bInstructionStarted;
+	ICPU_Z80* CPU;
+
+	uint16_t InstructionAddress;
+	uint64_t InstructionStartClock;
+	uint64_t LatestClockCounter;
+	uint64_t TotalInstructions;
+	uint64_t TotalClocks;
+
+	// flat counters indexed by the address of the instruction, allocated on the first enable
+	std::vector<uint64_t> ExecutionCount;
+	std::vector<uint64_t> Clocks;
+
+	std::unordered_map<uint16_t, FFunctionCounters> Functions;
+	std::vector<FCallFrame> CallStack;
+};
@@ -0,0 +1,189 @@
+#include "Motherboard_InputLog.h"
+#include <Utils/Hash.h>
+
+FInputLog::FInputLog()
+	: bRecording(false)
+	, bReplaying(false)
+	, bStateLoaded(false)
+	, bPartialFrame(false)
+	, EndClock(0)
+{}
+
+void FInputLog::StartRecording(const std::filesystem::path& _FilePath, std::vector<uint8_t>&& _State)
+{
+	FilePath = _FilePath;
+	State = std::move(_State);
+	bRecording = true;
+	LOG("InputLog: recording to {}", FilePath.string().c_str());
+}
+
+bool FInputLog::StopRecording(const std::vector<FInputEvent>& Events, uint64_t _EndClock)
+{
+	if (!bRecording)
+	{
+		return false;
+	}
+	bRecording = false;
+
+	FSaveStateWriter Writer(State);
+	Writer.BeginChunk(InputLog::EventsTag, InputLog::Version);
+	Writer.Write(_EndClock);
+	Writer.Write(uint32_t(Events.size()));
+	for (const FInputEvent& Event : Events)
+	{
+		Writer.Write(Event.Clock);
+		Writer.Write(Event.Key);
+		Writer.Write(Event.bPressed);
+	}
+	Writer.EndChunk();
+
+	const bool bSaved = SaveStateFile::Save(FilePath, State);
+	if (bSaved)
+	{
+		LOG("InputLog: {} events recorded to {}", Events.size(), FilePath.string().c_str());
+	}
+	State.clear();
+	return bSaved;
+}
+
+bool FInputLog::Load(const std::filesystem::path& FilePath, std::vector<uint8_t>& State, std::vector<FInputEvent>& Events, uint64_t& EndClock)
+{
+	std::vector<FSaveStateChunk> Chunks;
+	if (!SaveStateFile::Load(FilePath, State) || !SaveStateFile::Parse(State, Chunks))
+	{
+		return false;
+	}
+
+	const auto It = std::find_if(Chunks.begin(), Chunks.end(), [](const FSaveStateChunk& Chunk) -> bool { return Chunk.Tag == InputLog::EventsTag; });
+	if (It == Chunks.end())
+	{
+		LOG("InputLog: not an input recording: {}", FilePath.string().c_str());
+		return false;
+	}
+	if (It->Version > InputLog::Version)
+	{
+		LOG("InputLog: the version {} is newer than {}", It->Version, InputLog::Version);
+		return false;
+	}
+
+	FSaveStateReader Reader(*It);
+	uint32_t Count = 0;
+	Reader.Read(EndClock);
+	Reader.Read(Count);
+
+	Events.clear();
+	for (uint32_t Index = 0; Index < Count && Reader.IsValid(); ++Index)
+	{
+		FInputEvent Event;
+		Reader.Read(Event.Clock);
+		Reader.Read(Event.Key);
+		Reader.Read(Event.bPressed);
+		if (Event.Key >= EZXKey::Count || (!Events.empty() && Event.Clock < Events.back().Clock))
+		{
+			LOG_ERROR("[{}]\t the events are damaged.", (__FUNCTION__));
+			return false;
+		}
+		Events.push_back(Event);
+	}
+	if (!Reader.IsValid())
+	{
+		LOG_ERROR("[{}]\t the events are cut off.", (__FUNCTION__));
+		return false;
+	}
+	return true;
+}
+
+void FInputLog::StartReplay(const std::filesystem::path& _FilePath, const std::filesystem::path& _HashPath)
+{
+	FilePath = _FilePath;
+	HashPath = _HashPath;
+	Frames.clear();
+	bReplaying = true;
+	bStateLoaded = false;
+}
+
+void FInputLog::BeginReplay(uint64_t _EndClock)
+{
+	EndClock = _EndClock;
+	bStateLoaded = true;
+	bPartialFrame = true;
+	LOG("InputLog: replaying {}", FilePath.string().c_str());
+}
+
+bool FInputLog::Frame(uint64_t Clock, const std::vector<uint8_t>& DisplayData)
+{
+	if (!bStateLoaded)
+	{
+		return true;
+	}
+	if (Clock > EndClock)
+	{
+		return false;
+	}
+
+	// the display data kept some of the frame from before the load
+	if (bPartialFrame)
+	{
+		bPartialFrame = false;
+		return true;
+	}
+
+	Frames.push_back({ Clock, Utils::FNV1a64(Utils::FNV1a64Basis, DisplayData.data(), DisplayData.size()) });
+	return true;
+}
+
+void FInputLog::StopReplay()
+{
+	if (!bReplaying)
+	{
+		return;
+	}
+	bReplaying = false;
+
+	LOG("InputLog: {} frames replayed, hash {:016X}", Frames.size(), GetHash());
+	if (!HashPath.empty())
+	{
+		WriteHashes();
+	}
+}
+
+FInputLogStatus FInputLog::GetStatus() const
+{
+	FInputLogStatus Status;
+	Status.bRecording = bRecording;
+	Status.bReplaying = bReplaying;
+	Status.FilePath = FilePath;
+	Status.FrameCount = uint32_t(Frames.size());
+	Status.Hash = GetHash();
+	return Status;
+}
+
+uint64_t FInputLog::GetHash() const
+{
+	uint64_t Hash = Utils::FNV1a64Basis;
+	for (const FFrameHash& Frame : Frames)
+	{
+		Hash = Utils::FNV1a64(Hash, &Frame.Hash, sizeof(Frame.Hash));
+	}
+	return Hash;
+}
+
+bool FInputLog::WriteHashes() const
+{
+	std::error_code ec;
+	std::filesystem::create_directories(HashPath.parent_path(), ec);
+
+	std::ofstream File(HashPath, std::ios::out | std::ios::trunc);
+	if (!File.is_open())
+	{
+		LOG("Could not open the file: {}", HashPath.string().c_str());
+		return false;
+	}
+
+	// a line per frame: the number, the clock of its interrupt and the hash of the display data
+	for (size_t Index = 0; Index < Frames.size(); ++Index)
+	{
+		File << std::format("{} {} {:016X}\n", Index, Frames[Index].Clock, Frames[Index].Hash);
+	}
+	return File.good();
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <CoreMinimal.h>
+#include "Motherboard_SaveState.h"
+#include "Devices/IO/Keyboard.h"
+
+namespace InputLog
+{
+	// the recording is a save-state with one more chunk, the loader of the states passes it by
+	static constexpr uint32_t EventsTag = SaveState::MakeTag("INPT");
+	static constexpr uint16_t Version = 1;
+}
+
+struct FInputLogStatus
+{
+	bool bRecording = false;
+	bool bReplaying = false;
+	std::filesystem::path FilePath;
+	uint32_t FrameCount = 0;		// hashed by the replay
+	uint64_t Hash = 0;				// of the frame hashes in their order
+};
+
+struct FFrameHash
+{
+	uint64_t Clock;
+	uint64_t Hash;
+};
+
+// keyboard input log
+//
+// a recording keeps the state of its start and writes it with the events of the keyboard and the clock it ended on.
+// the replay loads the state, feeds the events back and hashes the display data at every frame interrupt
+// up to the end clock; two replays of one recording give the same hashes, a changed emulation doesn't
+class FInputLog
+{
+public:
+	FInputLog();
+
+	void StartRecording(const std::filesystem::path& _FilePath, std::vector<uint8_t>&& _State);
+	bool StopRecording(const std::vector<FInputEvent>& Events, uint64_t EndClock);
+
+	// the state is the whole file, the events chunk is ignored by its loader
+	static bool Load(const std::filesystem::path& FilePath, std::vector<uint8_t>& State, std::vector<FInputEvent>& Events, uint64_t& EndClock);
+
+	// the replay waits for its state to be loaded, the frame the state is loaded in isn't hashed
+	void StartReplay(const std::filesystem::path& _FilePath, const std::filesystem::path& _HashPath);
+	void BeginReplay(uint64_t _EndClock);
+	// on the frame interrupt, false once the end of the recording is passed
+	bool Frame(uint64_t Clock, const std::vector<uint8_t>& DisplayData);
+	void StopReplay();
+
+	FORCEINLINE bool IsRecording() const { return bRecording; }
+	FORCEINLINE bool IsReplaying() const { return bReplaying; }
+	FInputLogStatus GetStatus() const;
+
+private:
+	uint64_t GetHash() const;
+	bool WriteHashes() const;
+
+	std::filesystem::path FilePath;
+	std::filesystem::path HashPath;
+	std::vector<uint8_t> State;
+
+	bool bRecording;
+	bool bReplaying;
+	bool bStateLoaded;
+	bool bPartialFrame;
+	uint64_t EndClock;
+	std::vector<FFrameHash> Frames;
+};
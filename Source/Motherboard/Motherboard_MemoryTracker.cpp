@@ -0,0 +1,101 @@
+#include "Motherboard_MemoryTracker.h"
+
+namespace
+{
+	static constexpr size_t AddressSpaceSize = 0x10000;
+
+	// removes 1/8 of the value every frame (at least one), a saturated counter cools down in under two seconds
+	FORCEINLINE uint16_t DecayCounter(uint16_t Counter)
+	{
+		return Counter - ((Counter + 7) >> 3);
+	}
+}
+
+FMemoryTracker::FMemoryTracker()
+	: bEnabled(false)
+	, bSendAll(true)
+{}
+
+void FMemoryTracker::Enable()
+{
+	// the counters start from zero, what was left from the previous session is stale
+	ReadCount.assign(AddressSpaceSize, 0);
+	WriteCount.assign(AddressSpaceSize, 0);
+	ExecuteCount.assign(AddressSpaceSize, 0);
+	LastWriteClock.assign(AddressSpaceSize, INDEX_NONE);
+	SentData.resize(AddressSpaceSize, 0);
+	TouchedPages.reset();
+	ActivePages.reset();
+
+	bEnabled = true;
+	bSendAll = true;
+}
+
+void FMemoryTracker::Disable()
+{
+	bEnabled = false;
+}
+
+void FMemoryTracker::Decay()
+{
+	if (ActivePages.none())
+	{
+		return;
+	}
+
+	for (uint32_t Page = 0; Page < MemoryTracker::PageCount; ++Page)
+	{
+		if (!ActivePages.test(Page))
+		{
+			continue;
+		}
+
+		uint16_t Active = 0;
+		const uint32_t Begin = Page * MemoryTracker::PageSize;
+		for (uint32_t Address = Begin; Address < Begin + MemoryTracker::PageSize; ++Address)
+		{
+			ReadCount[Address] = DecayCounter(ReadCount[Address]);
+			WriteCount[Address] = DecayCounter(WriteCount[Address]);
+			ExecuteCount[Address] = DecayCounter(ExecuteCount[Address]);
+			Active |= ReadCount[Address] | WriteCount[Address] | ExecuteCount[Address];
+		}
+
+		TouchedPages.set(Page);
+		if (Active == 0)
+		{
+			ActivePages.reset(Page);
+		}
+	}
+}
+
+void FMemoryTracker::TakeDelta(const std::vector<uint8_t>& AddressSpace, FMemoryTrackerDelta& Output)
+{
+	Output.Pages.clear();
+	if (!bEnabled || AddressSpace.size() < AddressSpaceSize)
+	{
+		return;
+	}
+
+	for (uint32_t Page = 0; Page < MemoryTracker::PageCount; ++Page)
+	{
+		// the content may also be changed by loading or editing the memory, it is compared with what was sent
+		const uint32_t Begin = Page * MemoryTracker::PageSize;
+		const bool bContentChanged = std::memcmp(&AddressSpace[Begin], &SentData[Begin], MemoryTracker::PageSize) != 0;
+		if (!bSendAll && !bContentChanged && !TouchedPages.test(Page))
+		{
+			continue;
+		}
+
+		FMemoryTrackerPage& Output_Page = Output.Pages.emplace_back();
+		Output_Page.Index = uint8_t(Page);
+		std::memcpy(Output_Page.Data, &AddressSpace[Begin], MemoryTracker::PageSize);
+		std::memcpy(Output_Page.ReadCount, &ReadCount[Begin], sizeof(Output_Page.ReadCount));
+		std::memcpy(Output_Page.WriteCount, &WriteCount[Begin], sizeof(Output_Page.WriteCount));
+		std::memcpy(Output_Page.ExecuteCount, &ExecuteCount[Begin], sizeof(Output_Page.ExecuteCount));
+		std::memcpy(Output_Page.LastWriteClock, &LastWriteClock[Begin], sizeof(Output_Page.LastWriteClock));
+		std::memcpy(&SentData[Begin], &AddressSpace[Begin], MemoryTracker::PageSize);
+	}
+
+	TouchedPages.reset();
+	bSendAll = false;
+}
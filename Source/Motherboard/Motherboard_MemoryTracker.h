@@ -0,0 +1,94 @@
+#pragma once
+
+#include <CoreMinimal.h>
+#include <bitset>
+
+namespace MemoryTracker
+{
+	static constexpr uint32_t PageSize = 256;
+	static constexpr uint32_t PageCount = 65536 / PageSize;
+}
+
+// a page of the address space with its access counters, what changed since the previous request
+struct FMemoryTrackerPage
+{
+	uint8_t Index;
+	uint8_t Data[MemoryTracker::PageSize];
+	uint16_t ReadCount[MemoryTracker::PageSize];
+	uint16_t WriteCount[MemoryTracker::PageSize];
+	uint16_t ExecuteCount[MemoryTracker::PageSize];
+	uint64_t LastWriteClock[MemoryTracker::PageSize];	// FClockGenerator.ClockCounter, INDEX_NONE if never written
+};
+
+struct FMemoryTrackerDelta
+{
+	FMemoryTrackerDelta(uint64_t _ClockCounter = INDEX_NONE)
+		: ClockCounter(_ClockCounter)
+	{}
+
+	uint64_t ClockCounter;
+	std::vector<FMemoryTrackerPage> Pages;
+};
+
+// read/write/execute counters per byte of the address space
+//
+// the CPU reports its memory cycles (the opcode fetch counts as execute), the counters saturate
+// and decay every frame, so they show where the program is busy right now rather than since the start.
+// the requests get only the pages that were accessed, decayed or changed their content since the previous one
+class FMemoryTracker
+{
+public:
+	FMemoryTracker();
+
+	FORCEINLINE bool IsEnabled() const { return bEnabled; }
+
+	void Enable();
+	void Disable();
+
+	FORCEINLINE void Read(uint16_t Address)
+	{
+		Increment(ReadCount[Address]);
+		Touch(Address);
+	}
+	FORCEINLINE void Write(uint16_t Address, uint64_t ClockCounter)
+	{
+		Increment(WriteCount[Address]);
+		LastWriteClock[Address] = ClockCounter;
+		Touch(Address);
+	}
+	FORCEINLINE void Execute(uint16_t Address)
+	{
+		Increment(ExecuteCount[Address]);
+		Touch(Address);
+	}
+
+	// called once a frame
+	void Decay();
+	void TakeDelta(const std::vector<uint8_t>& AddressSpace, FMemoryTrackerDelta& Output);
+
+private:
+	FORCEINLINE static void Increment(uint16_t& Counter)
+	{
+		Counter += Counter != UINT16_MAX;
+	}
+	FORCEINLINE void Touch(uint16_t Address)
+	{
+		const uint32_t Page = Address / MemoryTracker::PageSize;
+		TouchedPages.set(Page);
+		ActivePages.set(Page);
+	}
+
+	bool bEnabled;
+	bool bSendAll;
+
+	std::vector<uint16_t> ReadCount;
+	std::vector<uint16_t> WriteCount;
+	std::vector<uint16_t> ExecuteCount;
+	std::vector<uint64_t> LastWriteClock;
+
+	// the content the UI got with the previous request
+	std::vector<uint8_t> SentData;
+
+	std::bitset<MemoryTracker::PageCount> TouchedPages;		// to be sent with the next request
+	std::bitset<MemoryTracker::PageCount> ActivePages;		// with non-zero counters to decay
+};
@@ -0,0 +1,321 @@
+#include "Motherboard_SaveState.h"
+#include <Utils/Hash.h>
+
+namespace
+{
+	static constexpr uint32_t FileHeaderSize = 8;				// magic, version, reserved
+	static constexpr uint32_t ChunkHeaderSize = 10;				// tag, version, size
+
+	FORCEINLINE uint16_t Get16(const uint8_t* Data) { return uint16_t(Data[0] | (Data[1] << 8)); }
+	FORCEINLINE uint32_t Get32(const uint8_t* Data) { return uint32_t(Get16(Data)) | (uint32_t(Get16(Data + 2)) << 16); }
+}
+
+FSaveStateWriter::FSaveStateWriter(std::vector<uint8_t>& _Buffer)
+	: Buffer(_Buffer)
+	, ChunkOffset(INDEX_NONE)
+	, bValid(true)
+{}
+
+void FSaveStateWriter::BeginChunk(uint32_t Tag, uint16_t Version)
+{
+	assert(ChunkOffset == INDEX_NONE);
+
+	ChunkOffset = Buffer.size();
+	Write(Tag);
+	Write(Version);
+	Write(uint32_t(0));
+}
+
+void FSaveStateWriter::EndChunk()
+{
+	assert(ChunkOffset != INDEX_NONE);
+
+	if (!bValid)
+	{
+		Buffer.resize(ChunkOffset);
+		ChunkOffset = INDEX_NONE;
+		return;
+	}
+
+	const uint32_t Size = uint32_t(Buffer.size() - ChunkOffset - ChunkHeaderSize);
+	uint8_t* SizeField = Buffer.data() + ChunkOffset + ChunkHeaderSize - sizeof(uint32_t);
+	SizeField[0] = uint8_t(Size);
+	SizeField[1] = uint8_t(Size >> 8);
+	SizeField[2] = uint8_t(Size >> 16);
+	SizeField[3] = uint8_t(Size >> 24);
+	ChunkOffset = INDEX_NONE;
+}
+
+void FSaveStateWriter::Write(const void* Data, size_t Size)
+{
+	const uint8_t* Bytes = reinterpret_cast<const uint8_t*>(Data);
+	Buffer.insert(Buffer.end(), Bytes, Bytes + Size);
+}
+
+void FSaveStateWriter::WriteString(std::string_view String)
+{
+	Write(uint32_t(String.size()));
+	Write(String.data(), String.size());
+}
+
+bool FSaveStateWriter::WriteMemory(const uint8_t* Data, uint32_t Size)
+{
+	// the pages point at the first of the identical ones, which is deflated in its place
+	const uint32_t PageCount = (Size + SaveState::PageSize - 1) / SaveState::PageSize;
+	std::vector<uint32_t> UniquePages;
+	std::vector<uint64_t> UniqueHashes;
+	UniquePages.reserve(PageCount);
+	UniqueHashes.reserve(PageCount);
+
+	Write(Size);
+	Write(PageCount);
+	for (uint32_t Page = 0; Page < PageCount; ++Page)
+	{
+		const uint32_t Offset = Page * SaveState::PageSize;
+		const uint32_t Length = (std::min)(SaveState::PageSize, Size - Offset);
+		const uint64_t Hash = Utils::FNV1a64(Utils::FNV1a64Basis, Data + Offset, Length);
+
+		uint32_t UniqueIndex = 0;
+		for (; UniqueIndex < UniquePages.size(); ++UniqueIndex)
+		{
+			const uint32_t UniqueOffset = UniquePages[UniqueIndex] * SaveState::PageSize;
+			if (UniqueHashes[UniqueIndex] == Hash &&
+				(std::min)(SaveState::PageSize, Size - UniqueOffset) == Length &&
+				std::memcmp(Data + UniqueOffset, Data + Offset, Length) == 0)
+			{
+				break;
+			}
+		}
+		if (UniqueIndex == UniquePages.size())
+		{
+			UniquePages.push_back(Page);
+			UniqueHashes.push_back(Hash);
+		}
+		Write(UniqueIndex);
+	}
+
+	z_stream Stream = {};
+	if (deflateInit(&Stream, Z_BEST_SPEED) != Z_OK)
+	{
+		LOG_ERROR("[{}]\t compression failed.", (__FUNCTION__));
+		bValid = false;
+		return false;
+	}
+
+	uLong UniqueSize = 0;
+	for (uint32_t Page : UniquePages)
+	{
+		UniqueSize += (std::min)(SaveState::PageSize, Size - Page * SaveState::PageSize);
+	}
+
+	const size_t SizeOffset = Buffer.size();
+	Write(uint32_t(0));
+	const size_t DataOffset = Buffer.size();
+	Buffer.resize(DataOffset + deflateBound(&Stream, UniqueSize));
+	Stream.next_out = Buffer.data() + DataOffset;
+	Stream.avail_out = uInt(Buffer.size() - DataOffset);
+
+	int32_t Result = Z_OK;
+	for (size_t Index = 0; Index < UniquePages.size() && Result == Z_OK; ++Index)
+	{
+		const uint32_t Offset = UniquePages[Index] * SaveState::PageSize;
+		Stream.next_in = const_cast<Bytef*>(Data + Offset);
+		Stream.avail_in = (std::min)(SaveState::PageSize, Size - Offset);
+		Result = deflate(&Stream, Index + 1 == UniquePages.size() ? Z_FINISH : Z_NO_FLUSH);
+	}
+	if (UniquePages.empty())
+	{
+		Result = deflate(&Stream, Z_FINISH);
+	}
+
+	const uint32_t CompressedSize = uint32_t(Stream.total_out);
+	deflateEnd(&Stream);
+	if (Result != Z_STREAM_END)
+	{
+		LOG_ERROR("[{}]\t compression failed.", (__FUNCTION__));
+		bValid = false;
+		return false;
+	}
+
+	Buffer.resize(DataOffset + CompressedSize);
+	Buffer[SizeOffset + 0] = uint8_t(CompressedSize);
+	Buffer[SizeOffset + 1] = uint8_t(CompressedSize >> 8);
+	Buffer[SizeOffset + 2] = uint8_t(CompressedSize >> 16);
+	Buffer[SizeOffset + 3] = uint8_t(CompressedSize >> 24);
+	return true;
+}
+
+FSaveStateReader::FSaveStateReader(const FSaveStateChunk& Chunk)
+	: Data(Chunk.Data)
+	, Size(Chunk.Size)
+	, Position(0)
+	, bValid(true)
+{}
+
+bool FSaveStateReader::Read(void* Output, size_t Length)
+{
+	if (!Ensure(Length))
+	{
+		return false;
+	}
+	std::memcpy(Output, Data + Position, Length);
+	Position += Length;
+	return true;
+}
+
+bool FSaveStateReader::ReadString(std::string& String)
+{
+	uint32_t Length = 0;
+	if (!Read(Length) || !Ensure(Length))
+	{
+		return false;
+	}
+	String.assign(reinterpret_cast<const char*>(Data + Position), Length);
+	Position += Length;
+	return true;
+}
+
+bool FSaveStateReader::ReadMemory(uint8_t* Output, uint32_t OutputSize)
+{
+	uint32_t MemorySize = 0, PageCount = 0;
+	if (!Read(MemorySize) || !Read(PageCount) || MemorySize != OutputSize ||
+		PageCount != (MemorySize + SaveState::PageSize - 1) / SaveState::PageSize || !Ensure(size_t(PageCount) * sizeof(uint32_t)))
+	{
+		bValid = false;
+		return false;
+	}
+	const uint8_t* PageMap = Data + Position;
+	Position += size_t(PageCount) * sizeof(uint32_t);
+
+	uint32_t CompressedSize = 0;
+	if (!Read(CompressedSize) || !Ensure(CompressedSize))
+	{
+		return false;
+	}
+
+	z_stream Stream = {};
+	if (inflateInit(&Stream) != Z_OK)
+	{
+		bValid = false;
+		return false;
+	}
+	Stream.next_in = const_cast<Bytef*>(Data + Position);
+	Stream.avail_in = CompressedSize;
+	Position += CompressedSize;
+
+	// the unique pages come in the order of their first use, the rest are copied from it
+	std::vector<uint32_t> UniquePages;
+	UniquePages.reserve(PageCount);
+	for (uint32_t Page = 0; Page < PageCount && bValid; ++Page)
+	{
+		const uint32_t UniqueIndex = Get32(PageMap + Page * sizeof(uint32_t));
+		const uint32_t Offset = Page * SaveState::PageSize;
+		const uint32_t Length = (std::min)(SaveState::PageSize, MemorySize - Offset);
+
+		if (UniqueIndex < UniquePages.size())
+		{
+			const uint32_t UniqueOffset = UniquePages[UniqueIndex] * SaveState::PageSize;
+			bValid = (std::min)(SaveState::PageSize, MemorySize - UniqueOffset) == Length;
+			if (bValid)
+			{
+				std::memcpy(Output + Offset, Output + UniqueOffset, Length);
+			}
+			continue;
+		}
+
+		bValid = UniqueIndex == UniquePages.size();
+		if (bValid)
+		{
+			UniquePages.push_back(Page);
+			Stream.next_out = Output + Offset;
+			Stream.avail_out = Length;
+			const int32_t Result = inflate(&Stream, Z_SYNC_FLUSH);
+			bValid = (Result == Z_OK || Result == Z_STREAM_END) && Stream.avail_out == 0;
+		}
+	}
+	inflateEnd(&Stream);
+	return bValid;
+}
+
+void SaveStateFile::BeginFile(std::vector<uint8_t>& Buffer)
+{
+	Buffer.clear();
+	FSaveStateWriter Writer(Buffer);
+	Writer.Write(SaveState::Magic);
+	Writer.Write(SaveState::Version);
+	Writer.Write(uint16_t(0));
+}
+
+bool SaveStateFile::Parse(const std::vector<uint8_t>& Buffer, std::vector<FSaveStateChunk>& Chunks)
+{
+	Chunks.clear();
+	if (Buffer.size() < FileHeaderSize || Get32(Buffer.data()) != SaveState::Magic)
+	{
+		LOG("SaveState: not a save-state");
+		return false;
+	}
+	if (Get16(Buffer.data() + 4) > SaveState::Version)
+	{
+		LOG("SaveState: the version {} is newer than {}", Get16(Buffer.data() + 4), SaveState::Version);
+		return false;
+	}
+
+	size_t Offset = FileHeaderSize;
+	while (Offset < Buffer.size())
+	{
+		if (Offset + ChunkHeaderSize > Buffer.size())
+		{
+			LOG("SaveState: the chunk header is cut off");
+			return false;
+		}
+
+		const uint8_t* Header = Buffer.data() + Offset;
+		FSaveStateChunk Chunk
+		{
+			.Tag = Get32(Header),
+			.Version = Get16(Header + 4),
+			.Data = Header + ChunkHeaderSize,
+			.Size = Get32(Header + 6),
+		};
+		if (Offset + ChunkHeaderSize + uint64_t(Chunk.Size) > Buffer.size())
+		{
+			LOG("SaveState: the chunk #{:08X} is cut off", Chunk.Tag);
+			return false;
+		}
+
+		Chunks.push_back(Chunk);
+		Offset += ChunkHeaderSize + Chunk.Size;
+	}
+	return true;
+}
+
+bool SaveStateFile::Load(const std::filesystem::path& FilePath, std::vector<uint8_t>& Buffer)
+{
+	std::ifstream File(FilePath, std::ios::in | std::ios::binary);
+	if (!File.is_open())
+	{
+		LOG("Could not open the file: {}", FilePath.string().c_str());
+		return false;
+	}
+
+	File.seekg(0, std::ios::end);
+	Buffer.resize(size_t(File.tellg()));
+	File.seekg(0, std::ios::beg);
+	File.read(reinterpret_cast<char*>(Buffer.data()), Buffer.size());
+	return File.good();
+}
+
+bool SaveStateFile::Save(const std::filesystem::path& FilePath, const std::vector<uint8_t>& Buffer)
+{
+	std::error_code ec;
+	std::filesystem::create_directories(FilePath.parent_path(), ec);
+
+	std::ofstream File(FilePath, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!File.is_open())
+	{
+		LOG("Could not open the file: {}", FilePath.string().c_str());
+		return false;
+	}
+	File.write(reinterpret_cast<const char*>(Buffer.data()), Buffer.size());
+	return File.good();
+}
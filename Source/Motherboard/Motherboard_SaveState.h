@@ -0,0 +1,127 @@
+#pragma once
+
+#include <CoreMinimal.h>
+
+namespace SaveState
+{
+	static constexpr uint32_t Magic = 0x53445A58;				// "XZDS"
+	static constexpr uint16_t Version = 1;
+	static constexpr uint32_t PageSize = 1024;					// memory is deduplicated by pages
+	static constexpr uint32_t SlotCount = 10;					// quick-save slots
+
+	constexpr uint32_t MakeTag(const char(&ID)[5])
+	{
+		return uint32_t(uint8_t(ID[0])) | (uint32_t(uint8_t(ID[1])) << 8) | (uint32_t(uint8_t(ID[2])) << 16) | (uint32_t(uint8_t(ID[3])) << 24);
+	}
+
+	// the board keeps its own chunk, the devices are tagged by their unique ID
+	static constexpr uint32_t ClockTag = MakeTag("CLCK");
+}
+
+// a tagged, versioned part of the state
+struct FSaveStateChunk
+{
+	uint32_t Tag;
+	uint16_t Version;
+	const uint8_t* Data;
+	uint32_t Size;
+};
+
+// little-endian values appended straight to the buffer, the chunk size is filled in when the chunk ends;
+// a failed write drops its whole chunk and keeps the writer failed
+class FSaveStateWriter
+{
+public:
+	FSaveStateWriter(std::vector<uint8_t>& _Buffer);
+
+	void BeginChunk(uint32_t Tag, uint16_t Version);
+	void EndChunk();
+
+	template<typename T>
+	void Write(T Value)
+	{
+		static_assert(std::is_integral_v<T> || std::is_enum_v<T>, "only integral values are written");
+		using UnsignedType = std::make_unsigned_t<std::conditional_t<std::is_same_v<T, bool>, uint8_t, T>>;
+		const UnsignedType Bits = UnsignedType(Value);
+		for (size_t Index = 0; Index < sizeof(UnsignedType); ++Index)
+		{
+			Buffer.push_back(uint8_t(Bits >> (Index * 8)));
+		}
+	}
+	void Write(const void* Data, size_t Size);
+	void WriteString(std::string_view String);
+
+	// identical pages are stored once, the unique ones are deflated straight from the storage
+	bool WriteMemory(const uint8_t* Data, uint32_t Size);
+
+	FORCEINLINE bool IsValid() const { return bValid; }
+
+private:
+	std::vector<uint8_t>& Buffer;
+	size_t ChunkOffset;
+	bool bValid;
+};
+
+// reads the values of one chunk, a read past the end fails and keeps failing
+class FSaveStateReader
+{
+public:
+	FSaveStateReader(const FSaveStateChunk& Chunk);
+
+	template<typename T>
+	bool Read(T& Value)
+	{
+		static_assert(std::is_integral_v<T> || std::is_enum_v<T>, "only integral values are read");
+		using UnsignedType = std::make_unsigned_t<std::conditional_t<std::is_same_v<T, bool>, uint8_t, T>>;
+		if (!Ensure(sizeof(UnsignedType)))
+		{
+			return false;
+		}
+
+		UnsignedType Bits = 0;
+		for (size_t Index = 0; Index < sizeof(UnsignedType); ++Index)
+		{
+			Bits |= UnsignedType(UnsignedType(Data[Position + Index]) << (Index * 8));
+		}
+		Position += sizeof(UnsignedType);
+
+		if constexpr (std::is_same_v<T, bool>)
+		{
+			Value = Bits != 0;
+		}
+		else
+		{
+			Value = T(Bits);
+		}
+		return true;
+	}
+	bool Read(void* Output, size_t Size);
+	bool ReadString(std::string& String);
+
+	// the memory has to be of the saved size
+	bool ReadMemory(uint8_t* Output, uint32_t Size);
+
+	FORCEINLINE bool IsValid() const { return bValid; }
+
+private:
+	FORCEINLINE bool Ensure(size_t Size)
+	{
+		bValid = bValid && Position + Size <= this->Size;
+		return bValid;
+	}
+
+	const uint8_t* Data;
+	size_t Size;
+	size_t Position;
+	bool bValid;
+};
+
+namespace SaveStateFile
+{
+	void BeginFile(std::vector<uint8_t>& Buffer);
+	// splits the state into chunks, they point into the buffer
+	bool Parse(const std::vector<uint8_t>& Buffer, std::vector<FSaveStateChunk>& Chunks);
+
+	bool Load(const std::filesystem::path& FilePath, std::vector<uint8_t>& Buffer);
+	bool Save(const std::filesystem::path& FilePath, const std::vector<uint8_t>& Buffer);
+}
@@ -0,0 +1,669 @@
+#include "Motherboard_Snapshot.h"
+
+namespace
+{
+	static constexpr uint32_t SNA_HeaderSize = 27;
+	static constexpr uint32_t Z80_HeaderSize = 30;
+	static constexpr uint16_t Z80_ExtraHeaderSizeV3 = 54;
+	static constexpr uint32_t SZX_Magic = 0x5453585A;			// "ZXST"
+	static constexpr uint8_t SZX_Machine48K = 1;
+	static constexpr uint16_t SZX_RAMCompressed = 0x0001;
+	static const char* CreatorName = "ZX-Debugger";
+
+	FORCEINLINE uint16_t Get16(const uint8_t* Data) { return uint16_t(Data[0] | (Data[1] << 8)); }
+	FORCEINLINE uint32_t Get32(const uint8_t* Data) { return uint32_t(Get16(Data)) | (uint32_t(Get16(Data + 2)) << 16); }
+
+	FORCEINLINE void Put8(std::vector<uint8_t>& Output, uint8_t Value) { Output.push_back(Value); }
+	FORCEINLINE void Put16(std::vector<uint8_t>& Output, uint16_t Value) { Output.push_back(uint8_t(Value)); Output.push_back(uint8_t(Value >> 8)); }
+	FORCEINLINE void Put32(std::vector<uint8_t>& Output, uint32_t Value) { Put16(Output, uint16_t(Value)); Put16(Output, uint16_t(Value >> 16)); }
+	FORCEINLINE void PutID(std::vector<uint8_t>& Output, const char* ID) { Output.insert(Output.end(), ID, ID + 4); }
+
+	// the RAM of the 48K machine by the page numbers of the formats
+	int32_t Z80_PageOffset(uint8_t Page)
+	{
+		switch (Page)
+		{
+			case 8: return 0x0000;
+			case 4: return 0x4000;
+			case 5: return 0x8000;
+			default: return INDEX_NONE;
+		}
+	}
+
+	int32_t SZX_PageOffset(uint8_t Page)
+	{
+		switch (Page)
+		{
+			case 5: return 0x0000;
+			case 2: return 0x4000;
+			case 0: return 0x8000;
+			default: return INDEX_NONE;
+		}
+	}
+
+	bool ReadFile(const std::filesystem::path& FilePath, std::vector<uint8_t>& Output)
+	{
+		std::ifstream File(FilePath, std::ios::in | std::ios::binary);
+		if (!File.is_open())
+		{
+			LOG("Could not open the file: {}", FilePath.string().c_str());
+			return false;
+		}
+		Output.assign(std::istreambuf_iterator<char>(File), std::istreambuf_iterator<char>());
+		return true;
+	}
+
+	bool WriteFile(const std::filesystem::path& FilePath, const std::vector<uint8_t>& Data)
+	{
+		std::error_code ec;
+		std::filesystem::create_directories(FilePath.parent_path(), ec);
+
+		std::ofstream File(FilePath, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!File.is_open())
+		{
+			LOG("Could not open the file: {}", FilePath.string().c_str());
+			return false;
+		}
+		File.write(reinterpret_cast<const char*>(Data.data()), Data.size());
+		return File.good();
+	}
+
+	// .z80 block compression: ED ED nn bb repeats bb nn times, the byte after a single ED is never a part of a run
+	class FZ80Decoder
+	{
+	public:
+		FZ80Decoder(std::istream& _Stream)
+			: Stream(_Stream)
+			, Position(0)
+			, Size(0)
+			, Remaining(0)
+		{}
+
+		// the limit of the compressed bytes in the stream, the rest of the file if not known
+		void SetLimit(uint64_t Limit) { Remaining = Limit; }
+
+		bool Read(uint8_t* Output, uint32_t Length)
+		{
+			for (uint32_t Index = 0; Index < Length; ++Index)
+			{
+				if (!Get(Output[Index]))
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		bool Decompress(uint8_t* Output, uint32_t Length)
+		{
+			uint32_t Index = 0;
+			while (Index < Length)
+			{
+				uint8_t Value;
+				if (!Get(Value))
+				{
+					return false;
+				}
+				// the last byte of the block can't start a run
+				if (Value != 0xED || Index + 1 == Length)
+				{
+					Output[Index++] = Value;
+					continue;
+				}
+
+				uint8_t Next;
+				if (!Get(Next))
+				{
+					return false;
+				}
+				if (Next != 0xED)
+				{
+					Output[Index++] = Value;
+					if (Index < Length)
+					{
+						Output[Index++] = Next;
+					}
+					continue;
+				}
+
+				uint8_t Count, Repeated;
+				if (!Get(Count) || !Get(Repeated))
+				{
+					return false;
+				}
+				const uint32_t RunLength = (std::min)(uint32_t(Count), Length - Index);
+				std::memset(Output + Index, Repeated, RunLength);
+				Index += RunLength;
+			}
+			return true;
+		}
+
+		bool Skip(uint64_t Length)
+		{
+			uint8_t Value;
+			for (uint64_t Index = 0; Index < Length; ++Index)
+			{
+				if (!Get(Value))
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+	private:
+		FORCEINLINE bool Get(uint8_t& Value)
+		{
+			if (Remaining == 0)
+			{
+				return false;
+			}
+			if (Position == Size)
+			{
+				Stream.read(reinterpret_cast<char*>(Buffer), sizeof(Buffer));
+				Size = uint32_t(Stream.gcount());
+				Position = 0;
+				if (Size == 0)
+				{
+					return false;
+				}
+			}
+			--Remaining;
+			Value = Buffer[Position++];
+			return true;
+		}
+
+		std::istream& Stream;
+		uint8_t Buffer[4096];
+		uint32_t Position;
+		uint32_t Size;
+		uint64_t Remaining;
+	};
+
+	void Z80_Compress(const uint8_t* Data, uint32_t Length, std::vector<uint8_t>& Output)
+	{
+		uint32_t Index = 0;
+		while (Index < Length)
+		{
+			const uint8_t Value = Data[Index];
+			uint32_t RunLength = 1;
+			while (Index + RunLength < Length && Data[Index + RunLength] == Value && RunLength < 255)
+			{
+				++RunLength;
+			}
+
+			if (RunLength >= 5 || (Value == 0xED && RunLength >= 2))
+			{
+				Output.insert(Output.end(), { 0xED, 0xED, uint8_t(RunLength), Value });
+				Index += RunLength;
+				continue;
+			}
+
+			Output.push_back(Value);
+			++Index;
+			if (Value == 0xED && Index < Length)
+			{
+				Output.push_back(Data[Index++]);
+			}
+		}
+	}
+
+	bool Load_SNA(const std::filesystem::path& FilePath, FMachineSnapshot& Output)
+	{
+		std::vector<uint8_t> File;
+		if (!ReadFile(FilePath, File))
+		{
+			return false;
+		}
+		if (File.size() != SNA_HeaderSize + Snapshot::RAMSize)
+		{
+			LOG("Snapshot: only 48K .sna files are supported: {}", FilePath.string().c_str());
+			return false;
+		}
+
+		const uint8_t* Header = File.data();
+		FRegisters& Registers = Output.Registers;
+		Registers.HL_ = Get16(Header + 1);
+		Registers.DE_ = Get16(Header + 3);
+		Registers.BC_ = Get16(Header + 5);
+		Registers.AF_ = Get16(Header + 7);
+		Registers.HL = Get16(Header + 9);
+		Registers.DE = Get16(Header + 11);
+		Registers.BC = Get16(Header + 13);
+		Registers.IY = Get16(Header + 15);
+		Registers.IX = Get16(Header + 17);
+		Registers.IR = uint16_t((Header[0] << 8) | Header[20]);
+		Registers.AF = Get16(Header + 21);
+		Registers.IM = Header[25] & 0x03;
+		// the state is saved inside an interrupt, RETN restores IFF1 from IFF2
+		Registers.bIFF2 = (Header[19] & 0x04) != 0;
+		Registers.bIFF1 = Registers.bIFF2;
+		Output.BorderColor = Header[26] & 0x07;
+		Output.RAM.assign(File.begin() + SNA_HeaderSize, File.end());
+
+		// RETN
+		const uint16_t SP = Get16(Header + 23);
+		const auto Peek = [&](uint16_t Address) -> uint8_t { return Address >= Snapshot::RAMAddress ? Output.RAM[Address - Snapshot::RAMAddress] : 0; };
+		Registers.PC = uint16_t(Peek(SP) | (Peek(uint16_t(SP + 1)) << 8));
+		Registers.SP = uint16_t(SP + 2);
+		return true;
+	}
+
+	bool Save_SNA(const std::filesystem::path& FilePath, const FMachineSnapshot& Input)
+	{
+		const FRegisters& Registers = Input.Registers;
+
+		// PC goes on the stack
+		const uint16_t SP = uint16_t(*Registers.SP - 2);
+		if (SP < Snapshot::RAMAddress || SP + 1u >= Snapshot::RAMAddress + Snapshot::RAMSize)
+		{
+			LOG("Snapshot: the stack at #{:04X} is outside RAM, PC can't be saved to .sna", *Registers.SP);
+			return false;
+		}
+
+		std::vector<uint8_t> File;
+		File.reserve(SNA_HeaderSize + Snapshot::RAMSize);
+		Put8(File, uint8_t(*Registers.IR >> 8));
+		Put16(File, *Registers.HL_);
+		Put16(File, *Registers.DE_);
+		Put16(File, *Registers.BC_);
+		Put16(File, *Registers.AF_);
+		Put16(File, *Registers.HL);
+		Put16(File, *Registers.DE);
+		Put16(File, *Registers.BC);
+		Put16(File, *Registers.IY);
+		Put16(File, *Registers.IX);
+		Put8(File, Registers.bIFF2 ? 0x04 : 0x00);
+		Put8(File, uint8_t(*Registers.IR));
+		Put16(File, *Registers.AF);
+		Put16(File, SP);
+		Put8(File, Registers.IM);
+		Put8(File, Input.BorderColor & 0x07);
+
+		const size_t RAMOffset = File.size();
+		File.insert(File.end(), Input.RAM.begin(), Input.RAM.end());
+		File[RAMOffset + SP - Snapshot::RAMAddress] = uint8_t(*Registers.PC);
+		File[RAMOffset + SP - Snapshot::RAMAddress + 1] = uint8_t(*Registers.PC >> 8);
+		return WriteFile(FilePath, File);
+	}
+
+	bool Load_Z80(const std::filesystem::path& FilePath, FMachineSnapshot& Output)
+	{
+		std::ifstream File(FilePath, std::ios::in | std::ios::binary);
+		if (!File.is_open())
+		{
+			LOG("Could not open the file: {}", FilePath.string().c_str());
+			return false;
+		}
+
+		FZ80Decoder Decoder(File);
+		Decoder.SetLimit(UINT64_MAX);
+
+		uint8_t Header[Z80_HeaderSize];
+		if (!Decoder.Read(Header, Z80_HeaderSize))
+		{
+			LOG("Snapshot: the file is too short: {}", FilePath.string().c_str());
+			return false;
+		}
+
+		// compatibility: 0xFF is 1
+		const uint8_t Flags = Header[12] == 0xFF ? 0x01 : Header[12];
+
+		FRegisters& Registers = Output.Registers;
+		Registers.AF = uint16_t((Header[0] << 8) | Header[1]);
+		Registers.BC = Get16(Header + 2);
+		Registers.HL = Get16(Header + 4);
+		Registers.PC = Get16(Header + 6);
+		Registers.SP = Get16(Header + 8);
+		Registers.IR = uint16_t((Header[10] << 8) | (Header[11] & 0x7F) | ((Flags & 0x01) << 7));
+		Registers.DE = Get16(Header + 13);
+		Registers.BC_ = Get16(Header + 15);
+		Registers.DE_ = Get16(Header + 17);
+		Registers.HL_ = Get16(Header + 19);
+		Registers.AF_ = uint16_t((Header[21] << 8) | Header[22]);
+		Registers.IY = Get16(Header + 23);
+		Registers.IX = Get16(Header + 25);
+		Registers.bIFF1 = Header[27] != 0;
+		Registers.bIFF2 = Header[28] != 0;
+		Registers.IM = Header[29] & 0x03;
+		Output.BorderColor = (Flags >> 1) & 0x07;
+		Output.RAM.assign(Snapshot::RAMSize, 0);
+
+		// version 1: the 48K memory follows the header as one block
+		if (*Registers.PC != 0)
+		{
+			const bool bSuccess = (Flags & 0x20)
+				? Decoder.Decompress(Output.RAM.data(), Snapshot::RAMSize)
+				: Decoder.Read(Output.RAM.data(), Snapshot::RAMSize);
+			if (!bSuccess)
+			{
+				LOG("Snapshot: the memory is cut off: {}", FilePath.string().c_str());
+			}
+			return bSuccess;
+		}
+
+		// versions 2 and 3: the extended header and the pages
+		uint8_t ExtraSize[2];
+		if (!Decoder.Read(ExtraSize, 2))
+		{
+			return false;
+		}
+
+		std::vector<uint8_t> Extra(Get16(ExtraSize));
+		if (Extra.size() < 4 || !Decoder.Read(Extra.data(), uint32_t(Extra.size())))
+		{
+			LOG("Snapshot: the extended header is damaged: {}", FilePath.string().c_str());
+			return false;
+		}
+		Registers.PC = Get16(Extra.data());
+
+		const uint8_t Hardware = Extra[2];
+		const bool bMachine48K = Hardware == 0 || Hardware == 1 || (Extra.size() > 23 && Hardware == 3);
+		if (!bMachine48K)
+		{
+			LOG("Snapshot: only the 48K machine is supported, the hardware mode is {}: {}", Hardware, FilePath.string().c_str());
+			return false;
+		}
+
+		uint8_t PageHeader[3];
+		while (Decoder.Read(PageHeader, 3))
+		{
+			const uint16_t Length = Get16(PageHeader);
+			const int32_t Offset = Z80_PageOffset(PageHeader[2]);
+			const bool bCompressed = Length != 0xFFFF;
+			const uint64_t StoredSize = bCompressed ? Length : Snapshot::PageSize;
+
+			if (Offset == INDEX_NONE)
+			{
+				Decoder.Skip(StoredSize);
+				continue;
+			}
+
+			Decoder.SetLimit(StoredSize);
+			const bool bSuccess = bCompressed
+				? Decoder.Decompress(Output.RAM.data() + Offset, Snapshot::PageSize)
+				: Decoder.Read(Output.RAM.data() + Offset, Snapshot::PageSize);
+			if (!bSuccess)
+			{
+				LOG("Snapshot: the page {} is damaged: {}", PageHeader[2], FilePath.string().c_str());
+				return false;
+			}
+
+			// whatever the page didn't use
+			Decoder.Skip(StoredSize);
+			Decoder.SetLimit(UINT64_MAX);
+		}
+		return true;
+	}
+
+	bool Save_Z80(const std::filesystem::path& FilePath, const FMachineSnapshot& Input)
+	{
+		const FRegisters& Registers = Input.Registers;
+
+		std::vector<uint8_t> File;
+		File.reserve(Snapshot::RAMSize);
+		Put8(File, uint8_t(*Registers.AF >> 8));
+		Put8(File, uint8_t(*Registers.AF));
+		Put16(File, *Registers.BC);
+		Put16(File, *Registers.HL);
+		Put16(File, 0);								// version 2 and above
+		Put16(File, *Registers.SP);
+		Put8(File, uint8_t(*Registers.IR >> 8));
+		Put8(File, uint8_t(*Registers.IR) & 0x7F);
+		Put8(File, uint8_t(((*Registers.IR >> 7) & 0x01) | ((Input.BorderColor & 0x07) << 1)));
+		Put16(File, *Registers.DE);
+		Put16(File, *Registers.BC_);
+		Put16(File, *Registers.DE_);
+		Put16(File, *Registers.HL_);
+		Put8(File, uint8_t(*Registers.AF_ >> 8));
+		Put8(File, uint8_t(*Registers.AF_));
+		Put16(File, *Registers.IY);
+		Put16(File, *Registers.IX);
+		Put8(File, Registers.bIFF1 ? 1 : 0);
+		Put8(File, Registers.bIFF2 ? 1 : 0);
+		Put8(File, Registers.IM & 0x03);
+
+		// version 3, 48K, the rest of the extended header is zero
+		Put16(File, Z80_ExtraHeaderSizeV3);
+		const size_t ExtraOffset = File.size();
+		File.resize(ExtraOffset + Z80_ExtraHeaderSizeV3, 0);
+		File[ExtraOffset + 0] = uint8_t(*Registers.PC);
+		File[ExtraOffset + 1] = uint8_t(*Registers.PC >> 8);
+
+		std::vector<uint8_t> Compressed;
+		for (uint8_t Page : { 8, 4, 5 })
+		{
+			Compressed.clear();
+			Z80_Compress(Input.RAM.data() + Z80_PageOffset(Page), Snapshot::PageSize, Compressed);
+
+			// a page that doesn't compress is stored as it is
+			if (Compressed.size() >= Snapshot::PageSize)
+			{
+				Put16(File, 0xFFFF);
+				Put8(File, Page);
+				File.insert(File.end(), Input.RAM.begin() + Z80_PageOffset(Page), Input.RAM.begin() + Z80_PageOffset(Page) + Snapshot::PageSize);
+				continue;
+			}
+			Put16(File, uint16_t(Compressed.size()));
+			Put8(File, Page);
+			File.insert(File.end(), Compressed.begin(), Compressed.end());
+		}
+		return WriteFile(FilePath, File);
+	}
+
+	bool Load_SZX(const std::filesystem::path& FilePath, FMachineSnapshot& Output)
+	{
+		std::vector<uint8_t> File;
+		if (!ReadFile(FilePath, File))
+		{
+			return false;
+		}
+		if (File.size() < 8 || Get32(File.data()) != SZX_Magic)
+		{
+			LOG("Snapshot: not a .szx file: {}", FilePath.string().c_str());
+			return false;
+		}
+		if (File[6] != SZX_Machine48K)
+		{
+			LOG("Snapshot: only the 48K machine is supported, the machine is {}: {}", File[6], FilePath.string().c_str());
+			return false;
+		}
+
+		Output.RAM.assign(Snapshot::RAMSize, 0);
+		bool bRegisters = false;
+
+		size_t Offset = 8;
+		while (Offset + 8 <= File.size())
+		{
+			const uint8_t* ID = File.data() + Offset;
+			const uint32_t Size = Get32(File.data() + Offset + 4);
+			const uint8_t* Block = File.data() + Offset + 8;
+			if (Offset + 8 + uint64_t(Size) > File.size())
+			{
+				LOG("Snapshot: the block {} is cut off: {}", std::string(ID, ID + 4), FilePath.string().c_str());
+				return false;
+			}
+			Offset += 8 + Size;
+
+			if (std::memcmp(ID, "Z80R", 4) == 0 && Size >= 29)
+			{
+				FRegisters& Registers = Output.Registers;
+				Registers.AF = Get16(Block + 0);
+				Registers.BC = Get16(Block + 2);
+				Registers.DE = Get16(Block + 4);
+				Registers.HL = Get16(Block + 6);
+				Registers.AF_ = Get16(Block + 8);
+				Registers.BC_ = Get16(Block + 10);
+				Registers.DE_ = Get16(Block + 12);
+				Registers.HL_ = Get16(Block + 14);
+				Registers.IX = Get16(Block + 16);
+				Registers.IY = Get16(Block + 18);
+				Registers.SP = Get16(Block + 20);
+				Registers.PC = Get16(Block + 22);
+				Registers.IR = uint16_t((Block[24] << 8) | Block[25]);
+				Registers.bIFF1 = Block[26] != 0;
+				Registers.bIFF2 = Block[27] != 0;
+				Registers.IM = Block[28] & 0x03;
+				bRegisters = true;
+			}
+			else if (std::memcmp(ID, "SPCR", 4) == 0 && Size >= 1)
+			{
+				Output.BorderColor = Block[0] & 0x07;
+			}
+			else if (std::memcmp(ID, "RAMP", 4) == 0 && Size >= 3)
+			{
+				const uint16_t Flags = Get16(Block);
+				const int32_t PageOffset = SZX_PageOffset(Block[2]);
+				if (PageOffset == INDEX_NONE)
+				{
+					continue;
+				}
+
+				uint8_t* Page = Output.RAM.data() + PageOffset;
+				if (Flags & SZX_RAMCompressed)
+				{
+					uLongf PageSize = Snapshot::PageSize;
+					if (uncompress(Page, &PageSize, Block + 3, Size - 3) != Z_OK || PageSize != Snapshot::PageSize)
+					{
+						LOG("Snapshot: the page {} is damaged: {}", Block[2], FilePath.string().c_str());
+						return false;
+					}
+				}
+				else if (Size - 3 >= Snapshot::PageSize)
+				{
+					std::memcpy(Page, Block + 3, Snapshot::PageSize);
+				}
+			}
+		}
+
+		if (!bRegisters)
+		{
+			LOG("Snapshot: no registers in {}", FilePath.string().c_str());
+		}
+		return bRegisters;
+	}
+
+	bool Save_SZX(const std::filesystem::path& FilePath, const FMachineSnapshot& Input)
+	{
+		const FRegisters& Registers = Input.Registers;
+
+		std::vector<uint8_t> File;
+		Put32(File, SZX_Magic);
+		Put8(File, 1);								// version 1.4
+		Put8(File, 4);
+		Put8(File, SZX_Machine48K);
+		Put8(File, 0);
+
+		// creator
+		PutID(File, "CRTR");
+		Put32(File, 36);
+		char Name[32] = {};
+		std::memcpy(Name, CreatorName, (std::min)(std::strlen(CreatorName), sizeof(Name) - 1));
+		File.insert(File.end(), Name, Name + sizeof(Name));
+		Put16(File, 0);
+		Put16(File, 0);
+
+		PutID(File, "Z80R");
+		Put32(File, 37);
+		for (uint16_t Value : { *Registers.AF, *Registers.BC, *Registers.DE, *Registers.HL,
+								*Registers.AF_, *Registers.BC_, *Registers.DE_, *Registers.HL_,
+								*Registers.IX, *Registers.IY, *Registers.SP, *Registers.PC })
+		{
+			Put16(File, Value);
+		}
+		Put8(File, uint8_t(*Registers.IR >> 8));
+		Put8(File, uint8_t(*Registers.IR));
+		Put8(File, Registers.bIFF1 ? 1 : 0);
+		Put8(File, Registers.bIFF2 ? 1 : 0);
+		Put8(File, Registers.IM);
+		Put32(File, 0);								// cycles since the interrupt
+		Put8(File, 0);								// hold the interrupt request
+		Put8(File, 0);								// flags
+		Put16(File, 0);								// MEMPTR
+
+		PutID(File, "SPCR");
+		Put32(File, 8);
+		Put8(File, Input.BorderColor & 0x07);
+		File.insert(File.end(), 7, 0);
+
+		std::vector<uint8_t> Compressed(compressBound(Snapshot::PageSize));
+		for (uint8_t Page : { 5, 2, 0 })
+		{
+			uLongf CompressedSize = uLongf(Compressed.size());
+			if (compress2(Compressed.data(), &CompressedSize, Input.RAM.data() + SZX_PageOffset(Page), Snapshot::PageSize, Z_BEST_COMPRESSION) != Z_OK)
+			{
+				LOG_ERROR("[{}]\t compression failed.", (__FUNCTION__));
+				return false;
+			}
+
+			PutID(File, "RAMP");
+			Put32(File, uint32_t(3 + CompressedSize));
+			Put16(File, SZX_RAMCompressed);
+			Put8(File, Page);
+			File.insert(File.end(), Compressed.begin(), Compressed.begin() + CompressedSize);
+		}
+		return WriteFile(FilePath, File);
+	}
+}
+
+ESnapshotFormat::Type SnapshotFile::GetFormat(const std::filesystem::path& FilePath)
+{
+	std::string Extension = FilePath.extension().string();
+	std::transform(Extension.begin(), Extension.end(), Extension.begin(), [](char Char) { return char(std::tolower(Char)); });
+
+	if (Extension == ".sna") return ESnapshotFormat::SNA;
+	if (Extension == ".z80") return ESnapshotFormat::Z80;
+	if (Extension == ".szx") return ESnapshotFormat::SZX;
+	return ESnapshotFormat::Unknown;
+}
+
+bool SnapshotFile::Load(const std::filesystem::path& FilePath, FMachineSnapshot& Output)
+{
+	Output = FMachineSnapshot();
+	bool bSuccess = false;
+	switch (GetFormat(FilePath))
+	{
+		case ESnapshotFormat::SNA: bSuccess = Load_SNA(FilePath, Output); break;
+		case ESnapshotFormat::Z80: bSuccess = Load_Z80(FilePath, Output); break;
+		case ESnapshotFormat::SZX: bSuccess = Load_SZX(FilePath, Output); break;
+		default:
+		{
+			LOG("Snapshot: unknown format: {}", FilePath.string().c_str());
+			return false;
+		}
+	}
+
+	if (bSuccess)
+	{
+		LOG("Snapshot: loaded {}, PC #{:04X}", FilePath.string().c_str(), *Output.Registers.PC);
+	}
+	return bSuccess;
+}
+
+bool SnapshotFile::Save(const std::filesystem::path& FilePath, const FMachineSnapshot& Input)
+{
+	if (Input.RAM.size() != Snapshot::RAMSize)
+	{
+		LOG_ERROR("[{}]\t the memory has to be 48K.", (__FUNCTION__));
+		return false;
+	}
+
+	bool bSuccess = false;
+	switch (GetFormat(FilePath))
+	{
+		case ESnapshotFormat::SNA: bSuccess = Save_SNA(FilePath, Input); break;
+		case ESnapshotFormat::Z80: bSuccess = Save_Z80(FilePath, Input); break;
+		case ESnapshotFormat::SZX: bSuccess = Save_SZX(FilePath, Input); break;
+		default:
+		{
+			LOG("Snapshot: unknown format: {}", FilePath.string().c_str());
+			return false;
+		}
+	}
+
+	if (bSuccess)
+	{
+		LOG("Snapshot: saved {}", FilePath.string().c_str());
+	}
+	return bSuccess;
+}
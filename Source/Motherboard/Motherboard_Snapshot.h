@@ -0,0 +1,42 @@
+#pragma once
+
+#include <CoreMinimal.h>
+#include "Devices/CPU/Interface_CPU_Z80.h"
+
+namespace ESnapshotFormat
+{
+	enum Type : uint8_t
+	{
+		Unknown,
+		SNA,
+		Z80,
+		SZX,
+	};
+}
+
+namespace Snapshot
+{
+	static constexpr uint16_t RAMAddress = 0x4000;
+	static constexpr uint32_t RAMSize = 0xC000;		// 48K
+	static constexpr uint32_t PageSize = 0x4000;
+}
+
+// the machine state the standard snapshot formats describe
+struct FMachineSnapshot
+{
+	FRegisters Registers = {};
+	uint8_t BorderColor = 7;
+	std::vector<uint8_t> RAM;				// Snapshot::RAMAddress - 0xFFFF
+};
+
+// .sna, .z80 and .szx files of the 48K machine, the format is chosen by the extension
+//
+// .z80 pages are decompressed while they are read from the file, .szx pages are saved compressed with zlib.
+// .sna keeps PC on the stack: it is popped on load and pushed into the saved copy of the memory on save
+namespace SnapshotFile
+{
+	ESnapshotFormat::Type GetFormat(const std::filesystem::path& FilePath);
+
+	bool Load(const std::filesystem::path& FilePath, FMachineSnapshot& Output);
+	bool Save(const std::filesystem::path& FilePath, const FMachineSnapshot& Input);
+}
@@ -0,0 +1,118 @@
+#include "Motherboard_TapeTrap.h"
+
+#include "Devices/IO/Tape.h"
+#include "Devices/CPU/Interface_CPU_Z80.h"
+#include "Utils/Memory.h"
+
+FTapeTrap::FTapeTrap()
+	: bEnabled(false)
+	, bInstrCycleDone(false)
+	, CPU(nullptr)
+	, Tape(nullptr)
+{}
+
+void FTapeTrap::Enable(ICPU_Z80* _CPU, FTape* _Tape)
+{
+	CPU = _CPU;
+	Tape = _Tape;
+	bEnabled = CPU != nullptr && Tape != nullptr;
+	bInstrCycleDone = false;
+}
+
+void FTapeTrap::Disable()
+{
+	bEnabled = false;
+	CPU = nullptr;
+	Tape = nullptr;
+}
+
+bool FTapeTrap::Tick()
+{
+	// an instruction ends on the rising edge of the flag, the next one is fetched from PC
+	const bool bDone = CPU->IsInstrCycleDone();
+	if (bDone == bInstrCycleDone)
+	{
+		return false;
+	}
+
+	bInstrCycleDone = bDone;
+	return bDone && *CPU->GetRegisters().PC == TapeTrap::LD_BYTES;
+}
+
+bool FTapeTrap::LoadBytes(FMemorySnapshot& MemorySnapshot)
+{
+	std::vector<uint8_t> AddressSpace;
+	Memory::ToAddressSpace(MemorySnapshot, AddressSpace);
+
+	// another ROM is paged in
+	if (!std::equal(std::begin(TapeTrap::LD_BYTES_Code), std::end(TapeTrap::LD_BYTES_Code), AddressSpace.begin() + TapeTrap::LD_BYTES))
+	{
+		return false;
+	}
+
+	const FTapeBlock* Block = Tape->TakeDataBlock();
+	if (Block == nullptr || Block->Data.empty())
+	{
+		return false;
+	}
+
+	FRegisters Registers = CPU->GetRegisters();
+	const std::vector<uint8_t>& Data = Block->Data;
+	const bool bLoad = (*Registers.AF.L & Z80_CF) != 0;
+
+	// the flag byte has to match, then the bytes and the checksum follow
+	bool bSuccess = Data[0] == *Registers.AF.H;
+	if (bSuccess)
+	{
+		uint8_t Parity = Data[0];
+		uint16_t Address = *Registers.IX;
+		uint16_t Length = *Registers.DE;
+		size_t Index = 1;
+
+		for (; Length != 0 && Index < Data.size(); --Length, ++Index, ++Address)
+		{
+			const uint8_t Value = Data[Index];
+			Parity ^= Value;
+
+			bool bReadOnly = false;
+			Memory::GetAccessMode(MemorySnapshot, Address, bReadOnly);
+			if (bLoad)
+			{
+				if (!bReadOnly)
+				{
+					AddressSpace[Address] = Value;
+				}
+			}
+			else if (AddressSpace[Address] != Value)
+			{
+				bSuccess = false;
+				break;
+			}
+		}
+
+		// the block is too short for the requested length or has no checksum
+		if (!bSuccess || Length != 0 || Index >= Data.size())
+		{
+			bSuccess = false;
+		}
+		else
+		{
+			Parity ^= Data[Index];
+			bSuccess = Parity == 0;
+		}
+
+		Registers.IX = Address;
+		Registers.DE = Length;
+	}
+
+	Registers.AF.L = bSuccess ? uint8_t(*Registers.AF.L | Z80_CF) : uint8_t(*Registers.AF.L & ~Z80_CF);
+
+	// RET
+	const uint16_t SP = *Registers.SP;
+	Registers.PC = uint16_t(AddressSpace[SP] | (AddressSpace[uint16_t(SP + 1)] << 8));
+	Registers.SP = uint16_t(SP + 2);
+	CPU->SetRegisters(Registers);
+
+	Memory::ToSnapshot(MemorySnapshot, AddressSpace);
+	return true;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <CoreMinimal.h>
+
+class FTape;
+class ICPU_Z80;
+struct FMemorySnapshot;
+
+namespace TapeTrap
+{
+	static constexpr uint16_t LD_BYTES = 0x0556;				// the entry point of the 48K ROM loader
+	static constexpr uint8_t LD_BYTES_Code[] = { 0x14, 0x08 };	// INC D, EX AF,AF'
+}
+
+// fast loading: the ROM routine LD-BYTES is replaced by the next data block of the tape
+//
+// the emulation thread calls Tick after every clock generator tick while the trap is enabled, the entry point is
+// checked when the CPU finishes an instruction. the block is copied (or verified) against the registers
+// the routine takes: A - the flag byte, carry - load or verify, IX - the address, DE - the length,
+// then the routine returns to the caller with carry set on success, as the ROM does
+class FTapeTrap
+{
+public:
+	FTapeTrap();
+
+	FORCEINLINE bool IsEnabled() const { return bEnabled; }
+
+	void Enable(ICPU_Z80* _CPU, FTape* _Tape);
+	void Disable();
+
+	// the CPU is about to execute LD-BYTES
+	bool Tick();
+	// the memory is updated in place, false if the trap didn't take place and the ROM has to load the block itself
+	bool LoadBytes(FMemorySnapshot& MemorySnapshot);
+
+private:
+	bool bEnabled;
+	bool bInstrCycleDone;
+	ICPU_Z80* CPU;
+	FTape* Tape;
+};
@@ -6,12 +6,18 @@
 #include "Devices/CPU/Interface_CPU_Z80.h"
 #include "Devices/Memory/Interface_Memory.h"
 #include "Devices/ControlUnit/Interface_Display.h"
+#include "Devices/IO/Tape.h"
+#include "Devices/IO/Beeper.h"
+#include "Devices/IO/Keyboard.h"
 
+#include "Utils/Memory.h"
 #include "Utils/ProfilerScope.h"
 
 FThread::FThread(FName Name)
 	: ThreadName(Name)
 	, bInterruptLatch(false)
+	, bInstructionBoundaryLatch(false)
+	, bThrottle(true)
 	, StepType(FCPU_StepType::None)
 	, ThreadStatus(EThreadStatus::Unknown)
 {}
@@ -27,6 +33,9 @@ void FThread::Shutdown()
 	Thread_Request(EThreadTypeRequest::ExecuteTask,
 		[this]() -> void
 		{
+			ThreadRequest_StopTraceRecorder();
+			Input_StopRecording();
+			Input_StopReplay();
 			Device_Unregistration();
 			ThreadRequest_SetStatus(EThreadStatus::Quit);
 		});
@@ -83,6 +92,177 @@ void FThread::Input_Step(FCPU_StepType Type)
 		});
 }
 
+void FThread::Input_Key(EZXKey::Type Key, bool bPressed)
+{
+	Thread_Request(EThreadTypeRequest::ExecuteTask,
+		[=, this]() -> void
+		{
+			ThreadRequest_InputKey(Key, bPressed);
+		});
+}
+
+void FThread::StartInputRecording(std::filesystem::path FilePath)
+{
+	Thread_Request(EThreadTypeRequest::ExecuteTask,
+		[=, this]() -> void
+		{
+			ThreadRequest_StartInputRecording(FilePath);
+		});
+}
+
+void FThread::StopInputRecording()
+{
+	Thread_Request(EThreadTypeRequest::ExecuteTask,
+		[this]() -> void
+		{
+			ThreadRequest_StopInputRecording();
+		});
+}
+
+void FThread::StartInputReplay(std::filesystem::path FilePath, std::filesystem::path HashPath)
+{
+	Thread_Request(EThreadTypeRequest::ExecuteTask,
+		[=, this]() -> void
+		{
+			ThreadRequest_StartInputReplay(FilePath, HashPath);
+		});
+}
+
+void FThread::SetThrottle(bool bEnable)
+{
+	Thread_Request(EThreadTypeRequest::ExecuteTask,
+		[=, this]() -> void
+		{
+			bThrottle = bEnable;
+		});
+}
+
+void FThread::SetCodeProfiler(bool bEnable)
+{
+	Thread_Request(EThreadTypeRequest::ExecuteTask,
+		[=, this]() -> void
+		{
+			ThreadRequest_SetCodeProfiler(bEnable);
+		});
+}
+
+void FThread::ResetCodeProfiler()
+{
+	Thread_Request(EThreadTypeRequest::ExecuteTask,
+		[this]() -> void
+		{
+			CodeProfiler.Reset();
+		});
+}
+
+void FThread::SetMemoryTracker(bool bEnable)
+{
+	Thread_Request(EThreadTypeRequest::ExecuteTask,
+		[=, this]() -> void
+		{
+			ThreadRequest_SetMemoryTracker(bEnable);
+		});
+}
+
+void FThread::StartTraceRecorder(std::filesystem::path FilePath)
+{
+	Thread_Request(EThreadTypeRequest::ExecuteTask,
+		[=, this]() -> void
+		{
+			ThreadRequest_StartTraceRecorder(FilePath);
+		});
+}
+
+void FThread::StopTraceRecorder()
+{
+	Thread_Request(EThreadTypeRequest::ExecuteTask,
+		[this]() -> void
+		{
+			ThreadRequest_StopTraceRecorder();
+		});
+}
+
+void FThread::InsertTape(std::filesystem::path FilePath)
+{
+	Thread_Request(EThreadTypeRequest::ExecuteTask,
+		[=, this]() -> void
+		{
+			ThreadRequest_InsertTape(FilePath);
+		});
+}
+
+void FThread::TapeControl(ETapeControl::Type Control)
+{
+	Thread_Request(EThreadTypeRequest::ExecuteTask,
+		[=, this]() -> void
+		{
+			ThreadRequest_TapeControl(Control);
+		});
+}
+
+void FThread::SetTapeLoadMode(ETapeLoadMode::Type Mode)
+{
+	Thread_Request(EThreadTypeRequest::ExecuteTask,
+		[=, this]() -> void
+		{
+			ThreadRequest_SetTapeLoadMode(Mode);
+		});
+}
+
+void FThread::LoadSnapshot(std::filesystem::path FilePath)
+{
+	Thread_Request(EThreadTypeRequest::ExecuteTask,
+		[=, this]() -> void
+		{
+			ThreadRequest_LoadSnapshot(FilePath);
+		});
+}
+
+void FThread::SaveSnapshot(std::filesystem::path FilePath)
+{
+	Thread_Request(EThreadTypeRequest::ExecuteTask,
+		[=, this]() -> void
+		{
+			ThreadRequest_SaveSnapshot(FilePath);
+		});
+}
+
+void FThread::QuickSave(uint32_t Slot)
+{
+	Thread_Request(EThreadTypeRequest::ExecuteTask,
+		[=, this]() -> void
+		{
+			ThreadRequest_QuickSave(Slot);
+		});
+}
+
+void FThread::QuickLoad(uint32_t Slot)
+{
+	Thread_Request(EThreadTypeRequest::ExecuteTask,
+		[=, this]() -> void
+		{
+			ThreadRequest_QuickLoad(Slot);
+		});
+}
+
+void FThread::SaveState(std::filesystem::path FilePath)
+{
+	Thread_Request(EThreadTypeRequest::ExecuteTask,
+		[=, this]() -> void
+		{
+			ThreadRequest_SaveState(FilePath);
+		});
+}
+
+void FThread::LoadState(std::filesystem::path FilePath)
+{
+	Thread_Request(EThreadTypeRequest::ExecuteTask,
+		[=, this]() -> void
+		{
+			ThreadRequest_LoadState(FilePath);
+		});
+}
+
 void FThread::Device_Registration(const std::vector<std::shared_ptr<FDevice>>& _Devices)
 {
 	for (const std::shared_ptr<FDevice>& Device : _Devices)
@@ -100,7 +280,7 @@ void FThread::Device_Registration(const std::vector<std::shared_ptr<FDevice>>& _
 		}
 		else
 		{
-			LOG("[{}] : The device cannot be reinitialized.", ThreadName.ToString());
+			LOG_CATEGORY(Emulation, Warning, "[{}] : The device cannot be reinitialized.", ThreadName.ToString());
 		}
 	}
 
@@ -160,7 +340,7 @@ std::any FThread::Device_ThreadRequestResult(EName::Type DeviceID, const std::ty
 
 void FThread::Thread_Execution()
 {
-	LOG("[{}] : Thread started.", ThreadName.ToString());
+	LOG_CATEGORY(Emulation, Log, "[{}] : Thread started.", ThreadName.ToString());
 
 	// main loop
 	while (ThreadStatus != EThreadStatus::Quit)
@@ -206,6 +386,22 @@ void FThread::Thread_Execution()
 			{
 				if (Device) Device->MainTick();
 			}
+			if (TapeTrap.IsEnabled() && TapeTrap.Tick())
+			{
+				Tape_LoadBytes();
+			}
+			if (!InstructionBoundaryTasks.empty())
+			{
+				Thread_InstructionBoundary();
+			}
+			if (CodeProfiler.IsEnabled())
+			{
+				CodeProfiler.Tick(CG.GetClockCounter());
+			}
+			if (TraceRecorder.IsEnabled())
+			{
+				TraceRecorder.Tick(CG.GetClockCounter());
+			}
 
 			// check request at end of frame
 			const bool bIsInterrupt = SB.IsPositiveEdge(BUS_INT);
@@ -214,13 +410,30 @@ void FThread::Thread_Execution()
 				bInterruptLatch = bIsInterrupt;
 				if (bInterruptLatch)
 				{
+					if (MemoryTracker.IsEnabled())
+					{
+						MemoryTracker.Decay();
+					}
+
 					const std::chrono::system_clock::time_point Frame_EndTime = std::chrono::system_clock::now();
 					const std::chrono::duration<double, std::milli> ElapsedTime = Frame_EndTime - Frame_StartTime;
-					LOG("Frame Time: {:0.1f} ms", ElapsedTime.count());
+					LOG_CATEGORY(Emulation, Verbose, "Frame Time: {:0.1f} ms", ElapsedTime.count());
 					Frame_StartTime = Frame_EndTime;
 
+					if (InputLog.IsReplaying())
+					{
+						Input_ReplayFrame();
+					}
+
+					// the frame isn't waited for while the tape is loading or unthrottled, nor is it heard
+					const bool bRealTime = bThrottle && !Tape_IsAccelerated();
+					if (FBeeper* Beeper = GetDevice<FBeeper>())
+					{
+						Beeper->EndFrame(bRealTime);
+					}
+
 					const double DesiredFrameTime = 1000.0 / 50.0;
-					double SleepTime = DesiredFrameTime - ElapsedTime.count();
+					double SleepTime = bRealTime ? DesiredFrameTime - ElapsedTime.count() : 0.0;
 
 					std::chrono::system_clock::time_point SyncMainFrame_StartTime = Frame_EndTime;
 					do
@@ -255,6 +468,22 @@ void FThread::Thread_Execution()
 						});
 				}
 			}
+			if (TapeTrap.IsEnabled() && TapeTrap.Tick())
+			{
+				Tape_LoadBytes();
+			}
+			if (!InstructionBoundaryTasks.empty())
+			{
+				Thread_InstructionBoundary();
+			}
+			if (CodeProfiler.IsEnabled())
+			{
+				CodeProfiler.Tick(CG.GetClockCounter());
+			}
+			if (TraceRecorder.IsEnabled())
+			{
+				TraceRecorder.Tick(CG.GetClockCounter());
+			}
 			if (bStopTrace)
 			{
 				StepType = FCPU_StepType::None; ThreadRequest_SetStatus(EThreadStatus::Stop);
@@ -262,7 +491,7 @@ void FThread::Thread_Execution()
 		}
 	};
 
-	LOG("[{}] : Thread shutdown.", ThreadName.ToString());
+	LOG_CATEGORY(Emulation, Log, "[{}] : Thread shutdown.", ThreadName.ToString());
 }
 
 void FThread::Thread_RequestHandling()
@@ -280,6 +509,46 @@ void FThread::Thread_RequestHandling()
 	}
 }
 
+void FThread::Thread_AtInstructionBoundary(Callback&& Task)
+{
+	// the stopped CPU is between the instructions already
+	const ICPU_Z80* CPU = GetDevice<ICPU_Z80>();
+	if (CPU == nullptr || ThreadStatus <= EThreadStatus::Stop)
+	{
+		Task();
+		return;
+	}
+
+	if (InstructionBoundaryTasks.empty())
+	{
+		bInstructionBoundaryLatch = CPU->IsInstrCycleDone();
+	}
+	InstructionBoundaryTasks.push_back(std::move(Task));
+}
+
+void FThread::Thread_InstructionBoundary()
+{
+	const ICPU_Z80* CPU = GetDevice<ICPU_Z80>();
+	const bool bDone = CPU == nullptr || CPU->IsInstrCycleDone();
+	if (bDone == bInstructionBoundaryLatch)
+	{
+		return;
+	}
+
+	bInstructionBoundaryLatch = bDone;
+	if (!bDone)
+	{
+		return;
+	}
+
+	std::vector<Callback> Tasks;
+	Tasks.swap(InstructionBoundaryTasks);
+	for (Callback& Task : Tasks)
+	{
+		Task();
+	}
+}
+
 void FThread::ThreadRequest_SetStatus(EThreadStatus NewStatus)
 {
 	ThreadStatus = NewStatus;
@@ -332,6 +601,9 @@ void FThread::ThreadRequest_ExecuteTask(const Callback&& Task)
 
 void FThread::ThreadRequest_Reset()
 {
+	// the clock counter starts again, the logged clocks are over
+	Input_StopRecording();
+	Input_StopReplay();
 	CG.Reset();
 
 	for (std::shared_ptr<FDevice>& Device : Devices)
@@ -339,6 +611,8 @@ void FThread::ThreadRequest_Reset()
 		if (Device) Device->Reset();
 	}
 
+	CodeProfiler.Restart();
+	TraceRecorder.Restart();
 	ThreadRequest_SetStatus(EThreadStatus::Run);
 	SB.SetActive(BUS_RESET);
 	ADD_EVENT(CG, 8 * CG.GetSampling(), 0,
@@ -375,6 +649,552 @@ void FThread::ThreadRequest_LoadRawData(EName::Type DeviceID, std::filesystem::p
 	}
 }
 
+void FThread::ThreadRequest_SetCodeProfiler(bool bEnable)
+{
+	if (!bEnable)
+	{
+		CodeProfiler.Disable();
+		return;
+	}
+
+	ICPU_Z80* CPU = GetDevice<ICPU_Z80>();
+	if (CPU == nullptr)
+	{
+		LOG_ERROR("[{}]\t failed to find device.", (__FUNCTION__));
+		return;
+	}
+	CodeProfiler.Enable(CPU);
+}
+
+void FThread::ThreadRequest_SetMemoryTracker(bool bEnable)
+{
+	ICPU_Z80* CPU = GetDevice<ICPU_Z80>();
+	if (CPU == nullptr)
+	{
+		LOG_ERROR("[{}]\t failed to find device.", (__FUNCTION__));
+		return;
+	}
+
+	if (bEnable)
+	{
+		MemoryTracker.Enable();
+		CPU->SetMemoryTracker(&MemoryTracker);
+	}
+	else
+	{
+		CPU->SetMemoryTracker(nullptr);
+		MemoryTracker.Disable();
+	}
+}
+
+void FThread::ThreadRequest_StartTraceRecorder(std::filesystem::path FilePath)
+{
+	ICPU_Z80* CPU = GetDevice<ICPU_Z80>();
+	if (CPU == nullptr)
+	{
+		LOG_ERROR("[{}]\t failed to find device.", (__FUNCTION__));
+		return;
+	}
+
+	CPU->SetTraceRecorder(nullptr);
+	if (TraceRecorder.Start(CPU, FilePath, GetClocksPerTState()))
+	{
+		CPU->SetTraceRecorder(&TraceRecorder);
+	}
+}
+
+void FThread::ThreadRequest_StopTraceRecorder()
+{
+	if (ICPU_Z80* CPU = GetDevice<ICPU_Z80>())
+	{
+		CPU->SetTraceRecorder(nullptr);
+	}
+	TraceRecorder.Stop();
+}
+
+void FThread::ThreadRequest_InsertTape(std::filesystem::path FilePath)
+{
+	FTape* Tape = GetDevice<FTape>();
+	if (Tape == nullptr)
+	{
+		LOG_ERROR("[{}]\t failed to find device.", (__FUNCTION__));
+		return;
+	}
+	Tape->Insert(FilePath);
+}
+
+void FThread::ThreadRequest_TapeControl(ETapeControl::Type Control)
+{
+	FTape* Tape = GetDevice<FTape>();
+	if (Tape == nullptr)
+	{
+		LOG_ERROR("[{}]\t failed to find device.", (__FUNCTION__));
+		return;
+	}
+	Tape->Control(Control);
+}
+
+void FThread::ThreadRequest_SetTapeLoadMode(ETapeLoadMode::Type Mode)
+{
+	FTape* Tape = GetDevice<FTape>();
+	if (Tape == nullptr)
+	{
+		LOG_ERROR("[{}]\t failed to find device.", (__FUNCTION__));
+		return;
+	}
+
+	Tape->SetLoadMode(Mode);
+	if (Mode == ETapeLoadMode::FastLoad)
+	{
+		TapeTrap.Enable(GetDevice<ICPU_Z80>(), Tape);
+	}
+	else
+	{
+		TapeTrap.Disable();
+	}
+}
+
+void FThread::ThreadRequest_LoadSnapshot(std::filesystem::path FilePath)
+{
+	std::shared_ptr<FMachineSnapshot> Snapshot = std::make_shared<FMachineSnapshot>();
+	if (!SnapshotFile::Load(FilePath, *Snapshot))
+	{
+		return;
+	}
+
+	// the devices start from reset, the state replaces it before the first instruction is fetched
+	InstructionBoundaryTasks.clear();
+	ThreadRequest_Reset();
+	Thread_AtInstructionBoundary(
+		[=, this]() -> void
+		{
+			Snapshot_Apply(*Snapshot);
+		});
+}
+
+void FThread::ThreadRequest_SaveSnapshot(std::filesystem::path FilePath)
+{
+	Thread_AtInstructionBoundary(
+		[=, this]() -> void
+		{
+			FMachineSnapshot Snapshot;
+			Snapshot_Take(Snapshot);
+			SnapshotFile::Save(FilePath, Snapshot);
+		});
+}
+
+void FThread::ThreadRequest_QuickSave(uint32_t Slot)
+{
+	if (Slot >= StateSlots.size())
+	{
+		return;
+	}
+
+	Thread_AtInstructionBoundary(
+		[=, this]() -> void
+		{
+			// a failed save keeps the slot and its file
+			std::vector<uint8_t> Buffer;
+			if (!State_Save(Buffer))
+			{
+				return;
+			}
+			StateSlots[Slot] = Buffer;
+			SaveStateFile::Save(FAppFramework::GetPath(EPathType::Export) / std::format("QuickSave_{}.zxs", Slot), Buffer);
+		});
+}
+
+void FThread::ThreadRequest_QuickLoad(uint32_t Slot)
+{
+	if (Slot >= StateSlots.size())
+	{
+		return;
+	}
+
+	// the slots saved by the previous sessions are on the disk
+	std::vector<uint8_t>& Buffer = StateSlots[Slot];
+	if (Buffer.empty())
+	{
+		const std::filesystem::path FilePath = FAppFramework::GetPath(EPathType::Export) / std::format("QuickSave_{}.zxs", Slot);
+		std::error_code ec;
+		if (!std::filesystem::exists(FilePath, ec) || !SaveStateFile::Load(FilePath, Buffer))
+		{
+			Buffer.clear();
+			LOG("SaveState: the slot {} is empty", Slot);
+			return;
+		}
+	}
+
+	Thread_AtInstructionBoundary(
+		[=, this]() -> void
+		{
+			State_Load(StateSlots[Slot]);
+		});
+}
+
+void FThread::ThreadRequest_SaveState(std::filesystem::path FilePath)
+{
+	Thread_AtInstructionBoundary(
+		[=, this]() -> void
+		{
+			std::vector<uint8_t> Buffer;
+			if (State_Save(Buffer))
+			{
+				SaveStateFile::Save(FilePath, Buffer);
+			}
+		});
+}
+
+void FThread::ThreadRequest_LoadState(std::filesystem::path FilePath)
+{
+	std::shared_ptr<std::vector<uint8_t>> Buffer = std::make_shared<std::vector<uint8_t>>();
+	if (!SaveStateFile::Load(FilePath, *Buffer))
+	{
+		return;
+	}
+
+	Thread_AtInstructionBoundary(
+		[=, this]() -> void
+		{
+			State_Load(*Buffer);
+		});
+}
+
+void FThread::ThreadRequest_InputKey(EZXKey::Type Key, bool bPressed)
+{
+	FKeyboard* Keyboard = GetDevice<FKeyboard>();
+	if (Keyboard == nullptr)
+	{
+		LOG_ERROR("[{}]\t failed to find device.", (__FUNCTION__));
+		return;
+	}
+	Keyboard->Input(Key, bPressed);
+}
+
+void FThread::ThreadRequest_StartInputRecording(std::filesystem::path FilePath)
+{
+	if (GetDevice<FKeyboard>() == nullptr)
+	{
+		LOG_ERROR("[{}]\t failed to find device.", (__FUNCTION__));
+		return;
+	}
+
+	Thread_AtInstructionBoundary(
+		[=, this]() -> void
+		{
+			Input_StopRecording();
+			Input_StopReplay();
+
+			// the recording goes on from the loaded state as the replay will, what the state doesn't keep is alike for both
+			std::vector<uint8_t> Buffer;
+			if (!State_Save(Buffer) || !State_Load(Buffer))
+			{
+				LOG_ERROR("[{}]\t failed to save the state of the recording.", (__FUNCTION__));
+				return;
+			}
+			GetDevice<FKeyboard>()->StartRecording();
+			InputLog.StartRecording(FilePath, std::move(Buffer));
+		});
+}
+
+void FThread::ThreadRequest_StopInputRecording()
+{
+	// after the start, which might wait for the boundary too
+	Thread_AtInstructionBoundary(
+		[this]() -> void
+		{
+			Input_StopRecording();
+		});
+}
+
+void FThread::ThreadRequest_StartInputReplay(std::filesystem::path FilePath, std::filesystem::path HashPath)
+{
+	if (GetDevice<FKeyboard>() == nullptr)
+	{
+		LOG_ERROR("[{}]\t failed to find device.", (__FUNCTION__));
+		return;
+	}
+
+	std::shared_ptr<std::vector<uint8_t>> Buffer = std::make_shared<std::vector<uint8_t>>();
+	std::shared_ptr<std::vector<FInputEvent>> Events = std::make_shared<std::vector<FInputEvent>>();
+	uint64_t EndClock = 0;
+	if (!FInputLog::Load(FilePath, *Buffer, *Events, EndClock))
+	{
+		return;
+	}
+
+	// replaying from the request on, the frames are hashed once the state is loaded
+	Input_StopRecording();
+	Input_StopReplay();
+	InputLog.StartReplay(FilePath, HashPath);
+	Thread_AtInstructionBoundary(
+		[=, this]() -> void
+		{
+			if (!InputLog.IsReplaying())
+			{
+				return;
+			}
+			if (!State_Load(*Buffer))
+			{
+				LOG_ERROR("[{}]\t failed to load the state of the recording.", (__FUNCTION__));
+				Input_StopReplay();
+				return;
+			}
+			GetDevice<FKeyboard>()->StartReplay(std::move(*Events));
+			InputLog.BeginReplay(EndClock);
+		});
+}
+
+void FThread::Tape_LoadBytes()
+{
+	// the block goes to the whole address space, the memory devices take their parts back
+	FMemorySnapshot MS(CG.GetClockCounter());
+	Memory_Read(MS);
+
+	if (TapeTrap.LoadBytes(MS))
+	{
+		Memory_Write(MS);
+	}
+}
+
+void FThread::Snapshot_Apply(const FMachineSnapshot& Snapshot)
+{
+	ICPU_Z80* CPU = GetDevice<ICPU_Z80>();
+	if (CPU == nullptr)
+	{
+		LOG_ERROR("[{}]\t failed to find device.", (__FUNCTION__));
+		return;
+	}
+	CPU->SetRegisters(Snapshot.Registers);
+
+	FMemorySnapshot MS(CG.GetClockCounter());
+	Memory_Read(MS);
+
+	std::vector<uint8_t> AddressSpace;
+	Memory::ToAddressSpace(MS, AddressSpace);
+	std::ranges::copy(Snapshot.RAM, AddressSpace.begin() + Snapshot::RAMAddress);
+	Memory::ToSnapshot(MS, AddressSpace);
+	Memory_Write(MS);
+
+	if (IDisplay* Display = GetDevice<IDisplay>())
+	{
+		Display->SetBorderColor(Snapshot.BorderColor);
+	}
+}
+
+void FThread::Snapshot_Take(FMachineSnapshot& Snapshot)
+{
+	if (const ICPU_Z80* CPU = GetDevice<ICPU_Z80>())
+	{
+		Snapshot.Registers = CPU->GetRegisters();
+	}
+
+	FMemorySnapshot MS(CG.GetClockCounter());
+	Memory_Read(MS);
+
+	std::vector<uint8_t> AddressSpace;
+	Memory::ToAddressSpace(MS, AddressSpace);
+	Snapshot.RAM.assign(AddressSpace.begin() + Snapshot::RAMAddress, AddressSpace.end());
+
+	if (const IDisplay* Display = GetDevice<IDisplay>())
+	{
+		Snapshot.BorderColor = Display->GetBorderColor();
+	}
+}
+
+bool FThread::State_Save(std::vector<uint8_t>& Buffer)
+{
+	const std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+
+	SaveStateFile::BeginFile(Buffer);
+	FSaveStateWriter Writer(Buffer);
+
+	Writer.BeginChunk(SaveState::ClockTag, 1);
+	Writer.Write(CG.GetClockCounter());
+	Writer.EndChunk();
+
+	for (const std::shared_ptr<FDevice>& Device : Devices)
+	{
+		const uint16_t Version = Device ? Device->GetStateVersion() : 0;
+		if (Version == 0)
+		{
+			continue;
+		}
+
+		Writer.BeginChunk(Device->UniqueDeviceID, Version);
+		Device->SaveState(Writer);
+		Writer.EndChunk();
+		if (!Writer.IsValid())
+		{
+			LOG_ERROR("[{}]\t failed to save the state of {}.", (__FUNCTION__), Device->GetName().ToString());
+			Buffer.clear();
+			return false;
+		}
+	}
+
+	const std::chrono::duration<double, std::milli> ElapsedTime = std::chrono::steady_clock::now() - StartTime;
+	LOG_CATEGORY(Emulation, Log, "SaveState: {} bytes saved in {:0.2f} ms", Buffer.size(), ElapsedTime.count());
+	return true;
+}
+
+bool FThread::State_Load(const std::vector<uint8_t>& Buffer)
+{
+	const std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+
+	if (!SaveStateFile::Parse(Buffer, StateChunks))
+	{
+		return false;
+	}
+
+	// the chunks of the devices with the same ID go in the order of the devices
+	std::vector<bool> UsedChunks(StateChunks.size(), false);
+	const auto TakeChunk = [&](uint32_t Tag) -> const FSaveStateChunk*
+		{
+			for (size_t Index = 0; Index < StateChunks.size(); ++Index)
+			{
+				if (!UsedChunks[Index] && StateChunks[Index].Tag == Tag)
+				{
+					UsedChunks[Index] = true;
+					return &StateChunks[Index];
+				}
+			}
+			return nullptr;
+		};
+
+	// every chunk is decoded before any is applied, a damaged or newer one leaves the machine as it was
+	std::optional<uint64_t> ClockCounter;
+	if (const FSaveStateChunk* Chunk = TakeChunk(SaveState::ClockTag))
+	{
+		FSaveStateReader Reader(*Chunk);
+		uint64_t Value = 0;
+		if (Reader.Read(Value))
+		{
+			ClockCounter = Value;
+		}
+	}
+
+	std::vector<std::function<void()>> Applies;
+	for (std::shared_ptr<FDevice>& Device : Devices)
+	{
+		const uint16_t Version = Device ? Device->GetStateVersion() : 0;
+		if (Version == 0)
+		{
+			continue;
+		}
+
+		const FSaveStateChunk* Chunk = TakeChunk(Device->UniqueDeviceID);
+		if (Chunk == nullptr)
+		{
+			LOG("SaveState: no state of {}, it is kept", Device->GetName().ToString());
+			continue;
+		}
+		if (Chunk->Version > Version)
+		{
+			LOG("SaveState: the state of {} is of a newer version {}", Device->GetName().ToString(), Chunk->Version);
+			return false;
+		}
+
+		FSaveStateReader Reader(*Chunk);
+		std::function<void()> Apply = Device->LoadState(Reader, Chunk->Version);
+		if (!Apply)
+		{
+			LOG_ERROR("[{}]\t the state of {} is damaged.", (__FUNCTION__), Device->GetName().ToString());
+			return false;
+		}
+		Applies.push_back(std::move(Apply));
+	}
+
+	if (ClockCounter.has_value())
+	{
+		CG.SetClockCounter(*ClockCounter);
+	}
+	for (const std::function<void()>& Apply : Applies)
+	{
+		Apply();
+	}
+
+	// the tape might have come with another load mode
+	if (const FTape* Tape = GetDevice<FTape>())
+	{
+		ThreadRequest_SetTapeLoadMode(Tape->GetLoadMode());
+	}
+	CodeProfiler.Restart();
+	TraceRecorder.Restart();
+
+	const std::chrono::duration<double, std::milli> ElapsedTime = std::chrono::steady_clock::now() - StartTime;
+	LOG_CATEGORY(Emulation, Log, "SaveState: {} bytes loaded in {:0.2f} ms", Buffer.size(), ElapsedTime.count());
+	return true;
+}
+
+void FThread::Memory_Read(FMemorySnapshot& MS)
+{
+	for (const std::shared_ptr<FDevice>& Device : Device_GetByType(EDeviceType::Memory))
+	{
+		if (std::shared_ptr<IMemory> Memory = std::dynamic_pointer_cast<IMemory>(Device))
+		{
+			Memory->Snapshot(MS, EMemoryOperationType::Read);
+		}
+	}
+}
+
+void FThread::Memory_Write(FMemorySnapshot& MS)
+{
+	for (const std::shared_ptr<FDevice>& Device : Device_GetByType(EDeviceType::Memory))
+	{
+		if (std::shared_ptr<IMemory> Memory = std::dynamic_pointer_cast<IMemory>(Device))
+		{
+			Memory->Snapshot(MS, EMemoryOperationType::Write);
+		}
+	}
+}
+
+bool FThread::Tape_IsAccelerated()
+{
+	const FTape* Tape = GetDevice<FTape>();
+	return Tape != nullptr && Tape->IsAccelerated();
+}
+
+void FThread::Input_StopRecording()
+{
+	if (!InputLog.IsRecording())
+	{
+		return;
+	}
+
+	FKeyboard* Keyboard = GetDevice<FKeyboard>();
+	InputLog.StopRecording(Keyboard != nullptr ? Keyboard->StopRecording() : std::vector<FInputEvent>(), CG.GetClockCounter());
+}
+
+void FThread::Input_StopReplay()
+{
+	if (!InputLog.IsReplaying())
+	{
+		return;
+	}
+
+	if (FKeyboard* Keyboard = GetDevice<FKeyboard>())
+	{
+		Keyboard->StopReplay();
+	}
+	InputLog.StopReplay();
+}
+
+void FThread::Input_ReplayFrame()
+{
+	const IDisplay* Display = GetDevice<IDisplay>();
+	if (Display == nullptr || !InputLog.Frame(CG.GetClockCounter(), Display->GetDisplayData()))
+	{
+		Input_StopReplay();
+	}
+}
+
+uint64_t FThread::GetClocksPerTState()
+{
+	// the CPU is ticked every half-cycle of its own clock, derived from the clock generator by the divider
+	const std::vector<std::shared_ptr<FDevice>> CPUs = Device_GetByType(EDeviceType::CPU);
+	return uint64_t(CG.GetSampling()) << (CPUs.empty() ? 0 : CPUs.front()->FrequencyDivider);
+}
+
 void FThread::GetState_RequestHandler(EName::Type DeviceID, const std::type_index& Type)
 {
 	switch (DeviceID)
@@ -395,6 +1215,29 @@ void FThread::GetState_RequestHandler(EName::Type DeviceID, const std::type_inde
 			{
 				return ThreadRequestResult.Push(CG.GetFrequency());
 			}
+			else if (Type == typeid(FCodeProfilerSnapshot))
+			{
+				FCodeProfilerSnapshot Snapshot;
+				CodeProfiler.Snapshot(Snapshot, GetClocksPerTState());
+				return ThreadRequestResult.Push(Snapshot);
+			}
+			else if (Type == typeid(FTraceRecorderStatus))
+			{
+				return ThreadRequestResult.Push(TraceRecorder.GetStatus());
+			}
+			else if (Type == typeid(FInputLogStatus))
+			{
+				return ThreadRequestResult.Push(InputLog.GetStatus());
+			}
+			break;
+		}
+		case NAME_Tape:
+		{
+			if (Type == typeid(FTapeStatus))
+			{
+				const FTape* Tape = GetDevice<FTape>();
+				return ThreadRequestResult.Push(Tape != nullptr ? Tape->GetStatus() : FTapeStatus());
+			}
 			break;
 		}
 		case NAME_Z80:
@@ -436,6 +1279,26 @@ void FThread::GetState_RequestHandler(EName::Type DeviceID, const std::type_inde
 		}
 		case NAME_Memory:
 		{
+			if (Type == typeid(FMemoryTrackerDelta))
+			{
+				// the whole address space is assembled from every memory device, only the changed pages leave the thread
+				FMemorySnapshot MS(CG.GetClockCounter());
+				for (std::shared_ptr<FDevice>& Device : Device_GetByType(EDeviceType::Memory))
+				{
+					if (std::shared_ptr<IMemory> Memory = std::dynamic_pointer_cast<IMemory>(Device))
+					{
+						Memory->Snapshot(MS, EMemoryOperationType::Read);
+					}
+				}
+
+				std::vector<uint8_t> AddressSpace;
+				Memory::ToAddressSpace(MS, AddressSpace);
+
+				FMemoryTrackerDelta Delta(CG.GetClockCounter());
+				MemoryTracker.TakeDelta(AddressSpace, Delta);
+				return ThreadRequestResult.Push(Delta);
+			}
+
 			FMemorySnapshot MS(CG.GetClockCounter());
 			IMemory* Memory = GetDevice<IMemory>();
 			if (Memory == nullptr)
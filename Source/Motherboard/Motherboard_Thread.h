@@ -1,14 +1,24 @@
 #pragma once
 
 #include <CoreMinimal.h>
+#include <array>
 #include "Utils/Queue.h"
 #include "Utils/Signal/Bus.h"
 #include "Core/TimerManager.h"
 #include "Motherboard_ClockGenerator.h"
+#include "Motherboard_CodeProfiler.h"
+#include "Motherboard_MemoryTracker.h"
+#include "Motherboard_TraceRecorder.h"
+#include "Motherboard_TapeTrap.h"
+#include "Motherboard_Snapshot.h"
+#include "Motherboard_SaveState.h"
+#include "Motherboard_InputLog.h"
+#include "Devices/IO/Tape.h"
 
 class FDevice;
 class FBoard;
 class FMotherboard;
+struct FMemorySnapshot;
 
 enum class EDeviceType;
 
@@ -72,6 +82,41 @@ private:
 	// input
 	void Inut_Debugger(bool bEnterDebugger);
 	void Input_Step(FCPU_StepType Type);
+	void Input_Key(EZXKey::Type Key, bool bPressed);
+
+	// input log
+	void StartInputRecording(std::filesystem::path FilePath);
+	void StopInputRecording();
+	void StartInputReplay(std::filesystem::path FilePath, std::filesystem::path HashPath);
+
+	// the frames aren't paced to real time, for the headless runs
+	void SetThrottle(bool bEnable);
+
+	// code profiler
+	void SetCodeProfiler(bool bEnable);
+	void ResetCodeProfiler();
+
+	// memory access tracking
+	void SetMemoryTracker(bool bEnable);
+
+	// execution trace
+	void StartTraceRecorder(std::filesystem::path FilePath);
+	void StopTraceRecorder();
+
+	// tape
+	void InsertTape(std::filesystem::path FilePath);
+	void TapeControl(ETapeControl::Type Control);
+	void SetTapeLoadMode(ETapeLoadMode::Type Mode);
+
+	// snapshot
+	void LoadSnapshot(std::filesystem::path FilePath);
+	void SaveSnapshot(std::filesystem::path FilePath);
+
+	// save-state
+	void QuickSave(uint32_t Slot);
+	void QuickLoad(uint32_t Slot);
+	void SaveState(std::filesystem::path FilePath);
+	void LoadState(std::filesystem::path FilePath);
 
 	void Device_Registration(const std::vector<std::shared_ptr<FDevice>>& _Devices);
 	void Device_Unregistration();
@@ -82,6 +127,8 @@ private:
 	std::any Device_ThreadRequestResult(EName::Type DeviceID, const std::type_index& Type);
 	void Thread_Execution();
 	void Thread_RequestHandling();
+	void Thread_AtInstructionBoundary(Callback&& Task);
+	void Thread_InstructionBoundary();
 
 	void ThreadRequest_SetStatus(EThreadStatus NewStatus);
 	void ThreadRequest_Step(FCPU_StepType Type);
@@ -90,6 +137,35 @@ private:
 	void ThreadRequest_Reset();
 	void ThreadRequest_NonmaskableInterrupt();
 	void ThreadRequest_LoadRawData(EName::Type DeviceID, std::filesystem::path FilePath);
+	void ThreadRequest_SetCodeProfiler(bool bEnable);
+	void ThreadRequest_SetMemoryTracker(bool bEnable);
+	void ThreadRequest_StartTraceRecorder(std::filesystem::path FilePath);
+	void ThreadRequest_StopTraceRecorder();
+	void ThreadRequest_InsertTape(std::filesystem::path FilePath);
+	void ThreadRequest_TapeControl(ETapeControl::Type Control);
+	void ThreadRequest_SetTapeLoadMode(ETapeLoadMode::Type Mode);
+	void ThreadRequest_LoadSnapshot(std::filesystem::path FilePath);
+	void ThreadRequest_SaveSnapshot(std::filesystem::path FilePath);
+	void ThreadRequest_QuickSave(uint32_t Slot);
+	void ThreadRequest_QuickLoad(uint32_t Slot);
+	void ThreadRequest_SaveState(std::filesystem::path FilePath);
+	void ThreadRequest_LoadState(std::filesystem::path FilePath);
+	void ThreadRequest_InputKey(EZXKey::Type Key, bool bPressed);
+	void ThreadRequest_StartInputRecording(std::filesystem::path FilePath);
+	void ThreadRequest_StopInputRecording();
+	void ThreadRequest_StartInputReplay(std::filesystem::path FilePath, std::filesystem::path HashPath);
+	void Tape_LoadBytes();
+	void Snapshot_Apply(const FMachineSnapshot& Snapshot);
+	void Snapshot_Take(FMachineSnapshot& Snapshot);
+	bool State_Save(std::vector<uint8_t>& Buffer);
+	bool State_Load(const std::vector<uint8_t>& Buffer);
+	void Memory_Read(FMemorySnapshot& MS);
+	void Memory_Write(FMemorySnapshot& MS);
+	bool Tape_IsAccelerated();
+	void Input_StopRecording();
+	void Input_StopReplay();
+	void Input_ReplayFrame();
+	uint64_t GetClocksPerTState();
 
 	void GetState_RequestHandler(EName::Type DeviceID, const std::type_index& Type);
 	void SetState_RequestHandler(EName::Type DeviceID, const std::type_index& Type, const std::any& Value);
@@ -158,12 +234,26 @@ private:
 
 	FName ThreadName;
 	bool bInterruptLatch;
+	bool bInstructionBoundaryLatch;
+	bool bThrottle;
 
 	FSignalsBus SB;
 	FTimerManager TM;
 	FClockGenerator CG;
+	FCodeProfiler CodeProfiler;
+	FMemoryTracker MemoryTracker;
+	FTraceRecorder TraceRecorder;
+	FTapeTrap TapeTrap;
+	FInputLog InputLog;
 	std::unordered_map<std::type_index, std::any> Container;
 
+	// the tasks wait for the end of the current instruction
+	std::vector<Callback> InstructionBoundaryTasks;
+
+	// quick-save slots, the buffers are kept to be reused
+	std::array<std::vector<uint8_t>, SaveState::SlotCount> StateSlots;
+	std::vector<FSaveStateChunk> StateChunks;
+
 	FCPU_StepType StepType;
 	std::string SerializedData;
 
@@ -0,0 +1,648 @@
+#include "Motherboard_TraceRecorder.h"
+#include "Devices/CPU/Interface_CPU_Z80.h"
+
+namespace
+{
+	enum ERecordFlags : uint8_t
+	{
+		RecordFlag_OpcodeLength	= 0x07,
+		RecordFlag_PC			= 0x08,		// the instruction isn't where the PC of the previous one pointed
+		RecordFlag_Writes		= 0x10,
+		RecordFlag_Registers	= 0x20,
+	};
+
+	// the longest record: header, clock, PC, opcode, register mask with all the registers, writes
+	static constexpr size_t MaxRecordSize = 1 + 10 + 2 + TraceRecorder::MaxOpcodeLength + 3 + ETraceRegister::MAX * 2 + 1 + TraceRecorder::MaxWrites * 3;
+
+#pragma pack(push, 1)
+	struct FTraceFileHeader
+	{
+		uint32_t Magic;
+		uint32_t Version;
+		uint64_t ClocksPerTState;
+	};
+
+	struct FTraceBlockHeader
+	{
+		uint32_t CompressedSize;
+		uint32_t RawSize;
+		uint32_t RecordCount;
+		uint32_t Reserved;
+		uint64_t FirstClock;
+		uint64_t LastClock;
+	};
+#pragma pack(pop)
+
+	void ToTraceRegisters(const FRegisters& Registers, FTraceRegisters& Output)
+	{
+		Output[ETraceRegister::PC] = *Registers.PC;
+		Output[ETraceRegister::IR] = *Registers.IR;
+		Output[ETraceRegister::IX] = *Registers.IX;
+		Output[ETraceRegister::IY] = *Registers.IY;
+		Output[ETraceRegister::SP] = *Registers.SP;
+		Output[ETraceRegister::AF] = *Registers.AF;
+		Output[ETraceRegister::HL] = *Registers.HL;
+		Output[ETraceRegister::DE] = *Registers.DE;
+		Output[ETraceRegister::BC] = *Registers.BC;
+		Output[ETraceRegister::AF_] = *Registers.AF_;
+		Output[ETraceRegister::HL_] = *Registers.HL_;
+		Output[ETraceRegister::DE_] = *Registers.DE_;
+		Output[ETraceRegister::BC_] = *Registers.BC_;
+		Output[ETraceRegister::State] = uint16_t(Registers.bIFF1) | uint16_t(Registers.bIFF2) << 1 | uint16_t(Registers.IM) << 2;
+	}
+
+	FORCEINLINE void Put8(std::vector<uint8_t>& Output, uint8_t Value)
+	{
+		Output.push_back(Value);
+	}
+
+	FORCEINLINE void Put16(std::vector<uint8_t>& Output, uint16_t Value)
+	{
+		Output.push_back(uint8_t(Value));
+		Output.push_back(uint8_t(Value >> 8));
+	}
+
+	// 7 bits per byte, the high bit marks a following byte
+	FORCEINLINE void PutVarint(std::vector<uint8_t>& Output, uint64_t Value)
+	{
+		while (Value >= 0x80)
+		{
+			Output.push_back(uint8_t(Value) | 0x80);
+			Value >>= 7;
+		}
+		Output.push_back(uint8_t(Value));
+	}
+
+	struct FInput
+	{
+		const uint8_t* Data;
+		const uint8_t* End;
+		bool bOverflow = false;
+
+		uint8_t Get8()
+		{
+			if (Data >= End)
+			{
+				bOverflow = true;
+				return 0;
+			}
+			return *Data++;
+		}
+
+		uint16_t Get16()
+		{
+			const uint16_t Low = Get8();
+			return Low | uint16_t(Get8()) << 8;
+		}
+
+		uint64_t GetVarint()
+		{
+			uint64_t Value = 0;
+			for (uint32_t Shift = 0; Shift < 64; Shift += 7)
+			{
+				const uint8_t Byte = Get8();
+				Value |= uint64_t(Byte & 0x7F) << Shift;
+				if ((Byte & 0x80) == 0)
+				{
+					break;
+				}
+			}
+			return Value;
+		}
+	};
+}
+
+FTraceRecorder::FTraceRecorder()
+	: bEnabled(false)
+	, bInstrCycleDone(false)
+	, bInstructionStarted(false)
+	, CPU(nullptr)
+	, InstructionAddress(0)
+	, InstructionStartClock(0)
+	, OpcodeLength(0)
+	, WriteCount(0)
+	, ClockOffset(0)
+	, LatestClockCounter(0)
+	, PreviousClock(0)
+	, PreviousRegisters{}
+	, Head(0)
+	, Tail(0)
+	, bWriterStop(false)
+	, bWriteFailed(false)
+	, RecordCount(0)
+	, RawBytes(0)
+	, CompressedBytes(0)
+	, Stalls(0)
+{}
+
+FTraceRecorder::~FTraceRecorder()
+{
+	Stop();
+}
+
+bool FTraceRecorder::Start(ICPU_Z80* _CPU, const std::filesystem::path& _FilePath, uint64_t ClocksPerTState)
+{
+	Stop();
+
+	std::error_code ec;
+	std::filesystem::create_directories(_FilePath.parent_path(), ec);
+
+	File.open(_FilePath, std::ios::binary | std::ios::trunc);
+	if (!File.is_open())
+	{
+		LOG_ERROR("[{}]\t Can't open file : {}", (__FUNCTION__), _FilePath.string());
+		return false;
+	}
+
+	const FTraceFileHeader Header = { TraceRecorder::Magic, TraceRecorder::Version, ClocksPerTState };
+	File.write(reinterpret_cast<const char*>(&Header), sizeof(Header));
+
+	Blocks.resize(TraceRecorder::RingSize);
+	for (FBlock& Block : Blocks)
+	{
+		Block.Data.reserve(TraceRecorder::BlockSize + MaxRecordSize);
+		Block.RecordCount = 0;
+	}
+
+	CPU = _CPU;
+	FilePath = _FilePath;
+	bInstrCycleDone = false;
+	bInstructionStarted = false;
+	ClockOffset = 0;
+	LatestClockCounter = 0;
+	RecordCount = 0;
+	RawBytes = 0;
+	CompressedBytes = 0;
+	Stalls = 0;
+
+	Head = 0;
+	Tail = 0;
+	bWriterStop = false;
+	bWriteFailed = false;
+	Writer = std::thread(&FTraceRecorder::Writer_Execution, this);
+
+	bEnabled = true;
+	LOG_CATEGORY(Emulation, Log, "Trace recording started: {}", FilePath.string());
+	return true;
+}
+
+void FTraceRecorder::Stop()
+{
+	if (!bEnabled)
+	{
+		return;
+	}
+	bEnabled = false;
+
+	if (Blocks[Head % TraceRecorder::RingSize].RecordCount > 0)
+	{
+		SubmitBlock();
+	}
+
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		bWriterStop = true;
+	}
+	WriterCondition.notify_one();
+	Writer.join();
+	File.close();
+
+	if (bWriteFailed)
+	{
+		LOG_ERROR("[{}]\t Trace recording stopped, failed to write : {}", (__FUNCTION__), FilePath.string());
+		return;
+	}
+	LOG_CATEGORY(Emulation, Log, "Trace recording stopped: {} instructions, {} bytes compressed to {}",
+		RecordCount, RawBytes, CompressedBytes.load());
+}
+
+void FTraceRecorder::Restart()
+{
+	ClockOffset += LatestClockCounter;
+	LatestClockCounter = 0;
+	bInstrCycleDone = false;
+	bInstructionStarted = false;
+}
+
+FTraceRecorderStatus FTraceRecorder::GetStatus() const
+{
+	FTraceRecorderStatus Status;
+	Status.bRecording = bEnabled;
+	Status.FilePath = FilePath;
+	Status.RecordCount = RecordCount;
+	Status.RawBytes = RawBytes;
+	Status.CompressedBytes = CompressedBytes.load(std::memory_order_relaxed);
+	Status.Stalls = Stalls;
+	Status.bWriteFailed = bWriteFailed.load(std::memory_order_relaxed);
+	return Status;
+}
+
+void FTraceRecorder::Tick(uint64_t ClockCounter)
+{
+	LatestClockCounter = ClockCounter;
+
+	// an instruction ends on the rising edge of the flag, the next one is fetched from PC
+	const bool bDone = CPU->IsInstrCycleDone();
+	if (bDone == bInstrCycleDone)
+	{
+		return;
+	}
+
+	bInstrCycleDone = bDone;
+	if (!bDone)
+	{
+		return;
+	}
+
+	const uint64_t Clock = ClockOffset + ClockCounter;
+	if (bInstructionStarted)
+	{
+		AppendRecord();
+		if (bWriteFailed.load(std::memory_order_relaxed))
+		{
+			Stop();
+			return;
+		}
+	}
+	else if (Blocks[Head % TraceRecorder::RingSize].RecordCount == 0)
+	{
+		// recording may start in the middle of an instruction, the first block begins with the registers of this boundary
+		ToTraceRegisters(CPU->GetRegisters(), PreviousRegisters);
+	}
+
+	bInstructionStarted = true;
+	InstructionAddress = *CPU->GetRegisters().PC;
+	InstructionStartClock = Clock;
+	OpcodeLength = 0;
+	WriteCount = 0;
+}
+
+void FTraceRecorder::BeginBlock(uint64_t ClockCounter)
+{
+	// the registers before the first instruction, the records of the block change them
+	FBlock& Block = Blocks[Head % TraceRecorder::RingSize];
+	Block.Data.clear();
+	Block.RecordCount = 0;
+	Block.FirstClock = ClockCounter;
+	Block.LastClock = ClockCounter;
+	for (const uint16_t Value : PreviousRegisters)
+	{
+		Put16(Block.Data, Value);
+	}
+	PreviousClock = ClockCounter;
+}
+
+void FTraceRecorder::SubmitBlock()
+{
+	RawBytes += Blocks[Head % TraceRecorder::RingSize].Data.size();
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		Head.store(Head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+	WriterCondition.notify_one();
+
+	// the next block is still waiting for the writer
+	if (Head.load(std::memory_order_relaxed) - Tail.load(std::memory_order_acquire) >= TraceRecorder::RingSize)
+	{
+		++Stalls;
+		std::unique_lock<std::mutex> Lock(Mutex);
+		FreeCondition.wait(Lock, [this]() { return Head.load(std::memory_order_relaxed) - Tail.load(std::memory_order_acquire) < TraceRecorder::RingSize; });
+	}
+	Blocks[Head % TraceRecorder::RingSize].RecordCount = 0;
+}
+
+void FTraceRecorder::AppendRecord()
+{
+	FBlock& Block = Blocks[Head % TraceRecorder::RingSize];
+	if (Block.RecordCount == 0)
+	{
+		BeginBlock(InstructionStartClock);
+	}
+
+	FTraceRegisters Registers;
+	ToTraceRegisters(CPU->GetRegisters(), Registers);
+
+	uint16_t ChangedRegisters = 0;
+	for (uint32_t Index = 0; Index < ETraceRegister::MAX; ++Index)
+	{
+		ChangedRegisters |= uint16_t(Registers[Index] != PreviousRegisters[Index]) << Index;
+	}
+
+	const bool bJump = InstructionAddress != PreviousRegisters[ETraceRegister::PC];
+	const uint8_t Header = OpcodeLength |
+		(bJump ? RecordFlag_PC : 0) |
+		(WriteCount > 0 ? RecordFlag_Writes : 0) |
+		(ChangedRegisters != 0 ? RecordFlag_Registers : 0);
+
+	std::vector<uint8_t>& Output = Block.Data;
+	Put8(Output, Header);
+	PutVarint(Output, InstructionStartClock - PreviousClock);
+	if (bJump)
+	{
+		Put16(Output, InstructionAddress);
+	}
+	Output.insert(Output.end(), Opcode_, Opcode_ + OpcodeLength);
+	if (ChangedRegisters != 0)
+	{
+		PutVarint(Output, ChangedRegisters);
+		for (uint32_t Index = 0; Index < ETraceRegister::MAX; ++Index)
+		{
+			if (ChangedRegisters & (1 << Index))
+			{
+				Put16(Output, Registers[Index]);
+			}
+		}
+	}
+	if (WriteCount > 0)
+	{
+		Put8(Output, uint8_t(WriteCount));
+		for (uint32_t Index = 0; Index < WriteCount; ++Index)
+		{
+			Put16(Output, Writes[Index].Address);
+			Put8(Output, Writes[Index].Value);
+		}
+	}
+
+	++Block.RecordCount;
+	++RecordCount;
+	Block.LastClock = InstructionStartClock;
+	PreviousClock = InstructionStartClock;
+	PreviousRegisters = Registers;
+
+	if (Output.size() >= TraceRecorder::BlockSize)
+	{
+		SubmitBlock();
+	}
+}
+
+void FTraceRecorder::Writer_Execution()
+{
+	std::vector<uint8_t> Compressed;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> Lock(Mutex);
+			WriterCondition.wait(Lock, [this]() { return Tail.load(std::memory_order_relaxed) < Head.load(std::memory_order_acquire) || bWriterStop; });
+		}
+
+		const uint64_t Position = Tail.load(std::memory_order_relaxed);
+		if (Position == Head.load(std::memory_order_acquire))
+		{
+			// nothing left and asked to stop
+			break;
+		}
+
+		// after a failure the blocks are only dropped, so the emulation never waits for a dead file
+		if (!bWriteFailed.load(std::memory_order_relaxed) &&
+			!Writer_WriteBlock(Blocks[Position % TraceRecorder::RingSize], Compressed))
+		{
+			LOG_ERROR("[{}]\t failed to write the trace : {}", (__FUNCTION__), FilePath.string());
+			bWriteFailed.store(true, std::memory_order_relaxed);
+		}
+		{
+			std::lock_guard<std::mutex> Lock(Mutex);
+			Tail.store(Position + 1, std::memory_order_release);
+		}
+		FreeCondition.notify_one();
+	}
+}
+
+bool FTraceRecorder::Writer_WriteBlock(const FBlock& Block, std::vector<uint8_t>& Compressed)
+{
+	uLongf CompressedSize = compressBound(uLong(Block.Data.size()));
+	Compressed.resize(CompressedSize);
+	if (compress2(Compressed.data(), &CompressedSize, Block.Data.data(), uLong(Block.Data.size()), Z_BEST_SPEED) != Z_OK)
+	{
+		LOG_ERROR("[{}]\t failed to compress a block of {} records", (__FUNCTION__), Block.RecordCount);
+		return false;
+	}
+
+	const FTraceBlockHeader Header =
+	{
+		uint32_t(CompressedSize),
+		uint32_t(Block.Data.size()),
+		Block.RecordCount,
+		0,
+		Block.FirstClock,
+		Block.LastClock,
+	};
+	File.write(reinterpret_cast<const char*>(&Header), sizeof(Header));
+	File.write(reinterpret_cast<const char*>(Compressed.data()), CompressedSize);
+
+	// a complete block on the disk survives a crash of the emulator
+	File.flush();
+	CompressedBytes.fetch_add(sizeof(Header) + CompressedSize, std::memory_order_relaxed);
+	return File.good();
+}
+
+FTraceReader::FTraceReader()
+	: ClocksPerTState(0)
+	, RecordCount(0)
+	, CachedBlock(INDEX_NONE)
+{}
+
+bool FTraceReader::Open(const std::filesystem::path& FilePath)
+{
+	Close();
+
+	File.open(FilePath, std::ios::binary);
+	if (!File.is_open())
+	{
+		LOG_ERROR("[{}]\t Can't open file : {}", (__FUNCTION__), FilePath.string());
+		return false;
+	}
+
+	FTraceFileHeader Header;
+	File.read(reinterpret_cast<char*>(&Header), sizeof(Header));
+	if (!File || Header.Magic != TraceRecorder::Magic || Header.Version != TraceRecorder::Version)
+	{
+		LOG_ERROR("[{}]\t Not a trace file : {}", (__FUNCTION__), FilePath.string());
+		Close();
+		return false;
+	}
+	ClocksPerTState = Header.ClocksPerTState;
+
+	std::error_code ec;
+	const uint64_t FileSize = std::filesystem::file_size(FilePath, ec);
+
+	// the block headers are read up to the first incomplete block
+	uint64_t Offset = sizeof(FTraceFileHeader);
+	while (true)
+	{
+		FTraceBlockHeader BlockHeader;
+		File.seekg(Offset);
+		if (!File.read(reinterpret_cast<char*>(&BlockHeader), sizeof(BlockHeader)))
+		{
+			break;
+		}
+
+		Offset += sizeof(BlockHeader);
+		if (Offset + BlockHeader.CompressedSize > FileSize || BlockHeader.RecordCount == 0)
+		{
+			break;
+		}
+
+		FBlockInfo& BlockInfo = BlockInfos.emplace_back();
+		BlockInfo.Offset = Offset;
+		BlockInfo.CompressedSize = BlockHeader.CompressedSize;
+		BlockInfo.RawSize = BlockHeader.RawSize;
+		BlockInfo.RecordCount = BlockHeader.RecordCount;
+		BlockInfo.FirstRecord = RecordCount;
+		BlockInfo.FirstClock = BlockHeader.FirstClock;
+		BlockInfo.LastClock = BlockHeader.LastClock;
+
+		RecordCount += BlockHeader.RecordCount;
+		Offset += BlockHeader.CompressedSize;
+	}
+	File.clear();
+	return true;
+}
+
+void FTraceReader::Close()
+{
+	File.close();
+	File.clear();
+	ClocksPerTState = 0;
+	RecordCount = 0;
+	BlockInfos.clear();
+	CachedBlock = INDEX_NONE;
+	CachedRecords.clear();
+}
+
+uint64_t FTraceReader::GetFirstClock() const
+{
+	return BlockInfos.empty() ? 0 : BlockInfos.front().FirstClock;
+}
+
+uint64_t FTraceReader::GetLastClock() const
+{
+	return BlockInfos.empty() ? 0 : BlockInfos.back().LastClock;
+}
+
+uint64_t FTraceReader::FindRecord(uint64_t ClockCounter)
+{
+	if (BlockInfos.empty())
+	{
+		return 0;
+	}
+
+	auto BlockIt = std::upper_bound(BlockInfos.begin(), BlockInfos.end(), ClockCounter,
+		[](uint64_t Clock, const FBlockInfo& BlockInfo)
+		{
+			return Clock < BlockInfo.FirstClock;
+		});
+	const size_t BlockIndex = BlockIt == BlockInfos.begin() ? 0 : size_t(BlockIt - BlockInfos.begin()) - 1;
+	if (!LoadBlock(BlockIndex))
+	{
+		return BlockInfos[BlockIndex].FirstRecord;
+	}
+
+	auto RecordIt = std::upper_bound(CachedRecords.begin(), CachedRecords.end(), ClockCounter,
+		[](uint64_t Clock, const FTraceRecord& Record)
+		{
+			return Clock < Record.ClockCounter;
+		});
+	const uint64_t Index = RecordIt == CachedRecords.begin() ? 0 : uint64_t(RecordIt - CachedRecords.begin()) - 1;
+	return BlockInfos[BlockIndex].FirstRecord + Index;
+}
+
+const FTraceRecord* FTraceReader::GetRecord(uint64_t Index)
+{
+	if (Index >= RecordCount)
+	{
+		return nullptr;
+	}
+
+	auto BlockIt = std::upper_bound(BlockInfos.begin(), BlockInfos.end(), Index,
+		[](uint64_t RecordIndex, const FBlockInfo& BlockInfo)
+		{
+			return RecordIndex < BlockInfo.FirstRecord;
+		});
+	const size_t BlockIndex = size_t(BlockIt - BlockInfos.begin()) - 1;
+	if (!LoadBlock(BlockIndex))
+	{
+		return nullptr;
+	}
+	return &CachedRecords[Index - BlockInfos[BlockIndex].FirstRecord];
+}
+
+bool FTraceReader::LoadBlock(size_t BlockIndex)
+{
+	if (CachedBlock == BlockIndex)
+	{
+		return true;
+	}
+	CachedBlock = INDEX_NONE;
+	CachedRecords.clear();
+
+	const FBlockInfo& BlockInfo = BlockInfos[BlockIndex];
+	std::vector<uint8_t> Compressed(BlockInfo.CompressedSize);
+	File.seekg(BlockInfo.Offset);
+	if (!File.read(reinterpret_cast<char*>(Compressed.data()), Compressed.size()))
+	{
+		LOG_ERROR("[{}]\t failed to read block {}", (__FUNCTION__), BlockIndex);
+		File.clear();
+		return false;
+	}
+
+	std::vector<uint8_t> Raw(BlockInfo.RawSize);
+	uLongf RawSize = uLongf(Raw.size());
+	if (uncompress(Raw.data(), &RawSize, Compressed.data(), uLong(Compressed.size())) != Z_OK || RawSize != Raw.size())
+	{
+		LOG_ERROR("[{}]\t failed to decompress block {}", (__FUNCTION__), BlockIndex);
+		return false;
+	}
+
+	FInput Input = { Raw.data(), Raw.data() + Raw.size() };
+	FTraceRegisters Registers;
+	for (uint16_t& Value : Registers)
+	{
+		Value = Input.Get16();
+	}
+
+	uint64_t Clock = BlockInfo.FirstClock;
+	CachedRecords.resize(BlockInfo.RecordCount);
+	for (FTraceRecord& Record : CachedRecords)
+	{
+		const uint8_t Header = Input.Get8();
+		Clock += Input.GetVarint();
+
+		Record.ClockCounter = Clock;
+		Record.PC = (Header & RecordFlag_PC) ? Input.Get16() : Registers[ETraceRegister::PC];
+		Record.OpcodeLength = (std::min)(uint8_t(Header & RecordFlag_OpcodeLength), uint8_t(TraceRecorder::MaxOpcodeLength));
+		for (uint8_t Index = 0; Index < Record.OpcodeLength; ++Index)
+		{
+			Record.Opcode[Index] = Input.Get8();
+		}
+
+		Record.ChangedRegisters = (Header & RecordFlag_Registers) ? uint16_t(Input.GetVarint()) : 0;
+		for (uint32_t Index = 0; Index < ETraceRegister::MAX; ++Index)
+		{
+			if (Record.ChangedRegisters & (1 << Index))
+			{
+				Registers[Index] = Input.Get16();
+			}
+		}
+		Record.Registers = Registers;
+
+		if (Header & RecordFlag_Writes)
+		{
+			Record.Writes.resize(Input.Get8());
+			for (FTraceWrite& Write : Record.Writes)
+			{
+				Write.Address = Input.Get16();
+				Write.Value = Input.Get8();
+			}
+		}
+	}
+
+	if (Input.bOverflow)
+	{
+		LOG_ERROR("[{}]\t block {} is corrupted", (__FUNCTION__), BlockIndex);
+		CachedRecords.clear();
+		return false;
+	}
+
+	CachedBlock = BlockIndex;
+	return true;
+}
@@ -0,0 +1,219 @@
+#pragma once
+
+#include <CoreMinimal.h>
+#include <array>
+#include <mutex>
+#include <condition_variable>
+
+class ICPU_Z80;
+struct FRegisters;
+
+namespace TraceRecorder
+{
+	static constexpr uint32_t Magic = 0x52545A58;				// "XZTR"
+	static constexpr uint32_t Version = 1;
+	static constexpr uint32_t BlockSize = 256 * 1024;			// uncompressed bytes of the records in a block
+	static constexpr uint32_t RingSize = 16;					// blocks waiting for the writer
+	static constexpr uint32_t MaxOpcodeLength = 4;
+	static constexpr uint32_t MaxWrites = 8;					// per instruction, the rest is dropped
+}
+
+namespace ETraceRegister
+{
+	enum Type : uint8_t
+	{
+		PC = 0,
+		IR,
+		IX,
+		IY,
+		SP,
+		AF,
+		HL,
+		DE,
+		BC,
+		AF_,
+		HL_,
+		DE_,
+		BC_,
+		State,			// IFF1, IFF2 and IM
+
+		MAX
+	};
+}
+
+using FTraceRegisters = std::array<uint16_t, ETraceRegister::MAX>;
+
+struct FTraceWrite
+{
+	uint16_t Address;
+	uint8_t Value;
+};
+
+struct FTraceRecord
+{
+	uint64_t ClockCounter;							// the start of the instruction
+	uint16_t PC;
+	uint8_t OpcodeLength;
+	uint8_t Opcode[TraceRecorder::MaxOpcodeLength];
+	uint16_t ChangedRegisters;						// bit mask of ETraceRegister
+	FTraceRegisters Registers;						// after the instruction
+	std::vector<FTraceWrite> Writes;
+};
+
+struct FTraceRecorderStatus
+{
+	bool bRecording = false;
+	std::filesystem::path FilePath;
+	uint64_t RecordCount = 0;
+	uint64_t RawBytes = 0;
+	uint64_t CompressedBytes = 0;
+	uint64_t Stalls = 0;			// the emulation waited for the writer
+	bool bWriteFailed = false;		// the file couldn't be written, the recording stopped itself
+};
+
+// binary execution trace
+//
+// every executed instruction is appended to the current block of a ring: the clock counter as a delta,
+// the PC only when it isn't the one the previous instruction left, the opcode bytes, the changed registers
+// and the memory writes reported by the CPU. a block starts with the full register set, so it can be decoded alone.
+// the full blocks are compressed with zlib and written by a background thread, the emulation thread waits
+// only if the writer falls behind by the whole ring.
+//
+// file: header, then blocks of { FTraceBlockHeader, compressed records } until the end,
+// a trace cut off by a crash is readable up to the last complete block
+class FTraceRecorder
+{
+public:
+	FTraceRecorder();
+	~FTraceRecorder();
+
+	FORCEINLINE bool IsEnabled() const { return bEnabled; }
+
+	bool Start(ICPU_Z80* _CPU, const std::filesystem::path& FilePath, uint64_t ClocksPerTState);
+	void Stop();
+	// the CPU was reset, the current instruction is dropped and the clock keeps going up in the file
+	void Restart();
+
+	FTraceRecorderStatus GetStatus() const;
+
+	// the memory cycles of the current instruction, reported by the CPU
+	FORCEINLINE void Fetch(uint8_t Opcode)
+	{
+		if (OpcodeLength < TraceRecorder::MaxOpcodeLength)
+		{
+			Opcode_[OpcodeLength++] = Opcode;
+		}
+	}
+	FORCEINLINE void Read(uint16_t Address, uint8_t Value)
+	{
+		// the operands are read right behind the opcode
+		if (OpcodeLength < TraceRecorder::MaxOpcodeLength && Address == uint16_t(InstructionAddress + OpcodeLength))
+		{
+			Opcode_[OpcodeLength++] = Value;
+		}
+	}
+	FORCEINLINE void Write(uint16_t Address, uint8_t Value)
+	{
+		if (WriteCount < TraceRecorder::MaxWrites)
+		{
+			Writes[WriteCount++] = { Address, Value };
+		}
+	}
+
+	void Tick(uint64_t ClockCounter);
+
+private:
+	struct FBlock
+	{
+		std::vector<uint8_t> Data;
+		uint32_t RecordCount;
+		uint64_t FirstClock;
+		uint64_t LastClock;
+	};
+
+	void BeginBlock(uint64_t ClockCounter);
+	void SubmitBlock();
+	void AppendRecord();
+
+	void Writer_Execution();
+	bool Writer_WriteBlock(const FBlock& Block, std::vector<uint8_t>& Compressed);
+
+	bool bEnabled;
+	bool bInstrCycleDone;
+	bool bInstructionStarted;
+	ICPU_Z80* CPU;
+
+	// the instruction in progress
+	uint16_t InstructionAddress;
+	uint64_t InstructionStartClock;
+	uint8_t OpcodeLength;
+	uint8_t Opcode_[TraceRecorder::MaxOpcodeLength];
+	uint32_t WriteCount;
+	FTraceWrite Writes[TraceRecorder::MaxWrites];
+
+	// the clock counter written to the file: the emulation clock plus what was before the latest reset
+	uint64_t ClockOffset;
+	uint64_t LatestClockCounter;
+	uint64_t PreviousClock;
+	FTraceRegisters PreviousRegisters;
+
+	// ring of blocks, the emulation thread fills Head, the writer thread empties Tail
+	std::vector<FBlock> Blocks;
+	std::atomic<uint64_t> Head;
+	std::atomic<uint64_t> Tail;
+	std::atomic<bool> bWriterStop;
+	std::atomic<bool> bWriteFailed;
+	std::mutex Mutex;
+	std::condition_variable WriterCondition;
+	std::condition_variable FreeCondition;
+	std::thread Writer;
+	std::ofstream File;
+
+	std::filesystem::path FilePath;
+	uint64_t RecordCount;
+	uint64_t RawBytes;
+	std::atomic<uint64_t> CompressedBytes;
+	uint64_t Stalls;
+};
+
+// random access to a trace file, the blocks are indexed on open and decoded on demand
+class FTraceReader
+{
+public:
+	FTraceReader();
+
+	bool Open(const std::filesystem::path& FilePath);
+	void Close();
+
+	FORCEINLINE bool IsOpen() const { return File.is_open(); }
+	FORCEINLINE uint64_t GetRecordCount() const { return RecordCount; }
+	FORCEINLINE uint64_t GetClocksPerTState() const { return ClocksPerTState; }
+	uint64_t GetFirstClock() const;
+	uint64_t GetLastClock() const;
+
+	// index of the last record started at or before the clock counter
+	uint64_t FindRecord(uint64_t ClockCounter);
+	const FTraceRecord* GetRecord(uint64_t Index);
+
+private:
+	struct FBlockInfo
+	{
+		uint64_t Offset;			// of the compressed records in the file
+		uint32_t CompressedSize;
+		uint32_t RawSize;
+		uint32_t RecordCount;
+		uint64_t FirstRecord;
+		uint64_t FirstClock;
+		uint64_t LastClock;
+	};
+
+	bool LoadBlock(size_t BlockIndex);
+
+	std::ifstream File;
+	uint64_t ClocksPerTState;
+	uint64_t RecordCount;
+	std::vector<FBlockInfo> BlockInfos;
+
+	size_t CachedBlock;
+	std::vector<FTraceRecord> CachedRecords;
+};
@@ -1038,65 +1038,92 @@ static CodeGenerator::FCandidate MakeZXColumnSameByteRegFromOffsets(const std::v
     return C;
 }
 
-bool CodeGenerator::BuildAnalysis(const std::vector<uint8_t>& Data, const std::vector<uint8_t>& DirtyMask, const FOptions& Options, FAnalysis& OutAnalysis, std::string& OutError, const FProgressInfo* Progress)
+namespace
 {
-    if (Data.size() != ZX_SCREEN_SIZE)
+    enum ERunSection
     {
-        OutError = "BuildAnalysis: data must contain exactly 6912 bytes";
-        return false;
-    }
-
-    FAnalysis Analysis;
-    Analysis.Data = Data;
-    Analysis.ScreenBaseAddress = Options.ScreenBaseAddress;
+        RunSection_Bytes = 0,
+        RunSection_Words,
+        RunSection_StackBlocks,
+        RunSection_RepeatWords,
+        RunSection_Horizontal,
+    };
 
-    if (DirtyMask.empty())
-    {
-        Analysis.Dirty.assign(ZX_SCREEN_SIZE, 1);
-    }
-    else
+    bool AnalysisCancelled(const CodeGenerator::FProgressInfo* Progress, std::string& OutError)
     {
-        if (DirtyMask.size() != ZX_SCREEN_SIZE)
+        if (!ProgressCancelled(Progress))
         {
-            OutError = "BuildAnalysis: dirtyMask must contain exactly 6912 bytes";
             return false;
         }
 
-        Analysis.Dirty = DirtyMask;
+        OutError = "BuildAnalysis: cancelled";
+        return true;
     }
 
-    Analysis.StartsAt.resize(ZX_SCREEN_SIZE);
-    Analysis.ByteFrequency.assign(256, 0);
-    Analysis.WordFrequency.assign(0x10000, 0);
+    bool SameAnalysisOptions(const CodeGenerator::FOptions& A, const CodeGenerator::FOptions& B)
+    {
+        return A.MaxStackPairsToEnumerate == B.MaxStackPairsToEnumerate &&
+            A.ScreenBaseAddress == B.ScreenBaseAddress &&
+            A.EnableByteCandidates == B.EnableByteCandidates &&
+            A.EnableWordCandidates == B.EnableWordCandidates &&
+            A.EnableStackBlocks == B.EnableStackBlocks &&
+            A.EnableRepeatWords == B.EnableRepeatWords &&
+            A.EnableHorizontalSameByteIncL == B.EnableHorizontalSameByteIncL &&
+            A.EnableVerticalCandidates == B.EnableVerticalCandidates &&
+            A.EnableReverseDirections == B.EnableReverseDirections &&
+            A.EnableRegisterConstants == B.EnableRegisterConstants;
+    }
 
-    ProgressSet(Progress, 0, 100);
-    if (ProgressCancelled(Progress))
+    bool SamePreferredRegisters(const CodeGenerator::FAnalysis& A, const CodeGenerator::FAnalysis& B)
     {
-        OutError = "BuildAnalysis: cancelled";
-        return false;
+        return A.bHasPreferredBC == B.bHasPreferredBC &&
+            A.bHasPreferredDE == B.bHasPreferredDE &&
+            (!A.bHasPreferredBC || (A.PreferredB == B.PreferredB && A.PreferredC == B.PreferredC)) &&
+            (!A.bHasPreferredDE || (A.PreferredD == B.PreferredD && A.PreferredE == B.PreferredE));
     }
 
-    for (int32_t Offset = 0; Offset < ZX_SCREEN_SIZE; ++Offset)
+    uint64_t HashAnalysisInput(const std::vector<uint8_t>& Data, const std::vector<uint8_t>& Dirty)
     {
-        if (Analysis.Dirty[Offset])
+        // FNV-1a
+        uint64_t Hash = 0xCBF29CE484222325ull;
+        for (int32_t Offset = 0; Offset < CodeGenerator::ZX_SCREEN_SIZE; ++Offset)
         {
-            ++Analysis.ByteFrequency[Data[Offset]];
+            Hash = (Hash ^ Data[Offset]) * 0x100000001B3ull;
+            Hash = (Hash ^ (Dirty[Offset] ? 1 : 0)) * 0x100000001B3ull;
         }
+        return Hash;
+    }
 
-        if (Offset + 1 < ZX_SCREEN_SIZE && RangeIsDirty(Analysis.Dirty, Offset, Offset + 2))
+    void AddByteFrequencyAt(std::vector<int32_t>& ByteFrequency, const std::vector<uint8_t>& Data, const std::vector<uint8_t>& Dirty, int32_t Offset, int32_t Delta)
+    {
+        if (Dirty[Offset])
         {
-            ++Analysis.WordFrequency[ReadWordLE(Data, Offset)];
+            ByteFrequency[Data[Offset]] += Delta;
         }
+    }
 
-        if ((Offset & 0x3FF) == 0 && ProgressCancelled(Progress))
+    void AddWordFrequencyAt(std::vector<int32_t>& WordFrequency, const std::vector<uint8_t>& Data, const std::vector<uint8_t>& Dirty, int32_t Offset, int32_t Delta)
+    {
+        if (Offset >= 0 && Offset + 1 < CodeGenerator::ZX_SCREEN_SIZE && CodeGenerator::RangeIsDirty(Dirty, Offset, Offset + 2))
         {
-            OutError = "BuildAnalysis: cancelled";
-            return false;
+            WordFrequency[CodeGenerator::ReadWordLE(Data, Offset)] += Delta;
         }
     }
 
-    if (Options.EnableRegisterConstants)
+    void SelectPreferredRegisters(CodeGenerator::FAnalysis& Analysis, const CodeGenerator::FOptions& Options)
     {
+        Analysis.bHasPreferredBC = false;
+        Analysis.PreferredB = 0;
+        Analysis.PreferredC = 0;
+        Analysis.bHasPreferredDE = false;
+        Analysis.PreferredD = 0;
+        Analysis.PreferredE = 0;
+
+        if (!Options.EnableRegisterConstants)
+        {
+            return;
+        }
+
         int32_t BestValues[4] = { INDEX_NONE, INDEX_NONE, INDEX_NONE, INDEX_NONE };
         for (int32_t Value = 0; Value < 256; ++Value)
         {
@@ -1144,445 +1171,727 @@ bool CodeGenerator::BuildAnalysis(const std::vector<uint8_t>& Data, const std::v
         }
     }
 
-    ProgressSet(Progress, 10, 100);
-    if (ProgressCancelled(Progress))
-    {
-        OutError = "BuildAnalysis: cancelled";
-        return false;
-    }
-
     // ------------------------------------------------------------
-    // 1. Одиночные байты.
+    // Кандидаты непрерывного Dirty-участка [RangeStart, RangeEnd).
+    // Все линейные кандидаты зависят только от данных и границ своего участка,
+    // поэтому участок с теми же границами и данными можно взять из кэша целиком.
     // ------------------------------------------------------------
-    for (int32_t i = 0; i < ZX_SCREEN_SIZE; ++i)
+    void GenerateRunCandidates(const CodeGenerator::FAnalysis& Analysis, const CodeGenerator::FOptions& Options, CodeGenerator::FAnalysisRunBucket& Bucket)
     {
-        if (!Analysis.Dirty[i])
-        {
-            continue;
-        }
-
-        if (Options.EnableByteCandidates)
-        {
-            AddCandidate(Analysis, MakeByteAbsA(Data, i));
-            AddCandidate(Analysis, MakeByteHLImm(Data, i));
-        }
-
-        if ((i & 0x1FF) == 0 && ProgressCancelled(Progress))
-        {
-            OutError = "BuildAnalysis: cancelled";
-            return false;
-        }
-    }
+        using namespace CodeGenerator;
 
-    ProgressSet(Progress, 25, 100);
+        const std::vector<uint8_t>& Data = Analysis.Data;
+        const int32_t RangeStart = Bucket.Start;
+        const int32_t RangeEnd = Bucket.End;
+        const int32_t RangeLength = RangeEnd - RangeStart;
 
-    // ------------------------------------------------------------
-    // 2. Обычные 2 байта через LD HL, Word / LD (nn), HL.
-    // ------------------------------------------------------------
-    for (int32_t i = 0; i + 1 < ZX_SCREEN_SIZE; ++i)
-    {
-        if (!RangeIsDirty(Analysis.Dirty, i, i + 2))
+        // 1. Одиночные байты.
+        if (Options.EnableByteCandidates)
         {
-            continue;
+            for (int32_t i = RangeStart; i < RangeEnd; ++i)
+            {
+                Bucket.Sections[RunSection_Bytes].push_back(MakeByteAbsA(Data, i));
+                Bucket.Sections[RunSection_Bytes].push_back(MakeByteHLImm(Data, i));
+            }
         }
 
+        // 2. Обычные 2 байта через LD HL, Word / LD (nn), HL.
         if (Options.EnableWordCandidates)
         {
-            AddCandidate(Analysis, MakeWordAbsHL(Data, i));
+            for (int32_t i = RangeStart; i + 1 < RangeEnd; ++i)
+            {
+                Bucket.Sections[RunSection_Words].push_back(MakeWordAbsHL(Data, i));
+            }
         }
 
-        if ((i & 0x1FF) == 0 && ProgressCancelled(Progress))
+        // 3. Stack-блоки внутри непрерывного Dirty-участка.
+        if (Options.EnableStackBlocks && RangeLength >= 4)
         {
-            OutError = "BuildAnalysis: cancelled";
-            return false;
-        }
-    }
+            for (int32_t Start = RangeStart; Start < RangeEnd; ++Start)
+            {
+                const int32_t Available = RangeEnd - Start;
+                const int32_t MaxPairs = min(Options.MaxStackPairsToEnumerate, Available / 2);
 
-    ProgressSet(Progress, 40, 100);
+                // Стек имеет смысл примерно с 2 PUSH, то есть с 4 байт.
+                for (int32_t Pairs = 2; Pairs <= MaxPairs; ++Pairs)
+                {
+                    Bucket.Sections[RunSection_StackBlocks].push_back(MakeStackBlock(Data, Start, Pairs * 2));
+                }
+            }
 
-    // ------------------------------------------------------------
-    // 3. Stack-блоки внутри непрерывных Dirty-участков.
-    // ------------------------------------------------------------
-    int32_t i = 0;
-    while (i < ZX_SCREEN_SIZE)
-    {
-        while (i < ZX_SCREEN_SIZE && !Analysis.Dirty[i])
-        {
-            ++i;
+            // Большой блок на весь непрерывный участок.
+            if ((RangeLength & 1) == 0 && RangeLength / 2 > Options.MaxStackPairsToEnumerate)
+            {
+                Bucket.Sections[RunSection_StackBlocks].push_back(MakeStackBlock(Data, RangeStart, RangeLength));
+            }
         }
 
-        const int32_t RangeStart = i;
-        while (i < ZX_SCREEN_SIZE && Analysis.Dirty[i])
+        // 4. Повторяющиеся WORD подряд.
+        if (Options.EnableRepeatWords)
         {
-            ++i;
-        }
+            for (int32_t Start = RangeStart; Start + 1 < RangeEnd && Start + 3 < ZX_SCREEN_SIZE; ++Start)
+            {
+                const uint16_t Word = ReadWordLE(Data, Start);
 
-        const int32_t RangeEnd = i;
-        const int32_t RangeLength = RangeEnd - RangeStart;
+                int32_t PairCount = 1;
+                int32_t Pos = Start + 2;
+                while (Pos + 1 < RangeEnd && ReadWordLE(Data, Pos) == Word)
+                {
+                    ++PairCount;
+                    Pos += 2;
+                }
 
-        if (RangeLength < 4)
+                if (PairCount >= 2)
+                {
+                    Bucket.Sections[RunSection_RepeatWords].push_back(MakeRepeatWordAbsHL(Data, Start, PairCount));
+                    Bucket.Sections[RunSection_RepeatWords].push_back(MakeRepeatWordStack(Data, Start, PairCount));
+                }
+            }
+        }
+
+        // 5. Горизонтальные серии одинакового байта через INC L.
+        //    Нельзя пересекать границу страницы, потому что INC L не меняет H.
+        const bool bRegisterConstants = Options.EnableRegisterConstants && (Analysis.bHasPreferredBC || Analysis.bHasPreferredDE);
+        if (!Options.EnableHorizontalSameByteIncL && !bRegisterConstants)
         {
-            continue;
+            return;
         }
 
         for (int32_t Start = RangeStart; Start < RangeEnd; ++Start)
         {
-            const int32_t Available = RangeEnd - Start;
-            const int32_t MaxPairs = min(Options.MaxStackPairsToEnumerate, Available / 2);
+            const uint16_t StartAddr = AddrOf(Start);
+            const uint8_t Value = Data[Start];
 
-            // Стек имеет смысл примерно с 2 PUSH, то есть с 4 байт.
-            for (int32_t Pairs = 2; Pairs <= MaxPairs; ++Pairs)
+            int32_t Length = 1;
+            while (Start + Length < RangeEnd)
             {
-                if (Options.EnableStackBlocks)
+                const uint16_t NextAddr = AddrOf(Start + Length);
+                if ((StartAddr & 0xFF00) != (NextAddr & 0xFF00))
                 {
-                    AddCandidate(Analysis, MakeStackBlock(Data, Start, Pairs * 2));
+                    break;
                 }
 
-                if ((Pairs & 0x0F) == 0 && ProgressCancelled(Progress))
+                if (Data[Start + Length] != Value)
                 {
-                    OutError = "BuildAnalysis: cancelled";
-                    return false;
+                    break;
                 }
+
+                ++Length;
             }
-        }
 
-        // Большой блок на весь непрерывный участок.
-        if (Options.EnableStackBlocks &&
-            (RangeLength & 1) == 0 &&
-            RangeLength / 2 > Options.MaxStackPairsToEnumerate)
-        {
-            AddCandidate(Analysis, MakeStackBlock(Data, RangeStart, RangeLength));
-        }
+            if (Length < 3)
+            {
+                continue;
+            }
 
-        if (ProgressCancelled(Progress))
-        {
-            OutError = "BuildAnalysis: cancelled";
-            return false;
+            if (Options.EnableHorizontalSameByteIncL)
+            {
+                Bucket.Sections[RunSection_Horizontal].push_back(MakeHorizontalSameByteIncL(Data, Start, Length));
+                if (Options.EnableReverseDirections)
+                {
+                    Bucket.Sections[RunSection_Horizontal].push_back(MakeHorizontalSameByteDecL(Data, Start + Length - 1, Length));
+                }
+            }
+
+            if (bRegisterConstants)
+            {
+                const char RegisterName = GetPreferredRegisterNameForValue(Analysis, Value);
+                if (RegisterName != 0)
+                {
+                    Bucket.Sections[RunSection_Horizontal].push_back(MakeHorizontalSameByteRegIncL(Data, Start, Length, RegisterName));
+                    if (Options.EnableReverseDirections)
+                    {
+                        Bucket.Sections[RunSection_Horizontal].push_back(MakeHorizontalSameByteRegDecL(Data, Start + Length - 1, Length, RegisterName));
+                    }
+                }
+            }
         }
     }
 
-    ProgressSet(Progress, 55, 100);
-
     // ------------------------------------------------------------
-    // 4. Повторяющиеся WORD подряд.
+    // Вертикальные серии через INC H и повторяющиеся WORD с шагом #0100.
+    // Это отражает геометрию экрана ZX: соседние raster-строки часто лежат
+    // в адресах addr, addr+#0100, addr+#0200...
+    // Зависят только от байтов с тем же младшим байтом адреса (и следующим для WORD).
     // ------------------------------------------------------------
-    for (int32_t Start = 0; Start + 3 < ZX_SCREEN_SIZE; ++Start)
+    void GenerateStrideCandidates(const CodeGenerator::FAnalysis& Analysis, const CodeGenerator::FOptions& Options, int32_t Start, std::vector<CodeGenerator::FCandidate>& Bucket)
     {
-        if (!RangeIsDirty(Analysis.Dirty, Start, Start + 2))
+        using namespace CodeGenerator;
+
+        const std::vector<uint8_t>& Data = Analysis.Data;
+        if (!Analysis.Dirty[Start])
         {
-            continue;
+            return;
         }
 
-        const uint16_t Word = ReadWordLE(Data, Start);
-
-        int32_t PairCount = 1;
-        int32_t Pos = Start + 2;
+        int32_t Count = 1;
+        while (Start + Count * 0x0100 < ZX_SCREEN_SIZE && Analysis.Dirty[Start + Count * 0x0100])
+        {
+            ++Count;
+        }
 
-        while (Pos + 1 < ZX_SCREEN_SIZE)
+        if (Count >= 3)
         {
-            if (!RangeIsDirty(Analysis.Dirty, Pos, Pos + 2))
+            Bucket.push_back(MakeVerticalBytesIncH(Data, Start, Count));
+            if (Options.EnableReverseDirections)
             {
-                break;
+                Bucket.push_back(MakeVerticalBytesDecH(Data, Start + (Count - 1) * 0x0100, Count));
             }
 
-            if (ReadWordLE(Data, Pos) != Word)
+            const uint8_t Value = Data[Start];
+            int32_t SameCount = 1;
+            while (SameCount < Count && Data[Start + SameCount * 0x0100] == Value)
             {
-                break;
+                ++SameCount;
             }
 
-            ++PairCount;
-            Pos += 2;
+            if (SameCount >= 3)
+            {
+                Bucket.push_back(MakeVerticalSameByteIncH(Data, Start, SameCount));
+                if (Options.EnableReverseDirections)
+                {
+                    Bucket.push_back(MakeVerticalSameByteDecH(Data, Start + (SameCount - 1) * 0x0100, SameCount));
+                }
+
+                if (Options.EnableRegisterConstants && (Analysis.bHasPreferredBC || Analysis.bHasPreferredDE))
+                {
+                    const char RegisterName = GetPreferredRegisterNameForValue(Analysis, Value);
+                    if (RegisterName != 0)
+                    {
+                        Bucket.push_back(MakeVerticalSameByteRegIncH(Data, Start, SameCount, RegisterName));
+                        if (Options.EnableReverseDirections)
+                        {
+                            Bucket.push_back(MakeVerticalSameByteRegDecH(Data, Start + (SameCount - 1) * 0x0100, SameCount, RegisterName));
+                        }
+                    }
+                }
+            }
         }
 
-        if (PairCount >= 2)
+        if (Start + 1 < ZX_SCREEN_SIZE && RangeIsDirty(Analysis.Dirty, Start, Start + 2))
         {
-            if (Options.EnableRepeatWords)
+            const uint16_t Word = ReadWordLE(Data, Start);
+            int32_t WordCount = 1;
+            while (Start + WordCount * 0x0100 + 1 < ZX_SCREEN_SIZE &&
+                RangeIsDirty(Analysis.Dirty, Start + WordCount * 0x0100, Start + WordCount * 0x0100 + 2) &&
+                ReadWordLE(Data, Start + WordCount * 0x0100) == Word)
             {
-                AddCandidate(Analysis, MakeRepeatWordAbsHL(Data, Start, PairCount));
-                AddCandidate(Analysis, MakeRepeatWordStack(Data, Start, PairCount));
+                ++WordCount;
             }
-        }
 
-        if ((Start & 0x1FF) == 0 && ProgressCancelled(Progress))
-        {
-            OutError = "BuildAnalysis: cancelled";
-            return false;
+            if (WordCount >= 2)
+            {
+                Bucket.push_back(MakeVerticalRepeatWordAbsHL(Data, Start, WordCount));
+            }
         }
     }
 
-    ProgressSet(Progress, 70, 100);
-
     // ------------------------------------------------------------
-    // 5. Горизонтальные серии одинакового байта через INC L.
-    //    Нельзя пересекать границу страницы, потому что INC L не меняет H.
+    // Столбцы ZX-экрана: байт ByteX во всех 192 raster-строках.
     // ------------------------------------------------------------
-    for (int32_t Start = 0; Start < ZX_SCREEN_SIZE; ++Start)
+    void GenerateColumnCandidates(const CodeGenerator::FAnalysis& Analysis, const CodeGenerator::FOptions& Options, int32_t ByteX, std::vector<CodeGenerator::FCandidate>& Bucket)
     {
-        if (!Analysis.Dirty[Start])
-        {
-            continue;
-        }
+        using namespace CodeGenerator;
 
-        const uint16_t StartAddr = AddrOf(Start);
-        const uint8_t Value = Data[Start];
+        const std::vector<uint8_t>& Data = Analysis.Data;
+        const bool bRegisterConstants = Options.EnableRegisterConstants && (Analysis.bHasPreferredBC || Analysis.bHasPreferredDE);
 
-        int32_t Length = 1;
-        while (Start + Length < ZX_SCREEN_SIZE)
+        int32_t Y = 0;
+        while (Y < 192)
         {
-            const uint16_t NextAddr = AddrOf(Start + Length);
-            if ((StartAddr & 0xFF00) != (NextAddr & 0xFF00))
+            while (Y < 192 && !Analysis.Dirty[ZXPixelOffsetFromByteXY(ByteX, Y)])
             {
-                break;
+                ++Y;
             }
 
-            if (!Analysis.Dirty[Start + Length])
+            const int32_t StartY = Y;
+            while (Y < 192 && Analysis.Dirty[ZXPixelOffsetFromByteXY(ByteX, Y)])
             {
-                break;
+                ++Y;
             }
 
-            if (Data[Start + Length] != Value)
+            const int32_t Count = Y - StartY;
+            if (Count < 3)
             {
-                break;
+                continue;
             }
 
-            ++Length;
-        }
+            Bucket.push_back(MakeZXColumnBytes(Data, ByteX, StartY, Count));
 
-        if (Length >= 3)
-        {
-            if (Options.EnableHorizontalSameByteIncL)
+            for (int32_t SameStartY = StartY; SameStartY < StartY + Count; ++SameStartY)
             {
-                AddCandidate(Analysis, MakeHorizontalSameByteIncL(Data, Start, Length));
-                if (Options.EnableReverseDirections)
+                const uint8_t Value = Data[ZXPixelOffsetFromByteXY(ByteX, SameStartY)];
+                int32_t SameCount = 1;
+                while (SameStartY + SameCount < StartY + Count &&
+                    Data[ZXPixelOffsetFromByteXY(ByteX, SameStartY + SameCount)] == Value)
                 {
-                    AddCandidate(Analysis, MakeHorizontalSameByteDecL(Data, Start + Length - 1, Length));
+                    ++SameCount;
                 }
-            }
 
-            if (Options.EnableRegisterConstants && (Analysis.bHasPreferredBC || Analysis.bHasPreferredDE))
-            {
-                const char RegisterName = GetPreferredRegisterNameForValue(Analysis, Value);
-                if (RegisterName != 0)
+                if (SameCount >= 3)
                 {
-                    AddCandidate(Analysis, MakeHorizontalSameByteRegIncL(Data, Start, Length, RegisterName));
-                    if (Options.EnableReverseDirections)
+                    Bucket.push_back(MakeZXColumnSameByte(Data, ByteX, SameStartY, SameCount));
+
+                    if (bRegisterConstants)
                     {
-                        AddCandidate(Analysis, MakeHorizontalSameByteRegDecL(Data, Start + Length - 1, Length, RegisterName));
+                        const char RegisterName = GetPreferredRegisterNameForValue(Analysis, Value);
+                        if (RegisterName != 0)
+                        {
+                            Bucket.push_back(MakeZXColumnSameByteReg(Data, ByteX, SameStartY, SameCount, RegisterName));
+                        }
                     }
                 }
+
+                SameStartY += max(0, SameCount - 1);
             }
         }
 
-        if ((Start & 0x3FF) == 0 && ProgressCancelled(Progress))
+        static constexpr int32_t MaxSparseZXColumnCount = 12;
+        std::vector<int32_t> DirtyYs;
+        std::vector<int32_t> DirtyOffsets;
+        DirtyYs.reserve(192);
+        DirtyOffsets.reserve(192);
+        for (int32_t SparseY = 0; SparseY < 192; ++SparseY)
         {
-            OutError = "BuildAnalysis: cancelled";
-            return false;
+            const int32_t Offset = ZXPixelOffsetFromByteXY(ByteX, SparseY);
+            if (Analysis.Dirty[Offset])
+            {
+                DirtyYs.push_back(SparseY);
+                DirtyOffsets.push_back(Offset);
+            }
         }
-    }
-
-    ProgressSet(Progress, 85, 100);
 
-    // ------------------------------------------------------------
-    // 6. Вертикальные серии через INC H и повторяющиеся WORD с шагом #0100.
-    //    Это отражает геометрию экрана ZX: соседние raster-строки часто лежат
-    //    в адресах addr, addr+#0100, addr+#0200...
-    // ------------------------------------------------------------
-    if (Options.EnableVerticalCandidates)
-    {
-        for (int32_t Start = 0; Start < ZX_SCREEN_SIZE; ++Start)
+        std::vector<int32_t> Offsets;
+        Offsets.reserve(MaxSparseZXColumnCount);
+        for (int32_t StartIndex = 0; StartIndex < static_cast<int32_t>(DirtyOffsets.size()); ++StartIndex)
         {
-            if (!Analysis.Dirty[Start])
-            {
-                continue;
-            }
+            Offsets.clear();
+            bool bAllSameByte = true;
+            const uint8_t FirstValue = Data[DirtyOffsets[StartIndex]];
 
-            int32_t Count = 1;
-            while (Start + Count * 0x0100 < ZX_SCREEN_SIZE && Analysis.Dirty[Start + Count * 0x0100])
+            for (int32_t EndIndex = StartIndex; EndIndex < static_cast<int32_t>(DirtyOffsets.size()) && EndIndex < StartIndex + MaxSparseZXColumnCount; ++EndIndex)
             {
-                ++Count;
-            }
+                Offsets.push_back(DirtyOffsets[EndIndex]);
+                bAllSameByte = bAllSameByte && Data[DirtyOffsets[EndIndex]] == FirstValue;
 
-            if (Count >= 3)
-            {
-                AddCandidate(Analysis, MakeVerticalBytesIncH(Data, Start, Count));
-                if (Options.EnableReverseDirections)
+                if (Offsets.size() < 3)
                 {
-                    AddCandidate(Analysis, MakeVerticalBytesDecH(Data, Start + (Count - 1) * 0x0100, Count));
+                    continue;
                 }
 
-                const uint8_t Value = Data[Start];
-                int32_t SameCount = 1;
-                while (SameCount < Count && Data[Start + SameCount * 0x0100] == Value)
+                const bool bHasVisualGap = DirtyYs[EndIndex] - DirtyYs[StartIndex] + 1 != static_cast<int32_t>(Offsets.size());
+                if (!bHasVisualGap)
                 {
-                    ++SameCount;
+                    continue;
                 }
 
-                if (SameCount >= 3)
+                const int32_t AddressLoads = CountZXColumnAddressLoads(Offsets);
+                if (AddressLoads >= static_cast<int32_t>(Offsets.size()))
                 {
-                    AddCandidate(Analysis, MakeVerticalSameByteIncH(Data, Start, SameCount));
-                    if (Options.EnableReverseDirections)
-                    {
-                        AddCandidate(Analysis, MakeVerticalSameByteDecH(Data, Start + (SameCount - 1) * 0x0100, SameCount));
-                    }
+                    continue;
+                }
+
+                Bucket.push_back(MakeZXColumnBytesFromOffsets(Data, Offsets));
+
+                if (bAllSameByte)
+                {
+                    Bucket.push_back(MakeZXColumnSameByteFromOffsets(Data, Offsets));
 
-                    if (Options.EnableRegisterConstants && (Analysis.bHasPreferredBC || Analysis.bHasPreferredDE))
+                    if (bRegisterConstants)
                     {
-                        const char RegisterName = GetPreferredRegisterNameForValue(Analysis, Value);
+                        const char RegisterName = GetPreferredRegisterNameForValue(Analysis, FirstValue);
                         if (RegisterName != 0)
                         {
-                            AddCandidate(Analysis, MakeVerticalSameByteRegIncH(Data, Start, SameCount, RegisterName));
-                            if (Options.EnableReverseDirections)
-                            {
-                                AddCandidate(Analysis, MakeVerticalSameByteRegDecH(Data, Start + (SameCount - 1) * 0x0100, SameCount, RegisterName));
-                            }
+                            Bucket.push_back(MakeZXColumnSameByteRegFromOffsets(Data, Offsets, RegisterName));
                         }
                     }
                 }
             }
+        }
+    }
+
+    void StoreAnalysisCacheEntry(CodeGenerator::FAnalysisCache& Cache, uint64_t Key, const CodeGenerator::FOptions& Options, CodeGenerator::FAnalysis&& Analysis)
+    {
+        if (Cache.MaxEntries <= 0)
+        {
+            return;
+        }
+
+        while (static_cast<int32_t>(Cache.Entries.size()) >= Cache.MaxEntries)
+        {
+            Cache.Entries.erase(Cache.Entries.begin());
+        }
+
+        CodeGenerator::FAnalysisCacheEntry& Entry = Cache.Entries.emplace_back();
+        Entry.Key = Key;
+        Entry.Options = Options;
+        Entry.Analysis = std::move(Analysis);
+    }
+
+    // прерванная сборка могла забрать часть корзин базы: база уходит в готовые результаты,
+    // следующая сборка будет полной, а не инкрементной от неполных корзин
+    bool CancelAnalysis(CodeGenerator::FAnalysisCache& Cache)
+    {
+        if (Cache.bHasBase)
+        {
+            StoreAnalysisCacheEntry(Cache, Cache.BaseKey, Cache.BaseOptions, std::move(Cache.Base));
+        }
+
+        Cache.bHasBase = false;
+        Cache.BaseKey = 0;
+        Cache.Base = CodeGenerator::FAnalysis();
+        Cache.Runs.clear();
+        Cache.StrideBuckets.clear();
+        Cache.ColumnBuckets.clear();
+        return false;
+    }
+}
+
+void CodeGenerator::FAnalysisCache::Reset()
+{
+    bHasBase = false;
+    BaseKey = 0;
+    BaseOptions = FOptions();
+    Base = FAnalysis();
+    Runs.clear();
+    StrideBuckets.clear();
+    ColumnBuckets.clear();
+    Entries.clear();
+}
+
+bool CodeGenerator::BuildAnalysis(const std::vector<uint8_t>& Data, const std::vector<uint8_t>& DirtyMask, const FOptions& Options, FAnalysis& OutAnalysis, std::string& OutError, const FProgressInfo* Progress)
+{
+    FAnalysisCache Cache;
+    Cache.MaxEntries = 0;
+    return BuildAnalysis(Data, DirtyMask, Options, Cache, OutAnalysis, OutError, Progress);
+}
+
+bool CodeGenerator::BuildAnalysis(const std::vector<uint8_t>& Data, const std::vector<uint8_t>& DirtyMask, const FOptions& Options, FAnalysisCache& Cache, FAnalysis& OutAnalysis, std::string& OutError, const FProgressInfo* Progress)
+{
+    if (Data.size() != ZX_SCREEN_SIZE)
+    {
+        OutError = "BuildAnalysis: data must contain exactly 6912 bytes";
+        return false;
+    }
+
+    FAnalysis Analysis;
+    Analysis.Data = Data;
+    Analysis.ScreenBaseAddress = Options.ScreenBaseAddress;
+
+    if (DirtyMask.empty())
+    {
+        Analysis.Dirty.assign(ZX_SCREEN_SIZE, 1);
+    }
+    else
+    {
+        if (DirtyMask.size() != ZX_SCREEN_SIZE)
+        {
+            OutError = "BuildAnalysis: dirtyMask must contain exactly 6912 bytes";
+            return false;
+        }
+
+        Analysis.Dirty = DirtyMask;
+    }
+
+    ProgressSet(Progress, 0, 100);
+    if (AnalysisCancelled(Progress, OutError))
+    {
+        return false;
+    }
+
+    // ------------------------------------------------------------
+    // 0. Тот же кадр уже анализировался: отдаём готовый результат.
+    // ------------------------------------------------------------
+    const uint64_t Key = HashAnalysisInput(Analysis.Data, Analysis.Dirty);
+    if (Cache.bHasBase && Cache.BaseKey == Key && SameAnalysisOptions(Cache.BaseOptions, Options) &&
+        Cache.Base.Data == Analysis.Data && Cache.Base.Dirty == Analysis.Dirty)
+    {
+        ++Cache.Stats.ExactHits;
+        ProgressSet(Progress, 100, 100);
+        OutAnalysis = Cache.Base;
+        return true;
+    }
+
+    for (auto It = Cache.Entries.begin(); It != Cache.Entries.end(); ++It)
+    {
+        if (It->Key != Key || !SameAnalysisOptions(It->Options, Options) ||
+            It->Analysis.Data != Analysis.Data || It->Analysis.Dirty != Analysis.Dirty)
+        {
+            continue;
+        }
 
-            if (Start + 1 < ZX_SCREEN_SIZE && RangeIsDirty(Analysis.Dirty, Start, Start + 2))
+        ++Cache.Stats.ExactHits;
+        FAnalysisCacheEntry Entry = std::move(*It);
+        Cache.Entries.erase(It);
+        OutAnalysis = Entry.Analysis;
+        Cache.Entries.push_back(std::move(Entry));
+        ProgressSet(Progress, 100, 100);
+        return true;
+    }
+
+    // ------------------------------------------------------------
+    // 1. Изменённые байты относительно предыдущего анализа.
+    // ------------------------------------------------------------
+    bool bIncremental = Cache.bHasBase && SameAnalysisOptions(Cache.BaseOptions, Options);
+    std::vector<uint8_t> Changed;
+    if (bIncremental)
+    {
+        Changed.assign(ZX_SCREEN_SIZE, 0);
+        for (int32_t Offset = 0; Offset < ZX_SCREEN_SIZE; ++Offset)
+        {
+            Changed[Offset] = Analysis.Data[Offset] != Cache.Base.Data[Offset] || Analysis.Dirty[Offset] != Cache.Base.Dirty[Offset] ? 1 : 0;
+        }
+    }
+
+    // ------------------------------------------------------------
+    // 2. Частоты байтов и слов: правим только изменённые позиции.
+    // ------------------------------------------------------------
+    Analysis.StartsAt.resize(ZX_SCREEN_SIZE);
+    if (bIncremental)
+    {
+        Analysis.ByteFrequency = Cache.Base.ByteFrequency;
+        Analysis.WordFrequency = Cache.Base.WordFrequency;
+
+        int32_t LastWordOffset = INDEX_NONE;
+        for (int32_t Offset = 0; Offset < ZX_SCREEN_SIZE; ++Offset)
+        {
+            if (!Changed[Offset])
             {
-                const uint16_t Word = ReadWordLE(Data, Start);
-                int32_t WordCount = 1;
-                while (Start + WordCount * 0x0100 + 1 < ZX_SCREEN_SIZE &&
-                    RangeIsDirty(Analysis.Dirty, Start + WordCount * 0x0100, Start + WordCount * 0x0100 + 2) &&
-                    ReadWordLE(Data, Start + WordCount * 0x0100) == Word)
-                {
-                    ++WordCount;
-                }
+                continue;
+            }
 
-                if (WordCount >= 2)
-                {
-                    AddCandidate(Analysis, MakeVerticalRepeatWordAbsHL(Data, Start, WordCount));
-                }
+            AddByteFrequencyAt(Analysis.ByteFrequency, Cache.Base.Data, Cache.Base.Dirty, Offset, -1);
+            AddByteFrequencyAt(Analysis.ByteFrequency, Analysis.Data, Analysis.Dirty, Offset, +1);
+
+            // слово с началом в Offset - 1 тоже содержит изменённый байт
+            for (int32_t WordOffset = max(Offset - 1, LastWordOffset + 1); WordOffset <= Offset; ++WordOffset)
+            {
+                AddWordFrequencyAt(Analysis.WordFrequency, Cache.Base.Data, Cache.Base.Dirty, WordOffset, -1);
+                AddWordFrequencyAt(Analysis.WordFrequency, Analysis.Data, Analysis.Dirty, WordOffset, +1);
             }
+            LastWordOffset = Offset;
+        }
+    }
+    else
+    {
+        Analysis.ByteFrequency.assign(256, 0);
+        Analysis.WordFrequency.assign(0x10000, 0);
+        for (int32_t Offset = 0; Offset < ZX_SCREEN_SIZE; ++Offset)
+        {
+            AddByteFrequencyAt(Analysis.ByteFrequency, Analysis.Data, Analysis.Dirty, Offset, +1);
+            AddWordFrequencyAt(Analysis.WordFrequency, Analysis.Data, Analysis.Dirty, Offset, +1);
 
-            if ((Start & 0x3FF) == 0 && ProgressCancelled(Progress))
+            if ((Offset & 0x3FF) == 0 && AnalysisCancelled(Progress, OutError))
             {
-                OutError = "BuildAnalysis: cancelled";
                 return false;
             }
         }
+    }
+
+    SelectPreferredRegisters(Analysis, Options);
+
+    // Кандидаты с регистрами-константами зависят от всего кадра.
+    if (bIncremental && Options.EnableRegisterConstants && !SamePreferredRegisters(Analysis, Cache.Base))
+    {
+        bIncremental = false;
+    }
+
+    ProgressSet(Progress, 10, 100);
+    if (AnalysisCancelled(Progress, OutError))
+    {
+        return false;
+    }
+
+    // ------------------------------------------------------------
+    // 3. Непрерывные Dirty-участки.
+    // ------------------------------------------------------------
+    std::vector<int32_t> ChangedPrefix;
+    if (bIncremental)
+    {
+        ChangedPrefix.assign(ZX_SCREEN_SIZE + 1, 0);
+        for (int32_t Offset = 0; Offset < ZX_SCREEN_SIZE; ++Offset)
+        {
+            ChangedPrefix[Offset + 1] = ChangedPrefix[Offset] + Changed[Offset];
+        }
+    }
+
+    std::vector<FAnalysisRunBucket> Runs;
+    size_t BaseRunIndex = 0;
+    int32_t Offset = 0;
+    while (Offset < ZX_SCREEN_SIZE)
+    {
+        while (Offset < ZX_SCREEN_SIZE && !Analysis.Dirty[Offset])
+        {
+            ++Offset;
+        }
+        if (Offset >= ZX_SCREEN_SIZE)
+        {
+            break;
+        }
+
+        FAnalysisRunBucket& Bucket = Runs.emplace_back();
+        Bucket.Start = Offset;
+        while (Offset < ZX_SCREEN_SIZE && Analysis.Dirty[Offset])
+        {
+            ++Offset;
+        }
+        Bucket.End = Offset;
+
+        if (bIncremental && ChangedPrefix[Bucket.End] == ChangedPrefix[Bucket.Start])
+        {
+            while (BaseRunIndex < Cache.Runs.size() && Cache.Runs[BaseRunIndex].Start < Bucket.Start)
+            {
+                ++BaseRunIndex;
+            }
+
+            if (BaseRunIndex < Cache.Runs.size() &&
+                Cache.Runs[BaseRunIndex].Start == Bucket.Start &&
+                Cache.Runs[BaseRunIndex].End == Bucket.End)
+            {
+                Bucket = std::move(Cache.Runs[BaseRunIndex]);
+                ++Cache.Stats.ReusedRegions;
+                continue;
+            }
+        }
+
+        GenerateRunCandidates(Analysis, Options, Bucket);
+        ++Cache.Stats.RebuiltRegions;
+
+        if (AnalysisCancelled(Progress, OutError))
+        {
+            return CancelAnalysis(Cache);
+        }
+        ProgressSet(Progress, 10 + Offset * 60 / ZX_SCREEN_SIZE, 100);
+    }
 
-        for (int32_t ByteX = 0; ByteX < 32; ++ByteX)
+    // ------------------------------------------------------------
+    // 4. Вертикальные кандидаты.
+    // ------------------------------------------------------------
+    std::vector<std::vector<FCandidate>> StrideBuckets;
+    std::vector<std::vector<FCandidate>> ColumnBuckets;
+    if (Options.EnableVerticalCandidates)
+    {
+        bool bStrideGroupChanged[256] = {};
+        bool bColumnChanged[32] = {};
+        if (bIncremental)
         {
-            int32_t Y = 0;
-            while (Y < 192)
+            for (int32_t ChangedOffset = 0; ChangedOffset < ZX_SCREEN_SIZE; ++ChangedOffset)
             {
-                while (Y < 192 && !Analysis.Dirty[ZXPixelOffsetFromByteXY(ByteX, Y)])
+                if (!Changed[ChangedOffset])
                 {
-                    ++Y;
+                    continue;
                 }
 
-                const int32_t StartY = Y;
-                while (Y < 192 && Analysis.Dirty[ZXPixelOffsetFromByteXY(ByteX, Y)])
+                bStrideGroupChanged[ChangedOffset & 0xFF] = true;
+                bStrideGroupChanged[(ChangedOffset - 1) & 0xFF] = true;
+                if (ChangedOffset < ZX_PIXEL_SIZE)
                 {
-                    ++Y;
+                    bColumnChanged[ChangedOffset & 0x1F] = true;
                 }
+            }
+        }
 
-                const int32_t Count = Y - StartY;
-                if (Count >= 3)
-                {
-                    AddCandidate(Analysis, MakeZXColumnBytes(Data, ByteX, StartY, Count));
-
-                    for (int32_t SameStartY = StartY; SameStartY < StartY + Count; ++SameStartY)
-                    {
-                        const uint8_t Value = Data[ZXPixelOffsetFromByteXY(ByteX, SameStartY)];
-                        int32_t SameCount = 1;
-                        while (SameStartY + SameCount < StartY + Count &&
-                            Data[ZXPixelOffsetFromByteXY(ByteX, SameStartY + SameCount)] == Value)
-                        {
-                            ++SameCount;
-                        }
+        StrideBuckets.resize(ZX_SCREEN_SIZE);
+        for (int32_t Start = 0; Start < ZX_SCREEN_SIZE; ++Start)
+        {
+            if (bIncremental && !bStrideGroupChanged[Start & 0xFF])
+            {
+                StrideBuckets[Start] = std::move(Cache.StrideBuckets[Start]);
+                continue;
+            }
 
-                        if (SameCount >= 3)
-                        {
-                            AddCandidate(Analysis, MakeZXColumnSameByte(Data, ByteX, SameStartY, SameCount));
-
-                            if (Options.EnableRegisterConstants && (Analysis.bHasPreferredBC || Analysis.bHasPreferredDE))
-                            {
-                                const char RegisterName = GetPreferredRegisterNameForValue(Analysis, Value);
-                                if (RegisterName != 0)
-                                {
-                                    AddCandidate(Analysis, MakeZXColumnSameByteReg(Data, ByteX, SameStartY, SameCount, RegisterName));
-                                }
-                            }
-                        }
+            GenerateStrideCandidates(Analysis, Options, Start, StrideBuckets[Start]);
 
-                        SameStartY += max(0, SameCount - 1);
-                    }
-                }
+            if ((Start & 0x3FF) == 0 && AnalysisCancelled(Progress, OutError))
+            {
+                return CancelAnalysis(Cache);
             }
+        }
 
-            static constexpr int32_t MaxSparseZXColumnCount = 12;
-            std::vector<int32_t> DirtyYs;
-            std::vector<int32_t> DirtyOffsets;
-            DirtyYs.reserve(192);
-            DirtyOffsets.reserve(192);
-            for (int32_t SparseY = 0; SparseY < 192; ++SparseY)
+        for (int32_t Group = 0; Group < 256; ++Group)
+        {
+            if (bIncremental && !bStrideGroupChanged[Group])
             {
-                const int32_t Offset = ZXPixelOffsetFromByteXY(ByteX, SparseY);
-                if (Analysis.Dirty[Offset])
-                {
-                    DirtyYs.push_back(SparseY);
-                    DirtyOffsets.push_back(Offset);
-                }
+                ++Cache.Stats.ReusedRegions;
             }
-
-            for (int32_t StartIndex = 0; StartIndex < static_cast<int32_t>(DirtyOffsets.size()); ++StartIndex)
+            else
             {
-                std::vector<int32_t> Offsets;
-                Offsets.reserve(MaxSparseZXColumnCount);
-                bool bAllSameByte = true;
-                const uint8_t FirstValue = Data[DirtyOffsets[StartIndex]];
-
-                for (int32_t EndIndex = StartIndex; EndIndex < static_cast<int32_t>(DirtyOffsets.size()) && EndIndex < StartIndex + MaxSparseZXColumnCount; ++EndIndex)
-                {
-                    Offsets.push_back(DirtyOffsets[EndIndex]);
-                    bAllSameByte = bAllSameByte && Data[DirtyOffsets[EndIndex]] == FirstValue;
-
-                    if (Offsets.size() < 3)
-                    {
-                        continue;
-                    }
-
-                    const bool bHasVisualGap = DirtyYs[EndIndex] - DirtyYs[StartIndex] + 1 != static_cast<int32_t>(Offsets.size());
-                    if (!bHasVisualGap)
-                    {
-                        continue;
-                    }
+                ++Cache.Stats.RebuiltRegions;
+            }
+        }
 
-                    const int32_t AddressLoads = CountZXColumnAddressLoads(Offsets);
-                    if (AddressLoads >= static_cast<int32_t>(Offsets.size()))
-                    {
-                        continue;
-                    }
+        ProgressSet(Progress, 85, 100);
 
-                    AddCandidate(Analysis, MakeZXColumnBytesFromOffsets(Data, Offsets));
+        ColumnBuckets.resize(32);
+        for (int32_t ByteX = 0; ByteX < 32; ++ByteX)
+        {
+            if (bIncremental && !bColumnChanged[ByteX])
+            {
+                ColumnBuckets[ByteX] = std::move(Cache.ColumnBuckets[ByteX]);
+                ++Cache.Stats.ReusedRegions;
+                continue;
+            }
 
-                    if (bAllSameByte)
-                    {
-                        AddCandidate(Analysis, MakeZXColumnSameByteFromOffsets(Data, Offsets));
+            GenerateColumnCandidates(Analysis, Options, ByteX, ColumnBuckets[ByteX]);
+            ++Cache.Stats.RebuiltRegions;
 
-                        if (Options.EnableRegisterConstants && (Analysis.bHasPreferredBC || Analysis.bHasPreferredDE))
-                        {
-                            const char RegisterName = GetPreferredRegisterNameForValue(Analysis, FirstValue);
-                            if (RegisterName != 0)
-                            {
-                                AddCandidate(Analysis, MakeZXColumnSameByteRegFromOffsets(Data, Offsets, RegisterName));
-                            }
-                        }
-                    }
-                }
+            if ((ByteX & 0x07) == 0 && AnalysisCancelled(Progress, OutError))
+            {
+                return CancelAnalysis(Cache);
             }
+        }
+    }
 
-            if ((ByteX & 0x07) == 0 && ProgressCancelled(Progress))
+    // ------------------------------------------------------------
+    // 5. Сборка кандидатов в том же порядке, что и при полном анализе,
+    //    чтобы план не зависел от того, взят ли участок из кэша.
+    // ------------------------------------------------------------
+    for (int32_t Section = 0; Section < FAnalysisRunBucket::SectionCount; ++Section)
+    {
+        for (const FAnalysisRunBucket& Bucket : Runs)
+        {
+            for (const FCandidate& Candidate : Bucket.Sections[Section])
             {
-                OutError = "BuildAnalysis: cancelled";
-                return false;
+                AddCandidate(Analysis, Candidate);
             }
         }
     }
+    for (const std::vector<FCandidate>& Bucket : StrideBuckets)
+    {
+        for (const FCandidate& Candidate : Bucket)
+        {
+            AddCandidate(Analysis, Candidate);
+        }
+    }
+    for (const std::vector<FCandidate>& Bucket : ColumnBuckets)
+    {
+        for (const FCandidate& Candidate : Bucket)
+        {
+            AddCandidate(Analysis, Candidate);
+        }
+    }
+
+    if (bIncremental)
+    {
+        ++Cache.Stats.IncrementalBuilds;
+    }
+    else
+    {
+        ++Cache.Stats.FullBuilds;
+    }
+
+    if (Cache.bHasBase)
+    {
+        StoreAnalysisCacheEntry(Cache, Cache.BaseKey, Cache.BaseOptions, std::move(Cache.Base));
+    }
+
+    Cache.bHasBase = true;
+    Cache.BaseKey = Key;
+    Cache.BaseOptions = Options;
+    Cache.Runs = std::move(Runs);
+    Cache.StrideBuckets = std::move(StrideBuckets);
+    Cache.ColumnBuckets = std::move(ColumnBuckets);
+    Cache.Base = Analysis;
 
     ProgressSet(Progress, 100, 100);
     OutAnalysis = std::move(Analysis);
@@ -1690,6 +1999,36 @@ namespace
         return Cleaned;
     }
 
+    // то же, но очищенные смещения дописываются в OutCleaned, чтобы их можно было вернуть
+    int32_t MarkCandidateClean(std::vector<uint8_t>& Dirty, const CodeGenerator::FCandidate& Candidate, std::vector<int32_t>& OutCleaned)
+    {
+        const size_t First = OutCleaned.size();
+        if (Candidate.Linear)
+        {
+            for (int32_t i = Candidate.StartOffset; i < Candidate.EndOffset; ++i)
+            {
+                if (Dirty[i])
+                {
+                    Dirty[i] = 0;
+                    OutCleaned.push_back(i);
+                }
+            }
+        }
+        else
+        {
+            for (int32_t Offset : Candidate.CoveredOffsets)
+            {
+                if (Dirty[Offset])
+                {
+                    Dirty[Offset] = 0;
+                    OutCleaned.push_back(Offset);
+                }
+            }
+        }
+
+        return static_cast<int32_t>(OutCleaned.size() - First);
+    }
+
     bool CandidateOverlaps(const CodeGenerator::FCandidate& A, const CodeGenerator::FCandidate& B)
     {
         if (A.Linear && B.Linear)
@@ -1715,6 +2054,36 @@ namespace
         return static_cast<int64_t>(Cycles) * Options.CycleWeight + static_cast<int64_t>(CodeBytes) * Options.ByteWeight;
     }
 
+    // Нижняя оценка стоимости кандидата: только сами инструкции записи и шаги INC/DEC,
+    // как если бы все регистры уже были загружены нужными значениями.
+    int64_t CandidateStoreLowerBound(const CodeGenerator::FCandidate& Candidate, const CodeGenerator::FOptions& Options)
+    {
+        using namespace CodeGenerator;
+
+        const int32_t Count = max(1, Candidate.WriteBytes);
+        const int32_t Words = max(1, Count / 2);
+        const int32_t Steps = Count - 1;
+
+        int32_t Cycles = 0;
+        int32_t CodeBytes = 0;
+        switch (Candidate.Kind)
+        {
+        case EOpKind::ByteAbsA:                 Cycles = 13;                   CodeBytes = 3;                  break;
+        case EOpKind::ByteHLImm:                Cycles = 10;                   CodeBytes = 2;                  break;
+        case EOpKind::WordAbsHL:                Cycles = 16;                   CodeBytes = 3;                  break;
+        case EOpKind::StackBlock:
+        case EOpKind::RepeatWordStack:          Cycles = 11 * Words;           CodeBytes = Words;              break;
+        case EOpKind::RepeatWordAbsHL:
+        case EOpKind::VerticalRepeatWordAbsHL:  Cycles = 16 * Words;           CodeBytes = 3 * Words;          break;
+        case EOpKind::VerticalBytesIncH:
+        case EOpKind::VerticalBytesDecH:
+        case EOpKind::ZXColumnBytes:            Cycles = 10 * Count + 4 * Steps; CodeBytes = 2 * Count + Steps; break;
+        default:                                Cycles = 7 * Count + 4 * Steps;  CodeBytes = Count + Steps;     break;
+        }
+
+        return ScorePlan(Cycles, CodeBytes, Options);
+    }
+
     bool PreferCodeBytesTieBreak(const CodeGenerator::FOptions& Options)
     {
         return Options.ByteWeight >= Options.CycleWeight;
@@ -2335,6 +2704,315 @@ bool CodeGenerator::OptimizePlan(const FAnalysis& Analysis, const FOptions& Opti
         }
     }
 
+    // ------------------------------------------------------------
+    // Точный планировщик для небольших Dirty-участков.
+    // Перебор с отсечением по границе: на каждом шаге закрывается самый младший
+    // незаписанный байт одним из кандидатов, которые его покрывают. Стоимость
+    // перехода считается через EmitCandidate, то есть с учётом A/HL/BC/DE/SP.
+    // Состояния (остаток + регистры) запоминаются, хуже уже найденного не продолжаются.
+    // Результат луча (после перестановки ByteAbsA) служит начальной верхней границей;
+    // при превышении бюджета времени остаётся лучший из найденных планов.
+    // ------------------------------------------------------------
+    if (Options.Planner == EPlanner::Exact && InitialDirty > 0 && InitialDirty <= Options.ExactPlannerMaxDirtyBytes)
+    {
+        using FClock = std::chrono::steady_clock;
+        const FClock::time_point Deadline = FClock::now() + std::chrono::milliseconds(max(1, Options.ExactPlannerTimeBudgetMs));
+
+        std::vector<int32_t> DirtyOffsets;
+        std::vector<int32_t> DirtyIndexOf(ZX_SCREEN_SIZE, INDEX_NONE);
+        DirtyOffsets.reserve(InitialDirty);
+        for (int32_t Offset = 0; Offset < ZX_SCREEN_SIZE; ++Offset)
+        {
+            if (Analysis.Dirty[Offset])
+            {
+                DirtyIndexOf[Offset] = static_cast<int32_t>(DirtyOffsets.size());
+                DirtyOffsets.push_back(Offset);
+            }
+        }
+
+        // CoveringIds[i] -> кандидаты, покрывающие i-й Dirty-байт.
+        std::vector<std::vector<int32_t>> CoveringIds(DirtyOffsets.size());
+        for (int32_t ID = 0; ID < static_cast<int32_t>(Analysis.Candidates.size()); ++ID)
+        {
+            const FCandidate& Candidate = Analysis.Candidates[ID];
+            if (!CandidateIsDirty(Analysis.Dirty, Candidate))
+            {
+                continue;
+            }
+
+            if (Candidate.Linear)
+            {
+                for (int32_t Offset = Candidate.StartOffset; Offset < Candidate.EndOffset; ++Offset)
+                {
+                    CoveringIds[DirtyIndexOf[Offset]].push_back(ID);
+                }
+            }
+            else
+            {
+                for (int32_t Offset : Candidate.CoveredOffsets)
+                {
+                    CoveringIds[DirtyIndexOf[Offset]].push_back(ID);
+                }
+            }
+        }
+
+        // Нижняя граница на байт: самая дешёвая доля записи среди покрывающих его кандидатов.
+        std::vector<int64_t> ByteBound(DirtyOffsets.size(), 0);
+        for (size_t Index = 0; Index < DirtyOffsets.size(); ++Index)
+        {
+            int64_t Bound = (std::numeric_limits<int64_t>::max)();
+            for (int32_t ID : CoveringIds[Index])
+            {
+                const FCandidate& Candidate = Analysis.Candidates[ID];
+                Bound = min(Bound, CandidateStoreLowerBound(Candidate, Options) / max(1, Candidate.WriteBytes));
+            }
+            ByteBound[Index] = CoveringIds[Index].empty() ? 0 : Bound;
+        }
+
+        auto LowerBound = [&](const FSearchState& State, int32_t FirstIndex)
+        {
+            int64_t Bound = 0;
+            for (int32_t Index = FirstIndex; Index < InitialDirty; ++Index)
+            {
+                if (State.Remaining[DirtyOffsets[Index]])
+                {
+                    Bound += ByteBound[Index];
+                }
+            }
+            return Bound;
+        };
+
+        const int32_t WordCount = (InitialDirty + 63) / 64 + 2;
+        auto MakeStateKey = [&](const FSearchState& State, std::vector<uint64_t>& OutKey)
+        {
+            OutKey.assign(WordCount, 0);
+            for (int32_t Index = 0; Index < InitialDirty; ++Index)
+            {
+                if (State.Remaining[DirtyOffsets[Index]])
+                {
+                    OutKey[Index >> 6] |= 1ull << (Index & 63);
+                }
+            }
+
+            const FEmitState& Emit = State.EmitState;
+            const uint64_t H = Emit.bHasH ? WordHigh(Emit.HL) : 0;
+            const uint64_t L = Emit.bHasL ? WordLow(Emit.HL) : 0;
+            const uint64_t B = Emit.bHasB ? WordHigh(Emit.BC) : 0;
+            const uint64_t C = Emit.bHasC ? WordLow(Emit.BC) : 0;
+            const uint64_t D = Emit.bHasD ? WordHigh(Emit.DE) : 0;
+            const uint64_t E = Emit.bHasE ? WordLow(Emit.DE) : 0;
+            OutKey[WordCount - 2] =
+                static_cast<uint64_t>(Emit.bHasA ? Emit.A : 0) |
+                (static_cast<uint64_t>(Emit.bHasA) << 8) |
+                (static_cast<uint64_t>(Emit.bHasHL) << 9) | (static_cast<uint64_t>(Emit.bHasH) << 10) | (static_cast<uint64_t>(Emit.bHasL) << 11) |
+                (static_cast<uint64_t>(Emit.bHasBC) << 12) | (static_cast<uint64_t>(Emit.bHasB) << 13) | (static_cast<uint64_t>(Emit.bHasC) << 14) |
+                (static_cast<uint64_t>(Emit.bHasDE) << 15) | (static_cast<uint64_t>(Emit.bHasD) << 16) | (static_cast<uint64_t>(Emit.bHasE) << 17) |
+                (static_cast<uint64_t>(Emit.bHasSP) << 18) | (static_cast<uint64_t>(State.UsesStack) << 19) |
+                (H << 24) | (L << 32) | (B << 40) | (C << 48);
+            OutKey[WordCount - 1] = D | (E << 8) | (static_cast<uint64_t>(Emit.bHasSP ? Emit.SP : 0) << 16);
+        };
+
+        struct FStateKeyHash
+        {
+            size_t operator()(const std::vector<uint64_t>& Key) const
+            {
+                uint64_t Hash = 0xCBF29CE484222325ull;
+                for (uint64_t Word : Key)
+                {
+                    Hash = (Hash ^ Word) * 0x100000001B3ull;
+                    Hash ^= Hash >> 29;
+                }
+                return static_cast<size_t>(Hash);
+            }
+        };
+
+        // память под Visited ограничена в байтах: ключ растёт вместе с числом Dirty-байт
+        static constexpr size_t MaxVisitedBytes = size_t(64) << 20;
+        const size_t VisitedEntryBytes = WordCount * sizeof(uint64_t) + sizeof(std::vector<uint64_t>) + sizeof(int64_t) + 4 * sizeof(void*);
+        std::unordered_map<std::vector<uint64_t>, int64_t, FStateKeyHash> Visited;
+        size_t VisitedBytes = 0;
+        std::vector<uint64_t> Key;
+
+        FSearchState Root;
+        Root.Remaining = Analysis.Dirty;
+        Root.RemainingCount = InitialDirty;
+        Root.EmitState = FEmitState();
+        Root.EmitState.ScreenBaseAddress = Analysis.ScreenBaseAddress;
+        if (Analysis.bHasPreferredBC)
+        {
+            Root.EmitState.bHasPreferredBC = true;
+            Root.EmitState.PreferredBC = static_cast<uint16_t>((Analysis.PreferredB << 8) | Analysis.PreferredC);
+        }
+        if (Analysis.bHasPreferredDE)
+        {
+            Root.EmitState.bHasPreferredDE = true;
+            Root.EmitState.PreferredDE = static_cast<uint16_t>((Analysis.PreferredD << 8) | Analysis.PreferredE);
+        }
+
+        int64_t BestScore = ScoreState(BestFinished);
+        bool bExactImproved = false;
+        bool bBudgetExceeded = false;
+        int64_t NodeCounter = 0;
+
+        // Remaining и CandidateIds у поиска одни на все глубины: шаг вниз очищает байты кандидата
+        // и добавляет его ID, возврат восстанавливает их; дети хранят только скалярную часть состояния
+        auto CopyScalars = [](const FSearchState& From, FSearchState& To)
+        {
+            To.EmitState = From.EmitState;
+            To.RemainingCount = From.RemainingCount;
+            To.Cycles = From.Cycles;
+            To.CodeBytes = From.CodeBytes;
+            To.UsesB = From.UsesB;
+            To.UsesC = From.UsesC;
+            To.UsesD = From.UsesD;
+            To.UsesE = From.UsesE;
+            To.UsesStack = From.UsesStack;
+        };
+        auto RestoreCleaned = [](std::vector<uint8_t>& Remaining, std::vector<int32_t>& Cleaned, size_t First)
+        {
+            for (size_t i = First; i < Cleaned.size(); ++i)
+            {
+                Remaining[Cleaned[i]] = 1;
+            }
+            Cleaned.resize(First);
+        };
+        std::vector<int32_t> CleanedOffsets;
+        CleanedOffsets.reserve(InitialDirty);
+
+        auto Search = [&](auto& Self, FSearchState& State, int32_t FirstIndex) -> bool
+        {
+            if ((++NodeCounter & 0xFF) == 0 && (FClock::now() >= Deadline || ProgressCancelled(Progress)))
+            {
+                bBudgetExceeded = true;
+                return false;
+            }
+
+            const int64_t Score = ScoreState(State);
+            if (State.RemainingCount == 0)
+            {
+                if (Score < BestScore || (Score == BestScore && IsBetterState(State, BestFinished)))
+                {
+                    BestScore = Score;
+                    BestFinished = State;
+                    bExactImproved = true;
+                }
+                return true;
+            }
+
+            if (Score + LowerBound(State, FirstIndex) >= BestScore)
+            {
+                return true;
+            }
+
+            MakeStateKey(State, Key);
+            auto VisitedIt = Visited.find(Key);
+            if (VisitedIt != Visited.end())
+            {
+                if (VisitedIt->second <= Score)
+                {
+                    return true;
+                }
+                VisitedIt->second = Score;
+            }
+            else if (VisitedBytes + VisitedEntryBytes <= MaxVisitedBytes)
+            {
+                Visited.emplace(Key, Score);
+                VisitedBytes += VisitedEntryBytes;
+            }
+
+            int32_t Index = FirstIndex;
+            while (!State.Remaining[DirtyOffsets[Index]])
+            {
+                ++Index;
+            }
+
+            struct FChild
+            {
+                int32_t ID;
+                int64_t Score;
+                FSearchState State;
+            };
+
+            // все оставшиеся байты не раньше Index, граница ребёнка = граница родителя - очищенные им байты
+            const int64_t Bound = LowerBound(State, Index);
+            const size_t CleanedFirst = CleanedOffsets.size();
+            std::vector<FChild> Children;
+            Children.reserve(CoveringIds[Index].size());
+            for (int32_t ID : CoveringIds[Index])
+            {
+                const FCandidate& Candidate = Analysis.Candidates[ID];
+                if (!CandidateIsDirty(State.Remaining, Candidate))
+                {
+                    continue;
+                }
+
+                FChild Child{ ID, 0, FSearchState() };
+                CopyScalars(State, Child.State);
+                std::string TransitionError;
+                if (!ApplyCandidateTransition(Child.State, Candidate, TransitionError))
+                {
+                    continue;
+                }
+
+                const int32_t Cleaned = MarkCandidateClean(State.Remaining, Candidate, CleanedOffsets);
+                int64_t CleanedBound = 0;
+                for (size_t i = CleanedFirst; i < CleanedOffsets.size(); ++i)
+                {
+                    CleanedBound += ByteBound[DirtyIndexOf[CleanedOffsets[i]]];
+                }
+                RestoreCleaned(State.Remaining, CleanedOffsets, CleanedFirst);
+
+                Child.State.RemainingCount = max(0, Child.State.RemainingCount - Cleaned);
+                Child.Score = ScoreState(Child.State) + Bound - CleanedBound;
+                if (Child.Score >= BestScore)
+                {
+                    continue;
+                }
+                Children.push_back(std::move(Child));
+            }
+
+            std::sort(Children.begin(), Children.end(),
+                [](const FChild& A, const FChild& B)
+                {
+                    if (A.Score != B.Score)
+                    {
+                        return A.Score < B.Score;
+                    }
+                    return A.ID < B.ID;
+                });
+
+            FSearchState Parent;
+            CopyScalars(State, Parent);
+            for (const FChild& Child : Children)
+            {
+                MarkCandidateClean(State.Remaining, Analysis.Candidates[Child.ID], CleanedOffsets);
+                State.CandidateIds.push_back(Child.ID);
+                CopyScalars(Child.State, State);
+
+                const bool bContinue = Self(Self, State, Index);
+
+                CopyScalars(Parent, State);
+                State.CandidateIds.pop_back();
+                RestoreCleaned(State.Remaining, CleanedOffsets, CleanedFirst);
+                if (!bContinue)
+                {
+                    return false;
+                }
+            }
+            return true;
+        };
+
+        const bool bCompleted = Search(Search, Root, 0);
+        if (ProgressCancelled(Progress))
+        {
+            OutError = "OptimizePlan: cancelled";
+            return false;
+        }
+
+        OutPlan.bExact = bCompleted && !bBudgetExceeded;
+        OutPlan.bExactImproved = bExactImproved;
+    }
+
     OutPlan.CandidateIds = std::move(BestFinished.CandidateIds);
     OutPlan.TotalCycles = BestFinished.Cycles;
     OutPlan.TotalCodeBytes = BestFinished.CodeBytes;
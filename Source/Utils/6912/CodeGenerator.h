@@ -52,6 +52,11 @@ namespace CodeGenerator
         int32_t Cycles;
         int32_t CodeBytes;
         int32_t DirtyBytes;
+        int32_t AnalysisReusedRegions;
+        int32_t AnalysisRebuiltRegions;
+        bool bAnalysisCacheHit;
+        bool bPlanExact;
+        bool bPlanExactImproved;
 
         FResult()
             : bSuccess(false)
@@ -59,6 +64,11 @@ namespace CodeGenerator
             , Cycles(0)
             , CodeBytes(0)
             , DirtyBytes(0)
+            , AnalysisReusedRegions(0)
+            , AnalysisRebuiltRegions(0)
+            , bAnalysisCacheHit(false)
+            , bPlanExact(false)
+            , bPlanExactImproved(false)
         {
         }
     };
@@ -159,6 +169,8 @@ namespace CodeGenerator
         bool UsesD;
         bool UsesE;
         bool UsesStack;
+        bool bExact;            // точный планировщик доказал минимум
+        bool bExactImproved;    // точный планировщик нашёл план лучше луча
 
         FPlan()
             : TotalCycles(0)
@@ -168,10 +180,18 @@ namespace CodeGenerator
             , UsesD(false)
             , UsesE(false)
             , UsesStack(false)
+            , bExact(false)
+            , bExactImproved(false)
         {
         }
     };
 
+    enum class EPlanner
+    {
+        Beam,   // эвристический луч, быстрый на любом объёме
+        Exact,  // перебор с отсечением для небольших участков, при превышении бюджета - луч
+    };
+
     struct FOptions
     {
         // Сколько пар максимум перебирать для STACK_BLOCK с каждого Offset.
@@ -181,6 +201,11 @@ namespace CodeGenerator
         int32_t NonLinearBeamWidth;
         int32_t MaxNonLinearCandidatesToEvaluatePerPass;
 
+        // Точный планировщик включается только если Dirty-байтов не больше ExactPlannerMaxDirtyBytes.
+        EPlanner Planner;
+        int32_t ExactPlannerMaxDirtyBytes;
+        int32_t ExactPlannerTimeBudgetMs;
+
         // Если важнее скорость:
         // CycleWeight = 1000, ByteWeight = 1
         //
@@ -225,6 +250,9 @@ namespace CodeGenerator
             : MaxStackPairsToEnumerate(16)
             , NonLinearBeamWidth(4)
             , MaxNonLinearCandidatesToEvaluatePerPass(96)
+            , Planner(EPlanner::Beam)
+            , ExactPlannerMaxDirtyBytes(512)
+            , ExactPlannerTimeBudgetMs(2000)
             , CycleWeight(1000)
             , ByteWeight(1)
             , PreserveSP(true)
@@ -257,6 +285,82 @@ namespace CodeGenerator
         }
     };
 
+    // Кандидаты одного непрерывного Dirty-участка, разложенные по этапам анализа.
+    struct FAnalysisRunBucket
+    {
+        static constexpr int32_t SectionCount = 5;
+
+        int32_t Start;
+        int32_t End;
+        std::vector<FCandidate> Sections[SectionCount];
+
+        FAnalysisRunBucket()
+            : Start(0)
+            , End(0)
+        {
+        }
+    };
+
+    struct FAnalysisCacheEntry
+    {
+        uint64_t Key;
+        FOptions Options;
+        FAnalysis Analysis;
+
+        FAnalysisCacheEntry()
+            : Key(0)
+        {
+        }
+    };
+
+    struct FAnalysisCacheStats
+    {
+        int32_t FullBuilds;
+        int32_t IncrementalBuilds;
+        int32_t ExactHits;
+        int32_t ReusedRegions;
+        int32_t RebuiltRegions;
+
+        FAnalysisCacheStats()
+            : FullBuilds(0)
+            , IncrementalBuilds(0)
+            , ExactHits(0)
+            , ReusedRegions(0)
+            , RebuiltRegions(0)
+        {
+        }
+    };
+
+    // Кэш анализа между кадрами.
+    // Полностью совпавший кадр (данные + Dirty + опции) берётся готовым из Entries.
+    // Иначе анализ строится от последнего кадра (Base): частоты правятся по изменённым байтам,
+    // а кандидаты пересчитываются только для Dirty-участков, групп #0100 и ZX-столбцов,
+    // которых коснулись изменения. Не потокобезопасен, один кэш на один поток генерации.
+    struct FAnalysisCache
+    {
+        int32_t MaxEntries;
+
+        bool bHasBase;
+        uint64_t BaseKey;
+        FOptions BaseOptions;
+        FAnalysis Base;
+        std::vector<FAnalysisRunBucket> Runs;
+        std::vector<std::vector<FCandidate>> StrideBuckets; // [Start]
+        std::vector<std::vector<FCandidate>> ColumnBuckets; // [ByteX]
+
+        std::vector<FAnalysisCacheEntry> Entries;           // oldest first
+        FAnalysisCacheStats Stats;
+
+        FAnalysisCache()
+            : MaxEntries(4)
+            , bHasBase(false)
+            , BaseKey(0)
+        {
+        }
+
+        void Reset();
+    };
+
     struct FEmitState
     {
         bool bHasA;
@@ -396,6 +500,7 @@ namespace CodeGenerator
     FCandidate MakeZXColumnSameByteReg(const std::vector<uint8_t>& Data, int32_t ByteX, int32_t StartY, int32_t Count, char RegisterName);
 
     bool BuildAnalysis(const std::vector<uint8_t>& Data, const std::vector<uint8_t>& DirtyMask, const FOptions& Options, FAnalysis& OutAnalysis, std::string& OutError, const FProgressInfo* Progress = nullptr);
+    bool BuildAnalysis(const std::vector<uint8_t>& Data, const std::vector<uint8_t>& DirtyMask, const FOptions& Options, FAnalysisCache& Cache, FAnalysis& OutAnalysis, std::string& OutError, const FProgressInfo* Progress = nullptr);
     bool OptimizePlan(const FAnalysis& Analysis, const FOptions& Options, FPlan& OutPlan, std::string& OutError, const FProgressInfo* Progress = nullptr);
 
     void EmitByte(FEmitOutput& Out, uint8_t Value);
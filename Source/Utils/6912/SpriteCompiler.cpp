@@ -0,0 +1,325 @@
+﻿#include "SpriteCompiler.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace
+{
+    using CodeGenerator::FEmitOutput;
+    using CodeGenerator::EmitByte;
+    using CodeGenerator::Hex8;
+
+    void EmitOpcode(FEmitOutput& Out, const std::string& Text, int32_t Cycles, std::initializer_list<uint8_t> Bytes)
+    {
+        Out.Preview << "                " << Text << "\n";
+        for (uint8_t Byte : Bytes)
+        {
+            EmitByte(Out, Byte);
+        }
+        Out.Cycles += Cycles;
+    }
+
+    // Горизонтальный шаг HL внутри строки экрана. Спрайт не пересекает край экрана,
+    // поэтому меняется только L.
+    void EmitMoveL(FEmitOutput& Out, int32_t Delta, const SpriteCompiler::FOptions& Options)
+    {
+        if (Delta == 0)
+        {
+            return;
+        }
+
+        if (std::abs(Delta) > max(1, Options.MaxIncLSteps))
+        {
+            const uint8_t Value = static_cast<uint8_t>(Delta);
+            EmitOpcode(Out, "LD A, L", 4, { 0x7D });
+            EmitOpcode(Out, "ADD A, " + Hex8(Value), 7, { 0xC6, Value });
+            EmitOpcode(Out, "LD L, A", 4, { 0x6F });
+            return;
+        }
+
+        for (int32_t Step = 0; Step < std::abs(Delta); ++Step)
+        {
+            if (Delta > 0)
+            {
+                EmitOpcode(Out, "INC L", 4, { 0x2C });
+            }
+            else
+            {
+                EmitOpcode(Out, "DEC L", 4, { 0x2D });
+            }
+        }
+    }
+
+    // Переход HL на следующую пиксельную строку экрана.
+    // Row - строка спрайта, с которой уходим. Такты зависят от ветки, поэтому считаются
+    // отдельно: для Y, кратного 8, и перехода между знакоместами внутри одной трети.
+    void EmitNextRow(FEmitOutput& Out, int32_t Row, const SpriteCompiler::FOptions& Options)
+    {
+        const bool bCrossesCell = (Row & 7) == 7;
+        if (Options.bCharRowAligned && !bCrossesCell)
+        {
+            EmitOpcode(Out, "INC H", 4, { 0x24 });
+            return;
+        }
+
+        EmitOpcode(Out, "INC H", 0, { 0x24 });
+        if (!Options.bCharRowAligned)
+        {
+            EmitOpcode(Out, "LD A, H", 0, { 0x7C });
+            EmitOpcode(Out, "AND #07", 0, { 0xE6, 0x07 });
+            EmitOpcode(Out, "JR NZ, $+12", 0, { 0x20, 0x0A });
+        }
+        EmitOpcode(Out, "LD A, L", 0, { 0x7D });
+        EmitOpcode(Out, "ADD A, #20", 0, { 0xC6, 0x20 });
+        EmitOpcode(Out, "LD L, A", 0, { 0x6F });
+        EmitOpcode(Out, "JR C, $+6", 0, { 0x38, 0x04 });
+        EmitOpcode(Out, "LD A, H", 0, { 0x7C });
+        EmitOpcode(Out, "SUB #08", 0, { 0xD6, 0x08 });
+        EmitOpcode(Out, "LD H, A", 0, { 0x67 });
+
+        if (Options.bCharRowAligned)
+        {
+            Out.Cycles += 41;
+        }
+        else
+        {
+            // INC H / LD A,H / AND 7 / JR NZ (выполнен) = 27, полный путь без переноса = 59.
+            Out.Cycles += bCrossesCell ? 59 : 27;
+        }
+    }
+
+    // Запись одного байта: (screen AND NOT mask) OR (ink AND mask).
+    void EmitMaskedByte(FEmitOutput& Out, uint8_t Ink, uint8_t Mask)
+    {
+        const uint8_t Or = Ink & Mask;
+        if (Mask == 0xFF)
+        {
+            EmitOpcode(Out, "LD (HL), " + Hex8(Or), 10, { 0x36, Or });
+            return;
+        }
+
+        EmitOpcode(Out, "LD A, (HL)", 7, { 0x7E });
+        if (Or != Mask)
+        {
+            const uint8_t And = static_cast<uint8_t>(~Mask);
+            EmitOpcode(Out, "AND " + Hex8(And), 7, { 0xE6, And });
+        }
+        if (Or != 0)
+        {
+            EmitOpcode(Out, "OR " + Hex8(Or), 7, { 0xF6, Or });
+        }
+        EmitOpcode(Out, "LD (HL), A", 7, { 0x77 });
+    }
+
+    void AppendTable(std::ostringstream& Preview, const std::vector<uint8_t>& Table, int32_t BytesPerLine)
+    {
+        for (size_t Index = 0; Index < Table.size(); ++Index)
+        {
+            if (Index % BytesPerLine == 0)
+            {
+                Preview << (Index == 0 ? "" : "\n") << "                DB ";
+            }
+            else
+            {
+                Preview << ", ";
+            }
+            Preview << Hex8(Table[Index]);
+        }
+        if (!Table.empty())
+        {
+            Preview << "\n";
+        }
+    }
+}
+
+void SpriteCompiler::ShiftSprite(
+    const std::vector<uint8_t>& InkData,
+    const std::vector<uint8_t>& MaskData,
+    int32_t WidthBytes, int32_t Height, int32_t Shift,
+    std::vector<uint8_t>& OutInkData,
+    std::vector<uint8_t>& OutMaskData,
+    int32_t& OutWidthBytes)
+{
+    Shift &= 7;
+    OutWidthBytes = WidthBytes + (Shift != 0 ? 1 : 0);
+    OutInkData.assign(OutWidthBytes * Height, 0);
+    OutMaskData.assign(OutWidthBytes * Height, 0);
+
+    for (int32_t y = 0; y < Height; ++y)
+    {
+        for (int32_t x = 0; x < OutWidthBytes; ++x)
+        {
+            const int32_t Source = y * WidthBytes + x;
+            const uint8_t Ink = x < WidthBytes ? InkData[Source] : 0;
+            const uint8_t Mask = x < WidthBytes ? MaskData[Source] : 0;
+            const uint8_t PrevInk = x > 0 ? InkData[Source - 1] : 0;
+            const uint8_t PrevMask = x > 0 ? MaskData[Source - 1] : 0;
+
+            const int32_t Target = y * OutWidthBytes + x;
+            OutInkData[Target] = Shift == 0 ? Ink : static_cast<uint8_t>((Ink >> Shift) | (PrevInk << (8 - Shift)));
+            OutMaskData[Target] = Shift == 0 ? Mask : static_cast<uint8_t>((Mask >> Shift) | (PrevMask << (8 - Shift)));
+        }
+    }
+}
+
+bool SpriteCompiler::CompileVariant(
+    const std::vector<uint8_t>& InkData,
+    const std::vector<uint8_t>& MaskData,
+    int32_t WidthBytes, int32_t Height,
+    const FOptions& Options,
+    const std::string& LabelName,
+    FVariant& OutVariant,
+    std::string& OutError)
+{
+    const size_t Size = static_cast<size_t>(WidthBytes) * Height;
+    if (WidthBytes <= 0 || Height <= 0 || InkData.size() < Size || MaskData.size() < Size)
+    {
+        OutError = "CompileVariant: invalid sprite data";
+        return false;
+    }
+    // Сдвинутый вариант на байт шире исходного спрайта: полноэкранный спрайт даёт 33 байта.
+    if (WidthBytes > 32 + (OutVariant.Shift != 0 ? 1 : 0))
+    {
+        OutError = "CompileVariant: sprite is wider than the screen";
+        return false;
+    }
+
+    OutVariant.WidthBytes = WidthBytes;
+    OutVariant.Height = Height;
+    OutVariant.DrawnBytes = 0;
+    OutVariant.Table.resize(Size * 2);
+    for (size_t Index = 0; Index < Size; ++Index)
+    {
+        OutVariant.Table[Index * 2 + 0] = static_cast<uint8_t>(~MaskData[Index]);
+        OutVariant.Table[Index * 2 + 1] = InkData[Index] & MaskData[Index];
+    }
+
+    FEmitOutput Out;
+    int32_t CurrentRow = 0;
+    int32_t CurrentX = 0;
+    for (int32_t y = 0; y < Height; ++y)
+    {
+        std::vector<int32_t> Columns;
+        for (int32_t x = 0; x < WidthBytes; ++x)
+        {
+            if (MaskData[y * WidthBytes + x] != 0)
+            {
+                Columns.push_back(x);
+            }
+        }
+        if (Columns.empty())
+        {
+            continue;
+        }
+
+        for (; CurrentRow < y; ++CurrentRow)
+        {
+            EmitNextRow(Out, CurrentRow, Options);
+        }
+
+        // Строку проходим с ближнего к текущему L края.
+        if (std::abs(CurrentX - Columns.back()) < std::abs(CurrentX - Columns.front()))
+        {
+            std::reverse(Columns.begin(), Columns.end());
+        }
+
+        for (int32_t x : Columns)
+        {
+            EmitMoveL(Out, x - CurrentX, Options);
+            CurrentX = x;
+
+            const int32_t Offset = y * WidthBytes + x;
+            EmitMaskedByte(Out, InkData[Offset], MaskData[Offset]);
+            ++OutVariant.DrawnBytes;
+        }
+    }
+    EmitOpcode(Out, "RET", 10, { 0xC9 });
+
+    OutVariant.Code = std::move(Out.Code);
+    OutVariant.Cycles = Out.Cycles;
+    OutVariant.CodeBytes = static_cast<int32_t>(OutVariant.Code.size());
+
+    std::ostringstream Preview;
+    Preview << "; -----------------------------------------\n";
+    Preview << "; Compiled sprite, shift " << OutVariant.Shift << "\n";
+    Preview << "; In:\n";
+    Preview << ";   HL - screen address of the top-left sprite byte\n";
+    Preview << "; Out:\n";
+    Preview << ";   Function     - " << LabelName << "\n";
+    Preview << ";   Size         - " << WidthBytes << "x" << Height << " bytes, drawn " << OutVariant.DrawnBytes << "\n";
+    Preview << ";   Cycles       - " << OutVariant.Cycles << (Options.bCharRowAligned ? "" : " (Y multiple of 8)") << "\n";
+    Preview << ";   Code size    - " << OutVariant.CodeBytes << " bytes\n";
+    Preview << ";   Data         - " << LabelName << "_Data, " << OutVariant.Table.size() << " bytes (AND mask, OR data)\n";
+    Preview << "; Corrupt:\n";
+    Preview << ";   AF, HL\n";
+    Preview << "; Note:\n";
+    Preview << ";   Row step     - " << (Options.bCharRowAligned ? "Y aligned to 8, INC H inside a char row" : "any Y") << "\n";
+    Preview << "; -----------------------------------------\n";
+    Preview << LabelName << ":\n";
+    Preview << Out.Preview.str();
+    Preview << LabelName << "_Data:\n";
+    AppendTable(Preview, OutVariant.Table, 16);
+    OutVariant.AsmCode = Preview.str();
+    return true;
+}
+
+bool SpriteCompiler::Generate(
+    const std::vector<uint8_t>& InkData,
+    const std::vector<uint8_t>& MaskData,
+    int32_t Width, int32_t Height,
+    const FOptions& Options,
+    const std::string& LabelName,
+    FResult& OutResult,
+    std::string& OutError)
+{
+    const int32_t WidthBytes = Width >> 3;
+    const size_t Size = static_cast<size_t>(WidthBytes) * max(Height, 0);
+    if (WidthBytes <= 0 || Height <= 0 || InkData.size() < Size)
+    {
+        OutError = "Generate: invalid sprite size";
+        return false;
+    }
+    if (WidthBytes > 32)
+    {
+        OutError = "Generate: sprite is wider than the screen";
+        return false;
+    }
+    if (!MaskData.empty() && MaskData.size() < Size)
+    {
+        OutError = "Generate: mask data size mismatch";
+        return false;
+    }
+
+    // Без маски непрозрачны только пиксели чернил: запись по OR.
+    const std::vector<uint8_t>& Mask = MaskData.empty() ? InkData : MaskData;
+
+    OutResult.Variants.clear();
+    OutResult.Variants.resize(SHIFT_COUNT);
+
+    std::ostringstream Preview;
+    for (int32_t Shift = 0; Shift < SHIFT_COUNT; ++Shift)
+    {
+        std::vector<uint8_t> ShiftedInk;
+        std::vector<uint8_t> ShiftedMask;
+        int32_t ShiftedWidthBytes = 0;
+        ShiftSprite(InkData, Mask, WidthBytes, Height, Shift, ShiftedInk, ShiftedMask, ShiftedWidthBytes);
+
+        FVariant& Variant = OutResult.Variants[Shift];
+        Variant.Shift = Shift;
+        if (!CompileVariant(ShiftedInk, ShiftedMask, ShiftedWidthBytes, Height, Options, LabelName + "_Shift" + std::to_string(Shift), Variant, OutError))
+        {
+            return false;
+        }
+
+        Preview << Variant.AsmCode << "\n";
+    }
+
+    Preview << "; Shift table: address of the routine for X & 7\n";
+    Preview << LabelName << "_Shifts:\n";
+    for (int32_t Shift = 0; Shift < SHIFT_COUNT; ++Shift)
+    {
+        Preview << "                DW " << LabelName << "_Shift" << Shift << "\n";
+    }
+    OutResult.AsmCode = Preview.str();
+    return true;
+}
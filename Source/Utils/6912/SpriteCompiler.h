@@ -0,0 +1,87 @@
+﻿#pragma once
+
+#include "CodeGenerator.h"
+
+namespace SpriteCompiler
+{
+    // Количество горизонтальных сдвигов внутри байта экрана.
+    static constexpr int32_t SHIFT_COUNT = 8;
+
+    struct FOptions
+    {
+        // Y спрайта всегда кратен 8: внутри знакоместа переход на следующую строку - только INC H,
+        // без проверки границы знакоместа.
+        bool bCharRowAligned;
+
+        // Горизонтальный шаг длиннее этого значения выполняется через LD A,L / ADD A,n / LD L,A.
+        int32_t MaxIncLSteps;
+
+        FOptions()
+            : bCharRowAligned(false)
+            , MaxIncLSteps(3)
+        {
+        }
+    };
+
+    struct FVariant
+    {
+        int32_t Shift;          // сдвиг вправо в пикселях 0..7
+        int32_t WidthBytes;     // ширина сдвинутого спрайта в байтах
+        int32_t Height;
+        int32_t DrawnBytes;     // байты экрана, которые меняет процедура
+        int32_t Cycles;         // такты при Y, кратном 8
+        int32_t CodeBytes;
+
+        // Таблица сдвинутых данных: построчно пары AND-маска / OR-данные.
+        std::vector<uint8_t> Table;
+        std::vector<uint8_t> Code;
+        std::string AsmCode;
+
+        FVariant()
+            : Shift(0)
+            , WidthBytes(0)
+            , Height(0)
+            , DrawnBytes(0)
+            , Cycles(0)
+            , CodeBytes(0)
+        {
+        }
+    };
+
+    struct FResult
+    {
+        std::vector<FVariant> Variants;
+        std::string AsmCode;    // все варианты, таблицы данных и таблица переходов
+    };
+
+    // Сдвигает Ink/Mask вправо на Shift пикселей; при Shift > 0 ширина растёт на один байт.
+    void ShiftSprite(
+        const std::vector<uint8_t>& InkData,
+        const std::vector<uint8_t>& MaskData,
+        int32_t WidthBytes, int32_t Height, int32_t Shift,
+        std::vector<uint8_t>& OutInkData,
+        std::vector<uint8_t>& OutMaskData,
+        int32_t& OutWidthBytes);
+
+    // Компилирует процедуру вывода для уже сдвинутых данных, OutVariant.Shift задаётся заранее.
+    // Вход: HL - адрес экрана левого верхнего байта спрайта. Портит AF, HL.
+    bool CompileVariant(
+        const std::vector<uint8_t>& InkData,
+        const std::vector<uint8_t>& MaskData,
+        int32_t WidthBytes, int32_t Height,
+        const FOptions& Options,
+        const std::string& LabelName,
+        FVariant& OutVariant,
+        std::string& OutError);
+
+    // InkData/MaskData - формат FZXColorView: Width / 8 байт на строку, в маске 1 - непрозрачный пиксель.
+    // Пустая маска означает рисование по OR.
+    bool Generate(
+        const std::vector<uint8_t>& InkData,
+        const std::vector<uint8_t>& MaskData,
+        int32_t Width, int32_t Height,
+        const FOptions& Options,
+        const std::string& LabelName,
+        FResult& OutResult,
+        std::string& OutError);
+}
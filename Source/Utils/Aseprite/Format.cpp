@@ -1,5 +1,16 @@
 #include "Format.h"
 #include "Definition.h"
+#include <Core/JobSystem.h>
+
+#include <list>
+#include <mutex>
+
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+    #define ASEPRITE_COMPOSITE_SSE2 1
+    #include <emmintrin.h>
+#else
+    #define ASEPRITE_COMPOSITE_SSE2 0
+#endif
 
 // https://github.com/aseprite/aseprite/blob/main/docs/ase-file-specs.md
 namespace AsepriteFormat
@@ -46,60 +57,76 @@ namespace AsepriteFormat
         return ((v << GRAYA_V_SHIFT) | (a << GRAYA_A_SHIFT));
     }
 
-    static uint8_t Read_u8(std::ifstream& File)
+    // the whole file is read once, chunks are parsed straight from memory
+    struct FReader
     {
-        uint8_t b = {};
-        File.read((char*)&b, 1);
-        return b;
-    }
+        const uint8_t* Data = nullptr;
+        size_t Size = 0;
+        size_t Pos = 0;
 
-    static uint16_t Read_u16(std::ifstream& File)
-    {
-        uint8_t b[2] = {};
-        File.read((char*)b, 2);
-        return b[0] | (b[1] << 8);
-    }
+        size_t Tell() const
+        {
+            return Pos;
+        }
 
-    static uint32_t Read_u32(std::ifstream& File)
-    {
-        uint8_t b[4] = {};
-        File.read((char*)b, 4);
-        return b[0] | (b[1] << 8) | (b[2] << 16) | (b[3] << 24);
-    }
+        void Seek(size_t NewPos)
+        {
+            Pos = (std::min)(NewPos, Size);
+        }
+    };
 
-    static size_t ReadBytes(std::ifstream& File, uint8_t* buf, size_t n)
+    static uint8_t Read_u8(FReader& File)
     {
-        File.read(reinterpret_cast<char*>(buf), n);
-        return File.gcount();
+        return File.Pos < File.Size ? File.Data[File.Pos++] : 0;
     }
 
-    static void ReadPadding(std::ifstream& File, int32_t Bytes)
+    static uint16_t Read_u16(FReader& File)
     {
-        for (int c = 0; c < Bytes; c++)
+        if (File.Pos + 2 > File.Size)
         {
-            Read_u8(File);
+            File.Pos = File.Size;
+            return 0;
         }
+        const uint8_t* b = File.Data + File.Pos;
+        File.Pos += 2;
+        return b[0] | (b[1] << 8);
     }
 
-    static std::string ReadString(std::ifstream& File)
+    static uint32_t Read_u32(FReader& File)
     {
-        uint16_t Length = Read_u16(File);
-        if (Length == EOF)
+        if (File.Pos + 4 > File.Size)
         {
-            return "";
+            File.Pos = File.Size;
+            return 0;
         }
+        const uint8_t* b = File.Data + File.Pos;
+        File.Pos += 4;
+        return b[0] | (b[1] << 8) | (b[2] << 16) | (uint32_t(b[3]) << 24);
+    }
 
-        std::string String;
-        String.reserve(Length + 1);
+    static size_t ReadBytes(FReader& File, uint8_t* buf, size_t n)
+    {
+        n = (std::min)(n, File.Size - File.Pos);
+        std::memcpy(buf, File.Data + File.Pos, n);
+        File.Pos += n;
+        return n;
+    }
 
-        for (uint16_t c = 0; c < Length; c++)
-        {
-            String.push_back(Read_u8(File));
-        }
+    static void ReadPadding(FReader& File, int32_t Bytes)
+    {
+        File.Seek(File.Pos + Bytes);
+    }
+
+    static std::string ReadString(FReader& File)
+    {
+        const uint16_t Length = Read_u16(File);
+        const size_t Available = (std::min)(size_t(Length), File.Size - File.Pos);
+        std::string String(reinterpret_cast<const char*>(File.Data + File.Pos), Available);
+        File.Pos += Available;
         return String;
     }
 
-    static void ReadRawImage(std::ifstream& File, EPixelFormat PixelFormat, std::vector<uint8_t>& OutputRGBA, const FAsepriteHeader& Header, uint16_t X, uint16_t Y, uint16_t W, uint16_t H)
+    static void ReadRawImage(FReader& File, EPixelFormat PixelFormat, std::vector<uint8_t>& OutputRGBA, const FAsepriteHeader& Header, uint16_t X, uint16_t Y, uint16_t W, uint16_t H)
     {
         switch (PixelFormat)
         {
@@ -162,10 +189,14 @@ namespace AsepriteFormat
         }
     }
 
-    static bool ReadCompressedImage(std::ifstream& File, EPixelFormat PixelFormat, std::vector<uint8_t>& OutputRGBA, const FAsepriteHeader& Header, size_t ChunkEnd, int16_t X, int16_t Y, uint16_t W, uint16_t H)
+    static bool ReadCompressedImage(FReader& File, EPixelFormat PixelFormat, std::vector<uint8_t>& OutputRGBA, const FAsepriteHeader& Header, size_t ChunkEnd, int16_t X, int16_t Y, uint16_t W, uint16_t H)
     {
         z_stream zstream{};
         int32_t err = inflateInit(&zstream);
+        ON_SCOPE_EXIT
+        {
+            inflateEnd(&zstream);
+        };
         
         std::vector<uint8_t> Compressed(4096);
         std::vector<uint8_t> Uncompressed(4096);
@@ -186,9 +217,9 @@ namespace AsepriteFormat
             const int32_t WidthBytes = W * sizeof(uint32_t);
             std::vector<uint8_t> Scanline(WidthBytes);
 
-            while (File.tellg() < static_cast<std::streampos>(ChunkEnd))
+            while (File.Tell() < ChunkEnd)
             {
-                size_t InputBytes = std::min<size_t>(Compressed.size(), ChunkEnd - File.tellg());
+                size_t InputBytes = std::min<size_t>(Compressed.size(), ChunkEnd - File.Tell());
                 size_t BytesRead = ReadBytes(File, Compressed.data(), InputBytes);
                 if (BytesRead == 0)
                 {
@@ -261,9 +292,9 @@ namespace AsepriteFormat
             const int32_t WidthBytes = W * sizeof(uint16_t);
             std::vector<uint8_t> Scanline(WidthBytes);
 
-            while (File.tellg() < static_cast<std::streampos>(ChunkEnd))
+            while (File.Tell() < ChunkEnd)
             {
-                size_t InputBytes = std::min<size_t>(Compressed.size(), ChunkEnd - File.tellg());
+                size_t InputBytes = std::min<size_t>(Compressed.size(), ChunkEnd - File.Tell());
                 size_t BytesRead = ReadBytes(File, Compressed.data(), InputBytes);
                 if (BytesRead == 0)
                 {
@@ -334,9 +365,9 @@ namespace AsepriteFormat
             const int32_t WidthBytes = W * sizeof(uint8_t);
             std::vector<uint8_t> Scanline(WidthBytes);
 
-            while (File.tellg() < static_cast<std::streampos>(ChunkEnd))
+            while (File.Tell() < ChunkEnd)
             {
-                size_t InputBytes = std::min<size_t>(Compressed.size(), ChunkEnd - File.tellg());
+                size_t InputBytes = std::min<size_t>(Compressed.size(), ChunkEnd - File.Tell());
                 size_t BytesRead = ReadBytes(File, Compressed.data(), InputBytes);
                 if (BytesRead == 0)
                 {
@@ -411,9 +442,9 @@ namespace AsepriteFormat
         return true;
     }
 
-    static bool ReadHeader(std::ifstream& File, FAsepriteHeader& OutputHeader)
+    static bool ReadHeader(FReader& File, FAsepriteHeader& OutputHeader)
     {
-        size_t HeaderPos = File.tellg();
+        size_t HeaderPos = File.Tell();
 
         OutputHeader.Size = Read_u32(File);
         OutputHeader.Magic = Read_u16(File);
@@ -472,11 +503,11 @@ namespace AsepriteFormat
         }
 #endif
 
-        File.seekg(HeaderPos + 128, std::ios::beg);
+        File.Seek(HeaderPos + 128);
         return true;
     }
 
-    static void ReadFrameHeader(std::ifstream& File, FAsepriteFrameHeader& OutputFrameHeader)
+    static void ReadFrameHeader(FReader& File, FAsepriteFrameHeader& OutputFrameHeader)
     {
         OutputFrameHeader.Size = Read_u32(File);
         OutputFrameHeader.Magic = Read_u16(File);
@@ -491,7 +522,7 @@ namespace AsepriteFormat
         }
     }
 
-    static void ReadColorChunk(std::ifstream& File, FPalette& InOutputPalette, bool bScale6bitsTo8bits)
+    static void ReadColorChunk(FReader& File, FPalette& InOutputPalette, bool bScale6bitsTo8bits)
     {
         int32_t Packets = Read_u16(File); // Number of packets
 
@@ -516,7 +547,7 @@ namespace AsepriteFormat
         }
     }
 
-    static void ReadPaletteChunk(std::ifstream& File, FPalette& OutputPalette)
+    static void ReadPaletteChunk(FReader& File, FPalette& OutputPalette)
     {
         int32_t NewSize = Read_u32(File);
         int32_t from = Read_u32(File);
@@ -544,7 +575,7 @@ namespace AsepriteFormat
         }
     }
 
-    static FLayer ReadLayerChunk(std::ifstream& File)
+    static FLayer ReadLayerChunk(FReader& File)
     {
         // Read chunk data
         uint16_t Flags = Read_u16(File);
@@ -658,27 +689,104 @@ namespace AsepriteFormat
         //return layer;
     }
 
-    struct FCelReadResult
+    // position of a cel in the file, pixels are decoded only when a frame needs them
+    struct FCelIndex
     {
-        uint16_t LayerIndex = uint16_t(-1);
-        uint16_t LinkFrame = uint16_t(-1);
+        uint16_t LayerIndex = 0;
+        int16_t X = 0;
+        int16_t Y = 0;
+        int16_t W = 0;
+        int16_t H = 0;
+        uint16_t CelType = 0;
         int16_t ZIndex = 0;
         uint8_t Opacity = 255;
+        uint16_t PaletteIndex = 0;
+        int32_t PixelFrame = INDEX_NONE;    // frame owning the pixels, differs from the cel frame for linked cels
+        size_t DataPos = 0;
+        size_t ChunkEnd = 0;
+    };
+
+    // bytes-bounded LRU of decoded RGBA buffers
+    class FPixelCache
+    {
+    public:
+        explicit FPixelCache(size_t InBudget)
+            : Budget(InBudget)
+            , Size(0)
+        {}
 
-        bool IsValid() const
+        std::shared_ptr<const std::vector<uint8_t>> Find(uint64_t Key)
         {
-            return LayerIndex != uint16_t(-1);
+            auto It = Entries.find(Key);
+            if (It == Entries.end())
+            {
+                return nullptr;
+            }
+            Order.splice(Order.begin(), Order, It->second.second);
+            return It->second.first;
         }
+
+        // the lock is released while decoding, so two workers may add the same key; the entry is replaced in place
+        void Add(uint64_t Key, std::shared_ptr<const std::vector<uint8_t>> Pixels)
+        {
+            if (auto It = Entries.find(Key); It != Entries.end())
+            {
+                Size -= It->second.first->size();
+                Order.erase(It->second.second);
+                Entries.erase(It);
+            }
+
+            Size += Pixels->size();
+            Order.push_front(Key);
+            Entries[Key] = { std::move(Pixels), Order.begin() };
+
+            while (Size > Budget && Order.size() > 1)
+            {
+                auto Oldest = Entries.find(Order.back());
+                Size -= Oldest->second.first->size();
+                Entries.erase(Oldest);
+                Order.pop_back();
+            }
+        }
+
+        void Clear()
+        {
+            Entries.clear();
+            Order.clear();
+            Size = 0;
+        }
+
+    private:
+        size_t Budget;
+        size_t Size;
+        std::list<uint64_t> Order;
+        std::unordered_map<uint64_t, std::pair<std::shared_ptr<const std::vector<uint8_t>>, std::list<uint64_t>::iterator>> Entries;
     };
 
+    static constexpr size_t CelCacheBudget = 32 * 1024 * 1024;
+    static constexpr size_t FrameCacheBudget = 32 * 1024 * 1024;
 
-    static FCelReadResult ReadCelChunk(
-        std::ifstream& File,
-        EPixelFormat PixelFormat,
-        std::vector<uint8_t>& OutputRGBA,
-        const std::vector<FLayer>& Layers,
-        const FPalette& Palette,
-        const FAsepriteHeader& Header,
+    struct FFrameSource
+    {
+        std::vector<uint8_t> FileData;
+        FAsepriteHeader Header = {};
+        EColorMode ColorMode = EColorMode::RGB;
+        std::vector<FPalette> Palettes;             // palette versions in file order, cels refer to them by index
+        std::vector<std::vector<FCelIndex>> Cels;   // per frame, one cel per layer
+
+        std::mutex Mutex;
+        FPixelCache CelCache{ CelCacheBudget };
+        FPixelCache FrameCache{ FrameCacheBudget };
+        std::unordered_map<int32_t, std::shared_ptr<const std::vector<uint8_t>>> EditedFrames;
+        uint32_t Revision = 0;                      // bumped by RebuildFrames, composites of an older layer state aren't cached
+    };
+
+    // reads the cel header and remembers where its pixels are, returns false for cels of unknown layers
+    static bool ReadCelChunk(
+        FReader& File,
+        FCelIndex& OutputCel,
+        uint16_t& OutputLinkFrame,
+        size_t LayerCount,
         size_t ChunkEnd)
     {
         // Read chunk data
@@ -690,88 +798,36 @@ namespace AsepriteFormat
         int16_t zIndex      = ((int16_t)Read_u16(File));
         ReadPadding(File, 5);
 
-        if (LayerIndex >= Layers.size())
+        if (LayerIndex >= LayerCount)
         {
-            return {};
+            return false;
         }
 
-        FCelReadResult Result;
-        Result.LayerIndex = LayerIndex;
-        Result.ZIndex = zIndex;
-        Result.Opacity = Opacity;
+        OutputCel.LayerIndex = LayerIndex;
+        OutputCel.X = x;
+        OutputCel.Y = y;
+        OutputCel.CelType = CelType;
+        OutputCel.ZIndex = zIndex;
+        OutputCel.Opacity = Opacity;
+        OutputCel.ChunkEnd = ChunkEnd;
+        OutputLinkFrame = uint16_t(-1);
 
         switch (CelType)
         {
         case ASE_FILE_RAW_CEL:
+        case ASE_FILE_COMPRESSED_CEL:
         {
             // Read width and height
-            int16_t w = Read_u16(File);
-            int16_t h = Read_u16(File);
-
-            if (w > 0 && h > 0)
-            {
-                // Read pixel data
-                ReadRawImage(File, PixelFormat, OutputRGBA, Header, x, y, w, h);
-                if (PixelFormat == EPixelFormat::IMAGE_INDEXED)
-                {
-                    // convert index to RGBA
-                    for (uint16_t _y = 0; _y < Header.Height; ++_y)
-                    {
-                        for (uint16_t _x = 0; _x < Header.Width; ++_x)
-                        {
-                            const size_t Index = (_y * Header.Width + _x) * sizeof(uint32_t);
-                            uint32_t& Value = reinterpret_cast<uint32_t&>(OutputRGBA[Index]);
-                            const uint8_t PaletteIndex = Value & 0xff;
-                            Value = Header.TransparentIndex == PaletteIndex
-                                ? 0
-                                : PaletteIndex < Palette.RGBA.size() ? Palette.RGBA[PaletteIndex] : 0;
-                        }
-                    }
-                }
-            }
+            OutputCel.W = Read_u16(File);
+            OutputCel.H = Read_u16(File);
+            OutputCel.DataPos = File.Tell();
             break;
         }
 
         case ASE_FILE_LINK_CEL:
         {
             // Read link position
-            Result.LinkFrame = Read_u16(File);
-            return Result;
-        }
-
-        case ASE_FILE_COMPRESSED_CEL:
-        {
-            // Read width and height
-            int16_t w = Read_u16(File);
-            int16_t h = Read_u16(File);
-
-            if (w > 0 && h > 0)
-            {
-                if (!ReadCompressedImage(File, PixelFormat, OutputRGBA, Header, ChunkEnd, x, y, w, h))
-                {
-                    LOG_ERROR("[{}]\t ReadCompressedImage.", (__FUNCTION__));
-                    break;
-                }
-                if (PixelFormat == EPixelFormat::IMAGE_INDEXED)
-                {
-                    // convert index to RGBA
-                    for (uint16_t _y = 0; _y < Header.Height; ++_y)
-                    {
-                        for (uint16_t _x = 0; _x < Header.Width; ++_x)
-                        {
-                            const size_t Index = (_y * Header.Width + _x) * sizeof(uint32_t);
-                            uint32_t& Value = reinterpret_cast<uint32_t&>(OutputRGBA[Index]);
-
-                            uint8_t PaletteIndex = Value & 0xFF;
-                            if (Palette.RGBA.size() > PaletteIndex)
-                            {
-                                const uint32_t rgba = Header.TransparentIndex == PaletteIndex ? 0x00000000 : Palette.RGBA[PaletteIndex];
-                                Value = rgba;
-                            }
-                        }
-                    }
-                }
-            }
+            OutputLinkFrame = Read_u16(File);
             break;
         }
 
@@ -859,7 +915,104 @@ namespace AsepriteFormat
             break;
         }
 
-        return Result;
+        return true;
+    }
+
+    static void DecodeCel(const FFrameSource& Source, const FCelIndex& Cel, std::vector<uint8_t>& OutputRGBA)
+    {
+        const FAsepriteHeader& Header = Source.Header;
+        const EPixelFormat Format = PixelFormat(Source.ColorMode);
+
+        constexpr int32_t RGBABytesPerPixel = 4;
+        OutputRGBA.assign(static_cast<size_t>(Header.Width) * Header.Height * RGBABytesPerPixel, 0);
+        if (Source.ColorMode == EColorMode::INDEXED)
+        {
+            uint32_t* Pixels = reinterpret_cast<uint32_t*>(OutputRGBA.data());
+            std::fill(Pixels, Pixels + static_cast<size_t>(Header.Width) * Header.Height, Header.TransparentIndex);
+        }
+
+        if (Cel.W <= 0 || Cel.H <= 0)
+        {
+            return;
+        }
+
+        FReader File{ Source.FileData.data(), Source.FileData.size(), Cel.DataPos };
+        const FPalette& Palette = Source.Palettes[Cel.PaletteIndex];
+        switch (Cel.CelType)
+        {
+        case ASE_FILE_RAW_CEL:
+        {
+            // Read pixel data
+            ReadRawImage(File, Format, OutputRGBA, Header, Cel.X, Cel.Y, Cel.W, Cel.H);
+            if (Format == EPixelFormat::IMAGE_INDEXED)
+            {
+                // convert index to RGBA
+                for (uint16_t _y = 0; _y < Header.Height; ++_y)
+                {
+                    for (uint16_t _x = 0; _x < Header.Width; ++_x)
+                    {
+                        const size_t Index = (_y * Header.Width + _x) * sizeof(uint32_t);
+                        uint32_t& Value = reinterpret_cast<uint32_t&>(OutputRGBA[Index]);
+                        const uint8_t PaletteIndex = Value & 0xff;
+                        Value = Header.TransparentIndex == PaletteIndex
+                            ? 0
+                            : PaletteIndex < Palette.RGBA.size() ? Palette.RGBA[PaletteIndex] : 0;
+                    }
+                }
+            }
+            break;
+        }
+
+        case ASE_FILE_COMPRESSED_CEL:
+        {
+            if (!ReadCompressedImage(File, Format, OutputRGBA, Header, Cel.ChunkEnd, Cel.X, Cel.Y, Cel.W, Cel.H))
+            {
+                LOG_ERROR("[{}]\t ReadCompressedImage.", (__FUNCTION__));
+                break;
+            }
+            if (Format == EPixelFormat::IMAGE_INDEXED)
+            {
+                // convert index to RGBA
+                for (uint16_t _y = 0; _y < Header.Height; ++_y)
+                {
+                    for (uint16_t _x = 0; _x < Header.Width; ++_x)
+                    {
+                        const size_t Index = (_y * Header.Width + _x) * sizeof(uint32_t);
+                        uint32_t& Value = reinterpret_cast<uint32_t&>(OutputRGBA[Index]);
+
+                        uint8_t PaletteIndex = Value & 0xFF;
+                        if (Palette.RGBA.size() > PaletteIndex)
+                        {
+                            const uint32_t rgba = Header.TransparentIndex == PaletteIndex ? 0x00000000 : Palette.RGBA[PaletteIndex];
+                            Value = rgba;
+                        }
+                    }
+                }
+            }
+            break;
+        }
+        }
+    }
+
+    // inflates outside the lock, so that several frames can be decoded at once
+    static std::shared_ptr<const std::vector<uint8_t>> GetCelPixels(FFrameSource& Source, const FCelIndex& Cel)
+    {
+        const uint64_t Key = (static_cast<uint64_t>(Cel.PixelFrame) << 16) | Cel.LayerIndex;
+        {
+            std::lock_guard Lock(Source.Mutex);
+            std::shared_ptr<const std::vector<uint8_t>> Pixels = Source.CelCache.Find(Key);
+            if (Pixels)
+            {
+                return Pixels;
+            }
+        }
+
+        std::shared_ptr<std::vector<uint8_t>> Decoded = std::make_shared<std::vector<uint8_t>>();
+        DecodeCel(Source, Cel, *Decoded);
+
+        std::lock_guard Lock(Source.Mutex);
+        Source.CelCache.Add(Key, Decoded);
+        return Decoded;
     }
 
     static bool IsLayerEffectivelyVisible(const std::vector<FLayer>& Layers, uint16_t LayerIndex)
@@ -884,59 +1037,149 @@ namespace AsepriteFormat
         return true;
     }
 
-    static void CompositeNormal(std::vector<uint8_t>& Destination, const std::vector<uint8_t>& Source, uint8_t Opacity)
+    static void CompositeNormalPixel(uint8_t* Destination, const uint8_t* Source, uint8_t Opacity)
     {
-        const size_t PixelBytes = (std::min)(Destination.size(), Source.size());
-        for (size_t Index = 0; Index + 3 < PixelBytes; Index += 4)
+        const uint32_t SourceAlpha = (static_cast<uint32_t>(Source[3]) * Opacity + 127) / 255;
+        if (SourceAlpha == 0)
         {
-            const uint32_t SourceAlpha = (static_cast<uint32_t>(Source[Index + 3]) * Opacity + 127) / 255;
-            if (SourceAlpha == 0)
-            {
-                continue;
-            }
+            return;
+        }
 
-            if (SourceAlpha == 255)
-            {
-                Destination[Index + 0] = Source[Index + 0];
-                Destination[Index + 1] = Source[Index + 1];
-                Destination[Index + 2] = Source[Index + 2];
-                Destination[Index + 3] = 255;
-                continue;
-            }
+        if (SourceAlpha == 255)
+        {
+            Destination[0] = Source[0];
+            Destination[1] = Source[1];
+            Destination[2] = Source[2];
+            Destination[3] = 255;
+            return;
+        }
 
-            const uint32_t DestinationAlpha = Destination[Index + 3];
-            const uint32_t InverseSourceAlpha = 255 - SourceAlpha;
-            const uint32_t OutputAlpha = SourceAlpha + (DestinationAlpha * InverseSourceAlpha + 127) / 255;
-            for (size_t Channel = 0; Channel < 3; ++Channel)
-            {
-                const uint32_t Premultiplied =
-                    Source[Index + Channel] * SourceAlpha +
-                    (Destination[Index + Channel] * DestinationAlpha * InverseSourceAlpha + 127) / 255;
-                Destination[Index + Channel] = static_cast<uint8_t>((Premultiplied + OutputAlpha / 2) / OutputAlpha);
-            }
-            Destination[Index + 3] = static_cast<uint8_t>(OutputAlpha);
+        const uint32_t DestinationAlpha = Destination[3];
+        const uint32_t InverseSourceAlpha = 255 - SourceAlpha;
+        const uint32_t OutputAlpha = SourceAlpha + (DestinationAlpha * InverseSourceAlpha + 127) / 255;
+        for (size_t Channel = 0; Channel < 3; ++Channel)
+        {
+            const uint32_t Premultiplied =
+                Source[Channel] * SourceAlpha +
+                (Destination[Channel] * DestinationAlpha * InverseSourceAlpha + 127) / 255;
+            // rounding can reach 256 for a nearly transparent source over a saturated channel
+            Destination[Channel] = static_cast<uint8_t>((std::min)((Premultiplied + OutputAlpha / 2) / OutputAlpha, 255u));
+        }
+        Destination[3] = static_cast<uint8_t>(OutputAlpha);
+    }
+
+#if ASEPRITE_COMPOSITE_SSE2
+    // floor(Numerator / Denominator) for integers below 2^24, the estimate is off by at most one
+    // and the remainder correction makes it exact
+    static __m128 CorrectQuotient(__m128 Estimate, __m128 Numerator, __m128 Denominator)
+    {
+        const __m128 One = _mm_set1_ps(1.0f);
+        __m128 Quotient = _mm_cvtepi32_ps(_mm_cvttps_epi32(Estimate));
+        const __m128 Remainder = _mm_sub_ps(Numerator, _mm_mul_ps(Quotient, Denominator));
+        Quotient = _mm_add_ps(Quotient, _mm_and_ps(_mm_cmpge_ps(Remainder, Denominator), One));
+        Quotient = _mm_sub_ps(Quotient, _mm_and_ps(_mm_cmplt_ps(Remainder, _mm_setzero_ps()), One));
+        return Quotient;
+    }
+
+    static __m128 DivideFloor255(__m128 Numerator)
+    {
+        return CorrectQuotient(_mm_mul_ps(Numerator, _mm_set1_ps(1.0f / 255.0f)), Numerator, _mm_set1_ps(255.0f));
+    }
+
+    // same integer math as CompositeNormalPixel for 4 pixels at once, channels split into float lanes
+    static void CompositeNormal4(uint8_t* Destination, const uint8_t* Source, __m128 Opacity, bool bFullOpacity)
+    {
+        const __m128i ByteMask = _mm_set1_epi32(0xFF);
+        const __m128 Half = _mm_set1_ps(127.0f);
+        const __m128 Max = _mm_set1_ps(255.0f);
+
+        const __m128i SourcePixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Source));
+
+        // sprites are mostly fully transparent or fully opaque, such blocks skip the blend
+        const __m128i SourceAlphaBytes = _mm_srli_epi32(SourcePixels, 24);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(SourceAlphaBytes, _mm_setzero_si128())) == 0xFFFF)
+        {
+            return;
+        }
+        if (bFullOpacity && _mm_movemask_epi8(_mm_cmpeq_epi32(SourceAlphaBytes, ByteMask)) == 0xFFFF)
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(Destination), SourcePixels);
+            return;
+        }
+
+        const __m128i DestinationPixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Destination));
+
+        const __m128 SourceAlpha = DivideFloor255(
+            _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(SourceAlphaBytes), Opacity), Half));
+        const __m128 DestinationAlpha = _mm_cvtepi32_ps(_mm_srli_epi32(DestinationPixels, 24));
+        const __m128 InverseSourceAlpha = _mm_sub_ps(Max, SourceAlpha);
+        const __m128 OutputAlpha = _mm_add_ps(SourceAlpha,
+            DivideFloor255(_mm_add_ps(_mm_mul_ps(DestinationAlpha, InverseSourceAlpha), Half)));
+
+        // fully transparent source pixels keep the destination, OutputAlpha is 0 only for them
+        const __m128 Skip = _mm_cmpeq_ps(SourceAlpha, _mm_setzero_ps());
+        const __m128 Divisor = _mm_max_ps(OutputAlpha, _mm_set1_ps(1.0f));
+        const __m128 Reciprocal = _mm_div_ps(_mm_set1_ps(1.0f), Divisor);
+        const __m128 HalfOutputAlpha = _mm_cvtepi32_ps(_mm_srli_epi32(_mm_cvttps_epi32(OutputAlpha), 1));
+        const __m128 DestinationWeight = _mm_mul_ps(DestinationAlpha, InverseSourceAlpha);
+
+        __m128i Result = _mm_slli_epi32(_mm_cvttps_epi32(OutputAlpha), 24);
+        for (int32_t Shift = 0; Shift < 24; Shift += 8)
+        {
+            const __m128i ShiftCount = _mm_cvtsi32_si128(Shift);
+            const __m128 SourceChannel = _mm_cvtepi32_ps(_mm_and_si128(_mm_srl_epi32(SourcePixels, ShiftCount), ByteMask));
+            const __m128 DestinationChannel = _mm_cvtepi32_ps(_mm_and_si128(_mm_srl_epi32(DestinationPixels, ShiftCount), ByteMask));
+            const __m128 Premultiplied = _mm_add_ps(
+                _mm_mul_ps(SourceChannel, SourceAlpha),
+                DivideFloor255(_mm_add_ps(_mm_mul_ps(DestinationChannel, DestinationWeight), Half)));
+            const __m128 Numerator = _mm_add_ps(Premultiplied, HalfOutputAlpha);
+            const __m128 Channel = _mm_min_ps(CorrectQuotient(_mm_mul_ps(Numerator, Reciprocal), Numerator, Divisor), Max);
+            Result = _mm_or_si128(Result, _mm_sll_epi32(_mm_cvttps_epi32(Channel), ShiftCount));
+        }
+
+        const __m128i SkipMask = _mm_castps_si128(Skip);
+        Result = _mm_or_si128(_mm_and_si128(SkipMask, DestinationPixels), _mm_andnot_si128(SkipMask, Result));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(Destination), Result);
+    }
+#endif // ASEPRITE_COMPOSITE_SSE2
+
+    static void CompositeNormal(std::vector<uint8_t>& Destination, const std::vector<uint8_t>& Source, uint8_t Opacity)
+    {
+        const size_t PixelBytes = (std::min)(Destination.size(), Source.size()) & ~size_t(3);
+        size_t Index = 0;
+#if ASEPRITE_COMPOSITE_SSE2
+        const __m128 OpacityLanes = _mm_set1_ps(static_cast<float>(Opacity));
+        for (; Index + 16 <= PixelBytes; Index += 16)
+        {
+            CompositeNormal4(Destination.data() + Index, Source.data() + Index, OpacityLanes, Opacity == 255);
+        }
+#endif // ASEPRITE_COMPOSITE_SSE2
+        for (; Index < PixelBytes; Index += 4)
+        {
+            CompositeNormalPixel(Destination.data() + Index, Source.data() + Index, Opacity);
         }
     }
 
     static void CompositeFrame(
         std::vector<uint8_t>& OutputRGBA,
-        const std::map<uint16_t, FDecodedCel>& Cels,
+        FFrameSource& Source,
+        const std::vector<FCelIndex>& Cels,
         const std::vector<FLayer>& Layers,
         uint32_t HeaderFlags)
     {
         struct FRenderCel
         {
             uint16_t LayerIndex;
-            const FDecodedCel* Cel;
+            const FCelIndex* Cel;
         };
 
         std::vector<FRenderCel> RenderPlan;
         RenderPlan.reserve(Cels.size());
-        for (const auto& [LayerIndex, Cel] : Cels)
+        for (const FCelIndex& Cel : Cels)
         {
-            if (IsLayerEffectivelyVisible(Layers, LayerIndex))
+            if (IsLayerEffectivelyVisible(Layers, Cel.LayerIndex))
             {
-                RenderPlan.push_back({ LayerIndex, &Cel });
+                RenderPlan.push_back({ Cel.LayerIndex, &Cel });
             }
         }
 
@@ -954,21 +1197,111 @@ namespace AsepriteFormat
             const uint8_t LayerOpacity = (HeaderFlags & ASE_FILE_FLAG_LAYER_WITH_OPACITY) ? Layer.Opacity : 255;
             const uint8_t Opacity = static_cast<uint8_t>(
                 (static_cast<uint32_t>(RenderCel.Cel->Opacity) * LayerOpacity + 127) / 255);
-            CompositeNormal(OutputRGBA, RenderCel.Cel->Pixels, Opacity);
+            CompositeNormal(OutputRGBA, *GetCelPixels(Source, *RenderCel.Cel), Opacity);
         }
     }
 
-    bool RebuildFrames(FSprite& Sprite)
+    static const FCelIndex* FindCel(const FFrameSource& Source, int32_t Frame, uint16_t LayerIndex)
     {
-        if (Sprite.DecodedFrames.size() != Sprite.Frames.size())
+        const std::vector<FCelIndex>& Cels = Source.Cels[Frame];
+        auto It = std::lower_bound(Cels.begin(), Cels.end(), LayerIndex,
+            [](const FCelIndex& Cel, uint16_t Index)
+            {
+                return Cel.LayerIndex < Index;
+            });
+        return It != Cels.end() && It->LayerIndex == LayerIndex ? &(*It) : nullptr;
+    }
+
+    std::shared_ptr<const std::vector<uint8_t>> GetFrameRGBA(const FSprite& Sprite, int32_t Frame)
+    {
+        if (!Sprite.Source || Frame < 0 || Frame >= static_cast<int32_t>(Sprite.Source->Cels.size()))
         {
-            return false;
+            return std::make_shared<const std::vector<uint8_t>>(static_cast<size_t>(Sprite.Width) * Sprite.Height * 4, 0);
         }
 
-        for (size_t Frame = 0; Frame < Sprite.Frames.size(); ++Frame)
+        FFrameSource& Source = *Sprite.Source;
+        uint32_t Revision = 0;
         {
-            CompositeFrame(Sprite.Frames[Frame], Sprite.DecodedFrames[Frame], Sprite.Layers, Sprite.HeaderFlags);
+            std::lock_guard Lock(Source.Mutex);
+            Revision = Source.Revision;
+            auto EditedIt = Source.EditedFrames.find(Frame);
+            if (EditedIt != Source.EditedFrames.end())
+            {
+                return EditedIt->second;
+            }
+
+            std::shared_ptr<const std::vector<uint8_t>> RGBA = Source.FrameCache.Find(Frame);
+            if (RGBA)
+            {
+                return RGBA;
+            }
         }
+
+        // the chunk index never changes after Load, only the caches need the lock
+        constexpr int32_t Size = 4; // Composite RGB and grayscale frames in a common RGBA buffer.
+        std::shared_ptr<std::vector<uint8_t>> Composite =
+            std::make_shared<std::vector<uint8_t>>(static_cast<size_t>(Sprite.Width) * Sprite.Height * Size);
+        CompositeFrame(*Composite, Source, Source.Cels[Frame], Sprite.Layers, Sprite.HeaderFlags);
+
+        std::lock_guard Lock(Source.Mutex);
+        if (Revision == Source.Revision)
+        {
+            Source.FrameCache.Add(Frame, Composite);
+        }
+        return Composite;
+    }
+
+    void DecodeFrames(const FSprite& Sprite, int32_t FirstFrame, int32_t Count)
+    {
+        if (!Sprite.Source || Sprite.Width <= 0 || Sprite.Height <= 0)
+        {
+            return;
+        }
+
+        // decoding more than the cache keeps would only evict the first frames again
+        const size_t FrameBytes = static_cast<size_t>(Sprite.Width) * Sprite.Height * 4;
+        const int32_t MaxFrames = static_cast<int32_t>((std::max)(FrameCacheBudget / FrameBytes, size_t(1)));
+        FirstFrame = std::clamp(FirstFrame, 0, Sprite.FrameCount);
+        const int32_t LastFrame = (std::min)(FirstFrame + (std::min)(Count, MaxFrames), Sprite.FrameCount);
+        if (LastFrame - FirstFrame <= 1)
+        {
+            if (LastFrame > FirstFrame)
+            {
+                GetFrameRGBA(Sprite, FirstFrame);
+            }
+            return;
+        }
+
+        FJobSystem::Get().ParallelFor(LastFrame - FirstFrame,
+            [&Sprite, FirstFrame](int32_t Index)
+            {
+                GetFrameRGBA(Sprite, FirstFrame + Index);
+            });
+    }
+
+    void SetFrameRGBA(FSprite& Sprite, int32_t Frame, std::vector<uint8_t>&& RGBA)
+    {
+        if (!Sprite.Source || Frame < 0 || Frame >= Sprite.FrameCount)
+        {
+            return;
+        }
+
+        std::lock_guard Lock(Sprite.Source->Mutex);
+        Sprite.Source->EditedFrames[Frame] = std::make_shared<const std::vector<uint8_t>>(std::move(RGBA));
+    }
+
+    bool RebuildFrames(FSprite& Sprite)
+    {
+        if (!Sprite.Source || Sprite.Source->Cels.size() != static_cast<size_t>(Sprite.FrameCount))
+        {
+            return false;
+        }
+
+        // decoded cels don't depend on the layer state and stay cached
+        std::lock_guard Lock(Sprite.Source->Mutex);
+        Sprite.Source->FrameCache.Clear();
+        Sprite.Source->EditedFrames.clear();
+        ++Sprite.Source->Revision;
         return true;
     }
 
@@ -978,8 +1311,8 @@ namespace AsepriteFormat
 		const std::string& LayerName,
 		std::vector<uint8_t>& OutputRGBA)
 	{
-		if (LayerName.empty() || Frame < 0 ||
-			Frame >= static_cast<int32_t>(Sprite.DecodedFrames.size()))
+		if (LayerName.empty() || !Sprite.Source || Frame < 0 ||
+			Frame >= static_cast<int32_t>(Sprite.Source->Cels.size()))
 		{
 			return false;
 		}
@@ -995,19 +1328,20 @@ namespace AsepriteFormat
 		}
 
 		const uint16_t LayerIndex = static_cast<uint16_t>(std::distance(Sprite.Layers.begin(), LayerIt));
-		const auto CelIt = Sprite.DecodedFrames[Frame].find(LayerIndex);
+		FFrameSource& Source = *Sprite.Source;
+		const FCelIndex* Cel = FindCel(Source, Frame, LayerIndex);
 		OutputRGBA.assign(static_cast<size_t>(Sprite.Width) * Sprite.Height * 4, 0);
-		if (CelIt == Sprite.DecodedFrames[Frame].end())
+		if (Cel == nullptr)
 		{
 			return true;
 		}
 
-		OutputRGBA = CelIt->second.Pixels;
+		OutputRGBA = *GetCelPixels(Source, *Cel);
 		const uint8_t LayerOpacity = (Sprite.HeaderFlags & ASE_FILE_FLAG_LAYER_WITH_OPACITY)
 			? LayerIt->Opacity
 			: 255;
 		const uint32_t Opacity =
-			(static_cast<uint32_t>(CelIt->second.Opacity) * LayerOpacity + 127) / 255;
+			(static_cast<uint32_t>(Cel->Opacity) * LayerOpacity + 127) / 255;
 		for (size_t Index = 3; Index < OutputRGBA.size(); Index += 4)
 		{
 			OutputRGBA[Index] = static_cast<uint8_t>(
@@ -1019,12 +1353,24 @@ namespace AsepriteFormat
 	{
         bool bIgnoreOldColorChunks = false;
 
-        std::ifstream File(FilePath, std::ios::binary);
-        if (!File.is_open())
+        std::shared_ptr<FFrameSource> Source = std::make_shared<FFrameSource>();
         {
-            LOG_ERROR("[{}]\t Cannot open file.", (__FUNCTION__));
-            return false;
+            std::ifstream Stream(FilePath, std::ios::binary | std::ios::ate);
+            if (!Stream.is_open())
+            {
+                LOG_ERROR("[{}]\t Cannot open file.", (__FUNCTION__));
+                return false;
+            }
+
+            Source->FileData.resize(static_cast<size_t>(Stream.tellg()));
+            Stream.seekg(0);
+            if (!Stream.read(reinterpret_cast<char*>(Source->FileData.data()), Source->FileData.size()))
+            {
+                LOG_ERROR("[{}]\t Cannot read file.", (__FUNCTION__));
+                return false;
+            }
         }
+        FReader File{ Source->FileData.data(), Source->FileData.size(), 0 };
 
 		FAsepriteHeader Header;
         if (!ReadHeader(File, Header))
@@ -1050,7 +1396,7 @@ namespace AsepriteFormat
         OutputSprite.Height = Header.Height;
         OutputSprite.HeaderFlags = Header.Flags;
 
-        OutputSprite.Frames.resize(Header.Frames);
+        OutputSprite.FrameCount = Header.Frames;
         {
             OutputSprite.DurationPerFrame.resize(Header.Frames);
             std::fill(OutputSprite.DurationPerFrame.begin(), OutputSprite.DurationPerFrame.end(), std::clamp<uint16_t>(Header.Speed, 1, 65535));
@@ -1074,16 +1420,15 @@ namespace AsepriteFormat
             }
         }
 
-        OutputSprite.DecodedFrames.clear();
-        OutputSprite.DecodedFrames.resize(Header.Frames);
+        Source->Header = Header;
+        Source->ColorMode = OutputSprite.ColorMode;
+        Source->Cels.resize(Header.Frames);
+        bool bPaletteChanged = true;
 
-        // Read frame by frame to end-of-file
-        for (int Frame = 0; Frame < OutputSprite.Frames.size(); ++Frame)
+        // Index frame by frame to end-of-file, pixels are decoded on demand
+        for (int Frame = 0; Frame < OutputSprite.FrameCount; ++Frame)
         {
-            constexpr int32_t Size = 4; // Composite RGB and grayscale frames in a common RGBA buffer.
-            OutputSprite.Frames[Frame].resize(OutputSprite.Width * OutputSprite.Height * Size);
-
-            size_t FramePos = File.tellg();
+            size_t FramePos = File.Tell();
             FAsepriteFrameHeader FrameHeader;
             ReadFrameHeader(File, FrameHeader);
 
@@ -1103,7 +1448,7 @@ namespace AsepriteFormat
                 for (uint32_t c = 0; c < FrameHeader.Chunks; c++)
                 {
                     // Start chunk position
-                    size_t ChunkPos = File.tellg();
+                    size_t ChunkPos = File.Tell();
 
                     // Read chunk information
                     int32_t ChunkSize = Read_u32(File);
@@ -1117,6 +1462,7 @@ namespace AsepriteFormat
                         if (!bIgnoreOldColorChunks)
                         {
                             ReadColorChunk(File, Palette, ChunkType == ASE_FILE_CHUNK_FLI_COLOR);
+                            bPaletteChanged = true;
                         }
                         break;
                     }
@@ -1124,6 +1470,7 @@ namespace AsepriteFormat
                     case ASE_FILE_CHUNK_PALETTE:
                     {
                         ReadPaletteChunk(File, Palette);
+                        bPaletteChanged = true;
                         bIgnoreOldColorChunks = true;
                         break;
                     }
@@ -1150,56 +1497,60 @@ namespace AsepriteFormat
 
                     case ASE_FILE_CHUNK_CEL:
                     {
-                        constexpr int32_t RGBABytesPerPixel = 4;
-                        std::vector<uint8_t> CelPixels(
-                            static_cast<size_t>(OutputSprite.Width) * OutputSprite.Height * RGBABytesPerPixel,
-                            0);
-                        if (OutputSprite.ColorMode == EColorMode::INDEXED)
-                        {
-                            uint32_t* Pixels = reinterpret_cast<uint32_t*>(CelPixels.data());
-                            std::fill(
-                                Pixels,
-                                Pixels + static_cast<size_t>(OutputSprite.Width) * OutputSprite.Height,
-                                Header.TransparentIndex);
-                        }
-
-                        const FCelReadResult Cel = ReadCelChunk(
-                            File,
-                            PixelFormat(OutputSprite.ColorMode),
-                            CelPixels,
-                            OutputSprite.Layers,
-                            Palette,
-                            Header,
-                            ChunkPos + ChunkSize);
-                        if (!Cel.IsValid())
+                        FCelIndex Cel;
+                        uint16_t LinkFrame;
+                        if (!ReadCelChunk(File, Cel, LinkFrame, OutputSprite.Layers.size(), ChunkPos + ChunkSize))
                         {
                             break;
                         }
 
-                        FDecodedCel DecodedCel;
-                        DecodedCel.ZIndex = Cel.ZIndex;
-                        DecodedCel.Opacity = Cel.Opacity;
-                        if (Cel.LinkFrame != uint16_t(-1))
+                        if (LinkFrame != uint16_t(-1))
                         {
-                            if (Cel.LinkFrame >= OutputSprite.DecodedFrames.size())
+                            if (LinkFrame >= Frame)
                             {
-                                LOG_WARNING("[{}]\t Invalid linked cel frame {}.", (__FUNCTION__), Cel.LinkFrame);
+                                LOG_WARNING("[{}]\t Invalid linked cel frame {}.", (__FUNCTION__), LinkFrame);
                                 break;
                             }
 
-                            const auto LinkedCel = OutputSprite.DecodedFrames[Cel.LinkFrame].find(Cel.LayerIndex);
-                            if (LinkedCel == OutputSprite.DecodedFrames[Cel.LinkFrame].end())
+                            const FCelIndex* LinkedCel = FindCel(*Source, LinkFrame, Cel.LayerIndex);
+                            if (LinkedCel == nullptr)
                             {
-                                LOG_WARNING("[{}]\t Linked cel was not found in frame {}, layer {}.", (__FUNCTION__), Cel.LinkFrame, Cel.LayerIndex);
+                                LOG_WARNING("[{}]\t Linked cel was not found in frame {}, layer {}.", (__FUNCTION__), LinkFrame, Cel.LayerIndex);
                                 break;
                             }
-                            DecodedCel.Pixels = LinkedCel->second.Pixels;
+
+                            // shares the pixels (and the decoded cache entry) of the linked cel
+                            const int16_t ZIndex = Cel.ZIndex;
+                            const uint8_t Opacity = Cel.Opacity;
+                            Cel = *LinkedCel;
+                            Cel.ZIndex = ZIndex;
+                            Cel.Opacity = Opacity;
+                        }
+                        else
+                        {
+                            if (bPaletteChanged)
+                            {
+                                Source->Palettes.push_back(Palette);
+                                bPaletteChanged = false;
+                            }
+                            Cel.PaletteIndex = static_cast<uint16_t>(Source->Palettes.size() - 1);
+                            Cel.PixelFrame = Frame;
+                        }
+
+                        std::vector<FCelIndex>& Cels = Source->Cels[Frame];
+                        auto It = std::lower_bound(Cels.begin(), Cels.end(), Cel.LayerIndex,
+                            [](const FCelIndex& Other, uint16_t Index)
+                            {
+                                return Other.LayerIndex < Index;
+                            });
+                        if (It != Cels.end() && It->LayerIndex == Cel.LayerIndex)
+                        {
+                            *It = Cel;
                         }
                         else
                         {
-                            DecodedCel.Pixels = std::move(CelPixels);
+                            Cels.insert(It, Cel);
                         }
-                        OutputSprite.DecodedFrames[Frame][Cel.LayerIndex] = std::move(DecodedCel);
                         break;
                     }
 
@@ -1366,15 +1717,15 @@ namespace AsepriteFormat
                     }
                     
                     // Skip chunk size
-                    File.seekg(ChunkPos + ChunkSize);
+                    File.Seek(ChunkPos + ChunkSize);
                 }
             }
 
             // Skip frame size
-            File.seekg(FramePos + FrameHeader.Size);
+            File.Seek(FramePos + FrameHeader.Size);
         }
 
-        RebuildFrames(OutputSprite);
+        OutputSprite.Source = std::move(Source);
 
         OutputSprite.TransparentColor = Header.TransparentIndex < Palette.RGBA.size()
             ? Palette.RGBA[Header.TransparentIndex]
@@ -62,23 +62,18 @@ namespace AsepriteFormat
 		std::string Name;
 	};
 
-	struct FDecodedCel
-	{
-		std::vector<uint8_t> Pixels;
-		int16_t ZIndex = 0;
-		uint8_t Opacity = 255;
-	};
+	// file contents, chunk index of every frame and bounded caches of decoded cels and composited frames
+	struct FFrameSource;
 
 	struct FSprite
 	{
 		EColorMode ColorMode = EColorMode::RGB;
 		int32_t Width = 0;
 		int32_t Height = 0;
+		int32_t FrameCount = 0;
 		uint32_t TransparentColor = 0;
 		uint32_t HeaderFlags = 0;
 
-		std::vector<std::vector<uint8_t>> Frames;
-		std::vector<std::map<uint16_t, FDecodedCel>> DecodedFrames;
 		std::vector<int32_t> DurationPerFrame;
 		std::vector<FLayer> Layers;
 
@@ -86,12 +81,21 @@ namespace AsepriteFormat
 		std::string AttributeLayer;
 		std::string MaskLayer;
 
+		std::shared_ptr<FFrameSource> Source;
+
 		bool IsValid() const
 		{
-			return !Frames.empty() && !Layers.empty() && !DurationPerFrame.empty() && Width && Height;
+			return FrameCount > 0 && !Layers.empty() && !DurationPerFrame.empty() && Width && Height;
 		}
 	};
 
+	// composited RGBA of the visible layers, decoded on first request
+	std::shared_ptr<const std::vector<uint8_t>> GetFrameRGBA(const FSprite& Sprite, int32_t Frame);
+	// decodes and composites a range of frames on all cores, they are then served from the cache
+	void DecodeFrames(const FSprite& Sprite, int32_t FirstFrame, int32_t Count);
+	// replaces the composite of a frame (edited in the canvas) until the next RebuildFrames
+	void SetFrameRGBA(FSprite& Sprite, int32_t Frame, std::vector<uint8_t>&& RGBA);
+	// drops composited frames after layer visibility/opacity changes
 	bool RebuildFrames(FSprite& Sprite);
 	bool GetLayerFrameRGBA(
 		const FSprite& Sprite,
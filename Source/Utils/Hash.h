@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace Utils
+{
+	static constexpr uint64_t FNV1a64Basis = 0xCBF29CE484222325ull;
+
+	// FNV-1a 64, continues from Hash so that several ranges can be chained into one value
+	inline uint64_t FNV1a64(uint64_t Hash, const void* Data, size_t Size)
+	{
+		const uint8_t* Bytes = static_cast<const uint8_t*>(Data);
+		for (size_t Index = 0; Index < Size; ++Index)
+		{
+			Hash = (Hash ^ Bytes[Index]) * 0x100000001B3ull;
+		}
+		return Hash;
+	}
+}
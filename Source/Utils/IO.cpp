@@ -107,3 +107,63 @@ void IO::OpenFolder(const std::filesystem::path& Path)
         );
     }
 }
+
+IO::FMappedFile::~FMappedFile()
+{
+    Close();
+}
+
+bool IO::FMappedFile::Open(const std::filesystem::path& FilePath)
+{
+    Close();
+
+    File = CreateFileW(FilePath.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (File == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER FileSize;
+    if (!GetFileSizeEx(File, &FileSize) || FileSize.QuadPart <= 0)
+    {
+        Close();
+        return false;
+    }
+
+    Mapping = CreateFileMappingW(File, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (Mapping == nullptr)
+    {
+        Close();
+        return false;
+    }
+
+    Data = static_cast<const uint8_t*>(MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0));
+    if (Data == nullptr)
+    {
+        Close();
+        return false;
+    }
+
+    Size = static_cast<size_t>(FileSize.QuadPart);
+    return true;
+}
+
+void IO::FMappedFile::Close()
+{
+    if (Data != nullptr)
+    {
+        UnmapViewOfFile(Data);
+        Data = nullptr;
+    }
+    if (Mapping != nullptr)
+    {
+        CloseHandle(Mapping);
+        Mapping = nullptr;
+    }
+    if (File != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(File);
+        File = INVALID_HANDLE_VALUE;
+    }
+    Size = 0;
+}
@@ -9,4 +9,27 @@ namespace IO
 	std::error_code LoadBinaryData(std::vector<uint8_t>& OutputData, const std::filesystem::path& FilePath);
 	std::filesystem::path NormalizePath(const std::filesystem::path& InOut);
 	void OpenFolder(const std::filesystem::path& Path);
+
+	// read-only mapping of a whole file, unmapped when closed or destroyed
+	class FMappedFile
+	{
+	public:
+		FMappedFile() = default;
+		~FMappedFile();
+
+		FMappedFile(const FMappedFile&) = delete;
+		FMappedFile& operator=(const FMappedFile&) = delete;
+
+		bool Open(const std::filesystem::path& FilePath);
+		void Close();
+
+		const uint8_t* GetData() const { return Data; }
+		size_t GetSize() const { return Size; }
+
+	private:
+		HANDLE File = INVALID_HANDLE_VALUE;
+		HANDLE Mapping = nullptr;
+		const uint8_t* Data = nullptr;
+		size_t Size = 0;
+	};
 }
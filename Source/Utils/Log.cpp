@@ -0,0 +1,414 @@
+#include "Log.h"
+
+#include <deque>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <fstream>
+#include <iostream>
+#include <condition_variable>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+namespace
+{
+	static constexpr uint32_t LogSlotSize = 64;
+	static constexpr uint32_t LogSlotPayload = LogSlotSize - sizeof(uint64_t);
+	static constexpr uint32_t LogSlotCount = 8192;
+	// a larger record is formatted by the caller, so a single message can never take the whole queue
+	static constexpr uint32_t LogRecordMaxSlots = LogSlotCount / 8;
+	static constexpr size_t LogHistorySize = 1024;
+
+	static_assert((LogSlotCount & (LogSlotCount - 1)) == 0);
+	static_assert(sizeof(Utils::FLogRecord) <= LogSlotPayload);
+
+	// bounded multi-producer queue with a sequence number per slot,
+	// a slot at position P is free for the producers when its sequence is P and ready for the consumer at P + 1
+	struct alignas(LogSlotSize) FLogSlot
+	{
+		std::atomic<uint64_t> Sequence;
+		uint8_t Payload[LogSlotPayload];
+	};
+
+	class FLogger
+	{
+	public:
+		// never destroyed, static destructors may still log while the process exits
+		static FLogger& Get()
+		{
+			static FLogger* Instance = new FLogger;
+			return *Instance;
+		}
+
+		FLogger()
+			: Slots(new FLogSlot[LogSlotCount])
+			, Head(0)
+			, Tail(0)
+			, Dropped(0)
+		{
+			for (uint32_t Index = 0; Index < LogSlotCount; ++Index)
+			{
+				Slots[Index].Sequence.store(Index, std::memory_order_relaxed);
+			}
+			Worker = std::thread(&FLogger::Worker_Execution, this);
+			Worker.detach();
+			std::atexit(&Utils::FlushLog);
+		}
+
+		bool Reserve(uint32_t Count, bool bWait, uint64_t& OutputPosition)
+		{
+			uint64_t Position = Head.load(std::memory_order_relaxed);
+			while (true)
+			{
+				bool bFree = true;
+				for (uint32_t Index = 0; Index < Count && bFree; ++Index)
+				{
+					bFree = Slots[(Position + Index) & (LogSlotCount - 1)].Sequence.load(std::memory_order_acquire) == Position + Index;
+				}
+
+				if (!bFree)
+				{
+					const uint64_t Current = Head.load(std::memory_order_relaxed);
+					if (Current != Position)
+					{
+						// another producer took these slots
+						Position = Current;
+						continue;
+					}
+					if (!bWait)
+					{
+						Dropped.fetch_add(1, std::memory_order_relaxed);
+						return false;
+					}
+					// the queue is full, the consumer frees it in a moment
+					WorkerCondition.notify_one();
+					std::this_thread::yield();
+					Position = Head.load(std::memory_order_relaxed);
+					continue;
+				}
+
+				if (Head.compare_exchange_weak(Position, Position + Count, std::memory_order_relaxed))
+				{
+					OutputPosition = Position;
+					return true;
+				}
+			}
+		}
+
+		uint8_t* GetPayload(uint64_t Position)
+		{
+			return Slots[Position & (LogSlotCount - 1)].Payload;
+		}
+
+		void Publish(uint64_t Position, uint32_t Count)
+		{
+			// the first slot goes last, the consumer sees the whole record once it sees the first slot
+			for (uint32_t Index = Count; Index-- > 0;)
+			{
+				Slots[(Position + Index) & (LogSlotCount - 1)].Sequence.store(Position + Index + 1, std::memory_order_release);
+			}
+		}
+
+		void SetFile(const std::filesystem::path& FilePath)
+		{
+			std::unique_lock<std::mutex> Lock(SinkMutex);
+			std::error_code ec;
+			std::filesystem::create_directories(FilePath.parent_path(), ec);
+			File.close();
+			File.open(FilePath, std::ios::out | std::ios::trunc);
+		}
+
+		void GetHistory(std::vector<std::string>& OutputLines)
+		{
+			std::unique_lock<std::mutex> Lock(SinkMutex);
+			OutputLines.assign(History.begin(), History.end());
+		}
+
+		void Flush()
+		{
+			const uint64_t Position = Head.load(std::memory_order_acquire);
+			std::unique_lock<std::mutex> Lock(WorkerMutex);
+			WorkerCondition.notify_all();
+			// the consumer signals when it runs dry, a busy queue is checked every millisecond
+			while (!FlushedCondition.wait_for(Lock, std::chrono::milliseconds(1), [this, Position]() { return Tail.load(std::memory_order_acquire) >= Position; }))
+			{
+				WorkerCondition.notify_all();
+			}
+
+			std::unique_lock<std::mutex> SinkLock(SinkMutex);
+			std::cout.flush();
+			File.flush();
+		}
+
+		void WriteLine(ELogCategory::Type Category, LogVerbosity::Type Verbosity, std::string_view Line)
+		{
+			std::unique_lock<std::mutex> Lock(SinkMutex);
+			WriteConsole(Verbosity, Line);
+			if (File.is_open())
+			{
+				File << '[' << Utils::ToString(Category) << "] " << Line << '\n';
+				if (Verbosity <= LogVerbosity::Error)
+				{
+					File.flush();
+				}
+			}
+			History.emplace_back(Line);
+			if (History.size() > LogHistorySize)
+			{
+				History.pop_front();
+			}
+		}
+
+	private:
+		bool Pop(std::vector<uint8_t>& Buffer)
+		{
+			const uint64_t Position = Tail.load(std::memory_order_relaxed);
+			FLogSlot& First = Slots[Position & (LogSlotCount - 1)];
+			if (First.Sequence.load(std::memory_order_acquire) != Position + 1)
+			{
+				return false;
+			}
+
+			Utils::FLogRecord Record;
+			std::memcpy(&Record, First.Payload, sizeof(Record));
+			const uint32_t Count = (Record.Size + LogSlotPayload - 1) / LogSlotPayload;
+
+			Buffer.resize(size_t(Count) * LogSlotPayload);
+			for (uint32_t Index = 0; Index < Count; ++Index)
+			{
+				FLogSlot& Slot = Slots[(Position + Index) & (LogSlotCount - 1)];
+				std::memcpy(Buffer.data() + size_t(Index) * LogSlotPayload, Slot.Payload, LogSlotPayload);
+				Slot.Sequence.store(Position + Index + LogSlotCount, std::memory_order_release);
+			}
+			Tail.store(Position + Count, std::memory_order_release);
+			return true;
+		}
+
+		void Worker_Execution()
+		{
+			std::vector<uint8_t> Buffer;
+			std::string Line;
+			while (true)
+			{
+				if (!Pop(Buffer))
+				{
+					const uint32_t DroppedCount = Dropped.exchange(0, std::memory_order_relaxed);
+					if (DroppedCount > 0)
+					{
+						WriteLine(ELogCategory::General, LogVerbosity::Warning, std::format("[Log] {} messages were dropped, the queue was full.", DroppedCount));
+					}
+
+					std::unique_lock<std::mutex> Lock(WorkerMutex);
+					FlushedCondition.notify_all();
+					// producers don't signal every record, the queue is polled while it is idle
+					WorkerCondition.wait_for(Lock, std::chrono::milliseconds(5));
+					continue;
+				}
+
+				Utils::FLogRecord Record;
+				std::memcpy(&Record, Buffer.data(), sizeof(Record));
+
+				Line.clear();
+				const std::string_view Format(Record.Format, Record.FormatSize);
+				try
+				{
+					Record.Decoder(Line, Format, Buffer.data() + sizeof(Record));
+				}
+				catch (const std::exception& Exception)
+				{
+					Line = std::format("{} <{}>", Format, Exception.what());
+				}
+				WriteLine(ELogCategory::Type(Record.Category), LogVerbosity::Type(Record.Verbosity), Line);
+			}
+		}
+
+		void WriteConsole(LogVerbosity::Type Verbosity, std::string_view Line)
+		{
+#ifdef _WIN32
+			WORD Color;
+			switch (Verbosity)
+			{
+			case LogVerbosity::Fatal:
+			case LogVerbosity::Error:	Color = FOREGROUND_RED;							break;
+			case LogVerbosity::Warning:	Color = FOREGROUND_BLUE;						break;
+			case LogVerbosity::Display:	Color = FOREGROUND_RED | FOREGROUND_GREEN;		break;
+			case LogVerbosity::Log:		Color = FOREGROUND_BLUE | FOREGROUND_RED | FOREGROUND_GREEN;	break;
+			default:					Color = FOREGROUND_BLUE | FOREGROUND_GREEN;		break;
+			}
+			HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
+			SetConsoleTextAttribute(hConsole, Color);
+			std::cout << Line << std::endl;
+			SetConsoleTextAttribute(hConsole, FOREGROUND_BLUE | FOREGROUND_RED | FOREGROUND_GREEN);
+#else
+			const char* Color;
+			switch (Verbosity)
+			{
+			case LogVerbosity::Fatal:
+			case LogVerbosity::Error:	Color = "\x1b[31m";	break;
+			case LogVerbosity::Warning:	Color = "\x1b[34m";	break;
+			case LogVerbosity::Display:	Color = "\x1b[33m";	break;
+			case LogVerbosity::Log:		Color = "\x1b[0m";	break;
+			default:					Color = "\x1b[36m";	break;
+			}
+			std::cout << Color << Line << "\x1b[0m" << std::endl;
+#endif
+		}
+
+		std::unique_ptr<FLogSlot[]> Slots;
+		alignas(LogSlotSize) std::atomic<uint64_t> Head;
+		alignas(LogSlotSize) std::atomic<uint64_t> Tail;
+		std::atomic<uint32_t> Dropped;
+
+		std::mutex WorkerMutex;
+		std::condition_variable WorkerCondition;
+		std::condition_variable FlushedCondition;
+		std::thread Worker;
+
+		std::mutex SinkMutex;
+		std::ofstream File;
+		std::deque<std::string> History;
+	};
+
+	static const char* CategoryNames[ELogCategory::MAX] =
+	{
+		"General",
+		"Device",
+		"Emulation",
+		"Render",
+		"Sprite",
+		"IO",
+	};
+
+	static const char* VerbosityNames[] =
+	{
+		"NoLogging",
+		"Fatal",
+		"Error",
+		"Warning",
+		"Display",
+		"Log",
+		"Verbose",
+		"VeryVerbose",
+	};
+}
+
+bool Utils::FLogWriter::Begin(const FLogRecord& Record)
+{
+	SlotCount = (Record.Size + LogSlotPayload - 1) / LogSlotPayload;
+	Offset = 0;
+	if (!FLogger::Get().Reserve(SlotCount, Record.Verbosity <= LogVerbosity::Error, Position))
+	{
+		return false;
+	}
+	Write(&Record, sizeof(Record));
+	return true;
+}
+
+void Utils::FLogWriter::Write(const void* Data, size_t Size)
+{
+	FLogger& Logger = FLogger::Get();
+	const uint8_t* Source = static_cast<const uint8_t*>(Data);
+	while (Size > 0)
+	{
+		const size_t SlotOffset = Offset % LogSlotPayload;
+		const size_t Chunk = (std::min)(Size, size_t(LogSlotPayload) - SlotOffset);
+		std::memcpy(Logger.GetPayload(Position + Offset / LogSlotPayload) + SlotOffset, Source, Chunk);
+		Source += Chunk;
+		Offset += Chunk;
+		Size -= Chunk;
+	}
+}
+
+void Utils::FLogWriter::End()
+{
+	FLogger::Get().Publish(Position, SlotCount);
+}
+
+const char* Utils::ToString(ELogCategory::Type Category)
+{
+	return Category < ELogCategory::MAX ? CategoryNames[Category] : "";
+}
+
+const char* Utils::ToString(LogVerbosity::Type Verbosity)
+{
+	return Verbosity >= 0 && Verbosity < int32_t(std::size(VerbosityNames)) ? VerbosityNames[Verbosity] : "";
+}
+
+void Utils::SetLogVerbosity(ELogCategory::Type Category, LogVerbosity::Type Verbosity)
+{
+	if (Category < ELogCategory::MAX)
+	{
+		LogCategoryVerbosity[Category].store(uint8_t(Verbosity), std::memory_order_relaxed);
+	}
+}
+
+void Utils::ParseLogVerbosity(std::string_view Settings)
+{
+	auto Trim = [](std::string_view Text)
+		{
+			const size_t First = Text.find_first_not_of(" \t");
+			const size_t Last = Text.find_last_not_of(" \t");
+			return First == std::string_view::npos ? std::string_view() : Text.substr(First, Last - First + 1);
+		};
+
+	while (!Settings.empty())
+	{
+		const size_t End = Settings.find_first_of(", ;");
+		const std::string_view Pair = Settings.substr(0, End);
+		Settings = End == std::string_view::npos ? std::string_view() : Settings.substr(End + 1);
+
+		const size_t Separator = Pair.find('=');
+		if (Separator == std::string_view::npos)
+		{
+			continue;
+		}
+
+		const std::string_view CategoryName = Trim(Pair.substr(0, Separator));
+		const std::string_view VerbosityName = Trim(Pair.substr(Separator + 1));
+		for (int32_t Category = 0; Category < ELogCategory::MAX; ++Category)
+		{
+			if (CategoryName != CategoryNames[Category])
+			{
+				continue;
+			}
+			for (int32_t Verbosity = 0; Verbosity < int32_t(std::size(VerbosityNames)); ++Verbosity)
+			{
+				if (VerbosityName == VerbosityNames[Verbosity])
+				{
+					SetLogVerbosity(ELogCategory::Type(Category), LogVerbosity::Type(Verbosity));
+					break;
+				}
+			}
+		}
+	}
+}
+
+void Utils::SetLogFile(const std::filesystem::path& FilePath)
+{
+	FLogger::Get().SetFile(FilePath);
+}
+
+void Utils::GetLogHistory(std::vector<std::string>& OutputLines)
+{
+	FLogger::Get().GetHistory(OutputLines);
+}
+
+void Utils::FlushLog()
+{
+	FLogger::Get().Flush();
+}
+
+void Utils::LogLine(ELogCategory::Type Category, LogVerbosity::Type Verbosity, std::string_view Line)
+{
+	// keeps the order with the records already queued
+	FLogger& Logger = FLogger::Get();
+	Logger.Flush();
+	Logger.WriteLine(Category, Verbosity, Line);
+}
+
+size_t Utils::GetLogRecordLimit()
+{
+	return size_t(LogRecordMaxSlots) * LogSlotPayload;
+}
@@ -1,8 +1,16 @@
 #pragma once
 
-#include <mutex>
+#include <tuple>
+#include <atomic>
 #include <format>
-#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <filesystem>
+#include <string_view>
+#include <type_traits>
 
 namespace LogVerbosity
 {
@@ -19,62 +27,227 @@ namespace LogVerbosity
 	};
 }
 
+namespace ELogCategory
+{
+	enum Type : uint8_t
+	{
+		General,
+		Device,
+		Emulation,
+		Render,
+		Sprite,
+		IO,
+
+		MAX
+	};
+}
+
+// asynchronous logging
+//
+// a call enqueues a compact record: the address of the literal format string, a decoder instantiated
+// for the argument types and the arguments themselves (numbers by value, text as length and bytes),
+// a background thread formats the records and writes them to the console, the log file and the memory history.
+// the arguments are not evaluated at all when the category is below the verbosity of the call
 namespace Utils
-{	
-	#define CONSOLE_BLACK	(0)
-	#define CONSOLE_BLUE	(FOREGROUND_BLUE)
-	#define CONSOLE_RED		(FOREGROUND_RED)
-	#define CONSOLE_GREEN	(FOREGROUND_BLUE | FOREGROUND_GREEN)
-	#define CONSOLE_MAGENTA	(FOREGROUND_RED)
-	#define CONSOLE_YELLOW	(FOREGROUND_RED | FOREGROUND_GREEN)
-	#define CONSOLE_CYAN	(FOREGROUND_BLUE | FOREGROUND_GREEN)
-	#define CONSOLE_WHITE	(FOREGROUND_BLUE | FOREGROUND_RED | FOREGROUND_GREEN)
-
-	inline void SetConsoleColor(int32_t TextColor)
+{
+	using FLogDecoder = void (*)(std::string& Output, std::string_view Format, const uint8_t* Arguments);
+
+	struct FLogRecord
+	{
+		uint32_t Size;			// record and arguments in bytes
+		uint8_t Category;
+		uint8_t Verbosity;
+		uint16_t Reserved;
+		uint32_t FormatSize;
+		const char* Format;
+		FLogDecoder Decoder;
+	};
+
+	// writes a record into the lock-free queue, the record may span several slots
+	class FLogWriter
+	{
+	public:
+		// false if the queue is full and the record is dropped, errors wait for free space instead
+		bool Begin(const FLogRecord& Record);
+		void Write(const void* Data, size_t Size);
+		void End();
+
+	private:
+		uint64_t Position = 0;
+		uint32_t SlotCount = 0;
+		size_t Offset = 0;
+	};
+
+	inline std::atomic<uint8_t> LogCategoryVerbosity[ELogCategory::MAX] =
+	{
+		LogVerbosity::Log,
+		LogVerbosity::Log,
+		LogVerbosity::Log,
+		LogVerbosity::Log,
+		LogVerbosity::Log,
+		LogVerbosity::Log,
+	};
+
+	inline bool IsLogEnabled(ELogCategory::Type Category, LogVerbosity::Type Verbosity)
+	{
+		return Verbosity <= LogCategoryVerbosity[Category].load(std::memory_order_relaxed);
+	}
+
+	const char* ToString(ELogCategory::Type Category);
+	const char* ToString(LogVerbosity::Type Verbosity);
+	void SetLogVerbosity(ELogCategory::Type Category, LogVerbosity::Type Verbosity);
+	// "Category=Verbosity" pairs separated by commas or spaces, e.g. "Emulation=Warning, Device=Verbose"
+	void ParseLogVerbosity(std::string_view Settings);
+
+	void SetLogFile(const std::filesystem::path& FilePath);
+	// last formatted lines, the oldest first
+	void GetLogHistory(std::vector<std::string>& OutputLines);
+	// blocks until everything logged before the call is written
+	void FlushLog();
+
+	// the record doesn't fit into the queue, it is formatted by the caller and written right away
+	void LogLine(ELogCategory::Type Category, LogVerbosity::Type Verbosity, std::string_view Line);
+	size_t GetLogRecordLimit();
+
+	namespace LogArgument
 	{
-		HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
-		SetConsoleTextAttribute(hConsole, TextColor);
+		template<typename T>
+		using TDecay = std::remove_cvref_t<T>;
+
+		template<typename T>
+		inline constexpr bool bText =
+			std::is_same_v<TDecay<T>, std::string> ||
+			std::is_same_v<TDecay<T>, std::string_view> ||
+			std::is_same_v<std::decay_t<T>, const char*> ||
+			std::is_same_v<std::decay_t<T>, char*>;
+
+		template<typename T>
+		inline constexpr bool bValue =
+			std::is_arithmetic_v<TDecay<T>> ||
+			std::is_same_v<TDecay<T>, const void*> ||
+			std::is_same_v<TDecay<T>, void*>;
+
+		// what the record keeps, any other type is formatted with "{}" on the caller side and kept as text
+		template<typename T>
+		using TStored = std::conditional_t<bValue<T>, TDecay<T>, std::string_view>;
+
+		template<typename T>
+		auto Prepare(const T& Argument)
+		{
+			if constexpr (bValue<T>)
+			{
+				return TDecay<T>(Argument);
+			}
+			else if constexpr (bText<T>)
+			{
+				return std::string_view(Argument);
+			}
+			else
+			{
+				return std::format("{}", Argument);
+			}
+		}
+
+		template<typename T>
+		size_t GetSize(const T& Prepared)
+		{
+			if constexpr (std::is_arithmetic_v<T> || std::is_pointer_v<T>)
+			{
+				return sizeof(T);
+			}
+			else
+			{
+				return sizeof(uint32_t) + Prepared.size();
+			}
+		}
+
+		template<typename T>
+		void Write(FLogWriter& Writer, const T& Prepared)
+		{
+			if constexpr (std::is_arithmetic_v<T> || std::is_pointer_v<T>)
+			{
+				Writer.Write(&Prepared, sizeof(T));
+			}
+			else
+			{
+				const uint32_t Size = uint32_t(Prepared.size());
+				Writer.Write(&Size, sizeof(Size));
+				Writer.Write(Prepared.data(), Size);
+			}
+		}
+
+		template<typename T>
+		T Read(const uint8_t*& Data)
+		{
+			if constexpr (std::is_same_v<T, std::string_view>)
+			{
+				uint32_t Size;
+				std::memcpy(&Size, Data, sizeof(Size));
+				const std::string_view Text(reinterpret_cast<const char*>(Data + sizeof(Size)), Size);
+				Data += sizeof(Size) + Size;
+				return Text;
+			}
+			else
+			{
+				T Value;
+				std::memcpy(&Value, Data, sizeof(T));
+				Data += sizeof(T);
+				return Value;
+			}
+		}
+
+		template<typename... Args>
+		void Decode(std::string& Output, std::string_view Format, const uint8_t* Arguments)
+		{
+			// the braced list reads the arguments in order
+			std::tuple<TStored<Args>...> Values{ Read<TStored<Args>>(Arguments)... };
+			std::apply(
+				[&Output, Format](auto&... Value)
+				{
+					std::vformat_to(std::back_inserter(Output), Format, std::make_format_args(Value...));
+				}, Values);
+		}
 	}
 
 	template <typename... Args>
-	void Log(LogVerbosity::Type Verbosity, const std::string& _fmt, Args&&... _Args)
+	void Log(ELogCategory::Type Category, LogVerbosity::Type Verbosity, std::format_string<Args...> Format, Args&&... InArgs)
 	{
-		static std::mutex LogMutex;
+		const std::string_view FormatView = Format.get();
+		const auto Prepared = std::make_tuple(LogArgument::Prepare(InArgs)...);
+
+		size_t Size = sizeof(FLogRecord);
+		std::apply([&Size](const auto&... Argument) { ((Size += LogArgument::GetSize(Argument)), ...); }, Prepared);
+		if (Size > GetLogRecordLimit())
+		{
+			LogLine(Category, Verbosity, std::vformat(FormatView, std::make_format_args(InArgs...)));
+			return;
+		}
+
+		FLogRecord Record;
+		Record.Size = uint32_t(Size);
+		Record.Category = Category;
+		Record.Verbosity = uint8_t(Verbosity);
+		Record.Reserved = 0;
+		Record.FormatSize = uint32_t(FormatView.size());
+		Record.Format = FormatView.data();
+		Record.Decoder = &LogArgument::Decode<Args...>;
 
-		LogMutex.lock();
-		switch (Verbosity)
+		FLogWriter Writer;
+		if (Writer.Begin(Record))
 		{
-		case LogVerbosity::Error:
-			SetConsoleColor(CONSOLE_RED);
-			break;
-		case LogVerbosity::Warning:
-			SetConsoleColor(CONSOLE_BLUE);
-			break;
-		case LogVerbosity::Display:
-			SetConsoleColor(CONSOLE_YELLOW);
-			break;
-		case LogVerbosity::Log:
-			SetConsoleColor(CONSOLE_WHITE);
-			break;
-		default:
-			SetConsoleColor(CONSOLE_CYAN);
-			break;
+			std::apply([&Writer](const auto&... Argument) { (LogArgument::Write(Writer, Argument), ...); }, Prepared);
+			Writer.End();
 		}
-		std::cout << std::vformat(_fmt, std::make_format_args(_Args...)) << std::endl;
-		SetConsoleColor(CONSOLE_WHITE);
-		LogMutex.unlock();
 	}
 }
 
 #ifndef IMGUI_DISABLE_LOG
-#define LOG(...)						{ if (FrameworkConfig.bLog) { Utils::Log(LogVerbosity::Log, __VA_ARGS__); } }
-#define LOG_DISPLAY(...)				{ if (FrameworkConfig.bLog) { Utils::Log(LogVerbosity::Display, __VA_ARGS__); } }
-#define LOG_WARNING(...)				{ if (FrameworkConfig.bLog) { Utils::Log(LogVerbosity::Warning, __VA_ARGS__); } }
-#define LOG_ERROR(...)					{ if (FrameworkConfig.bLog) { Utils::Log(LogVerbosity::Error, __VA_ARGS__);} }
+#define LOG_CATEGORY(Category, Verbosity, ...)	{ if (FrameworkConfig.bLog && Utils::IsLogEnabled(ELogCategory::Category, LogVerbosity::Verbosity)) { Utils::Log(ELogCategory::Category, LogVerbosity::Verbosity, __VA_ARGS__); } }
 #else
-#define LOG(...)
-#define LOG_DISPLAY(...)
-#define LOG_WARNING(...)
-#define LOG_ERROR(...)	
+#define LOG_CATEGORY(Category, Verbosity, ...)
 #endif
 
+#define LOG(...)						LOG_CATEGORY(General, Log, __VA_ARGS__)
+#define LOG_DISPLAY(...)				LOG_CATEGORY(General, Display, __VA_ARGS__)
+#define LOG_WARNING(...)				LOG_CATEGORY(General, Warning, __VA_ARGS__)
+#define LOG_ERROR(...)					LOG_CATEGORY(General, Error, __VA_ARGS__)
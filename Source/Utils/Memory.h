@@ -19,7 +19,13 @@ namespace Memory
 	{
 		for (FDataBlock& DataBlock : Snapshot.DataBlocks)
 		{
-			std::ranges::copy(InRawData.begin() + DataBlock.PlacementAddress, InRawData.begin() + DataBlock.Data.size(), DataBlock.Data.begin());
+			if (DataBlock.PlacementAddress >= InRawData.size())
+			{
+				continue;
+			}
+
+			const size_t CopySize = FMath::Min(DataBlock.Data.size(), InRawData.size() - DataBlock.PlacementAddress);
+			std::ranges::copy(InRawData.begin() + DataBlock.PlacementAddress, InRawData.begin() + DataBlock.PlacementAddress + CopySize, DataBlock.Data.begin());
 		}
 	}
 
@@ -1,123 +1,254 @@
 #include "Name.h"
 
+#include <atomic>
+#include <mutex>
+
 namespace
 {
 	static const char* EmptyName = "";
-	static constexpr uint32_t FNameMaxBlockBits = 13;
-	static constexpr uint32_t FNameMaxBlocks = 1 << FNameMaxBlockBits;
 
-	static std::atomic_int Counter = 0;
-	static std::mutex NameMutex;
+	// interned string, lives in the arena of its shard until the program exits
+	struct FNameEntry
+	{
+		uint64_t Hash;
+		uint32_t Length;
+		char Text[1];
+	};
 
-	static uint32_t CurrentBlock = 0;
-	static char* Blocks[FNameMaxBlocks] = {};
-}
+	// names are resolved by ID through a directory of fixed-size chunks,
+	// a chunk is never moved once published, so readers need no lock
+	static constexpr uint32_t FNameChunkBits = 14;
+	static constexpr uint32_t FNameChunkSize = 1 << FNameChunkBits;
+	static constexpr uint32_t FNameMaxChunks = (uint32_t(INDEX_NONE) >> FNameChunkBits) + 1;
 
-const char* GetName(uint32_t Index)
-{
-	return Index < CurrentBlock ? Blocks[Index] : EmptyName;
-}
+	struct FNameChunk
+	{
+		std::atomic<const FNameEntry*> Entries[FNameChunkSize];
+	};
 
-uint32_t AddName(const char* _Name)
-{
-	NameMutex.lock();
+	static std::atomic<FNameChunk*> Chunks[FNameMaxChunks] = {};
+	static std::atomic<uint32_t> NameCounter = 0;
 
-	const size_t LengthString = std::strlen(_Name);
-	char* StrPtr = new char[LengthString + 1];
-	const uint32_t Index = CurrentBlock;
+	// open addressing table of IDs + 1, zero is an empty slot
+	struct FNameHashTable
+	{
+		uint32_t Mask;
+		uint32_t Count;
+		std::unique_ptr<std::atomic<uint32_t>[]> Slots;
 
-	std::memcpy(StrPtr, _Name, LengthString);
-	*(StrPtr + LengthString) = '\0';
-	Blocks[CurrentBlock++] = StrPtr;
+		explicit FNameHashTable(uint32_t Capacity)
+			: Mask(Capacity - 1)
+			, Count(0)
+			, Slots(new std::atomic<uint32_t>[Capacity])
+		{
+			for (uint32_t Index = 0; Index < Capacity; ++Index)
+			{
+				Slots[Index].store(0, std::memory_order_relaxed);
+			}
+		}
+	};
 
-	NameMutex.unlock();
+	// inserts are striped over the shards by hash, every shard grows on its own and owns its string arena,
+	// a grown table is published atomically and the old one is kept for the readers still probing it
+	struct FNameShard
+	{
+		static constexpr size_t ArenaBlockSize = 64 * 1024;
+		static constexpr uint32_t InitialCapacity = 256;
 
-	return Index;
-}
+		std::mutex Mutex;
+		std::atomic<FNameHashTable*> Table = nullptr;
+		std::vector<std::unique_ptr<FNameHashTable>> Tables;
+		std::vector<std::unique_ptr<uint8_t[]>> Arena;
+		uint8_t* ArenaBlock = nullptr;
+		size_t ArenaUsed = 0;
 
-uint32_t FindName(const char* _Name)
-{
-	for (uint32_t i = 0; i < CurrentBlock; ++i)
+		FNameEntry* Allocate(size_t Size)
+		{
+			Size = (Size + alignof(FNameEntry) - 1) & ~(alignof(FNameEntry) - 1);
+			if (Size > ArenaBlockSize)
+			{
+				// an oversized name gets a block of its own, the current block stays open
+				Arena.push_back(std::make_unique<uint8_t[]>(Size));
+				return reinterpret_cast<FNameEntry*>(Arena.back().get());
+			}
+			if (ArenaBlock == nullptr || ArenaUsed + Size > ArenaBlockSize)
+			{
+				Arena.push_back(std::make_unique<uint8_t[]>(ArenaBlockSize));
+				ArenaBlock = Arena.back().get();
+				ArenaUsed = 0;
+			}
+			FNameEntry* Entry = reinterpret_cast<FNameEntry*>(ArenaBlock + ArenaUsed);
+			ArenaUsed += Size;
+			return Entry;
+		}
+	};
+
+	static constexpr uint32_t FNameShardBits = 4;
+	static FNameShard Shards[1 << FNameShardBits];
+
+	uint64_t HashName(std::string_view Name)
 	{
-		char* StrPtr = Blocks[i];
-		if (std::strcmp(StrPtr, _Name) == 0)
+		uint64_t Hash = 0xCBF29CE484222325ull;
+		for (const char Char : Name)
 		{
-			return i;
+			Hash ^= uint8_t(Char);
+			Hash *= 0x100000001B3ull;
 		}
+		return Hash;
 	}
-	return INDEX_NONE;
-}
 
-void Release()
-{
-	if (--Counter > 0)
+	const FNameEntry* GetEntry(uint32_t Index)
 	{
-		return;
+		const FNameChunk* Chunk = Chunks[Index >> FNameChunkBits].load(std::memory_order_acquire);
+		return Chunk ? Chunk->Entries[Index & (FNameChunkSize - 1)].load(std::memory_order_acquire) : nullptr;
 	}
 
-	// remove all
-	for (uint32_t i = 0; i < CurrentBlock; ++i)
+	bool IsEqual(const FNameEntry* Entry, uint64_t Hash, std::string_view Name)
 	{
-		char* StrPtr = Blocks[i];
-		if (StrPtr)
+		return Entry->Hash == Hash && Entry->Length == Name.size() && std::memcmp(Entry->Text, Name.data(), Name.size()) == 0;
+	}
+
+	uint32_t FindName(const FNameHashTable* Table, uint64_t Hash, std::string_view Name)
+	{
+		if (Table == nullptr)
 		{
-			delete[] StrPtr;
-			Blocks[i] = nullptr;
+			return INDEX_NONE;
 		}
-	}
-}
 
-FName::FName()
-	: ID(INDEX_NONE)
-{
-	Counter++;
-}
+		// the low bits of the hash picked the shard
+		for (uint32_t Slot = uint32_t(Hash >> FNameShardBits) & Table->Mask;; Slot = (Slot + 1) & Table->Mask)
+		{
+			const uint32_t Value = Table->Slots[Slot].load(std::memory_order_acquire);
+			if (Value == 0)
+			{
+				return INDEX_NONE;
+			}
+			const FNameEntry* Entry = GetEntry(Value - 1);
+			if (Entry && IsEqual(Entry, Hash, Name))
+			{
+				return Value - 1;
+			}
+		}
+	}
 
-FName::FName(const char* _Name)
-{
-	if (CurrentBlock < FNameMaxBlocks)
+	void InsertSlot(FNameHashTable& Table, uint64_t Hash, uint32_t Index)
 	{
-		ID = FindName(_Name);
-		if (ID == INDEX_NONE)
+		uint32_t Slot = uint32_t(Hash >> FNameShardBits) & Table.Mask;
+		while (Table.Slots[Slot].load(std::memory_order_relaxed) != 0)
 		{
-			ID = AddName(_Name);
+			Slot = (Slot + 1) & Table.Mask;
 		}
+		Table.Slots[Slot].store(Index + 1, std::memory_order_release);
+		++Table.Count;
 	}
-	else
+
+	void PublishEntry(uint32_t Index, const FNameEntry* Entry)
 	{
-		ID = INDEX_NONE;
+		std::atomic<FNameChunk*>& Chunk = Chunks[Index >> FNameChunkBits];
+		FNameChunk* Current = Chunk.load(std::memory_order_acquire);
+		if (Current == nullptr)
+		{
+			// the chunk may be created by another shard at the same time, one of them wins
+			FNameChunk* NewChunk = new FNameChunk();
+			if (Chunk.compare_exchange_strong(Current, NewChunk, std::memory_order_acq_rel))
+			{
+				Current = NewChunk;
+			}
+			else
+			{
+				delete NewChunk;
+			}
+		}
+		Current->Entries[Index & (FNameChunkSize - 1)].store(Entry, std::memory_order_release);
 	}
-	Counter++;
-}
 
-FName::FName(const std::string& _StrName)
-{
-	if (CurrentBlock < FNameMaxBlocks)
+	uint32_t AddName(FNameShard& Shard, uint64_t Hash, std::string_view Name)
 	{
-		
-		ID = FindName(_StrName.c_str());
-		if (ID == INDEX_NONE)
+		std::unique_lock<std::mutex> Lock(Shard.Mutex);
+
+		// another thread may have added it after the lock-free lookup
+		FNameHashTable* Table = Shard.Table.load(std::memory_order_relaxed);
+		uint32_t Index = FindName(Table, Hash, Name);
+		if (Index != INDEX_NONE)
 		{
-			ID = AddName(_StrName.c_str());
+			return Index;
 		}
+
+		Index = NameCounter.fetch_add(1, std::memory_order_relaxed);
+		if (Index == uint32_t(INDEX_NONE))
+		{
+			return INDEX_NONE;
+		}
+
+		FNameEntry* Entry = Shard.Allocate(offsetof(FNameEntry, Text) + Name.size() + 1);
+		Entry->Hash = Hash;
+		Entry->Length = uint32_t(Name.size());
+		std::memcpy(Entry->Text, Name.data(), Name.size());
+		Entry->Text[Name.size()] = '\0';
+		PublishEntry(Index, Entry);
+
+		// keeps the load factor under a half
+		if (Table == nullptr || (Table->Count + 1) * 2 > Table->Mask + 1)
+		{
+			const uint32_t Capacity = Table ? (Table->Mask + 1) * 2 : FNameShard::InitialCapacity;
+			std::unique_ptr<FNameHashTable> NewTable = std::make_unique<FNameHashTable>(Capacity);
+			if (Table)
+			{
+				for (uint32_t Slot = 0; Slot <= Table->Mask; ++Slot)
+				{
+					const uint32_t Value = Table->Slots[Slot].load(std::memory_order_relaxed);
+					if (Value != 0)
+					{
+						InsertSlot(*NewTable, GetEntry(Value - 1)->Hash, Value - 1);
+					}
+				}
+			}
+			Table = NewTable.get();
+			Shard.Tables.push_back(std::move(NewTable));
+			InsertSlot(*Table, Hash, Index);
+			Shard.Table.store(Table, std::memory_order_release);
+		}
+		else
+		{
+			InsertSlot(*Table, Hash, Index);
+		}
+		return Index;
 	}
-	else
+
+	uint32_t FindOrAddName(std::string_view Name)
 	{
-		ID = INDEX_NONE;
+		const uint64_t Hash = HashName(Name);
+		FNameShard& Shard = Shards[Hash & ((1 << FNameShardBits) - 1)];
+
+		const uint32_t Index = FindName(Shard.Table.load(std::memory_order_acquire), Hash, Name);
+		return Index != INDEX_NONE ? Index : AddName(Shard, Hash, Name);
 	}
-	Counter++;
 }
 
-FName::FName(const FName& Other)
-	: ID(Other.ID)
+const char* GetName(uint32_t Index)
 {
-	Counter++;
+	const FNameEntry* Entry = Index != INDEX_NONE ? GetEntry(Index) : nullptr;
+	return Entry ? Entry->Text : EmptyName;
 }
 
+FName::FName()
+	: ID(INDEX_NONE)
+{}
+
+FName::FName(const char* _Name)
+	: ID(FindOrAddName(_Name))
+{}
+
+FName::FName(const std::string& _StrName)
+	: ID(FindOrAddName(_StrName.c_str()))
+{}
+
+FName::FName(const FName& Other)
+	: ID(Other.ID)
+{}
+
 FName::~FName()
-{
-	Release();
-}
+{}
 
 std::string FName::ToString() const
 {
@@ -9,6 +9,9 @@ REGISTER_NAME(40, AccessToROM)
 REGISTER_NAME(50, Memory)
 REGISTER_NAME(51, EPROM)
 REGISTER_NAME(52, DRAM)
+REGISTER_NAME(60, Tape)
+REGISTER_NAME(61, Beeper)
+REGISTER_NAME(62, Keyboard)
 
 REGISTER_NAME(100, FileDialog)
 REGISTER_NAME(101, Canvas)
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <vector>
+
+// single-producer single-consumer ring, the capacity is rounded up to a power of two
+//
+// the producer owns Head and the consumer owns Tail, each reads the other's index with acquire.
+// Push/Pop move as many items as fit and return the count, nothing ever blocks
+template <typename T>
+class TRingBuffer
+{
+public:
+	TRingBuffer(size_t _Capacity)
+		: Mask(std::bit_ceil(_Capacity) - 1)
+		, Items(Mask + 1)
+		, Head(0)
+		, Tail(0)
+	{}
+
+	size_t Push(const T* Input, size_t Count)
+	{
+		const size_t CurrentHead = Head.load(std::memory_order_relaxed);
+		const size_t Free = Items.size() - (CurrentHead - Tail.load(std::memory_order_acquire));
+		Count = (std::min)(Count, Free);
+		for (size_t Index = 0; Index < Count; ++Index)
+		{
+			Items[(CurrentHead + Index) & Mask] = Input[Index];
+		}
+		Head.store(CurrentHead + Count, std::memory_order_release);
+		return Count;
+	}
+
+	size_t Pop(T* Output, size_t Count)
+	{
+		const size_t CurrentTail = Tail.load(std::memory_order_relaxed);
+		const size_t Available = Head.load(std::memory_order_acquire) - CurrentTail;
+		Count = (std::min)(Count, Available);
+		for (size_t Index = 0; Index < Count; ++Index)
+		{
+			Output[Index] = Items[(CurrentTail + Index) & Mask];
+		}
+		Tail.store(CurrentTail + Count, std::memory_order_release);
+		return Count;
+	}
+
+	// either side may ask, the answer is a snapshot; the tail is read first so it never passes the head
+	size_t Size() const
+	{
+		const size_t CurrentTail = Tail.load(std::memory_order_acquire);
+		return Head.load(std::memory_order_acquire) - CurrentTail;
+	}
+	size_t Capacity() const { return Items.size(); }
+
+private:
+	const size_t Mask;
+	std::vector<T> Items;
+
+	// the indices only grow, they are masked on access
+	alignas(64) std::atomic<size_t> Head;
+	alignas(64) std::atomic<size_t> Tail;
+};
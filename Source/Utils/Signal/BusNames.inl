@@ -166,3 +166,5 @@ REGISTER_BUS_NAME(USER_SIGNAL + 18, WE)
 
 REGISTER_BUS_NAME(USER_SIGNAL + 19, RD_ROM)
 REGISTER_BUS_NAME(USER_SIGNAL + 20, WR_ROM) // debug
+
+REGISTER_BUS_NAME(USER_SIGNAL + 21, EAR)
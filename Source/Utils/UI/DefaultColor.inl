@@ -18,6 +18,9 @@ REGISTER_COLOR(19, DISASM_CONDITION, ToVec4(0x8FF987FF))
 REGISTER_COLOR(20, DISASM_CONSTANT, ToVec4(0xAFAFAFFF))
 REGISTER_COLOR(21, DISASM_CONSTANT_OFFSET, ToVec4(0xF9FF7DFF))
 REGISTER_COLOR(22, DISASM_SYMBOL, ToVec4(0xFFFFFFFF))
+REGISTER_COLOR(23, DISASM_BG_HEAT, ToVec4(0x1C1C1CFF))
+REGISTER_COLOR(24, DISASM_HEAT_COLD, ToVec4(0x23324FFF))
+REGISTER_COLOR(25, DISASM_HEAT_HOT, ToVec4(0xC8402AFF))
 
 // CPU state
 REGISTER_COLOR(30, CPU_REGISTER, ToVec4(0x8EFFF2FF))
@@ -25,6 +28,13 @@ REGISTER_COLOR(31, CPU_SYMBOL, ToVec4(0xFFFFFFFF))
 REGISTER_COLOR(32, CPU_VALUE, ToVec4(0xAFAFAFFF))
 REGISTER_COLOR(33, CPU_VALUE_CHANGED, ToVec4(0xAF3FAFFF))
 
+// Memory dump
+REGISTER_COLOR(35, MEMDUMP_HEAT_READ, ToVec4(0x2E9E4FFF))
+REGISTER_COLOR(36, MEMDUMP_HEAT_WRITE, ToVec4(0xC83C3CFF))
+REGISTER_COLOR(37, MEMDUMP_HEAT_EXECUTE, ToVec4(0x3C64DCFF))
+REGISTER_COLOR(38, MEMDUMP_CHANGED, ToVec4(0xFFD040FF))
+REGISTER_COLOR(39, MEMDUMP_REWRITTEN, ToVec4(0xC8643CFF))
+
 // Oscillograph
 REGISTER_COLOR(40, OSCIL_FRAME_BACKGROUND, ToVec4(0x101010FF))
 REGISTER_COLOR(41, OSCIL_AREA_BACKGROUND, ToVec4(0x202020FF))
\ No newline at end of file
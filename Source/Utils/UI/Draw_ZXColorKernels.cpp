@@ -0,0 +1,332 @@
+#include "Draw_ZXColorKernels.h"
+#include <Utils/UI/Draw.h>
+#include <Utils/UI/Draw_ZXColorVideo.h>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	#define ZX_COLOR_KERNELS_X86 1
+	#include <immintrin.h>
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+		#define ZX_TARGET_AVX2
+	#else
+		#include <cpuid.h>
+		#define ZX_TARGET_AVX2 __attribute__((target("avx2")))
+	#endif
+#else
+	#define ZX_COLOR_KERNELS_X86 0
+#endif
+
+namespace
+{
+	static constexpr int32_t PaletteSize = UI::EZXSpectrumColor::MAX;
+
+	// palette in the memory layout of RGBA pixels
+	struct FPalette
+	{
+		uint32_t Color[PaletteSize];
+		uint32_t OpaqueColor[PaletteSize];
+		uint32_t RB[PaletteSize];	// R | B << 16
+		uint32_t GA[PaletteSize];	// G | A << 16
+
+		FPalette()
+		{
+			for (int32_t Index = 0; Index < PaletteSize; ++Index)
+			{
+				Color[Index] = UI::ToU32(UI::ZXSpectrumColorRGBA[Index]);
+				OpaqueColor[Index] = UI::ToU32(UI::ZXSpectrumColorRGBA[Index] | 0xFF);
+				RB[Index] = Color[Index] & 0x00FF00FF;
+				GA[Index] = (Color[Index] >> 8) & 0x00FF00FF;
+			}
+		}
+	};
+
+	const FPalette& GetPalette()
+	{
+		static const FPalette Palette;
+		return Palette;
+	}
+
+	// direct-mapped cache of already quantized colours
+	struct FColorCache
+	{
+		static constexpr int32_t Bits = 10;
+		static constexpr int32_t Size = 1 << Bits;
+
+		uint32_t Keys[Size];
+		int8_t Values[Size];
+
+		FColorCache()
+		{
+			std::memset(Values, INDEX_NONE, sizeof(Values));
+		}
+
+		static uint32_t Slot(uint32_t Pixel)
+		{
+			return (Pixel * 0x9E3779B1u) >> (32 - Bits);
+		}
+
+		bool Find(uint32_t Pixel, uint8_t& OutIndex) const
+		{
+			const uint32_t Index = Slot(Pixel);
+			if (Values[Index] == INDEX_NONE || Keys[Index] != Pixel)
+			{
+				return false;
+			}
+			OutIndex = static_cast<uint8_t>(Values[Index]);
+			return true;
+		}
+
+		void Add(uint32_t Pixel, uint8_t Index)
+		{
+			const uint32_t Slot_ = Slot(Pixel);
+			Keys[Slot_] = Pixel;
+			Values[Slot_] = static_cast<int8_t>(Index);
+		}
+	};
+
+	uint32_t LoadPixel(const uint8_t* RawImage, size_t Index)
+	{
+		uint32_t Pixel;
+		std::memcpy(&Pixel, RawImage + Index * 4, sizeof(Pixel));
+		return Pixel;
+	}
+
+	// same metric and tie-break as UI::FindClosestColor
+	uint8_t FindClosestIndex_Scalar(uint32_t Pixel)
+	{
+		const FPalette& Palette = GetPalette();
+
+		int32_t Best = 0;
+		int32_t BestDistance = INT_MAX;
+		for (int32_t Index = 0; Index < PaletteSize; ++Index)
+		{
+			int32_t Distance = 0;
+			for (int32_t Shift = 0; Shift < 32; Shift += 8)
+			{
+				const int32_t Delta = static_cast<int32_t>((Pixel >> Shift) & 0xFF) - static_cast<int32_t>((Palette.Color[Index] >> Shift) & 0xFF);
+				Distance += Delta * Delta;
+			}
+			if (Distance < BestDistance)
+			{
+				BestDistance = Distance;
+				Best = Index;
+			}
+		}
+		return static_cast<uint8_t>(Best);
+	}
+
+#if ZX_COLOR_KERNELS_X86
+	// squared distance of 16-bit pairs: (R,B) and (G,A) through PMADDWD
+	void FindClosestIndex_SSE2(const uint8_t* RawImage, uint8_t* OutputIndices)
+	{
+		const FPalette& Palette = GetPalette();
+		const __m128i Mask = _mm_set1_epi32(0x00FF00FF);
+		const __m128i Pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(RawImage));
+		const __m128i RB = _mm_and_si128(Pixels, Mask);
+		const __m128i GA = _mm_and_si128(_mm_srli_epi32(Pixels, 8), Mask);
+
+		__m128i BestDistance = _mm_set1_epi32(INT_MAX);
+		__m128i BestIndex = _mm_setzero_si128();
+		for (int32_t Index = 0; Index < PaletteSize; ++Index)
+		{
+			const __m128i DeltaRB = _mm_sub_epi16(RB, _mm_set1_epi32(Palette.RB[Index]));
+			const __m128i DeltaGA = _mm_sub_epi16(GA, _mm_set1_epi32(Palette.GA[Index]));
+			const __m128i Distance = _mm_add_epi32(_mm_madd_epi16(DeltaRB, DeltaRB), _mm_madd_epi16(DeltaGA, DeltaGA));
+			const __m128i Less = _mm_cmplt_epi32(Distance, BestDistance);
+			BestDistance = _mm_or_si128(_mm_and_si128(Less, Distance), _mm_andnot_si128(Less, BestDistance));
+			BestIndex = _mm_or_si128(_mm_and_si128(Less, _mm_set1_epi32(Index)), _mm_andnot_si128(Less, BestIndex));
+		}
+
+		const __m128i Packed = _mm_packus_epi16(_mm_packs_epi32(BestIndex, BestIndex), _mm_setzero_si128());
+		const uint32_t Indices = static_cast<uint32_t>(_mm_cvtsi128_si32(Packed));
+		std::memcpy(OutputIndices, &Indices, sizeof(Indices));
+	}
+
+	ZX_TARGET_AVX2 void FindClosestIndex_AVX2(const uint8_t* RawImage, uint8_t* OutputIndices)
+	{
+		const FPalette& Palette = GetPalette();
+		const __m256i Mask = _mm256_set1_epi32(0x00FF00FF);
+		const __m256i Pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(RawImage));
+		const __m256i RB = _mm256_and_si256(Pixels, Mask);
+		const __m256i GA = _mm256_and_si256(_mm256_srli_epi32(Pixels, 8), Mask);
+
+		__m256i BestDistance = _mm256_set1_epi32(INT_MAX);
+		__m256i BestIndex = _mm256_setzero_si256();
+		for (int32_t Index = 0; Index < PaletteSize; ++Index)
+		{
+			const __m256i DeltaRB = _mm256_sub_epi16(RB, _mm256_set1_epi32(Palette.RB[Index]));
+			const __m256i DeltaGA = _mm256_sub_epi16(GA, _mm256_set1_epi32(Palette.GA[Index]));
+			const __m256i Distance = _mm256_add_epi32(_mm256_madd_epi16(DeltaRB, DeltaRB), _mm256_madd_epi16(DeltaGA, DeltaGA));
+			const __m256i Less = _mm256_cmpgt_epi32(BestDistance, Distance);
+			BestDistance = _mm256_blendv_epi8(BestDistance, Distance, Less);
+			BestIndex = _mm256_blendv_epi8(BestIndex, _mm256_set1_epi32(Index), Less);
+		}
+
+		const __m128i Low = _mm256_castsi256_si128(BestIndex);
+		const __m128i High = _mm256_extracti128_si256(BestIndex, 1);
+		const __m128i Packed = _mm_packus_epi16(_mm_packs_epi32(Low, High), _mm_setzero_si128());
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(OutputIndices), Packed);
+	}
+
+	ZX_TARGET_AVX2 size_t ExpandZXIndexToRGBA_AVX2(const uint8_t* IndexedData, size_t PixelCount, uint32_t* OutputRGBA, const uint32_t* Colors)
+	{
+		const __m256i Low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(Colors));
+		const __m256i High = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(Colors + 8));
+		const __m256i Seven = _mm256_set1_epi32(7);
+		const __m256i Sixteen = _mm256_set1_epi32(PaletteSize);
+
+		size_t Index = 0;
+		for (; Index + 8 <= PixelCount; Index += 8)
+		{
+			const __m256i Indices = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(IndexedData + Index)));
+			const __m256i FromLow = _mm256_permutevar8x32_epi32(Low, Indices);
+			const __m256i FromHigh = _mm256_permutevar8x32_epi32(High, Indices);
+			const __m256i Color = _mm256_blendv_epi8(FromLow, FromHigh, _mm256_cmpgt_epi32(Indices, Seven));
+			const __m256i Valid = _mm256_cmpgt_epi32(Sixteen, Indices);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(OutputRGBA + Index), _mm256_and_si256(Color, Valid));
+		}
+		return Index;
+	}
+#endif // ZX_COLOR_KERNELS_X86
+
+	UI::EConversionKernel::Type DetectConversionKernel()
+	{
+#if ZX_COLOR_KERNELS_X86
+		int32_t Info[4] = {};
+	#if defined(_MSC_VER)
+		__cpuid(Info, 0);
+		const int32_t MaxLeaf = Info[0];
+		__cpuid(Info, 1);
+	#else
+		const int32_t MaxLeaf = static_cast<int32_t>(__get_cpuid_max(0, nullptr));
+		__cpuid(1, Info[0], Info[1], Info[2], Info[3]);
+	#endif
+		const bool bSSE2 = (Info[3] & (1 << 26)) != 0;
+		const bool bOSXSAVE = (Info[2] & (1 << 27)) != 0;
+		const bool bAVX = (Info[2] & (1 << 28)) != 0;
+
+		bool bAVX2 = false;
+		if (MaxLeaf >= 7 && bOSXSAVE && bAVX)
+		{
+	#if defined(_MSC_VER)
+			const uint64_t XCR0 = _xgetbv(0);
+			__cpuidex(Info, 7, 0);
+	#else
+			uint32_t XCR0Low = 0;
+			uint32_t XCR0High = 0;
+			__asm__ ("xgetbv" : "=a"(XCR0Low), "=d"(XCR0High) : "c"(0));
+			const uint64_t XCR0 = (static_cast<uint64_t>(XCR0High) << 32) | XCR0Low;
+			__cpuid_count(7, 0, Info[0], Info[1], Info[2], Info[3]);
+	#endif
+			// the OS saves XMM and YMM state
+			bAVX2 = (XCR0 & 0x06) == 0x06 && (Info[1] & (1 << 5)) != 0;
+		}
+
+		if (bAVX2)
+		{
+			return UI::EConversionKernel::AVX2;
+		}
+		if (bSSE2)
+		{
+			return UI::EConversionKernel::SSE2;
+		}
+#endif // ZX_COLOR_KERNELS_X86
+		return UI::EConversionKernel::Scalar;
+	}
+}
+
+UI::EConversionKernel::Type UI::GetConversionKernel()
+{
+	static const EConversionKernel::Type Kernel = DetectConversionKernel();
+	return Kernel;
+}
+
+void UI::QuantizeRGBAToZXIndex(const uint8_t* RawImage, size_t PixelCount, uint8_t* OutputIndexedData, uint32_t TransparentPixel)
+{
+	FColorCache Cache;
+	const EConversionKernel::Type Kernel = GetConversionKernel();
+	const size_t BlockSize = Kernel == EConversionKernel::AVX2 ? 8 : Kernel == EConversionKernel::SSE2 ? 4 : 1;
+
+	size_t Index = 0;
+	if (BlockSize > 1)
+	{
+		for (; Index + BlockSize <= PixelCount; Index += BlockSize)
+		{
+			// exact colours already met go through the cache, the block is searched only on a miss
+			uint8_t Indices[8];
+			bool bAllFound = true;
+			for (size_t Lane = 0; Lane < BlockSize && bAllFound; ++Lane)
+			{
+				const uint32_t Pixel = LoadPixel(RawImage, Index + Lane);
+				if (Pixel == TransparentPixel)
+				{
+					Indices[Lane] = EZXSpectrumColor::Transparent;
+				}
+				else
+				{
+					bAllFound = Cache.Find(Pixel, Indices[Lane]);
+				}
+			}
+
+			if (!bAllFound)
+			{
+#if ZX_COLOR_KERNELS_X86
+				if (Kernel == EConversionKernel::AVX2)
+				{
+					FindClosestIndex_AVX2(RawImage + Index * 4, Indices);
+				}
+				else
+				{
+					FindClosestIndex_SSE2(RawImage + Index * 4, Indices);
+				}
+#endif
+				for (size_t Lane = 0; Lane < BlockSize; ++Lane)
+				{
+					const uint32_t Pixel = LoadPixel(RawImage, Index + Lane);
+					if (Pixel == TransparentPixel)
+					{
+						Indices[Lane] = EZXSpectrumColor::Transparent;
+					}
+					else
+					{
+						Cache.Add(Pixel, Indices[Lane]);
+					}
+				}
+			}
+
+			std::memcpy(OutputIndexedData + Index, Indices, BlockSize);
+		}
+	}
+
+	for (; Index < PixelCount; ++Index)
+	{
+		const uint32_t Pixel = LoadPixel(RawImage, Index);
+		uint8_t ColorIndex = EZXSpectrumColor::Transparent;
+		if (Pixel != TransparentPixel && !Cache.Find(Pixel, ColorIndex))
+		{
+			ColorIndex = FindClosestIndex_Scalar(Pixel);
+			Cache.Add(Pixel, ColorIndex);
+		}
+		OutputIndexedData[Index] = ColorIndex;
+	}
+}
+
+void UI::ExpandZXIndexToRGBA(const uint8_t* IndexedData, size_t PixelCount, uint32_t* OutputRGBA, bool bOpaque /*= false*/)
+{
+	const FPalette& Palette = GetPalette();
+	const uint32_t* Colors = bOpaque ? Palette.OpaqueColor : Palette.Color;
+
+	size_t Index = 0;
+#if ZX_COLOR_KERNELS_X86
+	if (GetConversionKernel() == EConversionKernel::AVX2)
+	{
+		Index = ExpandZXIndexToRGBA_AVX2(IndexedData, PixelCount, OutputRGBA, Colors);
+	}
+#endif
+
+	for (; Index < PixelCount; ++Index)
+	{
+		const uint8_t Value = IndexedData[Index];
+		OutputRGBA[Index] = Value < PaletteSize ? Colors[Value] : 0;
+	}
+}
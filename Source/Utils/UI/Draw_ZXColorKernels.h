@@ -0,0 +1,26 @@
+#pragma once
+
+#include <CoreMinimal.h>
+
+namespace UI
+{
+	namespace EConversionKernel
+	{
+		enum Type : uint8_t
+		{
+			Scalar,
+			SSE2,
+			AVX2,
+		};
+	}
+
+	// the best kernel supported by the CPU, detected once
+	EConversionKernel::Type GetConversionKernel();
+
+	// nearest ZX palette index for each pixel (RGBA bytes in memory, 4 channels)
+	// pixels equal to TransparentPixel (in the same memory layout) become EZXSpectrumColor::Transparent
+	void QuantizeRGBAToZXIndex(const uint8_t* RawImage, size_t PixelCount, uint8_t* OutputIndexedData, uint32_t TransparentPixel);
+
+	// ZX palette index to RGBA (ImU32); indices outside the palette become 0
+	void ExpandZXIndexToRGBA(const uint8_t* IndexedData, size_t PixelCount, uint32_t* OutputRGBA, bool bOpaque = false);
+}
@@ -1,6 +1,8 @@
 ﻿#include "Draw_ZXColorVideo.h"
 #include "Utils/Shader.h"
 #include <Utils/UI/Draw.h>
+#include <Utils/UI/Draw_ZXColorKernels.h>
+#include <Core/JobSystem.h>
 #include "Devices/ControlUnit/Interface_Display.h"
 #include "resource.h"
 #include <Window/Sprite/SpriteList.h>
@@ -492,17 +494,23 @@ bool UI::Draw_ButtonZXColorSprite(
 
 	ImGui::PushClipRect(p0, p1, true);
 	{
-		const FImage& Image = Sprite->ZXColorView->Image;
-		// callback for using our own image shader 
-		ImGui::GetWindowDrawList()->AddCallback(UI::OnDrawCallback_ZXVideo, Sprite->ZXColorView.get());
-		ImGui::GetWindowDrawList()->AddImage(
-			Sprite->ZXColorView->Image.ShaderResourceView, 
-			p0, p0 + Image.Size * Scale, 
-			ImVec2(0.0f, 0.0f), ImVec2(1.0, 1.0f),
-			ImGui::GetColorU32(TintColor));
+		// the thumbnail is a part of the shared atlas page when the sprite is packed,
+		// a sprite the atlas hasn't been rebuilt for yet has no texture of its own and shows only the background
+		UI::FZXColorView* View = Sprite->AtlasView ? Sprite->AtlasView.get() : Sprite->ZXColorView.get();
+		if (View != nullptr && View->Image.ShaderResourceView != nullptr)
+		{
+			const ImRect UV = Sprite->AtlasView ? Sprite->AtlasUV : ImRect(0.0f, 0.0f, 1.0f, 1.0f);
+			// callback for using our own image shader 
+			ImGui::GetWindowDrawList()->AddCallback(UI::OnDrawCallback_ZXVideo, View);
+			ImGui::GetWindowDrawList()->AddImage(
+				View->Image.ShaderResourceView, 
+				p0, p0 + ImVec2((float)Sprite->Width, (float)Sprite->Height) * Scale, 
+				UV.Min, UV.Max,
+				ImGui::GetColorU32(TintColor));
 
-		// reset callback for using our own image shader 
-		ImGui::GetWindowDrawList()->AddCallback(ImDrawCallback_ResetRenderState, nullptr);
+			// reset callback for using our own image shader 
+			ImGui::GetWindowDrawList()->AddCallback(ImDrawCallback_ResetRenderState, nullptr);
+		}
 		
 		for (const FButtonZXColorSpriteSettings::FLayer& Layer : Settings.Layers)
 		{
@@ -613,89 +621,312 @@ ImVec2 UI::ConverZXViewPositionToPixel(UI::FZXColorView& ZXColorView, const ImVe
 	return ImFloor((Position - ZXColorView.ViewTopLeftPixel + ZXColorView.UV.Min / ImageSizeInv * ZXColorView.Scale) / ZXColorView.Scale);
 }
 
-void UI::ConvertZXIndexColorToDisplayRGB(FImage& InOutputImage, const std::vector<uint8_t> Data)
+void UI::ConvertZXIndexColorToDisplayRGB(FImage& InOutputImage, const std::vector<uint8_t>& Data)
 {
 	if (!InOutputImage.IsValid())
 	{
 		return;
 	}
 
-	std::vector<uint32_t> RGBA(InOutputImage.GetLength());
-	for (int32_t i = 0; i < Data.size(); ++i)
-	{
-		const uint8_t& Value = Data[i];
-		const UI::EZXSpectrumColor::Type IndexColor = static_cast<UI::EZXSpectrumColor::Type>(Value);
-		const uint32_t ColorRGBA = ToU32(UI::ZXSpectrumColorRGBA[IndexColor] | 0xFF);
-		RGBA[i] = ColorRGBA;
-	}
+	// called every frame, the buffer is kept between calls
+	thread_local std::vector<uint32_t> RGBA;
+	RGBA.resize(InOutputImage.GetLength());
+	const size_t Count = ImMin(Data.size(), RGBA.size());
+	ExpandZXIndexToRGBA(Data.data(), Count, RGBA.data(), true);
+
+	// the pixels not covered by the data must not keep the previous call's colors
+	std::fill(RGBA.begin() + Count, RGBA.end(), 0u);
 
 	FImageBase& Images = FImageBase::Get();
 	Images.UpdateTexture(InOutputImage.Handle, RGBA.data());
 }
 
-void UI::GetInkPaper(const std::vector<uint8_t>& IndicesBoundary, uint8_t& OutputPaperColor, uint8_t& OutputInkColor, const UI::FConversationSettings& Settings)
+namespace
 {
-	std::map<uint8_t, int32_t> Freq;
-	for (uint8_t i : IndicesBoundary)
+	static constexpr int32_t ZXColorBins = 16;
+
+	// below this size the conversion runs on the calling thread only
+	static constexpr int32_t ParallelConversionMinPixels = 512 * 384;
+
+	typedef std::array<int32_t, ZXColorBins> FCellHistogram;
+	typedef std::array<std::array<int32_t, ZXColorBins>, ZXColorBins> FPaletteError;
+
+	// weighted squared RGB distance between palette colors
+	const FPaletteError& GetPaletteError()
 	{
-		Freq[i]++;
+		static const FPaletteError Table = []()
+			{
+				FPaletteError Result{};
+				for (int32_t A = 0; A < ZXColorBins; ++A)
+				{
+					for (int32_t B = 0; B < ZXColorBins; ++B)
+					{
+						const int32_t Distance_R = int32_t(UI::ZXSpectrumColorRGBA[A] >> 24) - int32_t(UI::ZXSpectrumColorRGBA[B] >> 24);
+						const int32_t Distance_G = int32_t((UI::ZXSpectrumColorRGBA[A] >> 16) & 0xFF) - int32_t((UI::ZXSpectrumColorRGBA[B] >> 16) & 0xFF);
+						const int32_t Distance_B = int32_t((UI::ZXSpectrumColorRGBA[A] >> 8) & 0xFF) - int32_t((UI::ZXSpectrumColorRGBA[B] >> 8) & 0xFF);
+						Result[A][B] = 3 * Distance_R * Distance_R + 4 * Distance_G * Distance_G + 2 * Distance_B * Distance_B;
+					}
+				}
+				return Result;
+			}();
+		return Table;
 	}
 
-	std::vector<std::pair<uint8_t, int>> Sorted(Freq.begin(), Freq.end());
-	std::sort(Sorted.begin(), Sorted.end(),
-		[](auto& A, auto& B)
+	void GetInkPaperFrequent(const FCellHistogram& Histogram, uint8_t& OutputPaperColor, uint8_t& OutputInkColor, const UI::FConversationSettings& Settings)
+	{
+		// colors present in the cell, most frequent first, equal counts in ascending index order
+		uint8_t Sorted[ZXColorBins];
+		int32_t SortedCount = 0;
+		for (int32_t Index = 0; Index < ZXColorBins; ++Index)
 		{
-			return A.second > B.second;
-		});
+			if (Histogram[Index] == 0)
+			{
+				continue;
+			}
 
-	int32_t OftenEncountered = Sorted[0].first;
-	int32_t SometimesEncountered = (Sorted.size() > 1) ? Sorted[1].first : OftenEncountered;
+			int32_t i = SortedCount++;
+			for (; i > 0 && Histogram[Sorted[i - 1]] < Histogram[Index]; --i)
+			{
+				Sorted[i] = Sorted[i - 1];
+			}
+			Sorted[i] = uint8_t(Index);
+		}
+
+		if (SortedCount == 0)
+		{
+			OutputPaperColor = OutputInkColor = Settings.ReplaceTransparent;
+			return;
+		}
+
+		int32_t OftenEncountered = Sorted[0];
+		int32_t SometimesEncountered = (SortedCount > 1) ? Sorted[1] : OftenEncountered;
+
+		if (SortedCount >= 3)
+		{
+			if (OftenEncountered == Settings.TransparentIndex)
+			{
+				OftenEncountered = SometimesEncountered;
+				SometimesEncountered = Sorted[2];
+			}
+			else if (SometimesEncountered == Settings.TransparentIndex)
+			{
+				SometimesEncountered = Sorted[2];
+			}
+
+			// exceptions of colors with different brightness
+			if ((OftenEncountered & 0x07) == (SometimesEncountered & 0x07))
+			{
+				SometimesEncountered = Sorted[2];
+			}
+		}
+
+		if (SortedCount > 2)
+		{
+			if (OftenEncountered == Settings.TransparentIndex)
+			{
+				OftenEncountered = Settings.ReplaceTransparent;
+			}
+			if (SometimesEncountered == Settings.TransparentIndex)
+			{
+				SometimesEncountered = Settings.ReplaceTransparent;
+			}
+		}
+
+		if (SortedCount == 1)
+		{
+			if (OftenEncountered == Settings.TransparentIndex)
+			{
+				OftenEncountered = Settings.InkAlways;
+			}
+			if (SometimesEncountered == Settings.TransparentIndex)
+			{
+				SometimesEncountered = Settings.ReplaceTransparent;
+			}
+		}
+
+		OutputPaperColor = OftenEncountered;
+		OutputInkColor = SometimesEncountered;
+	}
 
-	if (Sorted.size() >= 3)
+	// tries every pair of the same brightness, transparent pixels are masked out and don't count
+	bool GetInkPaperMinimizeError(const FCellHistogram& Histogram, uint8_t& OutputPaperColor, uint8_t& OutputInkColor, const UI::FConversationSettings& Settings)
 	{
-		if (OftenEncountered == Settings.TransparentIndex)
+		const FPaletteError& Error = GetPaletteError();
+
+		int32_t Colors[ZXColorBins];
+		int32_t ColorCount = 0;
+		for (int32_t Index = 0; Index < ZXColorBins; ++Index)
 		{
-			OftenEncountered = SometimesEncountered;
-			SometimesEncountered = Sorted[2].first;
+			if (Histogram[Index] != 0 && Index != Settings.TransparentIndex)
+			{
+				Colors[ColorCount++] = Index;
+			}
 		}
-		else if (SometimesEncountered == Settings.TransparentIndex)
+		if (ColorCount == 0)
 		{
-			SometimesEncountered = Sorted[2].first;
+			return false;
 		}
 
-		// exceptions of colors with different brightness
-		if ((OftenEncountered & 0x07) == (SometimesEncountered & 0x07))
+		int64_t BestError = INT64_MAX;
+		bool bBestHasInkAlways = false;
+		int32_t BestA = Colors[0];
+		int32_t BestB = Colors[0];
+		for (int32_t Bright = 0; Bright < ZXColorBins; Bright += 8)
 		{
-			SometimesEncountered = Sorted[2].first;
+			for (int32_t A = Bright; A < Bright + 8; ++A)
+			{
+				for (int32_t B = A; B < Bright + 8; ++B)
+				{
+					int64_t PairError = 0;
+					for (int32_t i = 0; i < ColorCount && PairError <= BestError; ++i)
+					{
+						const int32_t Color = Colors[i];
+						PairError += int64_t(Histogram[Color]) * ImMin(Error[Color][A], Error[Color][B]);
+					}
+
+					// on equal error prefer the pair that keeps the forced ink color
+					const bool bHasInkAlways = A == Settings.InkAlways || B == Settings.InkAlways;
+					if (PairError < BestError || (PairError == BestError && bHasInkAlways && !bBestHasInkAlways))
+					{
+						BestError = PairError;
+						bBestHasInkAlways = bHasInkAlways;
+						BestA = A;
+						BestB = B;
+					}
+				}
+			}
 		}
+
+		// the color covering more pixels becomes paper
+		int32_t CoverageA = 0;
+		int32_t CoverageB = 0;
+		for (int32_t i = 0; i < ColorCount; ++i)
+		{
+			const int32_t Color = Colors[i];
+			(Error[Color][BestB] < Error[Color][BestA] ? CoverageB : CoverageA) += Histogram[Color];
+		}
+
+		OutputPaperColor = uint8_t(CoverageB > CoverageA ? BestB : BestA);
+		OutputInkColor = uint8_t(CoverageB > CoverageA ? BestA : BestB);
+		return true;
 	}
 
-	if (Sorted.size() > 2)
+	void SolveCell(const FCellHistogram& Histogram, uint8_t& OutputPaperColor, uint8_t& OutputInkColor, const UI::FConversationSettings& Settings)
 	{
-		if (OftenEncountered == Settings.TransparentIndex)
+		if (!Settings.bMinimizeError || !GetInkPaperMinimizeError(Histogram, OutputPaperColor, OutputInkColor, Settings))
 		{
-			OftenEncountered = Settings.ReplaceTransparent;
+			GetInkPaperFrequent(Histogram, OutputPaperColor, OutputInkColor, Settings);
 		}
-		if (SometimesEncountered == Settings.TransparentIndex)
+
+		if (Settings.InkAlways != UI::EZXSpectrumColor::None && Settings.InkAlways == OutputPaperColor)
 		{
-			SometimesEncountered = Settings.ReplaceTransparent;
+			std::swap(OutputPaperColor, OutputInkColor);
 		}
 	}
 
-	if (Sorted.size() == 1)
+	// converts cell rows [FirstCellRow, LastCellRow), histograms of a whole row of cells are gathered in one pass
+	void ConvertCellRows(
+		const uint8_t* IndexedData,
+		int32_t Width,
+		int32_t Boundary_X,
+		int32_t FirstCellRow, int32_t LastCellRow,
+		uint8_t* OutputInkData,
+		uint8_t* OutputAttributeData,
+		uint8_t* OutputMaskData,
+		const UI::FConversationSettings& Settings)
 	{
-		if (OftenEncountered == Settings.TransparentIndex)
+		const FPaletteError& Error = GetPaletteError();
+
+		std::vector<FCellHistogram> Histograms(Boundary_X);
+		std::vector<std::array<uint8_t, ZXColorBins>> InkBits(Boundary_X);
+
+		uint8_t MaskBits[ZXColorBins];
+		for (int32_t Index = 0; Index < ZXColorBins; ++Index)
 		{
-			OftenEncountered = Settings.InkAlways;
+			MaskBits[Index] = Index == UI::EZXSpectrumColor::Transparent ? 0 : 1;
 		}
-		if (SometimesEncountered == Settings.TransparentIndex)
+
+		for (int32_t y = FirstCellRow; y < LastCellRow; ++y)
 		{
-			SometimesEncountered = Settings.ReplaceTransparent;
+			const uint8_t* CellRow = IndexedData + static_cast<size_t>(y) * 8 * Width;
+
+			for (FCellHistogram& Histogram : Histograms)
+			{
+				Histogram.fill(0);
+			}
+			for (int32_t dy = 0; dy < 8; ++dy)
+			{
+				const uint8_t* Row = CellRow + static_cast<size_t>(dy) * Width;
+				for (int32_t x = 0; x < Boundary_X; ++x)
+				{
+					FCellHistogram& Histogram = Histograms[x];
+					for (int32_t dx = 0; dx < 8; ++dx)
+					{
+						Histogram[Row[x * 8 + dx] & (ZXColorBins - 1)]++;
+					}
+				}
+			}
+
+			for (int32_t x = 0; x < Boundary_X; ++x)
+			{
+				uint8_t PaperColor, InkColor;
+				SolveCell(Histograms[x], PaperColor, InkColor, Settings);
+
+				// ink bit for every palette index of this cell
+				std::array<uint8_t, ZXColorBins>& Bits = InkBits[x];
+				for (int32_t Index = 0; Index < ZXColorBins; ++Index)
+				{
+					const int32_t Color = Index & 0x07;
+					bool bInk = Color == UI::EZXSpectrumColor::Transparent ? Settings.ReplaceTransparent == (InkColor & 0x07) : Color == (InkColor & 0x07);
+					if (Settings.bMinimizeError && Index != Settings.TransparentIndex && InkColor < ZXColorBins && PaperColor < ZXColorBins)
+					{
+						bInk = Error[Index][InkColor] < Error[Index][PaperColor];
+					}
+					Bits[Index] = bInk ? 1 : 0;
+				}
+
+				const bool bBright = (InkColor & 0x08) && (PaperColor & 0x08);
+				OutputAttributeData[y * Boundary_X + x] = (bBright << 6) | ((PaperColor & 0x07) << 3) | (InkColor & 0x07);
+			}
+
+			for (int32_t dy = 0; dy < 8; ++dy)
+			{
+				const uint8_t* Row = CellRow + static_cast<size_t>(dy) * Width;
+				const size_t PixelsOffset = (static_cast<size_t>(y) * 8 + dy) * Boundary_X;
+				for (int32_t x = 0; x < Boundary_X; ++x)
+				{
+					const std::array<uint8_t, ZXColorBins>& Bits = InkBits[x];
+					const uint8_t* Pixels = Row + x * 8;
+
+					uint8_t Mask = 0;
+					uint8_t PixelsInk = 0;
+					for (int32_t dx = 0; dx < 8; ++dx)
+					{
+						const uint8_t Index = Pixels[dx] & (ZXColorBins - 1);
+						PixelsInk = (PixelsInk << 1) | Bits[Index];
+						Mask = (Mask << 1) | MaskBits[Index];
+					}
+
+					OutputInkData[PixelsOffset + x] = PixelsInk;
+					OutputMaskData[PixelsOffset + x] = Mask;
+				}
+			}
 		}
 	}
-	
-	OutputPaperColor = OftenEncountered;
-	OutputInkColor = SometimesEncountered;
+}
+
+void UI::GetInkPaper(const std::vector<uint8_t>& IndicesBoundary, uint8_t& OutputPaperColor, uint8_t& OutputInkColor, const UI::FConversationSettings& Settings)
+{
+	FCellHistogram Histogram{};
+	for (uint8_t i : IndicesBoundary)
+	{
+		Histogram[i & (ZXColorBins - 1)]++;
+	}
+
+	if (!Settings.bMinimizeError || !GetInkPaperMinimizeError(Histogram, OutputPaperColor, OutputInkColor, Settings))
+	{
+		GetInkPaperFrequent(Histogram, OutputPaperColor, OutputInkColor, Settings);
+	}
 }
 
 int32_t UI::FindClosestColor(ImU32 Color)
@@ -723,6 +954,16 @@ void UI::QuantizeToZX(const uint8_t* RawImage, int32_t Width, int32_t Height, in
 	const int32_t Size = Width * Height;
 	OutputIndexedData.resize(Size);
 
+	if (Channels == 4)
+	{
+		// TransparentColor is 0xRRGGBBAA packed as ImU32, pixels are R, G, B, A bytes
+		const uint32_t TransparentPixel =
+			(TransparentColor >> 24) | ((TransparentColor >> 8) & 0x0000FF00) |
+			((TransparentColor << 8) & 0x00FF0000) | (TransparentColor << 24);
+		QuantizeRGBAToZXIndex(RawImage, Size, OutputIndexedData.data(), TransparentPixel);
+		return;
+	}
+
 	for (int i = 0; i < Size; ++i)
 	{
 		const uint8_t* Pixel = &RawImage[i * Channels];
@@ -769,24 +1010,23 @@ void UI::ZXIndexColorToRGBA(std::vector<uint32_t>& OutputRGBA, const std::vector
 {
 	const int32_t Size = Width * Height;
 	OutputRGBA.resize(Size);
-	for (int32_t i = 0; i < IndexedData.size(); ++i)
-	{
-		const uint8_t& Value = IndexedData[i];
-		const EZXColor IndexColor = static_cast<UI::EZXSpectrumColor::Type>(Value);
-		const ImU32 ColorRGBA = ToU32(UI::ZXSpectrumColorRGBA[IndexColor]);
-		OutputRGBA[i] = ColorRGBA;
-	}
+	const size_t Count = ImMin(IndexedData.size(), OutputRGBA.size());
+	ExpandZXIndexToRGBA(IndexedData.data(), Count, OutputRGBA.data());
+
+	// the output may be a reused buffer, the pixels not covered by the data are cleared
+	std::fill(OutputRGBA.begin() + Count, OutputRGBA.end(), 0u);
 }
 
 void UI::ZXIndexColorToImage(FImage& InOutputImage, const std::vector<uint8_t>& IndexedData, int32_t Width, int32_t Height, bool bCreate)
 {
-	std::vector<uint32_t> RGBA;
+	thread_local std::vector<uint32_t> RGBA;
 	ZXIndexColorToRGBA(RGBA, IndexedData, Width, Height);
 
 	FImageBase& Images = FImageBase::Get();
 	if (bCreate)
 	{
-		InOutputImage = Images.CreateTexture(RGBA.data(), Width, Height, D3D11_CPU_ACCESS_WRITE, D3D11_USAGE_DYNAMIC);
+		// default usage, so that partial updates only upload the changed rectangle
+		InOutputImage = Images.CreateTexture(RGBA.data(), Width, Height, 0, D3D11_USAGE_DEFAULT);
 	}
 	else
 	{
@@ -794,6 +1034,29 @@ void UI::ZXIndexColorToImage(FImage& InOutputImage, const std::vector<uint8_t>&
 	}
 }
 
+void UI::ZXIndexColorToImage(FImage& InOutputImage, FTextureStaging& Staging, const std::vector<uint8_t>& IndexedData, int32_t Width, int32_t Height, const FDirtyRect& Region)
+{
+	ZXIndexColorToStaging(Staging, IndexedData, Width, Height, Region);
+	UploadStaging(InOutputImage, Staging);
+}
+
+void UI::UploadStaging(FImage& InOutputImage, FTextureStaging& Staging)
+{
+	const FDirtyRect Dirty = Staging.ConsumeDirty();
+
+	FImageBase& Images = FImageBase::Get();
+	if (!InOutputImage.IsValid() ||
+		(int32_t)InOutputImage.Width != Staging.Width ||
+		(int32_t)InOutputImage.Height != Staging.Height)
+	{
+		InOutputImage = Images.CreateTexture(Staging.RGBA.data(), Staging.Width, Staging.Height, 0, D3D11_USAGE_DEFAULT);
+	}
+	else if (!Dirty.IsEmpty())
+	{
+		Images.UpdateTextureRegion(InOutputImage.Handle, Staging.RGBA.data(), Dirty.MinX, Dirty.MinY, Dirty.GetWidth(), Dirty.GetHeight());
+	}
+}
+
 void UI::ZXIndexColorToZXAttributeColor(
 	const std::vector<uint8_t>& IndexedData,
 	int32_t Width, int32_t Height,
@@ -811,64 +1074,29 @@ void UI::ZXIndexColorToZXAttributeColor(
 	const int32_t AttributeSize = Boundary_X * Boundary_Y;
 	OutputAttributeData.resize(AttributeSize);
 
-	std::vector<uint8_t> Boundary(8 * 8);	
-	for (int32_t y = 0; y < Boundary_Y; ++y)
+	if (Boundary_X <= 0 || Boundary_Y <= 0)
 	{
-		for (int32_t x = 0; x < Boundary_X; ++x)
-		{
-			for (int32_t dy = 0; dy < 8; ++dy)
-			{
-				for (int32_t dx = 0; dx < 8; ++dx)
-				{
-					const int32_t BoundaryOffset = dy * 8 + dx;
-					Boundary[BoundaryOffset] = IndexedData[(y * 8 + dy) * Width + (x * 8 + dx)];
-				}
-			}
-
-			uint8_t PaperColor, InkColor;
-			GetInkPaper(Boundary, PaperColor, InkColor, Settings);
-			if (Settings.InkAlways != EZXSpectrumColor::None && Settings.InkAlways == PaperColor)
-			{
-				std::swap(PaperColor, InkColor);
-			}
-
-			for (int32_t dy = 0; dy < 8; ++dy)
-			{
-				uint8_t Mask = 0;
-				uint8_t PixelsInk = 0;
-				for (int32_t dx = 0; dx < 8; ++dx)
-				{
-					Mask <<= 1;
-					PixelsInk <<= 1;
-
-					const int32_t BoundaryOffset = dy * 8 + dx;
-					const uint8_t Index = Boundary[BoundaryOffset] & 0x07;
-					if (Index == UI::EZXSpectrumColor::Transparent ? Settings.ReplaceTransparent == (InkColor & 0x07) : Index == (InkColor & 0x07))
-					{
-						PixelsInk |= 1;
-					}
-
-					if (Boundary[BoundaryOffset] == UI::EZXSpectrumColor::Transparent)
-					{
-						Mask |= 1;
-					}
-				}
-
-				const int32_t PixelsOffset = (y * 8 + dy) * Boundary_X + x;
-				OutputInkData[PixelsOffset] = PixelsInk;
-				OutputMaskData[PixelsOffset] = ~Mask;
-			}
-
-			bool bBright = (InkColor & 0x08) && (PaperColor & 0x08);
-			InkColor &= 0x07;
-			PaperColor &= 0x07;
-
-			uint8_t Attribut = (bBright << 6) | (PaperColor << 3) | InkColor;
+		return;
+	}
 
-			const int32_t Offset = y * Boundary_X + x;
-			OutputAttributeData[Offset] = Attribut;
-		}
+	const int32_t Concurrency = int32_t(std::thread::hardware_concurrency());
+	const int32_t BandCount = Width * Height < ParallelConversionMinPixels ? 1 : ImClamp(Concurrency, 1, Boundary_Y);
+	if (BandCount <= 1)
+	{
+		ConvertCellRows(IndexedData.data(), Width, Boundary_X, 0, Boundary_Y,
+			OutputInkData.data(), OutputAttributeData.data(), OutputMaskData.data(), Settings);
+		return;
 	}
+
+	// cell rows are independent, each band is a contiguous range of them
+	FJobSystem::Get().ParallelFor(BandCount,
+		[&](int32_t Band)
+		{
+			const int32_t FirstCellRow = Boundary_Y * Band / BandCount;
+			const int32_t LastCellRow = Boundary_Y * (Band + 1) / BandCount;
+			ConvertCellRows(IndexedData.data(), Width, Boundary_X, FirstCellRow, LastCellRow,
+				OutputInkData.data(), OutputAttributeData.data(), OutputMaskData.data(), Settings);
+		});
 }
 
 void UI::ZXAttributeColorToZXIndexColor(
@@ -905,115 +1133,57 @@ void UI::ZXAttributeColorToImage(
 	bool bTransparentMask /*= false*/,
 	bool bTransparentPaper /*= false*/)
 {
-	const int32_t Size = Width * Height;
-	std::vector<uint32_t> RGBA(Size);
-
-	if (OutputIndexedData != nullptr)
-	{
-		OutputIndexedData->resize(Size);
-	}
-
-	const int32_t Boundary_X = Width >> 3;
-	const int32_t Boundary_Y = Height >> 3;
-
-	bool bInk = InkData != nullptr;
-	bool bMask = MaskData != nullptr;
-	bool bAttribute = AttributeData != nullptr;
-
-	for (int32_t i = 0; i < Size; ++i)
-	{
-		const int32_t y = i / Width;
-		const int32_t x = i % Width;
-
-		const int32_t bx = x / 8;
-		const int32_t dx = x % 8;
-		const int32_t by = y / 8;
-		const int32_t dy = y % 8;
-
-		uint8_t Mask = 0xFF;
-		uint8_t Pixels = 0x00;
-		uint8_t InkColor = EZXSpectrumColor::Black_;
-		uint8_t PaperColor = EZXSpectrumColor::White_;
-
-		if (bInk)
-		{
-			const int32_t InkOffset = (by * 8 + dy) * Boundary_X + bx;
-			Pixels = InkData[InkOffset];
-		}
-
-		if (bMask)
-		{
-			const int32_t MaskOffset = (by * 8 + dy) * Boundary_X + bx;
-			Mask = MaskData[MaskOffset];
-		}
-
-		if (bAttribute)
-		{
-			const int32_t AttributeOffset = by * Boundary_X + bx;
-			const uint8_t Attribute = AttributeData[AttributeOffset];
-			const bool bBright = (Attribute >> 6) & 0x01;
-			InkColor = (Attribute & 0x07) | (bBright << 3);
-			PaperColor = ((Attribute >> 3) & 0x07) | (bBright << 3);
-		}
-
-		if (InkColor == EZXSpectrumColor::Transparent)
-		{
-			InkColor = EZXSpectrumColor::Black_;
-		}
-		if (PaperColor == EZXSpectrumColor::Transparent)
-		{
-			PaperColor = EZXSpectrumColor::Black_;
-		}
-
-		if (bInk || bAttribute)
-		{
-			if (bMaskInverse)
-			{
-				Mask = ~Mask;
-			}
-		}
-		else
-		{
-			std::swap(InkColor, PaperColor);
-		}
-
-		const bool bInkPixel = ((Pixels << dx) & 0x80) != 0;
-		const int8_t ColorInk = bInkPixel
-			? InkColor
-			: (bTransparentPaper && bInk && bAttribute
-				? EZXSpectrumColor::Transparent
-				: PaperColor);
-		const int8_t Color = ((Mask << dx) & 0x80) ? EZXSpectrumColor::Transparent : ColorInk;
-		const int8_t TransparentMask = ((Mask << dx) & 0x80) ? EZXSpectrumColor::Magenta_ : EZXSpectrumColor::Black_;
-		if (OutputIndexedData)
-		{
-			(*OutputIndexedData)[i] = Color;
-		}
-
-		const ImVec4 ColorRGBA = ToVec4(UI::ZXSpectrumColorRGBA[Color]);
-		ImVec4 MaskColorRGBA = ToVec4(UI::ZXSpectrumColorRGBA[TransparentMask]) * 0.5f;
-		MaskColorRGBA.w = 1.0f;
-
-		ImVec4 BlandColor = ColorRGBA + (bTransparentMask ? MaskColorRGBA : ImVec4());
-		BlandColor.x = ImClamp<float>(BlandColor.x, 0.0f, 1.0f);
-		BlandColor.y = ImClamp<float>(BlandColor.y, 0.0f, 1.0f);
-		BlandColor.z = ImClamp<float>(BlandColor.z, 0.0f, 1.0f);
-		BlandColor.w = ImClamp<float>(BlandColor.w, 0.0f, 1.0f);
-
-		RGBA[i] = ColorToU32(BlandColor);
-	}
+	thread_local FTextureStaging Staging;
+	ZXAttributeColorToStaging(
+		Staging,
+		Width, Height,
+		InkData,
+		AttributeData,
+		MaskData,
+		FDirtyRect::Full(Width, Height),
+		OutputIndexedData,
+		bMaskInverse,
+		bTransparentMask,
+		bTransparentPaper);
+	Staging.Dirty.Reset();
 
 	FImageBase& Images = FImageBase::Get();
 	if (bCreate)
 	{
-		InOutputImage = Images.CreateTexture(RGBA.data(), Width, Height, D3D11_CPU_ACCESS_WRITE, D3D11_USAGE_DYNAMIC);
+		InOutputImage = Images.CreateTexture(Staging.RGBA.data(), Width, Height, 0, D3D11_USAGE_DEFAULT);
 	}
 	else
 	{
-		Images.UpdateTexture(InOutputImage.Handle, RGBA.data());
+		Images.UpdateTexture(InOutputImage.Handle, Staging.RGBA.data());
 	}
 }
 
+void UI::ZXAttributeColorToImage(
+	FImage& InOutputImage,
+	FTextureStaging& Staging,
+	int32_t Width, int32_t Height,
+	const uint8_t* InkData,
+	const uint8_t* AttributeData,
+	const uint8_t* MaskData,
+	const FDirtyRect& Region,
+	bool bMaskInverse /*= true*/,
+	bool bTransparentMask /*= false*/,
+	bool bTransparentPaper /*= false*/)
+{
+	ZXAttributeColorToStaging(
+		Staging,
+		Width, Height,
+		InkData,
+		AttributeData,
+		MaskData,
+		Region,
+		nullptr,
+		bMaskInverse,
+		bTransparentMask,
+		bTransparentPaper);
+	UploadStaging(InOutputImage, Staging);
+}
+
 void UI::FillRegion(const ImRect& RectangleFill, std::vector<uint8_t>& OutputIndexedData, int32_t Width, int32_t Height, EZXSpectrumColor::Type FillColor)
 {
 	const int32_t Size = Width * Height;
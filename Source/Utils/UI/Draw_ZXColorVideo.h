@@ -2,6 +2,7 @@
 
 #include <CoreMinimal.h>
 #include <Core/Image.h>
+#include <Utils/UI/Draw_ZXTextureStaging.h>
 
 struct FSprite;
 
@@ -88,6 +89,9 @@ namespace UI
 		uint8_t InkAlways = EZXSpectrumColor::None;
 		uint8_t TransparentIndex = EZXSpectrumColor::Transparent;
 		uint8_t ReplaceTransparent = EZXSpectrumColor::White;
+
+		// pick the ink/paper pair with the lowest color error instead of the two most frequent colors
+		bool bMinimizeError = false;
 	};
 
 	struct FZXViewOptions
@@ -151,6 +155,7 @@ namespace UI
 
 		// render data
 		FImage Image;						// final display result
+		FTextureStaging Staging;			// CPU copy of the image for partial updates
 
 		// ZX Spectrum viewing data
 		std::vector<uint8_t> IndexedData;	// indexed image data after QuantizeToZX
@@ -211,7 +216,7 @@ namespace UI
 	void Add_ZXViewDeltaPosition(std::shared_ptr<UI::FZXColorView> ZXColorView, ImVec2 DeltaPosition);
 	void Set_ZXViewScale(std::shared_ptr<UI::FZXColorView> ZXColorView, float MouseWheel);
 	ImVec2 ConverZXViewPositionToPixel(UI::FZXColorView& ZXColorView, const ImVec2& Position);
-	void ConvertZXIndexColorToDisplayRGB(FImage& InOutputImage, const std::vector<uint8_t> Data);
+	void ConvertZXIndexColorToDisplayRGB(FImage& InOutputImage, const std::vector<uint8_t>& Data);
 
 	void GetInkPaper(const std::vector<uint8_t>& IndicesBoundary, uint8_t& OutputPaperColor, uint8_t& OutputInkColor, const UI::FConversationSettings& Settings);
 	int32_t FindClosestColor(ImU32 Color);
@@ -227,6 +232,8 @@ namespace UI
 	// conversion of index colors (1 color per pixel) to texture image
 	void ZXIndexColorToRGBA(std::vector<uint32_t>& OutputRGBA, const std::vector<uint8_t>& IndexedData, int32_t Width, int32_t Height);
 	void ZXIndexColorToImage(FImage& InOutputImage, const std::vector<uint8_t>& IndexedData, int32_t Width, int32_t Height, bool bCreate = false);
+	// converts only the region into the staging and uploads what is dirty in it
+	void ZXIndexColorToImage(FImage& InOutputImage, FTextureStaging& Staging, const std::vector<uint8_t>& IndexedData, int32_t Width, int32_t Height, const FDirtyRect& Region);
 	
 	// conversion of index colors (1 color per pixel) to ZX format
 	void ZXIndexColorToZXAttributeColor(
@@ -258,6 +265,20 @@ namespace UI
 		bool bMaskInverse = true,
 		bool bTransparentMask = false,
 		bool bTransparentPaper = false);
+	void ZXAttributeColorToImage(
+		FImage& InOutputImage,
+		FTextureStaging& Staging,
+		int32_t Width, int32_t Height,
+		const uint8_t* InkData,
+		const uint8_t* AttributeData,
+		const uint8_t* MaskData,
+		const FDirtyRect& Region,
+		bool bMaskInverse = true,
+		bool bTransparentMask = false,
+		bool bTransparentPaper = false);
+
+	// uploads the dirty rectangle of the staging, the texture is created when it doesn't match the staging
+	void UploadStaging(FImage& InOutputImage, FTextureStaging& Staging);
 
 	// fill region
 	void FillRegion(const ImRect& RectangleFill, std::vector<uint8_t>& OutputIndexedData, int32_t Width, int32_t Height, EZXSpectrumColor::Type FillColor);
@@ -0,0 +1,157 @@
+#include "Draw_ZXFloodFill.h"
+
+namespace
+{
+	struct FSeed
+	{
+		int32_t X;
+		int32_t Y;
+	};
+
+	// the bounds of the settings clamped to the pixels that have data
+	UI::FDirtyRect GetBounds(const UI::FFloodFillSettings& Settings, int32_t Width, int32_t Height)
+	{
+		UI::FDirtyRect Bounds = Settings.Bounds.IsEmpty() ? UI::FDirtyRect::Full(Width, Height) : Settings.Bounds;
+		Bounds.Clamp(Width, Height);
+		return Bounds;
+	}
+
+	template<typename TMatch>
+	UI::FDirtyRect ScanlineFill(
+		int32_t Width, int32_t Height,
+		int32_t X, int32_t Y,
+		const UI::FDirtyRect& Bounds,
+		bool bDiagonal,
+		TMatch&& Match,
+		std::vector<uint8_t>& Region)
+	{
+		Region.assign(static_cast<size_t>(Width) * Height, 0);
+		if (X < Bounds.MinX || X >= Bounds.MaxX || Y < Bounds.MinY || Y >= Bounds.MaxY)
+		{
+			return UI::FDirtyRect();
+		}
+
+		// pending spans of the neighbour rows, one seed per run of matching pixels
+		thread_local std::vector<FSeed> Stack;
+		Stack.clear();
+		Stack.push_back({ X, Y });
+
+		const int32_t Diagonal = bDiagonal ? 1 : 0;
+		UI::FDirtyRect Result;
+		while (!Stack.empty())
+		{
+			const FSeed Seed = Stack.back();
+			Stack.pop_back();
+
+			uint8_t* Row = Region.data() + static_cast<size_t>(Seed.Y) * Width;
+			if (Row[Seed.X] || !Match(Seed.X, Seed.Y))
+			{
+				continue;
+			}
+
+			int32_t Left = Seed.X;
+			int32_t Right = Seed.X + 1;
+			while (Left > Bounds.MinX && !Row[Left - 1] && Match(Left - 1, Seed.Y))
+			{
+				--Left;
+			}
+			while (Right < Bounds.MaxX && !Row[Right] && Match(Right, Seed.Y))
+			{
+				++Right;
+			}
+			std::memset(Row + Left, 1, Right - Left);
+			Result.Add({ Left, Seed.Y, Right, Seed.Y + 1 });
+
+			// the span is widened by one pixel on both sides for diagonal neighbours
+			const int32_t ScanLeft = (std::max)(Left - Diagonal, Bounds.MinX);
+			const int32_t ScanRight = (std::min)(Right + Diagonal, Bounds.MaxX);
+			for (const int32_t NextY : { Seed.Y - 1, Seed.Y + 1 })
+			{
+				if (NextY < Bounds.MinY || NextY >= Bounds.MaxY)
+				{
+					continue;
+				}
+
+				const uint8_t* NextRow = Region.data() + static_cast<size_t>(NextY) * Width;
+				bool bRun = false;
+				for (int32_t NextX = ScanLeft; NextX < ScanRight; ++NextX)
+				{
+					const bool bInside = !NextRow[NextX] && Match(NextX, NextY);
+					if (bInside && !bRun)
+					{
+						Stack.push_back({ NextX, NextY });
+					}
+					bRun = bInside;
+				}
+			}
+		}
+		return Result;
+	}
+}
+
+UI::FDirtyRect UI::FloodFillRegion(
+	const std::vector<uint8_t>& IndexedData,
+	int32_t Width, int32_t Height,
+	int32_t X, int32_t Y,
+	const FFloodFillSettings& Settings,
+	std::vector<uint8_t>& OutputRegion)
+{
+	if (Width <= 0 || Height <= 0 || IndexedData.size() < static_cast<size_t>(Width) * Height ||
+		X < 0 || X >= Width || Y < 0 || Y >= Height)
+	{
+		OutputRegion.clear();
+		return FDirtyRect();
+	}
+
+	const uint8_t* Data = IndexedData.data();
+	const uint8_t SeedColor = Data[static_cast<size_t>(Y) * Width + X];
+	return ScanlineFill(Width, Height, X, Y, GetBounds(Settings, Width, Height), Settings.bDiagonal,
+		[Data, Width, SeedColor](int32_t PixelX, int32_t PixelY)
+		{
+			return Data[static_cast<size_t>(PixelY) * Width + PixelX] == SeedColor;
+		},
+		OutputRegion);
+}
+
+UI::FDirtyRect UI::FloodFillRegion(
+	const uint8_t* InkData,
+	const uint8_t* AttributeData,
+	int32_t Width, int32_t Height,
+	int32_t X, int32_t Y,
+	const FFloodFillSettings& Settings,
+	std::vector<uint8_t>& OutputRegion)
+{
+	const int32_t Boundary_X = Width >> 3;
+	if (InkData == nullptr || Boundary_X <= 0 || Height <= 0 ||
+		X < 0 || X >= Boundary_X * 8 || Y < 0 || Y >= Height)
+	{
+		OutputRegion.clear();
+		return FDirtyRect();
+	}
+
+	// ink/paper index of a pixel, bright included, or just the ink bit
+	auto GetColor = [InkData, AttributeData, Boundary_X](int32_t PixelX, int32_t PixelY) -> uint8_t
+		{
+			const int32_t bx = PixelX >> 3;
+			const bool bInkPixel = ((InkData[PixelY * Boundary_X + bx] << (PixelX & 7)) & 0x80) != 0;
+			if (AttributeData == nullptr)
+			{
+				return bInkPixel;
+			}
+
+			const uint8_t Attribute = AttributeData[(PixelY >> 3) * Boundary_X + bx];
+			const uint8_t Bright = ((Attribute >> 6) & 0x01) << 3;
+			return bInkPixel ? (Attribute & 0x07) | Bright : ((Attribute >> 3) & 0x07) | Bright;
+		};
+
+	// the last partial byte of a row has no ZX data
+	const FDirtyRect Bounds = GetBounds(Settings, Boundary_X * 8, Height);
+
+	const uint8_t SeedColor = GetColor(X, Y);
+	return ScanlineFill(Width, Height, X, Y, Bounds, Settings.bDiagonal,
+		[&GetColor, SeedColor](int32_t PixelX, int32_t PixelY)
+		{
+			return GetColor(PixelX, PixelY) == SeedColor;
+		},
+		OutputRegion);
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <CoreMinimal.h>
+#include <Utils/UI/Draw_ZXTextureStaging.h>
+
+namespace UI
+{
+	struct FFloodFillSettings
+	{
+		bool bDiagonal = false;		// 8-connectivity instead of 4
+		FDirtyRect Bounds;			// pixels outside never join the region, empty - the whole image
+	};
+
+	// scanline fill without recursion: marks the pixels connected to the seed that have its color,
+	// OutputRegion is resized to Width * Height bytes (1 - part of the region),
+	// returns the bounding rectangle of the region, empty if the seed is outside the bounds
+	FDirtyRect FloodFillRegion(
+		const std::vector<uint8_t>& IndexedData,
+		int32_t Width, int32_t Height,
+		int32_t X, int32_t Y,
+		const FFloodFillSettings& Settings,
+		std::vector<uint8_t>& OutputRegion);
+
+	// the same over ZX data, the color of a pixel is the ink or paper of its attribute cell,
+	// without attributes only the ink bit is compared
+	FDirtyRect FloodFillRegion(
+		const uint8_t* InkData,
+		const uint8_t* AttributeData,
+		int32_t Width, int32_t Height,
+		int32_t X, int32_t Y,
+		const FFloodFillSettings& Settings,
+		std::vector<uint8_t>& OutputRegion);
+}
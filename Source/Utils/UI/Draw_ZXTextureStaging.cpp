@@ -0,0 +1,224 @@
+#include "Draw_ZXTextureStaging.h"
+#include <Utils/UI/Draw.h>
+#include <Utils/UI/Draw_ZXColorKernels.h>
+#include <Utils/UI/Draw_ZXColorVideo.h>
+
+namespace
+{
+	// final RGBA of a palette index with and without the mask tint, indexed [bMasked][Color]
+	typedef std::array<std::array<uint32_t, UI::EZXSpectrumColor::MAX>, 2> FAttributeColorTable;
+
+	FAttributeColorTable MakeAttributeColorTable(bool bTransparentMask)
+	{
+		FAttributeColorTable Table;
+		for (int32_t bMasked = 0; bMasked < 2; ++bMasked)
+		{
+			const uint8_t TransparentMask = bMasked ? UI::EZXSpectrumColor::Magenta_ : UI::EZXSpectrumColor::Black_;
+			ImVec4 MaskColorRGBA = UI::ToVec4(UI::ZXSpectrumColorRGBA[TransparentMask]) * 0.5f;
+			MaskColorRGBA.w = 1.0f;
+
+			for (int32_t Color = 0; Color < UI::EZXSpectrumColor::MAX; ++Color)
+			{
+				const ImVec4 ColorRGBA = UI::ToVec4(UI::ZXSpectrumColorRGBA[Color]);
+				ImVec4 BlandColor = ColorRGBA + (bTransparentMask ? MaskColorRGBA : ImVec4());
+				BlandColor.x = ImClamp<float>(BlandColor.x, 0.0f, 1.0f);
+				BlandColor.y = ImClamp<float>(BlandColor.y, 0.0f, 1.0f);
+				BlandColor.z = ImClamp<float>(BlandColor.z, 0.0f, 1.0f);
+				BlandColor.w = ImClamp<float>(BlandColor.w, 0.0f, 1.0f);
+				Table[bMasked][Color] = UI::ColorToU32(BlandColor);
+			}
+		}
+		return Table;
+	}
+
+	// clamps the region and resizes the staging, a resized staging converts everything
+	bool PrepareRegion(UI::FTextureStaging& Staging, int32_t Width, int32_t Height, UI::FDirtyRect& Region)
+	{
+		if (Staging.Resize(Width, Height))
+		{
+			Region = UI::FDirtyRect::Full(Width, Height);
+		}
+		Region.Clamp(Width, Height);
+		return !Region.IsEmpty();
+	}
+}
+
+void UI::FDirtyRect::Add(const FDirtyRect& Other)
+{
+	if (Other.IsEmpty())
+	{
+		return;
+	}
+	if (IsEmpty())
+	{
+		*this = Other;
+		return;
+	}
+	MinX = (std::min)(MinX, Other.MinX);
+	MinY = (std::min)(MinY, Other.MinY);
+	MaxX = (std::max)(MaxX, Other.MaxX);
+	MaxY = (std::max)(MaxY, Other.MaxY);
+}
+
+void UI::FDirtyRect::Clamp(int32_t Width, int32_t Height)
+{
+	MinX = ImClamp(MinX, 0, Width);
+	MinY = ImClamp(MinY, 0, Height);
+	MaxX = ImClamp(MaxX, 0, Width);
+	MaxY = ImClamp(MaxY, 0, Height);
+}
+
+bool UI::FTextureStaging::Resize(int32_t InWidth, int32_t InHeight)
+{
+	if (Width == InWidth && Height == InHeight && RGBA.size() == static_cast<size_t>(Width) * Height)
+	{
+		return false;
+	}
+
+	Width = InWidth;
+	Height = InHeight;
+	RGBA.assign(static_cast<size_t>(Width) * Height, 0);
+	Dirty = FDirtyRect::Full(Width, Height);
+	return true;
+}
+
+UI::FDirtyRect UI::FTextureStaging::ConsumeDirty()
+{
+	const FDirtyRect Result = Dirty;
+	Dirty.Reset();
+	return Result;
+}
+
+UI::FDirtyRect UI::ZXIndexColorToStaging(
+	FTextureStaging& Staging,
+	const std::vector<uint8_t>& IndexedData,
+	int32_t Width, int32_t Height,
+	FDirtyRect Region)
+{
+	if (!PrepareRegion(Staging, Width, Height, Region))
+	{
+		return Region;
+	}
+
+	const size_t RowSize = static_cast<size_t>(Region.GetWidth());
+	for (int32_t Y = Region.MinY; Y < Region.MaxY; ++Y)
+	{
+		const size_t Offset = static_cast<size_t>(Y) * Width + Region.MinX;
+		uint32_t* Output = Staging.GetRow(Y) + Region.MinX;
+		const size_t Count = Offset < IndexedData.size() ? (std::min)(RowSize, IndexedData.size() - Offset) : 0;
+		ExpandZXIndexToRGBA(IndexedData.data() + Offset, Count, Output);
+		std::fill(Output + Count, Output + RowSize, 0u);
+	}
+
+	Staging.Dirty.Add(Region);
+	return Region;
+}
+
+UI::FDirtyRect UI::ZXAttributeColorToStaging(
+	FTextureStaging& Staging,
+	int32_t Width, int32_t Height,
+	const uint8_t* InkData,
+	const uint8_t* AttributeData,
+	const uint8_t* MaskData,
+	FDirtyRect Region,
+	std::vector<uint8_t>* OutputIndexedData /*= nullptr*/,
+	bool bMaskInverse /*= true*/,
+	bool bTransparentMask /*= false*/,
+	bool bTransparentPaper /*= false*/)
+{
+	if (OutputIndexedData != nullptr && OutputIndexedData->size() != static_cast<size_t>(Width) * Height)
+	{
+		OutputIndexedData->resize(static_cast<size_t>(Width) * Height);
+	}
+	if (!PrepareRegion(Staging, Width, Height, Region))
+	{
+		return Region;
+	}
+
+	static const FAttributeColorTable ColorTable[2] = { MakeAttributeColorTable(false), MakeAttributeColorTable(true) };
+	const FAttributeColorTable& Colors = ColorTable[bTransparentMask];
+
+	const int32_t Boundary_X = Width >> 3;
+
+	const bool bInk = InkData != nullptr;
+	const bool bMask = MaskData != nullptr;
+	const bool bAttribute = AttributeData != nullptr;
+
+	for (int32_t y = Region.MinY; y < Region.MaxY; ++y)
+	{
+		const int32_t by = y / 8;
+		const int32_t dy = y % 8;
+		uint32_t* Output = Staging.GetRow(y);
+
+		for (int32_t x = Region.MinX; x < Region.MaxX; ++x)
+		{
+			const int32_t bx = x / 8;
+			const int32_t dx = x % 8;
+
+			uint8_t Mask = 0xFF;
+			uint8_t Pixels = 0x00;
+			uint8_t InkColor = EZXSpectrumColor::Black_;
+			uint8_t PaperColor = EZXSpectrumColor::White_;
+
+			if (bInk)
+			{
+				const int32_t InkOffset = (by * 8 + dy) * Boundary_X + bx;
+				Pixels = InkData[InkOffset];
+			}
+
+			if (bMask)
+			{
+				const int32_t MaskOffset = (by * 8 + dy) * Boundary_X + bx;
+				Mask = MaskData[MaskOffset];
+			}
+
+			if (bAttribute)
+			{
+				const int32_t AttributeOffset = by * Boundary_X + bx;
+				const uint8_t Attribute = AttributeData[AttributeOffset];
+				const bool bBright = (Attribute >> 6) & 0x01;
+				InkColor = (Attribute & 0x07) | (bBright << 3);
+				PaperColor = ((Attribute >> 3) & 0x07) | (bBright << 3);
+			}
+
+			if (InkColor == EZXSpectrumColor::Transparent)
+			{
+				InkColor = EZXSpectrumColor::Black_;
+			}
+			if (PaperColor == EZXSpectrumColor::Transparent)
+			{
+				PaperColor = EZXSpectrumColor::Black_;
+			}
+
+			if (bInk || bAttribute)
+			{
+				if (bMaskInverse)
+				{
+					Mask = ~Mask;
+				}
+			}
+			else
+			{
+				std::swap(InkColor, PaperColor);
+			}
+
+			const bool bInkPixel = ((Pixels << dx) & 0x80) != 0;
+			const uint8_t ColorInk = bInkPixel
+				? InkColor
+				: (bTransparentPaper && bInk && bAttribute
+					? EZXSpectrumColor::Transparent
+					: PaperColor);
+			const bool bMasked = ((Mask << dx) & 0x80) != 0;
+			const uint8_t Color = bMasked ? EZXSpectrumColor::Transparent : ColorInk;
+			if (OutputIndexedData)
+			{
+				(*OutputIndexedData)[static_cast<size_t>(y) * Width + x] = Color;
+			}
+
+			Output[x] = Colors[bMasked][Color];
+		}
+	}
+
+	Staging.Dirty.Add(Region);
+	return Region;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <CoreMinimal.h>
+
+namespace UI
+{
+	// rectangle of changed pixels, Max is exclusive, empty when Min >= Max
+	struct FDirtyRect
+	{
+		int32_t MinX = 0;
+		int32_t MinY = 0;
+		int32_t MaxX = 0;
+		int32_t MaxY = 0;
+
+		static FDirtyRect Full(int32_t Width, int32_t Height) { return { 0, 0, Width, Height }; }
+		static FDirtyRect Pixel(int32_t X, int32_t Y) { return { X, Y, X + 1, Y + 1 }; }
+		// the 8x8 attribute cell containing the pixel
+		static FDirtyRect Cell(int32_t X, int32_t Y) { return { X & ~7, Y & ~7, (X & ~7) + 8, (Y & ~7) + 8 }; }
+
+		bool IsEmpty() const { return MinX >= MaxX || MinY >= MaxY; }
+		int32_t GetWidth() const { return MaxX - MinX; }
+		int32_t GetHeight() const { return MaxY - MinY; }
+
+		void Add(const FDirtyRect& Other);
+		void Clamp(int32_t Width, int32_t Height);
+		void Reset() { *this = FDirtyRect(); }
+	};
+
+	// CPU copy of a texture, regions are converted into it and only the accumulated dirty rectangle is uploaded
+	struct FTextureStaging
+	{
+		int32_t Width = 0;
+		int32_t Height = 0;
+		std::vector<uint32_t> RGBA;
+		FDirtyRect Dirty;
+
+		// returns true if the size changed, the whole image is dirty then
+		bool Resize(int32_t InWidth, int32_t InHeight);
+		uint32_t* GetRow(int32_t Y) { return RGBA.data() + static_cast<size_t>(Y) * Width; }
+		FDirtyRect ConsumeDirty();
+	};
+
+	// conversion of index colors (1 color per pixel) of the region into the staging
+	// returns the converted region, the whole image when the staging was resized
+	FDirtyRect ZXIndexColorToStaging(
+		FTextureStaging& Staging,
+		const std::vector<uint8_t>& IndexedData,
+		int32_t Width, int32_t Height,
+		FDirtyRect Region);
+
+	// conversion of ZX format of the region into the staging, same rules as ZXAttributeColorToImage
+	FDirtyRect ZXAttributeColorToStaging(
+		FTextureStaging& Staging,
+		int32_t Width, int32_t Height,
+		const uint8_t* InkData,
+		const uint8_t* AttributeData,
+		const uint8_t* MaskData,
+		FDirtyRect Region,
+		std::vector<uint8_t>* OutputIndexedData = nullptr,
+		bool bMaskInverse = true,
+		bool bTransparentMask = false,
+		bool bTransparentPaper = false);
+}
@@ -1,16 +1,208 @@
 #include "UndoQueue.h"
 
+namespace
+{
+    // zero gaps shorter than this are cheaper to keep inside a literal than to split the record
+    constexpr size_t MinZeroRun = 3;
+    // freed pages kept for reuse, the rest give their memory back
+    constexpr size_t MaxFreePages = 8;
+
+    void WriteVarint(std::vector<uint8_t>& Output, size_t Value)
+    {
+        while (Value >= 0x80)
+        {
+            Output.push_back(uint8_t(Value | 0x80));
+            Value >>= 7;
+        }
+        Output.push_back(uint8_t(Value));
+    }
+
+    size_t ReadVarint(const uint8_t*& Input)
+    {
+        size_t Value = 0;
+        for (uint32_t Shift = 0; ; Shift += 7)
+        {
+            const uint8_t Byte = *Input++;
+            Value |= size_t(Byte & 0x7F) << Shift;
+            if (!(Byte & 0x80))
+            {
+                return Value;
+            }
+        }
+    }
+
+    bool IsMarker(const Undo::FActionPtr& Action)
+    {
+        return dynamic_cast<Undo::FContinuousMarkerAction*>(Action.get()) != nullptr;
+    }
+}
+
 namespace Undo
 {
+    FArena::FBlock FArena::Allocate(size_t Size)
+    {
+        if (CurrentPage == INDEX_NONE || Pages[CurrentPage].Used + Size > Pages[CurrentPage].Data.size())
+        {
+            if (FreePages.empty())
+            {
+                CurrentPage = (int32_t)Pages.size();
+                Pages.emplace_back();
+            }
+            else
+            {
+                CurrentPage = FreePages.back();
+                FreePages.pop_back();
+            }
+
+            // a delta bigger than a page gets a page of its own
+            FPage& Page = Pages[CurrentPage];
+            Page.Data.resize((std::max)(PageSize, Size));
+            Page.Used = 0;
+            Page.References = 0;
+        }
+
+        FPage& Page = Pages[CurrentPage];
+        FBlock Block{ CurrentPage, (uint32_t)Page.Used, (uint32_t)Size };
+        Page.Used += Size;
+        ++Page.References;
+        return Block;
+    }
+
+    void FArena::Release(const FBlock& Block)
+    {
+        if (Block.Page == INDEX_NONE)
+        {
+            return;
+        }
+
+        FPage& Page = Pages[Block.Page];
+        if (--Page.References > 0)
+        {
+            return;
+        }
+
+        if (Block.Page == CurrentPage)
+        {
+            // nothing else lives in it, keep filling it from the start
+            Page.Used = 0;
+            return;
+        }
+
+        if (FreePages.size() >= MaxFreePages || Page.Data.size() > PageSize)
+        {
+            Page.Data = {};
+        }
+        FreePages.push_back(Block.Page);
+    }
+
+    FDeltaAction::~FDeltaAction()
+    {
+        for (const FBufferDelta& Delta : Deltas)
+        {
+            Arena->Release(Delta.Block);
+        }
+    }
+
+    void FDeltaAction::Execute()
+    {
+        for (const FBufferDelta& Delta : Deltas)
+        {
+            // the buffer was reallocated for another image since, the delta doesn't describe it anymore
+            if (Delta.Buffer->size() != Delta.BufferSize)
+            {
+                continue;
+            }
+
+            uint8_t* Output = Delta.Buffer->data() + Delta.Begin;
+            const uint8_t* Input = Arena->GetData(Delta.Block);
+            const uint8_t* End = Input + Delta.Block.Size;
+            while (Input < End)
+            {
+                Output += ReadVarint(Input);
+                const size_t Count = ReadVarint(Input);
+                for (size_t Index = 0; Index < Count; ++Index)
+                {
+                    *Output++ ^= *Input++;
+                }
+            }
+        }
+
+        if (OnApplied)
+        {
+            OnApplied();
+        }
+    }
+
+    size_t FDeltaAction::GetSize() const
+    {
+        size_t Result = sizeof(*this) + Deltas.size() * sizeof(FBufferDelta);
+        for (const FBufferDelta& Delta : Deltas)
+        {
+            Result += Delta.Block.Size;
+        }
+        return Result;
+    }
+
+    void FDeltaAction::Encode(const uint8_t* Before, const uint8_t* After, size_t Size, std::vector<uint8_t>& Output)
+    {
+        Output.clear();
+
+        size_t Index = 0;
+        while (Index < Size)
+        {
+            const size_t ZeroBegin = Index;
+            while (Index < Size && Before[Index] == After[Index])
+            {
+                ++Index;
+            }
+            if (Index == Size)
+            {
+                break;
+            }
+
+            // the literal runs until a zero gap long enough to be worth a new record
+            const size_t LiteralBegin = Index;
+            size_t LiteralEnd = Index;
+            while (Index < Size)
+            {
+                if (Before[Index] != After[Index])
+                {
+                    LiteralEnd = ++Index;
+                }
+                else if (++Index - LiteralEnd >= MinZeroRun)
+                {
+                    break;
+                }
+            }
+            Index = LiteralEnd;
+
+            WriteVarint(Output, LiteralBegin - ZeroBegin);
+            WriteVarint(Output, LiteralEnd - LiteralBegin);
+            for (size_t Literal = LiteralBegin; Literal < LiteralEnd; ++Literal)
+            {
+                Output.push_back(Before[Literal] ^ After[Literal]);
+            }
+        }
+    }
+
+    FQueue::FQueue(size_t InBudget /*= 32 * 1024 * 1024*/)
+        : Budget(InBudget)
+        , Arena(std::make_shared<FArena>())
+    {}
+
     void FQueue::SetWithUndo(FActionPtr Action)
     {
         Action->Execute();
-        UndoStack.push(Action);
-        RedoStack = {};
+        Push(Action);
     }
 
     void FQueue::Undo()
     {
+        if (bIsRecordingDelta)
+        {
+            EndDelta();
+        }
+
         if (UndoStack.empty())
         {
             return;
@@ -18,12 +210,12 @@ namespace Undo
 
         while (!UndoStack.empty())
         {
-            FActionPtr Action = UndoStack.top();
-            UndoStack.pop();
+            FActionPtr Action = UndoStack.back();
+            UndoStack.pop_back();
             Action->Execute();
-            RedoStack.push(Action);
+            RedoStack.push_back(Action);
 
-            if (dynamic_cast<FContinuousMarkerAction*>(Action.get()))
+            if (IsMarker(Action))
             {
                 break;
             }
@@ -36,32 +228,146 @@ namespace Undo
         {
             return;
         }
-        while (!RedoStack.empty())
+        // the marker of the step comes back first, then everything up to the marker of the next step
+        do
         {
-            FActionPtr Action = RedoStack.top();
-            RedoStack.pop();
+            FActionPtr Action = RedoStack.back();
+            RedoStack.pop_back();
             Action->Execute();
-            UndoStack.push(Action);
-
-            if (dynamic_cast<FContinuousMarkerAction*>(Action.get()))
-            {
-                break;
-            }
-        }
+            UndoStack.push_back(Action);
+        } while (!RedoStack.empty() && !IsMarker(RedoStack.back()));
     }
 
     void FQueue::Clear()
     {
-        UndoStack = {};
-        RedoStack = {};
+        UndoStack.clear();
+        RedoStack.clear();
+        Size = 0;
+        bIsContinuous = false;
+        bIsRecordingDelta = false;
+        DeltaBuffers.clear();
+        DeltaOnApplied = nullptr;
     }
     void FQueue::BeginContinuous()
     {
         bIsContinuous = true;
-        UndoStack.push(std::make_shared<FContinuousMarkerAction>());
+        Push(std::make_shared<FContinuousMarkerAction>());
     }
     void FQueue::EndContinuous()
     {
         bIsContinuous = false;
     }
-}
\ No newline at end of file
+
+    void FQueue::BeginDelta(std::vector<std::vector<uint8_t>*> Buffers, std::function<void()> OnApplied)
+    {
+        if (bIsRecordingDelta)
+        {
+            EndDelta();
+        }
+
+        bIsRecordingDelta = true;
+        DeltaBuffers = std::move(Buffers);
+        DeltaOnApplied = std::move(OnApplied);
+
+        // the snapshots keep their capacity between steps
+        DeltaSnapshots.resize(DeltaBuffers.size());
+        for (size_t Index = 0; Index < DeltaBuffers.size(); ++Index)
+        {
+            DeltaSnapshots[Index].assign(DeltaBuffers[Index]->begin(), DeltaBuffers[Index]->end());
+        }
+    }
+
+    void FQueue::EndDelta()
+    {
+        if (!bIsRecordingDelta)
+        {
+            return;
+        }
+        bIsRecordingDelta = false;
+
+        std::vector<FDeltaAction::FBufferDelta> Deltas;
+        for (size_t Index = 0; Index < DeltaBuffers.size(); ++Index)
+        {
+            const std::vector<uint8_t>& Before = DeltaSnapshots[Index];
+            std::vector<uint8_t>& After = *DeltaBuffers[Index];
+            if (Before.size() != After.size())
+            {
+                continue;
+            }
+
+            // changed range
+            const size_t First = std::mismatch(Before.begin(), Before.end(), After.begin()).first - Before.begin();
+            if (First == Before.size())
+            {
+                continue;
+            }
+            const size_t Last = Before.size() - (std::mismatch(Before.rbegin(), Before.rend(), After.rbegin()).first - Before.rbegin());
+
+            FDeltaAction::Encode(Before.data() + First, After.data() + First, Last - First, DeltaScratch);
+
+            FDeltaAction::FBufferDelta& Delta = Deltas.emplace_back();
+            Delta.Buffer = &After;
+            Delta.BufferSize = After.size();
+            Delta.Begin = First;
+            Delta.Block = Arena->Allocate(DeltaScratch.size());
+            std::memcpy(Arena->GetData(Delta.Block), DeltaScratch.data(), DeltaScratch.size());
+        }
+
+        DeltaBuffers.clear();
+        if (Deltas.empty())
+        {
+            DeltaOnApplied = nullptr;
+            return;
+        }
+
+        Push(std::make_shared<FContinuousMarkerAction>());
+        Push(std::make_shared<FDeltaAction>(Arena, std::move(Deltas), std::move(DeltaOnApplied)));
+        DeltaOnApplied = nullptr;
+    }
+
+    void FQueue::SetBudget(size_t InBudget)
+    {
+        Budget = InBudget;
+        Evict();
+    }
+
+    void FQueue::Push(FActionPtr Action)
+    {
+        ClearRedo();
+        Size += Action->GetSize();
+        UndoStack.push_back(std::move(Action));
+        Evict();
+    }
+
+    void FQueue::ClearRedo()
+    {
+        for (const FActionPtr& Action : RedoStack)
+        {
+            Size -= Action->GetSize();
+        }
+        RedoStack.clear();
+    }
+
+    void FQueue::Evict()
+    {
+        while (Size > Budget && !UndoStack.empty())
+        {
+            // a step is the marker and everything pushed after it
+            size_t End = 1;
+            while (End < UndoStack.size() && !IsMarker(UndoStack[End]))
+            {
+                ++End;
+            }
+            if (End == UndoStack.size())
+            {
+                break;
+            }
+
+            for (; End > 0; --End)
+            {
+                Size -= UndoStack.front()->GetSize();
+                UndoStack.pop_front();
+            }
+        }
+    }
+}
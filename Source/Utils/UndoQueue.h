@@ -1,5 +1,6 @@
 #pragma once
 
+#include <deque>
 #include <CoreMinimal.h>
 
 namespace Undo
@@ -8,6 +9,8 @@ namespace Undo
     {
     public:
         virtual void Execute() = 0;
+        // bytes held by the action, counted against the budget of the queue
+        virtual size_t GetSize() const { return 0; }
         virtual ~IAction() {}
     };
 
@@ -40,9 +43,73 @@ namespace Undo
         TArg Param;
     };
 
+    // pages shared by the deltas, a page goes back to the pool once no delta references it
+    class FArena
+    {
+    public:
+        static constexpr size_t PageSize = 64 * 1024;
+
+        struct FBlock
+        {
+            int32_t Page = INDEX_NONE;
+            uint32_t Offset = 0;
+            uint32_t Size = 0;
+        };
+
+        FBlock Allocate(size_t Size);
+        void Release(const FBlock& Block);
+        uint8_t* GetData(const FBlock& Block) { return Pages[Block.Page].Data.data() + Block.Offset; }
+
+    private:
+        struct FPage
+        {
+            std::vector<uint8_t> Data;
+            size_t Used = 0;
+            int32_t References = 0;
+        };
+
+        std::vector<FPage> Pages;
+        std::vector<int32_t> FreePages;
+        int32_t CurrentPage = INDEX_NONE;
+    };
+
+    // XOR of the before/after states of a set of buffers, run-length encoded over the changed range,
+    // XOR is its own inverse so the same call undoes and redoes it in O(changed bytes)
+    class FDeltaAction : public IAction
+    {
+    public:
+        struct FBufferDelta
+        {
+            std::vector<uint8_t>* Buffer = nullptr;
+            size_t BufferSize = 0;
+            size_t Begin = 0;
+            FArena::FBlock Block;
+        };
+
+        FDeltaAction(std::shared_ptr<FArena> InArena, std::vector<FBufferDelta>&& InDeltas, std::function<void()> InOnApplied)
+            : Arena(std::move(InArena))
+            , Deltas(std::move(InDeltas))
+            , OnApplied(std::move(InOnApplied))
+        {}
+        ~FDeltaAction() override;
+
+        void Execute() override;
+        size_t GetSize() const override;
+
+        // (zero run, literal count, literal bytes) records of Before ^ After
+        static void Encode(const uint8_t* Before, const uint8_t* After, size_t Size, std::vector<uint8_t>& Output);
+
+    private:
+        std::shared_ptr<FArena> Arena;
+        std::vector<FBufferDelta> Deltas;
+        std::function<void()> OnApplied;
+    };
+
     class FQueue
     {
     public:
+        FQueue(size_t InBudget = 32 * 1024 * 1024);
+
         void SetWithUndo(FActionPtr Action);
         void Undo();
         void Redo();
@@ -52,12 +119,34 @@ namespace Undo
         void EndContinuous();
         bool IsContinuous() const { return bIsContinuous; }
         size_t UndoSize() const { return UndoStack.size(); }
-        std::stack<FActionPtr>& GetUndoStack() { return UndoStack; }
+
+        // snapshots the buffers, the caller edits them in place and EndDelta records the difference as one step,
+        // OnApplied is called after every undo/redo of the step
+        void BeginDelta(std::vector<std::vector<uint8_t>*> Buffers, std::function<void()> OnApplied);
+        void EndDelta();
+        bool IsRecordingDelta() const { return bIsRecordingDelta; }
+
+        // the oldest steps are dropped once the actions hold more than this, the last step always stays
+        void SetBudget(size_t InBudget);
+        size_t GetSize() const { return Size; }
 
     private:
-        std::stack<FActionPtr> UndoStack;
-        std::stack<FActionPtr> RedoStack;
+        void Push(FActionPtr Action);
+        void ClearRedo();
+        void Evict();
+
+        std::deque<FActionPtr> UndoStack;
+        std::deque<FActionPtr> RedoStack;
+        size_t Budget;
+        size_t Size = 0;
+
+        std::shared_ptr<FArena> Arena;
+        std::vector<std::vector<uint8_t>*> DeltaBuffers;
+        std::vector<std::vector<uint8_t>> DeltaSnapshots;
+        std::vector<uint8_t> DeltaScratch;
+        std::function<void()> DeltaOnApplied;
 
         bool bIsContinuous = false;
+        bool bIsRecordingDelta = false;
     };
 }
@@ -223,7 +223,7 @@ void SFileDialog::ReadDirectory(const std::string& Path)
 		{
 			if (ErrorCode)
 			{
-				LOG_ERROR("Can't open file : %s", FileIt.path().string().c_str());
+				LOG_ERROR("Can't open file : {}", FileIt.path().string());
 				continue;
 			}
 
@@ -239,7 +239,7 @@ void SFileDialog::ReadDirectory(const std::string& Path)
 	}
 	catch (const std::exception& Exception)
 	{
-		LOG_ERROR(Exception.what());
+		LOG_ERROR("{}", Exception.what());
 	}
 
 	ApplyFilterTypes();
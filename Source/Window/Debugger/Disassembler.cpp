@@ -17,11 +17,26 @@ namespace
 	static constexpr float ColumnWidth_Breakpoint = 2;
 	static constexpr float ColumnWidth_PrefixAddress = 10.0f;
 	static constexpr float ColumnWidth_Address = 50.0f;
+	static constexpr float ColumnWidth_Heat = 40.0f;
 	static constexpr float ColumnWidth_Opcode = 80.0f;
 	static constexpr float ColumnWidth_Instruction = 200.0f;
 
 	#define FORMAT_ADDRESS(upper)		(upper ? "%04X" : "%04x")
 	#define FORMAT_OPCODE(upper)		(upper ? "{:02X}" : "{:02x}")
+
+	static const char* CodeProfilerReportFilename = "CodeProfile.txt";
+	static constexpr float CodeProfilerRefreshRate = 0.25f;
+
+	// fits the narrow heat column: 999, 12K, 3.4M
+	std::string FormatCounter(uint64_t Value)
+	{
+		if (Value >= 10'000'000'000ull)	return std::format("{}G", Value / 1'000'000'000ull);
+		if (Value >= 1'000'000'000ull)	return std::format("{:.1f}G", double(Value) * 1e-9);
+		if (Value >= 10'000'000ull)		return std::format("{}M", Value / 1'000'000ull);
+		if (Value >= 1'000'000ull)		return std::format("{:.1f}M", double(Value) * 1e-6);
+		if (Value >= 10'000ull)			return std::format("{}K", Value / 1'000ull);
+		return std::format("{}", Value);
+	}
 }
 
 namespace Disassembler
@@ -1124,6 +1139,7 @@ SDisassembler::SDisassembler(EFont::Type _FontName)
 	, bShowOpcode(true)
 	, bAddressUpperCaseHex(true)
 	, bInstructionUpperCaseHex(false)
+	, bHeatByTStates(true)
 	, CodeDisassemblerScale(1.0f)
 	, bEditingTakeFocusReset(false)
 	, bAddressEditingTakeFocus(false)
@@ -1139,6 +1155,8 @@ SDisassembler::SDisassembler(EFont::Type _FontName)
 	, TimeElapsedCounter(INDEX_NONE)
 	, LatestClockCounter(INDEX_NONE)
 	, Status(EThreadStatus::Unknown)
+	, bCodeProfiler(false)
+	, CodeProfilerRefreshTime(0.0f)
 {}
 
 void SDisassembler::Initialize(const std::vector<std::any>& Args)
@@ -1163,6 +1181,7 @@ void SDisassembler::SetupHotKeys()
 		{ ImGuiKey_PageDown,						ImGuiInputFlags_Repeat,	std::bind(&ThisClass::Input_PageDown,			Self)			},	// debugger: page down
 
 		{ ImGuiMod_Ctrl | ImGuiKey_G,				ImGuiInputFlags_Repeat,	std::bind(&ThisClass::Input_GoToAddress,		Self)			},	// debugger: go to address
+		{ ImGuiMod_Ctrl | ImGuiKey_P,				ImGuiInputFlags_None,	std::bind(&ThisClass::Input_CodeProfiler,		Self)			},	// debugger: code profiler			(ctrl + p)
 
 		{ ImGuiKey_F5,								ImGuiInputFlags_Repeat, std::bind(&ThisClass::Input_Step, Self, FCPU_StepType::StepTo)	},	// debugger: step into				(f4)
 		{ ImGuiKey_F7,								ImGuiInputFlags_Repeat,	std::bind(&ThisClass::Input_Step, Self, FCPU_StepType::StepInto)},	// debugger: step into				(f7)
@@ -1182,6 +1201,20 @@ void SDisassembler::Tick(float DeltaTime)
 			Load_MemorySnapshot();
 			TimeElapsedCounter = (ClockCounter - LatestClockCounter) >> 2;
 			LatestClockCounter = ClockCounter;
+			if (bCodeProfiler)
+			{
+				Load_CodeProfilerSnapshot();
+			}
+		}
+	}
+
+	// the counters are copied from the emulation thread, a few times a second is enough for the heat column
+	if (bCodeProfiler && Status == EThreadStatus::Run)
+	{
+		CodeProfilerRefreshTime -= DeltaTime;
+		if (CodeProfilerRefreshTime <= 0.0f)
+		{
+			Load_CodeProfilerSnapshot();
 		}
 	}
 
@@ -1246,6 +1279,28 @@ void SDisassembler::Upload_MemorySnapshot()
 	GetMotherboard().SetState<FMemorySnapshot>(NAME_MainBoard, NAME_Memory, Snapshot);
 }
 
+void SDisassembler::Load_CodeProfilerSnapshot()
+{
+	CodeProfilerSnapshot = GetMotherboard().GetState<FCodeProfilerSnapshot>(NAME_MainBoard, NAME_None);
+	CodeProfilerRefreshTime = CodeProfilerRefreshRate;
+}
+
+void SDisassembler::Export_CodeProfilerReport()
+{
+	Load_CodeProfilerSnapshot();
+
+	const std::filesystem::path FilePath = FAppFramework::GetPath(EPathType::Export) / CodeProfilerReportFilename;
+	if (CodeProfilerSnapshot.ExportReport(FilePath))
+	{
+		LOG("Code profiler report: {}", FilePath.string());
+	}
+}
+
+bool SDisassembler::IsHeatVisible() const
+{
+	return bCodeProfiler || !CodeProfilerSnapshot.IsEmpty();
+}
+
 void SDisassembler::Draw_CodeDisassembler(EThreadStatus Status)
 {
 	if (LatestClockCounter == INDEX_NONE)
@@ -1296,7 +1351,8 @@ void SDisassembler::Draw_CodeDisassembler(EThreadStatus Status)
 
 		CodeDisassemblerID = ImGui::GetCurrentWindow()->ID;
 
-		const int32_t ColumnsNum = 3 + bMemoryArea + bShowOpcode;
+		const bool bShowHeat = IsHeatVisible();
+		const int32_t ColumnsNum = 3 + bMemoryArea + bShowHeat + bShowOpcode;
 		if (ImGui::BeginTable("##Disassembler", ColumnsNum,
 			ImGuiTableFlags_NoPadOuterX |
 			ImGuiTableFlags_NoClip |
@@ -1307,6 +1363,7 @@ void SDisassembler::Draw_CodeDisassembler(EThreadStatus Status)
 			ImGui::TableSetupColumn("Breakpoint", ImGuiTableColumnFlags_WidthFixed | ImGuiTableColumnFlags_NoResize, ColumnWidth_Breakpoint * CodeDisassemblerScale);
 			if (bMemoryArea) ImGui::TableSetupColumn("PrefixAddress", ImGuiTableColumnFlags_WidthFixed | ImGuiTableColumnFlags_NoResize, ColumnWidth_PrefixAddress * CodeDisassemblerScale);
 			ImGui::TableSetupColumn("Address", ImGuiTableColumnFlags_WidthFixed | ImGuiTableColumnFlags_NoResize, ColumnWidth_Address * CodeDisassemblerScale);
+			if (bShowHeat) ImGui::TableSetupColumn("Heat", ImGuiTableColumnFlags_WidthFixed | ImGuiTableColumnFlags_NoResize, ColumnWidth_Heat * CodeDisassemblerScale);
 			if (bShowOpcode) ImGui::TableSetupColumn("Opcode", ImGuiTableColumnFlags_WidthFixed | ImGuiTableColumnFlags_NoResize, ColumnWidth_Opcode * CodeDisassemblerScale);
 			ImGui::TableSetupColumn("Instruction", ImGuiTableColumnFlags_WidthStretch, ColumnWidth_Instruction * CodeDisassemblerScale);
 
@@ -1441,6 +1498,10 @@ void SDisassembler::Draw_CodeDisassembler(EThreadStatus Status)
 
 					Draw_Breakpoint(StartAddress);
 					Draw_Address(StartAddress, i);
+					if (bShowHeat)
+					{
+						Draw_Heat(StartAddress);
+					}
 					if (bShowOpcode)
 					{
 						Draw_OpcodeInstruction(StartAddress, Opcodes, i);
@@ -1480,6 +1541,8 @@ void SDisassembler::Draw_CodeDisassembler(EThreadStatus Status)
 		}
 		ImGui::PopStyleVar(2);
 		ImGui::PopFont();
+
+		Draw_ContextMenu();
 	}
 
 	ImGui::EndChild();
@@ -1648,6 +1711,70 @@ void SDisassembler::Draw_Address(uint16_t Address, int32_t CurrentLine)
 	ImGui::PopStyleColor();
 }
 
+void SDisassembler::Draw_Heat(uint16_t Address)
+{
+	ImGui::TableNextColumn();
+	ImGui::TableSetBgColor(ImGuiTableBgTarget_CellBg, COL_CONST32(UI::COLOR_DISASM_BG_HEAT));
+
+	if (CodeProfilerSnapshot.ExecutionCount.empty() || CodeProfilerSnapshot.ExecutionCount[Address] == 0)
+	{
+		return;
+	}
+
+	const uint64_t ExecutionCount = CodeProfilerSnapshot.ExecutionCount[Address];
+	const uint64_t TStates = CodeProfilerSnapshot.TStates[Address];
+	const uint64_t Value = bHeatByTStates ? TStates : ExecutionCount;
+	const uint64_t MaxValue = bHeatByTStates ? CodeProfilerSnapshot.MaxTStates : CodeProfilerSnapshot.MaxExecutionCount;
+
+	// logarithmic scale, otherwise a single hot loop leaves the rest of the code cold
+	const float Heat = MaxValue > 1 ? float(std::log1p(double(Value)) / std::log1p(double(MaxValue))) : 1.0f;
+	const ImVec4 Color = ImLerp(COL_CONST(UI::COLOR_DISASM_HEAT_COLD), COL_CONST(UI::COLOR_DISASM_HEAT_HOT), ImSaturate(Heat));
+	ImGui::TableSetBgColor(ImGuiTableBgTarget_CellBg, UI::ColorToU32(Color));
+
+	ImGui::PushStyleColor(ImGuiCol_Text, COL_CONST(UI::COLOR_DISASM_ADDRESS));
+	ImGui::TextUnformatted(FormatCounter(Value).c_str());
+	ImGui::PopStyleColor();
+
+	if (ImGui::IsItemHovered())
+	{
+		const double Share = CodeProfilerSnapshot.TotalTStates > 0 ? 100.0 * double(TStates) / double(CodeProfilerSnapshot.TotalTStates) : 0.0;
+		ImGui::SetTooltip("#%04X\nExecuted: %llu\nT-states: %llu (%.2f%%)\nAverage: %.1f T",
+			Address, (unsigned long long)ExecutionCount, (unsigned long long)TStates, Share, double(TStates) / double(ExecutionCount));
+	}
+}
+
+void SDisassembler::Draw_ContextMenu()
+{
+	if (!ImGui::BeginPopupContextWindow("##DisassemblerContextMenu"))
+	{
+		return;
+	}
+
+	if (ImGui::MenuItem("Code profiler", "Ctrl+P", bCodeProfiler))
+	{
+		Input_CodeProfiler();
+	}
+	if (ImGui::MenuItem("Heat by T-states", nullptr, bHeatByTStates))
+	{
+		bHeatByTStates = true;
+	}
+	if (ImGui::MenuItem("Heat by execution count", nullptr, !bHeatByTStates))
+	{
+		bHeatByTStates = false;
+	}
+	ImGui::Separator();
+	if (ImGui::MenuItem("Reset profiler", nullptr, false, IsHeatVisible()))
+	{
+		GetMotherboard().ResetCodeProfiler();
+		Load_CodeProfilerSnapshot();
+	}
+	if (ImGui::MenuItem("Export profiler report", nullptr, false, !CodeProfilerSnapshot.IsEmpty()))
+	{
+		Export_CodeProfilerReport();
+	}
+	ImGui::EndPopup();
+}
+
 void SDisassembler::Draw_OpcodeInstruction(uint16_t Address, const std::string& Opcodes, int32_t CurrentLine)
 {
 
@@ -2183,6 +2310,13 @@ void SDisassembler::Input_GoToAddress()
 	InputActionEvent.Type = EDisassemblerInput::Input_GoToAddress;
 }
 
+void SDisassembler::Input_CodeProfiler()
+{
+	bCodeProfiler = !bCodeProfiler;
+	GetMotherboard().SetCodeProfiler(bCodeProfiler);
+	Load_CodeProfilerSnapshot();
+}
+
 void SDisassembler::OnInputDebugger(bool bDebuggerState)
 {
 	if (bDebuggerState /*true = enter debugger*/)
@@ -5,6 +5,7 @@
 #include <Core/Image.h>
 #include "Devices/CPU/Interface_CPU_Z80.h"
 #include "Devices/Memory/Interface_Memory.h"
+#include "Motherboard/Motherboard_CodeProfiler.h"
 
 class FMotherboard;
 enum class EThreadStatus;
@@ -74,10 +75,15 @@ private:
 
 	void Load_MemorySnapshot();
 	void Upload_MemorySnapshot();
+	void Load_CodeProfilerSnapshot();
+	void Export_CodeProfilerReport();
+	bool IsHeatVisible() const;
 
 	void Draw_CodeDisassembler(EThreadStatus Status);
 	void Draw_Breakpoint(uint16_t Address);
 	void Draw_Address(uint16_t Address, int32_t CurrentLine);
+	void Draw_Heat(uint16_t Address);
+	void Draw_ContextMenu();
 	void Draw_OpcodeInstruction(uint16_t Address, const std::string& Opcodes, int32_t CurrentLine);
 	void Draw_Instruction(uint16_t Address, const std::string& Command, int32_t CurrentLine);
 	void Draw_ProgramCounter(uint16_t Address);
@@ -103,6 +109,7 @@ private:
 	void Input_PageUp();
 	void Input_PageDown();
 	void Input_GoToAddress();
+	void Input_CodeProfiler();
 
 	// events
 	virtual void OnInputDebugger(bool bDebuggerState) override;
@@ -113,6 +120,7 @@ private:
 	bool bShowOpcode;
 	bool bAddressUpperCaseHex;			// display hexadecimal values as "FF" instead of "ff"
 	bool bInstructionUpperCaseHex;		// display hexadecimal values as "FF" instead of "ff"
+	bool bHeatByTStates;				// the heat column shows the time spent instead of the execution count
 
 	// windows ID
 	ImGuiID CodeDisassemblerID;
@@ -144,4 +152,9 @@ private:
 	EThreadStatus Status;
 	FMemorySnapshot Snapshot;
 	std::vector<uint8_t> AddressSpace;
+
+	// code profiler
+	bool bCodeProfiler;
+	float CodeProfilerRefreshTime;
+	FCodeProfilerSnapshot CodeProfilerSnapshot;
 };
@@ -15,6 +15,14 @@ namespace
 	// set column widths
 	static constexpr float ColumnWidth_Breakpoint = 2;
 	static constexpr float ColumnWidth_PrefixAddress = 10.0f;
+
+	static constexpr float MemoryTrackerRefreshRate = 0.1f;
+
+	// the counters saturate at 65535, a logarithmic scale keeps a single access visible
+	float ToHeat(uint16_t Counter)
+	{
+		return Counter > 0 ? ImSaturate(std::log2(1.0f + Counter) / 16.0f) * 0.75f + 0.25f : 0.0f;
+	}
 }
 
 SMemoryDump::SMemoryDump(EFont::Type _FontName)
@@ -25,23 +33,54 @@ SMemoryDump::SMemoryDump(EFont::Type _FontName)
 	, bMemoryArea(false)
 	, bASCII_Values(true)
 	, bShowStatusBar(true)
+	, bHeatmap(true)
+	, bHighlightChanges(true)
 	, ColumnsToDisplay(16)
 	, BaseDisplayAddress(0)
 	, MemoryDumpScale(1.0f)
 	, LatestClockCounter(INDEX_NONE)
 	, Status(EThreadStatus::Unknown)
+	, bMemoryTracker(false)
+	, MemoryTrackerRefreshTime(0.0f)
+	, StopClockCounter(INDEX_NONE)
+	, ReferenceClockCounter(INDEX_NONE)
 {}
 
 void SMemoryDump::Tick(float DeltaTime)
 {
+	// the emulation thread counts the accesses only while somebody looks at them
+	if (bMemoryTracker != IsOpen())
+	{
+		bMemoryTracker = IsOpen();
+		GetMotherboard().SetMemoryTracker(bMemoryTracker);
+		LatestClockCounter = INDEX_NONE;
+	}
+	if (!bMemoryTracker)
+	{
+		return;
+	}
+
 	Status = GetMotherboard().GetState<EThreadStatus>(NAME_MainBoard, NAME_None);
 	if (Status == EThreadStatus::Stop)
 	{
 		const uint64_t ClockCounter = GetMotherboard().GetState<uint64_t>(NAME_MainBoard, NAME_None);
 		if (ClockCounter != LatestClockCounter || ClockCounter == INDEX_NONE)
 		{
-			Load_MemorySnapshot();
+			Load_MemoryDelta();
 			LatestClockCounter = ClockCounter;
+
+			ReferenceClockCounter = StopClockCounter;
+			ReferenceAddressSpace.swap(StopAddressSpace);
+			StopClockCounter = ClockCounter;
+			StopAddressSpace = AddressSpace;
+		}
+	}
+	else if (Status == EThreadStatus::Run)
+	{
+		MemoryTrackerRefreshTime -= DeltaTime;
+		if (MemoryTrackerRefreshTime <= 0.0f)
+		{
+			Load_MemoryDelta();
 		}
 	}
 }
@@ -148,7 +187,29 @@ void SMemoryDump::Draw_DumpMemory()
 
 							uint8_t& MemoryValue = AddressSpace[Address];
 
-							if (MemoryValue == 0)
+							const ImVec2 CellPos = ImGui::GetCursorScreenPos();
+							const ImVec2 CellSize = ImVec2(GlyphWidth * 2.0f, TextHeight);
+							if (bHeatmap)
+							{
+								if (const ImU32 HeatColor = GetHeatColor(Address))
+								{
+									DrawList->AddRectFilled(CellPos, CellPos + CellSize, HeatColor);
+								}
+							}
+
+							bool bChanged = false;
+							bool bRewritten = false;
+							if (bHighlightChanges && !ReferenceAddressSpace.empty())
+							{
+								bChanged = ReferenceAddressSpace[Address] != MemoryValue;
+								bRewritten = !bChanged && LastWriteClock[Address] != INDEX_NONE && LastWriteClock[Address] > ReferenceClockCounter;
+							}
+
+							if (bChanged)
+							{
+								ImGui::TextColored(COL_CONST(UI::COLOR_MEMDUMP_CHANGED), "%02X ", MemoryValue);
+							}
+							else if (MemoryValue == 0)
 							{
 								ImGui::TextDisabled("00 ");
 							}
@@ -156,6 +217,17 @@ void SMemoryDump::Draw_DumpMemory()
 							{
 								ImGui::Text("%02X ", MemoryValue);
 							}
+
+							// written with the same value, the write was wasted
+							if (bRewritten)
+							{
+								DrawList->AddRect(CellPos, CellPos + CellSize, COL_CONST32(UI::COLOR_MEMDUMP_REWRITTEN));
+							}
+
+							if (ImGui::IsItemHovered())
+							{
+								Draw_Tooltip(Address);
+							}
 						}
 
 						// draw ASCII values
@@ -191,6 +263,8 @@ void SMemoryDump::Draw_DumpMemory()
 			}
 			ImGui::PopStyleVar(2);
 			ImGui::PopFont();
+
+			Draw_ContextMenu();
 		}
 
 		ImGui::EndChild();
@@ -232,8 +306,82 @@ void SMemoryDump::Input_Mouse()
 	}
 }
 
-void SMemoryDump::Load_MemorySnapshot()
+void SMemoryDump::Draw_ContextMenu()
+{
+	if (!ImGui::BeginPopupContextWindow("##MemoryDumpContextMenu"))
+	{
+		return;
+	}
+
+	ImGui::MenuItem("Heatmap", nullptr, &bHeatmap);
+	ImGui::MenuItem("Highlight changes since the last stop", nullptr, &bHighlightChanges);
+	ImGui::EndPopup();
+}
+
+void SMemoryDump::Draw_Tooltip(int32_t Address)
 {
-	Snapshot = GetMotherboard().GetState<FMemorySnapshot>(NAME_MainBoard, NAME_Memory);
-	Memory::ToAddressSpace(Snapshot, AddressSpace);
+	if (ReadCount.empty())
+	{
+		return;
+	}
+
+	ImGui::BeginTooltip();
+	ImGui::Text("#%04X: %02X", Address, AddressSpace[Address]);
+	ImGui::TextColored(COL_CONST(UI::COLOR_MEMDUMP_HEAT_READ), "Read: %u", ReadCount[Address]);
+	ImGui::TextColored(COL_CONST(UI::COLOR_MEMDUMP_HEAT_WRITE), "Write: %u", WriteCount[Address]);
+	ImGui::TextColored(COL_CONST(UI::COLOR_MEMDUMP_HEAT_EXECUTE), "Execute: %u", ExecuteCount[Address]);
+	if (LastWriteClock[Address] != INDEX_NONE)
+	{
+		ImGui::Text("Last written: CC #%016llX", (unsigned long long)LastWriteClock[Address]);
+	}
+	ImGui::EndTooltip();
+}
+
+ImU32 SMemoryDump::GetHeatColor(int32_t Address) const
+{
+	if (ReadCount.empty())
+	{
+		return 0;
+	}
+
+	const float Read = ToHeat(ReadCount[Address]);
+	const float Write = ToHeat(WriteCount[Address]);
+	const float Execute = ToHeat(ExecuteCount[Address]);
+	const float Heat = (std::max)({ Read, Write, Execute });
+	if (Heat <= 0.0f)
+	{
+		return 0;
+	}
+
+	// the access types are mixed, a byte both read and written gets both colors
+	const ImVec4 Color =
+		COL_CONST(UI::COLOR_MEMDUMP_HEAT_READ) * Read +
+		COL_CONST(UI::COLOR_MEMDUMP_HEAT_WRITE) * Write +
+		COL_CONST(UI::COLOR_MEMDUMP_HEAT_EXECUTE) * Execute;
+	return UI::ColorToU32(ImVec4(ImSaturate(Color.x), ImSaturate(Color.y), ImSaturate(Color.z), Heat * 0.6f));
+}
+
+void SMemoryDump::Load_MemoryDelta()
+{
+	static constexpr size_t AddressSpaceSize = 0x10000;
+	if (AddressSpace.size() != AddressSpaceSize)
+	{
+		AddressSpace.resize(AddressSpaceSize, 0);
+		ReadCount.resize(AddressSpaceSize, 0);
+		WriteCount.resize(AddressSpaceSize, 0);
+		ExecuteCount.resize(AddressSpaceSize, 0);
+		LastWriteClock.resize(AddressSpaceSize, INDEX_NONE);
+	}
+
+	const FMemoryTrackerDelta Delta = GetMotherboard().GetState<FMemoryTrackerDelta>(NAME_MainBoard, NAME_Memory);
+	for (const FMemoryTrackerPage& Page : Delta.Pages)
+	{
+		const size_t Begin = size_t(Page.Index) * MemoryTracker::PageSize;
+		std::memcpy(&AddressSpace[Begin], Page.Data, sizeof(Page.Data));
+		std::memcpy(&ReadCount[Begin], Page.ReadCount, sizeof(Page.ReadCount));
+		std::memcpy(&WriteCount[Begin], Page.WriteCount, sizeof(Page.WriteCount));
+		std::memcpy(&ExecuteCount[Begin], Page.ExecuteCount, sizeof(Page.ExecuteCount));
+		std::memcpy(&LastWriteClock[Begin], Page.LastWriteClock, sizeof(Page.LastWriteClock));
+	}
+	MemoryTrackerRefreshTime = MemoryTrackerRefreshRate;
 }
@@ -3,6 +3,7 @@
 #include <CoreMinimal.h>
 #include "Viewer.h"
 #include "Devices/Memory/Interface_Memory.h"
+#include "Motherboard/Motherboard_MemoryTracker.h"
 
 class FMotherboard;
 enum class EThreadStatus;
@@ -21,9 +22,12 @@ private:
 	FORCEINLINE FMotherboard& GetMotherboard() const;
 	FORCEINLINE float InaccessibleHeight(int32_t LineNum, int32_t SeparatorNum) const;
 
-	void Load_MemorySnapshot();
+	void Load_MemoryDelta();
 
 	void Draw_DumpMemory();
+	void Draw_ContextMenu();
+	void Draw_Tooltip(int32_t Address);
+	ImU32 GetHeatColor(int32_t Address) const;
 
 	void Input_HotKeys();
 	void Input_Mouse();
@@ -32,6 +36,8 @@ private:
 	bool bMemoryArea;
 	bool bASCII_Values;
 	bool bShowStatusBar;
+	bool bHeatmap;
+	bool bHighlightChanges;			// bytes changed or rewritten since the previous stop
 	int32_t ColumnsToDisplay;
 
 	// windows ID
@@ -45,6 +51,19 @@ private:
 
 	uint64_t LatestClockCounter;
 	EThreadStatus Status;
-	FMemorySnapshot Snapshot;
 	std::vector<uint8_t> AddressSpace;
+
+	// memory access tracking, the mirror is updated with the changed pages only
+	bool bMemoryTracker;
+	float MemoryTrackerRefreshTime;
+	std::vector<uint16_t> ReadCount;
+	std::vector<uint16_t> WriteCount;
+	std::vector<uint16_t> ExecuteCount;
+	std::vector<uint64_t> LastWriteClock;
+
+	// the memory at the latest stop and at the one before, the changes in between are highlighted
+	uint64_t StopClockCounter;
+	uint64_t ReferenceClockCounter;
+	std::vector<uint8_t> StopAddressSpace;
+	std::vector<uint8_t> ReferenceAddressSpace;
 };
@@ -10,6 +10,26 @@ namespace
 {
 	static const wchar_t* ThisWindowName = L"Screen";
 	static const char* ResourcePathName = TEXT("SHADER/ZX");
+
+	// the host keys of the matrix, a key of a few ZX keys is pressed with the shift
+	static const std::pair<ImGuiKey, EZXKey::Type> KeyMap[] =
+	{
+		{ ImGuiKey_1, EZXKey::_1 }, { ImGuiKey_2, EZXKey::_2 }, { ImGuiKey_3, EZXKey::_3 }, { ImGuiKey_4, EZXKey::_4 }, { ImGuiKey_5, EZXKey::_5 },
+		{ ImGuiKey_6, EZXKey::_6 }, { ImGuiKey_7, EZXKey::_7 }, { ImGuiKey_8, EZXKey::_8 }, { ImGuiKey_9, EZXKey::_9 }, { ImGuiKey_0, EZXKey::_0 },
+		{ ImGuiKey_Q, EZXKey::Q }, { ImGuiKey_W, EZXKey::W }, { ImGuiKey_E, EZXKey::E }, { ImGuiKey_R, EZXKey::R }, { ImGuiKey_T, EZXKey::T },
+		{ ImGuiKey_Y, EZXKey::Y }, { ImGuiKey_U, EZXKey::U }, { ImGuiKey_I, EZXKey::I }, { ImGuiKey_O, EZXKey::O }, { ImGuiKey_P, EZXKey::P },
+		{ ImGuiKey_A, EZXKey::A }, { ImGuiKey_S, EZXKey::S }, { ImGuiKey_D, EZXKey::D }, { ImGuiKey_F, EZXKey::F }, { ImGuiKey_G, EZXKey::G },
+		{ ImGuiKey_H, EZXKey::H }, { ImGuiKey_J, EZXKey::J }, { ImGuiKey_K, EZXKey::K }, { ImGuiKey_L, EZXKey::L }, { ImGuiKey_Enter, EZXKey::Enter },
+		{ ImGuiKey_Z, EZXKey::Z }, { ImGuiKey_X, EZXKey::X }, { ImGuiKey_C, EZXKey::C }, { ImGuiKey_V, EZXKey::V }, { ImGuiKey_B, EZXKey::B },
+		{ ImGuiKey_N, EZXKey::N }, { ImGuiKey_M, EZXKey::M }, { ImGuiKey_Space, EZXKey::Space },
+		{ ImGuiKey_LeftShift, EZXKey::CapsShift }, { ImGuiKey_RightShift, EZXKey::SymbolShift },
+		{ ImGuiKey_LeftCtrl, EZXKey::SymbolShift }, { ImGuiKey_RightCtrl, EZXKey::SymbolShift },
+		{ ImGuiKey_Backspace, EZXKey::CapsShift }, { ImGuiKey_Backspace, EZXKey::_0 },
+		{ ImGuiKey_LeftArrow, EZXKey::CapsShift }, { ImGuiKey_LeftArrow, EZXKey::_5 },
+		{ ImGuiKey_DownArrow, EZXKey::CapsShift }, { ImGuiKey_DownArrow, EZXKey::_6 },
+		{ ImGuiKey_UpArrow, EZXKey::CapsShift }, { ImGuiKey_UpArrow, EZXKey::_7 },
+		{ ImGuiKey_RightArrow, EZXKey::CapsShift }, { ImGuiKey_RightArrow, EZXKey::_8 },
+	};
 }
 
 SScreen::SScreen(EFont::Type _FontName)
@@ -18,6 +38,7 @@ SScreen::SScreen(EFont::Type _FontName)
 		.SetFontName(_FontName)
 		.SetIncludeInWindows(true))
 	, bDragging(false)										// is user currently dragging to pan view
+	, PressedKeys{}
 {}
 
 void SScreen::Initialize(const std::vector<std::any>& Args)
@@ -94,6 +115,24 @@ void SScreen::Draw_Display()
 
 void SScreen::Input_HotKeys()
 {
+	// the keys go to the machine while the screen has the focus, the held ones are released when it's lost
+	std::array<bool, EZXKey::Count> Keys{};
+	if (Status == EThreadStatus::Run && ImGui::IsWindowFocused())
+	{
+		for (const auto& [HostKey, Key] : KeyMap)
+		{
+			Keys[Key] |= ImGui::IsKeyDown(HostKey);
+		}
+	}
+
+	for (uint8_t Key = 0; Key < EZXKey::Count; ++Key)
+	{
+		if (Keys[Key] != PressedKeys[Key])
+		{
+			PressedKeys[Key] = Keys[Key];
+			GetMotherboard().Input_Key(EZXKey::Type(Key), Keys[Key]);
+		}
+	}
 }
 
 void SScreen::Input_Mouse()
@@ -4,6 +4,7 @@
 #include "Viewer.h"
 #include "Utils/UI/Draw_ZXColorVideo.h"
 #include "Devices/ControlUnit/Interface_Display.h"
+#include "Devices/IO/Keyboard.h"
 
 class SScreen;
 struct FSpectrumDisplay;
@@ -50,6 +51,7 @@ private:
 	EThreadStatus Status;
 
 	bool bDragging;
+	std::array<bool, EZXKey::Count> PressedKeys;		// as sent to the keyboard
 	std::shared_ptr<UI::FZXColorView> ZXColorView;
 	std::shared_ptr<FSpectrumDisplay> SpectrumDisplay;
 };
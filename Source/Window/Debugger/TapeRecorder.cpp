@@ -0,0 +1,230 @@
+#include "TapeRecorder.h"
+
+#include "AppDebugger.h"
+#include "Motherboard/Motherboard.h"
+
+namespace
+{
+	static const wchar_t* ThisWindowName = L"Tape";
+
+	static constexpr float TapeStatusRefreshRate = 0.25f;
+
+	static constexpr const char* LoadModeNames[] = { "Normal", "Accelerated", "Fast load (ROM trap)" };
+
+	std::string FormatBlock(const FTapeBlock& Block)
+	{
+		switch (Block.Type)
+		{
+			case ETapeBlockType::Data:
+			{
+				if (Block.Data.empty())
+				{
+					return "Data, empty";
+				}
+				// the ROM header names the file
+				if (Block.Data[0] == 0x00 && Block.Data.size() == 19)
+				{
+					static constexpr const char* HeaderTypes[] = { "Program", "Number array", "Character array", "Bytes" };
+					const uint8_t HeaderType = Block.Data[1];
+					const std::string Name(Block.Data.begin() + 2, Block.Data.begin() + 12);
+					return std::format("{}: \"{}\"", HeaderType < std::size(HeaderTypes) ? HeaderTypes[HeaderType] : "Header", Name);
+				}
+				return std::format("{}, {} bytes, flag #{:02X}", Block.PilotPulses != 0 ? "Data" : "Pure data", Block.Data.size(), Block.Data[0]);
+			}
+			case ETapeBlockType::Tone:		return std::format("Tone, {} x {} T", Block.ToneCount, Block.Pulses.empty() ? 0 : Block.Pulses.front());
+			case ETapeBlockType::Pulses:	return std::format("Pulses, {}", Block.Pulses.size());
+			case ETapeBlockType::Pause:		return std::format("Pause, {} ms", Block.PauseMs);
+			case ETapeBlockType::Stop:		return "Stop the tape";
+		}
+		return "";
+	}
+}
+
+STapeRecorder::STapeRecorder(EFont::Type _FontName)
+	: Super(FWindowInitializer()
+		.SetName(ThisWindowName)
+		.SetFontName(_FontName)
+		.SetIncludeInWindows(true))
+	, TapeStatusRefreshTime(0.0f)
+	, LoadMode(ETapeLoadMode::FastLoad)
+	, FilePathBuffer{}
+{}
+
+void STapeRecorder::Tick(float DeltaTime)
+{
+	if (!IsOpen())
+	{
+		return;
+	}
+
+	TapeStatusRefreshTime -= DeltaTime;
+	if (TapeStatusRefreshTime <= 0.0f)
+	{
+		Load_TapeStatus();
+	}
+}
+
+void STapeRecorder::Render()
+{
+	if (!IsOpen())
+	{
+		Close();
+		return;
+	}
+
+	ImGui::Begin(GetWindowName().c_str(), &bOpen);
+	{
+		Draw_Controls();
+		ImGui::Separator();
+		Draw_Blocks();
+
+		ImGui::End();
+	}
+}
+
+FMotherboard& STapeRecorder::GetMotherboard() const
+{
+	return *FAppFramework::Get<FAppDebugger>().Motherboard;
+}
+
+void STapeRecorder::Load_TapeStatus()
+{
+	TapeStatus = GetMotherboard().GetState<FTapeStatus>(NAME_MainBoard, NAME_Tape);
+	TapeStatusRefreshTime = TapeStatusRefreshRate;
+
+	if (TapeStatus.FilePath != ImageFilePath)
+	{
+		ImageFilePath = TapeStatus.FilePath;
+		if (ImageFilePath.empty())
+		{
+			Image.Clear();
+		}
+		else
+		{
+			Image.Load(ImageFilePath);
+		}
+	}
+}
+
+void STapeRecorder::Draw_Controls()
+{
+	ImGui::SetNextItemWidth(-ImGui::CalcTextSize("Insert").x - ImGui::GetStyle().FramePadding.x * 2.0f - ImGui::GetStyle().ItemSpacing.x);
+	if (ImGui::InputTextWithHint("##FilePath", ".tap / .tzx", FilePathBuffer, IM_ARRAYSIZE(FilePathBuffer), ImGuiInputTextFlags_EnterReturnsTrue))
+	{
+		Input_Insert();
+	}
+	ImGui::SameLine();
+	if (ImGui::Button("Insert"))
+	{
+		Input_Insert();
+	}
+
+	ImGui::BeginDisabled(!TapeStatus.bInserted);
+	{
+		if (ImGui::Button(TapeStatus.bPlaying ? "Stop" : "Play"))
+		{
+			Input_Control(TapeStatus.bPlaying ? ETapeControl::Stop : ETapeControl::Play);
+		}
+		ImGui::SameLine();
+		if (ImGui::Button("Rewind"))
+		{
+			Input_Control(ETapeControl::Rewind);
+		}
+		ImGui::SameLine();
+		if (ImGui::Button("Eject"))
+		{
+			Input_Control(ETapeControl::Eject);
+		}
+		ImGui::EndDisabled();
+	}
+
+	ImGui::SameLine();
+	ImGui::SetNextItemWidth(ImGui::CalcTextSize(LoadModeNames[ETapeLoadMode::FastLoad]).x + ImGui::GetFrameHeight() * 2.0f);
+	if (ImGui::BeginCombo("##LoadMode", LoadModeNames[LoadMode]))
+	{
+		for (uint8_t Mode = ETapeLoadMode::Normal; Mode <= ETapeLoadMode::FastLoad; ++Mode)
+		{
+			if (ImGui::Selectable(LoadModeNames[Mode], Mode == LoadMode))
+			{
+				Input_LoadMode(ETapeLoadMode::Type(Mode));
+			}
+		}
+		ImGui::EndCombo();
+	}
+
+	if (TapeStatus.bInserted)
+	{
+		ImGui::SameLine();
+		ImGui::Text("%s, block %zu of %zu", TapeStatus.FilePath.filename().string().c_str(),
+			(std::min)(TapeStatus.BlockIndex + 1, TapeStatus.BlockCount), TapeStatus.BlockCount);
+	}
+}
+
+void STapeRecorder::Draw_Blocks()
+{
+	if (Image.IsEmpty())
+	{
+		ImGui::TextDisabled("No tape inserted");
+		return;
+	}
+
+	ImGui::PushFont(FFonts::Get().GetFont(FontName));
+	if (ImGui::BeginTable("##TapeBlocks", 2,
+		ImGuiTableFlags_ScrollY |
+		ImGuiTableFlags_RowBg |
+		ImGuiTableFlags_BordersInnerV))
+	{
+		ImGui::TableSetupScrollFreeze(0, 1);
+		ImGui::TableSetupColumn("#", ImGuiTableColumnFlags_WidthFixed);
+		ImGui::TableSetupColumn("Block", ImGuiTableColumnFlags_WidthStretch);
+		ImGui::TableHeadersRow();
+
+		const std::vector<FTapeBlock>& Blocks = Image.GetBlocks();
+		ImGuiListClipper Clipper;
+		Clipper.Begin(int32_t(Blocks.size()));
+		while (Clipper.Step())
+		{
+			for (int32_t Row = Clipper.DisplayStart; Row < Clipper.DisplayEnd; ++Row)
+			{
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+
+				const bool bCurrent = TapeStatus.BlockIndex == size_t(Row);
+				ImGui::PushID(Row);
+				ImGui::Selectable(std::format("{}", Row + 1).c_str(), bCurrent, ImGuiSelectableFlags_SpanAllColumns);
+				ImGui::PopID();
+
+				ImGui::TableNextColumn();
+				ImGui::TextUnformatted(FormatBlock(Blocks[Row]).c_str());
+			}
+		}
+
+		ImGui::EndTable();
+	}
+	ImGui::PopFont();
+}
+
+void STapeRecorder::Input_Insert()
+{
+	if (FilePathBuffer[0] == '\0')
+	{
+		return;
+	}
+
+	FMotherboard& Motherboard = GetMotherboard();
+	Motherboard.SetTapeLoadMode(NAME_MainBoard, LoadMode);
+	Motherboard.InsertTape(NAME_MainBoard, FilePathBuffer);
+	TapeStatusRefreshTime = 0.0f;
+}
+
+void STapeRecorder::Input_Control(ETapeControl::Type Control)
+{
+	GetMotherboard().TapeControl(NAME_MainBoard, Control);
+	TapeStatusRefreshTime = 0.0f;
+}
+
+void STapeRecorder::Input_LoadMode(ETapeLoadMode::Type Mode)
+{
+	LoadMode = Mode;
+	GetMotherboard().SetTapeLoadMode(NAME_MainBoard, LoadMode);
+}
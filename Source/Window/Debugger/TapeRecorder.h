@@ -0,0 +1,39 @@
+#pragma once
+
+#include <CoreMinimal.h>
+#include "Viewer.h"
+#include "Devices/IO/Tape.h"
+
+class FMotherboard;
+
+class STapeRecorder : public SViewerChild
+{
+	using Super = SViewerChild;
+	using ThisClass = STapeRecorder;
+public:
+	STapeRecorder(EFont::Type _FontName);
+
+	virtual void Tick(float DeltaTime) override;
+	virtual void Render() override;
+
+private:
+	FORCEINLINE FMotherboard& GetMotherboard() const;
+
+	void Load_TapeStatus();
+
+	void Draw_Controls();
+	void Draw_Blocks();
+
+	void Input_Insert();
+	void Input_Control(ETapeControl::Type Control);
+	void Input_LoadMode(ETapeLoadMode::Type Mode);
+
+	FTapeStatus TapeStatus;
+	float TapeStatusRefreshTime;
+	ETapeLoadMode::Type LoadMode;
+
+	// the blocks are listed from a copy of the inserted image
+	FTapeImage Image;
+	std::filesystem::path ImageFilePath;
+	char FilePathBuffer[1024];
+};
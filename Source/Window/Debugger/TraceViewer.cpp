@@ -0,0 +1,283 @@
+#include "TraceViewer.h"
+
+#include "AppDebugger.h"
+#include "Motherboard/Motherboard.h"
+
+namespace
+{
+	static const wchar_t* ThisWindowName = L"Trace";
+
+	static const char* TraceFilename = "Trace.zxtrace";
+	static constexpr float RecorderStatusRefreshRate = 0.25f;
+
+	static constexpr const char* RegisterNames[ETraceRegister::MAX] = { "PC", "IR", "IX", "IY", "SP", "AF", "HL", "DE", "BC", "AF'", "HL'", "DE'", "BC'", "IFF" };
+
+	std::string FormatOpcode(const FTraceRecord& Record)
+	{
+		std::string Output;
+		for (uint8_t Index = 0; Index < Record.OpcodeLength; ++Index)
+		{
+			Output += std::format("{:02X} ", Record.Opcode[Index]);
+		}
+		return Output;
+	}
+
+	// the PC changes with every instruction, it is already in its own column
+	std::string FormatRegisters(const FTraceRecord& Record)
+	{
+		std::string Output;
+		for (uint32_t Index = ETraceRegister::PC + 1; Index < ETraceRegister::MAX; ++Index)
+		{
+			if (Record.ChangedRegisters & (1 << Index))
+			{
+				Output += std::format("{}={:04X} ", RegisterNames[Index], Record.Registers[Index]);
+			}
+		}
+		return Output;
+	}
+
+	std::string FormatWrites(const FTraceRecord& Record)
+	{
+		std::string Output;
+		for (const FTraceWrite& Write : Record.Writes)
+		{
+			Output += std::format("({:04X})={:02X} ", Write.Address, Write.Value);
+		}
+		return Output;
+	}
+}
+
+STraceViewer::STraceViewer(EFont::Type _FontName)
+	: Super(FWindowInitializer()
+		.SetName(ThisWindowName)
+		.SetFontName(_FontName)
+		.SetIncludeInWindows(true))
+	, RecorderStatusRefreshTime(0.0f)
+	, bWaitingForStop(false)
+	, SeekBuffer{}
+	, SelectedRecord(INDEX_NONE)
+	, bScrollToSelected(false)
+{}
+
+void STraceViewer::Tick(float DeltaTime)
+{
+	if (!IsOpen() || (!RecorderStatus.bRecording && !bWaitingForStop))
+	{
+		return;
+	}
+
+	RecorderStatusRefreshTime -= DeltaTime;
+	if (RecorderStatusRefreshTime <= 0.0f)
+	{
+		Load_RecorderStatus();
+	}
+
+	// the file is complete once the writer has finished
+	if (bWaitingForStop && !RecorderStatus.bRecording)
+	{
+		bWaitingForStop = false;
+		Open_TraceFile();
+	}
+}
+
+void STraceViewer::Render()
+{
+	if (!IsOpen())
+	{
+		Close();
+		return;
+	}
+
+	ImGui::Begin(GetWindowName().c_str(), &bOpen);
+	{
+		Draw_Toolbar();
+		ImGui::Separator();
+		Draw_Records();
+
+		ImGui::End();
+	}
+}
+
+FMotherboard& STraceViewer::GetMotherboard() const
+{
+	return *FAppFramework::Get<FAppDebugger>().Motherboard;
+}
+
+void STraceViewer::Load_RecorderStatus()
+{
+	RecorderStatus = GetMotherboard().GetState<FTraceRecorderStatus>(NAME_MainBoard, NAME_None);
+	RecorderStatusRefreshTime = RecorderStatusRefreshRate;
+}
+
+void STraceViewer::Open_TraceFile()
+{
+	const std::filesystem::path FilePath = RecorderStatus.FilePath.empty()
+		? FAppFramework::GetPath(EPathType::Export) / TraceFilename
+		: RecorderStatus.FilePath;
+
+	SelectedRecord = INDEX_NONE;
+	if (Reader.Open(FilePath))
+	{
+		LOG("Trace: {} instructions in {}", Reader.GetRecordCount(), FilePath.string());
+	}
+}
+
+void STraceViewer::Draw_Toolbar()
+{
+	if (ImGui::Button(RecorderStatus.bRecording ? "Stop" : "Record"))
+	{
+		Input_Record();
+	}
+	ImGui::SameLine();
+
+	if (RecorderStatus.bRecording)
+	{
+		ImGui::Text("Recording: %llu instructions, %.1f MB compressed to %.1f MB",
+			(unsigned long long)RecorderStatus.RecordCount,
+			double(RecorderStatus.RawBytes) / (1024.0 * 1024.0),
+			double(RecorderStatus.CompressedBytes) / (1024.0 * 1024.0));
+		if (RecorderStatus.Stalls > 0)
+		{
+			ImGui::SameLine();
+			ImGui::TextDisabled("(the emulation waited for the disk %llu times)", (unsigned long long)RecorderStatus.Stalls);
+		}
+		return;
+	}
+
+	if (RecorderStatus.bWriteFailed)
+	{
+		ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "Recording stopped: failed to write the trace file");
+		ImGui::SameLine();
+	}
+
+	if (ImGui::Button("Open"))
+	{
+		Open_TraceFile();
+	}
+
+	if (Reader.IsOpen())
+	{
+		ImGui::SameLine();
+		ImGui::Text("%llu instructions, CC #%llX - #%llX",
+			(unsigned long long)Reader.GetRecordCount(),
+			(unsigned long long)Reader.GetFirstClock(),
+			(unsigned long long)Reader.GetLastClock());
+
+		ImGui::SameLine();
+		ImGui::SetNextItemWidth(ImGui::CalcTextSize("0000000000000000").x + ImGui::GetStyle().FramePadding.x * 2.0f);
+		if (ImGui::InputTextWithHint("##Seek", "clock counter", SeekBuffer, IM_ARRAYSIZE(SeekBuffer),
+			ImGuiInputTextFlags_CharsHexadecimal | ImGuiInputTextFlags_EnterReturnsTrue))
+		{
+			Input_Seek();
+		}
+		ImGui::SameLine();
+		if (ImGui::Button("Seek"))
+		{
+			Input_Seek();
+		}
+	}
+}
+
+void STraceViewer::Draw_Records()
+{
+	if (!Reader.IsOpen())
+	{
+		ImGui::TextDisabled("No trace loaded");
+		return;
+	}
+
+	ImGui::PushFont(FFonts::Get().GetFont(FontName));
+	if (ImGui::BeginTable("##TraceRecords", 5,
+		ImGuiTableFlags_ScrollY |
+		ImGuiTableFlags_RowBg |
+		ImGuiTableFlags_BordersInnerV |
+		ImGuiTableFlags_Resizable))
+	{
+		ImGui::TableSetupScrollFreeze(0, 1);
+		ImGui::TableSetupColumn("Clock", ImGuiTableColumnFlags_WidthFixed);
+		ImGui::TableSetupColumn("PC", ImGuiTableColumnFlags_WidthFixed);
+		ImGui::TableSetupColumn("Opcode", ImGuiTableColumnFlags_WidthFixed);
+		ImGui::TableSetupColumn("Registers", ImGuiTableColumnFlags_WidthStretch);
+		ImGui::TableSetupColumn("Writes", ImGuiTableColumnFlags_WidthFixed);
+		ImGui::TableHeadersRow();
+
+		const int32_t RowCount = int32_t((std::min)(Reader.GetRecordCount(), uint64_t(INT32_MAX)));
+
+		ImGuiListClipper Clipper;
+		Clipper.Begin(RowCount);
+		if (bScrollToSelected && SelectedRecord < uint64_t(RowCount))
+		{
+			Clipper.IncludeItemByIndex(int32_t(SelectedRecord));
+		}
+
+		while (Clipper.Step())
+		{
+			for (int32_t Row = Clipper.DisplayStart; Row < Clipper.DisplayEnd; ++Row)
+			{
+				const FTraceRecord* Record = Reader.GetRecord(Row);
+				if (Record == nullptr)
+				{
+					break;
+				}
+
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+
+				ImGui::PushID(Row);
+				const bool bSelected = SelectedRecord == uint64_t(Row);
+				if (ImGui::Selectable(std::format("{:016X}", Record->ClockCounter).c_str(), bSelected, ImGuiSelectableFlags_SpanAllColumns))
+				{
+					SelectedRecord = Row;
+				}
+				ImGui::PopID();
+
+				if (bScrollToSelected && bSelected)
+				{
+					ImGui::SetScrollHereY(0.5f);
+					bScrollToSelected = false;
+				}
+
+				ImGui::TableNextColumn();
+				ImGui::Text("%04X", Record->PC);
+				ImGui::TableNextColumn();
+				ImGui::TextUnformatted(FormatOpcode(*Record).c_str());
+				ImGui::TableNextColumn();
+				ImGui::TextUnformatted(FormatRegisters(*Record).c_str());
+				ImGui::TableNextColumn();
+				ImGui::TextUnformatted(FormatWrites(*Record).c_str());
+			}
+		}
+
+		ImGui::EndTable();
+	}
+	ImGui::PopFont();
+}
+
+void STraceViewer::Input_Record()
+{
+	if (RecorderStatus.bRecording)
+	{
+		GetMotherboard().StopTraceRecorder();
+		bWaitingForStop = true;
+	}
+	else
+	{
+		// the file is rewritten by the recorder
+		Reader.Close();
+		GetMotherboard().StartTraceRecorder(NAME_MainBoard, FAppFramework::GetPath(EPathType::Export) / TraceFilename);
+		RecorderStatus.bRecording = true;
+	}
+	RecorderStatusRefreshTime = 0.0f;
+}
+
+void STraceViewer::Input_Seek()
+{
+	if (!Reader.IsOpen() || SeekBuffer[0] == '\0')
+	{
+		return;
+	}
+
+	const uint64_t ClockCounter = std::strtoull(SeekBuffer, nullptr, 16);
+	SelectedRecord = Reader.FindRecord(ClockCounter);
+	bScrollToSelected = true;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <CoreMinimal.h>
+#include "Viewer.h"
+#include "Motherboard/Motherboard_TraceRecorder.h"
+
+class FMotherboard;
+
+class STraceViewer : public SViewerChild
+{
+	using Super = SViewerChild;
+	using ThisClass = STraceViewer;
+public:
+	STraceViewer(EFont::Type _FontName);
+
+	virtual void Tick(float DeltaTime) override;
+	virtual void Render() override;
+
+private:
+	FORCEINLINE FMotherboard& GetMotherboard() const;
+
+	void Load_RecorderStatus();
+	void Open_TraceFile();
+
+	void Draw_Toolbar();
+	void Draw_Records();
+
+	void Input_Record();
+	void Input_Seek();
+
+	FTraceRecorderStatus RecorderStatus;
+	float RecorderStatusRefreshTime;
+	bool bWaitingForStop;
+
+	FTraceReader Reader;
+	char SeekBuffer[BUFFER_SIZE_INPUT];
+	uint64_t SelectedRecord;
+	bool bScrollToSelected;
+};
@@ -7,6 +7,8 @@
 #include "Window/Debugger/MemoryDump.h"
 #include "Window/Debugger/Disassembler.h"
 #include "Window/Debugger/Oscillograph.h"
+#include "Window/Debugger/TraceViewer.h"
+#include "Window/Debugger/TapeRecorder.h"
 #include "Utils/Hotkey.h"
 #include "Motherboard/Motherboard.h"
 
@@ -16,6 +18,9 @@ namespace
 	static const char* MenuFileName = TEXT("File");
 	static const char* MenuEmulationName = TEXT("Emulation");
 	static const char* MenuWindowsName = TEXT("Windows");
+	static const char* SnapshotFilename = TEXT("Snapshot.szx");
+	static const char* SaveStateFilename = TEXT("State.zxs");
+	static const char* InputLogFilename = TEXT("Input.zxr");
 }
 
 SViewer::SViewer(EFont::Type _FontName, uint32_t _Width, uint32_t _Height)
@@ -25,6 +30,7 @@ SViewer::SViewer(EFont::Type _FontName, uint32_t _Width, uint32_t _Height)
 		.SetIncludeInWindows(false)
 		.SetWidth(_Width)
 		.SetHeight(_Height))
+	, QuickSaveSlot(0)
 {}
 
 void SViewer::NativeInitialize(const FNativeDataInitialize& _Data)
@@ -38,6 +44,8 @@ void SViewer::NativeInitialize(const FNativeDataInitialize& _Data)
 				{ EWindowsType::MemoryDump,			std::make_shared<SMemoryDump>(NAME_MEMORY_DUMP_16)		},
 				{ EWindowsType::Disassembler,		std::make_shared<SDisassembler>(NAME_DISASSEMBLER_16)	},
 				{ EWindowsType::Oscillograph,		std::make_shared<SOscillograph>(NAME_OSCILLOGRAPH_16)	},
+				{ EWindowsType::Trace,				std::make_shared<STraceViewer>(NAME_DOS_12)				},
+				{ EWindowsType::Tape,				std::make_shared<STapeRecorder>(NAME_DOS_12)			},
 			  };
 
 	// initialize windows
@@ -66,6 +74,8 @@ void SViewer::SetupHotKeys()
 	Hotkeys =
 	{
 		{ ImGuiKey_GraveAccent,			ImGuiInputFlags_None,	std::bind(&ThisClass::Inut_Debugger, Self)					},		// debugger
+		{ ImGuiKey_F2,					ImGuiInputFlags_None,	[Self]() { Self->GetMotherboard().QuickSave(NAME_MainBoard, Self->QuickSaveSlot); }},	// quick save
+		{ ImGuiKey_F3,					ImGuiInputFlags_None,	[Self]() { Self->GetMotherboard().QuickLoad(NAME_MainBoard, Self->QuickSaveSlot); }},	// quick load
 		{ ImGuiKey_F11,					ImGuiInputFlags_None,	[Self]() { Self->GetMotherboard().NonmaskableInterrupt();	}},		// NMI
 		{ ImGuiMod_Ctrl | ImGuiKey_F12, ImGuiInputFlags_None,	[Self]() { Self->GetMotherboard().Reset();					}},		// Reset
 	};
@@ -125,6 +135,25 @@ void SViewer::ShowMenu_File()
 {
 	if (ImGui::BeginMenu(MenuFileName))
 	{
+		const std::filesystem::path SnapshotPath = FAppFramework::GetPath(EPathType::Export) / SnapshotFilename;
+		if (ImGui::MenuItem("Save snapshot"))
+		{
+			GetMotherboard().SaveSnapshot(NAME_MainBoard, SnapshotPath);
+		}
+		if (ImGui::MenuItem("Load snapshot", nullptr, false, std::filesystem::exists(SnapshotPath)))
+		{
+			GetMotherboard().LoadSnapshot(NAME_MainBoard, SnapshotPath);
+		}
+		ImGui::Separator();
+		const std::filesystem::path SaveStatePath = FAppFramework::GetPath(EPathType::Export) / SaveStateFilename;
+		if (ImGui::MenuItem("Save state"))
+		{
+			GetMotherboard().SaveState(NAME_MainBoard, SaveStatePath);
+		}
+		if (ImGui::MenuItem("Load state", nullptr, false, std::filesystem::exists(SaveStatePath)))
+		{
+			GetMotherboard().LoadState(NAME_MainBoard, SaveStatePath);
+		}
 		ImGui::EndMenu();
 	}
 }
@@ -146,6 +175,44 @@ void SViewer::ShowMenu_Emulation()
 		{
 			GetMotherboard().NonmaskableInterrupt();
 		}
+		ImGui::Separator();
+		if (ImGui::MenuItem("Quick save", "F2"))
+		{
+			GetMotherboard().QuickSave(NAME_MainBoard, QuickSaveSlot);
+		}
+		if (ImGui::MenuItem("Quick load", "F3"))
+		{
+			GetMotherboard().QuickLoad(NAME_MainBoard, QuickSaveSlot);
+		}
+		if (ImGui::BeginMenu("Quick save slot"))
+		{
+			for (uint32_t Slot = 0; Slot < SaveState::SlotCount; ++Slot)
+			{
+				if (ImGui::MenuItem(std::format("Slot {}", Slot).c_str(), nullptr, Slot == QuickSaveSlot))
+				{
+					QuickSaveSlot = Slot;
+				}
+			}
+			ImGui::EndMenu();
+		}
+		ImGui::Separator();
+		const std::filesystem::path InputLogPath = FAppFramework::GetPath(EPathType::Export) / InputLogFilename;
+		const FInputLogStatus InputLogStatus = GetMotherboard().GetState<FInputLogStatus>(NAME_MainBoard, NAME_None);
+		if (ImGui::MenuItem("Record input", nullptr, InputLogStatus.bRecording, !InputLogStatus.bReplaying))
+		{
+			if (InputLogStatus.bRecording)
+			{
+				GetMotherboard().StopInputRecording();
+			}
+			else
+			{
+				GetMotherboard().StartInputRecording(NAME_MainBoard, InputLogPath);
+			}
+		}
+		if (ImGui::MenuItem("Replay input", nullptr, InputLogStatus.bReplaying, !InputLogStatus.bRecording && std::filesystem::exists(InputLogPath)))
+		{
+			GetMotherboard().StartInputReplay(NAME_MainBoard, InputLogPath);
+		}
 		ImGui::EndMenu();
 	}
 }
@@ -16,6 +16,8 @@ enum class EWindowsType
 	MemoryDump,
 	Disassembler,
 	Oscillograph,
+	Trace,
+	Tape,
 };
 
 class SViewer : public SWindow
@@ -94,6 +96,7 @@ private:
 	void ShowMenu_Windows();
 
 	std::map<EWindowsType, std::shared_ptr<SWindow>> Windows;
+	uint32_t QuickSaveSlot;
 };
 
 class SViewerChild : public SWindow
@@ -4,6 +4,7 @@
 #include "SpriteList.h"
 #include <AppSprite.h>
 #include <Utils/UI/Draw.h>
+#include <Utils/UI/Draw_ZXFloodFill.h>
 #include <Window/Sprite/Events.h>
 #include <Utils/IO.h>
 #include <Utils/Aseprite/Format.h>
@@ -16,6 +17,7 @@ namespace
 	static const wchar_t* ThisWindowName = L"Canvas";
 	static const char* PopupMenuName = TEXT("##PopupMenuSprite");
 	static const char* CreateSpriteName = "##CreateSprite";
+	static constexpr int32_t AsepritePrefetchFrames = 8;
 	std::weak_ptr<SCanvas> ActiveCanvas;
 
 	int32_t TextEditNumberCallback(ImGuiInputTextCallbackData* Data)
@@ -277,6 +279,10 @@ void SCanvas::NativeInitialize(const FNativeDataInitialize& Data)
 
 			if (Event.Tag == FEventTag::CanvasOptionsFlagsTag)
 			{
+				if ((OptionsFlags[0] ^ Event.OptionsFlags) & FCanvasOptionsFlags::Source)
+				{
+					ClearUndo();
+				}
 				OptionsFlags[0] = Event.OptionsFlags;
 				OptionsFlags[1] = Event.OptionsFlags;
 			}
@@ -342,6 +348,10 @@ void SCanvas::NativeInitialize(const FNativeDataInitialize& Data)
 			{
 				SetToolMode(Event.ChangeToolMode.ToolMode, true, true);
 			}
+			else if (Event.Tag == FEventTag::PaintBucketOptionsTag)
+			{
+				PaintBucketOptions = Event.PaintBucketOptions;
+			}
 		});
 
 	SubscribeEvent<FEvent_Timeline>(
@@ -350,14 +360,22 @@ void SCanvas::NativeInitialize(const FNativeDataInitialize& Data)
 			if (Event.Tag == FEventTag::TimelineLayerVisibilityChangedTag &&
 				Event.Sprite == AsepriteSprite)
 			{
+				FrameCache.Invalidate();
 				bFroceRebuiltSpriteFrame = true;
 				bRefreshCanvas = true;
 			}
 			else if (Event.Tag == FEventTag::TimelineLayerAssignmentChangedTag &&
 				Event.Sprite == AsepriteSprite)
 			{
-				for (int32_t Frame = 0; Frame < static_cast<int32_t>(AsepriteSprite->Frames.size()); ++Frame)
+				FrameCache.Invalidate();
+				const int32_t DecodeBatch = (std::max)(static_cast<int32_t>(std::thread::hardware_concurrency()), 1);
+				for (int32_t Frame = 0; Frame < AsepriteSprite->FrameCount; ++Frame)
 				{
+					if (Frame % DecodeBatch == 0)
+					{
+						AsepriteFormat::DecodeFrames(*AsepriteSprite, Frame, DecodeBatch);
+					}
+
 					std::vector<uint8_t> InkData;
 					std::vector<uint8_t> AttributeData;
 					std::vector<uint8_t> MaskData;
@@ -420,6 +438,7 @@ void SCanvas::NativeInitialize(const FNativeDataInitialize& Data)
 				{
 					return;
 				}
+				PrefetchAsepriteFrames(Event.Frame, Event.Frame < SelectedSpritesFrame ? -1 : 1);
 				SelectedSpritesFrame = Event.Frame;
 				bRefreshCanvas = true;
 			}
@@ -529,7 +548,7 @@ void SCanvas::Initialize(const std::vector<std::any>& Args)
 		Width = AsepriteSprite->Width;
 		Height = AsepriteSprite->Height;
 		Keyframes = std::make_shared<FKeyframes>();
-		Keyframes->Make((int32_t)AsepriteSprite->Frames.size(), (int32_t)AsepriteSprite->Layers.size());
+		Keyframes->Make(AsepriteSprite->FrameCount, (int32_t)AsepriteSprite->Layers.size());
 		TransparentColor = UI::ToU32(COLOR(0, 0, 0, 0));
 
 		FEvent_Timeline Timeline_Event(FEventTag::TimelineInitializeTag);
@@ -553,7 +572,7 @@ void SCanvas::Initialize(const std::vector<std::any>& Args)
 			SendEvent(AppSprite_Event);
 		}
 
-		if (AsepriteSprite->Frames.empty())
+		if (AsepriteSprite->FrameCount == 0)
 		{
 			LOG_ERROR("[{}]\t *.aseprite file does not have frames.", (__FUNCTION__));
 			break;
@@ -564,9 +583,10 @@ void SCanvas::Initialize(const std::vector<std::any>& Args)
 		Draw_ZXColorView_Initialize(ZXColorView, UI::ERenderType::Canvas);
 
 		SelectedSpritesFrame = 0;
-		MaxFramesInSprites = (int32_t)AsepriteSprite->Frames.size() - 1;
+		MaxFramesInSprites = AsepriteSprite->FrameCount - 1;
 
-		UI::QuantizeToZX(AsepriteSprite->Frames[0].data(), Width, Height, 4, ZXColorView->IndexedData, TransparentColor);
+		const std::shared_ptr<const std::vector<uint8_t>> FrameRGBA = AsepriteFormat::GetFrameRGBA(*AsepriteSprite, 0);
+		UI::QuantizeToZX(FrameRGBA->data(), Width, Height, 4, ZXColorView->IndexedData, TransparentColor);
 		UI::ZXIndexColorToImage(ZXColorView->Image, ZXColorView->IndexedData, Width, Height, true);
 		ConversionToZX(ConversationSettings);
 		LoadAsepriteFrameOverride(0, ZXColorView->InkData, ZXColorView->AttributeData, ZXColorView->MaskData);
@@ -640,7 +660,7 @@ bool SCanvas::HasTimeline() const
 
 	return ImageFormat == EImageFormat::Aseprite &&
 		AsepriteSprite &&
-		(AsepriteSprite->Frames.size() > 1 ||
+		(AsepriteSprite->FrameCount > 1 ||
 		 AsepriteSprite->Layers.size() > 1);
 }
 
@@ -729,7 +749,7 @@ bool SCanvas::ReloadFromSource()
 			return false;
 		}
 
-		const size_t PreviousFrameCount = AsepriteSprite ? AsepriteSprite->Frames.size() : 0;
+		const int32_t PreviousFrameCount = AsepriteSprite ? AsepriteSprite->FrameCount : 0;
 		const size_t PreviousLayerCount = AsepriteSprite ? AsepriteSprite->Layers.size() : 0;
 		if (AsepriteSprite)
 		{
@@ -739,45 +759,28 @@ bool SCanvas::ReloadFromSource()
 		}
 
 		AsepriteSprite = std::move(ReloadedSprite);
+		FrameCache.Invalidate();
 		Width = AsepriteSprite->Width;
 		Height = AsepriteSprite->Height;
-		MaxFramesInSprites = static_cast<int32_t>(AsepriteSprite->Frames.size()) - 1;
+		MaxFramesInSprites = AsepriteSprite->FrameCount - 1;
 		SelectedSpritesFrame = ImClamp(PreviousFrame, 0, MaxFramesInSprites);
 		if (!Keyframes ||
-			PreviousFrameCount != AsepriteSprite->Frames.size() ||
+			PreviousFrameCount != AsepriteSprite->FrameCount ||
 			PreviousLayerCount != AsepriteSprite->Layers.size())
 		{
 			Keyframes = std::make_shared<FKeyframes>();
 			Keyframes->Make(
-				static_cast<int32_t>(AsepriteSprite->Frames.size()),
+				AsepriteSprite->FrameCount,
 				static_cast<int32_t>(AsepriteSprite->Layers.size()));
 		}
 
-		UI::QuantizeToZX(
-			AsepriteSprite->Frames[SelectedSpritesFrame].data(),
-			Width,
-			Height,
-			4,
-			ZXColorView->IndexedData,
-			TransparentColor);
-		UI::ZXIndexColorToZXAttributeColor(
-			ZXColorView->IndexedData,
-			Width,
-			Height,
-			ZXColorView->InkData,
-			ZXColorView->AttributeData,
-			ZXColorView->MaskData,
-			ConversationSettings);
-		LoadAsepriteFrameOverride(
-			SelectedSpritesFrame,
-			ZXColorView->InkData,
-			ZXColorView->AttributeData,
-			ZXColorView->MaskData);
-		ApplyAsepriteLayerOverrides(
-			SelectedSpritesFrame,
-			ZXColorView->InkData,
-			ZXColorView->AttributeData,
-			ZXColorView->MaskData);
+		if (const std::shared_ptr<const FFrameZXData> Data = GetAsepriteFrameZXData(SelectedSpritesFrame))
+		{
+			ZXColorView->IndexedData = Data->IndexedData;
+			ZXColorView->InkData = Data->InkData;
+			ZXColorView->AttributeData = Data->AttributeData;
+			ZXColorView->MaskData = Data->MaskData;
+		}
 
 		FEvent_Timeline TimelineEvent(FEventTag::TimelineInitializeTag);
 		TimelineEvent.Keyframes = Keyframes;
@@ -802,25 +805,22 @@ bool SCanvas::ReloadFromSource()
 
 	if (ImageFormat == EImageFormat::Aseprite)
 	{
+		// frames are decoded in batches on all cores and then converted one by one
+		const int32_t DecodeBatch = (std::max)(static_cast<int32_t>(std::thread::hardware_concurrency()), 1);
 		for (int32_t Frame = 0; Frame <= MaxFramesInSprites; ++Frame)
 		{
-			std::vector<uint8_t> InkData;
-			std::vector<uint8_t> AttributeData;
-			std::vector<uint8_t> MaskData;
-			if (!BuildAsepriteFrameZXData(Frame, InkData, AttributeData, MaskData))
+			if (Frame % DecodeBatch == 0)
 			{
-				continue;
+				AsepriteFormat::DecodeFrames(*AsepriteSprite, Frame, DecodeBatch);
 			}
 
-			std::vector<uint8_t> IndexedData;
-			UI::QuantizeToZX(
-				AsepriteSprite->Frames[Frame].data(),
-				Width,
-				Height,
-				4,
-				IndexedData,
-				TransparentColor);
-			NotifySpritesUpdated(Frame, IndexedData, InkData, AttributeData, MaskData);
+			// the converted frame already holds the quantized source
+			const std::shared_ptr<const FFrameZXData> Data = GetAsepriteFrameZXData(Frame);
+			if (!Data)
+			{
+				continue;
+			}
+			NotifySpritesUpdated(Frame, Data->IndexedData, Data->InkData, Data->AttributeData, Data->MaskData);
 		}
 	}
 	else
@@ -864,6 +864,7 @@ void SCanvas::SetAsepriteLayerAssignments(
 	AsepriteSprite->InkLayer = InkLayer;
 	AsepriteSprite->AttributeLayer = AttributeLayer;
 	AsepriteSprite->MaskLayer = MaskLayer;
+	FrameCache.Invalidate();
 	LastRebuiltSpriteFrame = INDEX_NONE;
 	bFroceRebuiltSpriteFrame = true;
 	bRefreshCanvas = true;
@@ -952,8 +953,14 @@ void SCanvas::Render()
 
 	if (bRefreshCanvas)
 	{
-		RebuildCanvasFromAseprite(SelectedSpritesFrame);
 		bRefreshCanvas = false;
+		RebuildCanvasFromAseprite(SelectedSpritesFrame);
+		RefreshRegion.Reset();
+	}
+	else if (!RefreshRegion.IsEmpty())
+	{
+		RebuildCanvasFromAseprite(SelectedSpritesFrame, &RefreshRegion);
+		RefreshRegion.Reset();
 	}
 
 	const bool bNoMove = ToolMode[0] == EToolMode::RectangleMarquee;
@@ -1107,6 +1114,23 @@ void SCanvas::Render()
 			bNeedConvertCanvasToZX = false;
 			bNeedConvertZXToCanvas = false;
 			bRefreshCanvas = true;
+
+			// the converted buffers replace the ones the deltas were recorded on
+			ClearUndo();
+		}
+		if (ImGui::BeginPopupContextItem("ConversionSettings"))
+		{
+			if (ImGui::Checkbox("Минимизировать ошибку цвета", &ConversationSettings.bMinimizeError))
+			{
+				FrameCache.Invalidate();
+			}
+			if (ImGui::IsItemHovered())
+			{
+				ImGui::BeginTooltip();
+				ImGui::TextUnformatted("Ink/paper знакоместа подбираются по наименьшей ошибке цвета,\nа не по двум самым частым цветам.");
+				ImGui::EndTooltip();
+			}
+			ImGui::EndPopup();
 		}
 		ImGui::SameLine();
 		if (UI::Button("I", bInk, { WidthInk, WidthInk }, bInkEnabled))
@@ -1148,6 +1172,11 @@ void SCanvas::Render()
 
 		if (OptionsFlags[0] != OptionsFlags[1])
 		{
+			// the deltas hold either the indexed colors or the ZX data, switching the mode regenerates the other buffers
+			if ((OptionsFlags[0] ^ OptionsFlags[1]) & FCanvasOptionsFlags::Source)
+			{
+				ClearUndo();
+			}
 			OptionsFlags[1] = OptionsFlags[0];
 			FEvent_Canvas Event;
 			Event.Tag = FEventTag::CanvasOptionsFlagsTag;
@@ -1265,7 +1294,7 @@ void SCanvas::Draw_PopupMenu()
 				{
 					const int32_t FirstFrame = bAllFrames ? 0 : TimelineState.CurrentFrame;
 					const int32_t LastFrame = bAllFrames && AsepriteSprite
-						? static_cast<int32_t>(AsepriteSprite->Frames.size())
+						? AsepriteSprite->FrameCount
 						: FirstFrame + 1;
 					const FTilemapCellData_Rect LimitArea(SelectedArea);
 					for (int32_t Frame = FirstFrame; Frame < LastFrame; ++Frame)
@@ -1700,6 +1729,13 @@ void SCanvas::ApplyToolMode()
 		return;
 	}
 
+	// the buffers still hold the previous frame
+	if (!IsAsepriteFrameReady())
+	{
+		ZXColorView->bCursorEnable = false;
+		return;
+	}
+
 	bMouseInsideMarquee = ZXColorView->RectangleMarqueeRect.Contains(UI::ConverZXViewPositionToPixel(*ZXColorView, ImGui::GetMousePos()));
 
 	switch (ToolMode[0])
@@ -1722,6 +1758,8 @@ void SCanvas::ApplyToolMode()
 		Handler_Eyedropper();
 		break;
 	case EToolMode::PaintBucket:
+		ZXColorView->bCursorEnable = true;
+		Handler_PaintBucket();
 		break;
 	}
 }
@@ -1754,7 +1792,7 @@ void SCanvas::Imput_SelectAll()
 void SCanvas::Imput_Paste()
 {
 	FRGBAImage ClipboardImage;
-	if (Window::ClipboardData(ClipboardImage))
+	if (IsAsepriteFrameReady() && Window::ClipboardData(ClipboardImage))
 	{
 		if (ClipboardImage.Width == Width && ClipboardImage.Height == Height)
 		{
@@ -1778,7 +1816,7 @@ void SCanvas::Imput_Paste()
 
 void SCanvas::Imput_Delete()
 {
-	if (!bRectangleMarqueeActive)
+	if (!bRectangleMarqueeActive && IsAsepriteFrameReady())
 	{
 		ImRect FullRect;
 
@@ -1787,6 +1825,7 @@ void SCanvas::Imput_Delete()
 			FullRect = ZXColorView->RectangleMarqueeRect;
 		}
 
+		BeginUndoDelta();
 		if (OptionsFlags[0] & FCanvasOptionsFlags::Source)
 		{
 			bSourceDirty = true;
@@ -1811,6 +1850,7 @@ void SCanvas::Imput_Delete()
 				EZXColor::True);
 			bNeedConvertZXToCanvas = true;
 		}
+		UndoQueue.EndDelta();
 	}
 
 	bRefreshCanvas = true;
@@ -1913,6 +1953,9 @@ bool SCanvas::PrepareToChangeFrame()
 	{
 		return false;
 	}
+
+	// the deltas describe the buffers of this frame only
+	UndoQueue.Clear();
 	return true;
 }
 
@@ -1960,6 +2003,7 @@ void SCanvas::Imput_PreviousFrame()
 		break;
 	case EImageFormat::Aseprite:
 		bRefreshCanvas = true;
+		PrefetchAsepriteFrames(SelectedSpritesFrame, -1);
 		break;
 	}
 }
@@ -2004,6 +2048,10 @@ void SCanvas::Imput_Play()
 
 	bPlay = !bPlay;
 	PlayDuration = ImageFormat == EImageFormat::Aseprite ? float(AsepriteSprite->DurationPerFrame[SelectedSpritesFrame]) * 0.001f : 0.05f;
+	if (bPlay)
+	{
+		PrefetchAsepriteFrames(SelectedSpritesFrame);
+	}
 }
 
 void SCanvas::Imput_NextFrame()
@@ -2049,6 +2097,7 @@ void SCanvas::Imput_NextFrame()
 		break;
 	case EImageFormat::Aseprite:
 		bRefreshCanvas = true;
+		PrefetchAsepriteFrames(SelectedSpritesFrame);
 		break;
 	}
 }
@@ -2122,9 +2171,9 @@ void SCanvas::Handler_Pencil()
 	if (!Context.IO.MouseDown[ImGuiMouseButton_Left] && 
 		!Context.IO.MouseDown[ImGuiMouseButton_Right])
 	{
-		if (UndoQueue.IsContinuous())
+		if (UndoQueue.IsRecordingDelta())
 		{
-			UndoQueue.EndContinuous();
+			UndoQueue.EndDelta();
 		}
 		return;
 	}
@@ -2134,10 +2183,10 @@ void SCanvas::Handler_Pencil()
 		return;
 	}
 
-	if (!UndoQueue.IsContinuous())
+	// the whole stroke is one undo step
+	if (!UndoQueue.IsRecordingDelta())
 	{
-		UndoQueue.BeginContinuous();
-		PixelStrokeBegin = UndoQueue.UndoSize();
+		BeginUndoDelta();
 	}
 
 	const int8_t ButtonIndex = Context.IO.MouseDown[ImGuiMouseButton_Left] ? 0 : 1;
@@ -2146,6 +2195,168 @@ void SCanvas::Handler_Pencil()
 	Set_PixelToCanvas({ X, Y }, ButtonIndex);
 }
 
+void SCanvas::Handler_PaintBucket()
+{
+	ImGuiContext& Context = *ImGui::GetCurrentContext();
+	if (!Context.IO.MouseClicked[ImGuiMouseButton_Left] &&
+		!Context.IO.MouseClicked[ImGuiMouseButton_Right])
+	{
+		return;
+	}
+
+	if (ZXColorView->bVisibilityRectangleMarquee && !bMouseInsideMarquee)
+	{
+		return;
+	}
+
+	const int32_t X = FMath::FloorToInt32(ZXColorView->CursorPosition.x);
+	const int32_t Y = FMath::FloorToInt32(ZXColorView->CursorPosition.y);
+	if (X < 0 || X >= Width || Y < 0 || Y >= Height)
+	{
+		return;
+	}
+
+	// the fill stays inside the selection and, if asked, inside the attribute cell
+	UI::FFloodFillSettings Settings;
+	Settings.bDiagonal = PaintBucketOptions.bDiagonal;
+	Settings.Bounds = UI::FDirtyRect::Full(Width, Height);
+	if (ZXColorView->bVisibilityRectangleMarquee)
+	{
+		const ImRect& Marquee = ZXColorView->RectangleMarqueeRect;
+		Settings.Bounds = { (int32_t)Marquee.Min.x, (int32_t)Marquee.Min.y, (int32_t)Marquee.Max.x, (int32_t)Marquee.Max.y };
+	}
+	if (PaintBucketOptions.bWithinCell)
+	{
+		const UI::FDirtyRect Cell = UI::FDirtyRect::Cell(X, Y);
+		Settings.Bounds = { (std::max)(Settings.Bounds.MinX, Cell.MinX), (std::max)(Settings.Bounds.MinY, Cell.MinY),
+							(std::min)(Settings.Bounds.MaxX, Cell.MaxX), (std::min)(Settings.Bounds.MaxY, Cell.MaxY) };
+	}
+	if (Settings.Bounds.IsEmpty())
+	{
+		return;
+	}
+
+	const uint8_t ButtonIndex = Context.IO.MouseClicked[ImGuiMouseButton_Left] ? 0 : 1;
+	const uint8_t ColorIndex = ButtonColor[ButtonIndex];
+	if (ColorIndex == EZXColor::None)
+	{
+		return;
+	}
+
+	if (OptionsFlags[0] & FCanvasOptionsFlags::Source)
+	{
+		const UI::FDirtyRect Region = UI::FloodFillRegion(ZXColorView->IndexedData, Width, Height, X, Y, Settings, PaintBucketRegion);
+		if (Region.IsEmpty() || ZXColorView->IndexedData[Y * Width + X] == ColorIndex)
+		{
+			return;
+		}
+
+		// the whole fill is one undo step
+		BeginUndoDelta();
+		for (int32_t y = Region.MinY; y < Region.MaxY; ++y)
+		{
+			const size_t RowOffset = static_cast<size_t>(y) * Width;
+			for (int32_t x = Region.MinX; x < Region.MaxX; ++x)
+			{
+				if (PaintBucketRegion[RowOffset + x])
+				{
+					ZXColorView->IndexedData[RowOffset + x] = ColorIndex;
+				}
+			}
+		}
+		UndoQueue.EndDelta();
+
+		bNeedConvertCanvasToZX = true;
+		bSourceDirty = true;
+		RefreshRegion.Add(Region);
+		return;
+	}
+
+	const uint8_t Flags = OptionsFlags[0] & ~FCanvasOptionsFlags::Source;
+	const UI::FDirtyRect Region = UI::FloodFillRegion(
+		ZXColorView->InkData.data(),
+		ZXColorView->AttributeData.empty() ? nullptr : ZXColorView->AttributeData.data(),
+		Width, Height, X, Y, Settings, PaintBucketRegion);
+	if (Region.IsEmpty())
+	{
+		return;
+	}
+
+	const int32_t Boundary_X = Width >> 3;
+	const bool bInk = bTransparentMask || Flags & FCanvasOptionsFlags::Ink;
+	const bool bMask = (bTransparentMask || Flags & FCanvasOptionsFlags::Mask) && !ZXColorView->MaskData.empty();
+	const bool bAttribute = (bTransparentMask || Flags & FCanvasOptionsFlags::Attribute) && !ZXColorView->AttributeData.empty();
+
+	BeginUndoDelta();
+
+	// pixels, the same rules as the pencil
+	for (int32_t y = Region.MinY; y < Region.MaxY; ++y)
+	{
+		const size_t RowOffset = static_cast<size_t>(y) * Width;
+		for (int32_t x = Region.MinX; x < Region.MaxX; ++x)
+		{
+			if (!PaintBucketRegion[RowOffset + x])
+			{
+				continue;
+			}
+
+			const int32_t InkMaskOffset = y * Boundary_X + (x >> 3);
+			const uint8_t PixelBit = 1 << (7 - (x & 7));
+			if (bInk && ColorIndex != EZXColor::Transparent)
+			{
+				uint8_t& Pixels = ZXColorView->InkData[InkMaskOffset];
+				Pixels = !bTransparentMask && (ColorIndex & 0x07) != EZXColor::White ? Pixels | PixelBit : Pixels & ~PixelBit;
+			}
+			if (bMask)
+			{
+				uint8_t& Mask = ZXColorView->MaskData[InkMaskOffset];
+				Mask = ColorIndex != EZXColor::Transparent ? Mask | PixelBit : Mask & ~PixelBit;
+			}
+		}
+	}
+
+	// attributes of the cells the fill touched
+	if (bAttribute)
+	{
+		for (int32_t by = Region.MinY >> 3; by <= (Region.MaxY - 1) >> 3; ++by)
+		{
+			for (int32_t bx = Region.MinX >> 3; bx <= (Region.MaxX - 1) >> 3; ++bx)
+			{
+				bool bTouched = false;
+				for (int32_t y = by * 8; y < (std::min)(by * 8 + 8, Height) && !bTouched; ++y)
+				{
+					const uint8_t* Row = PaintBucketRegion.data() + static_cast<size_t>(y) * Width + bx * 8;
+					for (int32_t dx = 0; dx < 8 && !bTouched; ++dx)
+					{
+						bTouched = Row[dx] != 0;
+					}
+				}
+				if (!bTouched)
+				{
+					continue;
+				}
+
+				uint8_t& Attribute = ZXColorView->AttributeData[by * Boundary_X + bx];
+				const bool bInkTransparent = Subcolor[ESubcolor::Ink] == EZXColor::Transparent;
+				const bool bPaperTransparent = Subcolor[ESubcolor::Paper] == EZXColor::Transparent;
+
+				const uint8_t InkColor = bInkTransparent ? (Attribute & 0x07) : Subcolor[ESubcolor::Ink] & 0x07;
+				const uint8_t PaperColor = bPaperTransparent ? ((Attribute >> 3) & 0x07) : Subcolor[ESubcolor::Paper] & 0x07;
+
+				const bool bBright = bTransparentMask ? (Attribute & 0x40) : Subcolor[ESubcolor::Bright] == EZXColor::True;
+				const bool bFlash = bTransparentMask ? (Attribute & 0x80) : Subcolor[ESubcolor::Flash] == EZXColor::True;
+
+				Attribute = (bFlash << 7) | (bBright << 6) | (PaperColor << 3) | InkColor;
+			}
+		}
+	}
+	UndoQueue.EndDelta();
+
+	bIPMDirty = true;
+	bNeedConvertZXToCanvas = true;
+	RefreshRegion.Add({ Region.MinX & ~7, Region.MinY & ~7, (Region.MaxX + 7) & ~7, (Region.MaxY + 7) & ~7 });
+}
+
 void SCanvas::Handler_Eyedropper()
 {
 	ImGuiContext& Context = *ImGui::GetCurrentContext();
@@ -2264,29 +2475,9 @@ bool SCanvas::LoadAsepriteFrameOverride(
 	const size_t ExpectedPixelSize = static_cast<size_t>(Width >> 3) * Height;
 	const size_t ExpectedAttributeSize = static_cast<size_t>(Width >> 3) * (Height >> 3);
 	bool bLoaded = false;
-
-	auto LoadData = [&bLoaded](const std::filesystem::path& Path, size_t ExpectedSize, std::vector<uint8_t>& Output)
-	{
-		if (Path.empty() || !std::filesystem::exists(Path))
-		{
-			return;
-		}
-
-		std::vector<uint8_t> Data;
-		const std::error_code Error = IO::LoadBinaryData(Data, Path);
-		if (Error || Data.size() != ExpectedSize)
-		{
-			LOG_ERROR("[LoadAsepriteFrameOverride] Invalid override file: {}", Path.string());
-			return;
-		}
-
-		Output = std::move(Data);
-		bLoaded = true;
-	};
-
-	LoadData(GetAsepriteFrameOverridePath(Frame, ".ink"), ExpectedPixelSize, InkData);
-	LoadData(GetAsepriteFrameOverridePath(Frame, ".attr"), ExpectedAttributeSize, AttributeData);
-	LoadData(GetAsepriteFrameOverridePath(Frame, ".mask"), ExpectedPixelSize, MaskData);
+	bLoaded |= FFrameCache::LoadOverride(GetAsepriteFrameOverridePath(Frame, ".ink"), ExpectedPixelSize, InkData);
+	bLoaded |= FFrameCache::LoadOverride(GetAsepriteFrameOverridePath(Frame, ".attr"), ExpectedAttributeSize, AttributeData);
+	bLoaded |= FFrameCache::LoadOverride(GetAsepriteFrameOverridePath(Frame, ".mask"), ExpectedPixelSize, MaskData);
 	return bLoaded;
 }
 
@@ -2308,6 +2499,7 @@ bool SCanvas::SaveAsepriteFrameOverride(
 		return false;
 	}
 
+	FrameCache.Invalidate(Frame);
 	const std::error_code InkError = IO::SaveBinaryData(InkData, GetAsepriteFrameOverridePath(Frame, ".ink"), false);
 	const std::error_code AttributeError = IO::SaveBinaryData(AttributeData, GetAsepriteFrameOverridePath(Frame, ".attr"), false);
 	const std::error_code MaskError = IO::SaveBinaryData(MaskData, GetAsepriteFrameOverridePath(Frame, ".mask"), false);
@@ -2330,48 +2522,10 @@ bool SCanvas::ApplyAsepriteLayerOverrides(
 		return false;
 	}
 
-	auto ConvertAttributeLayer = [this](
-		const std::vector<uint8_t>& RGBA,
-		std::vector<uint8_t>& OutputAttributeData)
-		{
-			std::vector<uint8_t> IndexedData;
-			std::vector<uint8_t> IgnoredInkData;
-			std::vector<uint8_t> IgnoredMaskData;
-			UI::QuantizeToZX(
-				RGBA.data(),
-				Width,
-				Height,
-				4,
-				IndexedData,
-				TransparentColor);
-			UI::ZXIndexColorToZXAttributeColor(
-				IndexedData,
-				Width,
-				Height,
-				IgnoredInkData,
-				OutputAttributeData,
-				IgnoredMaskData,
-				ConversationSettings);
-		};
-
-	bool bApplied = false;
-	std::vector<uint8_t> LayerRGBA;
-	if (AsepriteFormat::GetLayerFrameRGBA(*AsepriteSprite, Frame, AsepriteSprite->InkLayer, LayerRGBA))
-	{
-		UI::ZXAlphaToPixelData(LayerRGBA.data(), Width, Height, 4, InkData);
-		bApplied = true;
-	}
-	if (AsepriteFormat::GetLayerFrameRGBA(*AsepriteSprite, Frame, AsepriteSprite->MaskLayer, LayerRGBA))
-	{
-		UI::ZXAlphaToPixelData(LayerRGBA.data(), Width, Height, 4, MaskData, true);
-		bApplied = true;
-	}
-	if (AsepriteFormat::GetLayerFrameRGBA(*AsepriteSprite, Frame, AsepriteSprite->AttributeLayer, LayerRGBA))
-	{
-		ConvertAttributeLayer(LayerRGBA, AttributeData);
-		bApplied = true;
-	}
-	return bApplied;
+	FFrameZXSource Source;
+	MakeAsepriteFrameSource(Frame, Source, true);
+	FFrameCache::Decode(Source);
+	return FFrameCache::ApplyLayerOverrides(Source, InkData, AttributeData, MaskData);
 }
 
 bool SCanvas::BuildAsepriteFrameZXData(
@@ -2383,26 +2537,123 @@ bool SCanvas::BuildAsepriteFrameZXData(
 	if (!AsepriteSprite ||
 		!AsepriteSprite->IsValid() ||
 		Frame < 0 ||
-		Frame >= static_cast<int32_t>(AsepriteSprite->Frames.size()))
+		Frame >= AsepriteSprite->FrameCount)
 	{
 		return false;
 	}
 
-	std::vector<uint8_t> IndexedData;
-	UI::QuantizeToZX(AsepriteSprite->Frames[Frame].data(), Width, Height, 4, IndexedData, TransparentColor);
-	UI::ZXIndexColorToZXAttributeColor(
-		IndexedData,
-		Width,
-		Height,
-		InkData,
-		AttributeData,
-		MaskData,
-		ConversationSettings);
-	LoadAsepriteFrameOverride(Frame, InkData, AttributeData, MaskData);
-	ApplyAsepriteLayerOverrides(Frame, InkData, AttributeData, MaskData);
+	const std::shared_ptr<const FFrameZXData> Data = GetAsepriteFrameZXData(Frame);
+	if (!Data)
+	{
+		return false;
+	}
+
+	InkData = Data->InkData;
+	AttributeData = Data->AttributeData;
+	MaskData = Data->MaskData;
 	return true;
 }
 
+bool SCanvas::MakeAsepriteFrameSource(int32_t Frame, FFrameZXSource& Output, bool bLayersOnly /*= false*/) const
+{
+	if (!AsepriteSprite ||
+		Frame < 0 ||
+		Frame >= AsepriteSprite->FrameCount)
+	{
+		return false;
+	}
+
+	Output.Frame = Frame;
+	Output.Width = Width;
+	Output.Height = Height;
+	Output.TransparentColor = TransparentColor;
+	Output.Settings = ConversationSettings;
+	Output.Sprite = AsepriteSprite;
+	Output.bLayersOnly = bLayersOnly;
+	if (!bLayersOnly && ImageFormat == EImageFormat::Aseprite && !SourcePathFile.empty())
+	{
+		Output.OverridePath[EFrameZXPart::Ink] = GetAsepriteFrameOverridePath(Frame, ".ink");
+		Output.OverridePath[EFrameZXPart::Attribute] = GetAsepriteFrameOverridePath(Frame, ".attr");
+		Output.OverridePath[EFrameZXPart::Mask] = GetAsepriteFrameOverridePath(Frame, ".mask");
+	}
+	return true;
+}
+
+bool SCanvas::IsAsepriteFrameReady() const
+{
+	return ImageFormat != EImageFormat::Aseprite ||
+		!AsepriteSprite ||
+		!AsepriteSprite->IsValid() ||
+		LastRebuiltSpriteFrame == SelectedSpritesFrame;
+}
+
+std::shared_ptr<const FFrameZXData> SCanvas::GetAsepriteFrameZXData(int32_t Frame) const
+{
+	if (!AsepriteSprite ||
+		!AsepriteSprite->IsValid() ||
+		Frame < 0 ||
+		Frame >= AsepriteSprite->FrameCount)
+	{
+		return nullptr;
+	}
+
+	std::shared_ptr<const FFrameZXData> Data = FrameCache.Find(Frame);
+	if (Data)
+	{
+		return Data;
+	}
+
+	FFrameZXSource Source;
+	std::shared_ptr<FFrameZXData> NewData = std::make_shared<FFrameZXData>();
+	if (!MakeAsepriteFrameSource(Frame, Source))
+	{
+		return nullptr;
+	}
+	FFrameCache::Decode(Source);
+	if (!FFrameCache::Convert(Source, *NewData))
+	{
+		return nullptr;
+	}
+
+	FrameCache.Add(Frame, NewData);
+	return NewData;
+}
+
+void SCanvas::PrefetchAsepriteFrames(int32_t Frame, int32_t Step /*= 1*/)
+{
+	if (!AsepriteSprite ||
+		!AsepriteSprite->IsValid() ||
+		ImageFormat != EImageFormat::Aseprite)
+	{
+		return;
+	}
+
+	// only the frame numbers and a copy of the sprite header are queued, the worker decodes the pixels;
+	// the copy keeps the worker away from the layers the timeline changes in place
+	std::shared_ptr<const AsepriteFormat::FSprite> Snapshot;
+	const int32_t FrameCount = AsepriteSprite->FrameCount;
+	const int32_t PrefetchCount = ImMin(AsepritePrefetchFrames, FrameCount - 1);
+	for (int32_t Index = 1; Index <= PrefetchCount; ++Index)
+	{
+		const int32_t NextFrame = ((Frame + Step * Index) % FrameCount + FrameCount) % FrameCount;
+		if (FrameCache.Contains(NextFrame))
+		{
+			continue;
+		}
+
+		FFrameZXSource Source;
+		if (MakeAsepriteFrameSource(NextFrame, Source))
+		{
+			if (!Snapshot)
+			{
+				Snapshot = std::make_shared<const AsepriteFormat::FSprite>(*AsepriteSprite);
+			}
+			Source.Sprite = Snapshot;
+			FrameCache.Prefetch(std::move(Source));
+		}
+	}
+}
+
 bool SCanvas::SaveSource(const std::filesystem::path& SavePath, const std::filesystem::path& SaveName)
 {
 	if (ImageFormat == EImageFormat::Aseprite)
@@ -2531,16 +2782,17 @@ bool SCanvas::UpdateAsepriteFrameFromSource()
 {
 	if (!AsepriteSprite ||
 		SelectedSpritesFrame < 0 ||
-		SelectedSpritesFrame >= static_cast<int32_t>(AsepriteSprite->Frames.size()))
+		SelectedSpritesFrame >= AsepriteSprite->FrameCount)
 	{
 		return false;
 	}
 
 	std::vector<uint32_t> RGBA;
 	UI::ZXIndexColorToRGBA(RGBA, ZXColorView->IndexedData, Width, Height);
-	std::vector<uint8_t>& Frame = AsepriteSprite->Frames[SelectedSpritesFrame];
-	Frame.resize(RGBA.size() * sizeof(uint32_t));
+	std::vector<uint8_t> Frame(RGBA.size() * sizeof(uint32_t));
 	std::memcpy(Frame.data(), RGBA.data(), Frame.size());
+	AsepriteFormat::SetFrameRGBA(*AsepriteSprite, SelectedSpritesFrame, std::move(Frame));
+	FrameCache.Invalidate(SelectedSpritesFrame);
 	return true;
 }
 
@@ -2586,19 +2838,14 @@ void SCanvas::Set_PixelToCanvas(const ImVec2& Position, uint8_t ButtonIndex)
 	LastSetButtonIndex = ButtonIndex;
 	LastSetPixelColorIndex = ColorIndex;
 
+	// the stroke delta is recorded by the undo queue
 	FPixelToCanvas Pixel;
 	{
 		Pixel.Position.push_back(Position);
 		Pixel.Color.push_back(ColorIndex);
 		Pixel.Canvas = OptionsFlags[0];
 	}
-	UndoQueue.SetWithUndo(
-		std::make_shared<Undo::TAction<FPixelToCanvas>>(
-			std::bind(&ThisClass::UndoSwapPixel, this, std::placeholders::_1),
-			Pixel
-		)
-	);
-
+	UndoSwapPixel(Pixel);
 }
 
 void SCanvas::UpdateCursorColor(bool bButton /*= false*/)
@@ -2706,7 +2953,7 @@ bool SCanvas::ApplyFrameInversion()
 
 	const int32_t FirstFrame = bInvertAllFrames ? 0 : SelectedSpritesFrame;
 	const int32_t LastFrame = bInvertAllFrames
-		? static_cast<int32_t>(AsepriteSprite->Frames.size())
+		? AsepriteSprite->FrameCount
 		: SelectedSpritesFrame + 1;
 
 	for (int32_t Frame = FirstFrame; Frame < LastFrame; ++Frame)
@@ -2762,7 +3009,7 @@ void SCanvas::ChangeFrameMode(EFrameMode::Type NewFrameMode)
 	bRefreshCanvas = true;
 }
 
-void SCanvas::RebuildCanvasFromAseprite(int32_t Frame /*= 0*/)
+void SCanvas::RebuildCanvasFromAseprite(int32_t Frame /*= 0*/, const UI::FDirtyRect* Region /*= nullptr*/)
 {
 	const bool bInk = OptionsFlags[0] & FCanvasOptionsFlags::Ink;
 	const bool bMask = OptionsFlags[0] & FCanvasOptionsFlags::Mask;
@@ -2774,22 +3021,26 @@ void SCanvas::RebuildCanvasFromAseprite(int32_t Frame /*= 0*/)
 	const bool bValidAsepriteFrame = AsepriteSprite &&
 		AsepriteSprite->IsValid() &&
 		Frame >= 0 &&
-		Frame < static_cast<int32_t>(AsepriteSprite->Frames.size());
+		Frame < AsepriteSprite->FrameCount;
 	const bool bRebuildFrame = bValidAsepriteFrame &&
 		(bFroceRebuiltSpriteFrame || LastRebuiltSpriteFrame != Frame);
 
 	if (bRebuildFrame)
 	{
-		UI::QuantizeToZX(AsepriteSprite->Frames[Frame].data(), Width, Height, 4, ZXColorView->IndexedData, TransparentColor);
-		UI::ZXIndexColorToZXAttributeColor(
-			ZXColorView->IndexedData,
-			Width, Height,
-			ZXColorView->InkData,
-			ZXColorView->AttributeData,
-			ZXColorView->MaskData,
-			ConversationSettings);
-		LoadAsepriteFrameOverride(Frame, ZXColorView->InkData, ZXColorView->AttributeData, ZXColorView->MaskData);
-		ApplyAsepriteLayerOverrides(Frame, ZXColorView->InkData, ZXColorView->AttributeData, ZXColorView->MaskData);
+		// the previous frame stays on screen until the worker finishes this one
+		if (LastRebuiltSpriteFrame != INDEX_NONE && FrameCache.IsPending(Frame))
+		{
+			bRefreshCanvas = true;
+			return;
+		}
+
+		if (const std::shared_ptr<const FFrameZXData> Data = GetAsepriteFrameZXData(Frame))
+		{
+			ZXColorView->IndexedData = Data->IndexedData;
+			ZXColorView->InkData = Data->InkData;
+			ZXColorView->AttributeData = Data->AttributeData;
+			ZXColorView->MaskData = Data->MaskData;
+		}
 		LastRebuiltSpriteFrame = Frame;
 	}
 
@@ -2898,19 +3149,23 @@ void SCanvas::RebuildCanvasFromAseprite(int32_t Frame /*= 0*/)
 		return;
 	}
 
+	// a rebuilt frame replaces everything, otherwise only the edited region is converted and uploaded
+	const UI::FDirtyRect ConvertRegion = Region != nullptr && !bRebuildFrame ? *Region : UI::FDirtyRect::Full(Width, Height);
 	if (bSource)
 	{
-		UI::ZXIndexColorToImage(ZXColorView->Image, ZXColorView->IndexedData, Width, Height);
+		UI::ZXIndexColorToImage(ZXColorView->Image, ZXColorView->Staging, ZXColorView->IndexedData, Width, Height, ConvertRegion);
 	}
 	else
 	{
 		UI::ZXAttributeColorToImage(
 			ZXColorView->Image,
+			ZXColorView->Staging,
 			Width, Height,
 			(bTransparentMask || bInk) ? ZXColorView->InkData.data() : nullptr,
 			(bTransparentMask || bPaper) ? ZXColorView->AttributeData.data() : nullptr,
 			bMask ? ZXColorView->MaskData.data() : nullptr,
-			false, nullptr, true,
+			ConvertRegion,
+			true,
 			bTransparentMask,
 			bTransparentPaper);
 	}
@@ -3002,6 +3257,7 @@ void SCanvas::UndoSwapPixel(FPixelToCanvas& Param)
 			uint32_t& Color = Param.Color[Index];
 			const uint32_t Offset = (uint32_t)Position.y * Width + (uint32_t)Position.x;
 			std::swap(ZXColorView->IndexedData[Offset], (uint8_t&)Color);
+			RefreshRegion.Add(UI::FDirtyRect::Pixel((int32_t)Position.x, (int32_t)Position.y));
 		}
 		bNeedConvertCanvasToZX = true;
 		bSourceDirty = true;
@@ -3031,6 +3287,9 @@ void SCanvas::UndoSwapPixel(FPixelToCanvas& Param)
 			uint8_t& Attribute = ZXColorView->AttributeData[by * Boundary_X + bx];
 			uint8_t _Attribute = Attribute;
 
+			// the attribute may change the whole cell
+			RefreshRegion.Add(UI::FDirtyRect::Cell(x, y));
+
 			// swap pixel color
 			const uint8_t PixelBit = 1 << (7 - dx);
 			const uint8_t Flags = OptionsFlags[0] & ~FCanvasOptionsFlags::Source;
@@ -3109,7 +3368,41 @@ void SCanvas::UndoSwapPixel(FPixelToCanvas& Param)
 		}
 		bNeedConvertZXToCanvas = true;
 	}
-	bRefreshCanvas = true;
+}
+
+void SCanvas::ClearUndo()
+{
+	if (UndoQueue.IsContinuous())
+	{
+		UndoQueue.EndContinuous();
+	}
+	UndoQueue.Clear();
+}
+
+void SCanvas::BeginUndoDelta()
+{
+	// in source mode the ZX data is converted from the indexed colors again,
+	// otherwise the canvas is rebuilt from the ZX data
+	if (OptionsFlags[0] & FCanvasOptionsFlags::Source)
+	{
+		UndoQueue.BeginDelta({ &ZXColorView->IndexedData },
+			[this]()
+			{
+				bNeedConvertCanvasToZX = true;
+				bSourceDirty = true;
+				bRefreshCanvas = true;
+			});
+	}
+	else
+	{
+		UndoQueue.BeginDelta({ &ZXColorView->InkData, &ZXColorView->AttributeData, &ZXColorView->MaskData },
+			[this]()
+			{
+				bIPMDirty = true;
+				bNeedConvertZXToCanvas = true;
+				bRefreshCanvas = true;
+			});
+	}
 }
 
 bool SCanvas::SplitSpriteName(const std::string& Name, std::string& Base, int32_t& Number) const
@@ -3437,7 +3730,8 @@ CodeGenerator::FResult SCanvas::CodeGeneration(
 	}
 
 	CodeGenerator::FAnalysis Analysis;
-	if (!BuildAnalysis(ScreenData, DirtyMask, EffectiveOptions, Analysis, Result.Error, Progress))
+	const CodeGenerator::FAnalysisCacheStats LastAnalysisStats = CodeGenerationAnalysisCache.Stats;
+	if (!BuildAnalysis(ScreenData, DirtyMask, EffectiveOptions, CodeGenerationAnalysisCache, Analysis, Result.Error, Progress))
 	{
 		return Result;
 	}
@@ -3455,6 +3749,11 @@ CodeGenerator::FResult SCanvas::CodeGeneration(
 	}
 
 	Result.OperationCount = (int32_t)Plan.CandidateIds.size();
+	Result.AnalysisReusedRegions = CodeGenerationAnalysisCache.Stats.ReusedRegions - LastAnalysisStats.ReusedRegions;
+	Result.AnalysisRebuiltRegions = CodeGenerationAnalysisCache.Stats.RebuiltRegions - LastAnalysisStats.RebuiltRegions;
+	Result.bAnalysisCacheHit = CodeGenerationAnalysisCache.Stats.ExactHits != LastAnalysisStats.ExactHits;
+	Result.bPlanExact = Plan.bExact;
+	Result.bPlanExactImproved = Plan.bExactImproved;
 	Result.Cycles = EmittedCycles;
 	Result.CodeBytes = (int32_t)Result.ByteCode.size();
 	Result.DirtyBytes = 0;
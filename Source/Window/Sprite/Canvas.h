@@ -11,6 +11,7 @@
 #include "ToolBar.h"
 #include "Definition.h"
 #include "UndoAction.h"
+#include "FrameCache.h"
 
 namespace EFrameMode { enum Type; }
 enum class EImageFormat;
@@ -98,6 +99,7 @@ private:
 	void Handler_RectangleMarquee();
 	void Handler_Pencil();
 	void Handler_Eyedropper();
+	void Handler_PaintBucket();
 
 	bool SaveSource(const std::filesystem::path& SavePath, const std::filesystem::path& SaveName);
 	bool SaveIPM(const std::filesystem::path& SavePath, const std::filesystem::path& SaveName);
@@ -123,6 +125,10 @@ private:
 		std::vector<uint8_t>& InkData,
 		std::vector<uint8_t>& AttributeData,
 		std::vector<uint8_t>& MaskData) const;
+	bool MakeAsepriteFrameSource(int32_t Frame, FFrameZXSource& Output, bool bLayersOnly = false) const;
+	std::shared_ptr<const FFrameZXData> GetAsepriteFrameZXData(int32_t Frame) const;
+	bool IsAsepriteFrameReady() const;
+	void PrefetchAsepriteFrames(int32_t Frame, int32_t Step = 1);
 	void InvertZXDataInRect(
 		std::vector<uint8_t>& InkData,
 		std::vector<uint8_t>& AttributeData,
@@ -147,11 +153,14 @@ private:
 	void ChangeFrameMode(EFrameMode::Type NewFrameMode);
 
 	// update canvas
-	void RebuildCanvasFromAseprite(int32_t Frame = 0);
+	void RebuildCanvasFromAseprite(int32_t Frame = 0, const UI::FDirtyRect* Region = nullptr);
 	bool FrameDifferenceZXColor(int32_t Frame, std::vector<uint8_t>& OutputDifference_InkData, std::vector<uint8_t>& OutputDifference_AttributeData, std::vector<uint8_t>& OutputDifference_MaskData, bool bReverse = false);
 
 	// undo/redo
 	void UndoSwapPixel(FPixelToCanvas& Param);
+	void BeginUndoDelta();
+	// the deltas are only valid for the buffers they were recorded on
+	void ClearUndo();
 
 	struct FSpriteNameOption
 	{
@@ -178,6 +187,7 @@ private:
 	bool bIPMDirty;
 	bool bDragging;
 	bool bRefreshCanvas;
+	UI::FDirtyRect RefreshRegion;		// pixels edited since the last refresh, converted and uploaded alone
 	bool bTransparentMask;
 	bool bAttributeClash;
 	bool bLastAttributeClashPhase;
@@ -206,6 +216,8 @@ private:
 	// draw pixels
 	UI::EZXSpectrumColor::Type ButtonColor[2];
 	UI::EZXSpectrumColor::Type Subcolor[ESubcolor::MAX];
+	FPaintBucketOptions PaintBucketOptions;
+	std::vector<uint8_t> PaintBucketRegion;
 	uint8_t LastSetButtonIndex;
 	uint8_t LastSetPixelColorIndex;
 	ImVec2 LastSetPixelPosition;
@@ -246,5 +258,10 @@ private:
 
 	// Undo/Redo
 	Undo::FQueue UndoQueue;
-	size_t PixelStrokeBegin;
+
+	// converted aseprite frames
+	mutable FFrameCache FrameCache;
+
+	// 6912
+	CodeGenerator::FAnalysisCache CodeGenerationAnalysisCache;
 };
@@ -15,6 +15,7 @@ namespace FEventTag
 {
 	static const FName ChangeToolModeTag = TEXT("ChangeToolMode");
 	static const FName RequestToolModeTag = TEXT("RequestToolMode");
+	static const FName PaintBucketOptionsTag = TEXT("PaintBucketOptions");
 	static const FName CanvasOptionsFlagsTag = TEXT("CanvasOptionsFlags");
 	static const FName CanvasViewFlagsTag = TEXT("CanvasViewFlags");
 	static const FName CanvasViewScaleTag = TEXT("CanvasViewScale");
@@ -89,6 +90,7 @@ struct FEvent_StatusBar : public IEvent
 struct FEvent_ToolBar : public IEvent
 {
 	FChangeToolMode ChangeToolMode;
+	FPaintBucketOptions PaintBucketOptions;
 	using IEvent::IEvent;
 };
 
@@ -0,0 +1,283 @@
+#include "FrameCache.h"
+#include <Utils/IO.h>
+
+FFrameCache::FFrameCache(size_t InBudget /*= 64 * 1024 * 1024*/)
+	: Budget(InBudget)
+	, Size(0)
+	, Generation(0)
+	, ConvertingFrame(INDEX_NONE)
+	, bQuit(false)
+	, bWorking(false)
+{}
+
+FFrameCache::~FFrameCache()
+{
+	FJobHandle Job;
+	{
+		std::lock_guard Lock(Mutex);
+		bQuit = true;
+		Pending.clear();
+		Job = WorkerJob;
+	}
+	// the job still converts the frame it has taken
+	Job.Cancel();
+	Job.Wait();
+}
+
+void FFrameCache::Decode(FFrameZXSource& Source)
+{
+	if (!Source.Sprite)
+	{
+		return;
+	}
+
+	const AsepriteFormat::FSprite& Sprite = *Source.Sprite;
+	if (!Source.bLayersOnly)
+	{
+		Source.RGBA = *AsepriteFormat::GetFrameRGBA(Sprite, Source.Frame);
+	}
+	Source.bLayer[EFrameZXPart::Ink] = AsepriteFormat::GetLayerFrameRGBA(Sprite, Source.Frame, Sprite.InkLayer, Source.LayerRGBA[EFrameZXPart::Ink]);
+	Source.bLayer[EFrameZXPart::Attribute] = AsepriteFormat::GetLayerFrameRGBA(Sprite, Source.Frame, Sprite.AttributeLayer, Source.LayerRGBA[EFrameZXPart::Attribute]);
+	Source.bLayer[EFrameZXPart::Mask] = AsepriteFormat::GetLayerFrameRGBA(Sprite, Source.Frame, Sprite.MaskLayer, Source.LayerRGBA[EFrameZXPart::Mask]);
+}
+
+bool FFrameCache::Convert(const FFrameZXSource& Source, FFrameZXData& Output)
+{
+	const size_t PixelCount = static_cast<size_t>(Source.Width) * Source.Height;
+	if (PixelCount == 0 || Source.RGBA.size() < PixelCount * 4)
+	{
+		return false;
+	}
+
+	UI::QuantizeToZX(Source.RGBA.data(), Source.Width, Source.Height, 4, Output.IndexedData, Source.TransparentColor);
+	UI::ZXIndexColorToZXAttributeColor(
+		Output.IndexedData,
+		Source.Width,
+		Source.Height,
+		Output.InkData,
+		Output.AttributeData,
+		Output.MaskData,
+		Source.Settings);
+
+	const size_t ExpectedPixelSize = static_cast<size_t>(Source.Width >> 3) * Source.Height;
+	const size_t ExpectedAttributeSize = static_cast<size_t>(Source.Width >> 3) * (Source.Height >> 3);
+	LoadOverride(Source.OverridePath[EFrameZXPart::Ink], ExpectedPixelSize, Output.InkData);
+	LoadOverride(Source.OverridePath[EFrameZXPart::Attribute], ExpectedAttributeSize, Output.AttributeData);
+	LoadOverride(Source.OverridePath[EFrameZXPart::Mask], ExpectedPixelSize, Output.MaskData);
+	ApplyLayerOverrides(Source, Output.InkData, Output.AttributeData, Output.MaskData);
+	return true;
+}
+
+bool FFrameCache::LoadOverride(const std::filesystem::path& Path, size_t ExpectedSize, std::vector<uint8_t>& Output)
+{
+	if (Path.empty() || !std::filesystem::exists(Path))
+	{
+		return false;
+	}
+
+	std::vector<uint8_t> Data;
+	const std::error_code Error = IO::LoadBinaryData(Data, Path);
+	if (Error || Data.size() != ExpectedSize)
+	{
+		LOG_ERROR("[LoadAsepriteFrameOverride] Invalid override file: {}", Path.string());
+		return false;
+	}
+
+	Output = std::move(Data);
+	return true;
+}
+
+bool FFrameCache::ApplyLayerOverrides(
+	const FFrameZXSource& Source,
+	std::vector<uint8_t>& InkData,
+	std::vector<uint8_t>& AttributeData,
+	std::vector<uint8_t>& MaskData)
+{
+	bool bApplied = false;
+	if (Source.bLayer[EFrameZXPart::Ink])
+	{
+		UI::ZXAlphaToPixelData(Source.LayerRGBA[EFrameZXPart::Ink].data(), Source.Width, Source.Height, 4, InkData);
+		bApplied = true;
+	}
+	if (Source.bLayer[EFrameZXPart::Mask])
+	{
+		UI::ZXAlphaToPixelData(Source.LayerRGBA[EFrameZXPart::Mask].data(), Source.Width, Source.Height, 4, MaskData, true);
+		bApplied = true;
+	}
+	if (Source.bLayer[EFrameZXPart::Attribute])
+	{
+		std::vector<uint8_t> IndexedData;
+		std::vector<uint8_t> IgnoredInkData;
+		std::vector<uint8_t> IgnoredMaskData;
+		UI::QuantizeToZX(
+			Source.LayerRGBA[EFrameZXPart::Attribute].data(),
+			Source.Width,
+			Source.Height,
+			4,
+			IndexedData,
+			Source.TransparentColor);
+		UI::ZXIndexColorToZXAttributeColor(
+			IndexedData,
+			Source.Width,
+			Source.Height,
+			IgnoredInkData,
+			AttributeData,
+			IgnoredMaskData,
+			Source.Settings);
+		bApplied = true;
+	}
+	return bApplied;
+}
+
+std::shared_ptr<const FFrameZXData> FFrameCache::Find(int32_t Frame)
+{
+	std::lock_guard Lock(Mutex);
+	auto It = Frames.find(Frame);
+	if (It == Frames.end())
+	{
+		return nullptr;
+	}
+
+	Order.splice(Order.begin(), Order, It->second.Order);
+	return It->second.Data;
+}
+
+void FFrameCache::Add(int32_t Frame, std::shared_ptr<const FFrameZXData> Data)
+{
+	std::lock_guard Lock(Mutex);
+	Insert(Frame, std::move(Data));
+}
+
+bool FFrameCache::Contains(int32_t Frame) const
+{
+	std::lock_guard Lock(Mutex);
+	return Frames.contains(Frame) || IsQueued(Frame);
+}
+
+bool FFrameCache::IsPending(int32_t Frame) const
+{
+	std::lock_guard Lock(Mutex);
+	return !Frames.contains(Frame) && IsQueued(Frame);
+}
+
+void FFrameCache::Prefetch(FFrameZXSource&& Source)
+{
+	{
+		std::lock_guard Lock(Mutex);
+		if (bQuit)
+		{
+			return;
+		}
+		Pending.push_back(std::move(Source));
+		if (bWorking)
+		{
+			return;
+		}
+
+		bWorking = true;
+		WorkerJob = FJobSystem::Get().Submit("Frame cache", [this](FJobContext& Context) { Worker_Execution(Context); }, nullptr, EJobPriority::High);
+		if (!WorkerJob.IsBusy())
+		{
+			// the pool is shut down, nothing would ever convert the queue
+			bWorking = false;
+			Pending.clear();
+		}
+	}
+}
+
+void FFrameCache::Invalidate()
+{
+	std::lock_guard Lock(Mutex);
+	++Generation;
+	Frames.clear();
+	Order.clear();
+	Pending.clear();
+	// the result of the running conversion is dropped, nobody should wait for it
+	ConvertingFrame = INDEX_NONE;
+	Size = 0;
+}
+
+void FFrameCache::Invalidate(int32_t Frame)
+{
+	std::lock_guard Lock(Mutex);
+	++Generation;
+	std::erase_if(Pending, [Frame](const FFrameZXSource& Source) { return Source.Frame == Frame; });
+	ConvertingFrame = INDEX_NONE;
+
+	auto It = Frames.find(Frame);
+	if (It != Frames.end())
+	{
+		Size -= It->second.Data->GetSize();
+		Order.erase(It->second.Order);
+		Frames.erase(It);
+	}
+}
+
+void FFrameCache::Worker_Execution(FJobContext& Context)
+{
+	std::unique_lock Lock(Mutex);
+	while (true)
+	{
+		if (bQuit || Pending.empty() || Context.IsCancelled())
+		{
+			bWorking = false;
+			break;
+		}
+
+		FFrameZXSource Source = std::move(Pending.front());
+		Pending.pop_front();
+		if (Frames.contains(Source.Frame))
+		{
+			continue;
+		}
+
+		const uint32_t SourceGeneration = Generation;
+		ConvertingFrame = Source.Frame;
+		Lock.unlock();
+
+		std::shared_ptr<FFrameZXData> Data = std::make_shared<FFrameZXData>();
+		Decode(Source);
+		const bool bConverted = Convert(Source, *Data);
+
+		Lock.lock();
+		if (ConvertingFrame == Source.Frame)
+		{
+			ConvertingFrame = INDEX_NONE;
+		}
+		// anything invalidated meanwhile may have changed the inputs of this frame
+		if (bConverted && SourceGeneration == Generation)
+		{
+			Insert(Source.Frame, std::move(Data));
+		}
+	}
+}
+
+void FFrameCache::Insert(int32_t Frame, std::shared_ptr<const FFrameZXData> Data)
+{
+	auto It = Frames.find(Frame);
+	if (It != Frames.end())
+	{
+		Size -= It->second.Data->GetSize();
+		Order.erase(It->second.Order);
+		Frames.erase(It);
+	}
+
+	Size += Data->GetSize();
+	Order.push_front(Frame);
+	Frames.emplace(Frame, FEntry{ std::move(Data), Order.begin() });
+
+	// least recently used frames go first, the newest one always stays
+	while (Size > Budget && Order.size() > 1)
+	{
+		auto Oldest = Frames.find(Order.back());
+		Size -= Oldest->second.Data->GetSize();
+		Frames.erase(Oldest);
+		Order.pop_back();
+	}
+}
+
+bool FFrameCache::IsQueued(int32_t Frame) const
+{
+	return ConvertingFrame == Frame ||
+		std::any_of(Pending.begin(), Pending.end(), [Frame](const FFrameZXSource& Source) { return Source.Frame == Frame; });
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <list>
+#include <deque>
+#include <mutex>
+#include <CoreMinimal.h>
+#include <Core/JobSystem.h>
+#include <Utils/Aseprite/Format.h>
+#include <Utils/UI/Draw_ZXColorVideo.h>
+
+namespace EFrameZXPart
+{
+	enum Type
+	{
+		Ink,
+		Attribute,
+		Mask,
+
+		MAX,
+	};
+}
+
+// converted ZX data of one aseprite frame
+struct FFrameZXData
+{
+	std::vector<uint8_t> IndexedData;
+	std::vector<uint8_t> InkData;
+	std::vector<uint8_t> AttributeData;
+	std::vector<uint8_t> MaskData;
+
+	size_t GetSize() const
+	{
+		return IndexedData.size() + InkData.size() + AttributeData.size() + MaskData.size();
+	}
+};
+
+// everything the conversion of a frame reads; the UI thread fills only the settings and the sprite,
+// the pixels are decoded by whoever converts the frame
+struct FFrameZXSource
+{
+	int32_t Frame = INDEX_NONE;
+	int32_t Width = 0;
+	int32_t Height = 0;
+	ImU32 TransparentColor = 0;
+	UI::FConversationSettings Settings;
+
+	// the worker gets a copy of the sprite header (layers, assignments), the decoded data behind it is shared and locked
+	std::shared_ptr<const AsepriteFormat::FSprite> Sprite;
+	bool bLayersOnly = false;
+
+	// *.ink/*.attr/*.mask files next to the source, empty paths are skipped
+	std::filesystem::path OverridePath[EFrameZXPart::MAX];
+
+	// filled by Decode: the composite and the RGBA of the layers assigned to ink/attribute/mask
+	std::vector<uint8_t> RGBA;
+	bool bLayer[EFrameZXPart::MAX] = {};
+	std::vector<uint8_t> LayerRGBA[EFrameZXPart::MAX];
+};
+
+// LRU cache of converted frames, prefetched frames are converted one after another by a single pool job
+class FFrameCache
+{
+public:
+	FFrameCache(size_t InBudget = 64 * 1024 * 1024);
+	~FFrameCache();
+
+	FFrameCache(const FFrameCache&) = delete;
+	FFrameCache& operator=(const FFrameCache&) = delete;
+
+	// composite and layer RGBA of the frame
+	static void Decode(FFrameZXSource& Source);
+	// quantization, attribute cells, override files and layer overrides
+	static bool Convert(const FFrameZXSource& Source, FFrameZXData& Output);
+	static bool LoadOverride(const std::filesystem::path& Path, size_t ExpectedSize, std::vector<uint8_t>& Output);
+	static bool ApplyLayerOverrides(
+		const FFrameZXSource& Source,
+		std::vector<uint8_t>& InkData,
+		std::vector<uint8_t>& AttributeData,
+		std::vector<uint8_t>& MaskData);
+
+	// returns nullptr if the frame isn't cached, never waits for the worker
+	std::shared_ptr<const FFrameZXData> Find(int32_t Frame);
+	void Add(int32_t Frame, std::shared_ptr<const FFrameZXData> Data);
+
+	// cached or waiting for the worker
+	bool Contains(int32_t Frame) const;
+	// not cached yet, but queued or being converted by the worker
+	bool IsPending(int32_t Frame) const;
+	void Prefetch(FFrameZXSource&& Source);
+
+	void Invalidate();
+	void Invalidate(int32_t Frame);
+
+private:
+	void Worker_Execution(FJobContext& Context);
+	void Insert(int32_t Frame, std::shared_ptr<const FFrameZXData> Data);
+	bool IsQueued(int32_t Frame) const;	// the caller holds Mutex
+
+	struct FEntry
+	{
+		std::shared_ptr<const FFrameZXData> Data;
+		std::list<int32_t>::iterator Order;
+	};
+
+	size_t Budget;
+	size_t Size;
+	uint32_t Generation;
+	int32_t ConvertingFrame;
+	bool bQuit;
+	bool bWorking;		// the job is submitted and drains Pending
+
+	std::list<int32_t> Order;	// most recently used first
+	std::unordered_map<int32_t, FEntry> Frames;
+	std::deque<FFrameZXSource> Pending;
+
+	mutable std::mutex Mutex;
+	FJobHandle WorkerJob;
+};
@@ -0,0 +1,241 @@
+#include "SpriteAtlas.h"
+#include <numeric>
+
+namespace
+{
+	// segment of the skyline, in attribute cells
+	struct FSkylineNode
+	{
+		int32_t X;
+		int32_t Y;
+		int32_t Width;
+	};
+
+	struct FSkylinePage
+	{
+		int32_t Width;
+		int32_t Height;
+		std::vector<FSkylineNode> Nodes;
+	};
+
+	// lowest top of the rectangle when its left edge is at the node, INDEX_NONE if it doesn't fit
+	int32_t FitAtNode(const FSkylinePage& Page, size_t Index, int32_t Width, int32_t Height)
+	{
+		const int32_t X = Page.Nodes[Index].X;
+		if (X + Width > Page.Width)
+		{
+			return INDEX_NONE;
+		}
+
+		int32_t Y = 0;
+		int32_t WidthLeft = Width;
+		for (size_t It = Index; WidthLeft > 0 && It < Page.Nodes.size(); ++It)
+		{
+			Y = (std::max)(Y, Page.Nodes[It].Y);
+			WidthLeft -= Page.Nodes[It].Width;
+		}
+		return Y + Height <= Page.Height ? Y : INDEX_NONE;
+	}
+
+	void AddSkylineLevel(FSkylinePage& Page, size_t Index, int32_t X, int32_t Y, int32_t Width)
+	{
+		Page.Nodes.insert(Page.Nodes.begin() + Index, FSkylineNode{ X, Y, Width });
+
+		// the nodes under the new one are cut or removed
+		for (size_t It = Index + 1; It < Page.Nodes.size();)
+		{
+			FSkylineNode& Node = Page.Nodes[It];
+			const int32_t Overlap = X + Width - Node.X;
+			if (Overlap <= 0)
+			{
+				break;
+			}
+			if (Overlap < Node.Width)
+			{
+				Node.X += Overlap;
+				Node.Width -= Overlap;
+				break;
+			}
+			Page.Nodes.erase(Page.Nodes.begin() + It);
+		}
+
+		for (size_t It = 0; It + 1 < Page.Nodes.size();)
+		{
+			if (Page.Nodes[It].Y == Page.Nodes[It + 1].Y)
+			{
+				Page.Nodes[It].Width += Page.Nodes[It + 1].Width;
+				Page.Nodes.erase(Page.Nodes.begin() + It + 1);
+			}
+			else
+			{
+				++It;
+			}
+		}
+	}
+}
+
+void FSpriteAtlas::Pack(const std::vector<std::pair<int32_t, int32_t>>& Sizes, int32_t PageWidth /*= 256*/, int32_t PageHeight /*= 256*/)
+{
+	Reset();
+	Rects.resize(Sizes.size());
+
+	const int32_t PageCellsX = (std::max)(PageWidth >> 3, 1);
+	const int32_t PageCellsY = (std::max)(PageHeight >> 3, 1);
+
+	// tallest first, then widest, keeps the skyline flat
+	std::vector<size_t> Order(Sizes.size());
+	std::iota(Order.begin(), Order.end(), 0);
+	std::stable_sort(Order.begin(), Order.end(),
+		[&Sizes](size_t Lhs, size_t Rhs)
+		{
+			return Sizes[Lhs].second != Sizes[Rhs].second ? Sizes[Lhs].second > Sizes[Rhs].second : Sizes[Lhs].first > Sizes[Rhs].first;
+		});
+
+	std::vector<FSkylinePage> SkylinePages;
+	std::vector<int32_t> UsedHeight;
+	for (const size_t Index : Order)
+	{
+		const int32_t Width = Sizes[Index].first;
+		const int32_t Height = Sizes[Index].second;
+		if (Width <= 0 || Height <= 0)
+		{
+			continue;
+		}
+
+		const int32_t CellsX = (Width + 7) >> 3;
+		const int32_t CellsY = (Height + 7) >> 3;
+		FSpriteAtlasRect& Rect = Rects[Index];
+		Rect.Width = Width;
+		Rect.Height = Height;
+
+		if (CellsX > PageCellsX || CellsY > PageCellsY)
+		{
+			// oversized, the page is full right away
+			SkylinePages.push_back({ CellsX, CellsY, { { 0, CellsY, CellsX } } });
+			UsedHeight.push_back(CellsY);
+			Rect.Page = int32_t(SkylinePages.size() - 1);
+			continue;
+		}
+
+		int32_t BestPage = INDEX_NONE;
+		size_t BestNode = 0;
+		int32_t BestY = 0;
+		for (int32_t PageIndex = 0; PageIndex < int32_t(SkylinePages.size()) && BestPage == INDEX_NONE; ++PageIndex)
+		{
+			const FSkylinePage& Page = SkylinePages[PageIndex];
+			int32_t BestTop = INT32_MAX;
+			for (size_t Node = 0; Node < Page.Nodes.size(); ++Node)
+			{
+				const int32_t Y = FitAtNode(Page, Node, CellsX, CellsY);
+				if (Y != INDEX_NONE && Y + CellsY < BestTop)
+				{
+					BestTop = Y + CellsY;
+					BestPage = PageIndex;
+					BestNode = Node;
+					BestY = Y;
+				}
+			}
+		}
+
+		if (BestPage == INDEX_NONE)
+		{
+			SkylinePages.push_back({ PageCellsX, PageCellsY, { { 0, 0, PageCellsX } } });
+			UsedHeight.push_back(0);
+			BestPage = int32_t(SkylinePages.size() - 1);
+			BestNode = 0;
+			BestY = 0;
+		}
+
+		FSkylinePage& Page = SkylinePages[BestPage];
+		const int32_t X = Page.Nodes[BestNode].X;
+		AddSkylineLevel(Page, BestNode, X, BestY + CellsY, CellsX);
+		UsedHeight[BestPage] = (std::max)(UsedHeight[BestPage], BestY + CellsY);
+
+		Rect.Page = BestPage;
+		Rect.X = X << 3;
+		Rect.Y = BestY << 3;
+	}
+
+	Pages.resize(SkylinePages.size());
+	for (size_t PageIndex = 0; PageIndex < SkylinePages.size(); ++PageIndex)
+	{
+		Pages[PageIndex].Width = SkylinePages[PageIndex].Width << 3;
+		Pages[PageIndex].Height = UsedHeight[PageIndex] << 3;
+	}
+}
+
+void FSpriteAtlas::Reset()
+{
+	Pages.clear();
+	Rects.clear();
+}
+
+size_t FSpriteAtlas::GetPixelSize() const
+{
+	size_t Size = 0;
+	for (const FSpriteAtlasPage& Page : Pages)
+	{
+		Size += Page.GetPixelSize();
+	}
+	return Size;
+}
+
+size_t FSpriteAtlas::GetAttributeSize() const
+{
+	size_t Size = 0;
+	for (const FSpriteAtlasPage& Page : Pages)
+	{
+		Size += Page.GetAttributeSize();
+	}
+	return Size;
+}
+
+size_t FSpriteAtlas::GetPixelOffset(const FSpriteAtlasRect& Rect) const
+{
+	size_t Offset = 0;
+	for (int32_t PageIndex = 0; PageIndex < Rect.Page; ++PageIndex)
+	{
+		Offset += Pages[PageIndex].GetPixelSize();
+	}
+	return Offset + static_cast<size_t>(Rect.Y) * GetStride(Rect) + (Rect.X >> 3);
+}
+
+size_t FSpriteAtlas::GetAttributeOffset(const FSpriteAtlasRect& Rect) const
+{
+	size_t Offset = 0;
+	for (int32_t PageIndex = 0; PageIndex < Rect.Page; ++PageIndex)
+	{
+		Offset += Pages[PageIndex].GetAttributeSize();
+	}
+	return Offset + static_cast<size_t>(Rect.Y >> 3) * GetStride(Rect) + (Rect.X >> 3);
+}
+
+void FSpriteAtlas::WriteRows(std::vector<uint8_t>& Blob, size_t Offset, int32_t Stride, const std::vector<uint8_t>& Data, int32_t RowSize, int32_t Rows)
+{
+	for (int32_t Row = 0; Row < Rows; ++Row)
+	{
+		const size_t Source = static_cast<size_t>(Row) * RowSize;
+		const size_t Destination = Offset + static_cast<size_t>(Row) * Stride;
+		if (Source + RowSize > Data.size() || Destination + RowSize > Blob.size())
+		{
+			break;
+		}
+		std::memcpy(Blob.data() + Destination, Data.data() + Source, RowSize);
+	}
+}
+
+bool FSpriteAtlas::ReadRows(const std::vector<uint8_t>& Blob, size_t Offset, int32_t Stride, int32_t RowSize, int32_t Rows, std::vector<uint8_t>& Output)
+{
+	if (Rows <= 0 || RowSize <= 0 || Stride < RowSize ||
+		Offset + static_cast<size_t>(Rows - 1) * Stride + RowSize > Blob.size())
+	{
+		return false;
+	}
+
+	Output.resize(static_cast<size_t>(RowSize) * Rows);
+	for (int32_t Row = 0; Row < Rows; ++Row)
+	{
+		std::memcpy(Output.data() + static_cast<size_t>(Row) * RowSize, Blob.data() + Offset + static_cast<size_t>(Row) * Stride, RowSize);
+	}
+	return true;
+}
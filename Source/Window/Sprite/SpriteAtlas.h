@@ -0,0 +1,52 @@
+#pragma once
+
+#include <CoreMinimal.h>
+
+// place of a sprite on an atlas page, in pixels
+struct FSpriteAtlasRect
+{
+	int32_t Page = INDEX_NONE;
+	int32_t X = 0;
+	int32_t Y = 0;
+	int32_t Width = 0;
+	int32_t Height = 0;
+
+	bool IsValid() const { return Page != INDEX_NONE; }
+};
+
+struct FSpriteAtlasPage
+{
+	int32_t Width = 0;
+	int32_t Height = 0;
+
+	// ZX layout of a page: rows of Width / 8 bytes, 8 pixels per byte and one attribute per 8x8 cell
+	int32_t GetStride() const { return Width >> 3; }
+	size_t GetPixelSize() const { return static_cast<size_t>(GetStride()) * Height; }
+	size_t GetAttributeSize() const { return static_cast<size_t>(GetStride()) * (Height >> 3); }
+};
+
+// skyline packer of sprites into shared pages
+// sprites are placed on the 8x8 attribute grid, so every rectangle starts at a whole byte of a pixel row
+// and at a whole attribute cell, pages follow each other in the exported blobs
+struct FSpriteAtlas
+{
+	std::vector<FSpriteAtlasPage> Pages;
+	std::vector<FSpriteAtlasRect> Rects;	// in the order of the packed sizes
+
+	// sizes are in pixels and are rounded up to the attribute cell,
+	// a sprite larger than a page gets a page of its own, pages are cut down to the used height
+	void Pack(const std::vector<std::pair<int32_t, int32_t>>& Sizes, int32_t PageWidth = 256, int32_t PageHeight = 256);
+	void Reset();
+
+	int32_t GetStride(const FSpriteAtlasRect& Rect) const { return Pages[Rect.Page].GetStride(); }
+	size_t GetPixelSize() const;
+	size_t GetAttributeSize() const;
+
+	// offsets of the first byte of the sprite in the ink/mask and attribute blobs
+	size_t GetPixelOffset(const FSpriteAtlasRect& Rect) const;
+	size_t GetAttributeOffset(const FSpriteAtlasRect& Rect) const;
+
+	// copy of Rows rows of RowSize bytes between a tightly packed sprite and a blob with Stride bytes per row
+	static void WriteRows(std::vector<uint8_t>& Blob, size_t Offset, int32_t Stride, const std::vector<uint8_t>& Data, int32_t RowSize, int32_t Rows);
+	static bool ReadRows(const std::vector<uint8_t>& Blob, size_t Offset, int32_t Stride, int32_t RowSize, int32_t Rows, std::vector<uint8_t>& Output);
+};
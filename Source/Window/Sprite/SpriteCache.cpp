@@ -0,0 +1,399 @@
+#include "SpriteCache.h"
+#include "SpriteList.h"
+#include <Utils/IO.h>
+#include <Utils/Hash.h>
+#include <json/json.hpp>
+#include <mutex>
+
+namespace
+{
+	static constexpr char CacheMagic[4] = { 'Z', 'X', 'S', 'C' };
+	static constexpr uint32_t CacheVersion = 2;
+	static constexpr uint64_t MissingFile = UINT64_MAX;
+
+	// the imports run as jobs, two of them never write the same temporary file at once
+	std::mutex SaveMutex;
+
+	struct FHash
+	{
+		uint64_t Value = Utils::FNV1a64Basis;
+
+		void Update(const void* Data, size_t Size)
+		{
+			Value = Utils::FNV1a64(Value, Data, Size);
+		}
+	};
+
+	// range of the string pool
+	struct FString
+	{
+		uint32_t Offset;
+		uint32_t Size;
+	};
+
+	// range of the data blob
+	struct FBlob
+	{
+		uint64_t Offset;
+		uint64_t Size;
+	};
+
+	struct FHeader
+	{
+		char Magic[4];
+		uint32_t Version;
+		uint64_t JsonSize;
+		uint64_t JsonHash;
+		uint64_t SettingsHash;	// of the conversion settings the sprites were converted with
+		uint32_t DependencyCount;
+		uint32_t SpriteCount;
+		uint64_t DependencyTableOffset;
+		uint64_t SpriteTableOffset;
+		FBlob StringPool;
+		FBlob Data;
+	};
+
+	struct FDependencyRecord
+	{
+		FString Path;
+		uint64_t Size;			// MissingFile if the file didn't exist
+		int64_t WriteTime;
+	};
+
+	struct FSpriteRecord
+	{
+		FString Name;
+		FString SourcePathFile;
+		FString InkLayer;
+		FString AttributeLayer;
+		FString MaskLayer;
+		FString Regions;		// json of the metadata regions, empty if there are none
+		uint32_t Width;
+		uint32_t Height;
+		uint32_t PositionX;
+		uint32_t PositionY;
+		int32_t AsepriteIndex;
+		uint32_t Reserved;
+		FBlob IndexedData;
+		FBlob InkData;
+		FBlob AttributeData;
+		FBlob MaskData;
+	};
+
+	// the file layout doesn't depend on the compiler
+	static_assert(sizeof(FHeader) == 88);
+	static_assert(sizeof(FDependencyRecord) == 24);
+	static_assert(sizeof(FSpriteRecord) == 136);
+
+	void GetFileStamp(const std::filesystem::path& Path, uint64_t& OutputSize, int64_t& OutputWriteTime)
+	{
+		std::error_code ec;
+		OutputSize = std::filesystem::file_size(Path, ec);
+		const std::filesystem::file_time_type WriteTime = ec ? std::filesystem::file_time_type() : std::filesystem::last_write_time(Path, ec);
+		if (ec)
+		{
+			OutputSize = MissingFile;
+			OutputWriteTime = 0;
+			return;
+		}
+		OutputWriteTime = static_cast<int64_t>(WriteTime.time_since_epoch().count());
+	}
+
+	bool HashFile(const std::filesystem::path& Path, uint64_t& OutputSize, uint64_t& OutputHash)
+	{
+		IO::FMappedFile File;
+		if (!File.Open(Path))
+		{
+			return false;
+		}
+
+		FHash Hash;
+		Hash.Update(File.GetData(), File.GetSize());
+		OutputSize = File.GetSize();
+		OutputHash = Hash.Value;
+		return true;
+	}
+
+	uint64_t HashSettings(const UI::FConversationSettings& Settings)
+	{
+		const uint8_t Fields[] = { Settings.InkAlways, Settings.TransparentIndex, Settings.ReplaceTransparent, Settings.bMinimizeError };
+		FHash Hash;
+		Hash.Update(Fields, sizeof(Fields));
+		return Hash.Value;
+	}
+
+	struct FWriter
+	{
+		std::vector<uint8_t> StringPool;
+		std::vector<uint8_t> Data;
+
+		FString AddString(const std::string& Text)
+		{
+			const FString Result{ static_cast<uint32_t>(StringPool.size()), static_cast<uint32_t>(Text.size()) };
+			StringPool.insert(StringPool.end(), Text.begin(), Text.end());
+			return Result;
+		}
+
+		FBlob AddBlob(const std::vector<uint8_t>& Bytes)
+		{
+			const FBlob Result{ Data.size(), Bytes.size() };
+			Data.insert(Data.end(), Bytes.begin(), Bytes.end());
+			return Result;
+		}
+	};
+
+	struct FReader
+	{
+		const uint8_t* File;
+		size_t FileSize;
+		FBlob StringPool;
+		FBlob Data;
+
+		static bool IsInside(uint64_t Offset, uint64_t Size, uint64_t Limit)
+		{
+			return Offset <= Limit && Size <= Limit - Offset;
+		}
+
+		bool GetString(const FString& String, std::string& Output) const
+		{
+			if (!IsInside(String.Offset, String.Size, StringPool.Size))
+			{
+				return false;
+			}
+			const char* Begin = reinterpret_cast<const char*>(File + StringPool.Offset + String.Offset);
+			Output.assign(Begin, String.Size);
+			return true;
+		}
+
+		bool GetPath(const FString& String, std::filesystem::path& Output) const
+		{
+			std::string Text;
+			if (!GetString(String, Text))
+			{
+				return false;
+			}
+			Output = Utils::Utf8ToUtf16(Text);
+			return true;
+		}
+
+		bool GetBlob(const FBlob& Blob, std::vector<uint8_t>& Output) const
+		{
+			if (!IsInside(Blob.Offset, Blob.Size, Data.Size))
+			{
+				return false;
+			}
+			const uint8_t* Begin = File + Data.Offset + Blob.Offset;
+			Output.assign(Begin, Begin + Blob.Size);
+			return true;
+		}
+	};
+}
+
+std::filesystem::path FSpriteCache::GetCachePath(const std::filesystem::path& JsonFilePath)
+{
+	std::filesystem::path CachePath = JsonFilePath;
+	return CachePath.replace_extension(".cache");
+}
+
+bool FSpriteCache::Load(
+	const std::filesystem::path& JsonFilePath,
+	const UI::FConversationSettings& Settings,
+	std::vector<std::shared_ptr<FSprite>>& OutputSprites)
+{
+	IO::FMappedFile CacheFile;
+	if (!CacheFile.Open(GetCachePath(JsonFilePath)) || CacheFile.GetSize() < sizeof(FHeader))
+	{
+		return false;
+	}
+
+	const uint8_t* File = CacheFile.GetData();
+	const size_t FileSize = CacheFile.GetSize();
+	FHeader Header;
+	std::memcpy(&Header, File, sizeof(FHeader));
+	if (std::memcmp(Header.Magic, CacheMagic, sizeof(CacheMagic)) != 0 ||
+		Header.Version != CacheVersion ||
+		Header.SettingsHash != HashSettings(Settings) ||
+		!FReader::IsInside(Header.DependencyTableOffset, static_cast<uint64_t>(Header.DependencyCount) * sizeof(FDependencyRecord), FileSize) ||
+		!FReader::IsInside(Header.SpriteTableOffset, static_cast<uint64_t>(Header.SpriteCount) * sizeof(FSpriteRecord), FileSize) ||
+		!FReader::IsInside(Header.StringPool.Offset, Header.StringPool.Size, FileSize) ||
+		!FReader::IsInside(Header.Data.Offset, Header.Data.Size, FileSize))
+	{
+		return false;
+	}
+
+	// the json may have been rewritten by the export or edited by hand
+	uint64_t JsonSize = 0;
+	uint64_t JsonHash = 0;
+	if (!HashFile(JsonFilePath, JsonSize, JsonHash) || JsonSize != Header.JsonSize || JsonHash != Header.JsonHash)
+	{
+		return false;
+	}
+
+	const FReader Reader{ File, FileSize, Header.StringPool, Header.Data };
+	for (uint32_t Index = 0; Index < Header.DependencyCount; ++Index)
+	{
+		FDependencyRecord Record;
+		std::memcpy(&Record, File + Header.DependencyTableOffset + Index * sizeof(FDependencyRecord), sizeof(FDependencyRecord));
+
+		std::filesystem::path Path;
+		uint64_t Size = 0;
+		int64_t WriteTime = 0;
+		if (!Reader.GetPath(Record.Path, Path))
+		{
+			return false;
+		}
+		GetFileStamp(Path, Size, WriteTime);
+		if (Size != Record.Size || WriteTime != Record.WriteTime)
+		{
+			return false;
+		}
+	}
+
+	std::vector<std::shared_ptr<FSprite>> Sprites;
+	Sprites.reserve(Header.SpriteCount);
+	for (uint32_t Index = 0; Index < Header.SpriteCount; ++Index)
+	{
+		FSpriteRecord Record;
+		std::memcpy(&Record, File + Header.SpriteTableOffset + Index * sizeof(FSpriteRecord), sizeof(FSpriteRecord));
+
+		std::shared_ptr<FSprite> Sprite = std::make_shared<FSprite>();
+		Sprite->ZXColorView = std::make_shared<UI::FZXColorView>();
+		Sprite->Width = Record.Width;
+		Sprite->Height = Record.Height;
+		Sprite->SpritePositionToImageX = Record.PositionX;
+		Sprite->SpritePositionToImageY = Record.PositionY;
+		Sprite->AsepriteIndex = Record.AsepriteIndex;
+
+		std::string Regions;
+		if (!Reader.GetString(Record.Name, Sprite->Name) ||
+			!Reader.GetPath(Record.SourcePathFile, Sprite->SourcePathFile) ||
+			!Reader.GetString(Record.InkLayer, Sprite->InkLayer) ||
+			!Reader.GetString(Record.AttributeLayer, Sprite->AttributeLayer) ||
+			!Reader.GetString(Record.MaskLayer, Sprite->MaskLayer) ||
+			!Reader.GetString(Record.Regions, Regions) ||
+			!Reader.GetBlob(Record.IndexedData, Sprite->ZXColorView->IndexedData) ||
+			!Reader.GetBlob(Record.InkData, Sprite->ZXColorView->InkData) ||
+			!Reader.GetBlob(Record.AttributeData, Sprite->ZXColorView->AttributeData) ||
+			!Reader.GetBlob(Record.MaskData, Sprite->ZXColorView->MaskData))
+		{
+			return false;
+		}
+
+		if (!Regions.empty())
+		{
+			try
+			{
+				Sprite->Regions = nlohmann::ordered_json::parse(Regions);
+			}
+			catch (...)
+			{
+				return false;
+			}
+		}
+		Sprites.push_back(std::move(Sprite));
+	}
+
+	OutputSprites = std::move(Sprites);
+	return true;
+}
+
+bool FSpriteCache::Save(
+	const std::filesystem::path& JsonFilePath,
+	const UI::FConversationSettings& Settings,
+	const std::vector<std::shared_ptr<FSprite>>& Sprites,
+	const std::vector<std::filesystem::path>& Dependencies)
+{
+	FHeader Header = {};
+	std::memcpy(Header.Magic, CacheMagic, sizeof(CacheMagic));
+	Header.Version = CacheVersion;
+	Header.SettingsHash = HashSettings(Settings);
+	if (!HashFile(JsonFilePath, Header.JsonSize, Header.JsonHash))
+	{
+		return false;
+	}
+
+	FWriter Writer;
+	std::vector<FDependencyRecord> DependencyRecords;
+	{
+		std::vector<std::wstring> Paths;
+		Paths.reserve(Dependencies.size());
+		for (const std::filesystem::path& Path : Dependencies)
+		{
+			if (!Path.empty())
+			{
+				Paths.push_back(Path.wstring());
+			}
+		}
+		std::sort(Paths.begin(), Paths.end());
+		Paths.erase(std::unique(Paths.begin(), Paths.end()), Paths.end());
+
+		DependencyRecords.reserve(Paths.size());
+		for (const std::wstring& Path : Paths)
+		{
+			FDependencyRecord& Record = DependencyRecords.emplace_back();
+			Record.Path = Writer.AddString(Utils::Utf16ToUtf8(Path));
+			GetFileStamp(Path, Record.Size, Record.WriteTime);
+		}
+	}
+
+	std::vector<FSpriteRecord> SpriteRecords;
+	SpriteRecords.reserve(Sprites.size());
+	for (const std::shared_ptr<FSprite>& Sprite : Sprites)
+	{
+		FSpriteRecord& Record = SpriteRecords.emplace_back();
+		Record.Name = Writer.AddString(Sprite->Name);
+		Record.SourcePathFile = Writer.AddString(Utils::Utf16ToUtf8(Sprite->SourcePathFile.wstring()));
+		Record.InkLayer = Writer.AddString(Sprite->InkLayer);
+		Record.AttributeLayer = Writer.AddString(Sprite->AttributeLayer);
+		Record.MaskLayer = Writer.AddString(Sprite->MaskLayer);
+		Record.Regions = Writer.AddString(Sprite->Regions.empty() ? std::string() : nlohmann::ordered_json(Sprite->Regions).dump());
+		Record.Width = Sprite->Width;
+		Record.Height = Sprite->Height;
+		Record.PositionX = Sprite->SpritePositionToImageX;
+		Record.PositionY = Sprite->SpritePositionToImageY;
+		Record.AsepriteIndex = Sprite->AsepriteIndex;
+		Record.IndexedData = Writer.AddBlob(Sprite->ZXColorView->IndexedData);
+		Record.InkData = Writer.AddBlob(Sprite->ZXColorView->InkData);
+		Record.AttributeData = Writer.AddBlob(Sprite->ZXColorView->AttributeData);
+		Record.MaskData = Writer.AddBlob(Sprite->ZXColorView->MaskData);
+	}
+
+	Header.DependencyCount = static_cast<uint32_t>(DependencyRecords.size());
+	Header.SpriteCount = static_cast<uint32_t>(SpriteRecords.size());
+	Header.DependencyTableOffset = sizeof(FHeader);
+	Header.SpriteTableOffset = Header.DependencyTableOffset + DependencyRecords.size() * sizeof(FDependencyRecord);
+	Header.StringPool = { Header.SpriteTableOffset + SpriteRecords.size() * sizeof(FSpriteRecord), Writer.StringPool.size() };
+	Header.Data = { Header.StringPool.Offset + Header.StringPool.Size, Writer.Data.size() };
+
+	// written aside and renamed, a reader never sees a half-written cache
+	std::lock_guard Lock(SaveMutex);
+	const std::filesystem::path CachePath = GetCachePath(JsonFilePath);
+	std::filesystem::path TemporaryPath = CachePath;
+	TemporaryPath += ".tmp";
+	{
+		std::ofstream CacheFile(TemporaryPath, std::ios::binary | std::ios::trunc);
+		if (!CacheFile.is_open())
+		{
+			return false;
+		}
+		CacheFile.write(reinterpret_cast<const char*>(&Header), sizeof(FHeader));
+		CacheFile.write(reinterpret_cast<const char*>(DependencyRecords.data()), DependencyRecords.size() * sizeof(FDependencyRecord));
+		CacheFile.write(reinterpret_cast<const char*>(SpriteRecords.data()), SpriteRecords.size() * sizeof(FSpriteRecord));
+		CacheFile.write(reinterpret_cast<const char*>(Writer.StringPool.data()), Writer.StringPool.size());
+		CacheFile.write(reinterpret_cast<const char*>(Writer.Data.data()), Writer.Data.size());
+		if (!CacheFile)
+		{
+			return false;
+		}
+	}
+
+	std::error_code ec;
+	std::filesystem::rename(TemporaryPath, CachePath, ec);
+	if (ec)
+	{
+		LOG_ERROR("[{}]\t Failed to write '{}': {}.", (__FUNCTION__), CachePath.string(), ec.message());
+		std::filesystem::remove(TemporaryPath, ec);
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <CoreMinimal.h>
+
+struct FSprite;
+namespace UI { struct FConversationSettings; }
+
+// binary cache of an imported sprite list, written next to the json as <name>.cache
+//
+// header, dependency table, sprite table, string pool and data blob follow each other,
+// the tables are fixed-size records with offsets into the pool and the blob, so the file is read straight from a mapping.
+// the cache is valid while the json has the same contents, the conversion settings are the same and every file the import
+// depends on (source images, exported images, *.ink/*.attr/*.mask, atlas blobs) keeps its size and write time,
+// otherwise the json is parsed again
+class FSpriteCache
+{
+public:
+	static std::filesystem::path GetCachePath(const std::filesystem::path& JsonFilePath);
+
+	// sprites come without device resources, returns false if the cache is missing, outdated or damaged
+	static bool Load(
+		const std::filesystem::path& JsonFilePath,
+		const UI::FConversationSettings& Settings,
+		std::vector<std::shared_ptr<FSprite>>& OutputSprites);
+	static bool Save(
+		const std::filesystem::path& JsonFilePath,
+		const UI::FConversationSettings& Settings,
+		const std::vector<std::shared_ptr<FSprite>>& Sprites,
+		const std::vector<std::filesystem::path>& Dependencies);
+};
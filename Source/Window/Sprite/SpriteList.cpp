@@ -9,8 +9,10 @@
 #include <AppSprite.h>
 #include <Window/Sprite/Events.h>
 #include <Utils/Aseprite/Format.h>
+#include <Utils/6912/SpriteCompiler.h>
 #include <Core/Image.h>
 #include "Canvas.h"
+#include "SpriteCache.h"
 
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include "stb/stb_image_write.h"
@@ -23,6 +25,14 @@ namespace
 	const char* ExportToName = "Export##ExportTo";
 	static const char* PopupMenuName = TEXT("##PopupMenu");
 
+	// the sprites are converted with them on import and repair, the cache of an import is valid only for them
+	static const UI::FConversationSettings ImportConversionSettings
+	{
+		.InkAlways = EZXColor::Black_,
+		.TransparentIndex = EZXColor::Transparent,
+		.ReplaceTransparent = EZXColor::Black,
+	};
+
 	static constexpr ImVec2 VisibleSizeArray[] =
 	{
 		ImVec2(16.0f, 16.0f),
@@ -50,11 +60,14 @@ SSpriteList::SSpriteList(EFont::Type _FontName, std::string _DockSlot /*= ""*/)
 	, ScaleVisible(2)
 	, IndexSelectedSprite(INDEX_NONE)
 	, IndexRenameSprite(INDEX_NONE)
+	, bThumbnailAtlasDirty(false)
 	, bNeedOpenImportRepairPopup(false)
 	, bUniqueExportFilename(false)
 	, bExportInk(true)
 	, bExportAttribute(true)
 	, bExportMask(true)
+	, bExportCompiledSprite(false)
+	, bExportAtlas(true)
 	, IndexSelectedScript(INDEX_NONE)
 {}
 
@@ -106,21 +119,7 @@ void SSpriteList::NativeInitialize(const FNativeDataInitialize& Data)
 	SubscribeEvent<FEvent_ImportJSON>(
 		[this](const FEvent_ImportJSON& Event)
 		{
-			if (HasMissingImportData(Event.FilePath))
-			{
-				PendingImportFilePath = Event.FilePath;
-				ImportRepairOptions = {};
-				bNeedOpenImportRepairPopup = true;
-				return;
-			}
-
-			std::vector<std::shared_ptr<FSprite>> ReadSprites;
-			if (ImportSprites(Event.FilePath, ReadSprites))
-			{
-				CurrentPath = Event.FilePath.parent_path();
-
-				ApplyImportSprites(ReadSprites);
-			}
+			StartImportJob(Event.FilePath, false);
 		});
 	SubscribeEvent<FEvent_Sprite>(
 		[this](const FEvent_Sprite& Event)
@@ -177,6 +176,14 @@ void SSpriteList::Render()
 		return;
 	}
 
+	// the previous frame has been presented by now
+	for (const std::shared_ptr<UI::FZXColorView>& Page : RetiredThumbnailPages)
+	{
+		Page->Image.Release();
+		UI::Draw_ZXColorView_Shutdown(Page);
+	}
+	RetiredThumbnailPages.clear();
+
 	ImGui::Begin(GetWindowName().c_str(), &bOpen);
 
 	PopupMenu_EditMetadataID = ImGui::GetCurrentWindow()->GetID(PopupMenuName);
@@ -227,6 +234,13 @@ void SSpriteList::Render()
 			ImGui::SameLine();
 		}
 
+		// progress of the background import
+		if (ImportJob.IsValid())
+		{
+			ImGui::ProgressBar(ImportJob.GetProgress(), ImVec2(120.0f, 0.0f), "Importing...");
+			ImGui::SameLine();
+		}
+
 		// draw current scale
 		{
 			ImGui::PushStyleColor(ImGuiCol_Text, COL_CONST(UI::COLOR_WEAK));
@@ -266,6 +280,20 @@ void SSpriteList::Render()
 void SSpriteList::Destroy()
 {
 	UnsubscribeAll();
+
+	// the completion sees the cancel and doesn't touch the window
+	ImportJob.Cancel();
+	ImportJob.Wait();
+	ImportJob.Reset();
+
+	RetiredThumbnailPages.insert(RetiredThumbnailPages.end(), ThumbnailPages.begin(), ThumbnailPages.end());
+	ThumbnailPages.clear();
+	for (const std::shared_ptr<UI::FZXColorView>& Page : RetiredThumbnailPages)
+	{
+		Page->Image.Release();
+		UI::Draw_ZXColorView_Shutdown(Page);
+	}
+	RetiredThumbnailPages.clear();
 }
 
 void SSpriteList::Input_HotKeys()
@@ -318,6 +346,7 @@ void SSpriteList::Imput_Delete()
 		return;
 	}
 	Sprites.erase(Sprites.begin() + IndexSelectedSprite);
+	bThumbnailAtlasDirty = true;
 
 	if (Sprites.empty())
 	{
@@ -329,6 +358,7 @@ void SSpriteList::ClearSprites()
 {
 	Sprites.clear();
 	EditingSprites.clear();
+	bThumbnailAtlasDirty = true;
 	IndexSelectedSprite = INDEX_NONE;
 	IndexRenameSprite = INDEX_NONE;
 
@@ -343,6 +373,11 @@ void SSpriteList::Draw_SpriteList()
 	ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(1.0f, 1.0f));
 	ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2(2.0f, 2.0f));
 
+	if (bThumbnailAtlasDirty)
+	{
+		RebuildThumbnailAtlas();
+	}
+
 	const ImGuiStyle& Style = ImGui::GetStyle();
 	const ImVec2 VisibleSize = VisibleSizeArray[ScaleVisible];
 	const float WindowVisible_x2 = ImGui::GetWindowPos().x + ImGui::GetWindowContentRegionMax().x;
@@ -523,6 +558,8 @@ void SSpriteList::Draw_ExportSprites()
 	ImGui::Checkbox("*.ink", &bExportInk);
 	ImGui::Checkbox("*.attr", &bExportAttribute);
 	ImGui::Checkbox("*.mask", &bExportMask);
+	ImGui::Checkbox("*.asm (compiled, 8 shifts)", &bExportCompiledSprite);
+	ImGui::Checkbox("pack into atlas pages", &bExportAtlas);
 	ImGui::Dummy(ImVec2(0.0f, TextHeight * 0.5f));
 	if (ImGui::ButtonEx("OK", ImVec2(TextWidth * 11.0f, TextHeight * 1.5f)))
 	{
@@ -622,8 +659,6 @@ void SSpriteList::AddSprite(
 		}
 
 		const int32_t Size = NewSprite->Width * NewSprite->Height;
-		std::vector<uint32_t> RGBA(Size);
-
 		std::vector<uint8_t>& NewIndexedData = NewSprite->ZXColorView->IndexedData;
 		NewIndexedData.resize(Size);
 
@@ -708,15 +743,9 @@ void SSpriteList::AddSprite(
 				const int8_t Color = ((Mask << dx) & 0x80) ? UI::EZXSpectrumColor::Transparent : ColorInk;
 				NewIndexedData[Index] = Color;
 
-				const ImU32 ColorRGBA = UI::ToU32(UI::ZXSpectrumColorRGBA[Color]);
-				RGBA[Index] = ColorRGBA;
-
 				++Index;
 			}
 		}
-
-		FImageBase& Images = FImageBase::Get();
-		NewSprite->ZXColorView->Image = Images.CreateTexture(RGBA.data(), NewSprite->Width, NewSprite->Height, D3D11_CPU_ACCESS_WRITE, D3D11_USAGE_DYNAMIC);
 	}
 	
 	NewSprite->ZXColorView->Device = Data.Device;
@@ -724,6 +753,7 @@ void SSpriteList::AddSprite(
 	Draw_ZXColorView_Initialize(NewSprite->ZXColorView, UI::ERenderType::Sprite);
 
 	Sprites.push_back(NewSprite);
+	bThumbnailAtlasDirty = true;
 }
 
 std::vector<std::shared_ptr<FSprite>> SSpriteList::UpdateSprite(
@@ -852,8 +882,7 @@ std::vector<std::shared_ptr<FSprite>> SSpriteList::UpdateSprite(
 			}
 		}
 
-		FImageBase& Images = FImageBase::Get();
-		Images.UpdateTexture(Sprite->ZXColorView->Image.Handle, RGBA.data());
+		UpdateThumbnail(Sprite, RGBA);
 
 		UpdatedSprites.push_back(Sprite);
 	}
@@ -897,7 +926,11 @@ bool SSpriteList::HasMissingImportData(const std::filesystem::path& FilePath) co
 
 	for (const auto& SpriteJson : Json)
 	{
-		const std::filesystem::path PNGFile = ImportPath / FromUtf8(SpriteJson.value("SprName", std::string{})).concat(L".png");
+		// packed sprites have a page of the atlas instead of their own image
+		const nlohmann::ordered_json AtlasJson = SpriteJson.value("Atlas", nlohmann::ordered_json::object());
+		const std::filesystem::path PNGFile = AtlasJson.contains("Image")
+			? ResolvePath(FromUtf8(AtlasJson.value("Image", std::string{})))
+			: ImportPath / FromUtf8(SpriteJson.value("SprName", std::string{})).concat(L".png");
 		if (!std::filesystem::exists(PNGFile))
 		{
 			return true;
@@ -956,9 +989,16 @@ bool SSpriteList::RepairImportData(const std::filesystem::path& FilePath, const
 	{
 		int32_t Width = 0;
 		int32_t Height = 0;
-		std::vector<std::vector<uint8_t>> Frames;
+		int32_t FrameCount = 0;
+		std::shared_ptr<const std::vector<uint8_t>> Image;
+		std::shared_ptr<AsepriteFormat::FSprite> Aseprite;
 		bool bLoaded = false;
 		bool bValid = false;
+
+		std::shared_ptr<const std::vector<uint8_t>> GetFrame(int32_t Frame) const
+		{
+			return Aseprite ? AsepriteFormat::GetFrameRGBA(*Aseprite, Frame) : Image;
+		}
 	};
 
 	const std::filesystem::path ImportPath = FilePath.parent_path();
@@ -982,19 +1022,20 @@ bool SSpriteList::RepairImportData(const std::filesystem::path& FilePath, const
 				uint8_t* ImageData = FImageBase::LoadToMemory(SourcePath, Source.Width, Source.Height);
 				if (ImageData != nullptr && Source.Width > 0 && Source.Height > 0)
 				{
-					Source.Frames.emplace_back(ImageData, ImageData + static_cast<size_t>(Source.Width) * Source.Height * 4);
+					Source.Image = std::make_shared<const std::vector<uint8_t>>(ImageData, ImageData + static_cast<size_t>(Source.Width) * Source.Height * 4);
+					Source.FrameCount = 1;
 					Source.bValid = true;
 				}
 				FImageBase::ReleaseLoadedIntoMemory(ImageData);
 			}
 			else if (Format == EImageFormat::Aseprite)
 			{
-				AsepriteFormat::FSprite Aseprite;
-				if (AsepriteFormat::Load(SourcePath, Aseprite) && !Aseprite.Frames.empty())
+				Source.Aseprite = std::make_shared<AsepriteFormat::FSprite>();
+				if (AsepriteFormat::Load(SourcePath, *Source.Aseprite) && Source.Aseprite->FrameCount > 0)
 				{
-					Source.Width = Aseprite.Width;
-					Source.Height = Aseprite.Height;
-					Source.Frames = std::move(Aseprite.Frames);
+					Source.Width = Source.Aseprite->Width;
+					Source.Height = Source.Aseprite->Height;
+					Source.FrameCount = Source.Aseprite->FrameCount;
 					Source.bValid = true;
 				}
 			}
@@ -1012,13 +1053,15 @@ bool SSpriteList::RepairImportData(const std::filesystem::path& FilePath, const
 		const int32_t PositionY = SpriteJson.value("PoxImgY", 0);
 		const int32_t FrameIndex = SpriteJson.value("AsepriteIndex", INDEX_NONE);
 
+		const nlohmann::ordered_json AtlasJson = SpriteJson.value("Atlas", nlohmann::ordered_json::object());
+		const std::filesystem::path AtlasPNGFile = ResolvePath(FromUtf8(AtlasJson.value("Image", std::string{})));
 		const std::filesystem::path PNGFile = ImportPath / FromUtf8(SpriteName).concat(L".png");
 		auto DataIsMissing = [&SpriteJson, &FromUtf8, &ResolvePath](const char* Field)
 			{
 				const std::filesystem::path DataFile = FromUtf8(SpriteJson.value(Field, std::string{}));
 				return DataFile.empty() || !std::filesystem::exists(ResolvePath(DataFile));
 			};
-		const bool bNeedPNG = Options.bPNG && !std::filesystem::exists(PNGFile);
+		const bool bNeedPNG = Options.bPNG && !std::filesystem::exists(AtlasJson.contains("Image") ? AtlasPNGFile : PNGFile);
 		const bool bNeedInk = Options.bInk && DataIsMissing("InkData");
 		const bool bNeedAttribute = Options.bAttribute && DataIsMissing("AttributeData");
 		const bool bNeedMask = Options.bMask && DataIsMissing("MaskData");
@@ -1029,11 +1072,14 @@ bool SSpriteList::RepairImportData(const std::filesystem::path& FilePath, const
 
 		const std::filesystem::path SourcePath = ResolvePath(FromUtf8(SpriteJson.value("FileImg", std::string{})));
 		FSourceImage& Source = LoadSourceImage(SourcePath);
-		const int32_t EffectiveFrame = FrameIndex >= 0 && FrameIndex < static_cast<int32_t>(Source.Frames.size()) ? FrameIndex : 0;
-		if (!Source.bValid || EffectiveFrame >= static_cast<int32_t>(Source.Frames.size()) ||
+		const int32_t EffectiveFrame = FrameIndex >= 0 && FrameIndex < Source.FrameCount ? FrameIndex : 0;
+		const std::shared_ptr<const std::vector<uint8_t>> SourceFrame = Source.bValid && EffectiveFrame < Source.FrameCount
+			? Source.GetFrame(EffectiveFrame)
+			: nullptr;
+		if (!SourceFrame ||
 			Width <= 0 || Height <= 0 || PositionX < 0 || PositionY < 0 ||
 			PositionX + Width > Source.Width || PositionY + Height > Source.Height ||
-			Source.Frames[EffectiveFrame].size() < static_cast<size_t>(Source.Width) * Source.Height * 4)
+			SourceFrame->size() < static_cast<size_t>(Source.Width) * Source.Height * 4)
 		{
 			LOG_ERROR("[{}]\t Cannot restore sprite '{}' from '{}'.", (__FUNCTION__), SpriteName, SourcePath.string());
 			bAllSucceeded = false;
@@ -1041,7 +1087,7 @@ bool SSpriteList::RepairImportData(const std::filesystem::path& FilePath, const
 		}
 
 		std::vector<uint8_t> CroppedRGBA(static_cast<size_t>(Width) * Height * 4);
-		const std::vector<uint8_t>& SourceRGBA = Source.Frames[EffectiveFrame];
+		const std::vector<uint8_t>& SourceRGBA = *SourceFrame;
 		for (int32_t Y = 0; Y < Height; ++Y)
 		{
 			const size_t SourceOffset = (static_cast<size_t>(PositionY + Y) * Source.Width + PositionX) * 4;
@@ -1054,6 +1100,12 @@ bool SSpriteList::RepairImportData(const std::filesystem::path& FilePath, const
 			LOG_ERROR("[{}]\t Failed to restore '{}'.", (__FUNCTION__), PNGFile.string());
 			bAllSucceeded = false;
 		}
+		else if (bNeedPNG && SpriteJson.contains("Atlas"))
+		{
+			// the sprite is restored into its own files, the missing page isn't used anymore
+			SpriteJson["Atlas"].erase("Image");
+			bJsonChanged = true;
+		}
 
 		if (bNeedInk || bNeedAttribute || bNeedMask)
 		{
@@ -1062,15 +1114,10 @@ bool SSpriteList::RepairImportData(const std::filesystem::path& FilePath, const
 			std::vector<uint8_t> AttributeData;
 			std::vector<uint8_t> MaskData;
 			UI::QuantizeToZX(CroppedRGBA.data(), Width, Height, 4, IndexedData, UI::ToU32(COLOR(0, 0, 0, 0)));
-			const UI::FConversationSettings Settings
-			{
-				.InkAlways = EZXColor::Black_,
-				.TransparentIndex = EZXColor::Transparent,
-				.ReplaceTransparent = EZXColor::Black,
-			};
+			const UI::FConversationSettings& Settings = ImportConversionSettings;
 			UI::ZXIndexColorToZXAttributeColor(IndexedData, Width, Height, InkData, AttributeData, MaskData, Settings);
 
-			auto SaveData = [&](const char* Field, const wchar_t* Extension, const std::vector<uint8_t>& Data)
+			auto SaveData = [&](const char* Field, const char* OffsetField, const wchar_t* Extension, const std::vector<uint8_t>& Data)
 				{
 					const std::filesystem::path DataFile = IO::NormalizePath(std::filesystem::absolute(ImportPath / FromUtf8(SpriteName).concat(Extension)));
 					const std::error_code Error = IO::SaveBinaryData(Data, DataFile, false);
@@ -1081,11 +1128,15 @@ bool SSpriteList::RepairImportData(const std::filesystem::path& FilePath, const
 						return;
 					}
 					SpriteJson[Field] = ToUtf8(DataFile.wstring());
+					if (SpriteJson.contains("Atlas"))
+					{
+						SpriteJson["Atlas"].erase(OffsetField);
+					}
 					bJsonChanged = true;
 				};
-			if (bNeedInk) SaveData("InkData", L".ink", InkData);
-			if (bNeedAttribute) SaveData("AttributeData", L".attr", AttributeData);
-			if (bNeedMask) SaveData("MaskData", L".mask", MaskData);
+			if (bNeedInk) SaveData("InkData", "InkOffset", L".ink", InkData);
+			if (bNeedAttribute) SaveData("AttributeData", "AttributeOffset", L".attr", AttributeData);
+			if (bNeedMask) SaveData("MaskData", "MaskOffset", L".mask", MaskData);
 		}
 	}
 
@@ -1127,13 +1178,7 @@ void SSpriteList::Draw_ImportRepair()
 
 	if (ImGui::Button("Import", ImVec2(100.0f, 0.0f)))
 	{
-		RepairImportData(PendingImportFilePath, ImportRepairOptions);
-		std::vector<std::shared_ptr<FSprite>> ReadSprites;
-		if (ImportSprites(PendingImportFilePath, ReadSprites))
-		{
-			CurrentPath = PendingImportFilePath.parent_path();
-			ApplyImportSprites(ReadSprites);
-		}
+		StartImportJob(PendingImportFilePath, true);
 		PendingImportFilePath.clear();
 		ImGui::CloseCurrentPopup();
 	}
@@ -1146,7 +1191,69 @@ void SSpriteList::Draw_ImportRepair()
 	ImGui::EndPopup();
 }
 
-bool SSpriteList::ImportSprites(const std::filesystem::path& FilePath, std::vector<std::shared_ptr<FSprite>>& OutputSprites)
+void SSpriteList::StartImportJob(const std::filesystem::path& FilePath, bool bRepair)
+{
+	struct FImportResult
+	{
+		bool bSuccess = false;
+		bool bMissingData = false;
+		std::vector<std::shared_ptr<FSprite>> Sprites;
+	};
+
+	// a newer import replaces the running one
+	ImportJob.Cancel();
+
+	const std::shared_ptr<FImportResult> Result = std::make_shared<FImportResult>();
+	const FImportRepairOptions RepairOptions = ImportRepairOptions;
+	ImportJob = FJobSystem::Get().Submit("Import sprites",
+		[this, FilePath, bRepair, RepairOptions, Result](FJobContext& Context)
+		{
+			if (bRepair)
+			{
+				RepairImportData(FilePath, RepairOptions);
+			}
+			// a valid cache was written from complete data, the json isn't parsed at all then
+			else if (FSpriteCache::Load(FilePath, ImportConversionSettings, Result->Sprites))
+			{
+				Result->bSuccess = true;
+				return;
+			}
+			else if (HasMissingImportData(FilePath))
+			{
+				Result->bMissingData = true;
+				return;
+			}
+			Result->bSuccess = ImportSprites(FilePath, Result->Sprites, &Context);
+		},
+		[this, FilePath, Result](const FJobHandle& Job)
+		{
+			if (Job.IsCancelRequested())
+			{
+				return;
+			}
+			ImportJob.Reset();
+
+			if (Result->bMissingData)
+			{
+				PendingImportFilePath = FilePath;
+				ImportRepairOptions = {};
+				bNeedOpenImportRepairPopup = true;
+				return;
+			}
+
+			if (Job.GetStatus() == EJobStatus::Completed && Result->bSuccess)
+			{
+				for (const std::shared_ptr<FSprite>& Sprite : Result->Sprites)
+				{
+					InitializeImportedSprite(Sprite);
+				}
+				CurrentPath = FilePath.parent_path();
+				ApplyImportSprites(Result->Sprites);
+			}
+		});
+}
+
+bool SSpriteList::ImportSprites(const std::filesystem::path& FilePath, std::vector<std::shared_ptr<FSprite>>& OutputSprites, FJobContext* Job /*= nullptr*/) const
 {
 	nlohmann::ordered_json Json;
 	std::ifstream JsonFile(FilePath, std::ios::binary);
@@ -1183,13 +1290,21 @@ bool SSpriteList::ImportSprites(const std::filesystem::path& FilePath, std::vect
 	{
 		int32_t Width = 0;
 		int32_t Height = 0;
-		std::vector<std::vector<uint8_t>> Frames;
+		int32_t FrameCount = 0;
+		std::shared_ptr<const std::vector<uint8_t>> Image;
 		std::shared_ptr<AsepriteFormat::FSprite> Aseprite;
 		bool bLoaded = false;
 		bool bValid = false;
+
+		std::shared_ptr<const std::vector<uint8_t>> GetFrame(int32_t Frame) const
+		{
+			return Aseprite ? AsepriteFormat::GetFrameRGBA(*Aseprite, Frame) : Image;
+		}
 	};
+	// every file the import reads, the cache is valid while none of them changes
+	std::vector<std::filesystem::path> Dependencies;
 	std::unordered_map<std::wstring, FSourceImage> SourceImages;
-	auto LoadSourceImage = [&SourceImages](const std::filesystem::path& SourcePath) -> FSourceImage&
+	auto LoadSourceImage = [&SourceImages, &Dependencies](const std::filesystem::path& SourcePath) -> FSourceImage&
 		{
 			FSourceImage& Source = SourceImages[SourcePath.wstring()];
 			if (Source.bLoaded)
@@ -1197,6 +1312,7 @@ bool SSpriteList::ImportSprites(const std::filesystem::path& FilePath, std::vect
 				return Source;
 			}
 			Source.bLoaded = true;
+			Dependencies.push_back(SourcePath);
 
 			const EImageFormat Format = FAppSprite::SupportImageFormat(SourcePath);
 			if (Format == EImageFormat::PNG)
@@ -1204,7 +1320,8 @@ bool SSpriteList::ImportSprites(const std::filesystem::path& FilePath, std::vect
 				uint8_t* ImageData = FImageBase::LoadToMemory(SourcePath, Source.Width, Source.Height);
 				if (ImageData != nullptr && Source.Width > 0 && Source.Height > 0)
 				{
-					Source.Frames.emplace_back(ImageData, ImageData + static_cast<size_t>(Source.Width) * Source.Height * 4);
+					Source.Image = std::make_shared<const std::vector<uint8_t>>(ImageData, ImageData + static_cast<size_t>(Source.Width) * Source.Height * 4);
+					Source.FrameCount = 1;
 					Source.bValid = true;
 				}
 				FImageBase::ReleaseLoadedIntoMemory(ImageData);
@@ -1212,28 +1329,44 @@ bool SSpriteList::ImportSprites(const std::filesystem::path& FilePath, std::vect
 			else if (Format == EImageFormat::Aseprite)
 			{
 				Source.Aseprite = std::make_shared<AsepriteFormat::FSprite>();
-				if (AsepriteFormat::Load(SourcePath, *Source.Aseprite) && !Source.Aseprite->Frames.empty())
+				if (AsepriteFormat::Load(SourcePath, *Source.Aseprite) && Source.Aseprite->FrameCount > 0)
 				{
 					Source.Width = Source.Aseprite->Width;
 					Source.Height = Source.Aseprite->Height;
-					Source.Frames = Source.Aseprite->Frames;
+					Source.FrameCount = Source.Aseprite->FrameCount;
 					Source.bValid = true;
 				}
 			}
 			return Source;
 		};
+	// ink/attribute/mask blobs of the atlas pages are shared by all the packed sprites
+	std::unordered_map<std::wstring, std::vector<uint8_t>> AtlasBlobs;
+	auto LoadAtlasBlob = [&AtlasBlobs](const std::filesystem::path& BlobPath) -> const std::vector<uint8_t>&
+		{
+			auto [It, bInserted] = AtlasBlobs.try_emplace(BlobPath.wstring());
+			if (bInserted)
+			{
+				IO::LoadBinaryData(It->second, BlobPath);
+			}
+			return It->second;
+		};
+	const int32_t SpriteCount = int32_t(Json.size());
 	for (const auto& SpriteJson : Json)
 	{
+		if (Job != nullptr)
+		{
+			if (Job->IsCancelled())
+			{
+				return false;
+			}
+			Job->SetProgress(int32_t(OutputSprites.size()), SpriteCount);
+		}
+
 		std::shared_ptr<FSprite> NewSprite = std::make_shared<FSprite>();
 		NewSprite->bSelected = false;
 		NewSprite->HoverStartTime = -1.0;
 
 		NewSprite->ZXColorView = std::make_shared<UI::FZXColorView>();
-		NewSprite->ZXColorView->Scale = ImVec2(1.0f, 1.0f);
-		NewSprite->ZXColorView->ImagePosition = ImVec2(0.0f, 0.0f);
-		NewSprite->ZXColorView->Device = Data.Device;
-		NewSprite->ZXColorView->DeviceContext = Data.DeviceContext;
-		Draw_ZXColorView_Initialize(NewSprite->ZXColorView, UI::ERenderType::Sprite);
 
 		// main parameters
 		NewSprite->Name = SpriteJson.value("SprName", "");
@@ -1256,20 +1389,22 @@ bool SSpriteList::ImportSprites(const std::filesystem::path& FilePath, std::vect
 		}
 
 		const int32_t EffectiveFrame = NewSprite->AsepriteIndex >= 0 &&
-			NewSprite->AsepriteIndex < static_cast<int32_t>(Source.Frames.size())
+			NewSprite->AsepriteIndex < Source.FrameCount
 			? NewSprite->AsepriteIndex
 			: 0;
-		const bool bCanConvertSource = Source.bValid &&
-			EffectiveFrame < static_cast<int32_t>(Source.Frames.size()) &&
+		const std::shared_ptr<const std::vector<uint8_t>> SourceFrame = Source.bValid && EffectiveFrame < Source.FrameCount
+			? Source.GetFrame(EffectiveFrame)
+			: nullptr;
+		const bool bCanConvertSource = SourceFrame &&
 			NewSprite->Width > 0 && NewSprite->Height > 0 &&
 			NewSprite->Width % 8 == 0 && NewSprite->Height % 8 == 0 &&
 			NewSprite->SpritePositionToImageX + NewSprite->Width <= static_cast<uint32_t>(Source.Width) &&
 			NewSprite->SpritePositionToImageY + NewSprite->Height <= static_cast<uint32_t>(Source.Height) &&
-			Source.Frames[EffectiveFrame].size() >= static_cast<size_t>(Source.Width) * Source.Height * 4;
+			SourceFrame->size() >= static_cast<size_t>(Source.Width) * Source.Height * 4;
 		if (bCanConvertSource)
 		{
 			std::vector<uint8_t> CroppedRGBA(static_cast<size_t>(NewSprite->Width) * NewSprite->Height * 4);
-			const std::vector<uint8_t>& SourceRGBA = Source.Frames[EffectiveFrame];
+			const std::vector<uint8_t>& SourceRGBA = *SourceFrame;
 			for (uint32_t Y = 0; Y < NewSprite->Height; ++Y)
 			{
 				const size_t SourceOffset = (static_cast<size_t>(NewSprite->SpritePositionToImageY + Y) * Source.Width + NewSprite->SpritePositionToImageX) * 4;
@@ -1278,12 +1413,7 @@ bool SSpriteList::ImportSprites(const std::filesystem::path& FilePath, std::vect
 			}
 
 			UI::QuantizeToZX(CroppedRGBA.data(), NewSprite->Width, NewSprite->Height, 4, NewSprite->ZXColorView->IndexedData, UI::ToU32(COLOR(0, 0, 0, 0)));
-			const UI::FConversationSettings Settings
-			{
-				.InkAlways = EZXColor::Black_,
-				.TransparentIndex = EZXColor::Transparent,
-				.ReplaceTransparent = EZXColor::Black,
-			};
+			const UI::FConversationSettings& Settings = ImportConversionSettings;
 			UI::ZXIndexColorToZXAttributeColor(
 				NewSprite->ZXColorView->IndexedData,
 				NewSprite->Width, NewSprite->Height,
@@ -1298,19 +1428,37 @@ bool SSpriteList::ImportSprites(const std::filesystem::path& FilePath, std::vect
 		std::filesystem::path AttributeDataFile = ResolvePath(FromUtf8(SpriteJson.value("AttributeData", "")));
 		std::filesystem::path MaskDataFile = ResolvePath(FromUtf8(SpriteJson.value("MaskData", "")));
 
-		// reading binary data
-		if (std::filesystem::exists(InkDataFile))
-		{
-			IO::LoadBinaryData(NewSprite->ZXColorView->InkData, InkDataFile);
-		}
-		if (std::filesystem::exists(AttributeDataFile))
-		{
-			IO::LoadBinaryData(NewSprite->ZXColorView->AttributeData, AttributeDataFile);
-		}
-		if (std::filesystem::exists(MaskDataFile))
-		{
-			IO::LoadBinaryData(NewSprite->ZXColorView->MaskData, MaskDataFile);
-		}
+		// reading binary data, packed sprites are cut out of the atlas blobs by the offset table
+		const nlohmann::ordered_json AtlasJson = SpriteJson.value("Atlas", nlohmann::ordered_json::object());
+
+		// the exported image isn't read, but the cache is dropped when it changes or goes missing, so the repair is offered
+		Dependencies.push_back(AtlasJson.contains("Image")
+			? ResolvePath(FromUtf8(AtlasJson.value("Image", std::string{})))
+			: ImportPath / (FromUtf8(NewSprite->Name) + L".png"));
+		auto LoadData = [&](const std::filesystem::path& DataFile, const char* OffsetField, uint32_t Rows, std::vector<uint8_t>& OutputData)
+			{
+				Dependencies.push_back(DataFile);
+				if (!std::filesystem::exists(DataFile))
+				{
+					return;
+				}
+				if (!AtlasJson.contains(OffsetField))
+				{
+					IO::LoadBinaryData(OutputData, DataFile);
+				}
+				else if (!FSpriteAtlas::ReadRows(
+					LoadAtlasBlob(DataFile),
+					AtlasJson[OffsetField].get<size_t>(),
+					AtlasJson.value("Stride", 0),
+					NewSprite->Width >> 3, Rows,
+					OutputData))
+				{
+					LOG_ERROR("[{}]\t Sprite '{}' is outside of the atlas '{}'.", (__FUNCTION__), NewSprite->Name, DataFile.string());
+				}
+			};
+		LoadData(InkDataFile, "InkOffset", NewSprite->Height, NewSprite->ZXColorView->InkData);
+		LoadData(AttributeDataFile, "AttributeOffset", NewSprite->Height >> 3, NewSprite->ZXColorView->AttributeData);
+		LoadData(MaskDataFile, "MaskOffset", NewSprite->Height, NewSprite->ZXColorView->MaskData);
 
 		if (Source.Aseprite && bCanConvertSource)
 		{
@@ -1337,12 +1485,7 @@ bool SSpriteList::ImportSprites(const std::filesystem::path& FilePath, std::vect
 					}
 					return true;
 				};
-			const UI::FConversationSettings Settings
-			{
-				.InkAlways = EZXColor::Black_,
-				.TransparentIndex = EZXColor::Transparent,
-				.ReplaceTransparent = EZXColor::Black,
-			};
+			const UI::FConversationSettings& Settings = ImportConversionSettings;
 			auto ConvertAttributeLayer = [&NewSprite, &Settings](
 				const std::vector<uint8_t>& RGBA,
 				std::vector<uint8_t>& OutputAttributeData)
@@ -1390,40 +1533,6 @@ bool SSpriteList::ImportSprites(const std::filesystem::path& FilePath, std::vect
 		if (SpriteJson.contains("Regions"))
 		{
 			NewSprite->Regions = SpriteJson["Regions"];
-
-			for (FSpriteMetaRegion& Region : NewSprite->Regions)
-			{
-				if (!Region.bHasRegionRect)
-				{
-					continue;
-				}
-
-				Region.ZXColorView = std::make_shared<UI::FZXColorView>();
-				Region.ZXColorView->bOnlyNearestSampling = true;
-				Region.ZXColorView->Device = Data.Device;
-				Region.ZXColorView->DeviceContext = Data.DeviceContext;
-				UI::Draw_ZXColorView_Initialize(Region.ZXColorView, UI::ERenderType::Sprite);
-				{
-					const int32_t Size = NewSprite->Width * NewSprite->Height;
-					std::vector<uint32_t> RGBA(Size, 0);
-
-					if (!Region.ZXColorView->Image.IsValid())
-					{
-						for (uint32_t y = (uint32_t)Region.Rect.Min.y; y < (uint32_t)Region.Rect.Max.y; ++y)
-						{
-							for (uint32_t x = (uint32_t)Region.Rect.Min.x; x < (uint32_t)Region.Rect.Max.x; ++x)
-							{
-								const int8_t Color = UI::EZXSpectrumColor::Black_;
-								const ImU32 ColorRGBA = UI::ToU32(UI::ZXSpectrumColorRGBA[Color]);
-
-								const uint32_t Index = y * NewSprite->Width + x;
-								RGBA[Index] = ColorRGBA;
-							}
-						}
-						Region.ZXColorView->Image = FImageBase::Get().CreateTexture(RGBA.data(), NewSprite->Width, NewSprite->Height, D3D11_CPU_ACCESS_READ, D3D11_USAGE_DEFAULT);
-					}
-				}
-			}
 		}
 		const size_t ExpectedPixelDataSize = static_cast<size_t>(NewSprite->Width >> 3) * NewSprite->Height;
 		const size_t ExpectedAttributeDataSize = static_cast<size_t>(NewSprite->Width >> 3) * (NewSprite->Height >> 3);
@@ -1431,13 +1540,15 @@ bool SSpriteList::ImportSprites(const std::filesystem::path& FilePath, std::vect
 		const uint8_t* InkData = bValidZXDimensions && NewSprite->ZXColorView->InkData.size() >= ExpectedPixelDataSize ? NewSprite->ZXColorView->InkData.data() : nullptr;
 		const uint8_t* AttributeData = bValidZXDimensions && NewSprite->ZXColorView->AttributeData.size() >= ExpectedAttributeDataSize ? NewSprite->ZXColorView->AttributeData.data() : nullptr;
 		const uint8_t* MaskData = bValidZXDimensions && NewSprite->ZXColorView->MaskData.size() >= ExpectedPixelDataSize ? NewSprite->ZXColorView->MaskData.data() : nullptr;
-		UI::ZXAttributeColorToImage(
-			NewSprite->ZXColorView->Image,
+		// only the index colors are needed, the thumbnail is drawn from the atlas of the sprite list
+		UI::FTextureStaging Staging;
+		UI::ZXAttributeColorToStaging(
+			Staging,
 			NewSprite->Width, NewSprite->Height,
 			InkData,
 			AttributeData,
 			MaskData,
-			true,
+			UI::FDirtyRect::Full(NewSprite->Width, NewSprite->Height),
 			&NewSprite->ZXColorView->IndexedData,
 			true /* ????????!!!!!!!*/,
 			false,
@@ -1445,9 +1556,60 @@ bool SSpriteList::ImportSprites(const std::filesystem::path& FilePath, std::vect
 		OutputSprites.push_back(NewSprite);
 	}
 
+	// a cancelled import has been replaced by a newer one, which writes the cache itself
+	if (Job != nullptr && Job->IsCancelled())
+	{
+		return false;
+	}
+	FSpriteCache::Save(FilePath, ImportConversionSettings, OutputSprites, Dependencies);
 	return true;
 }
 
+void SSpriteList::InitializeImportedSprite(const std::shared_ptr<FSprite>& Sprite) const
+{
+	Sprite->bSelected = false;
+	Sprite->HoverStartTime = -1.0;
+	Sprite->ZXColorView->Scale = ImVec2(1.0f, 1.0f);
+	Sprite->ZXColorView->ImagePosition = ImVec2(0.0f, 0.0f);
+	Sprite->ZXColorView->Device = Data.Device;
+	Sprite->ZXColorView->DeviceContext = Data.DeviceContext;
+	Draw_ZXColorView_Initialize(Sprite->ZXColorView, UI::ERenderType::Sprite);
+
+	for (FSpriteMetaRegion& Region : Sprite->Regions)
+	{
+		if (!Region.bHasRegionRect)
+		{
+			continue;
+		}
+
+		Region.ZXColorView = std::make_shared<UI::FZXColorView>();
+		Region.ZXColorView->bOnlyNearestSampling = true;
+		Region.ZXColorView->Device = Data.Device;
+		Region.ZXColorView->DeviceContext = Data.DeviceContext;
+		UI::Draw_ZXColorView_Initialize(Region.ZXColorView, UI::ERenderType::Sprite);
+		{
+			const int32_t Size = Sprite->Width * Sprite->Height;
+			std::vector<uint32_t> RGBA(Size, 0);
+
+			if (!Region.ZXColorView->Image.IsValid())
+			{
+				for (uint32_t y = (uint32_t)Region.Rect.Min.y; y < (uint32_t)Region.Rect.Max.y; ++y)
+				{
+					for (uint32_t x = (uint32_t)Region.Rect.Min.x; x < (uint32_t)Region.Rect.Max.x; ++x)
+					{
+						const int8_t Color = UI::EZXSpectrumColor::Black_;
+						const ImU32 ColorRGBA = UI::ToU32(UI::ZXSpectrumColorRGBA[Color]);
+
+						const uint32_t Index = y * Sprite->Width + x;
+						RGBA[Index] = ColorRGBA;
+					}
+				}
+				Region.ZXColorView->Image = FImageBase::Get().CreateTexture(RGBA.data(), Sprite->Width, Sprite->Height, D3D11_CPU_ACCESS_READ, D3D11_USAGE_DEFAULT);
+			}
+		}
+	}
+}
+
 void SSpriteList::ExportSprites(
 	const std::filesystem::path& ScriptFilePath,
 	const std::filesystem::path& ExportPath,
@@ -1502,15 +1664,126 @@ void SSpriteList::ExportSprites(
 			return conv.to_bytes(wstr);
 		};
 
-	for (const std::shared_ptr<FSprite>& Sprite : SelectedSprites)
+	// packing stage: the sprites share atlas pages, each data type is one blob of pages
+	// and every sprite gets its page rectangle and offsets into the blobs
+	FSpriteAtlas Atlas;
+	std::filesystem::path AtlasInkFilePath;
+	std::filesystem::path AtlasAttributeFilePath;
+	std::filesystem::path AtlasMaskFilePath;
+	std::vector<std::filesystem::path> AtlasImageFilePaths;
+	auto HasZXData = [](const std::shared_ptr<FSprite>& Sprite, const std::vector<uint8_t>& Data, uint32_t Rows)
+		{
+			return Sprite->Width != INDEX_NONE && Sprite->Height != INDEX_NONE && Sprite->Width % 8 == 0 && Sprite->Height % 8 == 0 &&
+				Data.size() == static_cast<size_t>(Sprite->Width >> 3) * Rows;
+		};
+	if (bExportAtlas)
+	{
+		std::vector<std::pair<int32_t, int32_t>> Sizes;
+		Sizes.reserve(SelectedSprites.size());
+		for (const std::shared_ptr<FSprite>& Sprite : SelectedSprites)
+		{
+			const bool bPacked = Sprite->Width > 0 && Sprite->Height > 0 && HasZXData(Sprite, Sprite->ZXColorView->InkData, Sprite->Height);
+			Sizes.emplace_back(bPacked ? int32_t(Sprite->Width) : 0, bPacked ? int32_t(Sprite->Height) : 0);
+		}
+		Atlas.Pack(Sizes);
+
+		std::vector<uint8_t> InkBlob(Atlas.GetPixelSize(), 0);
+		std::vector<uint8_t> AttributeBlob(Atlas.GetAttributeSize(), 0);
+		std::vector<uint8_t> MaskBlob(Atlas.GetPixelSize(), 0);
+		std::vector<std::vector<uint32_t>> PagesRGBA(Atlas.Pages.size());
+		for (size_t PageIndex = 0; PageIndex < Atlas.Pages.size(); ++PageIndex)
+		{
+			PagesRGBA[PageIndex].resize(static_cast<size_t>(Atlas.Pages[PageIndex].Width) * Atlas.Pages[PageIndex].Height, 0);
+		}
+
+		for (size_t Index = 0; Index < SelectedSprites.size(); ++Index)
+		{
+			const std::shared_ptr<FSprite>& Sprite = SelectedSprites[Index];
+			const FSpriteAtlasRect& Rect = Atlas.Rects[Index];
+			if (!Rect.IsValid())
+			{
+				continue;
+			}
+
+			const int32_t Stride = Atlas.GetStride(Rect);
+			const int32_t RowSize = Rect.Width >> 3;
+			FSpriteAtlas::WriteRows(InkBlob, Atlas.GetPixelOffset(Rect), Stride, Sprite->ZXColorView->InkData, RowSize, Rect.Height);
+			FSpriteAtlas::WriteRows(AttributeBlob, Atlas.GetAttributeOffset(Rect), Stride, Sprite->ZXColorView->AttributeData, RowSize, Rect.Height >> 3);
+			FSpriteAtlas::WriteRows(MaskBlob, Atlas.GetPixelOffset(Rect), Stride, Sprite->ZXColorView->MaskData, RowSize, Rect.Height);
+
+			const std::vector<uint8_t>& IndexedData = Sprite->ZXColorView->IndexedData;
+			if (IndexedData.size() == static_cast<size_t>(Rect.Width) * Rect.Height)
+			{
+				std::vector<uint32_t>& RGBA = PagesRGBA[Rect.Page];
+				for (int32_t Y = 0; Y < Rect.Height; ++Y)
+				{
+					for (int32_t X = 0; X < Rect.Width; ++X)
+					{
+						const uint8_t ColorIndex = IndexedData[static_cast<size_t>(Y) * Rect.Width + X];
+						RGBA[static_cast<size_t>(Rect.Y + Y) * Atlas.Pages[Rect.Page].Width + Rect.X + X] = UI::ToU32(UI::ZXSpectrumColorRGBA[ColorIndex]);
+					}
+				}
+			}
+		}
+
+		auto SaveAtlasBlob = [&](const std::vector<uint8_t>& Blob, std::string_view Filename) -> std::filesystem::path
+			{
+				const std::filesystem::path BlobFilePath = IO::NormalizePath(std::filesystem::absolute(ExportPath / Filename));
+				const std::filesystem::path UniqueBlobFilePath = bUniqueExportFilename ? IO::GetUniquePath(BlobFilePath, ec) : BlobFilePath;
+				if (ec || IO::SaveBinaryData(Blob, UniqueBlobFilePath, false))
+				{
+					LOG_ERROR("[{}]\t Failed to write '{}'!", (__FUNCTION__), BlobFilePath.string());
+					return {};
+				}
+				return UniqueBlobFilePath;
+			};
+		if (!Atlas.Pages.empty())
+		{
+			AtlasInkFilePath = bExportInk ? SaveAtlasBlob(InkBlob, "Atlas.ink") : std::filesystem::path();
+			AtlasAttributeFilePath = bExportAttribute ? SaveAtlasBlob(AttributeBlob, "Atlas.attr") : std::filesystem::path();
+			AtlasMaskFilePath = bExportMask ? SaveAtlasBlob(MaskBlob, "Atlas.mask") : std::filesystem::path();
+		}
+
+		constexpr int32_t Channels = 4;
+		for (size_t PageIndex = 0; PageIndex < Atlas.Pages.size(); ++PageIndex)
+		{
+			const FSpriteAtlasPage& Page = Atlas.Pages[PageIndex];
+			const std::filesystem::path ImageFilePath = IO::NormalizePath(std::filesystem::absolute(ExportPath / std::format("Atlas_{}.png", PageIndex)));
+			const std::filesystem::path UniqueImageFilePath = bUniqueExportFilename ? IO::GetUniquePath(ImageFilePath, ec) : ImageFilePath;
+			if (ec || !stbi_write_png(UniqueImageFilePath.string().c_str(), Page.Width, Page.Height, Channels, PagesRGBA[PageIndex].data(), Page.Width * Channels))
+			{
+				LOG_ERROR("[{}]\t Failed to write PNG!", (__FUNCTION__));
+				AtlasImageFilePaths.emplace_back();
+				continue;
+			}
+			AtlasImageFilePaths.push_back(UniqueImageFilePath);
+		}
+	}
+
+	for (size_t SpriteIndex = 0; SpriteIndex < SelectedSprites.size(); ++SpriteIndex)
 	{
+		const std::shared_ptr<FSprite>& Sprite = SelectedSprites[SpriteIndex];
+		const FSpriteAtlasRect AtlasRect = bExportAtlas ? Atlas.Rects[SpriteIndex] : FSpriteAtlasRect();
+		nlohmann::ordered_json AtlasJson = nlohmann::ordered_json::object();
+		if (AtlasRect.IsValid())
+		{
+			AtlasJson["Page"] = AtlasRect.Page;
+			AtlasJson["X"] = AtlasRect.X;
+			AtlasJson["Y"] = AtlasRect.Y;
+			AtlasJson["Stride"] = Atlas.GetStride(AtlasRect);
+			if (!AtlasImageFilePaths[AtlasRect.Page].empty())
+			{
+				AtlasJson["Image"] = ToUtf8(AtlasImageFilePaths[AtlasRect.Page].wstring());
+			}
+		}
+
 		const auto MakeExportFilename = [&Sprite](std::string_view Extension)
 			{
 				return std::filesystem::path(Utils::Utf8ToUtf16(Sprite->Name + std::string(Extension)));
 			};
 
 		std::filesystem::path IndexedDataFilePath;
-		if (Sprite->ZXColorView->IndexedData.size() > 0)
+		if (Sprite->ZXColorView->IndexedData.size() > 0 && !AtlasJson.contains("Image"))
 		{
 			IndexedDataFilePath = IO::NormalizePath(ExportPath / MakeExportFilename(".png"));
 			const std::filesystem::path UniqueIndexedDataFilePath = bUniqueExportFilename ? IO::GetUniquePath(IndexedDataFilePath, ec) : IndexedDataFilePath;
@@ -1549,26 +1822,91 @@ void SSpriteList::ExportSprites(
 		}
 
 		std::filesystem::path InkDataFilePath;
-		if (bExportInk && Sprite->ZXColorView->InkData.size() > 0)
+		if (!AtlasInkFilePath.empty() && AtlasRect.IsValid())
+		{
+			InkDataFilePath = AtlasInkFilePath;
+			AtlasJson["InkOffset"] = Atlas.GetPixelOffset(AtlasRect);
+		}
+		else if (bExportInk && Sprite->ZXColorView->InkData.size() > 0)
 		{
 			InkDataFilePath = IO::NormalizePath(std::filesystem::absolute(ExportPath / MakeExportFilename(".ink")));
 			IO::SaveBinaryData(Sprite->ZXColorView->InkData, InkDataFilePath, bUniqueExportFilename);
 		}
 
 		std::filesystem::path AttributeDataFilePath;
-		if (bExportAttribute && Sprite->ZXColorView->AttributeData.size() > 0)
+		if (!AtlasAttributeFilePath.empty() && AtlasRect.IsValid() && HasZXData(Sprite, Sprite->ZXColorView->AttributeData, Sprite->Height >> 3))
+		{
+			AttributeDataFilePath = AtlasAttributeFilePath;
+			AtlasJson["AttributeOffset"] = Atlas.GetAttributeOffset(AtlasRect);
+		}
+		else if (bExportAttribute && Sprite->ZXColorView->AttributeData.size() > 0)
 		{
 			AttributeDataFilePath = IO::NormalizePath(std::filesystem::absolute(ExportPath / MakeExportFilename(".attr")));
 			IO::SaveBinaryData(Sprite->ZXColorView->AttributeData, AttributeDataFilePath, bUniqueExportFilename);
 		}
 
 		std::filesystem::path MaskDataFilePath;
-		if (bExportMask && Sprite->ZXColorView->MaskData.size() > 0)
+		if (!AtlasMaskFilePath.empty() && AtlasRect.IsValid() && HasZXData(Sprite, Sprite->ZXColorView->MaskData, Sprite->Height))
+		{
+			MaskDataFilePath = AtlasMaskFilePath;
+			AtlasJson["MaskOffset"] = Atlas.GetPixelOffset(AtlasRect);
+		}
+		else if (bExportMask && Sprite->ZXColorView->MaskData.size() > 0)
 		{
 			MaskDataFilePath = IO::NormalizePath(std::filesystem::absolute(ExportPath / MakeExportFilename(".mask")));
 			IO::SaveBinaryData(Sprite->ZXColorView->MaskData, MaskDataFilePath, bUniqueExportFilename);
 		}
 
+		std::filesystem::path CompiledSpriteFilePath;
+		nlohmann::ordered_json CompiledVariantsJson = nlohmann::ordered_json::array();
+		if (bExportCompiledSprite && Sprite->ZXColorView->InkData.size() > 0)
+		{
+			std::string LabelName = Sprite->Name;
+			std::replace_if(LabelName.begin(), LabelName.end(), [](char c) { return !std::isalnum(static_cast<unsigned char>(c)); }, '_');
+			if (LabelName.empty() || std::isdigit(static_cast<unsigned char>(LabelName.front())))
+			{
+				LabelName.insert(LabelName.begin(), '_');
+			}
+
+			SpriteCompiler::FResult CompiledSprite;
+			std::string Error;
+			if (SpriteCompiler::Generate(
+				Sprite->ZXColorView->InkData,
+				Sprite->ZXColorView->MaskData,
+				Sprite->Width, Sprite->Height,
+				SpriteCompiler::FOptions(),
+				LabelName,
+				CompiledSprite,
+				Error))
+			{
+				CompiledSpriteFilePath = IO::NormalizePath(std::filesystem::absolute(ExportPath / MakeExportFilename(".asm")));
+				const std::filesystem::path UniqueCompiledSpriteFilePath = bUniqueExportFilename ? IO::GetUniquePath(CompiledSpriteFilePath, ec) : CompiledSpriteFilePath;
+				std::ofstream CompiledFile(UniqueCompiledSpriteFilePath, std::ios::binary);
+				if (!ec && CompiledFile.is_open())
+				{
+					CompiledFile << CompiledSprite.AsmCode;
+					CompiledFile.close();
+					CompiledSpriteFilePath = UniqueCompiledSpriteFilePath;
+				}
+
+				for (const SpriteCompiler::FVariant& Variant : CompiledSprite.Variants)
+				{
+					CompiledVariantsJson.push_back(
+						{
+							{"Shift", Variant.Shift},
+							{"WidthBytes", Variant.WidthBytes},
+							{"Cycles", Variant.Cycles},
+							{"CodeBytes", Variant.CodeBytes},
+							{"TableBytes", Variant.Table.size()},
+						});
+				}
+			}
+			else
+			{
+				LOG_ERROR("[{}]\t Failed to compile sprite '{}': {}", (__FUNCTION__), Sprite->Name, Error);
+			}
+		}
+
 		nlohmann::ordered_json SpriteJson =
 			{
 				{"SprName", Sprite->Name},
@@ -1583,6 +1921,10 @@ void SSpriteList::ExportSprites(
 				{"MaskData", ToUtf8(MaskDataFilePath.wstring())},
 			};
 
+		if (!AtlasJson.empty())
+		{
+			SpriteJson["Atlas"] = AtlasJson;
+		}
 		if (Sprite->AsepriteIndex != INDEX_NONE)
 		{
 			SpriteJson.emplace("AsepriteIndex", Sprite->AsepriteIndex);
@@ -1597,6 +1939,11 @@ void SSpriteList::ExportSprites(
 		{
 			SpriteJson.emplace("Regions", Sprite->Regions);
 		}
+		if (!CompiledVariantsJson.empty())
+		{
+			SpriteJson.emplace("CompiledSprite", ToUtf8(CompiledSpriteFilePath.wstring()));
+			SpriteJson.emplace("CompiledVariants", CompiledVariantsJson);
+		}
 
 		// Finding a sprite in JSON
 		auto It = std::find_if(Json.begin(), Json.end(),
@@ -1661,6 +2008,7 @@ void SSpriteList::SendSelectedSprite(bool bOpenMetadata /*= false*/) const
 void SSpriteList::ApplyImportSprites(const std::vector<std::shared_ptr<FSprite>>& ReadSprites)
 {
 	Sprites = ReadSprites;
+	bThumbnailAtlasDirty = true;
 	std::shared_ptr<SViewerBase> Viewer = GetParent();
 	for (std::shared_ptr<FSprite> Sprite : Sprites)
 	{
@@ -1678,3 +2026,91 @@ void SSpriteList::ApplyImportSprites(const std::vector<std::shared_ptr<FSprite>>
 		}
 	}
 }
+
+void SSpriteList::RebuildThumbnailAtlas()
+{
+	bThumbnailAtlasDirty = false;
+
+	std::vector<std::pair<int32_t, int32_t>> Sizes;
+	Sizes.reserve(Sprites.size());
+	for (const std::shared_ptr<FSprite>& Sprite : Sprites)
+	{
+		const bool bHasImage = Sprite->ZXColorView && Sprite->Width != INDEX_NONE && Sprite->Height != INDEX_NONE &&
+			Sprite->ZXColorView->IndexedData.size() == static_cast<size_t>(Sprite->Width) * Sprite->Height;
+		Sizes.emplace_back(bHasImage ? int32_t(Sprite->Width) : 0, bHasImage ? int32_t(Sprite->Height) : 0);
+	}
+
+	FSpriteAtlas Atlas;
+	Atlas.Pack(Sizes, 1024, 1024);
+
+	RetiredThumbnailPages.insert(RetiredThumbnailPages.end(), ThumbnailPages.begin(), ThumbnailPages.end());
+	ThumbnailPages.clear();
+	for (const FSpriteAtlasPage& Page : Atlas.Pages)
+	{
+		std::shared_ptr<UI::FZXColorView> PageView = std::make_shared<UI::FZXColorView>();
+		PageView->Scale = ImVec2(1.0f, 1.0f);
+		PageView->ImagePosition = ImVec2(0.0f, 0.0f);
+		PageView->Device = Data.Device;
+		PageView->DeviceContext = Data.DeviceContext;
+		UI::Draw_ZXColorView_Initialize(PageView, UI::ERenderType::Sprite);
+		PageView->Staging.Resize(Page.Width, Page.Height);
+		ThumbnailPages.push_back(PageView);
+	}
+
+	for (size_t Index = 0; Index < Sprites.size(); ++Index)
+	{
+		const std::shared_ptr<FSprite>& Sprite = Sprites[Index];
+		const FSpriteAtlasRect& Rect = Atlas.Rects[Index];
+		if (!Rect.IsValid())
+		{
+			Sprite->AtlasView.reset();
+			Sprite->AtlasRect = FSpriteAtlasRect();
+			continue;
+		}
+
+		UI::FTextureStaging& Staging = ThumbnailPages[Rect.Page]->Staging;
+		const std::vector<uint8_t>& IndexedData = Sprite->ZXColorView->IndexedData;
+		for (int32_t Y = 0; Y < Rect.Height; ++Y)
+		{
+			const uint8_t* Input = IndexedData.data() + static_cast<size_t>(Y) * Rect.Width;
+			uint32_t* Output = Staging.GetRow(Rect.Y + Y) + Rect.X;
+			for (int32_t X = 0; X < Rect.Width; ++X)
+			{
+				Output[X] = UI::ToU32(UI::ZXSpectrumColorRGBA[Input[X]]);
+			}
+		}
+
+		const ImVec2 PageSize((float)Staging.Width, (float)Staging.Height);
+		Sprite->AtlasView = ThumbnailPages[Rect.Page];
+		Sprite->AtlasRect = Rect;
+		Sprite->AtlasUV = ImRect(
+			ImVec2((float)Rect.X, (float)Rect.Y) / PageSize,
+			ImVec2((float)(Rect.X + Rect.Width), (float)(Rect.Y + Rect.Height)) / PageSize);
+	}
+
+	for (const std::shared_ptr<UI::FZXColorView>& PageView : ThumbnailPages)
+	{
+		UI::UploadStaging(PageView->Image, PageView->Staging);
+	}
+}
+
+void SSpriteList::UpdateThumbnail(const std::shared_ptr<FSprite>& Sprite, const std::vector<uint32_t>& RGBA)
+{
+	const FSpriteAtlasRect& Rect = Sprite->AtlasRect;
+	if (!Sprite->AtlasView ||
+		Rect.Width != int32_t(Sprite->Width) || Rect.Height != int32_t(Sprite->Height) ||
+		RGBA.size() < static_cast<size_t>(Rect.Width) * Rect.Height)
+	{
+		bThumbnailAtlasDirty = true;
+		return;
+	}
+
+	// only the rectangle of the sprite is uploaded into its page
+	UI::FTextureStaging& Staging = Sprite->AtlasView->Staging;
+	for (int32_t Y = 0; Y < Rect.Height; ++Y)
+	{
+		std::memcpy(Staging.GetRow(Rect.Y + Y) + Rect.X, RGBA.data() + static_cast<size_t>(Y) * Rect.Width, static_cast<size_t>(Rect.Width) * sizeof(uint32_t));
+	}
+	Staging.Dirty.Add({ Rect.X, Rect.Y, Rect.X + Rect.Width, Rect.Y + Rect.Height });
+	UI::UploadStaging(Sprite->AtlasView->Image, Staging);
+}
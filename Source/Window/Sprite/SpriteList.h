@@ -3,7 +3,9 @@
 #include <CoreMinimal.h>
 #include <json/json.hpp>
 #include <Core/ViewerBase.h>
+#include <Core/JobSystem.h>
 #include <Utils/UI/Draw_ZXColorVideo.h>
+#include "SpriteAtlas.h"
 
 struct FSpriteProperty
 {
@@ -191,6 +193,11 @@ struct FSprite
 	std::vector<FSpriteMetaRegion> Regions;
 	std::shared_ptr<UI::FZXColorView> ZXColorView;
 
+	// thumbnail in the shared atlas page of the sprite list
+	std::shared_ptr<UI::FZXColorView> AtlasView;
+	FSpriteAtlasRect AtlasRect;
+	ImRect AtlasUV;
+
 	FSprite()
 		: Width (INDEX_NONE)
 		, Height (INDEX_NONE)
@@ -282,7 +289,10 @@ private:
 
 	bool HasMissingImportData(const std::filesystem::path& FilePath) const;
 	bool RepairImportData(const std::filesystem::path& FilePath, const FImportRepairOptions& Options) const;
-	bool ImportSprites(const std::filesystem::path& FilePath, std::vector<std::shared_ptr<FSprite>>& OutputSprites);
+	// sprites come without device resources, InitializeImportedSprite is called on the main thread afterwards
+	bool ImportSprites(const std::filesystem::path& FilePath, std::vector<std::shared_ptr<FSprite>>& OutputSprites, FJobContext* Job = nullptr) const;
+	void InitializeImportedSprite(const std::shared_ptr<FSprite>& Sprite) const;
+	void StartImportJob(const std::filesystem::path& FilePath, bool bRepair);
 	void Draw_ImportRepair();
 	void ExportSprites(
 		const std::filesystem::path& ScriptFilePath,
@@ -294,6 +304,9 @@ private:
 	void SendSelectedSprite(bool bOpenMetadata = false) const;
 	void ApplyImportSprites(const std::vector<std::shared_ptr<FSprite>>& ReadSprites);
 
+	void RebuildThumbnailAtlas();
+	void UpdateThumbnail(const std::shared_ptr<FSprite>& Sprite, const std::vector<uint32_t>& RGBA);
+
 	bool bNeedKeptOpened_ExportPopup;
 	uint32_t ScaleVisible;
 	int32_t IndexSelectedSprite;
@@ -303,16 +316,26 @@ private:
 	std::vector<std::shared_ptr<FSprite>> Sprites;
 	std::unordered_map<std::string, bool> EditingSprites;
 
+	// thumbnails of all sprites share the packed pages instead of a texture per sprite
+	bool bThumbnailAtlasDirty;
+	std::vector<std::shared_ptr<UI::FZXColorView>> ThumbnailPages;
+	std::vector<std::shared_ptr<UI::FZXColorView>> RetiredThumbnailPages;	// may still be referenced by the last frame
+
 	// popup menu 'Restore missing import data'
 	bool bNeedOpenImportRepairPopup;
 	std::filesystem::path PendingImportFilePath;
 	FImportRepairOptions ImportRepairOptions;
 
+	// import in the background, valid until the completion has run
+	FJobHandle ImportJob;
+
 	// popup menu 'Export'
 	bool bUniqueExportFilename;
 	bool bExportInk;
 	bool bExportAttribute;
 	bool bExportMask;
+	bool bExportCompiledSprite;
+	bool bExportAtlas;
 	int32_t IndexSelectedScript;
 	std::vector<std::string> ScriptFileNames;
 	std::map<std::string, std::string> ScriptFiles;
@@ -1336,6 +1336,6 @@ void STimeline::InitializeFromAseprite(std::weak_ptr<AsepriteFormat::FSprite> Ne
         return;
     }
 
-    FrameCount = (int32_t)Sprite->Frames.size();
+    FrameCount = Sprite->FrameCount;
     LayerCount = (int32_t)Sprite->Layers.size();
 }
@@ -40,6 +40,7 @@ void SToolBar::NativeInitialize(const FNativeDataInitialize& Data)
 				Event.Tag = FEventTag::ChangeToolModeTag;
 				Event.ChangeToolMode.ToolMode = ToolMode[0];
 				SendEvent(Event);
+				SendPaintBucketOptions();
 			}
 		});
 }
@@ -119,6 +120,16 @@ void SToolBar::Render()
 		{
 			SetToolMode(EToolMode::PaintBucket, true);
 		}
+		if (ImGui::BeginPopupContextItem("PaintBucketOptions"))
+		{
+			bool bChanged = ImGui::Checkbox("Заливка по диагонали", &PaintBucketOptions.bDiagonal);
+			bChanged |= ImGui::Checkbox("Только внутри знакоместа", &PaintBucketOptions.bWithinCell);
+			if (bChanged)
+			{
+				SendPaintBucketOptions();
+			}
+			ImGui::EndPopup();
+		}
 
 		//ImGui::Text("%i, %i", ToolMode[0], ToolMode[1]);
 
@@ -132,6 +143,14 @@ void SToolBar::Destroy()
 	UnsubscribeAll();
 }
 
+void SToolBar::SendPaintBucketOptions()
+{
+	FEvent_ToolBar Event;
+	Event.Tag = FEventTag::PaintBucketOptionsTag;
+	Event.PaintBucketOptions = PaintBucketOptions;
+	SendEvent(Event);
+}
+
 void SToolBar::SetToolMode(EToolMode::Type NewToolMode, bool bForce /*= true*/, bool bEvent /*= false*/)
 {
 	if (ToolMode[0] != NewToolMode)
@@ -17,6 +17,12 @@ namespace EToolMode
 	};
 }
 
+struct FPaintBucketOptions
+{
+	bool bDiagonal = false;		// 8-connectivity
+	bool bWithinCell = false;	// don't leave the attribute cell of the clicked pixel
+};
+
 class SToolBar : public SViewerChildBase
 {
 	using Super = SViewerChildBase;
@@ -33,6 +39,7 @@ public:
 private:
 	bool IsEqualToolMode(EToolMode::Type Equal) const { return ToolMode[0] == Equal; }
 	void SetToolMode(EToolMode::Type NewToolMode, bool bForce = true, bool bEvent = false);
+	void SendPaintBucketOptions();
 
 	// image 
 	FImageHandle ImageRectangleMarquee;
@@ -42,4 +49,5 @@ private:
 	FImageHandle ImagePaintBucket;
 
 	EToolMode::Type ToolMode[2];
+	FPaintBucketOptions PaintBucketOptions;
 };
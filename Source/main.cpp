@@ -5,6 +5,8 @@
 #include <AppMain.h>
 #include <AppSprite.h>
 #include <AppDebugger.h>
+#include <AppConverter.h>
+#include <AppReplay.h>
 
 int main(int argc, char** argv)
 {
@@ -24,8 +26,33 @@ int main(int argc, char** argv)
 		}
 	}
 
+	if (FAppConverter::IsRequested(Args))
+	{
+		FAppConverter::FOptions Options;
+		return FAppConverter::ParseArgs(Args, Options) ? FAppConverter::Run(Options) : 1;
+	}
+
+	if (FAppReplay::IsRequested(Args))
+	{
+		FAppReplay::FOptions Options;
+		return FAppReplay::ParseArgs(Args, Options) ? FAppReplay::Run(Options) : 1;
+	}
+
 	EApplication::Type Application = EApplication::None;
 	{
+		// the debugger starts from the snapshot
+		if (const auto It = Args.find("snapshot"); It != Args.end() && !It->second.empty())
+		{
+			FAppFramework::Get<FAppDebugger>().SetStartupSnapshot(It->second);
+			Application = EApplication::Debugger;
+		}
+
+		// the sound is recorded instead of played
+		if (const auto It = Args.find("wav"); It != Args.end() && !It->second.empty())
+		{
+			FAppFramework::Get<FAppDebugger>().SetAudioFile(It->second);
+		}
+
 		for (const auto& [Key, Value] : Args)
 		{
 			if (!Key.compare("debugger"))